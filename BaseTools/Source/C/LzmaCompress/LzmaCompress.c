@@ -25,8 +25,25 @@
 #include "CommonLib.h"
 #include "ParseInf.h"
 
+#ifdef _WIN32
+#include "Sdk/C/Threads.h"
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
 #define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
 
+//
+// Chunked format: a 16-byte header (Signature, ChunkSize, ChunkCount and
+// DecodedSize, all UINT32) followed by ChunkCount UINT32 encoded chunk sizes
+// and then by the chunks. Each chunk is a complete LZMA stream with its own
+// LZMA_HEADER_SIZE header, so the chunks can be decoded independently.
+//
+#define LZMA_CHUNKED_SIGNATURE    0x4B435A4C   // "LZCK"
+#define LZMA_CHUNKED_HEADER_SIZE  16
+#define DEFAULT_CHUNK_SIZE        (1 << 20)
+
 typedef enum {
   NoConverter,
   X86Converter,
@@ -44,10 +61,12 @@ static CONVERTER_TYPE mConType = NoConverter;
 
 UINT64 mDictionarySize = 28;
 UINT64 mCompressionMode = 2;
+UINT64 mChunkSize = 0;
+UINT64 mThreadCount = 0;
 
 #define UTILITY_NAME "LzmaCompress"
 #define UTILITY_MAJOR_VERSION 0
-#define UTILITY_MINOR_VERSION 2
+#define UTILITY_MINOR_VERSION 3
 #define INTEL_COPYRIGHT \
   "Copyright (c) 2009-2018, Intel Corporation. All rights reserved."
 void PrintHelp(char *buffer)
@@ -60,6 +79,10 @@ void PrintHelp(char *buffer)
              "  -d: decode file\n"
              "  -o FileName, --output FileName: specify the output filename\n"
              "  --f86: enable converter for x86 code\n"
+             "  --chunked: encode/decode independently decodable chunks\n"
+             "  --chunk-size Size: set the chunk size of --chunked, default: 0x100000\n"
+             "  --threads Count: set the number of threads encoding the chunks of --chunked,\n"
+             "                   default: 0 (one per host processor)\n"
              "  -v, --verbose: increase output messages\n"
              "  -q, --quiet: reduce output messages\n"
              "  --debug [0-9]: set debug level\n"
@@ -174,6 +197,325 @@ Done:
   return res;
 }
 
+static void WriteUInt32(Byte *buffer, UInt32 value)
+{
+  int i;
+  for (i = 0; i < 4; i++)
+    buffer[i] = (Byte)(value >> (8 * i));
+}
+
+static UInt32 ReadUInt32(const Byte *buffer)
+{
+  return (UInt32)buffer[0] | ((UInt32)buffer[1] << 8) | ((UInt32)buffer[2] << 16) | ((UInt32)buffer[3] << 24);
+}
+
+//
+// Chunks are encoded into fixed size slots of the output buffer, thread N of
+// M encoding the chunks N, N + M, N + 2M... The slots are then packed behind
+// the size table in chunk order, so the output does not depend on the number
+// of threads.
+//
+typedef struct {
+  const Byte          *inBuffer;
+  size_t              inSize;
+  Byte                *slotBuffer;
+  size_t              slotSize;
+  size_t              chunkSize;
+  UInt32              chunkCount;
+  UInt32              threadCount;
+  const CLzmaEncProps *props;
+  size_t              *encodedSize;
+  SRes                *chunkRes;
+} CHUNKED_ENCODER;
+
+typedef struct {
+  CHUNKED_ENCODER     *encoder;
+  UInt32              firstChunk;
+} CHUNKED_ENCODER_THREAD;
+
+static void EncodeChunks(CHUNKED_ENCODER *encoder, UInt32 firstChunk)
+{
+  UInt32 chunk;
+
+  for (chunk = firstChunk; chunk < encoder->chunkCount; chunk += encoder->threadCount) {
+    size_t inPos = (size_t)chunk * encoder->chunkSize;
+    size_t chunkInSize = encoder->inSize - inPos < encoder->chunkSize ? encoder->inSize - inPos : encoder->chunkSize;
+    Byte *slot = encoder->slotBuffer + (size_t)chunk * encoder->slotSize;
+    size_t outSizeProcessed = encoder->slotSize - LZMA_HEADER_SIZE;
+    size_t outPropsSize = LZMA_PROPS_SIZE;
+    int i;
+
+    for (i = 0; i < 8; i++)
+      slot[i + LZMA_PROPS_SIZE] = (Byte)((UInt64)chunkInSize >> (8 * i));
+
+    encoder->chunkRes[chunk] = LzmaEncode(slot + LZMA_HEADER_SIZE, &outSizeProcessed,
+        encoder->inBuffer + inPos, chunkInSize,
+        encoder->props, slot, &outPropsSize, 0,
+        NULL, &g_Alloc, &g_Alloc);
+    encoder->encodedSize[chunk] = LZMA_HEADER_SIZE + outSizeProcessed;
+  }
+}
+
+#ifdef _WIN32
+static THREAD_FUNC_DECL EncodeChunksThread(void *param)
+#else
+static void *EncodeChunksThread(void *param)
+#endif
+{
+  CHUNKED_ENCODER_THREAD *thread = (CHUNKED_ENCODER_THREAD *)param;
+  EncodeChunks(thread->encoder, thread->firstChunk);
+  return 0;
+}
+
+static UInt32 GetProcessorCount(void)
+{
+#ifdef _WIN32
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  return systemInfo.dwNumberOfProcessors;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (UInt32)count : 1;
+#endif
+}
+
+//
+// Run EncodeChunks () on encoder->threadCount threads. If a thread cannot be
+// created, the calling thread encodes the chunks that thread would have.
+//
+static void EncodeChunksMt(CHUNKED_ENCODER *encoder)
+{
+  CHUNKED_ENCODER_THREAD *threads;
+#ifdef _WIN32
+  CThread *handles;
+#else
+  pthread_t *handles;
+#endif
+  BoolInt *created;
+  UInt32 index;
+
+  threads = (CHUNKED_ENCODER_THREAD *)MyAlloc(encoder->threadCount * sizeof(*threads));
+  handles = MyAlloc(encoder->threadCount * sizeof(*handles));
+  created = (BoolInt *)MyAlloc(encoder->threadCount * sizeof(*created));
+  if (threads == 0 || handles == 0 || created == 0) {
+    encoder->threadCount = 1;
+    EncodeChunks(encoder, 0);
+    goto Done;
+  }
+
+  for (index = 1; index < encoder->threadCount; index++) {
+    threads[index].encoder = encoder;
+    threads[index].firstChunk = index;
+#ifdef _WIN32
+    Thread_Construct(&handles[index]);
+    created[index] = (Thread_Create(&handles[index], EncodeChunksThread, &threads[index]) == 0);
+#else
+    created[index] = (pthread_create(&handles[index], NULL, EncodeChunksThread, &threads[index]) == 0);
+#endif
+  }
+
+  EncodeChunks(encoder, 0);
+
+  for (index = 1; index < encoder->threadCount; index++) {
+    if (!created[index]) {
+      EncodeChunks(encoder, index);
+      continue;
+    }
+#ifdef _WIN32
+    Thread_Wait(&handles[index]);
+    Thread_Close(&handles[index]);
+#else
+    pthread_join(handles[index], NULL);
+#endif
+  }
+
+Done:
+  MyFree(created);
+  MyFree(handles);
+  MyFree(threads);
+}
+
+static SRes EncodeChunked(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize, CLzmaEncProps *props)
+{
+  SRes res;
+  size_t inSize = (size_t)fileSize;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+  size_t outSize;
+  size_t outPos;
+  size_t chunkSize = (size_t)mChunkSize;
+  UInt32 chunkCount;
+  UInt32 chunk;
+  CHUNKED_ENCODER encoder;
+
+  encoder.encodedSize = 0;
+  encoder.chunkRes = 0;
+
+  if (inSize == 0) {
+    return SZ_ERROR_INPUT_EOF;
+  }
+
+  if (fileSize > 0xFFFFFFFF) {
+    return SZ_ERROR_PARAM;
+  }
+
+  inBuffer = (Byte *)MyAlloc(inSize);
+  if (inBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
+    res = SZ_ERROR_READ;
+    goto Done;
+  }
+
+  chunkCount = (UInt32)((inSize + chunkSize - 1) / chunkSize);
+
+  // we allocate 105% of the chunk size + 64KB for each chunk slot
+  encoder.slotSize = (chunkSize < inSize ? chunkSize : inSize) / 20 * 21 + LZMA_HEADER_SIZE + (1 << 16);
+  outSize = LZMA_CHUNKED_HEADER_SIZE + 4 * (size_t)chunkCount +
+            (size_t)chunkCount * encoder.slotSize;
+  outBuffer = (Byte *)MyAlloc(outSize);
+  encoder.encodedSize = (size_t *)MyAlloc((size_t)chunkCount * sizeof(size_t));
+  encoder.chunkRes = (SRes *)MyAlloc((size_t)chunkCount * sizeof(SRes));
+  if (outBuffer == 0 || encoder.encodedSize == 0 || encoder.chunkRes == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  WriteUInt32(outBuffer, LZMA_CHUNKED_SIGNATURE);
+  WriteUInt32(outBuffer + 4, (UInt32)chunkSize);
+  WriteUInt32(outBuffer + 8, chunkCount);
+  WriteUInt32(outBuffer + 12, (UInt32)inSize);
+
+  //
+  // The dictionary does not need to be larger than a chunk
+  //
+  props->reduceSize = chunkSize;
+
+  outPos = LZMA_CHUNKED_HEADER_SIZE + 4 * (size_t)chunkCount;
+
+  encoder.inBuffer = inBuffer;
+  encoder.inSize = inSize;
+  encoder.slotBuffer = outBuffer + outPos;
+  encoder.chunkSize = chunkSize;
+  encoder.chunkCount = chunkCount;
+  encoder.threadCount = (mThreadCount != 0) ? (UInt32)mThreadCount : GetProcessorCount();
+  if (encoder.threadCount > chunkCount) {
+    encoder.threadCount = chunkCount;
+  }
+  encoder.props = props;
+
+  if (encoder.threadCount > 1) {
+    EncodeChunksMt(&encoder);
+  } else {
+    EncodeChunks(&encoder, 0);
+  }
+
+  for (chunk = 0; chunk < chunkCount; chunk++) {
+    res = encoder.chunkRes[chunk];
+    if (res != SZ_OK)
+      goto Done;
+
+    WriteUInt32(outBuffer + LZMA_CHUNKED_HEADER_SIZE + 4 * chunk, (UInt32)encoder.encodedSize[chunk]);
+    memmove(outBuffer + outPos, encoder.slotBuffer + (size_t)chunk * encoder.slotSize, encoder.encodedSize[chunk]);
+    outPos += encoder.encodedSize[chunk];
+  }
+
+  if (outStream->Write(outStream, outBuffer, outPos) != outPos)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(encoder.chunkRes);
+  MyFree(encoder.encodedSize);
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
+static SRes DecodeChunked(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
+{
+  SRes res;
+  size_t inSize = (size_t)fileSize;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+  size_t outSize;
+  size_t inPos;
+  size_t chunkSize;
+  UInt32 chunkCount;
+  UInt32 chunk;
+
+  if (inSize < LZMA_CHUNKED_HEADER_SIZE)
+    return SZ_ERROR_INPUT_EOF;
+
+  inBuffer = (Byte *)MyAlloc(inSize);
+  if (inBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
+    res = SZ_ERROR_READ;
+    goto Done;
+  }
+
+  chunkSize  = ReadUInt32(inBuffer + 4);
+  chunkCount = ReadUInt32(inBuffer + 8);
+  outSize    = ReadUInt32(inBuffer + 12);
+  if ((ReadUInt32(inBuffer) != LZMA_CHUNKED_SIGNATURE) || (chunkSize == 0) ||
+      (chunkCount != (outSize + chunkSize - 1) / chunkSize) ||
+      ((inSize - LZMA_CHUNKED_HEADER_SIZE) / 4 < chunkCount)) {
+    res = SZ_ERROR_DATA;
+    goto Done;
+  }
+
+  if (outSize == 0) {
+    res = SZ_OK;
+    goto Done;
+  }
+
+  outBuffer = (Byte *)MyAlloc(outSize);
+  if (outBuffer == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  inPos = LZMA_CHUNKED_HEADER_SIZE + 4 * (size_t)chunkCount;
+  for (chunk = 0; chunk < chunkCount; chunk++) {
+    size_t outPos = (size_t)chunk * chunkSize;
+    size_t chunkOutSize = outSize - outPos < chunkSize ? outSize - outPos : chunkSize;
+    size_t chunkInSize = ReadUInt32(inBuffer + LZMA_CHUNKED_HEADER_SIZE + 4 * chunk);
+    size_t inSizePure;
+    ELzmaStatus status;
+
+    if ((chunkInSize < LZMA_HEADER_SIZE) || (chunkInSize > inSize - inPos)) {
+      res = SZ_ERROR_DATA;
+      goto Done;
+    }
+
+    inSizePure = chunkInSize - LZMA_HEADER_SIZE;
+    res = LzmaDecode(outBuffer + outPos, &chunkOutSize, inBuffer + inPos + LZMA_HEADER_SIZE, &inSizePure,
+        inBuffer + inPos, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+
+    if (res != SZ_OK)
+      goto Done;
+
+    if (status != LZMA_STATUS_FINISHED_WITH_MARK && status != LZMA_STATUS_MAYBE_FINISHED_WITHOUT_MARK) {
+      res = SZ_ERROR_DATA;
+      goto Done;
+    }
+
+    inPos += chunkInSize;
+  }
+
+  if (outStream->Write(outStream, outBuffer, outSize) != outSize)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
 static SRes Decode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
 {
   SRes res;
@@ -272,6 +614,28 @@ int main2(int numArgs, const char *args[], char *rs)
       modeWasSet = True;
     } else if (strcmp(args[param], "--f86") == 0) {
       mConType = X86Converter;
+    } else if (strcmp(args[param], "--chunked") == 0) {
+      if (mChunkSize == 0) {
+        mChunkSize = DEFAULT_CHUNK_SIZE;
+      }
+    } else if (strcmp(args[param], "--chunk-size") == 0) {
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      AsciiStringToUint64(args[param + 1],FALSE,&mChunkSize);
+      if ((mChunkSize == 0) || (mChunkSize > 0x80000000)) {
+        return PrintError(rs, kInvalidParamValMessage);
+      }
+      param++;
+    } else if (strcmp(args[param], "--threads") == 0) {
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      AsciiStringToUint64(args[param + 1],FALSE,&mThreadCount);
+      if (mThreadCount > 0x400) {
+        return PrintError(rs, kInvalidParamValMessage);
+      }
+      param++;
     } else if (strcmp(args[param], "-o") == 0 ||
                strcmp(args[param], "--output") == 0) {
       if (numArgs < (param + 2)) {
@@ -342,6 +706,10 @@ int main2(int numArgs, const char *args[], char *rs)
     return PrintUserError(rs);
   }
 
+  if ((mChunkSize != 0) && (mConType != NoConverter)) {
+    return PrintError(rs, "--chunked cannot be combined with a converter");
+  }
+
   {
     size_t t4 = sizeof(UInt32);
     size_t t8 = sizeof(UInt64);
@@ -364,14 +732,22 @@ int main2(int numArgs, const char *args[], char *rs)
     if (!mQuietMode) {
       printf("Encoding\n");
     }
-    res = Encode(&outStream.vt, &inStream.vt, fileSize, &props);
+    if (mChunkSize != 0) {
+      res = EncodeChunked(&outStream.vt, &inStream.vt, fileSize, &props);
+    } else {
+      res = Encode(&outStream.vt, &inStream.vt, fileSize, &props);
+    }
   }
   else
   {
     if (!mQuietMode) {
       printf("Decoding\n");
     }
-    res = Decode(&outStream.vt, &inStream.vt, fileSize);
+    if (mChunkSize != 0) {
+      res = DecodeChunked(&outStream.vt, &inStream.vt, fileSize);
+    } else {
+      res = Decode(&outStream.vt, &inStream.vt, fileSize);
+    }
   }
 
   File_Close(&outStream.file);
@@ -1611,6 +1611,8 @@ class TopLevelMakefile(BuildFile):
             ExtraOption += " -c"
         if not GlobalData.gEnableGenfdsMultiThread:
             ExtraOption += " --no-genfds-multi-thread"
+        if GlobalData.gEnableGenfdsMultiThreadFv:
+            ExtraOption += " --genfds-multi-thread-fv -n %d" % GlobalData.gThreadNumber
         if GlobalData.gIgnoreSource:
             ExtraOption += " --ignore-sources"
 
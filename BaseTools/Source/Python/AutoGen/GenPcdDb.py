@@ -20,7 +20,12 @@ from Common import GlobalData
 from Common import EdkLogger
 import Common.LongFilePathOs as os
 
-DATABASE_VERSION = 7
+DATABASE_VERSION = 8
+
+## Marks a bucket of the ExMap hash table that holds the slot of its only key
+EXMAP_HASH_DIRECT = 0x80000000
+## Bound of the seed search of a bucket of the ExMap hash table
+EXMAP_HASH_MAX_SEED = 0x10000
 
 gPcdDatabaseAutoGenC = TemplateString("""
 //
@@ -188,7 +193,8 @@ typedef struct {
   //UINT16                LocalTokenCount;  // LOCAL_TOKEN_NUMBER for all
   //UINT16                ExTokenCount;     // EX_TOKEN_NUMBER for DynamicEx
   //UINT16                GuidTableCount;   // The Number of Guid in GuidTable
-  //UINT8                 Pad[6];
+  //UINT8                 Pad[2];
+  //TABLE_OFFSET          ExMapHashTableOffset;
   ${PHASE}_PCD_DATABASE_INIT    Init;
   ${PHASE}_PCD_DATABASE_UNINIT  Uninit;
 } ${PHASE}_PCD_DATABASE;
@@ -323,6 +329,84 @@ class DbExMapTblItemList (DbItemList):
                            GetIntegerValue(Datas[2]))
         return Buffer
 
+## Hash of a DynamicEx PCD key for the ExMap hash table
+#
+#  FNV-1a over the seed and the key, both little endian, followed by the
+#  MurmurHash3 finalizer so that the low bits depend on the whole key. It must
+#  match PcdExMapHash () of the PCD PEIM and PCD driver.
+#
+#   @param      Seed     The hash seed
+#   @param      KeyBytes The token space GUID followed by the token number
+#
+#   @retval     The 32-bit hash value
+#
+def ExMapHash(Seed, KeyBytes):
+    Hash = 0x811C9DC5
+    for Byte in bytearray(pack('=L', Seed) + KeyBytes):
+        Hash = ((Hash ^ Byte) * 0x01000193) & 0xFFFFFFFF
+    Hash ^= Hash >> 16
+    Hash = (Hash * 0x85EBCA6B) & 0xFFFFFFFF
+    Hash ^= Hash >> 13
+    Hash = (Hash * 0xC2B2AE35) & 0xFFFFFFFF
+    Hash ^= Hash >> 16
+    return Hash
+
+## Build the minimal perfect hash table of the ExMap table
+#
+#  The keys are hashed with seed 0 into BucketCount buckets. From the largest
+#  bucket down, each bucket gets the smallest seed that places all its keys in
+#  free and distinct slots of a table with one slot per key. A bucket holding a
+#  single key records the slot itself, with EXMAP_HASH_DIRECT set.
+#
+#   @param      ExMapTable    The ExMap table entries (ExToken, LocalToken, GuidIndex)
+#   @param      GuidTable     The GUID table in C structure format
+#   @param      ExTokenCount  The number of DynamicEx PCDs
+#
+#   @retval     The UINT32 list BucketCount, Displacement[BucketCount], ExMapIndex[ExTokenCount],
+#               or an empty list if there is no DynamicEx PCD, a key is not unique or
+#               no seed below EXMAP_HASH_MAX_SEED places a bucket.
+#
+def BuildExMapHashTable(ExMapTable, GuidTable, ExTokenCount):
+    if ExTokenCount == 0:
+        return []
+
+    Keys = []
+    for ExToken, _, GuidIndex in ExMapTable[:ExTokenCount]:
+        Guid = PackGUID(GuidStructureStringToGuidString(GuidTable[GetIntegerValue(GuidIndex)]).split('-'))
+        Keys.append(bytes(Guid) + pack('=L', GetIntegerValue(ExToken)))
+    if len(set(Keys)) != len(Keys):
+        return []
+
+    BucketCount = (ExTokenCount + 1) // 2
+    Buckets = [[] for _ in range(BucketCount)]
+    for Index, Key in enumerate(Keys):
+        Buckets[ExMapHash(0, Key) % BucketCount].append(Index)
+
+    Displacement = [0] * BucketCount
+    Slots = [None] * ExTokenCount
+    Order = sorted(range(BucketCount), key=lambda Bucket: len(Buckets[Bucket]), reverse=True)
+    for Bucket in Order:
+        if len(Buckets[Bucket]) < 2:
+            break
+        for Seed in range(1, EXMAP_HASH_MAX_SEED):
+            Placed = [ExMapHash(Seed, Keys[Index]) % ExTokenCount for Index in Buckets[Bucket]]
+            if len(set(Placed)) == len(Placed) and all(Slots[Slot] is None for Slot in Placed):
+                break
+        else:
+            return []
+        Displacement[Bucket] = Seed
+        for Index, Slot in zip(Buckets[Bucket], Placed):
+            Slots[Slot] = Index
+
+    FreeSlots = [Slot for Slot in range(ExTokenCount) if Slots[Slot] is None]
+    for Bucket in Order:
+        if len(Buckets[Bucket]) == 1:
+            Slot = FreeSlots.pop()
+            Displacement[Bucket] = EXMAP_HASH_DIRECT | Slot
+            Slots[Slot] = Buckets[Bucket][0]
+
+    return [BucketCount] + Displacement + Slots
+
 ## DbComItemList
 #
 # The DbComItemList is a special kind of DbItemList in case that the size of the List can not be computed by the
@@ -611,6 +695,8 @@ def BuildExDataBase(Dict):
     DbVpdHeadValue = DbComItemList(4, RawDataList = VpdHeadValue)
     ExMapTable = list(zip(Dict['EXMAPPING_TABLE_EXTOKEN'], Dict['EXMAPPING_TABLE_LOCAL_TOKEN'], Dict['EXMAPPING_TABLE_GUID_INDEX']))
     DbExMapTable = DbExMapTblItemList(8, RawDataList = ExMapTable)
+    ExMapHashTable = BuildExMapHashTable(ExMapTable, Dict['GUID_STRUCTURE'], GetIntegerValue(Dict['EX_TOKEN_NUMBER']))
+    DbExMapHashTable = DbItemList(4, RawDataList = ExMapHashTable)
     LocalTokenNumberTable = Dict['LOCAL_TOKEN_NUMBER_DB_VALUE']
     DbLocalTokenNumberTable = DbItemList(4, RawDataList = LocalTokenNumberTable)
     GuidTable = Dict['GUID_STRUCTURE']
@@ -675,16 +761,16 @@ def BuildExDataBase(Dict):
     DbUnInitValueBoolean = DbItemList(1, RawDataList = UnInitValueBoolean)
     PcdTokenNumberMap = Dict['PCD_ORDER_TOKEN_NUMBER_MAP']
 
-    DbNameTotle = ["SkuidValue",  "InitValueUint64", "VardefValueUint64", "InitValueUint32", "VardefValueUint32", "VpdHeadValue", "ExMapTable",
+    DbNameTotle = ["SkuidValue",  "InitValueUint64", "VardefValueUint64", "InitValueUint32", "VardefValueUint32", "VpdHeadValue", "ExMapTable", "ExMapHashTable",
                "LocalTokenNumberTable", "GuidTable", "StringHeadValue",  "PcdNameOffsetTable", "VariableTable", "StringTableLen", "PcdTokenTable", "PcdCNameTable",
                "SizeTableValue", "InitValueUint16", "VardefValueUint16", "InitValueUint8", "VardefValueUint8", "InitValueBoolean",
                "VardefValueBoolean", "UnInitValueUint64", "UnInitValueUint32", "UnInitValueUint16", "UnInitValueUint8", "UnInitValueBoolean"]
 
-    DbTotal = [SkuidValue,  InitValueUint64, VardefValueUint64, InitValueUint32, VardefValueUint32, VpdHeadValue, ExMapTable,
+    DbTotal = [SkuidValue,  InitValueUint64, VardefValueUint64, InitValueUint32, VardefValueUint32, VpdHeadValue, ExMapTable, ExMapHashTable,
                LocalTokenNumberTable, GuidTable, StringHeadValue,  PcdNameOffsetTable, VariableTable, StringTableLen, PcdTokenTable, PcdCNameTable,
                SizeTableValue, InitValueUint16, VardefValueUint16, InitValueUint8, VardefValueUint8, InitValueBoolean,
                VardefValueBoolean, UnInitValueUint64, UnInitValueUint32, UnInitValueUint16, UnInitValueUint8, UnInitValueBoolean]
-    DbItemTotal = [DbSkuidValue,  DbInitValueUint64, DbVardefValueUint64, DbInitValueUint32, DbVardefValueUint32, DbVpdHeadValue, DbExMapTable,
+    DbItemTotal = [DbSkuidValue,  DbInitValueUint64, DbVardefValueUint64, DbInitValueUint32, DbVardefValueUint32, DbVpdHeadValue, DbExMapTable, DbExMapHashTable,
                DbLocalTokenNumberTable, DbGuidTable, DbStringHeadValue,  DbPcdNameOffsetTable, DbVariableTable, DbStringTableLen, DbPcdTokenTable, DbPcdCNameTable,
                DbSizeTableValue, DbInitValueUint16, DbVardefValueUint16, DbInitValueUint8, DbVardefValueUint8, DbInitValueBoolean,
                DbVardefValueBoolean, DbUnInitValueUint64, DbUnInitValueUint32, DbUnInitValueUint16, DbUnInitValueUint8, DbUnInitValueBoolean]
@@ -754,11 +840,15 @@ def BuildExDataBase(Dict):
 
     # calculate various table offset now
     DbTotalLength = FixedHeaderLen
+    ExMapHashTableOffset = 0
     for DbIndex in range(len(DbItemTotal)):
         if DbItemTotal[DbIndex] is DbLocalTokenNumberTable:
             LocalTokenNumberTableOffset = DbTotalLength
         elif DbItemTotal[DbIndex] is DbExMapTable:
             ExMapTableOffset = DbTotalLength
+        elif DbItemTotal[DbIndex] is DbExMapHashTable:
+            if ExMapHashTable:
+                ExMapHashTableOffset = DbTotalLength
         elif DbItemTotal[DbIndex] is DbGuidTable:
             GuidTableOffset = DbTotalLength
         elif DbItemTotal[DbIndex] is DbStringTableLen:
@@ -839,9 +929,8 @@ def BuildExDataBase(Dict):
     b = pack('=B', Pad)
     Buffer += b
     Buffer += b
-    Buffer += b
-    Buffer += b
-    Buffer += b
+
+    b = pack('=L', ExMapHashTableOffset)
     Buffer += b
 
     Index = 0
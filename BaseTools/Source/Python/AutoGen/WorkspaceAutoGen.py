@@ -899,6 +899,8 @@ class WorkspaceAutoGen(AutoGen):
             FdsCommandDict["quiet"] = True
 
         FdsCommandDict["GenfdsMultiThread"] = GlobalData.gEnableGenfdsMultiThread
+        FdsCommandDict["GenfdsMultiThreadFv"] = GlobalData.gEnableGenfdsMultiThreadFv
+        FdsCommandDict["thread_number"] = GlobalData.gThreadNumber
         if GlobalData.gIgnoreSource:
             FdsCommandDict["IgnoreSources"] = True
 
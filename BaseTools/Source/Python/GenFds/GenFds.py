@@ -18,6 +18,9 @@ from glob import glob
 from struct import unpack
 from linecache import getlines
 from io import BytesIO
+from concurrent.futures import ThreadPoolExecutor, wait, FIRST_COMPLETED
+from multiprocessing import cpu_count
+import threading
 
 import Common.LongFilePathOs as os
 from Common.TargetTxtClassObject import TargetTxtDict,gDefaultTargetTxtFile
@@ -35,6 +38,8 @@ from Workspace.WorkspaceDatabase import WorkspaceDatabase
 from .FdfParser import FdfParser, Warning
 from .GenFdsGlobalVariable import GenFdsGlobalVariable
 from .FfsFileStatement import FileStatement
+from .FfsInfStatement import FfsInfStatement
+from .FvImageSection import FvImageSection
 import Common.DataType as DataType
 from struct import Struct
 
@@ -95,7 +100,7 @@ def resetFdsGlobalVariable():
     GenFdsGlobalVariable.ModuleFile = ''
     GenFdsGlobalVariable.EnableGenfdsMultiThread = True
 
-    GenFdsGlobalVariable.LargeFileInFvFlags = []
+    GenFdsGlobalVariable.ThreadData = threading.local()
     GenFdsGlobalVariable.EFI_FIRMWARE_FILE_SYSTEM3_GUID = '5473C07A-3DCB-4dca-BD6F-1E9689E7349A'
     GenFdsGlobalVariable.LARGE_FILE_SIZE = 0x1000000
 
@@ -142,6 +147,14 @@ def GenFdsApi(FdsCommandDict, WorkSpaceDataBase=None):
                 GenFdsGlobalVariable.EnableGenfdsMultiThread = True
             else:
                 GenFdsGlobalVariable.EnableGenfdsMultiThread = False
+            GenFds.MultiThreadFv = bool(FdsCommandDict.get("GenfdsMultiThreadFv"))
+            if FdsCommandDict.get("thread_number") is not None and FdsCommandDict.get("thread_number") > 0:
+                GenFds.ThreadNumber = FdsCommandDict.get("thread_number")
+            else:
+                try:
+                    GenFds.ThreadNumber = cpu_count()
+                except NotImplementedError:
+                    GenFds.ThreadNumber = 1
         os.chdir(GenFdsGlobalVariable.WorkSpaceDir)
 
         # set multiple workspace
@@ -407,6 +420,8 @@ def OptionsToCommandDict(Options):
     FdsCommandDict["debug"] = Options.debug
     FdsCommandDict["Workspace"] = Options.Workspace
     FdsCommandDict["GenfdsMultiThread"] = not Options.NoGenfdsMultiThread
+    FdsCommandDict["GenfdsMultiThreadFv"] = Options.GenfdsMultiThreadFv
+    FdsCommandDict["thread_number"] = Options.ThreadNumber
     FdsCommandDict["fdf_file"] = [PathClass(Options.filename)] if Options.filename else []
     FdsCommandDict["build_target"] = Options.BuildTarget
     FdsCommandDict["toolchain_tag"] = Options.ToolChain
@@ -465,6 +480,9 @@ def myOptionParser():
     Parser.add_option("--pcd", action="append", dest="OptionPcd", help="Set PCD value by command line. Format: \"PcdName=Value\" ")
     Parser.add_option("--genfds-multi-thread", action="store_true", dest="GenfdsMultiThread", default=True, help="Enable GenFds multi thread to generate ffs file.")
     Parser.add_option("--no-genfds-multi-thread", action="store_true", dest="NoGenfdsMultiThread", default=False, help="Disable GenFds multi thread to generate ffs file.")
+    Parser.add_option("--genfds-multi-thread-fv", action="store_true", dest="GenfdsMultiThreadFv", default=False, help="Generate the FV images that are not in an FD region on multiple threads.")
+    Parser.add_option("-n", "--thread-number", action="store", type="int", dest="ThreadNumber", help="Number of threads used by --genfds-multi-thread-fv. "\
+                      "0 or less means the number of processors of the host, which is the default.")
 
     Options, _ = Parser.parse_args()
     return Options
@@ -481,6 +499,8 @@ class GenFds(object):
     OnlyGenerateThisFd = None
     OnlyGenerateThisFv = None
     OnlyGenerateThisCap = None
+    MultiThreadFv = False
+    ThreadNumber = 1
 
     ## GenFd()
     #
@@ -506,6 +526,8 @@ class GenFds(object):
                 FdObj.GenFd()
                 return
         elif GenFds.OnlyGenerateThisFd is None and GenFds.OnlyGenerateThisFv is None:
+            if GenFds.OnlyGenerateThisCap is None and GenFds.MultiThreadFv and GenFds.ThreadNumber > 1:
+                GenFds.GenFvConcurrently(GenFds.ThreadNumber)
             for FdObj in GenFdsGlobalVariable.FdfParser.Profile.FdDict.values():
                 FdObj.GenFd()
 
@@ -534,6 +556,137 @@ class GenFds(object):
                 for OptRomObj in GenFdsGlobalVariable.FdfParser.Profile.OptRomDict.values():
                     OptRomObj.AddToBuffer(None)
 
+    ## GetFvReferences()
+    #
+    #   @param  SectionList     Sections to look into, recursively
+    #   @param  FvNameSet       Set the names of the nested FVs are added to
+    #   @retval bool            False if a section depends on an FD image
+    #
+    @staticmethod
+    def GetFvReferences(SectionList, FvNameSet):
+        Supported = True
+        for Sect in SectionList:
+            if isinstance(Sect, FvImageSection) and Sect.FvName:
+                FvNameSet.add(Sect.FvName.upper())
+            elif getattr(Sect, 'FdName', None):
+                Supported = False
+            if getattr(Sect, 'SectionList', None):
+                if not GenFds.GetFvReferences(Sect.SectionList, FvNameSet):
+                    Supported = False
+        return Supported
+
+    ## GenFvConcurrently()
+    #
+    #   Generate the FV images that are not placed in an FD region ahead of the
+    #   FDs, on ThreadNumber threads, so that the external tools of independent
+    #   FVs, e.g. the compressors of the GUIDed sections, run concurrently.
+    #
+    #   Only the FVs that are not nested in another FV are started here. A nested
+    #   FV is generated by the thread of its parent, through the FV_IMAGE section,
+    #   so it gets the macros of the parent as in the serial generation. An FV is
+    #   started once no running FV shares a module, a FILE statement output or a
+    #   nested FV with it, including the ones of its nested FVs. The serial
+    #   generation that follows then takes these FVs from
+    #   GenFdsGlobalVariable.ImageBinDict.
+    #
+    #   @param  ThreadNumber    Maximum number of FVs generated at a time
+    #
+    @staticmethod
+    def GenFvConcurrently(ThreadNumber):
+        FvDict = GenFdsGlobalVariable.FdfParser.Profile.FvDict
+        FdFvNames = set()
+        for FdObj in GenFdsGlobalVariable.FdfParser.Profile.FdDict.values():
+            for RegionObj in FdObj.RegionList:
+                if RegionObj.RegionType == BINARY_FILE_TYPE_FV:
+                    for RegionData in RegionObj.RegionDataList:
+                        FdFvNames.add(RegionData.upper())
+
+        Depends = {}
+        Resources = {}
+        AllNestedFvNames = set()
+        for FvName, FvObj in FvDict.items():
+            NestedFvNames = set()
+            ModuleFiles = set()
+            Supported = True
+            for FfsFile in FvObj.FfsList:
+                if isinstance(FfsFile, FfsInfStatement):
+                    ModuleFiles.add(os.path.normcase(os.path.normpath(FfsFile.InfFileName)))
+                elif isinstance(FfsFile, FileStatement):
+                    #
+                    # A FILE statement writes its FFS file below FfsDir/NameGuid
+                    #
+                    ModuleFiles.add(os.path.normcase(os.path.normpath(os.path.join(GenFdsGlobalVariable.FfsDir, FfsFile.NameGuid.upper()))))
+                    if FfsFile.FdName:
+                        Supported = False
+                    if FfsFile.FvName:
+                        NestedFvNames.add(FfsFile.FvName.upper())
+                    if not GenFds.GetFvReferences(FfsFile.SectionList, NestedFvNames):
+                        Supported = False
+            AllNestedFvNames |= NestedFvNames
+            if FvName in FdFvNames or FvObj.FvBaseAddress is not None or FvObj.BaseAddress is not None:
+                continue
+            if Supported:
+                Depends[FvName] = NestedFvNames
+                Resources[FvName] = ModuleFiles | NestedFvNames | {FvName}
+
+        #
+        # Drop the FVs nesting an FV that has to be generated in its FD region
+        #
+        Changed = True
+        while Changed:
+            Changed = False
+            for FvName in list(Depends):
+                if not Depends[FvName] <= set(Depends):
+                    del Depends[FvName]
+                    Changed = True
+
+        #
+        # A parent FV also generates the modules of the FVs nested in it
+        #
+        Changed = True
+        while Changed:
+            Changed = False
+            for FvName in Depends:
+                for NestedFvName in Depends[FvName]:
+                    if not Resources[NestedFvName] <= Resources[FvName]:
+                        Resources[FvName] |= Resources[NestedFvName]
+                        Changed = True
+
+        Pending = [FvName for FvName in FvDict if FvName in Depends and FvName not in AllNestedFvNames]
+        if len(Pending) < 2:
+            return
+
+        GenFdsGlobalVariable.VerboseLogger("\n Generate FV images on %d threads!" % ThreadNumber)
+        Running = {}
+        with ThreadPoolExecutor(max_workers=ThreadNumber) as Executor:
+            while Pending or Running:
+                Busy = set()
+                for FvName in Running.values():
+                    Busy |= Resources[FvName]
+                for FvName in list(Pending):
+                    if len(Running) >= ThreadNumber:
+                        break
+                    if not (Resources[FvName] & Busy):
+                        Running[Executor.submit(GenFds.GenFvToBuffer, FvDict[FvName])] = FvName
+                        Busy |= Resources[FvName]
+                        Pending.remove(FvName)
+                if not Running:
+                    break
+                Finished, _ = wait(Running, return_when=FIRST_COMPLETED)
+                for Future in Finished:
+                    Running.pop(Future)
+                    Future.result()
+
+    ## GenFvToBuffer()
+    #
+    #   @param  FvObj           FV to generate
+    #
+    @staticmethod
+    def GenFvToBuffer(FvObj):
+        Buffer = BytesIO()
+        FvObj.AddToBuffer(Buffer)
+        Buffer.close()
+
     @staticmethod
     def GenFfsMakefile(OutputDir, FdfParserObject, WorkSpace, ArchList, GlobalData):
         GenFdsGlobalVariable.SetEnv(FdfParserObject, WorkSpace, ArchList, GlobalData)
@@ -0,0 +1,156 @@
+## @file
+# Unit tests for the concurrent generation of the FV images in GenFds
+#
+#  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+#
+#  SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import sys
+import threading
+import time
+import unittest
+from types import SimpleNamespace
+
+import TestTools
+
+from GenFds.GenFds import GenFds, myOptionParser, OptionsToCommandDict
+from GenFds.GenFdsGlobalVariable import GenFdsGlobalVariable
+from GenFds.FfsInfStatement import FfsInfStatement
+from GenFds.FfsFileStatement import FileStatement
+from GenFds.FvImageSection import FvImageSection
+
+def Inf(InfFileName):
+    Ffs = FfsInfStatement()
+    Ffs.InfFileName = InfFileName
+    return Ffs
+
+def NestedFv(NameGuid, FvName):
+    Sect = FvImageSection()
+    Sect.FvName = FvName
+    Ffs = FileStatement()
+    Ffs.NameGuid = NameGuid
+    Ffs.SectionList = [Sect]
+    return Ffs
+
+def Fv(Name, FfsList):
+    return SimpleNamespace(UiFvName=Name, FfsList=FfsList, FvBaseAddress=None, BaseAddress=None)
+
+class GenFvConcurrentlyTestCase(unittest.TestCase):
+
+    def setUp(self):
+        self.SavedFdfParser = GenFdsGlobalVariable.FdfParser
+        self.SavedFfsDir = GenFdsGlobalVariable.FfsDir
+        self.SavedGenFvToBuffer = GenFds.GenFvToBuffer
+        GenFdsGlobalVariable.FfsDir = 'Ffs'
+        self.Lock = threading.Lock()
+        self.Started = []
+        self.Running = set()
+        self.Overlaps = []
+        GenFds.GenFvToBuffer = staticmethod(self.GenFvToBuffer)
+
+    def tearDown(self):
+        GenFdsGlobalVariable.FdfParser = self.SavedFdfParser
+        GenFdsGlobalVariable.FfsDir = self.SavedFfsDir
+        GenFds.GenFvToBuffer = self.SavedGenFvToBuffer
+
+    def GenFvToBuffer(self, FvObj):
+        with self.Lock:
+            self.Started.append(FvObj.UiFvName)
+            self.Overlaps.append(frozenset(self.Running | {FvObj.UiFvName}))
+            self.Running.add(FvObj.UiFvName)
+        time.sleep(0.05)
+        with self.Lock:
+            self.Running.remove(FvObj.UiFvName)
+
+    def SetProfile(self, FvList, FdFvNames=()):
+        Regions = [SimpleNamespace(RegionType='FV', RegionDataList=list(FdFvNames))]
+        GenFdsGlobalVariable.FdfParser = SimpleNamespace(Profile=SimpleNamespace(
+            FvDict=dict((FvObj.UiFvName, FvObj) for FvObj in FvList),
+            FdDict={'FD': SimpleNamespace(RegionList=Regions)}
+            ))
+
+    def RanTogether(self, FvNameA, FvNameB):
+        return any(FvNameA in Overlap and FvNameB in Overlap for Overlap in self.Overlaps)
+
+    def testIndependentFvsRunConcurrently(self):
+        self.SetProfile([Fv('FVA', [Inf('A.inf')]), Fv('FVB', [Inf('B.inf')])])
+        GenFds.GenFvConcurrently(2)
+        self.assertEqual(sorted(self.Started), ['FVA', 'FVB'])
+        self.assertTrue(self.RanTogether('FVA', 'FVB'))
+
+    def testSharedModuleIsNotGeneratedConcurrently(self):
+        self.SetProfile([
+            Fv('FVA', [Inf('A.inf'), Inf('Common.inf')]),
+            Fv('FVB', [Inf('B.inf'), Inf('Common.inf')]),
+            Fv('FVC', [Inf('C.inf')])
+            ])
+        GenFds.GenFvConcurrently(3)
+        self.assertEqual(sorted(self.Started), ['FVA', 'FVB', 'FVC'])
+        self.assertFalse(self.RanTogether('FVA', 'FVB'))
+
+    def testSharedFileStatementIsNotGeneratedConcurrently(self):
+        Guid = '11111111-2222-3333-4444-555555555555'
+        FileA = FileStatement()
+        FileA.NameGuid = Guid
+        FileB = FileStatement()
+        FileB.NameGuid = Guid
+        self.SetProfile([Fv('FVA', [FileA]), Fv('FVB', [FileB])])
+        GenFds.GenFvConcurrently(2)
+        self.assertFalse(self.RanTogether('FVA', 'FVB'))
+
+    def testNestedFvIsGeneratedByItsParent(self):
+        self.SetProfile([
+            Fv('PARENT', [Inf('A.inf'), NestedFv('AAAAAAAA-2222-3333-4444-555555555555', 'NESTED')]),
+            Fv('NESTED', [Inf('Nested.inf')]),
+            Fv('OTHER', [Inf('Other.inf')])
+            ])
+        GenFds.GenFvConcurrently(3)
+        self.assertEqual(sorted(self.Started), ['OTHER', 'PARENT'])
+
+    def testParentConflictsWithModulesOfNestedFv(self):
+        self.SetProfile([
+            Fv('PARENT', [NestedFv('AAAAAAAA-2222-3333-4444-555555555555', 'NESTED')]),
+            Fv('NESTED', [Inf('Common.inf')]),
+            Fv('OTHER', [Inf('Common.inf')])
+            ])
+        GenFds.GenFvConcurrently(2)
+        self.assertEqual(sorted(self.Started), ['OTHER', 'PARENT'])
+        self.assertFalse(self.RanTogether('OTHER', 'PARENT'))
+
+    def testFvNestingFdRegionFvIsLeftToSerialGeneration(self):
+        self.SetProfile([
+            Fv('PARENT', [NestedFv('AAAAAAAA-2222-3333-4444-555555555555', 'FVMAIN')]),
+            Fv('FVMAIN', [Inf('Main.inf')]),
+            Fv('FVA', [Inf('A.inf')]),
+            Fv('FVB', [Inf('B.inf')])
+            ], FdFvNames=['FVMAIN'])
+        GenFds.GenFvConcurrently(2)
+        self.assertEqual(sorted(self.Started), ['FVA', 'FVB'])
+
+    def testFvWithBaseAddressIsLeftToSerialGeneration(self):
+        Fixed = Fv('FIXED', [Inf('Fixed.inf')])
+        Fixed.FvBaseAddress = '0xFFF00000'
+        self.SetProfile([Fixed, Fv('FVA', [Inf('A.inf')]), Fv('FVB', [Inf('B.inf')])])
+        GenFds.GenFvConcurrently(2)
+        self.assertEqual(sorted(self.Started), ['FVA', 'FVB'])
+
+class GenFdsMultiThreadFvOptionTestCase(unittest.TestCase):
+
+    def testMultiThreadFvIsOffByDefault(self):
+        SavedArgv = sys.argv
+        try:
+            sys.argv = ['GenFds']
+            FdsCommandDict = OptionsToCommandDict(myOptionParser())
+        finally:
+            sys.argv = SavedArgv
+        self.assertFalse(FdsCommandDict["GenfdsMultiThreadFv"])
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
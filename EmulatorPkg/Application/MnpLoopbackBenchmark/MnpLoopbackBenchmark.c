@@ -0,0 +1,264 @@
+/** @file
+  Measure the number of packets per second received through MNP.
+
+  The frames are sent by MNP to its own MAC address and looped back by
+  EmuSnpDxe when PcdEmuSnpLoopback is TRUE. The receive rate is measured once
+  with the MNP system poll timer only and once polling MNP after each frame.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/NetLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include <Protocol/ManagedNetwork.h>
+
+#define BENCHMARK_ETHER_TYPE    0x88B5    // IEEE 802 local experimental
+#define BENCHMARK_DATA_LENGTH   1024
+#define BENCHMARK_RX_TOKEN_NUM  16
+#define BENCHMARK_SECONDS       5
+
+EFI_MANAGED_NETWORK_PROTOCOL          *mMnp;
+EFI_MANAGED_NETWORK_COMPLETION_TOKEN  mRxToken[BENCHMARK_RX_TOKEN_NUM];
+BOOLEAN                               mStopping;
+UINT64                                mReceived;
+UINT8                                 mTxData[BENCHMARK_DATA_LENGTH];
+
+/**
+  Count the received packet, recycle it and post the token again.
+
+  @param[in]  Event    The receive token event.
+  @param[in]  Context  Pointer to the receive token.
+
+**/
+VOID
+EFIAPI
+BenchmarkRxNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EFI_MANAGED_NETWORK_COMPLETION_TOKEN  *Token;
+
+  Token = (EFI_MANAGED_NETWORK_COMPLETION_TOKEN *)Context;
+  if (EFI_ERROR (Token->Status)) {
+    return;
+  }
+
+  mReceived++;
+  gBS->SignalEvent (Token->Packet.RxData->RecycleEvent);
+
+  if (!mStopping) {
+    mMnp->Receive (mMnp, Token);
+  }
+}
+
+/**
+  Send frames to the station address for BENCHMARK_SECONDS and print the
+  number of frames received per second.
+
+  @param[in]  Poll     Whether to call Poll() after each frame.
+  @param[in]  Station  The station address of the MNP.
+
+  @retval EFI_SUCCESS  The rate has been measured.
+  @retval Others       Failed to set up the measurement.
+
+**/
+EFI_STATUS
+BenchmarkRun (
+  IN BOOLEAN          Poll,
+  IN EFI_MAC_ADDRESS  *Station
+  )
+{
+  EFI_STATUS                            Status;
+  EFI_MANAGED_NETWORK_CONFIG_DATA       Config;
+  EFI_MANAGED_NETWORK_COMPLETION_TOKEN  TxToken;
+  EFI_MANAGED_NETWORK_TRANSMIT_DATA     TxData;
+  EFI_EVENT                             Timer;
+  UINT64                                Sent;
+  UINTN                                 Index;
+
+  ZeroMem (&Config, sizeof (Config));
+  Config.ProtocolTypeFilter       = BENCHMARK_ETHER_TYPE;
+  Config.EnableUnicastReceive     = TRUE;
+  Config.FlushQueuesOnReset       = TRUE;
+  Config.DisableBackgroundPolling = Poll;
+
+  Status = mMnp->Configure (mMnp, &Config);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  mStopping = FALSE;
+  mReceived = 0;
+  for (Index = 0; Index < BENCHMARK_RX_TOKEN_NUM; Index++) {
+    Status = mMnp->Receive (mMnp, &mRxToken[Index]);
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+  }
+
+  ZeroMem (&TxToken, sizeof (TxToken));
+  ZeroMem (&TxData, sizeof (TxData));
+  TxData.DestinationAddress              = Station;
+  TxData.ProtocolType                    = BENCHMARK_ETHER_TYPE;
+  TxData.DataLength                      = BENCHMARK_DATA_LENGTH;
+  TxData.FragmentCount                   = 1;
+  TxData.FragmentTable[0].FragmentLength = BENCHMARK_DATA_LENGTH;
+  TxData.FragmentTable[0].FragmentBuffer = mTxData;
+  TxToken.Packet.TxData                  = &TxData;
+
+  Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &TxToken.Event);
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER, TPL_CALLBACK, NULL, NULL, &Timer);
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (TxToken.Event);
+    goto ON_EXIT;
+  }
+
+  gBS->SetTimer (Timer, TimerRelative, EFI_TIMER_PERIOD_SECONDS (BENCHMARK_SECONDS));
+
+  Sent = 0;
+  while (gBS->CheckEvent (Timer) == EFI_NOT_READY) {
+    if (!EFI_ERROR (mMnp->Transmit (mMnp, &TxToken)) && !EFI_ERROR (TxToken.Status)) {
+      Sent++;
+    }
+
+    if (Poll) {
+      mMnp->Poll (mMnp);
+    }
+  }
+
+  mStopping = TRUE;
+  gBS->CloseEvent (Timer);
+  gBS->CloseEvent (TxToken.Event);
+
+  Print (
+    L"%s polling: %ld frames sent, %ld received, %ld packets/sec\n",
+    Poll ? L"Explicit" : L"System",
+    Sent,
+    mReceived,
+    DivU64x32 (mReceived, BENCHMARK_SECONDS)
+    );
+
+ON_EXIT:
+  mStopping = TRUE;
+  mMnp->Cancel (mMnp, NULL);
+  mMnp->Configure (mMnp, NULL);
+  return Status;
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the application.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The entry point is executed successfully.
+  @retval other             Some error occurs when executing this entry point.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS               Status;
+  EFI_HANDLE               *Handles;
+  UINTN                    HandleCount;
+  EFI_HANDLE               ChildHandle;
+  EFI_SIMPLE_NETWORK_MODE  SnpMode;
+  EFI_MAC_ADDRESS          Station;
+  UINTN                    Index;
+
+  Status = gBS->LocateHandleBuffer (
+                  ByProtocol,
+                  &gEfiManagedNetworkServiceBindingProtocolGuid,
+                  NULL,
+                  &HandleCount,
+                  &Handles
+                  );
+  if (EFI_ERROR (Status)) {
+    Print (L"No MNP service found, %r\n", Status);
+    return Status;
+  }
+
+  ChildHandle = NULL;
+  Status      = NetLibCreateServiceChild (
+                  Handles[0],
+                  ImageHandle,
+                  &gEfiManagedNetworkServiceBindingProtocolGuid,
+                  &ChildHandle
+                  );
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  Status = gBS->HandleProtocol (ChildHandle, &gEfiManagedNetworkProtocolGuid, (VOID **)&mMnp);
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  Status = mMnp->GetModeData (mMnp, NULL, &SnpMode);
+  if (EFI_ERROR (Status) && (Status != EFI_NOT_STARTED)) {
+    goto ON_EXIT;
+  }
+
+  CopyMem (&Station, &SnpMode.CurrentAddress, sizeof (Station));
+
+  for (Index = 0; Index < BENCHMARK_RX_TOKEN_NUM; Index++) {
+    Status = gBS->CreateEvent (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    BenchmarkRxNotify,
+                    &mRxToken[Index],
+                    &mRxToken[Index].Event
+                    );
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+  }
+
+  Status = BenchmarkRun (FALSE, &Station);
+  if (!EFI_ERROR (Status)) {
+    Status = BenchmarkRun (TRUE, &Station);
+  }
+
+  if (EFI_ERROR (Status)) {
+    Print (L"Benchmark failed, %r\n", Status);
+  }
+
+ON_EXIT:
+  for (Index = 0; Index < BENCHMARK_RX_TOKEN_NUM; Index++) {
+    if (mRxToken[Index].Event != NULL) {
+      gBS->CloseEvent (mRxToken[Index].Event);
+    }
+  }
+
+  if (ChildHandle != NULL) {
+    NetLibDestroyServiceChild (
+      Handles[0],
+      ImageHandle,
+      &gEfiManagedNetworkServiceBindingProtocolGuid,
+      ChildHandle
+      );
+  }
+
+  FreePool (Handles);
+  return Status;
+}
@@ -0,0 +1,299 @@
+/** @file
+  Measure the TCP receive throughput from a server on the host network.
+
+  Usage: TcpThroughput <ServerIp> <Port> [Seconds]
+
+  The application connects to the server, for example "nc -l 5001 < /dev/zero"
+  running on the host, receives for the given number of seconds and prints the
+  throughput. Set PcdEmuNetworkReceiveDelay to emulate a long round trip time.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/NetLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include <Protocol/ShellParameters.h>
+#include <Protocol/Tcp4.h>
+
+#define THROUGHPUT_BUFFER_SIZE      0x10000
+#define THROUGHPUT_DEFAULT_SECONDS  10
+
+EFI_TCP4_PROTOCOL  *mTcp4;
+BOOLEAN            mRxDone;
+UINT8              mRxBuffer[THROUGHPUT_BUFFER_SIZE];
+
+/**
+  Notify function of the TCP tokens, marks the token as completed.
+
+  @param[in]  Event    The token event.
+  @param[in]  Context  Pointer to the BOOLEAN to set.
+
+**/
+VOID
+EFIAPI
+ThroughputNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  *(BOOLEAN *)Context = TRUE;
+}
+
+/**
+  Connect to the server and configure the TCP4 instance.
+
+  @param[in]  Server     The IPv4 address of the server.
+  @param[in]  Port       The TCP port of the server.
+
+  @retval EFI_SUCCESS  The connection is established.
+  @retval Others       Failed to connect.
+
+**/
+EFI_STATUS
+ThroughputConnect (
+  IN EFI_IPv4_ADDRESS  *Server,
+  IN UINT16            Port
+  )
+{
+  EFI_STATUS                 Status;
+  EFI_TCP4_CONFIG_DATA       Config;
+  EFI_TCP4_OPTION            Option;
+  EFI_TCP4_CONNECTION_TOKEN  ConnToken;
+  BOOLEAN                    Done;
+
+  ZeroMem (&Option, sizeof (Option));
+  Option.ReceiveBufferSize   = 0x200000;
+  Option.SendBufferSize      = 0x200000;
+  Option.EnableWindowScaling = TRUE;
+  Option.EnableTimeStamp     = TRUE;
+  Option.EnableSelectiveAck  = TRUE;
+
+  ZeroMem (&Config, sizeof (Config));
+  Config.TypeOfService                 = 8;
+  Config.TimeToLive                    = 255;
+  Config.AccessPoint.UseDefaultAddress = TRUE;
+  Config.AccessPoint.RemotePort        = Port;
+  Config.AccessPoint.ActiveFlag        = TRUE;
+  Config.ControlOption                 = &Option;
+  CopyMem (&Config.AccessPoint.RemoteAddress, Server, sizeof (EFI_IPv4_ADDRESS));
+
+  //
+  // The default address may not be ready until the DHCP process is done.
+  //
+  do {
+    Status = mTcp4->Configure (mTcp4, &Config);
+  } while (Status == EFI_NO_MAPPING);
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Done = FALSE;
+  ZeroMem (&ConnToken, sizeof (ConnToken));
+  Status = gBS->CreateEvent (EVT_NOTIFY_SIGNAL, TPL_CALLBACK, ThroughputNotify, &Done, &ConnToken.CompletionToken.Event);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = mTcp4->Connect (mTcp4, &ConnToken);
+  if (!EFI_ERROR (Status)) {
+    while (!Done) {
+      mTcp4->Poll (mTcp4);
+    }
+
+    Status = ConnToken.CompletionToken.Status;
+  }
+
+  gBS->CloseEvent (ConnToken.CompletionToken.Event);
+  return Status;
+}
+
+/**
+  Receive from the server for the given time and print the throughput.
+
+  @param[in]  Seconds    The time to receive.
+
+  @retval EFI_SUCCESS  The throughput has been measured.
+  @retval Others       Failed to receive.
+
+**/
+EFI_STATUS
+ThroughputReceive (
+  IN UINTN  Seconds
+  )
+{
+  EFI_STATUS             Status;
+  EFI_TCP4_IO_TOKEN      RxToken;
+  EFI_TCP4_RECEIVE_DATA  RxData;
+  EFI_EVENT              Timer;
+  UINT64                 Received;
+
+  ZeroMem (&RxToken, sizeof (RxToken));
+  Status = gBS->CreateEvent (EVT_NOTIFY_SIGNAL, TPL_CALLBACK, ThroughputNotify, &mRxDone, &RxToken.CompletionToken.Event);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->CreateEvent (EVT_TIMER, TPL_CALLBACK, NULL, NULL, &Timer);
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (RxToken.CompletionToken.Event);
+    return Status;
+  }
+
+  gBS->SetTimer (Timer, TimerRelative, MultU64x32 (EFI_TIMER_PERIOD_SECONDS (1), (UINT32)Seconds));
+
+  Received              = 0;
+  RxToken.Packet.RxData = &RxData;
+
+  while (gBS->CheckEvent (Timer) == EFI_NOT_READY) {
+    ZeroMem (&RxData, sizeof (RxData));
+    RxData.DataLength                      = THROUGHPUT_BUFFER_SIZE;
+    RxData.FragmentCount                   = 1;
+    RxData.FragmentTable[0].FragmentLength = THROUGHPUT_BUFFER_SIZE;
+    RxData.FragmentTable[0].FragmentBuffer = mRxBuffer;
+
+    mRxDone = FALSE;
+    Status  = mTcp4->Receive (mTcp4, &RxToken);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    while (!mRxDone && (gBS->CheckEvent (Timer) == EFI_NOT_READY)) {
+    }
+
+    if (!mRxDone) {
+      mTcp4->Cancel (mTcp4, &RxToken.CompletionToken);
+      break;
+    }
+
+    Status = RxToken.CompletionToken.Status;
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Received += RxData.DataLength;
+  }
+
+  gBS->CloseEvent (Timer);
+  gBS->CloseEvent (RxToken.CompletionToken.Event);
+
+  Print (
+    L"%ld bytes received in %d seconds, %ld KB/s\n",
+    Received,
+    Seconds,
+    DivU64x32 (Received, (UINT32)(Seconds * 1024))
+    );
+
+  return (Received != 0) ? EFI_SUCCESS : Status;
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the application.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The entry point is executed successfully.
+  @retval other             Some error occurs when executing this entry point.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_SHELL_PARAMETERS_PROTOCOL  *ShellParameters;
+  EFI_IPv4_ADDRESS               Server;
+  UINTN                          Port;
+  UINTN                          Seconds;
+  EFI_HANDLE                     *Handles;
+  UINTN                          HandleCount;
+  EFI_HANDLE                     ChildHandle;
+
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiShellParametersProtocolGuid, (VOID **)&ShellParameters);
+  if (EFI_ERROR (Status) || (ShellParameters->Argc < 3) ||
+      EFI_ERROR (NetLibStrToIp4 (ShellParameters->Argv[1], &Server)))
+  {
+    Print (L"Usage: TcpThroughput <ServerIp> <Port> [Seconds]\n");
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Port    = StrDecimalToUintn (ShellParameters->Argv[2]);
+  Seconds = THROUGHPUT_DEFAULT_SECONDS;
+  if (ShellParameters->Argc > 3) {
+    Seconds = StrDecimalToUintn (ShellParameters->Argv[3]);
+  }
+
+  if ((Port == 0) || (Port > MAX_UINT16) || (Seconds == 0) || (Seconds > MAX_UINT16)) {
+    Print (L"Invalid port or time\n");
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = gBS->LocateHandleBuffer (
+                  ByProtocol,
+                  &gEfiTcp4ServiceBindingProtocolGuid,
+                  NULL,
+                  &HandleCount,
+                  &Handles
+                  );
+  if (EFI_ERROR (Status)) {
+    Print (L"No TCP4 service found, %r\n", Status);
+    return Status;
+  }
+
+  ChildHandle = NULL;
+  Status      = NetLibCreateServiceChild (
+                  Handles[0],
+                  ImageHandle,
+                  &gEfiTcp4ServiceBindingProtocolGuid,
+                  &ChildHandle
+                  );
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  Status = gBS->HandleProtocol (ChildHandle, &gEfiTcp4ProtocolGuid, (VOID **)&mTcp4);
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  Status = ThroughputConnect (&Server, (UINT16)Port);
+  if (EFI_ERROR (Status)) {
+    Print (L"Failed to connect, %r\n", Status);
+    goto ON_EXIT;
+  }
+
+  Status = ThroughputReceive (Seconds);
+  if (EFI_ERROR (Status)) {
+    Print (L"Failed to receive, %r\n", Status);
+  }
+
+  mTcp4->Configure (mTcp4, NULL);
+
+ON_EXIT:
+  if (ChildHandle != NULL) {
+    NetLibDestroyServiceChild (
+      Handles[0],
+      ImageHandle,
+      &gEfiTcp4ServiceBindingProtocolGuid,
+      ChildHandle
+      );
+  }
+
+  FreePool (Handles);
+  return Status;
+}
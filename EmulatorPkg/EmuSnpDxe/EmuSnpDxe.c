@@ -420,6 +420,30 @@ EmuSnpGetStatus (
 
   Private = EMU_SNP_PRIVATE_DATA_FROM_SNP_THIS (This);
 
+  if (Private->LoopbackRing != NULL) {
+    if (InterruptStatus != NULL) {
+      *InterruptStatus = 0;
+      if (Private->LoopbackCount != 0) {
+        *InterruptStatus |= EFI_SIMPLE_NETWORK_RECEIVE_INTERRUPT;
+      }
+
+      if (Private->RecycledTxBufCount != 0) {
+        *InterruptStatus |= EFI_SIMPLE_NETWORK_TRANSMIT_INTERRUPT;
+      }
+    }
+
+    if (TxBuffer != NULL) {
+      if (Private->RecycledTxBufCount == 0) {
+        *TxBuffer = NULL;
+      } else {
+        Private->RecycledTxBufCount--;
+        *TxBuffer = Private->RecycledTxBuf[Private->RecycledTxBufCount];
+      }
+    }
+
+    return EFI_SUCCESS;
+  }
+
   Status = Private->Io->GetStatus (Private->Io, InterruptStatus, TxBuffer);
   return Status;
 }
@@ -466,11 +490,50 @@ EmuSnpTransmit (
   IN UINT16                       *Protocol OPTIONAL
   )
 {
-  EFI_STATUS            Status;
-  EMU_SNP_PRIVATE_DATA  *Private;
+  EFI_STATUS              Status;
+  EMU_SNP_PRIVATE_DATA    *Private;
+  EMU_SNP_LOOPBACK_FRAME  *Frame;
+  UINT8                   *Header;
 
   Private = EMU_SNP_PRIVATE_DATA_FROM_SNP_THIS (This);
 
+  if (Private->LoopbackRing != NULL) {
+    if ((Buffer == NULL) || (BufferSize < NET_ETHER_HEADER_SIZE) || (BufferSize > EMU_SNP_LOOPBACK_FRAME_SIZE)) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    if (HeaderSize != 0) {
+      if ((HeaderSize != NET_ETHER_HEADER_SIZE) || (DestAddr == NULL) || (Protocol == NULL)) {
+        return EFI_INVALID_PARAMETER;
+      }
+
+      if (SrcAddr == NULL) {
+        SrcAddr = &Private->Mode.CurrentAddress;
+      }
+
+      Header = (UINT8 *)Buffer;
+      CopyMem (Header, DestAddr, NET_ETHER_ADDR_LEN);
+      CopyMem (Header + NET_ETHER_ADDR_LEN, SrcAddr, NET_ETHER_ADDR_LEN);
+      WriteUnaligned16 ((UINT16 *)(Header + 2 * NET_ETHER_ADDR_LEN), HTONS (*Protocol));
+    }
+
+    if ((Private->LoopbackCount == EMU_SNP_LOOPBACK_RING_SIZE) ||
+        (Private->RecycledTxBufCount == EMU_SNP_LOOPBACK_RING_SIZE))
+    {
+      return EFI_NOT_READY;
+    }
+
+    Frame = &Private->LoopbackRing[(Private->LoopbackHead + Private->LoopbackCount) % EMU_SNP_LOOPBACK_RING_SIZE];
+    CopyMem (Frame->Data, Buffer, BufferSize);
+    Frame->Length = BufferSize;
+    Private->LoopbackCount++;
+
+    Private->RecycledTxBuf[Private->RecycledTxBufCount] = Buffer;
+    Private->RecycledTxBufCount++;
+
+    return EFI_SUCCESS;
+  }
+
   Status = Private->Io->Transmit (
                           Private->Io,
                           HeaderSize,
@@ -525,11 +588,54 @@ EmuSnpReceive (
   OUT UINT16                      *Protocol OPTIONAL
   )
 {
-  EFI_STATUS            Status;
-  EMU_SNP_PRIVATE_DATA  *Private;
+  EFI_STATUS              Status;
+  EMU_SNP_PRIVATE_DATA    *Private;
+  EMU_SNP_LOOPBACK_FRAME  *Frame;
 
   Private = EMU_SNP_PRIVATE_DATA_FROM_SNP_THIS (This);
 
+  if (Private->LoopbackRing != NULL) {
+    if ((BuffSize == NULL) || (Buffer == NULL)) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    if (Private->LoopbackCount == 0) {
+      return EFI_NOT_READY;
+    }
+
+    Frame = &Private->LoopbackRing[Private->LoopbackHead];
+    if (*BuffSize < Frame->Length) {
+      *BuffSize = Frame->Length;
+      return EFI_BUFFER_TOO_SMALL;
+    }
+
+    CopyMem (Buffer, Frame->Data, Frame->Length);
+    *BuffSize = Frame->Length;
+
+    if (HeaderSize != NULL) {
+      *HeaderSize = NET_ETHER_HEADER_SIZE;
+    }
+
+    if (DestinationAddr != NULL) {
+      ZeroMem (DestinationAddr, sizeof (EFI_MAC_ADDRESS));
+      CopyMem (DestinationAddr, Frame->Data, NET_ETHER_ADDR_LEN);
+    }
+
+    if (SourceAddr != NULL) {
+      ZeroMem (SourceAddr, sizeof (EFI_MAC_ADDRESS));
+      CopyMem (SourceAddr, Frame->Data + NET_ETHER_ADDR_LEN, NET_ETHER_ADDR_LEN);
+    }
+
+    if (Protocol != NULL) {
+      *Protocol = NTOHS (ReadUnaligned16 ((UINT16 *)(Frame->Data + 2 * NET_ETHER_ADDR_LEN)));
+    }
+
+    Private->LoopbackHead = (Private->LoopbackHead + 1) % EMU_SNP_LOOPBACK_RING_SIZE;
+    Private->LoopbackCount--;
+
+    return EFI_SUCCESS;
+  }
+
   Status = Private->Io->Receive (
                           Private->Io,
                           HeaderSize,
@@ -742,6 +848,14 @@ EmuSnpDriverBindingStart (
     goto Done;
   }
 
+  if (FeaturePcdGet (PcdEmuSnpLoopback)) {
+    Private->LoopbackRing = AllocateZeroPool (EMU_SNP_LOOPBACK_RING_SIZE * sizeof (EMU_SNP_LOOPBACK_FRAME));
+    if (Private->LoopbackRing == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Done;
+    }
+  }
+
   //
   // Build the device path by appending the MAC node to the ParentDevicePath
   // from the EmuIo handle.
@@ -811,6 +925,10 @@ EmuSnpDriverBindingStart (
 Done:
   if (EFI_ERROR (Status)) {
     if (Private != NULL) {
+      if (Private->LoopbackRing != NULL) {
+        FreePool (Private->LoopbackRing);
+      }
+
       FreePool (Private);
     }
 
@@ -934,6 +1052,10 @@ EmuSnpDriverBindingStop (
 
     FreePool (Private->DevicePath);
     FreeUnicodeStringTable (Private->ControllerNameTable);
+    if (Private->LoopbackRing != NULL) {
+      FreePool (Private->LoopbackRing);
+    }
+
     FreePool (Private);
   }
 
@@ -30,9 +30,22 @@ Abstract:
 #include <Library/DevicePathLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/NetLib.h>
+#include <Library/PcdLib.h>
 
 #define NET_ETHER_HEADER_SIZE  14
 
+//
+// Loopback mode, enabled by PcdEmuSnpLoopback: transmitted frames are queued
+// in the driver and received back, without going through the host.
+//
+#define EMU_SNP_LOOPBACK_RING_SIZE   64
+#define EMU_SNP_LOOPBACK_FRAME_SIZE  1536
+
+typedef struct {
+  UINTN    Length;
+  UINT8    Data[EMU_SNP_LOOPBACK_FRAME_SIZE];
+} EMU_SNP_LOOPBACK_FRAME;
+
 //
 //  Private data for driver.
 //
@@ -51,6 +64,15 @@ typedef struct {
   EFI_SIMPLE_NETWORK_MODE        Mode;
 
   EFI_UNICODE_STRING_TABLE       *ControllerNameTable;
+
+  //
+  // Loopback mode, LoopbackRing is NULL if it is disabled.
+  //
+  EMU_SNP_LOOPBACK_FRAME         *LoopbackRing;
+  UINTN                          LoopbackHead;
+  UINTN                          LoopbackCount;
+  VOID                           *RecycledTxBuf[EMU_SNP_LOOPBACK_RING_SIZE];
+  UINTN                          RecycledTxBufCount;
 } EMU_SNP_PRIVATE_DATA;
 
 #define EMU_SNP_PRIVATE_DATA_FROM_SNP_THIS(a) \
@@ -883,6 +883,8 @@ EmuSnpReceive (
   struct bpf_stat  BpfStats;
   ETHERNET_HEADER  *EnetHeader;
   ssize_t          Result;
+  struct timeval   Now;
+  INT64            Age;
 
   Private = EMU_SNP_PRIVATE_DATA_FROM_THIS (This);
 
@@ -925,6 +927,20 @@ EmuSnpReceive (
   BpfHeader  = Private->CurrentReadPointer;
   EnetHeader = Private->CurrentReadPointer + BpfHeader->bh_hdrlen;
 
+  //
+  // Hold the packets back until they are PcdEmuNetworkReceiveDelay old,
+  // so the network stack sees a long round trip time. They are returned
+  // in order, the ones that follow are never older than this one.
+  //
+  if (FixedPcdGet32 (PcdEmuNetworkReceiveDelay) != 0) {
+    gettimeofday (&Now, NULL);
+    Age = ((INT64)Now.tv_sec - BpfHeader->bh_tstamp.tv_sec) * 1000 +
+          ((INT64)Now.tv_usec - BpfHeader->bh_tstamp.tv_usec) / 1000;
+    if (Age < FixedPcdGet32 (PcdEmuNetworkReceiveDelay)) {
+      return EFI_NOT_READY;
+    }
+  }
+
   if (BpfHeader->bh_caplen > *BufferSize) {
     *BufferSize = BpfHeader->bh_caplen;
     return EFI_BUFFER_TOO_SMALL;
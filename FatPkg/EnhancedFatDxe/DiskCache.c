@@ -8,6 +8,102 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "Fat.h"
 
+/**
+
+  Get the memory of the page described by a cache tag.
+
+  @param  DiskCache             - The disk cache.
+  @param  CacheTag              - The cache tag of the page.
+
+  @return The address of the page in the cache buffer.
+
+**/
+STATIC
+UINT8 *
+FatGetCachePageAddress (
+  IN DISK_CACHE  *DiskCache,
+  IN CACHE_TAG   *CacheTag
+  )
+{
+  return DiskCache->CacheBase + ((UINTN)(CacheTag - DiskCache->CacheTag) << DiskCache->PageAlignment);
+}
+
+/**
+
+  Find the cache tag that holds the specified page.
+
+  @param  DiskCache             - The disk cache.
+  @param  PageNo                - PageNo to match with the cache.
+
+  @return The cache tag that holds the page, or NULL if the page is not cached.
+
+**/
+STATIC
+CACHE_TAG *
+FatFindCacheTag (
+  IN DISK_CACHE  *DiskCache,
+  IN UINTN       PageNo
+  )
+{
+  UINTN      Way;
+  CACHE_TAG  *CacheTag;
+
+  CacheTag = &DiskCache->CacheTag[PageNo & DiskCache->GroupMask];
+  for (Way = 0; Way < DiskCache->WayCount; Way++) {
+    if ((CacheTag->RealSize > 0) && (CacheTag->PageNo == PageNo)) {
+      return CacheTag;
+    }
+
+    CacheTag += DiskCache->GroupMask + 1;
+  }
+
+  return NULL;
+}
+
+/**
+
+  Select the cache tag to be replaced by the specified page: an unused page of
+  the set of PageNo if there is one, otherwise the least recently used page.
+
+  @param  DiskCache             - The disk cache.
+  @param  PageNo                - PageNo to be loaded into the cache.
+
+  @return The cache tag to be replaced.
+
+**/
+STATIC
+CACHE_TAG *
+FatGetVictimCacheTag (
+  IN DISK_CACHE  *DiskCache,
+  IN UINTN       PageNo
+  )
+{
+  UINTN      Way;
+  UINTN      Age;
+  UINTN      MaxAge;
+  CACHE_TAG  *CacheTag;
+  CACHE_TAG  *Victim;
+
+  CacheTag = &DiskCache->CacheTag[PageNo & DiskCache->GroupMask];
+  Victim   = CacheTag;
+  MaxAge   = 0;
+  for (Way = 0; Way < DiskCache->WayCount; Way++) {
+    if (CacheTag->RealSize == 0) {
+      return CacheTag;
+    }
+
+    Age = DiskCache->AccessCount - CacheTag->LastAccess;
+    if (Age > MaxAge) {
+      MaxAge = Age;
+      Victim = CacheTag;
+    }
+
+    CacheTag += DiskCache->GroupMask + 1;
+  }
+
+  return Victim;
+}
+
 /**
 
   This function is used by the Data Cache.
@@ -38,24 +134,18 @@ FatFlushDataCacheRange (
   )
 {
   UINTN       PageNo;
-  UINTN       GroupNo;
-  UINTN       GroupMask;
   UINTN       PageSize;
   UINT8       PageAlignment;
   DISK_CACHE  *DiskCache;
   CACHE_TAG   *CacheTag;
-  UINT8       *BaseAddress;
 
   DiskCache     = &Volume->DiskCache[CacheData];
-  BaseAddress   = DiskCache->CacheBase;
-  GroupMask     = DiskCache->GroupMask;
   PageAlignment = DiskCache->PageAlignment;
   PageSize      = (UINTN)1 << PageAlignment;
 
   for (PageNo = StartPageNo; PageNo < EndPageNo; PageNo++) {
-    GroupNo  = PageNo & GroupMask;
-    CacheTag = &DiskCache->CacheTag[GroupNo];
-    if ((CacheTag->RealSize > 0) && (CacheTag->PageNo == PageNo)) {
+    CacheTag = FatFindCacheTag (DiskCache, PageNo);
+    if (CacheTag != NULL) {
       //
       // When reading data form disk directly, if some dirty data
       // in cache is in this rang, this data in the Buffer need to
@@ -65,7 +155,7 @@ FatFlushDataCacheRange (
         if (CacheTag->Dirty) {
           CopyMem (
             Buffer + ((PageNo - StartPageNo) << PageAlignment),
-            BaseAddress + (GroupNo << PageAlignment),
+            FatGetCachePageAddress (DiskCache, CacheTag),
             PageSize
             );
         }
@@ -81,12 +171,16 @@ FatFlushDataCacheRange (
 
 /**
 
-  Exchange the cache page with the image on the disk
+  Exchange the cache pages with the image on the disk
+
+  The PageCount pages start at CacheTag and must be contiguous both in the
+  cache and on the disk; they are transferred with a single disk access.
 
   @param  Volume                - FAT file system volume.
   @param  DataType              - Indicate the cache type.
   @param  IoMode                - Indicate whether to load this page from disk or store this page to disk.
-  @param  CacheTag              - The Cache Tag for the current cache page.
+  @param  CacheTag              - The Cache Tag for the first cache page.
+  @param  PageCount             - The number of cache pages.
   @param  Task                    point to task instance.
 
   @retval EFI_SUCCESS           - Cache page exchanged successfully.
@@ -100,12 +194,14 @@ FatExchangeCachePage (
   IN CACHE_DATA_TYPE  DataType,
   IN IO_MODE          IoMode,
   IN CACHE_TAG        *CacheTag,
+  IN UINTN            PageCount,
   IN FAT_TASK         *Task
   )
 {
   EFI_STATUS  Status;
-  UINTN       GroupNo;
   UINTN       PageNo;
+  UINTN       PageSize;
+  UINTN       Index;
   UINTN       WriteCount;
   UINTN       RealSize;
   UINT64      EntryPos;
@@ -116,13 +212,13 @@ FatExchangeCachePage (
 
   DiskCache     = &Volume->DiskCache[DataType];
   PageNo        = CacheTag->PageNo;
-  GroupNo       = PageNo & DiskCache->GroupMask;
   PageAlignment = DiskCache->PageAlignment;
-  PageAddress   = DiskCache->CacheBase + (GroupNo << PageAlignment);
+  PageSize      = (UINTN)1 << PageAlignment;
+  PageAddress   = FatGetCachePageAddress (DiskCache, CacheTag);
   EntryPos      = DiskCache->BaseAddress + LShiftU64 (PageNo, PageAlignment);
-  RealSize      = CacheTag->RealSize;
+  RealSize      = ((PageCount - 1) << PageAlignment) + CacheTag[PageCount - 1].RealSize;
   if (IoMode == ReadDisk) {
-    RealSize = (UINTN)1 << PageAlignment;
+    RealSize = PageCount << PageAlignment;
     MaxSize  = DiskCache->LimitAddress - EntryPos;
     if (MaxSize < RealSize) {
       DEBUG ((DEBUG_INFO, "FatDiskIo: Cache Page OutBound occurred! \n"));
@@ -147,15 +243,71 @@ FatExchangeCachePage (
     EntryPos += Volume->FatSize;
   } while (--WriteCount > 0);
 
-  CacheTag->Dirty    = FALSE;
-  CacheTag->RealSize = RealSize;
+  for (Index = 0; Index < PageCount; Index++) {
+    CacheTag[Index].Dirty    = FALSE;
+    CacheTag[Index].RealSize = MIN (RealSize, PageSize);
+    RealSize                -= CacheTag[Index].RealSize;
+  }
+
   return EFI_SUCCESS;
 }
 
+/**
+
+  Count the pages that can be read ahead together with a missed page.
+
+  The pages following PageNo are loaded into the pages following CacheTag in
+  the same way of the cache, so that they are read with a single disk access.
+  Read-ahead stops at the end of the way, at the end of the cache range, at a
+  dirty cache page and at a page that is already cached.
+
+  @param  DiskCache             - The disk cache.
+  @param  PageNo                - The missed PageNo.
+  @param  CacheTag              - The Cache Tag selected for the missed page.
+
+  @return The number of pages to read ahead after PageNo.
+
+**/
+STATIC
+UINTN
+FatGetReadAheadCount (
+  IN DISK_CACHE  *DiskCache,
+  IN UINTN       PageNo,
+  IN CACHE_TAG   *CacheTag
+  )
+{
+  UINTN   Count;
+  UINTN   NextPageNo;
+  UINT64  EntryPos;
+
+  for (Count = 0; Count < DiskCache->ReadAheadCount; Count++) {
+    NextPageNo = PageNo + Count + 1;
+    if ((NextPageNo & DiskCache->GroupMask) == 0) {
+      break;
+    }
+
+    EntryPos = DiskCache->BaseAddress + LShiftU64 (NextPageNo, DiskCache->PageAlignment);
+    if (EntryPos >= DiskCache->LimitAddress) {
+      break;
+    }
+
+    if (((CacheTag[Count + 1].RealSize > 0) && CacheTag[Count + 1].Dirty) ||
+        (FatFindCacheTag (DiskCache, NextPageNo) != NULL))
+    {
+      break;
+    }
+  }
+
+  return Count;
+}
+
 /**
 
   Get one cache page by specified PageNo.
 
+  When the missed pages follow each other, the next pages are read ahead
+  into the cache together with the missed page.
+
   @param  Volume                - FAT file system volume.
   @param  CacheDataType         - The cache type: CACHE_FAT or CACHE_DATA.
   @param  PageNo                - PageNo to match with the cache.
@@ -168,40 +320,69 @@ FatExchangeCachePage (
 STATIC
 EFI_STATUS
 FatGetCachePage (
-  IN FAT_VOLUME       *Volume,
-  IN CACHE_DATA_TYPE  CacheDataType,
-  IN UINTN            PageNo,
-  IN CACHE_TAG        *CacheTag
+  IN  FAT_VOLUME       *Volume,
+  IN  CACHE_DATA_TYPE  CacheDataType,
+  IN  UINTN            PageNo,
+  OUT CACHE_TAG        **CacheTag
   )
 {
   EFI_STATUS  Status;
-  UINTN       OldPageNo;
+  DISK_CACHE  *DiskCache;
+  CACHE_TAG   *Victim;
+  UINTN       PageCount;
+  UINTN       Index;
 
-  OldPageNo = CacheTag->PageNo;
-  if ((CacheTag->RealSize > 0) && (OldPageNo == PageNo)) {
+  DiskCache = &Volume->DiskCache[CacheDataType];
+  DiskCache->AccessCount++;
+
+  *CacheTag = FatFindCacheTag (DiskCache, PageNo);
+  if (*CacheTag != NULL) {
     //
     // Cache Hit occurred
     //
+    (*CacheTag)->LastAccess = DiskCache->AccessCount;
     return EFI_SUCCESS;
   }
 
+  Victim = FatGetVictimCacheTag (DiskCache, PageNo);
+
   //
   // Write dirty cache page back to disk
   //
-  if ((CacheTag->RealSize > 0) && CacheTag->Dirty) {
-    Status = FatExchangeCachePage (Volume, CacheDataType, WriteDisk, CacheTag, NULL);
+  if ((Victim->RealSize > 0) && Victim->Dirty) {
+    Status = FatExchangeCachePage (Volume, CacheDataType, WriteDisk, Victim, 1, NULL);
     if (EFI_ERROR (Status)) {
       return Status;
     }
   }
 
+  PageCount = 1;
+  if (PageNo == DiskCache->NextMissPageNo) {
+    PageCount += FatGetReadAheadCount (DiskCache, PageNo, Victim);
+  }
+
   //
-  // Load new data from disk;
+  // Load new data from disk; if reading ahead fails, load the missed page only
   //
-  CacheTag->PageNo = PageNo;
-  Status           = FatExchangeCachePage (Volume, CacheDataType, ReadDisk, CacheTag, NULL);
+  for (Index = 0; Index < PageCount; Index++) {
+    Victim[Index].PageNo     = PageNo + Index;
+    Victim[Index].RealSize   = 0;
+    Victim[Index].LastAccess = DiskCache->AccessCount;
+  }
 
-  return Status;
+  Status = FatExchangeCachePage (Volume, CacheDataType, ReadDisk, Victim, PageCount, NULL);
+  if (EFI_ERROR (Status) && (PageCount > 1)) {
+    PageCount = 1;
+    Status    = FatExchangeCachePage (Volume, CacheDataType, ReadDisk, Victim, PageCount, NULL);
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  DiskCache->NextMissPageNo = PageNo + PageCount;
+  *CacheTag                 = Victim;
+  return EFI_SUCCESS;
 }
 
 /**
@@ -238,14 +419,11 @@ FatAccessUnalignedCachePage (
   VOID        *Destination;
   DISK_CACHE  *DiskCache;
   CACHE_TAG   *CacheTag;
-  UINTN       GroupNo;
 
   DiskCache = &Volume->DiskCache[CacheDataType];
-  GroupNo   = PageNo & DiskCache->GroupMask;
-  CacheTag  = &DiskCache->CacheTag[GroupNo];
-  Status    = FatGetCachePage (Volume, CacheDataType, PageNo, CacheTag);
+  Status    = FatGetCachePage (Volume, CacheDataType, PageNo, &CacheTag);
   if (!EFI_ERROR (Status)) {
-    Source      = DiskCache->CacheBase + (GroupNo << DiskCache->PageAlignment) + Offset;
+    Source      = FatGetCachePageAddress (DiskCache, CacheTag) + Offset;
     Destination = Buffer;
     if (IoMode != ReadDisk) {
       CacheTag->Dirty  = TRUE;
@@ -384,6 +562,9 @@ FatAccessCache (
 
   Flush all the dirty cache back, include the FAT cache and the Data cache.
 
+  Dirty pages that are contiguous both in the cache and on the disk are
+  written back with a single disk access.
+
   @param  Volume                - FAT file system volume.
   @param  Task                    point to task instance.
 
@@ -399,7 +580,10 @@ FatVolumeFlushCache (
 {
   EFI_STATUS       Status;
   CACHE_DATA_TYPE  CacheDataType;
-  UINTN            GroupIndex;
+  UINTN            TagIndex;
+  UINTN            TagCount;
+  UINTN            PageCount;
+  UINTN            PageSize;
   UINTN            GroupMask;
   DISK_CACHE       *DiskCache;
   CACHE_TAG        *CacheTag;
@@ -411,13 +595,29 @@ FatVolumeFlushCache (
       // Data cache or fat cache is dirty, write the dirty data back
       //
       GroupMask = DiskCache->GroupMask;
-      for (GroupIndex = 0; GroupIndex <= GroupMask; GroupIndex++) {
-        CacheTag = &DiskCache->CacheTag[GroupIndex];
+      PageSize  = (UINTN)1 << DiskCache->PageAlignment;
+      TagCount  = DiskCache->WayCount * (GroupMask + 1);
+      for (TagIndex = 0; TagIndex < TagCount; TagIndex += PageCount) {
+        CacheTag  = &DiskCache->CacheTag[TagIndex];
+        PageCount = 1;
         if ((CacheTag->RealSize > 0) && CacheTag->Dirty) {
+          //
+          // Coalesce the following dirty pages of the same way that continue
+          // this page on the disk.
+          //
+          while ((((TagIndex + PageCount) & GroupMask) != 0) &&
+                 (CacheTag[PageCount - 1].RealSize == PageSize) &&
+                 (CacheTag[PageCount].RealSize > 0) &&
+                 CacheTag[PageCount].Dirty &&
+                 (CacheTag[PageCount].PageNo == CacheTag[PageCount - 1].PageNo + 1))
+          {
+            PageCount++;
+          }
+
           //
           // Write back all Dirty Data Cache Page to disk
           //
-          Status = FatExchangeCachePage (Volume, CacheDataType, WriteDisk, CacheTag, Task);
+          Status = FatExchangeCachePage (Volume, CacheDataType, WriteDisk, CacheTag, PageCount, Task);
           if (EFI_ERROR (Status)) {
             return Status;
           }
@@ -451,7 +651,10 @@ FatInitializeDiskCache (
   )
 {
   DISK_CACHE  *DiskCache;
-  UINTN       FatCacheGroupCount;
+  UINTN       FatCachePageCount;
+  UINTN       FatCacheTagCount;
+  UINTN       DataCachePageCount;
+  UINTN       DataCacheTagCount;
   UINTN       DataCacheSize;
   UINTN       FatCacheSize;
   UINT8       *CacheBuffer;
@@ -461,27 +664,37 @@ FatInitializeDiskCache (
   // Configure the parameters of disk cache
   //
   if (Volume->FatType == Fat12) {
-    FatCacheGroupCount                 = FAT_FATCACHE_GROUP_MIN_COUNT;
+    FatCachePageCount                  = FAT_FATCACHE_PAGE_MIN_COUNT;
     DiskCache[CacheFat].PageAlignment  = FAT_FATCACHE_PAGE_MIN_ALIGNMENT;
     DiskCache[CacheData].PageAlignment = FAT_DATACACHE_PAGE_MIN_ALIGNMENT;
   } else {
-    FatCacheGroupCount                 = FAT_FATCACHE_GROUP_MAX_COUNT;
+    FatCachePageCount                  = FAT_FATCACHE_PAGE_MAX_COUNT;
     DiskCache[CacheFat].PageAlignment  = FAT_FATCACHE_PAGE_MAX_ALIGNMENT;
     DiskCache[CacheData].PageAlignment = FAT_DATACACHE_PAGE_MAX_ALIGNMENT;
   }
 
-  DiskCache[CacheData].GroupMask    = FAT_DATACACHE_GROUP_COUNT - 1;
-  DiskCache[CacheData].BaseAddress  = Volume->RootPos;
-  DiskCache[CacheData].LimitAddress = Volume->VolumeSize;
-  DiskCache[CacheFat].GroupMask     = FatCacheGroupCount - 1;
-  DiskCache[CacheFat].BaseAddress   = Volume->FatPos;
-  DiskCache[CacheFat].LimitAddress  = Volume->FatPos + Volume->FatSize;
-  FatCacheSize                      = FatCacheGroupCount << DiskCache[CacheFat].PageAlignment;
-  DataCacheSize                     = FAT_DATACACHE_GROUP_COUNT << DiskCache[CacheData].PageAlignment;
+  DataCachePageCount = MAX (PcdGet32 (PcdFatDataCachePageCount), 1);
+
+  DiskCache[CacheData].WayCount       = MIN (DataCachePageCount, FAT_DATACACHE_WAY_COUNT);
+  DiskCache[CacheData].GroupMask      = GetPowerOfTwo32 ((UINT32)(DataCachePageCount / DiskCache[CacheData].WayCount)) - 1;
+  DiskCache[CacheData].ReadAheadCount = PcdGet32 (PcdFatDataCacheReadAheadPageCount);
+  DiskCache[CacheData].NextMissPageNo = MAX_UINTN;
+  DiskCache[CacheData].BaseAddress    = Volume->RootPos;
+  DiskCache[CacheData].LimitAddress   = Volume->VolumeSize;
+  DiskCache[CacheFat].WayCount        = MIN (FatCachePageCount, FAT_FATCACHE_WAY_COUNT);
+  DiskCache[CacheFat].GroupMask       = FatCachePageCount / DiskCache[CacheFat].WayCount - 1;
+  DiskCache[CacheFat].ReadAheadCount  = 0;
+  DiskCache[CacheFat].NextMissPageNo  = MAX_UINTN;
+  DiskCache[CacheFat].BaseAddress     = Volume->FatPos;
+  DiskCache[CacheFat].LimitAddress    = Volume->FatPos + Volume->FatSize;
+  FatCacheTagCount                    = DiskCache[CacheFat].WayCount * (DiskCache[CacheFat].GroupMask + 1);
+  DataCacheTagCount                   = DiskCache[CacheData].WayCount * (DiskCache[CacheData].GroupMask + 1);
+  FatCacheSize                        = FatCacheTagCount << DiskCache[CacheFat].PageAlignment;
+  DataCacheSize                       = DataCacheTagCount << DiskCache[CacheData].PageAlignment;
   //
-  // Allocate the Fat Cache buffer
+  // Allocate the Fat Cache buffer, followed by the cache tags
   //
-  CacheBuffer = AllocateZeroPool (FatCacheSize + DataCacheSize);
+  CacheBuffer = AllocateZeroPool (FatCacheSize + DataCacheSize + (FatCacheTagCount + DataCacheTagCount) * sizeof (CACHE_TAG));
   if (CacheBuffer == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
@@ -489,5 +702,7 @@ FatInitializeDiskCache (
   Volume->CacheBuffer            = CacheBuffer;
   DiskCache[CacheFat].CacheBase  = CacheBuffer;
   DiskCache[CacheData].CacheBase = CacheBuffer + FatCacheSize;
+  DiskCache[CacheFat].CacheTag   = (CACHE_TAG *)(CacheBuffer + FatCacheSize + DataCacheSize);
+  DiskCache[CacheData].CacheTag  = DiskCache[CacheFat].CacheTag + FatCacheTagCount;
   return EFI_SUCCESS;
 }
@@ -80,9 +80,24 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define FAT_FATCACHE_PAGE_MAX_ALIGNMENT   15
 #define FAT_DATACACHE_PAGE_MIN_ALIGNMENT  13
 #define FAT_DATACACHE_PAGE_MAX_ALIGNMENT  16
-#define FAT_DATACACHE_GROUP_COUNT         64
-#define FAT_FATCACHE_GROUP_MIN_COUNT      1
-#define FAT_FATCACHE_GROUP_MAX_COUNT      16
+#define FAT_FATCACHE_PAGE_MIN_COUNT       1
+#define FAT_FATCACHE_PAGE_MAX_COUNT       16
+
+//
+// The pages of a cache are grouped in sets of up to FAT_xxxCACHE_WAY_COUNT
+// pages. A disk page can be held by any page of the set selected by its
+// PageNo; the least recently used one is replaced on a cache miss.
+//
+#define FAT_DATACACHE_WAY_COUNT  8
+#define FAT_FATCACHE_WAY_COUNT   4
+
+//
+// Initial and maximum number of extents in the extent map of an open file.
+// The cluster chain of a file that has more extents is run from the last
+// extent of the map.
+//
+#define FAT_EXTENT_MIN_COUNT  16
+#define FAT_EXTENT_MAX_COUNT  0x10000
 
 //
 // Used in 8.3 generation algorithm
@@ -146,6 +161,7 @@ typedef struct {
   UINTN      PageNo;
   UINTN      RealSize;
   BOOLEAN    Dirty;
+  UINTN      LastAccess;                      // Value of AccessCount when the page was last used
 } CACHE_TAG;
 
 typedef struct {
@@ -154,10 +170,27 @@ typedef struct {
   UINT8        *CacheBase;
   BOOLEAN      Dirty;
   UINT8        PageAlignment;
-  UINTN        GroupMask;
-  CACHE_TAG    CacheTag[FAT_DATACACHE_GROUP_COUNT];
+  UINTN        GroupMask;                     // Number of sets - 1
+  UINTN        WayCount;                      // Number of pages of a set
+  UINTN        AccessCount;                   // Increased on every page access
+  UINTN        ReadAheadCount;                // Maximum number of pages read ahead
+  UINTN        NextMissPageNo;                // PageNo that continues the sequential access
+  //
+  // CacheTag[Way * (GroupMask + 1) + GroupNo] describes the page at the same
+  // index in CacheBase, so the pages of one way are contiguous in memory.
+  //
+  CACHE_TAG    *CacheTag;
 } DISK_CACHE;
 
+//
+// A run of contiguous clusters of a file
+//
+typedef struct {
+  UINTN    ClusterIndex;                      // Index of the first cluster of the run in the file
+  UINTN    Cluster;                           // First cluster of the run on the volume
+  UINTN    ClusterCount;
+} FAT_EXTENT;
+
 //
 // Hash table size
 //
@@ -251,6 +284,14 @@ struct _FAT_OFILE {
   UINTN         FileCluster;
   UINTN         FileCurrentCluster;
   UINTN         FileLastCluster;
+  //
+  // The extents of the cluster chain, built lazily from the start of the
+  // chain and trimmed when the chain is truncated
+  //
+  FAT_EXTENT    *Extents;
+  UINTN         ExtentCount;
+  UINTN         ExtentMaxCount;
+  UINTN         ExtentClusterCount;           // Number of clusters described by Extents
 
   //
   // Dirty is set if there have been any updates to the
@@ -341,6 +341,156 @@ FatSizeToClusters (
   return Clusters;
 }
 
+/**
+
+  Extend the extent map of the open file along the cluster chain of the file,
+  until the map describes ClusterCount clusters.
+
+  @param  OFile                 - The open file.
+  @param  ClusterCount          - The number of clusters the map must describe.
+
+  @retval EFI_SUCCESS           - The map describes at least ClusterCount clusters.
+  @retval EFI_END_OF_FILE       - The cluster chain has less than ClusterCount clusters.
+  @retval EFI_VOLUME_CORRUPTED  - There are errors in the file's clusters.
+  @retval EFI_OUT_OF_RESOURCES  - The map cannot hold more extents.
+
+**/
+STATIC
+EFI_STATUS
+FatExtendExtentMap (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      ClusterCount
+  )
+{
+  FAT_VOLUME  *Volume;
+  FAT_EXTENT  *Extent;
+  FAT_EXTENT  *Extents;
+  UINTN       Cluster;
+  UINTN       MaxCount;
+
+  Volume = OFile->Volume;
+  while (OFile->ExtentClusterCount < ClusterCount) {
+    if (OFile->ExtentCount == 0) {
+      Extent  = NULL;
+      Cluster = OFile->FileCluster;
+    } else {
+      Extent  = &OFile->Extents[OFile->ExtentCount - 1];
+      Cluster = FatGetFatEntry (Volume, Extent->Cluster + Extent->ClusterCount - 1);
+    }
+
+    if ((Cluster < FAT_MIN_CLUSTER) || (Cluster > Volume->MaxCluster + 1)) {
+      if (FAT_END_OF_FAT_CHAIN (Cluster) || ((Extent == NULL) && (Cluster == FAT_CLUSTER_FREE))) {
+        return EFI_END_OF_FILE;
+      }
+
+      DEBUG ((DEBUG_INIT | DEBUG_ERROR, "FatExtendExtentMap: cluster chain corrupt\n"));
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    if ((Extent != NULL) && (Cluster == Extent->Cluster + Extent->ClusterCount)) {
+      Extent->ClusterCount++;
+    } else {
+      if (OFile->ExtentCount == OFile->ExtentMaxCount) {
+        if (OFile->ExtentMaxCount >= FAT_EXTENT_MAX_COUNT) {
+          return EFI_OUT_OF_RESOURCES;
+        }
+
+        MaxCount = MAX (OFile->ExtentMaxCount * 2, FAT_EXTENT_MIN_COUNT);
+        Extents  = ReallocatePool (
+                     OFile->ExtentMaxCount * sizeof (FAT_EXTENT),
+                     MaxCount * sizeof (FAT_EXTENT),
+                     OFile->Extents
+                     );
+        if (Extents == NULL) {
+          return EFI_OUT_OF_RESOURCES;
+        }
+
+        OFile->Extents        = Extents;
+        OFile->ExtentMaxCount = MaxCount;
+      }
+
+      Extent               = &OFile->Extents[OFile->ExtentCount];
+      Extent->ClusterIndex = OFile->ExtentClusterCount;
+      Extent->Cluster      = Cluster;
+      Extent->ClusterCount = 1;
+      OFile->ExtentCount++;
+    }
+
+    OFile->ExtentClusterCount++;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Trim the extent map of the open file to the first ClusterCount clusters,
+  after the cluster chain of the file has been truncated.
+
+  @param  OFile                 - The open file.
+  @param  ClusterCount          - The number of clusters left in the chain.
+
+**/
+STATIC
+VOID
+FatTruncateExtentMap (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      ClusterCount
+  )
+{
+  FAT_EXTENT  *Extent;
+
+  while (OFile->ExtentCount > 0) {
+    Extent = &OFile->Extents[OFile->ExtentCount - 1];
+    if (Extent->ClusterIndex < ClusterCount) {
+      Extent->ClusterCount = MIN (Extent->ClusterCount, ClusterCount - Extent->ClusterIndex);
+      break;
+    }
+
+    OFile->ExtentCount--;
+  }
+
+  OFile->ExtentClusterCount = MIN (OFile->ExtentClusterCount, ClusterCount);
+}
+
+/**
+
+  Find the extent that holds a cluster of the open file. The extent map must
+  describe the cluster.
+
+  @param  OFile                 - The open file.
+  @param  ClusterIndex          - The index of the cluster in the file.
+
+  @return The extent that holds the cluster.
+
+**/
+STATIC
+FAT_EXTENT *
+FatFindExtent (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      ClusterIndex
+  )
+{
+  UINTN  Low;
+  UINTN  High;
+  UINTN  Middle;
+
+  ASSERT (ClusterIndex < OFile->ExtentClusterCount);
+
+  Low  = 0;
+  High = OFile->ExtentCount - 1;
+  while (Low < High) {
+    Middle = (Low + High + 1) / 2;
+    if (OFile->Extents[Middle].ClusterIndex <= ClusterIndex) {
+      Low = Middle;
+    } else {
+      High = Middle - 1;
+    }
+  }
+
+  return &OFile->Extents[Low];
+}
+
 /**
 
   Shrink the end of the open file base on the file size.
@@ -366,6 +516,7 @@ FatShrinkEof (
   ASSERT_VOLUME_LOCKED (Volume);
 
   NewSize = FatSizeToClusters (Volume, OFile->FileSize);
+  FatTruncateExtentMap (OFile, NewSize);
 
   //
   // Find the address of the last cluster
@@ -566,7 +717,10 @@ FatOFilePosition (
   )
 {
   FAT_VOLUME  *Volume;
+  FAT_EXTENT  *Extent;
+  EFI_STATUS  Status;
   UINTN       ClusterSize;
+  UINTN       ClusterIndex;
   UINTN       Cluster;
   UINTN       StartPos;
   UINTN       Run;
@@ -585,7 +739,29 @@ FatOFilePosition (
     Run            = OFile->FileSize - Position;
   } else {
     //
-    // Run the file's cluster chain to find the current position
+    // Look up the cluster of the position in the extent map of the file
+    //
+    ClusterIndex = Position >> Volume->ClusterAlignment;
+    Status       = FatExtendExtentMap (OFile, ClusterIndex + 1);
+    if (Status == EFI_END_OF_FILE) {
+      DEBUG ((DEBUG_INIT | DEBUG_ERROR, "FatOFilePosition:" " cluster chain corrupt\n"));
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    if (Status == EFI_VOLUME_CORRUPTED) {
+      return Status;
+    }
+
+    Extent = NULL;
+    if (!EFI_ERROR (Status)) {
+      Extent                    = FatFindExtent (OFile, ClusterIndex);
+      OFile->FileCurrentCluster = Extent->Cluster + ClusterIndex - Extent->ClusterIndex;
+      OFile->Position           = ClusterIndex << Volume->ClusterAlignment;
+    }
+
+    //
+    // If the extent map cannot describe the position, run the file's
+    // cluster chain to find the current position
     // If possible, run from the current cluster rather than
     // start from beginning
     // Assumption: OFile->Position is always consistent with
@@ -624,12 +800,21 @@ FatOFilePosition (
     OFile->Position           = StartPos;
 
     //
-    // Compute the number of consecutive clusters in the file
+    // Compute the number of consecutive clusters in the file. The clusters
+    // that follow in the same extent are known to be consecutive. The run
+    // never goes past the PosLimit bytes that the caller may access.
     //
     Run = StartPos + ClusterSize - Position;
+    if (Extent != NULL) {
+      Run    += (Extent->ClusterIndex + Extent->ClusterCount - ClusterIndex - 1) << Volume->ClusterAlignment;
+      Cluster = Extent->Cluster + Extent->ClusterCount - 1;
+    }
+
+    Run = MIN (Run, PosLimit);
     if (!FAT_END_OF_FAT_CHAIN (Cluster)) {
-      while ((FatGetFatEntry (Volume, Cluster) == Cluster + 1) && Run < PosLimit) {
+      while ((Run < PosLimit) && (FatGetFatEntry (Volume, Cluster) == Cluster + 1)) {
         Run     += ClusterSize;
+        Run      = MIN (Run, PosLimit);
         Cluster += 1;
       }
     }
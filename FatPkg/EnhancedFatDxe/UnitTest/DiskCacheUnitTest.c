@@ -0,0 +1,757 @@
+/** @file
+  This is a host-based unit test for the set-associative disk cache of the
+  FAT driver in DiskCache.c.
+
+  The cache runs on a memory-backed disk that counts the disk accesses. The
+  tests check the replacement of the least recently used page, the write back
+  of dirty pages, read-ahead on sequential misses, the coalesced write back
+  of FatVolumeFlushCache (), and random reads and writes against a copy of
+  the disk. The number of disk reads of a sequential scan is reported with
+  and without read-ahead.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../Fat.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "FAT Disk Cache Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+//
+// A FAT12 volume uses 8KB data cache pages. The data area holds 254 pages,
+// so it does not end on a set boundary, and starts at page 0 of the data
+// cache.
+//
+#define TEST_FAT_POS         0x200
+#define TEST_FAT_SIZE        0x2000
+#define TEST_ROOT_POS        0x4000
+#define TEST_DATA_PAGES      254
+#define TEST_PAGE_SIZE       SIZE_8KB
+#define TEST_VOLUME_SIZE     (TEST_ROOT_POS + TEST_DATA_PAGES * TEST_PAGE_SIZE)
+#define TEST_RANDOM_STEPS    20000
+#define TEST_SCAN_READ_SIZE  512
+
+FAT_VOLUME             mTestVolume;
+EFI_BLOCK_IO_PROTOCOL  mTestBlockIo;
+UINT8                  *mTestDisk;
+UINT8                  *mTestModel;
+UINTN                  mTestDiskReads;
+UINTN                  mTestDiskWrites;
+UINTN                  mTestLastSize;
+UINT32                 mTestSeed;
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Stand-in for the FAT driver disk access, on the memory-backed disk.
+
+  @param  Volume                - FAT file system volume.
+  @param  IoMode                - ReadDisk or WriteDisk.
+  @param  Offset                - The starting byte offset.
+  @param  BufferSize            - Size of Buffer.
+  @param  Buffer                - Buffer containing the data.
+  @param  Task                  - Not used.
+
+  @retval EFI_SUCCESS           - The data was accessed.
+  @retval EFI_VOLUME_CORRUPTED  - The access is beyond the end of the volume.
+
+**/
+EFI_STATUS
+FatDiskIo (
+  IN     FAT_VOLUME  *Volume,
+  IN     IO_MODE     IoMode,
+  IN     UINT64      Offset,
+  IN     UINTN       BufferSize,
+  IN OUT VOID        *Buffer,
+  IN     FAT_TASK    *Task
+  )
+{
+  if (Offset + BufferSize > Volume->VolumeSize) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  ASSERT (!CACHE_ENABLED (IoMode));
+  mTestLastSize = BufferSize;
+  if (IoMode == ReadDisk) {
+    mTestDiskReads++;
+    CopyMem (Buffer, mTestDisk + Offset, BufferSize);
+  } else {
+    mTestDiskWrites++;
+    CopyMem (mTestDisk + Offset, Buffer, BufferSize);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the block I/O service.
+
+  @param[in]  This   The block I/O protocol instance.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+TestFlushBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Return a pseudo-random number.
+
+  @return The next number of the sequence.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mTestSeed = mTestSeed * 1103515245 + 12345;
+  return mTestSeed >> 8;
+}
+
+/**
+  Fill the disk and its copy with a pattern, and set up an empty cache.
+
+  @param[in]  Context  Unit test case context
+
+  @retval UNIT_TEST_PASSED  The cache is ready.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestInitVolume (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  if (mTestVolume.CacheBuffer != NULL) {
+    FreePool (mTestVolume.CacheBuffer);
+  }
+
+  ZeroMem (&mTestVolume, sizeof (mTestVolume));
+  mTestBlockIo.FlushBlocks = TestFlushBlocks;
+  mTestVolume.BlockIo      = &mTestBlockIo;
+  mTestVolume.FatType      = Fat12;
+  mTestVolume.NumFats      = 1;
+  mTestVolume.FatPos       = TEST_FAT_POS;
+  mTestVolume.FatSize      = TEST_FAT_SIZE;
+  mTestVolume.RootPos      = TEST_ROOT_POS;
+  mTestVolume.VolumeSize   = TEST_VOLUME_SIZE;
+  UT_ASSERT_NOT_EFI_ERROR (FatInitializeDiskCache (&mTestVolume));
+  UT_ASSERT_EQUAL (mTestVolume.DiskCache[CacheData].PageAlignment, 13);
+
+  for (Index = 0; Index < TEST_VOLUME_SIZE; Index++) {
+    mTestDisk[Index] = (UINT8)(Index * 7 + (Index >> 13));
+  }
+
+  CopyMem (mTestModel, mTestDisk, TEST_VOLUME_SIZE);
+  mTestDiskReads  = 0;
+  mTestDiskWrites = 0;
+  mTestLastSize   = 0;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Read one byte of a data page through the data cache.
+
+  @param[in]  PageNo  The data cache page.
+  @param[in]  Offset  The offset in the page.
+
+  @return The byte.
+**/
+UINT8
+TestReadByte (
+  IN UINTN  PageNo,
+  IN UINTN  Offset
+  )
+{
+  UINT8  Value;
+
+  Value = 0;
+  FatAccessCache (&mTestVolume, CacheData, ReadDisk, TEST_ROOT_POS + PageNo * TEST_PAGE_SIZE + Offset, 1, &Value, NULL);
+  return Value;
+}
+
+/**
+  Check that a byte of a data page read through the cache matches the copy
+  of the disk.
+
+  @param[in]  PageNo  The data cache page.
+
+  @retval TRUE   The byte matches.
+  @retval FALSE  The byte does not match.
+**/
+BOOLEAN
+TestCheckPage (
+  IN UINTN  PageNo
+  )
+{
+  UINTN  Offset;
+
+  Offset = TEST_PAGE_SIZE / 2 + PageNo;
+  return (BOOLEAN)(TestReadByte (PageNo, Offset) == mTestModel[TEST_ROOT_POS + PageNo * TEST_PAGE_SIZE + Offset]);
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  A miss in a full set must replace the least recently used page of the set.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DiskCacheEvictLru (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DISK_CACHE  *DiskCache;
+  UINTN       Sets;
+  UINTN       Way;
+
+  DiskCache = &mTestVolume.DiskCache[CacheData];
+  Sets      = DiskCache->GroupMask + 1;
+  UT_ASSERT_EQUAL (DiskCache->WayCount, FAT_DATACACHE_WAY_COUNT);
+
+  //
+  // Fill set 1, then use every page but the first one again
+  //
+  for (Way = 0; Way < DiskCache->WayCount; Way++) {
+    UT_ASSERT_TRUE (TestCheckPage (1 + Way * Sets));
+  }
+
+  UT_ASSERT_EQUAL (mTestDiskReads, DiskCache->WayCount);
+  for (Way = 1; Way < DiskCache->WayCount; Way++) {
+    UT_ASSERT_TRUE (TestCheckPage (1 + Way * Sets));
+  }
+
+  UT_ASSERT_EQUAL (mTestDiskReads, DiskCache->WayCount);
+
+  //
+  // The next page of the set replaces the first page only
+  //
+  UT_ASSERT_TRUE (TestCheckPage (1 + DiskCache->WayCount * Sets));
+  UT_ASSERT_EQUAL (mTestDiskReads, DiskCache->WayCount + 1);
+  for (Way = 1; Way < DiskCache->WayCount; Way++) {
+    UT_ASSERT_TRUE (TestCheckPage (1 + Way * Sets));
+  }
+
+  UT_ASSERT_EQUAL (mTestDiskReads, DiskCache->WayCount + 1);
+
+  //
+  // The first page is read again and replaces the page that was used least
+  // recently, the one that replaced it
+  //
+  UT_ASSERT_TRUE (TestCheckPage (1));
+  UT_ASSERT_EQUAL (mTestDiskReads, DiskCache->WayCount + 2);
+  UT_ASSERT_TRUE (TestCheckPage (1 + Sets));
+  UT_ASSERT_EQUAL (mTestDiskReads, DiskCache->WayCount + 2);
+  UT_ASSERT_TRUE (TestCheckPage (1 + DiskCache->WayCount * Sets));
+  UT_ASSERT_EQUAL (mTestDiskReads, DiskCache->WayCount + 3);
+
+  //
+  // Other sets are not affected
+  //
+  UT_ASSERT_TRUE (TestCheckPage (2));
+  UT_ASSERT_EQUAL (mTestDiskReads, DiskCache->WayCount + 4);
+  UT_ASSERT_EQUAL (mTestDiskWrites, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A dirty page must be written back when it is replaced, and not before.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DiskCacheEvictDirty (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DISK_CACHE  *DiskCache;
+  UINTN       Sets;
+  UINTN       Way;
+  UINT64      Offset;
+  UINT8       Value;
+
+  DiskCache = &mTestVolume.DiskCache[CacheData];
+  Sets      = DiskCache->GroupMask + 1;
+  Offset    = TEST_ROOT_POS + 2 * TEST_PAGE_SIZE + 100;
+  Value     = (UINT8)~mTestDisk[Offset];
+  UT_ASSERT_NOT_EFI_ERROR (FatAccessCache (&mTestVolume, CacheData, WriteDisk, Offset, 1, &Value, NULL));
+  mTestModel[Offset] = Value;
+  UT_ASSERT_EQUAL (mTestDiskWrites, 0);
+  UT_ASSERT_EQUAL (TestReadByte (2, 100), Value);
+
+  for (Way = 1; Way < DiskCache->WayCount; Way++) {
+    UT_ASSERT_TRUE (TestCheckPage (2 + Way * Sets));
+  }
+
+  UT_ASSERT_EQUAL (mTestDiskWrites, 0);
+  UT_ASSERT_TRUE (mTestDisk[Offset] != Value);
+
+  UT_ASSERT_TRUE (TestCheckPage (2 + DiskCache->WayCount * Sets));
+  UT_ASSERT_EQUAL (mTestDiskWrites, 1);
+  UT_ASSERT_EQUAL (mTestLastSize, TEST_PAGE_SIZE);
+  UT_ASSERT_EQUAL (mTestDisk[Offset], Value);
+  UT_ASSERT_MEM_EQUAL (mTestDisk, mTestModel, TEST_VOLUME_SIZE);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Sequential misses must read the following pages ahead with one disk read,
+  up to the end of the way and up to a page that is already cached.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DiskCacheReadAhead (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DISK_CACHE  *DiskCache;
+  UINTN       PageNo;
+
+  DiskCache = &mTestVolume.DiskCache[CacheData];
+  UT_ASSERT_EQUAL (DiskCache->GroupMask, 7);
+  UT_ASSERT_EQUAL (DiskCache->ReadAheadCount, 4);
+
+  //
+  // The first miss is not sequential yet
+  //
+  UT_ASSERT_TRUE (TestCheckPage (0));
+  UT_ASSERT_EQUAL (mTestDiskReads, 1);
+  UT_ASSERT_EQUAL (mTestLastSize, TEST_PAGE_SIZE);
+
+  //
+  // Pages 1 to 5 are read together, 6 and 7 up to the end of the way
+  //
+  UT_ASSERT_TRUE (TestCheckPage (1));
+  UT_ASSERT_EQUAL (mTestDiskReads, 2);
+  UT_ASSERT_EQUAL (mTestLastSize, 5 * TEST_PAGE_SIZE);
+  for (PageNo = 2; PageNo <= 5; PageNo++) {
+    UT_ASSERT_TRUE (TestCheckPage (PageNo));
+  }
+
+  UT_ASSERT_EQUAL (mTestDiskReads, 2);
+  UT_ASSERT_TRUE (TestCheckPage (6));
+  UT_ASSERT_EQUAL (mTestDiskReads, 3);
+  UT_ASSERT_EQUAL (mTestLastSize, 2 * TEST_PAGE_SIZE);
+  UT_ASSERT_TRUE (TestCheckPage (7));
+  UT_ASSERT_TRUE (TestCheckPage (8));
+  UT_ASSERT_EQUAL (mTestDiskReads, 4);
+  UT_ASSERT_EQUAL (mTestLastSize, 5 * TEST_PAGE_SIZE);
+
+  //
+  // Read-ahead stops at page 21, which is cached already
+  //
+  UT_ASSERT_TRUE (TestCheckPage (21));
+  UT_ASSERT_TRUE (TestCheckPage (16));
+  UT_ASSERT_TRUE (TestCheckPage (17));
+  UT_ASSERT_EQUAL (mTestDiskReads, 7);
+  UT_ASSERT_EQUAL (mTestLastSize, 4 * TEST_PAGE_SIZE);
+
+  //
+  // A miss that does not continue the previous one reads one page
+  //
+  UT_ASSERT_TRUE (TestCheckPage (40));
+  UT_ASSERT_EQUAL (mTestLastSize, TEST_PAGE_SIZE);
+  UT_ASSERT_TRUE (TestCheckPage (30));
+  UT_ASSERT_EQUAL (mTestLastSize, TEST_PAGE_SIZE);
+
+  //
+  // Read-ahead stops at the end of the volume
+  //
+  UT_ASSERT_TRUE (TestCheckPage (TEST_DATA_PAGES - 4));
+  UT_ASSERT_TRUE (TestCheckPage (TEST_DATA_PAGES - 3));
+  UT_ASSERT_EQUAL (mTestLastSize, 3 * TEST_PAGE_SIZE);
+  UT_ASSERT_TRUE (TestCheckPage (TEST_DATA_PAGES - 2));
+  UT_ASSERT_TRUE (TestCheckPage (TEST_DATA_PAGES - 1));
+  UT_ASSERT_EQUAL (mTestDiskReads, 11);
+  UT_ASSERT_EQUAL (mTestDiskWrites, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Read-ahead must not replace a dirty page, and must not overwrite the data
+  of a page that is dirty in another way.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DiskCacheReadAheadDirty (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DISK_CACHE  *DiskCache;
+  UINT64      Offset;
+  UINT8       Value;
+
+  DiskCache = &mTestVolume.DiskCache[CacheData];
+
+  //
+  // Page 11 is dirty in way 0 of set 3
+  //
+  Offset = TEST_ROOT_POS + 11 * TEST_PAGE_SIZE;
+  Value  = (UINT8)~mTestDisk[Offset];
+  UT_ASSERT_NOT_EFI_ERROR (FatAccessCache (&mTestVolume, CacheData, WriteDisk, Offset, 1, &Value, NULL));
+  mTestModel[Offset] = Value;
+  UT_ASSERT_EQUAL (DiskCache->CacheTag[3].PageNo, 11);
+
+  //
+  // Pages 0 to 2 go to way 0, where read-ahead stops before the dirty page
+  // 11. Page 3 then goes to way 1.
+  //
+  UT_ASSERT_TRUE (TestCheckPage (0));
+  UT_ASSERT_TRUE (TestCheckPage (1));
+  UT_ASSERT_EQUAL (mTestLastSize, 2 * TEST_PAGE_SIZE);
+  UT_ASSERT_TRUE (TestCheckPage (2));
+  UT_ASSERT_EQUAL (mTestDiskReads, 3);
+  UT_ASSERT_TRUE (TestCheckPage (3));
+  UT_ASSERT_EQUAL (mTestDiskReads, 4);
+  UT_ASSERT_EQUAL (DiskCache->CacheTag[3].PageNo, 11);
+  UT_ASSERT_EQUAL (DiskCache->CacheTag[DiskCache->GroupMask + 1 + 3].PageNo, 3);
+  UT_ASSERT_EQUAL (TestReadByte (11, 0), Value);
+  UT_ASSERT_EQUAL (mTestDiskWrites, 0);
+
+  UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (&mTestVolume, NULL));
+  UT_ASSERT_MEM_EQUAL (mTestDisk, mTestModel, TEST_VOLUME_SIZE);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Dirty pages that follow each other in one way and on the disk must be
+  written back with one disk write.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DiskCacheFlushCoalesce (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN   PageNo;
+  UINT64  Offset;
+  UINT8   Value;
+
+  for (PageNo = 0; PageNo < 8; PageNo++) {
+    if (PageNo == 5) {
+      continue;
+    }
+
+    Offset = TEST_ROOT_POS + PageNo * TEST_PAGE_SIZE + PageNo;
+    Value  = (UINT8)~mTestDisk[Offset];
+    UT_ASSERT_NOT_EFI_ERROR (FatAccessCache (&mTestVolume, CacheData, WriteDisk, Offset, 1, &Value, NULL));
+    mTestModel[Offset] = Value;
+  }
+
+  //
+  // Pages 0 to 4 and 6 to 7 are two runs of dirty pages
+  //
+  mTestDiskReads = 0;
+  UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (&mTestVolume, NULL));
+  UT_ASSERT_EQUAL (mTestDiskWrites, 2);
+  UT_ASSERT_EQUAL (mTestLastSize, 2 * TEST_PAGE_SIZE);
+  UT_ASSERT_MEM_EQUAL (mTestDisk, mTestModel, TEST_VOLUME_SIZE);
+
+  //
+  // Nothing is dirty any more
+  //
+  UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (&mTestVolume, NULL));
+  UT_ASSERT_EQUAL (mTestDiskWrites, 2);
+  UT_ASSERT_EQUAL (mTestDiskReads, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Random reads and writes of the data and FAT caches must match a copy of
+  the disk, and the disk must match the copy after every flush.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DiskCacheRandomAccess (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8            *Buffer;
+  UINTN            Step;
+  UINTN            Size;
+  UINT64           Offset;
+  UINT64           Base;
+  UINT64           Limit;
+  UINTN            Index;
+  CACHE_DATA_TYPE  CacheType;
+
+  Buffer = AllocatePool (4 * TEST_PAGE_SIZE);
+  UT_ASSERT_NOT_NULL (Buffer);
+
+  mTestSeed = 1;
+  for (Step = 0; Step < TEST_RANDOM_STEPS; Step++) {
+    //
+    // FAT accesses are smaller than a page, data accesses go up to four
+    // pages and are mostly sequential
+    //
+    if ((TestRandom () % 4) == 0) {
+      CacheType = CacheFat;
+      Base      = TEST_FAT_POS;
+      Limit     = TEST_FAT_POS + TEST_FAT_SIZE;
+      Size      = 1 + TestRandom () % 4;
+      Offset    = Base + TestRandom () % (Limit - Base - Size + 1);
+    } else {
+      CacheType = CacheData;
+      Base      = TEST_ROOT_POS;
+      Limit     = TEST_VOLUME_SIZE;
+      Size      = 1 + TestRandom () % (((TestRandom () % 4) == 0) ? 4 * TEST_PAGE_SIZE : 2048);
+      if ((TestRandom () % 2) == 0) {
+        Offset = Base + (TestRandom () % TEST_DATA_PAGES) * TEST_PAGE_SIZE;
+      } else {
+        Offset = Base + TestRandom () % (Limit - Base);
+      }
+
+      if (Offset + Size > Limit) {
+        Size = (UINTN)(Limit - Offset);
+      }
+    }
+
+    if ((TestRandom () % 3) == 0) {
+      for (Index = 0; Index < Size; Index++) {
+        Buffer[Index] = (UINT8)TestRandom ();
+      }
+
+      UT_ASSERT_NOT_EFI_ERROR (FatAccessCache (&mTestVolume, CacheType, WriteDisk, Offset, Size, Buffer, NULL));
+      CopyMem (mTestModel + Offset, Buffer, Size);
+    } else {
+      UT_ASSERT_NOT_EFI_ERROR (FatAccessCache (&mTestVolume, CacheType, ReadDisk, Offset, Size, Buffer, NULL));
+      UT_ASSERT_MEM_EQUAL (Buffer, mTestModel + Offset, Size);
+    }
+
+    if ((TestRandom () % 1000) == 0) {
+      UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (&mTestVolume, NULL));
+      UT_ASSERT_MEM_EQUAL (mTestDisk, mTestModel, TEST_VOLUME_SIZE);
+    }
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (&mTestVolume, NULL));
+  UT_ASSERT_MEM_EQUAL (mTestDisk, mTestModel, TEST_VOLUME_SIZE);
+  FreePool (Buffer);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Count the disk reads of a sequential scan of the data area in small reads,
+  with and without read-ahead.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DiskCacheSequentialScan (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8   Buffer[TEST_SCAN_READ_SIZE];
+  UINTN   Reads[2];
+  UINTN   Pass;
+  UINT64  Offset;
+
+  for (Pass = 0; Pass < 2; Pass++) {
+    UT_ASSERT_EQUAL (TestInitVolume (NULL), UNIT_TEST_PASSED);
+    if (Pass == 0) {
+      mTestVolume.DiskCache[CacheData].ReadAheadCount = 0;
+    }
+
+    for (Offset = TEST_ROOT_POS; Offset < TEST_VOLUME_SIZE; Offset += TEST_SCAN_READ_SIZE) {
+      UT_ASSERT_NOT_EFI_ERROR (FatAccessCache (&mTestVolume, CacheData, ReadDisk, Offset, TEST_SCAN_READ_SIZE, Buffer, NULL));
+      UT_ASSERT_MEM_EQUAL (Buffer, mTestModel + Offset, TEST_SCAN_READ_SIZE);
+    }
+
+    Reads[Pass] = mTestDiskReads;
+  }
+
+  UT_LOG_INFO (
+    "%d KB in %d byte reads: %Lu disk reads without read-ahead, %Lu with %Lu pages of read-ahead\n",
+    TEST_DATA_PAGES * TEST_PAGE_SIZE / SIZE_1KB,
+    TEST_SCAN_READ_SIZE,
+    (UINT64)Reads[0],
+    (UINT64)Reads[1],
+    (UINT64)mTestVolume.DiskCache[CacheData].ReadAheadCount
+    );
+
+  UT_ASSERT_EQUAL (Reads[0], TEST_DATA_PAGES);
+  UT_ASSERT_TRUE (Reads[1] < Reads[0] / 2);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Main entry point to the unit test.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      DiskCacheTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &DiskCacheTests,
+             Framework,
+             "Disk Cache Tests",
+             "FatPkg.DiskCache",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for DiskCacheTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    DiskCacheTests,
+    "A miss in a full set should replace the least recently used page",
+    "EvictLru",
+    DiskCacheEvictLru,
+    TestInitVolume,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    DiskCacheTests,
+    "A dirty page should be written back when it is replaced",
+    "EvictDirty",
+    DiskCacheEvictDirty,
+    TestInitVolume,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    DiskCacheTests,
+    "Sequential misses should read the following pages ahead",
+    "ReadAhead",
+    DiskCacheReadAhead,
+    TestInitVolume,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    DiskCacheTests,
+    "Read-ahead should stop at a dirty page",
+    "ReadAheadDirty",
+    DiskCacheReadAheadDirty,
+    TestInitVolume,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    DiskCacheTests,
+    "Adjacent dirty pages should be written back together",
+    "FlushCoalesce",
+    DiskCacheFlushCoalesce,
+    TestInitVolume,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    DiskCacheTests,
+    "Random reads and writes should match a copy of the disk",
+    "RandomAccess",
+    DiskCacheRandomAccess,
+    TestInitVolume,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    DiskCacheTests,
+    "A sequential scan should take fewer disk reads with read-ahead",
+    "SequentialScan",
+    DiskCacheSequentialScan,
+    NULL,
+    NULL,
+    NULL
+    );
+
+  mTestDisk  = AllocatePool (TEST_VOLUME_SIZE);
+  mTestModel = AllocatePool (TEST_VOLUME_SIZE);
+  if ((mTestDisk == NULL) || (mTestModel == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
@@ -0,0 +1,423 @@
+/** @file
+  Concurrent Dispatch Protocol implementation.
+
+  A DXE driver queues the CPU bound procedures of its initialization from its
+  entry point. Once the entry point has returned, CoreDispatcher () runs them
+  on the idle APs through the MP Services Protocol and on the BSP, and then
+  the completion routines on the BSP, before it starts the next driver.
+
+  The APs are therefore only busy while the dispatcher waits for them at
+  TPL_CALLBACK, so no driver code that may use the MP Services Protocol, like
+  the MTRR synchronization of the CPU driver, runs while they are.
+
+  The dispatcher waits for the WaitEvent of StartupThisAP (), which the MP
+  Services Protocol signals once it has seen the AP finish, or has reset it on
+  timeout, and considers the AP idle again. A flag of the work item tells the
+  two cases apart.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+
+#define CONCURRENT_WORK_SIGNATURE  SIGNATURE_32 ('c', 'w', 'r', 'k')
+
+typedef struct {
+  UINT32                                  Signature;
+  LIST_ENTRY                              Link;
+  ///
+  /// The image whose entry point queued the work.
+  ///
+  EFI_HANDLE                              ImageHandle;
+  EFI_AP_PROCEDURE                        Procedure;
+  EDKII_CONCURRENT_DISPATCH_COMPLETION    Completion;
+  VOID                                    *Context;
+  ///
+  /// The AP running Procedure. OnAp is set until the AP is idle again.
+  ///
+  UINTN                                   ProcessorNumber;
+  BOOLEAN                                 OnAp;
+  ///
+  /// Set by the processor running Procedure once it has returned.
+  ///
+  volatile BOOLEAN                        Done;
+} CONCURRENT_WORK;
+
+EFI_STATUS
+EFIAPI
+CoreConcurrentDispatchStartWork (
+  IN EDKII_CONCURRENT_DISPATCH_PROTOCOL    *This,
+  IN EFI_AP_PROCEDURE                      Procedure,
+  IN EDKII_CONCURRENT_DISPATCH_COMPLETION  Completion OPTIONAL,
+  IN VOID                                  *Context
+  );
+
+EDKII_CONCURRENT_DISPATCH_PROTOCOL  mConcurrentDispatch = {
+  CoreConcurrentDispatchStartWork
+};
+
+EFI_HANDLE  mConcurrentDispatchHandle = NULL;
+
+//
+// Work queued by the driver being started. List of CONCURRENT_WORK.
+//
+LIST_ENTRY  mConcurrentWorkList = INITIALIZE_LIST_HEAD_VARIABLE (mConcurrentWorkList);
+
+EFI_MP_SERVICES_PROTOCOL  *mMpServices = NULL;
+UINTN                     mProcessorCount;
+UINTN                     mBspNumber;
+UINTN                     mNextProcessor;
+
+//
+// WaitEvent of StartupThisAP () for each processor. An AP only accepts new work
+// once the MP Services Protocol has seen the previous one end, so one event per
+// AP is enough.
+//
+EFI_EVENT  *mApWaitEvent = NULL;
+
+/**
+  Run the procedure of a work item and report its end.
+
+  @param[in, out] Buffer   The CONCURRENT_WORK item.
+
+**/
+VOID
+EFIAPI
+ConcurrentWorkProcedure (
+  IN OUT VOID  *Buffer
+  )
+{
+  CONCURRENT_WORK  *Work;
+
+  Work = (CONCURRENT_WORK *)Buffer;
+  Work->Procedure (Work->Context);
+
+  MemoryFence ();
+  Work->Done = TRUE;
+}
+
+/**
+  Locate the MP Services Protocol and prepare the per AP WaitEvents.
+
+  @retval TRUE    The MP Services Protocol is available and there is an AP.
+  @retval FALSE   The work has to run on the BSP.
+
+**/
+BOOLEAN
+ConcurrentDispatchGetMpServices (
+  VOID
+  )
+{
+  EFI_STATUS                Status;
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+  UINTN                     EnabledProcessorCount;
+  UINTN                     Index;
+
+  if (mApWaitEvent != NULL) {
+    return TRUE;
+  }
+
+  if (mMpServices != NULL) {
+    //
+    // Located before, without any AP or without memory for the events.
+    //
+    return FALSE;
+  }
+
+  Status = CoreLocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **)&MpServices);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  mMpServices = MpServices;
+  Status      = MpServices->GetNumberOfProcessors (MpServices, &mProcessorCount, &EnabledProcessorCount);
+  if (EFI_ERROR (Status) || (EnabledProcessorCount < 2)) {
+    return FALSE;
+  }
+
+  Status = MpServices->WhoAmI (MpServices, &mBspNumber);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  mApWaitEvent = AllocateZeroPool (mProcessorCount * sizeof (EFI_EVENT));
+  if (mApWaitEvent == NULL) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < mProcessorCount; Index++) {
+    if (Index == mBspNumber) {
+      continue;
+    }
+
+    Status = CoreCreateEvent (0, TPL_CALLBACK, NULL, NULL, &mApWaitEvent[Index]);
+    if (EFI_ERROR (Status)) {
+      mApWaitEvent[Index] = NULL;
+    }
+  }
+
+  DEBUG ((DEBUG_DISPATCH, "Concurrent dispatch on %d processors\n", EnabledProcessorCount));
+  return TRUE;
+}
+
+/**
+  Start the procedure of a work item on an idle AP.
+
+  @param[in, out] Work   The work item.
+
+  @retval TRUE    The procedure has been started on an AP.
+  @retval FALSE   No AP is idle.
+
+**/
+BOOLEAN
+ConcurrentDispatchStartOnAp (
+  IN OUT CONCURRENT_WORK  *Work
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Count;
+  UINTN       ProcessorNumber;
+
+  if (!ConcurrentDispatchGetMpServices ()) {
+    return FALSE;
+  }
+
+  //
+  // Start from the AP after the last one used; a busy AP returns EFI_NOT_READY
+  // and a disabled one EFI_INVALID_PARAMETER. The MP Services Protocol resets
+  // the AP and signals the WaitEvent if the procedure does not return in time.
+  //
+  for (Count = 0; Count < mProcessorCount; Count++) {
+    ProcessorNumber = (mNextProcessor + Count) % mProcessorCount;
+    if ((ProcessorNumber == mBspNumber) || (mApWaitEvent[ProcessorNumber] == NULL)) {
+      continue;
+    }
+
+    Status = mMpServices->StartupThisAP (
+                            mMpServices,
+                            ConcurrentWorkProcedure,
+                            ProcessorNumber,
+                            mApWaitEvent[ProcessorNumber],
+                            PcdGet32 (PcdDxeCoreConcurrentDispatchApTimeout),
+                            Work,
+                            NULL
+                            );
+    if (!EFI_ERROR (Status)) {
+      Work->ProcessorNumber = ProcessorNumber;
+      Work->OnAp            = TRUE;
+      mNextProcessor        = ProcessorNumber + 1;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Run the CPU bound part of a driver initialization concurrently with the
+  other CPU bound parts queued by the same driver.
+
+  @param[in] This         The EDKII_CONCURRENT_DISPATCH_PROTOCOL instance.
+  @param[in] Procedure    The CPU bound part of the initialization.
+  @param[in] Completion   Optional. The part of the initialization that
+                          publishes the results.
+  @param[in] Context      The context passed to Procedure and Completion.
+
+  @retval EFI_SUCCESS            Procedure has been queued, or has run.
+  @retval EFI_INVALID_PARAMETER  Procedure is NULL.
+  @retval EFI_OUT_OF_RESOURCES   There are not enough resources to track the
+                                 work. Neither routine has been called.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreConcurrentDispatchStartWork (
+  IN EDKII_CONCURRENT_DISPATCH_PROTOCOL    *This,
+  IN EFI_AP_PROCEDURE                      Procedure,
+  IN EDKII_CONCURRENT_DISPATCH_COMPLETION  Completion OPTIONAL,
+  IN VOID                                  *Context
+  )
+{
+  CONCURRENT_WORK            *Work;
+  LOADED_IMAGE_PRIVATE_DATA  *Image;
+
+  if (Procedure == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Only queue the work of a driver entry point run by the dispatcher, which
+  // runs it as soon as the entry point returns.
+  //
+  Image = CoreGetCurrentImage ();
+  if (gDispatcherRunning && (gEfiCurrentTpl == TPL_APPLICATION) &&
+      (Image->Handle != gDxeCoreImageHandle) &&
+      (Image->Type != EFI_IMAGE_SUBSYSTEM_EFI_APPLICATION))
+  {
+    Work = AllocateZeroPool (sizeof (CONCURRENT_WORK));
+    if (Work == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    Work->Signature   = CONCURRENT_WORK_SIGNATURE;
+    Work->ImageHandle = Image->Handle;
+    Work->Procedure   = Procedure;
+    Work->Completion  = Completion;
+    Work->Context     = Context;
+    InsertTailList (&mConcurrentWorkList, &Work->Link);
+    return EFI_SUCCESS;
+  }
+
+  Procedure (Context);
+  if (Completion != NULL) {
+    Completion (Context);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Run the concurrent work queued by the driver that has just been started.
+
+  The procedures run on the idle APs and on the BSP. Once all of them have
+  returned, or have been aborted on timeout, the completion routines of the
+  procedures that returned run on the BSP in the order the work was queued.
+
+**/
+VOID
+CoreRunConcurrentWork (
+  VOID
+  )
+{
+  LIST_ENTRY       *Link;
+  CONCURRENT_WORK  *Work;
+  EFI_TPL          OldTpl;
+  BOOLEAN          Pending;
+
+  if (IsListEmpty (&mConcurrentWorkList)) {
+    return;
+  }
+
+  PERF_INMODULE_BEGIN ("ConcurrentDispatchWait");
+
+  //
+  // No notification function may run while an AP is busy, as it could use the
+  // MP Services Protocol. The MP Services Protocol checks the APs at TPL_NOTIFY.
+  //
+  OldTpl = CoreRaiseTpl (TPL_CALLBACK);
+
+  for (Link = mConcurrentWorkList.ForwardLink; Link != &mConcurrentWorkList; Link = Link->ForwardLink) {
+    Work = CR (Link, CONCURRENT_WORK, Link, CONCURRENT_WORK_SIGNATURE);
+    if (!ConcurrentDispatchStartOnAp (Work)) {
+      break;
+    }
+  }
+
+  for ( ; Link != &mConcurrentWorkList; Link = Link->ForwardLink) {
+    Work = CR (Link, CONCURRENT_WORK, Link, CONCURRENT_WORK_SIGNATURE);
+    ConcurrentWorkProcedure (Work);
+  }
+
+  do {
+    Pending = FALSE;
+    for (Link = mConcurrentWorkList.ForwardLink; Link != &mConcurrentWorkList; Link = Link->ForwardLink) {
+      Work = CR (Link, CONCURRENT_WORK, Link, CONCURRENT_WORK_SIGNATURE);
+      if (!Work->OnAp) {
+        continue;
+      }
+
+      //
+      // Done is not enough, the AP is only idle for the MP Services Protocol
+      // once it has signaled the WaitEvent. If Done is still not set then, the
+      // AP has been reset on timeout.
+      //
+      if (EFI_ERROR (CoreCheckEvent (mApWaitEvent[Work->ProcessorNumber]))) {
+        Pending = TRUE;
+        continue;
+      }
+
+      MemoryFence ();
+      if (!Work->Done) {
+        DEBUG ((DEBUG_ERROR, "Concurrent work of image %p timed out on processor %d\n", Work->ImageHandle, Work->ProcessorNumber));
+      }
+
+      Work->OnAp = FALSE;
+    }
+
+    if (Pending) {
+      CpuPause ();
+    }
+  } while (Pending);
+
+  CoreRestoreTpl (OldTpl);
+
+  PERF_INMODULE_END ("ConcurrentDispatchWait");
+
+  //
+  // A completion routine may queue more work, which then runs on the BSP in
+  // StartWork () as the dispatcher has left the entry point.
+  //
+  while (!IsListEmpty (&mConcurrentWorkList)) {
+    Work = CR (mConcurrentWorkList.ForwardLink, CONCURRENT_WORK, Link, CONCURRENT_WORK_SIGNATURE);
+    RemoveEntryList (&Work->Link);
+    if (Work->Done && (Work->Completion != NULL)) {
+      Work->Completion (Work->Context);
+    }
+
+    CoreFreePool (Work);
+  }
+}
+
+/**
+  Discard the concurrent work queued by an image that is being unloaded,
+  without running it.
+
+  @param[in] ImageHandle   The image being unloaded.
+
+**/
+VOID
+CoreDiscardConcurrentWork (
+  IN EFI_HANDLE  ImageHandle
+  )
+{
+  LIST_ENTRY       *Link;
+  LIST_ENTRY       *NextLink;
+  CONCURRENT_WORK  *Work;
+
+  for (Link = mConcurrentWorkList.ForwardLink; Link != &mConcurrentWorkList; Link = NextLink) {
+    NextLink = Link->ForwardLink;
+    Work     = CR (Link, CONCURRENT_WORK, Link, CONCURRENT_WORK_SIGNATURE);
+    if (Work->ImageHandle == ImageHandle) {
+      DEBUG ((DEBUG_WARN, "Concurrent work of image %p discarded\n", ImageHandle));
+      RemoveEntryList (&Work->Link);
+      CoreFreePool (Work);
+    }
+  }
+}
+
+/**
+  Install the Concurrent Dispatch Protocol if PcdDxeCoreConcurrentDispatch is
+  TRUE.
+
+**/
+VOID
+CoreInitializeConcurrentDispatch (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  if (!FeaturePcdGet (PcdDxeCoreConcurrentDispatch)) {
+    return;
+  }
+
+  Status = CoreInstallMultipleProtocolInterfaces (
+             &mConcurrentDispatchHandle,
+             &gEdkiiConcurrentDispatchProtocolGuid,
+             &mConcurrentDispatch,
+             NULL
+             );
+  ASSERT_EFI_ERROR (Status);
+}
@@ -517,6 +517,12 @@ CoreDispatcher (
 
         Status = CoreStartImage (DriverEntry->ImageHandle, NULL, NULL);
 
+        //
+        // Run the concurrent work queued by the entry point before any other
+        // driver code runs.
+        //
+        CoreRunConcurrentWork ();
+
         REPORT_STATUS_CODE_WITH_EXTENDED_DATA (
           EFI_PROGRESS_CODE,
           (EFI_SOFTWARE_DXE_CORE | EFI_SW_PC_INIT_END),
@@ -45,9 +45,13 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/HiiPackageList.h>
 #include <Protocol/SmmBase2.h>
 #include <Protocol/PeCoffImageEmulator.h>
+#include <Protocol/MpService.h>
+#include <Protocol/ConcurrentDispatch.h>
 #include <Guid/MemoryTypeInformation.h>
 #include <Guid/FirmwareFileSystem2.h>
 #include <Guid/FirmwareFileSystem3.h>
+#include <Guid/FvFileIndexHob.h>
+#include <Guid/HobIndexTable.h>
 #include <Guid/HobList.h>
 #include <Guid/DebugImageInfoTable.h>
 #include <Guid/FileInfo.h>
@@ -1423,6 +1427,20 @@ CoreExit (
   IN CHAR16      *ExitData  OPTIONAL
   );
 
+/**
+  Print the totals of the image load report.
+
+  The images read from a firmware volume in place and the images read into a
+  copy are reported apart, so that the load time saved by the in place path
+  can be compared on a platform. Times are 0 for images loaded before the CPU
+  Architectural Protocol is installed.
+
+**/
+VOID
+CoreDumpImageLoadReport (
+  VOID
+  );
+
 /**
   Creates an event.
 
@@ -1916,6 +1934,53 @@ CoreDispatcher (
   VOID
   );
 
+/**
+  Install the Concurrent Dispatch Protocol if PcdDxeCoreConcurrentDispatch is
+  TRUE.
+
+**/
+VOID
+CoreInitializeConcurrentDispatch (
+  VOID
+  );
+
+/**
+  Run the concurrent work queued by the driver that has just been started.
+
+  The procedures run on the idle APs and on the BSP. Once all of them have
+  returned, or have been aborted on timeout, the completion routines of the
+  procedures that returned run on the BSP in the order the work was queued.
+
+**/
+VOID
+CoreRunConcurrentWork (
+  VOID
+  );
+
+/**
+  Discard the concurrent work queued by an image that is being unloaded,
+  without running it.
+
+  @param[in] ImageHandle   The image being unloaded.
+
+**/
+VOID
+CoreDiscardConcurrentWork (
+  IN EFI_HANDLE  ImageHandle
+  );
+
+/**
+  Return the image whose entry point is running.
+
+  @return  The private data of the image started last, or of the DXE Core if
+           no image entry point is running.
+
+**/
+LOADED_IMAGE_PRIVATE_DATA *
+CoreGetCurrentImage (
+  VOID
+  );
+
 /**
   Check every driver and locate a matching one. If the driver is found, the Unrequested
   state flag is cleared.
@@ -1974,6 +2039,36 @@ FwVolDriverInit (
   IN EFI_SYSTEM_TABLE  *SystemTable
   );
 
+/**
+  Locate the PE32 section of a file in a firmware volume produced by the DXE
+  core, without copying it.
+
+  Only a PE32 section that is stored in the file itself and precedes any
+  encapsulation section is returned, in system memory, so that it is the same
+  section as the one returned by ReadSection () and cannot change while the
+  image is verified and loaded. In every other case the caller must use
+  ReadSection ().
+
+  @param  Fv                     The firmware volume protocol instance.
+  @param  NameGuid               Name of the file.
+  @param  Buffer                 Pointer to the PE32 image in the firmware volume.
+  @param  BufferSize             Size of the PE32 image.
+  @param  AuthenticationStatus   Authentication status of the firmware volume.
+
+  @retval EFI_SUCCESS            The PE32 image was found.
+  @retval EFI_UNSUPPORTED        The PE32 image cannot be accessed in place.
+  @retval EFI_NOT_FOUND          The file does not exist.
+
+**/
+EFI_STATUS
+FvLocatePe32Section (
+  IN  EFI_FIRMWARE_VOLUME2_PROTOCOL  *Fv,
+  IN  CONST EFI_GUID                 *NameGuid,
+  OUT VOID                           **Buffer,
+  OUT UINTN                          *BufferSize,
+  OUT UINT32                         *AuthenticationStatus
+  );
+
 /**
   Entry point of the section extraction code. Initializes an instance of the
   section extraction interface and installs it on a new handle.
@@ -2696,6 +2791,18 @@ InstallMemoryAttributesTableOnMemoryAllocation (
   IN EFI_MEMORY_TYPE  MemoryType
   );
 
+/**
+  Build the index of the GUID HOBs of the HOB list and install it in the EFI
+  System Table as the gEdkiiHobIndexTableGuid configuration table.
+
+  @param  HobStart       Pointer to the HOB list.
+
+**/
+VOID
+CoreInstallHobIndexTable (
+  IN VOID  *HobStart
+  );
+
 /**
   Insert image record.
 
@@ -353,6 +353,11 @@ DxeMain (
   Status = CoreInstallConfigurationTable (&gEfiHobListGuid, HobStart);
   ASSERT_EFI_ERROR (Status);
 
+  //
+  // Index the GUID HOBs for the HOB library instances of DXE drivers
+  //
+  CoreInstallHobIndexTable (HobStart);
+
   //
   // Install Memory Type Information Table into the EFI System Tables's Configuration Table
   //
@@ -503,6 +508,12 @@ DxeMain (
              );
   ASSERT_EFI_ERROR (Status);
 
+  //
+  // Publish the Concurrent Dispatch protocol for DXE drivers with CPU bound
+  // initialization.
+  //
+  CoreInitializeConcurrentDispatch ();
+
   //
   // Register for the GUIDs of the Architectural Protocols, so the rest of the
   // EFI Boot Services and EFI Runtime Services tables can be filled in.
@@ -774,6 +785,10 @@ CoreExitBootServices (
   //
   CoreNotifySignalList (&gEfiEventBeforeExitBootServicesGuid);
 
+  DEBUG_CODE (
+    CoreDumpImageLoadReport ();
+    );
+
   //
   // Disable Timer
   //
@@ -29,11 +29,25 @@ extern  UINTN  gEventPending;
 ///
 /// Timer event information
 ///
-typedef struct {
-  LIST_ENTRY    Link;
-  UINT64        TriggerTime;
-  UINT64        Period;
-} TIMER_EVENT_INFO;
+typedef struct _TIMER_EVENT_INFO TIMER_EVENT_INFO;
+struct _TIMER_EVENT_INFO {
+  ///
+  /// Links of the pairing heap that forms the timer database
+  ///
+  TIMER_EVENT_INFO    *Child;
+  TIMER_EVENT_INFO    *Sibling;
+  ///
+  /// Parent if this is the leftmost child, left sibling otherwise
+  ///
+  TIMER_EVENT_INFO    *Prev;
+  BOOLEAN             Queued;
+  UINT64              TriggerTime;
+  UINT64              Period;
+  ///
+  /// Order of insertion, keeps timers with the same TriggerTime first in first out
+  ///
+  UINT64              Sequence;
+};
 
 #define EVENT_SIGNATURE  SIGNATURE_32('e','v','n','t')
 typedef struct {
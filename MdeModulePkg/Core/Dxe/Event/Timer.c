@@ -12,10 +12,15 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 // Internal data
 //
+// The timer database is a pairing heap ordered by trigger time, so arming
+// a timer is O(1) and cancelling or expiring one is O(log n) amortized,
+// without allocating memory at TPL_HIGH_LEVEL - 1.
+//
 
-LIST_ENTRY  mEfiTimerList       = INITIALIZE_LIST_HEAD_VARIABLE (mEfiTimerList);
-EFI_LOCK    mEfiTimerLock       = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL - 1);
-EFI_EVENT   mEfiCheckTimerEvent = NULL;
+TIMER_EVENT_INFO  *mEfiTimerHeap      = NULL;
+UINT64            mEfiTimerSequence   = 0;
+EFI_LOCK          mEfiTimerLock       = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL - 1);
+EFI_EVENT         mEfiCheckTimerEvent = NULL;
 
 EFI_LOCK  mEfiSystemTimeLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL);
 UINT64    mEfiSystemTime     = 0;
@@ -24,6 +29,130 @@ UINT64    mEfiSystemTime     = 0;
 // Timer functions
 //
 
+/**
+  Checks if a timer expires before another one. Timers with the same
+  trigger time expire in the order they were inserted.
+
+  @param  Timer1                 The first timer
+  @param  Timer2                 The second timer
+
+  @retval TRUE                   Timer1 expires before Timer2
+  @retval FALSE                  Timer2 expires before Timer1
+
+**/
+BOOLEAN
+CoreTimerIsBefore (
+  IN TIMER_EVENT_INFO  *Timer1,
+  IN TIMER_EVENT_INFO  *Timer2
+  )
+{
+  if (Timer1->TriggerTime != Timer2->TriggerTime) {
+    return (BOOLEAN)(Timer1->TriggerTime < Timer2->TriggerTime);
+  }
+
+  return (BOOLEAN)(Timer1->Sequence < Timer2->Sequence);
+}
+
+/**
+  Melds two timer heaps. Both heaps must be detached from any other heap.
+
+  @param  Heap1                  The root of the first heap
+  @param  Heap2                  The root of the second heap
+
+  @return The root of the melded heap
+
+**/
+TIMER_EVENT_INFO *
+CoreMeldTimerHeap (
+  IN TIMER_EVENT_INFO  *Heap1,
+  IN TIMER_EVENT_INFO  *Heap2
+  )
+{
+  TIMER_EVENT_INFO  *Swap;
+
+  if (CoreTimerIsBefore (Heap2, Heap1)) {
+    Swap  = Heap1;
+    Heap1 = Heap2;
+    Heap2 = Swap;
+  }
+
+  //
+  // Heap2 becomes the leftmost child of Heap1
+  //
+  Heap2->Prev    = Heap1;
+  Heap2->Sibling = Heap1->Child;
+  if (Heap1->Child != NULL) {
+    Heap1->Child->Prev = Heap2;
+  }
+
+  Heap1->Child = Heap2;
+  return Heap1;
+}
+
+/**
+  Combines a list of sibling timer heaps into one heap with the two-pass
+  pairing algorithm.
+
+  @param  First                  The leftmost heap of the sibling list
+
+  @return The root of the combined heap, or NULL if the list is empty
+
+**/
+TIMER_EVENT_INFO *
+CoreCombineTimerHeaps (
+  IN TIMER_EVENT_INFO  *First
+  )
+{
+  TIMER_EVENT_INFO  *Pairs;
+  TIMER_EVENT_INFO  *Heap1;
+  TIMER_EVENT_INFO  *Heap2;
+  TIMER_EVENT_INFO  *Next;
+
+  //
+  // First pass: meld the siblings in pairs from left to right, and push the
+  // results onto a list that ends up ordered from right to left
+  //
+  Pairs = NULL;
+  while (First != NULL) {
+    Heap1       = First;
+    Heap2       = First->Sibling;
+    Heap1->Prev = NULL;
+    if (Heap2 == NULL) {
+      Heap1->Sibling = Pairs;
+      Pairs          = Heap1;
+      break;
+    }
+
+    Next           = Heap2->Sibling;
+    Heap1->Sibling = NULL;
+    Heap2->Sibling = NULL;
+    Heap2->Prev    = NULL;
+    Heap1          = CoreMeldTimerHeap (Heap1, Heap2);
+    Heap1->Sibling = Pairs;
+    Pairs          = Heap1;
+    First          = Next;
+  }
+
+  if (Pairs == NULL) {
+    return NULL;
+  }
+
+  //
+  // Second pass: meld the pairs from right to left into one heap
+  //
+  Heap1          = Pairs;
+  Pairs          = Pairs->Sibling;
+  Heap1->Sibling = NULL;
+  while (Pairs != NULL) {
+    Next           = Pairs->Sibling;
+    Pairs->Sibling = NULL;
+    Heap1          = CoreMeldTimerHeap (Heap1, Pairs);
+    Pairs          = Next;
+  }
+
+  return Heap1;
+}
+
 /**
   Inserts the timer event.
 
@@ -36,29 +165,74 @@ CoreInsertEventTimer (
   IN IEVENT  *Event
   )
 {
-  UINT64      TriggerTime;
-  LIST_ENTRY  *Link;
-  IEVENT      *Event2;
+  TIMER_EVENT_INFO  *Timer;
 
   ASSERT_LOCKED (&mEfiTimerLock);
+  ASSERT (!Event->Timer.Queued);
 
-  //
-  // Get the timer's trigger time
-  //
-  TriggerTime = Event->Timer.TriggerTime;
+  Timer           = &Event->Timer;
+  Timer->Child    = NULL;
+  Timer->Sibling  = NULL;
+  Timer->Prev     = NULL;
+  Timer->Sequence = mEfiTimerSequence++;
+  Timer->Queued   = TRUE;
 
   //
-  // Insert the timer into the timer database in assending sorted order
+  // Meld the timer into the timer database
   //
-  for (Link = mEfiTimerList.ForwardLink; Link != &mEfiTimerList; Link = Link->ForwardLink) {
-    Event2 = CR (Link, IEVENT, Timer.Link, EVENT_SIGNATURE);
+  if (mEfiTimerHeap == NULL) {
+    mEfiTimerHeap = Timer;
+  } else {
+    mEfiTimerHeap = CoreMeldTimerHeap (mEfiTimerHeap, Timer);
+  }
+}
 
-    if (Event2->Timer.TriggerTime > TriggerTime) {
-      break;
+/**
+  Removes the timer event from the timer database.
+
+  @param  Event                  Points to the internal structure of timer event
+                                 to be removed
+
+**/
+VOID
+CoreRemoveEventTimer (
+  IN IEVENT  *Event
+  )
+{
+  TIMER_EVENT_INFO  *Timer;
+  TIMER_EVENT_INFO  *SubHeap;
+
+  ASSERT_LOCKED (&mEfiTimerLock);
+  ASSERT (Event->Timer.Queued);
+
+  Timer = &Event->Timer;
+  if (Timer == mEfiTimerHeap) {
+    mEfiTimerHeap = CoreCombineTimerHeaps (Timer->Child);
+  } else {
+    //
+    // Unlink the timer from its parent or left sibling, then meld its
+    // children back into the timer database
+    //
+    if (Timer->Prev->Child == Timer) {
+      Timer->Prev->Child = Timer->Sibling;
+    } else {
+      Timer->Prev->Sibling = Timer->Sibling;
+    }
+
+    if (Timer->Sibling != NULL) {
+      Timer->Sibling->Prev = Timer->Prev;
+    }
+
+    SubHeap = CoreCombineTimerHeaps (Timer->Child);
+    if (SubHeap != NULL) {
+      mEfiTimerHeap = CoreMeldTimerHeap (mEfiTimerHeap, SubHeap);
     }
   }
 
-  InsertTailList (Link, &Event->Timer.Link);
+  Timer->Child   = NULL;
+  Timer->Sibling = NULL;
+  Timer->Prev    = NULL;
+  Timer->Queued  = FALSE;
 }
 
 /**
@@ -82,7 +256,7 @@ CoreCurrentSystemTime (
 }
 
 /**
-  Checks the sorted timer list against the current system time.
+  Checks the timer database against the current system time.
   Signals any expired event timer.
 
   @param  CheckEvent             Not used
@@ -105,8 +279,8 @@ CoreCheckTimers (
   CoreAcquireLock (&mEfiTimerLock);
   SystemTime = CoreCurrentSystemTime ();
 
-  while (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+  while (mEfiTimerHeap != NULL) {
+    Event = CR (mEfiTimerHeap, IEVENT, Timer, EVENT_SIGNATURE);
 
     //
     // If this timer is not expired, then we're done
@@ -119,8 +293,7 @@ CoreCheckTimers (
     // Remove this timer from the timer queue
     //
 
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+    CoreRemoveEventTimer (Event);
 
     //
     // Signal it
@@ -189,7 +362,7 @@ CoreTimerTick (
   IN UINT64  Duration
   )
 {
-  IEVENT  *Event;
+  TIMER_EVENT_INFO  *Timer;
 
   //
   // Check runtiem flag in case there are ticks while exiting boot services
@@ -202,13 +375,12 @@ CoreTimerTick (
   mEfiSystemTime += Duration;
 
   //
-  // If the head of the list is expired, fire the timer event
+  // If the root of the timer database is expired, fire the timer event
   // to process it
   //
-  if (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
-
-    if (Event->Timer.TriggerTime <= mEfiSystemTime) {
+  Timer = mEfiTimerHeap;
+  if (Timer != NULL) {
+    if (Timer->TriggerTime <= mEfiSystemTime) {
       CoreSignalEvent (mEfiCheckTimerEvent);
     }
   }
@@ -260,9 +432,8 @@ CoreSetTimer (
   //
   // If the timer is queued to the timer database, remove it
   //
-  if (Event->Timer.Link.ForwardLink != NULL) {
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+  if (Event->Timer.Queued) {
+    CoreRemoveEventTimer (Event);
   }
 
   Event->Timer.TriggerTime = 0;
@@ -241,6 +241,31 @@ GetFwVolHeader (
   return Status;
 }
 
+/**
+  Computes the FfsFileHashTable bucket index of a file name.
+
+  @param  NameGuid         The file name GUID.
+
+  @return Bucket index in the range [0, FFS_FILE_HASH_SIZE).
+
+**/
+UINTN
+FvHashFileName (
+  IN CONST EFI_GUID  *NameGuid
+  )
+{
+  UINT32  Hash;
+
+  Hash  = ReadUnaligned32 ((CONST UINT32 *)NameGuid);
+  Hash ^= ReadUnaligned32 ((CONST UINT32 *)NameGuid + 1);
+  Hash ^= ReadUnaligned32 ((CONST UINT32 *)NameGuid + 2);
+  Hash ^= ReadUnaligned32 ((CONST UINT32 *)NameGuid + 3);
+  Hash ^= Hash >> 16;
+  Hash ^= Hash >> 8;
+
+  return (UINTN)(Hash & (FFS_FILE_HASH_SIZE - 1));
+}
+
 /**
   Free FvDevice resource when error happens
 
@@ -296,6 +321,147 @@ FreeFvDeviceResource (
   return;
 }
 
+/**
+  Build the file list of a memory mapped FV from the file index the PEI Core
+  produced for it, so that the FFS file headers are not walked again.
+
+  The PEI Core only indexes an FV whose files all pass the checks of FvCheck ().
+  Each indexed file is still checked to be at its recorded offset. As FvCheck ()
+  does, a file with FFS_ATTRIB_CHECKSUM is copied out of the FV and its checksum
+  is verified on the copy, so that later reads do not see a changed flash file.
+
+  @param  FvDevice              A pointer to the FvDevice, with an empty file
+                                list.
+
+  @retval TRUE                  The file list has been built from the index.
+  @retval FALSE                 There is no usable index for the FV. The file
+                                list is empty.
+
+**/
+STATIC
+BOOLEAN
+FvBuildFileListFromIndex (
+  IN OUT FV_DEVICE  *FvDevice
+  )
+{
+  VOID                 *GuidHob;
+  FV_FILE_INDEX        *FileIndex;
+  FV_FILE_INDEX_ENTRY  *Entry;
+  EFI_FFS_FILE_HEADER  *FfsHeader;
+  EFI_FFS_FILE_HEADER  *CacheFfsHeader;
+  FFS_FILE_LIST_ENTRY  *FfsFileEntry;
+  LIST_ENTRY           *Link;
+  UINT32               Index;
+  UINTN                WholeFileSize;
+
+  if (!FvDevice->IsMemoryMapped) {
+    return FALSE;
+  }
+
+  FileIndex = NULL;
+  for (GuidHob = GetFirstGuidHob (&gEdkiiFvFileIndexHobGuid);
+       GuidHob != NULL;
+       GuidHob = GetNextGuidHob (&gEdkiiFvFileIndexHobGuid, GET_NEXT_HOB (GuidHob)))
+  {
+    FileIndex = GET_GUID_HOB_DATA (GuidHob);
+    if ((GET_GUID_HOB_DATA_SIZE (GuidHob) >= sizeof (FV_FILE_INDEX)) &&
+        (FileIndex->FvBase == (EFI_PHYSICAL_ADDRESS)(UINTN)FvDevice->CachedFv) &&
+        (FileIndex->FvLength == FvDevice->FwVolHeader->FvLength) &&
+        (GET_GUID_HOB_DATA_SIZE (GuidHob) >= sizeof (FV_FILE_INDEX) + (UINTN)FileIndex->FileCount * sizeof (FV_FILE_INDEX_ENTRY)))
+    {
+      break;
+    }
+
+    FileIndex = NULL;
+  }
+
+  if (FileIndex == NULL) {
+    return FALSE;
+  }
+
+  Entry = FV_FILE_INDEX_ENTRIES (FileIndex);
+  for (Index = 0; Index < FileIndex->FileCount; Index++) {
+    if (Entry[Index].Offset > FileIndex->FvLength - sizeof (EFI_FFS_FILE_HEADER)) {
+      break;
+    }
+
+    FfsHeader = (EFI_FFS_FILE_HEADER *)(FvDevice->CachedFv + Entry[Index].Offset);
+    if (!CompareGuid (&FfsHeader->Name, &Entry[Index].Name) ||
+        (FfsHeader->Type != Entry[Index].Type) ||
+        (GetFileState (FvDevice->ErasePolarity, FfsHeader) == EFI_FILE_DELETED))
+    {
+      break;
+    }
+
+    CacheFfsHeader = FfsHeader;
+    if ((FfsHeader->Attributes & FFS_ATTRIB_CHECKSUM) == FFS_ATTRIB_CHECKSUM) {
+      //
+      // Cache the file and verify the checksum on the cached copy, the same
+      // way FvCheck () does for a memory mapped FV.
+      //
+      WholeFileSize = IS_FFS_FILE2 (FfsHeader) ? FFS_FILE2_SIZE (FfsHeader) : FFS_FILE_SIZE (FfsHeader);
+      if (WholeFileSize > FileIndex->FvLength - Entry[Index].Offset) {
+        break;
+      }
+
+      CacheFfsHeader = AllocateCopyPool (WholeFileSize, FfsHeader);
+      if (CacheFfsHeader == NULL) {
+        break;
+      }
+    }
+
+    if (!IsValidFfsFile (FvDevice->ErasePolarity, CacheFfsHeader)) {
+      if (CacheFfsHeader != FfsHeader) {
+        CoreFreePool (CacheFfsHeader);
+      }
+
+      break;
+    }
+
+    FfsFileEntry = AllocateZeroPool (sizeof (FFS_FILE_LIST_ENTRY));
+    if (FfsFileEntry == NULL) {
+      if (CacheFfsHeader != FfsHeader) {
+        CoreFreePool (CacheFfsHeader);
+      }
+
+      break;
+    }
+
+    FfsFileEntry->FfsHeader  = CacheFfsHeader;
+    FfsFileEntry->FileCached = (BOOLEAN)(CacheFfsHeader != FfsHeader);
+    InsertTailList (&FvDevice->FfsFileListHeader, &FfsFileEntry->Link);
+    InsertTailList (
+      &FvDevice->FfsFileHashTable[FvHashFileName (&FfsHeader->Name)],
+      &FfsFileEntry->HashLink
+      );
+  }
+
+  if (Index == FileIndex->FileCount) {
+    return TRUE;
+  }
+
+  //
+  // The FV no longer matches its index, scan it instead.
+  //
+  DEBUG ((DEBUG_WARN, "Stale file index for the FV at %p\n", FvDevice->CachedFv));
+  while (!IsListEmpty (&FvDevice->FfsFileListHeader)) {
+    Link = GetFirstNode (&FvDevice->FfsFileListHeader);
+    RemoveEntryList (Link);
+    FfsFileEntry = BASE_CR (Link, FFS_FILE_LIST_ENTRY, Link);
+    if (FfsFileEntry->FileCached) {
+      CoreFreePool (FfsFileEntry->FfsHeader);
+    }
+
+    CoreFreePool (FfsFileEntry);
+  }
+
+  for (Index = 0; Index < FFS_FILE_HASH_SIZE; Index++) {
+    InitializeListHead (&FvDevice->FfsFileHashTable[Index]);
+  }
+
+  return FALSE;
+}
+
 /**
   Check if an FV is consistent and allocate cache for it.
 
@@ -416,10 +582,17 @@ FvCheck (
 
   //
   // go through the whole FV cache, check the consistence of the FV.
-  // Make a linked list of all the Ffs file headers
+  // Make a linked list of all the Ffs file headers, and index them by name
   //
   Status = EFI_SUCCESS;
   InitializeListHead (&FvDevice->FfsFileListHeader);
+  for (Index = 0; Index < FFS_FILE_HASH_SIZE; Index++) {
+    InitializeListHead (&FvDevice->FfsFileHashTable[Index]);
+  }
+
+  if (FvBuildFileListFromIndex (FvDevice)) {
+    goto Done;
+  }
 
   //
   // Build FFS list
@@ -537,6 +710,10 @@ FvCheck (
       FfsFileEntry->FileCached = FileCached;
       FileCached               = FALSE;
       InsertTailList (&FvDevice->FfsFileListHeader, &FfsFileEntry->Link);
+      InsertTailList (
+        &FvDevice->FfsFileHashTable[FvHashFileName (&CacheFfsHeader->Name)],
+        &FfsFileEntry->HashLink
+        );
     }
 
     if (IS_FFS_FILE2 (CacheFfsHeader)) {
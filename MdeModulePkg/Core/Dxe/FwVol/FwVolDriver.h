@@ -12,11 +12,17 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define FV2_DEVICE_SIGNATURE  SIGNATURE_32 ('_', 'F', 'V', '2')
 
+//
+// Number of buckets of the file name hash index of a FV. Must be a power of 2.
+//
+#define FFS_FILE_HASH_SIZE  0x40
+
 //
 // Used to track all non-deleted files
 //
 typedef struct {
   LIST_ENTRY             Link;
+  LIST_ENTRY             HashLink;
   EFI_FFS_FILE_HEADER    *FfsHeader;
   UINTN                  StreamHandle;
   BOOLEAN                FileCached;
@@ -35,6 +41,7 @@ typedef struct {
   FFS_FILE_LIST_ENTRY                   *LastKey;
 
   LIST_ENTRY                            FfsFileListHeader;
+  LIST_ENTRY                            FfsFileHashTable[FFS_FILE_HASH_SIZE];
 
   UINT32                                AuthenticationStatus;
   UINT8                                 ErasePolarity;
@@ -44,6 +51,19 @@ typedef struct {
 
 #define FV_DEVICE_FROM_THIS(a)  CR(a, FV_DEVICE, Fv, FV2_DEVICE_SIGNATURE)
 
+/**
+  Computes the FfsFileHashTable bucket index of a file name.
+
+  @param  NameGuid         The file name GUID.
+
+  @return Bucket index in the range [0, FFS_FILE_HASH_SIZE).
+
+**/
+UINTN
+FvHashFileName (
+  IN CONST EFI_GUID  *NameGuid
+  );
+
 /**
   Retrieves attributes, insures positive polarity of attribute bits, returns
   resulting attributes in output parameter.
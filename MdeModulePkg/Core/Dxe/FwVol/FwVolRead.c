@@ -277,9 +277,10 @@ FvReadFile (
 {
   EFI_STATUS              Status;
   FV_DEVICE               *FvDevice;
-  EFI_GUID                SearchNameGuid;
-  EFI_FV_FILETYPE         LocalFoundType;
-  EFI_FV_FILE_ATTRIBUTES  LocalAttributes;
+  EFI_FV_ATTRIBUTES       FvAttributes;
+  LIST_ENTRY              *Bucket;
+  LIST_ENTRY              *Link;
+  FFS_FILE_LIST_ENTRY     *FfsFileEntry;
   UINTN                   FileSize;
   UINT8                   *SrcPtr;
   EFI_FFS_FILE_HEADER     *FfsHeader;
@@ -293,29 +294,44 @@ FvReadFile (
   FvDevice = FV_DEVICE_FROM_THIS (This);
 
   //
-  // Keep looking until we find the matching NameGuid.
-  // The Key is really a FfsFileEntry
-  //
-  FvDevice->LastKey = 0;
-  do {
-    LocalFoundType = 0;
-    Status         = FvGetNextFile (
-                       This,
-                       &FvDevice->LastKey,
-                       &LocalFoundType,
-                       &SearchNameGuid,
-                       &LocalAttributes,
-                       &FileSize
-                       );
-    if (EFI_ERROR (Status)) {
-      return EFI_NOT_FOUND;
+  // Check if read operation is enabled
+  //
+  Status = FvGetVolumeAttributes (This, &FvAttributes);
+  if (EFI_ERROR (Status) || ((FvAttributes & EFI_FV2_READ_STATUS) == 0)) {
+    return EFI_NOT_FOUND;
+  }
+
+  //
+  // Look up the matching NameGuid in the file name hash index. Pad files
+  // are skipped as GetNextFile() does. LastKey is set to the FfsFileEntry
+  // for FvReadFileSection().
+  //
+  FvDevice->LastKey = NULL;
+  Bucket            = &FvDevice->FfsFileHashTable[FvHashFileName (NameGuid)];
+  for (Link = Bucket->ForwardLink; Link != Bucket; Link = Link->ForwardLink) {
+    FfsFileEntry = BASE_CR (Link, FFS_FILE_LIST_ENTRY, HashLink);
+    FfsHeader    = FfsFileEntry->FfsHeader;
+    if ((FfsHeader->Type != EFI_FV_FILETYPE_FFS_PAD) &&
+        CompareGuid (&FfsHeader->Name, NameGuid))
+    {
+      FvDevice->LastKey = FfsFileEntry;
+      break;
     }
-  } while (!CompareGuid (&SearchNameGuid, NameGuid));
+  }
+
+  if (FvDevice->LastKey == NULL) {
+    return EFI_NOT_FOUND;
+  }
 
   //
-  // Get a pointer to the header
+  // Get a pointer to the header, and the size of the file data
   //
   FfsHeader = FvDevice->LastKey->FfsHeader;
+  if (IS_FFS_FILE2 (FfsHeader)) {
+    FileSize = FFS_FILE2_SIZE (FfsHeader) - sizeof (EFI_FFS_FILE_HEADER2);
+  } else {
+    FileSize = FFS_FILE_SIZE (FfsHeader) - sizeof (EFI_FFS_FILE_HEADER);
+  }
   if (FvDevice->IsMemoryMapped) {
     //
     // Memory mapped FV has not been cached, so here is to cache by file.
@@ -530,3 +546,142 @@ FvReadFileSection (
 Done:
   return Status;
 }
+
+/**
+  Locate the PE32 section of a file in a firmware volume produced by the DXE
+  core, without copying it.
+
+  Only a PE32 section that is stored in the file itself and precedes any
+  encapsulation section is returned, in system memory, so that it is the same
+  section as the one returned by ReadSection () and cannot change while the
+  image is verified and loaded. In every other case the caller must use
+  ReadSection ().
+
+  @param  Fv                     The firmware volume protocol instance.
+  @param  NameGuid               Name of the file.
+  @param  Buffer                 Pointer to the PE32 image in the firmware volume.
+  @param  BufferSize             Size of the PE32 image.
+  @param  AuthenticationStatus   Authentication status of the firmware volume.
+
+  @retval EFI_SUCCESS            The PE32 image was found.
+  @retval EFI_UNSUPPORTED        The PE32 image cannot be accessed in place.
+  @retval EFI_NOT_FOUND          The file does not exist.
+
+**/
+EFI_STATUS
+FvLocatePe32Section (
+  IN  EFI_FIRMWARE_VOLUME2_PROTOCOL  *Fv,
+  IN  CONST EFI_GUID                 *NameGuid,
+  OUT VOID                           **Buffer,
+  OUT UINTN                          *BufferSize,
+  OUT UINT32                         *AuthenticationStatus
+  )
+{
+  EFI_STATUS                       Status;
+  FV_DEVICE                        *FvDevice;
+  EFI_FV_ATTRIBUTES                FvAttributes;
+  LIST_ENTRY                       *Bucket;
+  LIST_ENTRY                       *Link;
+  FFS_FILE_LIST_ENTRY              *FfsFileEntry;
+  EFI_FFS_FILE_HEADER              *FfsHeader;
+  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  Descriptor;
+  UINT8                            *Section;
+  UINT8                            *FileEnd;
+  UINTN                            SectionHeaderSize;
+  UINTN                            SectionSize;
+
+  //
+  // Only the instances of this driver expose their FFS file list.
+  //
+  if (Fv->ReadFile != FvReadFile) {
+    return EFI_UNSUPPORTED;
+  }
+
+  FvDevice = FV_DEVICE_FROM_THIS (Fv);
+
+  Status = FvGetVolumeAttributes (Fv, &FvAttributes);
+  if (EFI_ERROR (Status) || ((FvAttributes & EFI_FV2_READ_STATUS) == 0)) {
+    return EFI_NOT_FOUND;
+  }
+
+  FfsHeader = NULL;
+  Bucket    = &FvDevice->FfsFileHashTable[FvHashFileName (NameGuid)];
+  for (Link = Bucket->ForwardLink; Link != Bucket; Link = Link->ForwardLink) {
+    FfsFileEntry = BASE_CR (Link, FFS_FILE_LIST_ENTRY, HashLink);
+    if ((FfsFileEntry->FfsHeader->Type != EFI_FV_FILETYPE_FFS_PAD) &&
+        CompareGuid (&FfsFileEntry->FfsHeader->Name, NameGuid))
+    {
+      FfsHeader = FfsFileEntry->FfsHeader;
+      break;
+    }
+  }
+
+  if (FfsHeader == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (FfsHeader->Type == EFI_FV_FILETYPE_RAW) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (IS_FFS_FILE2 (FfsHeader)) {
+    Section = (UINT8 *)FfsHeader + sizeof (EFI_FFS_FILE_HEADER2);
+    FileEnd = (UINT8 *)FfsHeader + FFS_FILE2_SIZE (FfsHeader);
+  } else {
+    Section = (UINT8 *)FfsHeader + sizeof (EFI_FFS_FILE_HEADER);
+    FileEnd = (UINT8 *)FfsHeader + FFS_FILE_SIZE (FfsHeader);
+  }
+
+  //
+  // A flash mapped firmware volume could be updated between the verification
+  // and the load of the image.
+  //
+  Status = CoreGetMemorySpaceDescriptor ((EFI_PHYSICAL_ADDRESS)(UINTN)FfsHeader, &Descriptor);
+  if (EFI_ERROR (Status) ||
+      (Descriptor.GcdMemoryType != EfiGcdMemoryTypeSystemMemory) ||
+      ((UINTN)FileEnd - Descriptor.BaseAddress > Descriptor.Length))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  while (Section + sizeof (EFI_COMMON_SECTION_HEADER) <= FileEnd) {
+    if (IS_SECTION2 (Section)) {
+      if (!FvDevice->IsFfs3Fv || (Section + sizeof (EFI_COMMON_SECTION_HEADER2) > FileEnd)) {
+        return EFI_UNSUPPORTED;
+      }
+
+      SectionHeaderSize = sizeof (EFI_COMMON_SECTION_HEADER2);
+      SectionSize       = SECTION2_SIZE (Section);
+    } else {
+      SectionHeaderSize = sizeof (EFI_COMMON_SECTION_HEADER);
+      SectionSize       = SECTION_SIZE (Section);
+    }
+
+    if ((SectionSize < SectionHeaderSize) || (SectionSize > (UINTN)(FileEnd - Section))) {
+      return EFI_UNSUPPORTED;
+    }
+
+    switch (((EFI_COMMON_SECTION_HEADER *)Section)->Type) {
+      case EFI_SECTION_PE32:
+        *Buffer               = Section + SectionHeaderSize;
+        *BufferSize           = SectionSize - SectionHeaderSize;
+        *AuthenticationStatus = FvDevice->AuthenticationStatus;
+        return EFI_SUCCESS;
+
+      case EFI_SECTION_COMPRESSION:
+      case EFI_SECTION_GUID_DEFINED:
+      case EFI_SECTION_DISPOSABLE:
+        //
+        // The first PE32 section may be encapsulated.
+        //
+        return EFI_UNSUPPORTED;
+
+      default:
+        break;
+    }
+
+    Section += ALIGN_VALUE (SectionSize, 4);
+  }
+
+  return EFI_UNSUPPORTED;
+}
@@ -10,12 +10,15 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "Handle.h"
 
 //
-// mProtocolDatabase     - A list of all protocols in the system.  (simple list for now)
+// mProtocolDatabase     - A list of all protocols in the system.
+// mProtocolHashTable    - The protocols of mProtocolDatabase hashed by protocol GUID
 // gHandleList           - A list of all the handles in the system
 // gProtocolDatabaseLock - Lock to protect the mProtocolDatabase
 // gHandleDatabaseKey    -  The Key to show that the handle has been created/modified
 //
 LIST_ENTRY  mProtocolDatabase     = INITIALIZE_LIST_HEAD_VARIABLE (mProtocolDatabase);
+LIST_ENTRY  mProtocolHashTable[PROTOCOL_ENTRY_HASH_SIZE];
+BOOLEAN     mProtocolHashTableInitialized = FALSE;
 LIST_ENTRY  gHandleList           = INITIALIZE_LIST_HEAD_VARIABLE (gHandleList);
 EFI_LOCK    gProtocolDatabaseLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
 UINT64      gHandleDatabaseKey    = 0;
@@ -78,6 +81,35 @@ CoreValidateHandle (
   return EFI_INVALID_PARAMETER;
 }
 
+/**
+  Computes the mProtocolHashTable bucket index of a protocol GUID.
+
+  @param  Protocol               The ID of the protocol
+
+  @return Bucket index in the range [0, PROTOCOL_ENTRY_HASH_SIZE)
+
+**/
+UINTN
+CoreHashProtocolGuid (
+  IN EFI_GUID  *Protocol
+  )
+{
+  UINT32  Hash;
+
+  //
+  // GUIDs are already well distributed, so folding the four 32-bit words
+  // of the GUID together is enough to spread them across the buckets.
+  //
+  Hash  = ReadUnaligned32 ((UINT32 *)Protocol);
+  Hash ^= ReadUnaligned32 ((UINT32 *)Protocol + 1);
+  Hash ^= ReadUnaligned32 ((UINT32 *)Protocol + 2);
+  Hash ^= ReadUnaligned32 ((UINT32 *)Protocol + 3);
+  Hash ^= Hash >> 16;
+  Hash ^= Hash >> 8;
+
+  return (UINTN)(Hash & (PROTOCOL_ENTRY_HASH_SIZE - 1));
+}
+
 /**
   Finds the protocol entry for the requested protocol.
   The gProtocolDatabaseLock must be owned
@@ -94,22 +126,32 @@ CoreFindProtocolEntry (
   IN BOOLEAN   Create
   )
 {
+  LIST_ENTRY      *Bucket;
   LIST_ENTRY      *Link;
   PROTOCOL_ENTRY  *Item;
   PROTOCOL_ENTRY  *ProtEntry;
+  UINTN           Index;
 
   ASSERT_LOCKED (&gProtocolDatabaseLock);
 
+  if (!mProtocolHashTableInitialized) {
+    for (Index = 0; Index < PROTOCOL_ENTRY_HASH_SIZE; Index++) {
+      InitializeListHead (&mProtocolHashTable[Index]);
+    }
+
+    mProtocolHashTableInitialized = TRUE;
+  }
+
   //
-  // Search the database for the matching GUID
+  // Search the hash bucket of the GUID for the matching protocol entry
   //
-
+  Bucket    = &mProtocolHashTable[CoreHashProtocolGuid (Protocol)];
   ProtEntry = NULL;
-  for (Link = mProtocolDatabase.ForwardLink;
-       Link != &mProtocolDatabase;
+  for (Link = Bucket->ForwardLink;
+       Link != Bucket;
        Link = Link->ForwardLink)
   {
-    Item = CR (Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE);
+    Item = CR (Link, PROTOCOL_ENTRY, HashLink, PROTOCOL_ENTRY_SIGNATURE);
     if (CompareGuid (&Item->ProtocolID, Protocol)) {
       //
       // This is the protocol entry
@@ -137,9 +179,11 @@ CoreFindProtocolEntry (
       InitializeListHead (&ProtEntry->Notify);
 
       //
-      // Add it to protocol database
+      // Add it to protocol database and to the hash index. Protocol entries
+      // are never freed, so both stay in sync for the lifetime of the core.
       //
       InsertTailList (&mProtocolDatabase, &ProtEntry->AllEntries);
+      InsertTailList (Bucket, &ProtEntry->HashLink);
     }
   }
 
@@ -88,6 +88,11 @@ GLOBAL_REMOVE_IF_UNREFERENCED MACHINE_TYPE_INFO  mMachineTypeInfo[] = {
 
 UINT16  mDxeCoreImageMachineType = 0;
 
+//
+// Totals of the image load report, indexed by IMAGE_FILE_HANDLE.InPlace
+//
+GLOBAL_REMOVE_IF_UNREFERENCED IMAGE_LOAD_REPORT  mImageLoadReport[2];
+
 /**
  Return machine type name.
 
@@ -581,9 +586,10 @@ CoreLoadPeImage (
   IN  UINT32                    Attribute
   )
 {
-  EFI_STATUS  Status;
-  BOOLEAN     DstBufAlocated;
-  UINTN       Size;
+  EFI_STATUS            Status;
+  BOOLEAN               DstBufAlocated;
+  UINTN                 Size;
+  EFI_PHYSICAL_ADDRESS  LinkedAddress;
 
   ZeroMem (&Image->ImageContext, sizeof (Image->ImageContext));
 
@@ -598,6 +604,8 @@ CoreLoadPeImage (
     return Status;
   }
 
+  LinkedAddress = Image->ImageContext.ImageAddress;
+
   if (!CoreIsImageTypeSupported (Image)) {
     //
     // The PE/COFF loader can support loading image types that can be executed.
@@ -770,6 +778,8 @@ CoreLoadPeImage (
     goto Done;
   }
 
+  ((IMAGE_FILE_HANDLE *)Pe32Handle)->Relocated = (BOOLEAN)(Image->ImageContext.ImageAddress != LinkedAddress);
+
   //
   // Flush the Instruction Cache
   //
@@ -932,6 +942,21 @@ CoreLoadedImageInfo (
   return Image;
 }
 
+/**
+  Return the image whose entry point is running.
+
+  @return  The private data of the image started last, or of the DXE Core if
+           no image entry point is running.
+
+**/
+LOADED_IMAGE_PRIVATE_DATA *
+CoreGetCurrentImage (
+  VOID
+  )
+{
+  return mCurrentImage;
+}
+
 /**
   Unloads EFI image from memory.
 
@@ -959,6 +984,12 @@ CoreUnloadAndCloseImage (
   HandleBuffer      = NULL;
   ProtocolGuidArray = NULL;
 
+  //
+  // The concurrent work of a driver whose entry point failed must not run
+  // once its code and data are freed.
+  //
+  CoreDiscardConcurrentWork (Image->Handle);
+
   if (Image->Started) {
     UnregisterMemoryProfileImage (Image);
   }
@@ -1092,6 +1123,153 @@ CoreUnloadAndCloseImage (
   CoreFreePool (Image);
 }
 
+/**
+  Read the timer of the CPU Architectural Protocol for the image load report.
+
+  @param  TimerValue              The timer value.
+  @param  TimerPeriod             The period of the timer in femtoseconds.
+
+  @retval TRUE                    The timer was read.
+  @retval FALSE                   The CPU Architectural Protocol is not
+                                  installed yet or has no readable timer.
+
+**/
+STATIC
+BOOLEAN
+CoreReadImageLoadTimer (
+  OUT UINT64  *TimerValue,
+  OUT UINT64  *TimerPeriod
+  )
+{
+  if (gCpu == NULL) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)!EFI_ERROR (gCpu->GetTimerValue (gCpu, 0, TimerValue, TimerPeriod));
+}
+
+/**
+  Add an image to the image load report and print its load time.
+
+  The load time covers reading the image from its device, the security checks,
+  loading and relocating it, and the installation of its protocols.
+
+  @param  Image                   The loaded image.
+  @param  FHand                   The source of the image.
+  @param  StartValue              Timer value when the load started.
+  @param  TimerPeriod             The period of the timer in femtoseconds, or 0
+                                  if the timer could not be read.
+
+**/
+STATIC
+VOID
+CoreReportImageLoad (
+  IN LOADED_IMAGE_PRIVATE_DATA  *Image,
+  IN IMAGE_FILE_HANDLE          *FHand,
+  IN UINT64                     StartValue,
+  IN UINT64                     TimerPeriod
+  )
+{
+  IMAGE_LOAD_REPORT  *Report;
+  UINT64             EndValue;
+  UINT64             Nanoseconds;
+
+  Nanoseconds = 0;
+  if ((TimerPeriod != 0) && CoreReadImageLoadTimer (&EndValue, &TimerPeriod)) {
+    Nanoseconds = DivU64x32 (MultU64x64 (EndValue - StartValue, TimerPeriod), 1000000);
+  }
+
+  Report               = &mImageLoadReport[FHand->InPlace ? 1 : 0];
+  Report->Count       += 1;
+  Report->Relocated   += FHand->Relocated ? 1 : 0;
+  Report->Bytes       += FHand->SourceSize;
+  Report->Nanoseconds += Nanoseconds;
+
+  DEBUG ((
+    DEBUG_LOAD,
+    "LoadImage: 0x%11p %a, 0x%Lx bytes, %a, %Lu us\n",
+    Image->Info.ImageBase,
+    FHand->InPlace ? "in place" : "copied",
+    (UINT64)FHand->SourceSize,
+    FHand->Relocated ? "relocated" : "not relocated",
+    DivU64x32 (Nanoseconds, 1000)
+    ));
+}
+
+/**
+  Print the totals of the image load report.
+
+  The images read from a firmware volume in place and the images read into a
+  copy are reported apart, so that the load time saved by the in place path
+  can be compared on a platform. Times are 0 for images loaded before the CPU
+  Architectural Protocol is installed.
+
+**/
+VOID
+CoreDumpImageLoadReport (
+  VOID
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mImageLoadReport); Index++) {
+    DEBUG ((
+      DEBUG_LOAD,
+      "LoadImage report: %a %Lu images, %Lu relocated, 0x%Lx bytes, %Lu us\n",
+      (Index == 1) ? "in place" : "copied",
+      (UINT64)mImageLoadReport[Index].Count,
+      (UINT64)mImageLoadReport[Index].Relocated,
+      mImageLoadReport[Index].Bytes,
+      DivU64x32 (mImageLoadReport[Index].Nanoseconds, 1000)
+      ));
+  }
+}
+
+/**
+  Get the PE32 image of a file in a firmware volume without reading a copy of
+  it. The PE/COFF loader then copies the image from the firmware volume
+  straight to its final location.
+
+  @param  FvHandle                Handle of the firmware volume.
+  @param  FvFileNode              The device path node that names the file.
+  @param  ImageSize               Size of the PE32 image.
+  @param  AuthenticationStatus    Authentication status of the PE32 image.
+
+  @return Pointer to the PE32 image in the firmware volume, or NULL if the
+          image has to be read through the Firmware Volume2 Protocol.
+
+**/
+VOID *
+CoreGetFvImageInPlace (
+  IN  EFI_HANDLE                FvHandle,
+  IN  EFI_DEVICE_PATH_PROTOCOL  *FvFileNode,
+  OUT UINTN                     *ImageSize,
+  OUT UINT32                    *AuthenticationStatus
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_GUID                       *NameGuid;
+  EFI_FIRMWARE_VOLUME2_PROTOCOL  *Fv;
+  VOID                           *Image;
+
+  NameGuid = EfiGetNameGuidFromFwVolDevicePathNode ((CONST MEDIA_FW_VOL_FILEPATH_DEVICE_PATH *)FvFileNode);
+  if (NameGuid == NULL) {
+    return NULL;
+  }
+
+  Status = CoreHandleProtocol (FvHandle, &gEfiFirmwareVolume2ProtocolGuid, (VOID **)&Fv);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  Status = FvLocatePe32Section (Fv, NameGuid, &Image, ImageSize, AuthenticationStatus);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  return Image;
+}
+
 /**
   Loads an EFI image into memory and returns a handle to the image.
 
@@ -1164,6 +1342,8 @@ CoreLoadImageCommon (
   UINTN                      FilePathSize;
   BOOLEAN                    ImageIsFromFv;
   BOOLEAN                    ImageIsFromLoadFile;
+  UINT64                     LoadStartValue;
+  UINT64                     LoadTimerPeriod;
 
   SecurityStatus = EFI_SUCCESS;
 
@@ -1183,6 +1363,15 @@ CoreLoadImageCommon (
     return EFI_INVALID_PARAMETER;
   }
 
+  LoadStartValue  = 0;
+  LoadTimerPeriod = 0;
+  DEBUG_CODE_BEGIN ();
+  if (!CoreReadImageLoadTimer (&LoadStartValue, &LoadTimerPeriod)) {
+    LoadTimerPeriod = 0;
+  }
+
+  DEBUG_CODE_END ();
+
   ZeroMem (&FHand, sizeof (IMAGE_FILE_HANDLE));
   FHand.Signature      = IMAGE_FILE_HANDLE_SIGNATURE;
   OriginalFilePath     = FilePath;
@@ -1243,18 +1432,32 @@ CoreLoadImageCommon (
     }
 
     //
-    // Get the source file buffer by its device path.
+    // Get the source file buffer by its device path. An image of a firmware
+    // volume in memory is used in place.
     //
-    FHand.Source = GetFileBufferByFilePath (
-                     BootPolicy,
-                     FilePath,
-                     &FHand.SourceSize,
-                     &AuthenticationStatus
-                     );
+    if (ImageIsFromFv) {
+      FHand.Source = CoreGetFvImageInPlace (
+                       DeviceHandle,
+                       HandleFilePath,
+                       &FHand.SourceSize,
+                       &AuthenticationStatus
+                       );
+      FHand.InPlace = (BOOLEAN)(FHand.Source != NULL);
+    }
+
+    if (FHand.Source == NULL) {
+      FHand.Source = GetFileBufferByFilePath (
+                       BootPolicy,
+                       FilePath,
+                       &FHand.SourceSize,
+                       &AuthenticationStatus
+                       );
+      FHand.FreeBuffer = (BOOLEAN)(FHand.Source != NULL);
+    }
+
     if (FHand.Source == NULL) {
       Status = EFI_NOT_FOUND;
     } else {
-      FHand.FreeBuffer = TRUE;
       if (ImageIsFromLoadFile) {
         //
         // LoadFile () may cause the device path of the Handle be updated.
@@ -1462,6 +1665,10 @@ CoreLoadImageCommon (
 
   ProtectUefiImage (&Image->Info, Image->LoadedImageDevicePath);
 
+  DEBUG_CODE (
+    CoreReportImageLoad (Image, &FHand, LoadStartValue, LoadTimerPeriod);
+    );
+
   //
   // Success.  Return the image handle
   //
@@ -16,8 +16,21 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 typedef struct {
   UINTN      Signature;
   BOOLEAN    FreeBuffer;
+  BOOLEAN    InPlace;
+  BOOLEAN    Relocated;
   VOID       *Source;
   UINTN      SourceSize;
 } IMAGE_FILE_HANDLE;
 
+//
+// Totals of the image load report, for the images read from a firmware volume
+// in place and for the images read into a copy
+//
+typedef struct {
+  UINTN     Count;
+  UINTN     Relocated;
+  UINT64    Bytes;
+  UINT64    Nanoseconds;
+} IMAGE_LOAD_REPORT;
+
 #endif
@@ -25,6 +25,18 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define MEMORY_TYPE_OEM_RESERVED_MIN  0x70000000
 #define MEMORY_TYPE_OEM_RESERVED_MAX  0x7FFFFFFF
 
+//
+// MEMORY_MAP_NODE - node of the red-black tree that indexes the memory map
+// descriptors by address
+//
+typedef struct _MEMORY_MAP_NODE MEMORY_MAP_NODE;
+struct _MEMORY_MAP_NODE {
+  MEMORY_MAP_NODE    *Parent;
+  MEMORY_MAP_NODE    *Left;
+  MEMORY_MAP_NODE    *Right;
+  BOOLEAN            Red;
+};
+
 //
 // MEMORY_MAP_ENTRY
 //
@@ -33,6 +45,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 typedef struct {
   UINTN              Signature;
   LIST_ENTRY         Link;
+  LIST_ENTRY         TypeLink;
+  MEMORY_MAP_NODE    Node;
   BOOLEAN            FromPages;
 
   EFI_MEMORY_TYPE    Type;
@@ -162,6 +176,60 @@ CoreInternalAllocatePages (
   IN BOOLEAN                   NeedGuard
   );
 
+/**
+  Internal function.  Adds a descriptor to the address index of the memory map.
+  The range of the descriptor must not overlap the range of any descriptor
+  in the index.
+
+  @param  Entry                  The descriptor to add
+
+**/
+VOID
+InsertMemoryMapTreeEntry (
+  IN OUT MEMORY_MAP  *Entry
+  );
+
+/**
+  Internal function.  Removes a descriptor from the address index of the
+  memory map. The descriptor is found through its node, not its address, so
+  it may be removed after its range was emptied.
+
+  @param  Entry                  The descriptor to remove
+
+**/
+VOID
+RemoveMemoryMapTreeEntry (
+  IN OUT MEMORY_MAP  *Entry
+  );
+
+/**
+  Internal function.  Finds the descriptor of the address index that covers
+  an address.
+
+  @param  Address                The address to search for
+
+  @return The descriptor, or NULL if no descriptor covers Address
+
+**/
+MEMORY_MAP *
+FindMemoryMapTreeEntry (
+  IN UINT64  Address
+  );
+
+/**
+  Internal function.  Returns the descriptor of the address index that
+  follows a descriptor in address order.
+
+  @param  Entry                  The descriptor
+
+  @return The next descriptor, or NULL if Entry is the last one
+
+**/
+MEMORY_MAP *
+GetNextMemoryMapTreeEntry (
+  IN MEMORY_MAP  *Entry
+  );
+
 //
 // Internal Global data
 //
@@ -0,0 +1,426 @@
+/** @file
+  Index of the memory map descriptors by address.
+
+  Every descriptor of gMemoryMap is also a node of a red-black tree ordered by
+  the start address of the descriptor. The nodes are embedded in the MEMORY_MAP
+  entries, so the index never allocates memory while the memory map is updated.
+
+  The start address of a descriptor may be changed in place as long as the
+  order of the descriptors does not change, which is the case when the front
+  of a range is clipped. The descriptor is removed through its node afterwards
+  if the clipped range is empty.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+#include "Imem.h"
+
+//
+// mMemoryMapTreeNil - the black leaf shared by all nodes of the tree
+//
+MEMORY_MAP_NODE  mMemoryMapTreeNil = {
+  &mMemoryMapTreeNil,
+  &mMemoryMapTreeNil,
+  &mMemoryMapTreeNil,
+  FALSE
+};
+
+//
+// mMemoryMapTreeRoot - the root of the address index of gMemoryMap
+//
+MEMORY_MAP_NODE  *mMemoryMapTreeRoot = &mMemoryMapTreeNil;
+
+#define MEMORY_MAP_TREE_NIL  (&mMemoryMapTreeNil)
+
+#define MEMORY_MAP_FROM_NODE(a)  CR (a, MEMORY_MAP, Node, MEMORY_MAP_SIGNATURE)
+
+/**
+  Rotates a node of the address index to the left.
+
+  @param  Node                   The node whose right child takes its place
+
+**/
+STATIC
+VOID
+RotateMemoryMapTreeLeft (
+  IN MEMORY_MAP_NODE  *Node
+  )
+{
+  MEMORY_MAP_NODE  *Child;
+
+  Child       = Node->Right;
+  Node->Right = Child->Left;
+  if (Child->Left != MEMORY_MAP_TREE_NIL) {
+    Child->Left->Parent = Node;
+  }
+
+  Child->Parent = Node->Parent;
+  if (Node->Parent == MEMORY_MAP_TREE_NIL) {
+    mMemoryMapTreeRoot = Child;
+  } else if (Node == Node->Parent->Left) {
+    Node->Parent->Left = Child;
+  } else {
+    Node->Parent->Right = Child;
+  }
+
+  Child->Left  = Node;
+  Node->Parent = Child;
+}
+
+/**
+  Rotates a node of the address index to the right.
+
+  @param  Node                   The node whose left child takes its place
+
+**/
+STATIC
+VOID
+RotateMemoryMapTreeRight (
+  IN MEMORY_MAP_NODE  *Node
+  )
+{
+  MEMORY_MAP_NODE  *Child;
+
+  Child      = Node->Left;
+  Node->Left = Child->Right;
+  if (Child->Right != MEMORY_MAP_TREE_NIL) {
+    Child->Right->Parent = Node;
+  }
+
+  Child->Parent = Node->Parent;
+  if (Node->Parent == MEMORY_MAP_TREE_NIL) {
+    mMemoryMapTreeRoot = Child;
+  } else if (Node == Node->Parent->Right) {
+    Node->Parent->Right = Child;
+  } else {
+    Node->Parent->Left = Child;
+  }
+
+  Child->Right = Node;
+  Node->Parent = Child;
+}
+
+/**
+  Replaces a subtree of the address index by another one.
+
+  @param  Node                   The root of the subtree to replace
+  @param  Replacement            The root of the subtree that takes its place
+
+**/
+STATIC
+VOID
+ReplaceMemoryMapTreeNode (
+  IN MEMORY_MAP_NODE  *Node,
+  IN MEMORY_MAP_NODE  *Replacement
+  )
+{
+  if (Node->Parent == MEMORY_MAP_TREE_NIL) {
+    mMemoryMapTreeRoot = Replacement;
+  } else if (Node == Node->Parent->Left) {
+    Node->Parent->Left = Replacement;
+  } else {
+    Node->Parent->Right = Replacement;
+  }
+
+  Replacement->Parent = Node->Parent;
+}
+
+/**
+  Internal function.  Adds a descriptor to the address index of the memory map.
+  The range of the descriptor must not overlap the range of any descriptor
+  in the index.
+
+  @param  Entry                  The descriptor to add
+
+**/
+VOID
+InsertMemoryMapTreeEntry (
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP_NODE  *Node;
+  MEMORY_MAP_NODE  *Parent;
+  MEMORY_MAP_NODE  *Uncle;
+  MEMORY_MAP_NODE  *Current;
+  MEMORY_MAP       *ParentEntry;
+  BOOLEAN          Left;
+
+  Node    = &Entry->Node;
+  Parent  = MEMORY_MAP_TREE_NIL;
+  Left    = FALSE;
+  Current = mMemoryMapTreeRoot;
+  while (Current != MEMORY_MAP_TREE_NIL) {
+    Parent      = Current;
+    ParentEntry = MEMORY_MAP_FROM_NODE (Current);
+    Left        = (BOOLEAN)(Entry->Start < ParentEntry->Start);
+    if (Left) {
+      Current = Current->Left;
+    } else {
+      Current = Current->Right;
+    }
+  }
+
+  Node->Parent = Parent;
+  Node->Left   = MEMORY_MAP_TREE_NIL;
+  Node->Right  = MEMORY_MAP_TREE_NIL;
+  Node->Red    = TRUE;
+  if (Parent == MEMORY_MAP_TREE_NIL) {
+    mMemoryMapTreeRoot = Node;
+  } else if (Left) {
+    Parent->Left = Node;
+  } else {
+    Parent->Right = Node;
+  }
+
+  //
+  // Restore the red-black properties: a red node has no red child
+  //
+  while (Node->Parent->Red) {
+    Parent = Node->Parent;
+    if (Parent == Parent->Parent->Left) {
+      Uncle = Parent->Parent->Right;
+      if (Uncle->Red) {
+        Parent->Red         = FALSE;
+        Uncle->Red          = FALSE;
+        Parent->Parent->Red = TRUE;
+        Node                = Parent->Parent;
+      } else {
+        if (Node == Parent->Right) {
+          Node = Parent;
+          RotateMemoryMapTreeLeft (Node);
+          Parent = Node->Parent;
+        }
+
+        Parent->Red         = FALSE;
+        Parent->Parent->Red = TRUE;
+        RotateMemoryMapTreeRight (Parent->Parent);
+      }
+    } else {
+      Uncle = Parent->Parent->Left;
+      if (Uncle->Red) {
+        Parent->Red         = FALSE;
+        Uncle->Red          = FALSE;
+        Parent->Parent->Red = TRUE;
+        Node                = Parent->Parent;
+      } else {
+        if (Node == Parent->Left) {
+          Node = Parent;
+          RotateMemoryMapTreeRight (Node);
+          Parent = Node->Parent;
+        }
+
+        Parent->Red         = FALSE;
+        Parent->Parent->Red = TRUE;
+        RotateMemoryMapTreeLeft (Parent->Parent);
+      }
+    }
+  }
+
+  mMemoryMapTreeRoot->Red = FALSE;
+}
+
+/**
+  Internal function.  Removes a descriptor from the address index of the
+  memory map. The descriptor is found through its node, not its address, so
+  it may be removed after its range was emptied.
+
+  @param  Entry                  The descriptor to remove
+
+**/
+VOID
+RemoveMemoryMapTreeEntry (
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP_NODE  *Node;
+  MEMORY_MAP_NODE  *Successor;
+  MEMORY_MAP_NODE  *Child;
+  MEMORY_MAP_NODE  *Sibling;
+  BOOLEAN          RemovedRed;
+
+  Node       = &Entry->Node;
+  RemovedRed = Node->Red;
+  if (Node->Left == MEMORY_MAP_TREE_NIL) {
+    Child = Node->Right;
+    ReplaceMemoryMapTreeNode (Node, Child);
+  } else if (Node->Right == MEMORY_MAP_TREE_NIL) {
+    Child = Node->Left;
+    ReplaceMemoryMapTreeNode (Node, Child);
+  } else {
+    //
+    // Move the successor of the node, which has no left child, to its place
+    //
+    Successor = Node->Right;
+    while (Successor->Left != MEMORY_MAP_TREE_NIL) {
+      Successor = Successor->Left;
+    }
+
+    RemovedRed = Successor->Red;
+    Child      = Successor->Right;
+    if (Successor->Parent == Node) {
+      Child->Parent = Successor;
+    } else {
+      ReplaceMemoryMapTreeNode (Successor, Successor->Right);
+      Successor->Right         = Node->Right;
+      Successor->Right->Parent = Successor;
+    }
+
+    ReplaceMemoryMapTreeNode (Node, Successor);
+    Successor->Left         = Node->Left;
+    Successor->Left->Parent = Successor;
+    Successor->Red          = Node->Red;
+  }
+
+  Node->Parent = NULL;
+  Node->Left   = NULL;
+  Node->Right  = NULL;
+
+  if (RemovedRed) {
+    return;
+  }
+
+  //
+  // Restore the red-black properties: all the paths from a node to its
+  // leaves have the same number of black nodes
+  //
+  while ((Child != mMemoryMapTreeRoot) && !Child->Red) {
+    if (Child == Child->Parent->Left) {
+      Sibling = Child->Parent->Right;
+      if (Sibling->Red) {
+        Sibling->Red       = FALSE;
+        Child->Parent->Red = TRUE;
+        RotateMemoryMapTreeLeft (Child->Parent);
+        Sibling = Child->Parent->Right;
+      }
+
+      if (!Sibling->Left->Red && !Sibling->Right->Red) {
+        Sibling->Red = TRUE;
+        Child        = Child->Parent;
+      } else {
+        if (!Sibling->Right->Red) {
+          Sibling->Left->Red = FALSE;
+          Sibling->Red       = TRUE;
+          RotateMemoryMapTreeRight (Sibling);
+          Sibling = Child->Parent->Right;
+        }
+
+        Sibling->Red        = Child->Parent->Red;
+        Child->Parent->Red  = FALSE;
+        Sibling->Right->Red = FALSE;
+        RotateMemoryMapTreeLeft (Child->Parent);
+        Child = mMemoryMapTreeRoot;
+      }
+    } else {
+      Sibling = Child->Parent->Left;
+      if (Sibling->Red) {
+        Sibling->Red       = FALSE;
+        Child->Parent->Red = TRUE;
+        RotateMemoryMapTreeRight (Child->Parent);
+        Sibling = Child->Parent->Left;
+      }
+
+      if (!Sibling->Right->Red && !Sibling->Left->Red) {
+        Sibling->Red = TRUE;
+        Child        = Child->Parent;
+      } else {
+        if (!Sibling->Left->Red) {
+          Sibling->Right->Red = FALSE;
+          Sibling->Red        = TRUE;
+          RotateMemoryMapTreeLeft (Sibling);
+          Sibling = Child->Parent->Left;
+        }
+
+        Sibling->Red       = Child->Parent->Red;
+        Child->Parent->Red = FALSE;
+        Sibling->Left->Red = FALSE;
+        RotateMemoryMapTreeRight (Child->Parent);
+        Child = mMemoryMapTreeRoot;
+      }
+    }
+  }
+
+  Child->Red = FALSE;
+}
+
+/**
+  Internal function.  Finds the descriptor of the address index that covers
+  an address.
+
+  @param  Address                The address to search for
+
+  @return The descriptor, or NULL if no descriptor covers Address
+
+**/
+MEMORY_MAP *
+FindMemoryMapTreeEntry (
+  IN UINT64  Address
+  )
+{
+  MEMORY_MAP_NODE  *Current;
+  MEMORY_MAP       *Entry;
+  MEMORY_MAP       *Floor;
+
+  //
+  // Find the descriptor with the highest start address not above Address
+  //
+  Floor   = NULL;
+  Current = mMemoryMapTreeRoot;
+  while (Current != MEMORY_MAP_TREE_NIL) {
+    Entry = MEMORY_MAP_FROM_NODE (Current);
+    if (Entry->Start <= Address) {
+      Floor   = Entry;
+      Current = Current->Right;
+    } else {
+      Current = Current->Left;
+    }
+  }
+
+  if ((Floor != NULL) && (Floor->End >= Address)) {
+    return Floor;
+  }
+
+  return NULL;
+}
+
+/**
+  Internal function.  Returns the descriptor of the address index that
+  follows a descriptor in address order.
+
+  @param  Entry                  The descriptor
+
+  @return The next descriptor, or NULL if Entry is the last one
+
+**/
+MEMORY_MAP *
+GetNextMemoryMapTreeEntry (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP_NODE  *Node;
+  MEMORY_MAP_NODE  *Parent;
+
+  Node = &Entry->Node;
+  if (Node->Right != MEMORY_MAP_TREE_NIL) {
+    Node = Node->Right;
+    while (Node->Left != MEMORY_MAP_TREE_NIL) {
+      Node = Node->Left;
+    }
+
+    return MEMORY_MAP_FROM_NODE (Node);
+  }
+
+  Parent = Node->Parent;
+  while ((Parent != MEMORY_MAP_TREE_NIL) && (Node == Parent->Right)) {
+    Node   = Parent;
+    Parent = Parent->Parent;
+  }
+
+  if (Parent == MEMORY_MAP_TREE_NIL) {
+    return NULL;
+  }
+
+  return MEMORY_MAP_FROM_NODE (Parent);
+}
@@ -45,6 +45,14 @@ UINTN       mFreeMapStack = 0;
 ///
 LIST_ENTRY  mFreeMemoryMapEntryList           = INITIALIZE_LIST_HEAD_VARIABLE (mFreeMemoryMapEntryList);
 BOOLEAN     mMemoryTypeInformationInitialized = FALSE;
+///
+/// mMemoryMapTypeList - the entries of gMemoryMap linked again by memory type,
+/// so that searches for free memory only visit the EfiConventionalMemory
+/// descriptors. All OEM and OS reserved memory types share the last list.
+/// Descriptors are looked up by address through the index in MemoryMapTree.c.
+///
+LIST_ENTRY  mMemoryMapTypeList[EfiMaxMemoryType + 1];
+BOOLEAN     mMemoryMapTypeListInitialized = FALSE;
 
 EFI_MEMORY_TYPE_STATISTICS  mMemoryTypeStatistics[EfiMaxMemoryType + 1] = {
   { 0, MAX_ALLOC_ADDRESS, 0, 0, EfiMaxMemoryType, TRUE,  FALSE },  // EfiReservedMemoryType
@@ -119,6 +127,71 @@ CoreReleaseMemoryLock (
   CoreReleaseLock (&gMemoryLock);
 }
 
+/**
+  Internal function.  Returns the list of memory map descriptors of a
+  memory type.
+
+  @param  Type                   The memory type
+
+  @return The head of the mMemoryMapTypeList list holding Type descriptors
+
+**/
+LIST_ENTRY *
+GetMemoryMapTypeList (
+  IN EFI_MEMORY_TYPE  Type
+  )
+{
+  UINTN  Index;
+
+  if (!mMemoryMapTypeListInitialized) {
+    for (Index = 0; Index <= EfiMaxMemoryType; Index++) {
+      InitializeListHead (&mMemoryMapTypeList[Index]);
+    }
+
+    mMemoryMapTypeListInitialized = TRUE;
+  }
+
+  if ((UINT32)Type < EfiMaxMemoryType) {
+    return &mMemoryMapTypeList[Type];
+  }
+
+  return &mMemoryMapTypeList[EfiMaxMemoryType];
+}
+
+/**
+  Internal function.  Inserts a descriptor entry into the memory map.
+
+  @param  Link                   The gMemoryMap link to insert the entry before
+  @param  Entry                  The entry to insert
+
+**/
+VOID
+InsertMemoryMapEntry (
+  IN     LIST_ENTRY  *Link,
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  InsertTailList (Link, &Entry->Link);
+  InsertTailList (GetMemoryMapTypeList (Entry->Type), &Entry->TypeLink);
+  InsertMemoryMapTreeEntry (Entry);
+}
+
+/**
+  Internal function.  Finds the descriptor entry that covers an address.
+
+  @param  Address                The address to search for
+
+  @return The descriptor entry, or NULL if no descriptor covers Address
+
+**/
+MEMORY_MAP *
+FindMemoryMapEntry (
+  IN UINT64  Address
+  )
+{
+  return FindMemoryMapTreeEntry (Address);
+}
+
 /**
   Internal function.  Removes a descriptor entry.
 
@@ -130,6 +203,8 @@ RemoveMemoryMapEntry (
   IN OUT MEMORY_MAP  *Entry
   )
 {
+  RemoveMemoryMapTreeEntry (Entry);
+  RemoveEntryList (&Entry->TypeLink);
   RemoveEntryList (&Entry->Link);
   Entry->Link.ForwardLink = NULL;
 
@@ -161,7 +236,6 @@ CoreAddRange (
   IN UINT64                Attribute
   )
 {
-  LIST_ENTRY  *Link;
   MEMORY_MAP  *Entry;
 
   ASSERT ((Start & EFI_PAGE_MASK) == 0);
@@ -203,30 +277,24 @@ CoreAddRange (
   CoreNotifySignalList (&gEfiEventMemoryMapChangeGuid);
 
   //
-  // Look for adjoining memory descriptor
+  // Look for adjoining memory descriptors, which are the descriptors that
+  // cover the bytes right below and right above the range
   //
 
   // Two memory descriptors can only be merged if they have the same Type
   // and the same Attribute
   //
-
-  Link = gMemoryMap.ForwardLink;
-  while (Link != &gMemoryMap) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    Link  = Link->ForwardLink;
-
-    if (Entry->Type != Type) {
-      continue;
-    }
-
-    if (Entry->Attribute != Attribute) {
-      continue;
-    }
-
-    if (Entry->End + 1 == Start) {
+  if (Start != 0) {
+    Entry = FindMemoryMapEntry (Start - 1);
+    if ((Entry != NULL) && (Entry->Type == Type) && (Entry->Attribute == Attribute)) {
       Start = Entry->Start;
       RemoveMemoryMapEntry (Entry);
-    } else if (Entry->Start == End + 1) {
+    }
+  }
+
+  if (End != MAX_UINT64) {
+    Entry = FindMemoryMapEntry (End + 1);
+    if ((Entry != NULL) && (Entry->Type == Type) && (Entry->Attribute == Attribute)) {
       End = Entry->End;
       RemoveMemoryMapEntry (Entry);
     }
@@ -243,7 +311,7 @@ CoreAddRange (
   mMapStack[mMapDepth].End          = End;
   mMapStack[mMapDepth].VirtualStart = 0;
   mMapStack[mMapDepth].Attribute    = Attribute;
-  InsertTailList (&gMemoryMap, &mMapStack[mMapDepth].Link);
+  InsertMemoryMapEntry (&gMemoryMap, &mMapStack[mMapDepth]);
 
   mMapDepth += 1;
   ASSERT (mMapDepth < MAX_MAP_DEPTH);
@@ -347,26 +415,33 @@ CoreFreeMemoryMapStack (
     mMapDepth -= 1;
 
     if (mMapStack[mMapDepth].Link.ForwardLink != NULL) {
+      //
+      // Find insertion location, in front of the next descriptor from pool.
+      // The descriptors from pool are kept in address order in gMemoryMap.
+      //
+      Entry2 = GetNextMemoryMapTreeEntry (&mMapStack[mMapDepth]);
+      while ((Entry2 != NULL) && !Entry2->FromPages) {
+        Entry2 = GetNextMemoryMapTreeEntry (Entry2);
+      }
+
+      if (Entry2 != NULL) {
+        Link2 = &Entry2->Link;
+      } else {
+        Link2 = &gMemoryMap;
+      }
+
       //
       // Move this entry to general memory
       //
+      RemoveMemoryMapTreeEntry (&mMapStack[mMapDepth]);
+      RemoveEntryList (&mMapStack[mMapDepth].TypeLink);
       RemoveEntryList (&mMapStack[mMapDepth].Link);
       mMapStack[mMapDepth].Link.ForwardLink = NULL;
 
       CopyMem (Entry, &mMapStack[mMapDepth], sizeof (MEMORY_MAP));
       Entry->FromPages = TRUE;
 
-      //
-      // Find insertion location
-      //
-      for (Link2 = gMemoryMap.ForwardLink; Link2 != &gMemoryMap; Link2 = Link2->ForwardLink) {
-        Entry2 = CR (Link2, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-        if (Entry2->FromPages && (Entry2->Start > Entry->Start)) {
-          break;
-        }
-      }
-
-      InsertTailList (Link2, &Entry->Link);
+      InsertMemoryMapEntry (Link2, Entry);
     } else {
       //
       // This item of mMapStack[mMapDepth] has already been dequeued from gMemoryMap list,
@@ -843,7 +918,6 @@ CoreConvertPagesEx (
   UINT64           RangeEnd;
   UINT64           Attribute;
   EFI_MEMORY_TYPE  MemType;
-  LIST_ENTRY       *Link;
   MEMORY_MAP       *Entry;
 
   Entry         = NULL;
@@ -868,15 +942,8 @@ CoreConvertPagesEx (
     //
     // Find the entry that the covers the range
     //
-    for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-      Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-      if ((Entry->Start <= Start) && (Entry->End > Start)) {
-        break;
-      }
-    }
-
-    if (Link == &gMemoryMap) {
+    Entry = FindMemoryMapEntry (Start);
+    if (Entry == NULL) {
       DEBUG ((DEBUG_ERROR | DEBUG_PAGE, "ConvertPages: failed to find range %lx - %lx\n", Start, End));
       return EFI_NOT_FOUND;
     }
@@ -990,7 +1057,7 @@ CoreConvertPagesEx (
       ASSERT (Entry->Start < Entry->End);
 
       Entry = &mMapStack[mMapDepth];
-      InsertTailList (&gMemoryMap, &Entry->Link);
+      InsertMemoryMapEntry (&gMemoryMap, Entry);
 
       mMapDepth += 1;
       ASSERT (mMapDepth < MAX_MAP_DEPTH);
@@ -1142,6 +1209,7 @@ CoreFindFreePagesI (
   UINT64      DescStart;
   UINT64      DescEnd;
   UINT64      DescNumberOfBytes;
+  LIST_ENTRY  *FreeList;
   LIST_ENTRY  *Link;
   MEMORY_MAP  *Entry;
 
@@ -1173,15 +1241,14 @@ CoreFindFreePagesI (
   NumberOfBytes = LShiftU64 (NumberOfPages, EFI_PAGE_SHIFT);
   Target        = 0;
 
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-    //
-    // If it's not a free entry, don't bother with it
-    //
-    if (Entry->Type != EfiConventionalMemory) {
-      continue;
-    }
+  //
+  // Only free entries are of interest, so walk the EfiConventionalMemory
+  // descriptors instead of the whole memory map
+  //
+  FreeList = GetMemoryMapTypeList (EfiConventionalMemory);
+  for (Link = FreeList->ForwardLink; Link != FreeList; Link = Link->ForwardLink) {
+    Entry = CR (Link, MEMORY_MAP, TypeLink, MEMORY_MAP_SIGNATURE);
+    ASSERT (Entry->Type == EfiConventionalMemory);
 
     DescStart = Entry->Start;
     DescEnd   = Entry->End;
@@ -1631,7 +1698,6 @@ CoreInternalFreePages (
   )
 {
   EFI_STATUS  Status;
-  LIST_ENTRY  *Link;
   MEMORY_MAP  *Entry;
   UINTN       Alignment;
   BOOLEAN     IsGuarded;
@@ -1645,15 +1711,8 @@ CoreInternalFreePages (
   // Find the entry that the covers the range
   //
   IsGuarded = FALSE;
-  Entry     = NULL;
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    if ((Entry->Start <= Memory) && (Entry->End > Memory)) {
-      break;
-    }
-  }
-
-  if (Link == &gMemoryMap) {
+  Entry     = FindMemoryMapEntry (Memory);
+  if (Entry == NULL) {
     Status = EFI_NOT_FOUND;
     goto Done;
   }
@@ -21,6 +21,7 @@ typedef struct {
 
 #define POOL_HEAD_SIGNATURE      SIGNATURE_32('p','h','d','0')
 #define POOLPAGE_HEAD_SIGNATURE  SIGNATURE_32('p','h','d','1')
+#define POOLSLAB_HEAD_SIGNATURE  SIGNATURE_32('p','h','d','2')
 typedef struct {
   UINT32             Signature;
   UINT32             Reserved;
@@ -59,6 +60,42 @@ STATIC CONST UINT16  mPoolSizeTable[] = {
 
 #define MAX_POOL_SIZE  (MAX_ADDRESS - POOL_OVERHEAD)
 
+//
+// Size classes of the slab pool engine (PcdDxeCorePoolSlabAllocator). Each
+// slab is one allocation granularity unit that starts with a POOL_SLAB header
+// and is split into equal slots of one size class. Larger requests use the
+// free lists above.
+//
+STATIC CONST UINT16  mPoolSlabSizeTable[] = {
+  64, 96, 128, 192, 256, 384, 512, 768, 1024
+};
+
+#define MAX_SLAB_LIST  (ARRAY_SIZE (mPoolSlabSizeTable))
+
+#define POOL_SLAB_SIGNATURE  SIGNATURE_32('p','s','l','b')
+typedef struct {
+  UINT32        Signature;
+  /// Size class of the slots in mPoolSlabSizeTable
+  UINT32        Index;
+  /// Number of slots handed out
+  UINT32        Used;
+  /// Number of slots in the slab
+  UINT32        Count;
+  /// Singly linked list of free slots
+  VOID          *FreeSlot;
+  /// Link on POOL.SlabList[Index] while the slab has free slots
+  LIST_ENTRY    Link;
+} POOL_SLAB;
+
+#define SIZE_OF_POOL_SLAB  ALIGN_VALUE (sizeof (POOL_SLAB), sizeof (UINT64))
+
+#define POOL_SLAB_FREE_SIGNATURE  SIGNATURE_32('p','s','f','0')
+typedef struct {
+  UINT32    Signature;
+  UINT32    Reserved;
+  VOID      *Next;
+} POOL_SLAB_FREE;
+
 //
 // Globals
 //
@@ -69,6 +106,8 @@ typedef struct {
   UINTN              Used;
   EFI_MEMORY_TYPE    MemoryType;
   LIST_ENTRY         FreeList[MAX_POOL_LIST];
+  LIST_ENTRY         SlabList[MAX_SLAB_LIST];
+  UINTN              SlabEmpty[MAX_SLAB_LIST];
   LIST_ENTRY         Link;
 } POOL;
 
@@ -107,6 +146,32 @@ GetPoolIndexFromSize (
   return MAX_POOL_LIST;
 }
 
+/**
+  Get slab size class index from the specified size.
+
+  @param  Size          The specified size to get index from slab size table.
+
+  @return               The index of slab size table, or MAX_SLAB_LIST if the
+                        size is too large to be served from a slab.
+
+**/
+STATIC
+UINTN
+GetSlabIndexFromSize (
+  UINTN  Size
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < MAX_SLAB_LIST; Index++) {
+    if (mPoolSlabSizeTable[Index] >= Size) {
+      return Index;
+    }
+  }
+
+  return MAX_SLAB_LIST;
+}
+
 /**
   Called to initialize the pool.
 
@@ -126,6 +191,11 @@ CoreInitializePool (
     for (Index = 0; Index < MAX_POOL_LIST; Index++) {
       InitializeListHead (&mPoolHead[Type].FreeList[Index]);
     }
+
+    for (Index = 0; Index < MAX_SLAB_LIST; Index++) {
+      InitializeListHead (&mPoolHead[Type].SlabList[Index]);
+      mPoolHead[Type].SlabEmpty[Index] = 0;
+    }
   }
 }
 
@@ -175,6 +245,11 @@ LookupPoolHead (
       InitializeListHead (&Pool->FreeList[Index]);
     }
 
+    for (Index = 0; Index < MAX_SLAB_LIST; Index++) {
+      InitializeListHead (&Pool->SlabList[Index]);
+      Pool->SlabEmpty[Index] = 0;
+    }
+
     InsertHeadList (&mPoolHeadList, &Pool->Link);
 
     return Pool;
@@ -336,6 +411,89 @@ CoreAllocatePoolPagesI (
   return Buffer;
 }
 
+/**
+  Internal function.  Allocates a slot from the slabs of a size class, and
+  adds a new slab to the size class if all of its slabs are full.
+
+  @param  Pool                   The pool head of the memory type
+  @param  Index                  The slab size class index
+  @param  Granularity            The page allocation granularity of the memory type
+
+  @return The allocated slot, or NULL
+
+**/
+STATIC
+POOL_HEAD *
+CoreAllocatePoolSlabI (
+  IN POOL   *Pool,
+  IN UINTN  Index,
+  IN UINTN  Granularity
+  )
+{
+  POOL_SLAB       *Slab;
+  POOL_SLAB_FREE  *Free;
+  CHAR8           *NewPage;
+  UINTN           SlotSize;
+  UINTN           Offset;
+
+  if (IsListEmpty (&Pool->SlabList[Index])) {
+    NewPage = CoreAllocatePoolPagesI (
+                Pool->MemoryType,
+                EFI_SIZE_TO_PAGES (Granularity),
+                Granularity,
+                FALSE
+                );
+    if (NewPage == NULL) {
+      return NULL;
+    }
+
+    //
+    // Split the new slab into free slots behind the slab header
+    //
+    SlotSize        = mPoolSlabSizeTable[Index];
+    Slab            = (POOL_SLAB *)NewPage;
+    Slab->Signature = POOL_SLAB_SIGNATURE;
+    Slab->Index     = (UINT32)Index;
+    Slab->Used      = 0;
+    Slab->Count     = 0;
+    Slab->FreeSlot  = NULL;
+    for (Offset = SIZE_OF_POOL_SLAB; Offset + SlotSize <= Granularity; Offset += SlotSize) {
+      Free            = (POOL_SLAB_FREE *)&NewPage[Offset];
+      Free->Signature = POOL_SLAB_FREE_SIGNATURE;
+      Free->Next      = Slab->FreeSlot;
+      Slab->FreeSlot  = Free;
+      Slab->Count++;
+    }
+
+    InsertHeadList (&Pool->SlabList[Index], &Slab->Link);
+    Pool->SlabEmpty[Index]++;
+  }
+
+  Slab = CR (Pool->SlabList[Index].ForwardLink, POOL_SLAB, Link, POOL_SLAB_SIGNATURE);
+  Free = Slab->FreeSlot;
+  ASSERT (Slab->Used < Slab->Count);
+  ASSERT (Free != NULL);
+  ASSERT (Free->Signature == POOL_SLAB_FREE_SIGNATURE);
+
+  if (Slab->Used == 0) {
+    ASSERT (Pool->SlabEmpty[Index] > 0);
+    Pool->SlabEmpty[Index]--;
+  }
+
+  Slab->FreeSlot = Free->Next;
+  Slab->Used++;
+
+  //
+  // A full slab leaves the size class list until one of its slots is freed
+  //
+  if (Slab->Used == Slab->Count) {
+    ASSERT (Slab->FreeSlot == NULL);
+    RemoveEntryList (&Slab->Link);
+  }
+
+  return (POOL_HEAD *)Free;
+}
+
 /**
   Internal function to allocate pool of a particular type.
   Caller must have the memory lock held
@@ -367,6 +525,7 @@ CoreAllocatePoolI (
   UINTN      Granularity;
   BOOLEAN    HasPoolTail;
   BOOLEAN    PageAsPool;
+  BOOLEAN    SlabAsPool;
 
   ASSERT_LOCKED (&mPoolMemoryLock);
 
@@ -402,7 +561,23 @@ CoreAllocatePoolI (
     return NULL;
   }
 
-  Head = NULL;
+  Head       = NULL;
+  SlabAsPool = FALSE;
+
+  //
+  // Serve small requests from the slabs of their size class if the slab
+  // engine is enabled. Guarded pool is always allocated as pages.
+  //
+  if (FeaturePcdGet (PcdDxeCorePoolSlabAllocator) && !NeedGuard && !PageAsPool) {
+    Index = GetSlabIndexFromSize (Size);
+    if (Index < MAX_SLAB_LIST) {
+      Head       = CoreAllocatePoolSlabI (Pool, Index, Granularity);
+      SlabAsPool = TRUE;
+      goto Done;
+    }
+
+    Index = SIZE_TO_LIST (Size);
+  }
 
   //
   // If allocation is over max size, just allocate pages for the request
@@ -505,7 +680,14 @@ Done:
     //
     // If we have a pool buffer, fill in the header & tail info
     //
-    Head->Signature = (PageAsPool) ? POOLPAGE_HEAD_SIGNATURE : POOL_HEAD_SIGNATURE;
+    if (PageAsPool) {
+      Head->Signature = POOLPAGE_HEAD_SIGNATURE;
+    } else if (SlabAsPool) {
+      Head->Signature = POOLSLAB_HEAD_SIGNATURE;
+    } else {
+      Head->Signature = POOL_HEAD_SIGNATURE;
+    }
+
     Head->Size      = Size;
     Head->Type      = (EFI_MEMORY_TYPE)PoolType;
     Buffer          = Head->Data;
@@ -665,6 +847,78 @@ CoreFreePoolPagesWithGuard (
   }
 }
 
+/**
+  Internal function.  Returns a slot to its slab, and gives the slab back to
+  free memory once none of its slots are in use.
+
+  @param  Pool                   The pool head of the memory type
+  @param  Head                   The pool head of the slot to free
+  @param  Granularity            The page allocation granularity of the memory type
+
+**/
+STATIC
+VOID
+CoreFreePoolSlabI (
+  IN POOL       *Pool,
+  IN POOL_HEAD  *Head,
+  IN UINTN      Granularity
+  )
+{
+  POOL_SLAB       *Slab;
+  POOL_SLAB_FREE  *Free;
+  LIST_ENTRY      *SlabList;
+
+  //
+  // Slabs are aligned on the allocation granularity, so the slab header is
+  // found from the slot address directly
+  //
+  Slab = (POOL_SLAB *)((UINTN)Head & ~(Granularity - 1));
+  ASSERT (Slab->Signature == POOL_SLAB_SIGNATURE);
+  ASSERT (Slab->Used > 0);
+  ASSERT (Slab->Used <= Slab->Count);
+  SlabList = &Pool->SlabList[Slab->Index];
+
+  //
+  // A full slab rejoins the size class list now that it has a free slot
+  //
+  if (Slab->Used == Slab->Count) {
+    InsertHeadList (SlabList, &Slab->Link);
+  }
+
+  Free            = (POOL_SLAB_FREE *)Head;
+  Free->Signature = POOL_SLAB_FREE_SIGNATURE;
+  Free->Next      = Slab->FreeSlot;
+  Slab->FreeSlot  = Free;
+  Slab->Used--;
+
+  if (Slab->Used != 0) {
+    return;
+  }
+
+  //
+  // Keep one empty slab per size class to avoid allocating and freeing
+  // pages when the number of live slots moves back and forth across a slab
+  // boundary, unless this is an OS/OEM specific memory type whose pool head
+  // may be released. The spare slab goes to the tail of the list so that
+  // partially used slabs are filled first.
+  //
+  RemoveEntryList (&Slab->Link);
+  if ((Pool->SlabEmpty[Slab->Index] == 0) &&
+      ((UINT32)Pool->MemoryType < MEMORY_TYPE_OEM_RESERVED_MIN))
+  {
+    InsertTailList (SlabList, &Slab->Link);
+    Pool->SlabEmpty[Slab->Index]++;
+    return;
+  }
+
+  Slab->Signature = 0;
+  CoreFreePoolPagesI (
+    Pool->MemoryType,
+    (EFI_PHYSICAL_ADDRESS)(UINTN)Slab,
+    EFI_SIZE_TO_PAGES (Granularity)
+    );
+}
+
 /**
   Internal function to free a pool entry.
   Caller must have the memory lock held
@@ -696,6 +950,7 @@ CoreFreePoolI (
   BOOLEAN    IsGuarded;
   BOOLEAN    HasPoolTail;
   BOOLEAN    PageAsPool;
+  BOOLEAN    SlabAsPool;
 
   ASSERT (Buffer != NULL);
   //
@@ -705,11 +960,13 @@ CoreFreePoolI (
   ASSERT (Head != NULL);
 
   if ((Head->Signature != POOL_HEAD_SIGNATURE) &&
-      (Head->Signature != POOLPAGE_HEAD_SIGNATURE))
+      (Head->Signature != POOLPAGE_HEAD_SIGNATURE) &&
+      (Head->Signature != POOLSLAB_HEAD_SIGNATURE))
   {
     ASSERT (
       Head->Signature == POOL_HEAD_SIGNATURE ||
-      Head->Signature == POOLPAGE_HEAD_SIGNATURE
+      Head->Signature == POOLPAGE_HEAD_SIGNATURE ||
+      Head->Signature == POOLSLAB_HEAD_SIGNATURE
       );
     return EFI_INVALID_PARAMETER;
   }
@@ -719,6 +976,7 @@ CoreFreePoolI (
   HasPoolTail = !(IsGuarded &&
                   ((PcdGet8 (PcdHeapGuardPropertyMask) & BIT7) == 0));
   PageAsPool = (Head->Signature == POOLPAGE_HEAD_SIGNATURE);
+  SlabAsPool = (Head->Signature == POOLSLAB_HEAD_SIGNATURE);
 
   if (HasPoolTail) {
     Tail = HEAD_TO_TAIL (Head);
@@ -773,10 +1031,15 @@ CoreFreePoolI (
   Index = SIZE_TO_LIST (Size);
   DEBUG_CLEAR_MEMORY (Head, Size);
 
-  //
-  // If it's not on the list, it must be pool pages
-  //
-  if ((Index >= SIZE_TO_LIST (Granularity)) || IsGuarded || PageAsPool) {
+  if (SlabAsPool) {
+    //
+    // Return the slot to its slab
+    //
+    CoreFreePoolSlabI (Pool, Head, Granularity);
+  } else if ((Index >= SIZE_TO_LIST (Granularity)) || IsGuarded || PageAsPool) {
+    //
+    // If it's not on the list, it must be pool pages
+    //
     //
     // Return the memory pages back to free memory
     //
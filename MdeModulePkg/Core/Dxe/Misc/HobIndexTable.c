@@ -0,0 +1,156 @@
+/** @file
+  Index of the GUID HOBs of the HOB list, published for the HOB library
+  instances of DXE drivers.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+
+/**
+  Find the GUID entry of a HOB index.
+
+  @param  GuidEntry      The GUID entries of the index.
+  @param  HashHead       The hash heads of the index.
+  @param  HashSize       The number of hash heads.
+  @param  Guid           The GUID to find.
+
+  @return The index of the GUID entry, or HOB_INDEX_END if Guid is not in the
+          index.
+
+**/
+STATIC
+UINT32
+HobIndexFindGuid (
+  IN HOB_INDEX_GUID_ENTRY  *GuidEntry,
+  IN UINT32                *HashHead,
+  IN UINT32                HashSize,
+  IN CONST EFI_GUID        *Guid
+  )
+{
+  UINT32  Index;
+
+  for (Index = HashHead[HOB_INDEX_HASH (Guid, HashSize)];
+       Index != HOB_INDEX_END;
+       Index = GuidEntry[Index].Next)
+  {
+    if (CompareGuid (&GuidEntry[Index].Name, Guid)) {
+      break;
+    }
+  }
+
+  return Index;
+}
+
+/**
+  Build the index of the GUID HOBs of the HOB list and install it in the EFI
+  System Table as the gEdkiiHobIndexTableGuid configuration table.
+
+  The HOB list must not change afterwards. If the index cannot be allocated,
+  no table is installed and the HOB library instances walk the HOB list.
+
+  @param  HobStart       Pointer to the HOB list.
+
+**/
+VOID
+CoreInstallHobIndexTable (
+  IN VOID  *HobStart
+  )
+{
+  EFI_STATUS            Status;
+  EFI_PEI_HOB_POINTERS  Hob;
+  HOB_INDEX_TABLE       *Table;
+  HOB_INDEX_GUID_ENTRY  *GuidEntry;
+  UINT32                *HashHead;
+  UINT32                *HobOffset;
+  UINT32                HobCount;
+  UINT32                HashSize;
+  UINT32                Index;
+  UINT32                Bucket;
+  UINT32                FirstHob;
+
+  //
+  // Count the GUID HOBs. The number of distinct GUIDs is not known yet, so
+  // room for one GUID entry per HOB is reserved.
+  //
+  HobCount = 0;
+  for (Hob.Raw = HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      HobCount++;
+    }
+  }
+
+  HashSize = 1;
+  while (HashSize < HobCount) {
+    HashSize <<= 1;
+  }
+
+  Table = AllocateZeroPool (HOB_INDEX_TABLE_SIZE (HobCount, HashSize, HobCount));
+  if (Table == NULL) {
+    return;
+  }
+
+  Table->HobList     = (EFI_PHYSICAL_ADDRESS)(UINTN)HobStart;
+  Table->HobListSize = (UINT64)((UINTN)Hob.Raw - (UINTN)HobStart) + sizeof (EFI_HOB_GENERIC_HEADER);
+  Table->HashSize    = HashSize;
+  Table->HobCount    = HobCount;
+  GuidEntry          = HOB_INDEX_GUIDS (Table);
+  HashHead           = (UINT32 *)(GuidEntry + HobCount);
+  SetMem32 (HashHead, HashSize * sizeof (UINT32), HOB_INDEX_END);
+
+  //
+  // Collect the distinct GUIDs and the number of HOBs of each. The hash heads
+  // follow the room reserved for the GUID entries until all are known.
+  //
+  for (Hob.Raw = HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType != EFI_HOB_TYPE_GUID_EXTENSION) {
+      continue;
+    }
+
+    Index = HobIndexFindGuid (GuidEntry, HashHead, HashSize, &Hob.Guid->Name);
+    if (Index == HOB_INDEX_END) {
+      Index  = Table->GuidCount++;
+      Bucket = HOB_INDEX_HASH (&Hob.Guid->Name, HashSize);
+      CopyGuid (&GuidEntry[Index].Name, &Hob.Guid->Name);
+      GuidEntry[Index].Next = HashHead[Bucket];
+      HashHead[Bucket]      = Index;
+    }
+
+    GuidEntry[Index].HobCount++;
+  }
+
+  //
+  // Move the hash heads down behind the GUID entries actually used. The HOB
+  // offsets follow them.
+  //
+  CopyMem (HOB_INDEX_HASH_HEADS (Table), HashHead, HashSize * sizeof (UINT32));
+  HashHead  = HOB_INDEX_HASH_HEADS (Table);
+  HobOffset = HOB_INDEX_HOB_OFFSETS (Table);
+
+  FirstHob = 0;
+  for (Index = 0; Index < Table->GuidCount; Index++) {
+    GuidEntry[Index].FirstHob = FirstHob;
+    FirstHob                 += GuidEntry[Index].HobCount;
+    GuidEntry[Index].HobCount = 0;
+  }
+
+  //
+  // Record the offsets of the HOBs of each GUID in HOB list order.
+  //
+  for (Hob.Raw = HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      Index = HobIndexFindGuid (GuidEntry, HashHead, HashSize, &Hob.Guid->Name);
+      ASSERT (Index != HOB_INDEX_END);
+      HobOffset[GuidEntry[Index].FirstHob + GuidEntry[Index].HobCount++] = (UINT32)((UINTN)Hob.Raw - (UINTN)HobStart);
+    }
+  }
+
+  DEBUG ((DEBUG_INFO, "HOB index: %d GUID HOBs, %d GUIDs\n", HobCount, Table->GuidCount));
+
+  Status = CoreInstallConfigurationTable (&gEdkiiHobIndexTableGuid, Table);
+  if (EFI_ERROR (Status)) {
+    CoreFreePool (Table);
+  }
+}
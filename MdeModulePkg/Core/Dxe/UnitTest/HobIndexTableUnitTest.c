@@ -0,0 +1,669 @@
+/** @file
+  This is a host-based unit test for CoreInstallHobIndexTable ().
+
+  HOB lists with a random mix of GUID HOBs and other HOBs are indexed by the
+  DXE core code. The installed table is checked against the HOB list: the GUID
+  entries must be compacted in front of the hash heads, and the offsets of the
+  HOBs of each GUID must be in HOB list order. Lookups through the table, done
+  the way the DxeHobLib instance does them, must find the same HOB as the HOB
+  list walk, with far fewer GUID comparisons.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../DxeMain.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "DXE Core HOB Index Table Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_GUID_COUNT     200
+#define TEST_HOB_COUNT      1000
+#define TEST_BENCH_HOBS     4096
+#define TEST_GUID_HOB_SIZE  (sizeof (EFI_HOB_GUID_TYPE) + 24)
+
+//
+// Test GUID base {12A9CF23-8159-4AAE-BC68-6F98F681148A}
+//
+EFI_GUID  mTestGuidBase = {
+  0x12a9cf23, 0x8159, 0x4aae, { 0xbc, 0x68, 0x6f, 0x98, 0xf6, 0x81, 0x14, 0x8a }
+};
+
+HOB_INDEX_TABLE  *mTestHobIndex;
+EFI_STATUS       mTestInstallStatus;
+UINTN            mTestFreeCount;
+UINT32           mTestSeed;
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Stand-in for the DXE core service, keeping the HOB index table that
+  CoreInstallHobIndexTable () installs.
+
+  @param[in]  Guid    The GUID of the configuration table.
+  @param[in]  Table   The configuration table.
+
+  @return mTestInstallStatus.
+**/
+EFI_STATUS
+EFIAPI
+CoreInstallConfigurationTable (
+  IN EFI_GUID  *Guid,
+  IN VOID      *Table
+  )
+{
+  if (!EFI_ERROR (mTestInstallStatus) && CompareGuid (Guid, &gEdkiiHobIndexTableGuid)) {
+    mTestHobIndex = Table;
+  }
+
+  return mTestInstallStatus;
+}
+
+/**
+  Stand-in for the DXE core service.
+
+  @param[in]  Buffer   The pool buffer to free.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+CoreFreePool (
+  IN VOID  *Buffer
+  )
+{
+  mTestFreeCount++;
+  FreePool (Buffer);
+  return EFI_SUCCESS;
+}
+
+/**
+  Return a pseudo-random number.
+
+  @return The next number of the sequence.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mTestSeed = mTestSeed * 1103515245 + 12345;
+  return mTestSeed >> 8;
+}
+
+/**
+  Return the test GUID of an index.
+
+  @param[out] Guid    Receives the GUID.
+  @param[in]  Index   Index of the GUID.
+**/
+VOID
+TestGuid (
+  OUT EFI_GUID  *Guid,
+  IN  UINTN     Index
+  )
+{
+  CopyGuid (Guid, &mTestGuidBase);
+  Guid->Data1   += (UINT32)Index;
+  Guid->Data4[7] = (UINT8)(Guid->Data4[7] + Index * 37);
+}
+
+/**
+  Create a HOB list of HobCount HOBs. One HOB out of four is a resource
+  descriptor HOB, the other ones are GUID HOBs with one of GuidCount GUIDs.
+
+  @param[in]  HobCount    Number of HOBs before the end of list HOB.
+  @param[in]  GuidCount   Number of distinct GUIDs of the GUID HOBs.
+
+  @return The HOB list, or NULL if it cannot be allocated.
+**/
+VOID *
+TestCreateHobList (
+  IN UINTN  HobCount,
+  IN UINTN  GuidCount
+  )
+{
+  EFI_PEI_HOB_POINTERS  Hob;
+  VOID                  *HobList;
+  UINTN                 Index;
+
+  HobList = AllocateZeroPool ((HobCount + 1) * TEST_GUID_HOB_SIZE);
+  if (HobList == NULL) {
+    return NULL;
+  }
+
+  Hob.Raw = HobList;
+  for (Index = 0; Index < HobCount; Index++) {
+    if ((GuidCount == 0) || (TestRandom () % 4 == 0)) {
+      Hob.Header->HobType   = EFI_HOB_TYPE_RESOURCE_DESCRIPTOR;
+      Hob.Header->HobLength = sizeof (EFI_HOB_RESOURCE_DESCRIPTOR);
+    } else {
+      Hob.Header->HobType   = EFI_HOB_TYPE_GUID_EXTENSION;
+      Hob.Header->HobLength = TEST_GUID_HOB_SIZE;
+      TestGuid (&Hob.Guid->Name, TestRandom () % GuidCount);
+    }
+
+    Hob.Raw = GET_NEXT_HOB (Hob);
+  }
+
+  Hob.Header->HobType   = EFI_HOB_TYPE_END_OF_HOB_LIST;
+  Hob.Header->HobLength = sizeof (EFI_HOB_GENERIC_HEADER);
+  return HobList;
+}
+
+/**
+  Index a HOB list with CoreInstallHobIndexTable ().
+
+  @param[in]  HobList   The HOB list.
+
+  @return The installed HOB index table, or NULL if none was installed.
+**/
+HOB_INDEX_TABLE *
+TestInstallHobIndex (
+  IN VOID  *HobList
+  )
+{
+  mTestHobIndex      = NULL;
+  mTestInstallStatus = EFI_SUCCESS;
+  CoreInstallHobIndexTable (HobList);
+  return mTestHobIndex;
+}
+
+/**
+  Find the GUID entry of a GUID by following its hash chain.
+
+  @param[in]      Table         The HOB index table.
+  @param[in]      Guid          The GUID to find.
+  @param[in, out] Comparisons   Incremented for every GUID comparison.
+
+  @return The GUID entry, or NULL if Guid is not in the table.
+**/
+HOB_INDEX_GUID_ENTRY *
+TestFindGuidEntry (
+  IN     HOB_INDEX_TABLE  *Table,
+  IN     CONST EFI_GUID   *Guid,
+  IN OUT UINTN            *Comparisons
+  )
+{
+  HOB_INDEX_GUID_ENTRY  *GuidEntry;
+  UINT32                Index;
+
+  GuidEntry = HOB_INDEX_GUIDS (Table);
+  for (Index = HOB_INDEX_HASH_HEADS (Table)[HOB_INDEX_HASH (Guid, Table->HashSize)];
+       Index != HOB_INDEX_END;
+       Index = GuidEntry[Index].Next)
+  {
+    *Comparisons += 1;
+    if (CompareGuid (&GuidEntry[Index].Name, Guid)) {
+      return &GuidEntry[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Find the next GUID HOB from a starting HOB through the HOB index table, the
+  way GetNextGuidHob () of DxeHobLib does.
+
+  @param[in]      Table         The HOB index table.
+  @param[in]      Guid          The GUID to match with in the HOB list.
+  @param[in]      HobStart      The starting HOB.
+  @param[in, out] Comparisons   Incremented for every GUID comparison.
+
+  @return The next instance of the matched GUID HOB from the starting HOB.
+**/
+VOID *
+TestIndexedGuidHob (
+  IN     HOB_INDEX_TABLE  *Table,
+  IN     CONST EFI_GUID   *Guid,
+  IN     CONST VOID       *HobStart,
+  IN OUT UINTN            *Comparisons
+  )
+{
+  HOB_INDEX_GUID_ENTRY  *GuidEntry;
+  UINT32                *HobOffset;
+  UINT32                Low;
+  UINT32                High;
+  UINT32                Middle;
+  UINTN                 StartOffset;
+
+  GuidEntry = TestFindGuidEntry (Table, Guid, Comparisons);
+  if (GuidEntry == NULL) {
+    return NULL;
+  }
+
+  StartOffset = (UINTN)HobStart - (UINTN)Table->HobList;
+  HobOffset   = HOB_INDEX_HOB_OFFSETS (Table) + GuidEntry->FirstHob;
+  Low         = 0;
+  High        = GuidEntry->HobCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (HobOffset[Middle] < StartOffset) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  if (Low == GuidEntry->HobCount) {
+    return NULL;
+  }
+
+  return (VOID *)(UINTN)(Table->HobList + HobOffset[Low]);
+}
+
+/**
+  Reference implementation of GetNextGuidHob ().
+
+  @param[in]      Guid          The GUID to match with in the HOB list.
+  @param[in]      HobStart      The starting HOB.
+  @param[in, out] Comparisons   Incremented for every GUID comparison.
+
+  @return The next instance of the matched GUID HOB from the starting HOB.
+**/
+VOID *
+TestWalkGuidHob (
+  IN     CONST EFI_GUID  *Guid,
+  IN     CONST VOID      *HobStart,
+  IN OUT UINTN           *Comparisons
+  )
+{
+  EFI_PEI_HOB_POINTERS  Hob;
+
+  for (Hob.Raw = (UINT8 *)HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      *Comparisons += 1;
+      if (CompareGuid (Guid, &Hob.Guid->Name)) {
+        return Hob.Raw;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Check the HOB index table of a HOB list against the HOB list.
+
+  @param[in]  Table     The HOB index table.
+  @param[in]  HobList   The HOB list.
+
+  @retval UNIT_TEST_PASSED   The table describes the HOB list.
+**/
+UNIT_TEST_STATUS
+TestCheckHobIndex (
+  IN HOB_INDEX_TABLE  *Table,
+  IN VOID             *HobList
+  )
+{
+  EFI_PEI_HOB_POINTERS  Hob;
+  HOB_INDEX_GUID_ENTRY  *GuidEntry;
+  HOB_INDEX_GUID_ENTRY  *Found;
+  UINT32                *HashHead;
+  UINT32                *HobOffset;
+  UINT32                Index;
+  UINT32                Hob32;
+  UINT32                FirstHob;
+  UINT32                GuidHobCount;
+  UINTN                 Comparisons;
+
+  UT_ASSERT_EQUAL (Table->HobList, (UINTN)HobList);
+
+  GuidHobCount = 0;
+  for (Hob.Raw = HobList; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      GuidHobCount++;
+    }
+  }
+
+  UT_ASSERT_EQUAL (Table->HobListSize, (UINTN)Hob.Raw + sizeof (EFI_HOB_GENERIC_HEADER) - (UINTN)HobList);
+  UT_ASSERT_EQUAL (Table->HobCount, GuidHobCount);
+  UT_ASSERT_TRUE (Table->HashSize >= Table->HobCount);
+  UT_ASSERT_EQUAL (Table->HashSize & (Table->HashSize - 1), 0);
+  UT_ASSERT_TRUE (Table->GuidCount <= Table->HobCount);
+
+  //
+  // The GUID entries are compacted: the hash heads and the chains only refer
+  // to the GuidCount entries in front of them, and each entry is on the chain
+  // of its bucket.
+  //
+  GuidEntry = HOB_INDEX_GUIDS (Table);
+  HashHead  = HOB_INDEX_HASH_HEADS (Table);
+  HobOffset = HOB_INDEX_HOB_OFFSETS (Table);
+  for (Index = 0; Index < Table->HashSize; Index++) {
+    UT_ASSERT_TRUE ((HashHead[Index] == HOB_INDEX_END) || (HashHead[Index] < Table->GuidCount));
+  }
+
+  FirstHob = 0;
+  for (Index = 0; Index < Table->GuidCount; Index++) {
+    UT_ASSERT_TRUE ((GuidEntry[Index].Next == HOB_INDEX_END) || (GuidEntry[Index].Next < Table->GuidCount));
+    Comparisons = 0;
+    Found       = TestFindGuidEntry (Table, &GuidEntry[Index].Name, &Comparisons);
+    UT_ASSERT_EQUAL ((UINTN)Found, (UINTN)&GuidEntry[Index]);
+    UT_ASSERT_EQUAL (GuidEntry[Index].FirstHob, FirstHob);
+    UT_ASSERT_TRUE (GuidEntry[Index].HobCount > 0);
+    FirstHob += GuidEntry[Index].HobCount;
+
+    //
+    // The HOBs of the GUID are sorted in HOB list order, and they are all the
+    // GUID HOBs of that GUID.
+    //
+    Found = NULL;
+    for (Hob32 = 0; Hob32 < GuidEntry[Index].HobCount; Hob32++) {
+      if (Hob32 > 0) {
+        UT_ASSERT_TRUE (HobOffset[FirstHob - GuidEntry[Index].HobCount + Hob32 - 1] < HobOffset[FirstHob - GuidEntry[Index].HobCount + Hob32]);
+      }
+    }
+
+    GuidHobCount = 0;
+    Hob32        = FirstHob - GuidEntry[Index].HobCount;
+    for (Hob.Raw = HobList; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+      if ((Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) && CompareGuid (&Hob.Guid->Name, &GuidEntry[Index].Name)) {
+        UT_ASSERT_EQUAL (HobOffset[Hob32 + GuidHobCount], (UINTN)Hob.Raw - (UINTN)HobList);
+        GuidHobCount++;
+      }
+    }
+
+    UT_ASSERT_EQUAL (GuidHobCount, GuidEntry[Index].HobCount);
+  }
+
+  UT_ASSERT_EQUAL (FirstHob, Table->HobCount);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the HOB index table of a test case.
+
+  @param[in]  Context  Unit test case context
+**/
+VOID
+EFIAPI
+HobIndexCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  if (mTestHobIndex != NULL) {
+    FreePool (mTestHobIndex);
+  }
+
+  mTestHobIndex = NULL;
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  Index HOB lists of several sizes and check the installed tables, then check
+  that lookups through the table match the HOB list walk from every HOB.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+HobIndexMatchesHobList (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINTN    HobCounts[]  = { 1, 7, 64, TEST_HOB_COUNT };
+  STATIC CONST UINTN    GuidCounts[] = { 1, 3, 40, TEST_GUID_COUNT };
+  EFI_PEI_HOB_POINTERS  Hob;
+  EFI_GUID              Guid;
+  HOB_INDEX_TABLE       *Table;
+  VOID                  *HobList;
+  UINTN                 Count;
+  UINTN                 Index;
+  UINTN                 Comparisons;
+  UNIT_TEST_STATUS      Status;
+
+  for (Count = 0; Count < ARRAY_SIZE (HobCounts); Count++) {
+    mTestSeed = (UINT32)Count + 1;
+    HobList   = TestCreateHobList (HobCounts[Count], GuidCounts[Count]);
+    UT_ASSERT_NOT_NULL (HobList);
+    Table = TestInstallHobIndex (HobList);
+    UT_ASSERT_NOT_NULL (Table);
+
+    Status = TestCheckHobIndex (Table, HobList);
+    UT_ASSERT_EQUAL (Status, UNIT_TEST_PASSED);
+
+    for (Index = 0; Index <= GuidCounts[Count]; Index++) {
+      TestGuid (&Guid, Index);
+      for (Hob.Raw = HobList; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+        Comparisons = 0;
+        UT_ASSERT_EQUAL (
+          (UINTN)TestIndexedGuidHob (Table, &Guid, Hob.Raw, &Comparisons),
+          (UINTN)TestWalkGuidHob (&Guid, Hob.Raw, &Comparisons)
+          );
+      }
+    }
+
+    HobIndexCleanup (NULL);
+    FreePool (HobList);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A HOB list without GUID HOBs gets an empty table, and the table is freed
+  when it cannot be installed.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+HobIndexEmptyAndInstallFailure (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GUID         Guid;
+  HOB_INDEX_TABLE  *Table;
+  VOID             *HobList;
+  UINTN            Comparisons;
+
+  mTestSeed = 1;
+  HobList   = TestCreateHobList (16, 0);
+  UT_ASSERT_NOT_NULL (HobList);
+  Table = TestInstallHobIndex (HobList);
+  UT_ASSERT_NOT_NULL (Table);
+  UT_ASSERT_EQUAL (Table->GuidCount, 0);
+  UT_ASSERT_EQUAL (Table->HobCount, 0);
+  UT_ASSERT_EQUAL (Table->HashSize, 1);
+  UT_ASSERT_EQUAL (HOB_INDEX_HASH_HEADS (Table)[0], HOB_INDEX_END);
+  TestGuid (&Guid, 0);
+  Comparisons = 0;
+  UT_ASSERT_TRUE (TestIndexedGuidHob (Table, &Guid, HobList, &Comparisons) == NULL);
+  UT_ASSERT_EQUAL (Comparisons, 0);
+  HobIndexCleanup (NULL);
+  FreePool (HobList);
+
+  mTestSeed = 2;
+  HobList   = TestCreateHobList (64, 8);
+  UT_ASSERT_NOT_NULL (HobList);
+  mTestFreeCount     = 0;
+  mTestHobIndex      = NULL;
+  mTestInstallStatus = EFI_OUT_OF_RESOURCES;
+  CoreInstallHobIndexTable (HobList);
+  UT_ASSERT_TRUE (mTestHobIndex == NULL);
+  UT_ASSERT_EQUAL (mTestFreeCount, 1);
+  FreePool (HobList);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Count the GUID comparisons of GetFirstGuidHob ()-style lookups with and
+  without the HOB index. With a hash table at least as large as the number of
+  GUID HOBs, a lookup must take a few comparisons instead of a walk over the
+  HOB list.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+HobIndexLookupCost (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GUID         Guid;
+  HOB_INDEX_TABLE  *Table;
+  VOID             *HobList;
+  UINTN            Index;
+  UINTN            WalkComparisons;
+  UINTN            IndexComparisons;
+
+  mTestSeed = 3;
+  HobList   = TestCreateHobList (TEST_BENCH_HOBS, TEST_GUID_COUNT);
+  UT_ASSERT_NOT_NULL (HobList);
+  Table = TestInstallHobIndex (HobList);
+  UT_ASSERT_NOT_NULL (Table);
+
+  WalkComparisons  = 0;
+  IndexComparisons = 0;
+  for (Index = 0; Index <= TEST_GUID_COUNT; Index++) {
+    TestGuid (&Guid, Index);
+    UT_ASSERT_EQUAL (
+      (UINTN)TestIndexedGuidHob (Table, &Guid, HobList, &IndexComparisons),
+      (UINTN)TestWalkGuidHob (&Guid, HobList, &WalkComparisons)
+      );
+  }
+
+  UT_LOG_INFO (
+    "%Lu lookups in %Lu HOBs: HOB list walk %Lu GUID comparisons, index %Lu\n",
+    (UINT64)(TEST_GUID_COUNT + 1),
+    (UINT64)TEST_BENCH_HOBS,
+    (UINT64)WalkComparisons,
+    (UINT64)IndexComparisons
+    );
+
+  //
+  // Every lookup through the index compares at least the GUID it finds, and
+  // the chains of a hash table that is not overloaded stay short.
+  //
+  UT_ASSERT_TRUE (IndexComparisons >= TEST_GUID_COUNT);
+  UT_ASSERT_TRUE (IndexComparisons <= 4 * (TEST_GUID_COUNT + 1));
+  UT_ASSERT_TRUE (IndexComparisons * 10 < WalkComparisons);
+
+  HobIndexCleanup (NULL);
+  FreePool (HobList);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Main entry point to the unit test.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      HobIndexTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &HobIndexTests,
+             Framework,
+             "HOB Index Table Tests",
+             "DxeCore.HobIndexTable",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for HobIndexTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    HobIndexTests,
+    "The installed table should describe the HOB list",
+    "MatchesHobList",
+    HobIndexMatchesHobList,
+    NULL,
+    HobIndexCleanup,
+    NULL
+    );
+  AddTestCase (
+    HobIndexTests,
+    "An empty table should be installed, a failed install should free it",
+    "EmptyAndFailure",
+    HobIndexEmptyAndInstallFailure,
+    NULL,
+    HobIndexCleanup,
+    NULL
+    );
+  AddTestCase (
+    HobIndexTests,
+    "Indexed lookups should take far fewer GUID comparisons than the walk",
+    "LookupCost",
+    HobIndexLookupCost,
+    NULL,
+    HobIndexCleanup,
+    NULL
+    );
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
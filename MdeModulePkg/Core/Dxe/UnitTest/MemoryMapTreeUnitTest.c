@@ -0,0 +1,597 @@
+/** @file
+  This is a host-based unit test for the address index of the DXE core memory
+  map in MemoryMapTree.c.
+
+  A randomized sequence of page allocations and frees is applied to a memory
+  map the way CoreConvertPagesEx () and CoreAddRange () update gMemoryMap.
+  After every step the descriptors found through the index are compared with
+  the linear walk of the map that the DXE core used before, and the red-black
+  properties of the index are checked.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../DxeMain.h"
+#include "../Mem/Imem.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "DXE Core Memory Map Index Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_MAP_PAGES        2048
+#define TEST_MAX_ENTRIES      (TEST_MAP_PAGES + 1)
+#define TEST_ITERATIONS       20000
+#define TEST_LOOKUPS          16
+#define TEST_ALLOCATED_TYPES  5
+
+extern MEMORY_MAP_NODE  mMemoryMapTreeNil;
+extern MEMORY_MAP_NODE  *mMemoryMapTreeRoot;
+
+//
+// The test memory map, the pool of its descriptors and the type of each page
+//
+LIST_ENTRY       mTestMap;
+MEMORY_MAP       mTestEntries[TEST_MAX_ENTRIES];
+MEMORY_MAP       *mTestFreeEntries[TEST_MAX_ENTRIES];
+UINTN            mTestFreeEntryCount;
+EFI_MEMORY_TYPE  mTestPageType[TEST_MAP_PAGES];
+UINT32           mTestSeed;
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Deterministic pseudo random number generator, so failures reproduce.
+
+  @return Next pseudo random number.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mTestSeed = mTestSeed * 1103515245 + 12345;
+  return (mTestSeed >> 16) & 0x7FFF;
+}
+
+/**
+  Find the descriptor that covers an address by walking the whole map, as
+  CoreConvertPagesEx () and CoreFreePages () did before the index.
+
+  @param[in] Address   Address to look up.
+
+  @return The descriptor covering Address, or NULL.
+**/
+MEMORY_MAP *
+TestWalkMap (
+  IN UINT64  Address
+  )
+{
+  LIST_ENTRY  *Link;
+  MEMORY_MAP  *Entry;
+
+  for (Link = mTestMap.ForwardLink; Link != &mTestMap; Link = Link->ForwardLink) {
+    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+    if ((Entry->Start <= Address) && (Entry->End > Address)) {
+      return Entry;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Remove a descriptor from the test map and return it to the pool.
+
+  @param[in] Entry     The descriptor.
+**/
+VOID
+TestRemoveEntry (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  RemoveMemoryMapTreeEntry (Entry);
+  RemoveEntryList (&Entry->Link);
+  mTestFreeEntries[mTestFreeEntryCount++] = Entry;
+}
+
+/**
+  Add a range to the test map, merging it with the adjoining descriptors of
+  the same type as CoreAddRange () does.
+
+  @param[in] Type      Memory type of the range.
+  @param[in] Start     First byte of the range.
+  @param[in] End       Last byte of the range.
+**/
+VOID
+TestAddRange (
+  IN EFI_MEMORY_TYPE  Type,
+  IN UINT64           Start,
+  IN UINT64           End
+  )
+{
+  MEMORY_MAP  *Entry;
+
+  if (Start != 0) {
+    Entry = FindMemoryMapTreeEntry (Start - 1);
+    if ((Entry != NULL) && (Entry->Type == Type)) {
+      Start = Entry->Start;
+      TestRemoveEntry (Entry);
+    }
+  }
+
+  Entry = FindMemoryMapTreeEntry (End + 1);
+  if ((Entry != NULL) && (Entry->Type == Type)) {
+    End = Entry->End;
+    TestRemoveEntry (Entry);
+  }
+
+  Entry            = mTestFreeEntries[--mTestFreeEntryCount];
+  Entry->Signature = MEMORY_MAP_SIGNATURE;
+  Entry->Type      = Type;
+  Entry->Start     = Start;
+  Entry->End       = End;
+  Entry->Attribute = 0;
+  InsertTailList (&mTestMap, &Entry->Link);
+  InsertMemoryMapTreeEntry (Entry);
+}
+
+/**
+  Convert the pages of a range that lies in one descriptor to a new type, as
+  CoreConvertPagesEx () does: the front of the descriptor is clipped in place,
+  even when that empties it, or the descriptor is split.
+
+  @param[in] Start     First byte of the range.
+  @param[in] End       Last byte of the range.
+  @param[in] NewType   New memory type of the range.
+**/
+VOID
+TestConvertRange (
+  IN UINT64           Start,
+  IN UINT64           End,
+  IN EFI_MEMORY_TYPE  NewType
+  )
+{
+  MEMORY_MAP  *Entry;
+  MEMORY_MAP  *Split;
+  UINT64      Page;
+
+  Entry = FindMemoryMapTreeEntry (Start);
+  if (Entry->Start == Start) {
+    Entry->Start = End + 1;
+  } else if (Entry->End == End) {
+    Entry->End = Start - 1;
+  } else {
+    Split            = mTestFreeEntries[--mTestFreeEntryCount];
+    Split->Signature = MEMORY_MAP_SIGNATURE;
+    Split->Type      = Entry->Type;
+    Split->Start     = End + 1;
+    Split->End       = Entry->End;
+    Split->Attribute = 0;
+    Entry->End       = Start - 1;
+    InsertTailList (&mTestMap, &Split->Link);
+    InsertMemoryMapTreeEntry (Split);
+  }
+
+  if (Entry->Start == Entry->End + 1) {
+    TestRemoveEntry (Entry);
+  }
+
+  TestAddRange (NewType, Start, End);
+
+  for (Page = Start / EFI_PAGE_SIZE; Page <= End / EFI_PAGE_SIZE; Page++) {
+    mTestPageType[Page] = NewType;
+  }
+}
+
+/**
+  Check the red-black properties of a subtree of the index and the order of
+  its descriptors.
+
+  @param[in]     Node      Root of the subtree.
+  @param[in,out] Count     Incremented by the number of nodes of the subtree.
+
+  @return The number of black nodes on the paths to the leaves, or -1 if a
+          property does not hold.
+**/
+INTN
+TestCheckSubtree (
+  IN     MEMORY_MAP_NODE  *Node,
+  IN OUT UINTN            *Count
+  )
+{
+  INTN        LeftHeight;
+  INTN        RightHeight;
+  MEMORY_MAP  *Entry;
+  MEMORY_MAP  *Child;
+
+  if (Node == &mMemoryMapTreeNil) {
+    return 1;
+  }
+
+  *Count += 1;
+  Entry   = CR (Node, MEMORY_MAP, Node, MEMORY_MAP_SIGNATURE);
+  if (Node->Red && (Node->Left->Red || Node->Right->Red)) {
+    return -1;
+  }
+
+  if (Node->Left != &mMemoryMapTreeNil) {
+    Child = CR (Node->Left, MEMORY_MAP, Node, MEMORY_MAP_SIGNATURE);
+    if ((Node->Left->Parent != Node) || (Child->End >= Entry->Start)) {
+      return -1;
+    }
+  }
+
+  if (Node->Right != &mMemoryMapTreeNil) {
+    Child = CR (Node->Right, MEMORY_MAP, Node, MEMORY_MAP_SIGNATURE);
+    if ((Node->Right->Parent != Node) || (Child->Start <= Entry->End)) {
+      return -1;
+    }
+  }
+
+  LeftHeight  = TestCheckSubtree (Node->Left, Count);
+  RightHeight = TestCheckSubtree (Node->Right, Count);
+  if ((LeftHeight < 0) || (LeftHeight != RightHeight)) {
+    return -1;
+  }
+
+  return LeftHeight + (Node->Red ? 0 : 1);
+}
+
+/**
+  Check the whole test map against the index and the page types.
+
+  @retval TRUE    The map, the index and the page types agree.
+  @retval FALSE   They do not.
+**/
+BOOLEAN
+TestCheckMap (
+  VOID
+  )
+{
+  LIST_ENTRY  *Link;
+  MEMORY_MAP  *Entry;
+  MEMORY_MAP  *Next;
+  UINTN       ListCount;
+  UINTN       TreeCount;
+  UINT64      Address;
+  UINT64      Page;
+  UINTN       Index;
+
+  if (mMemoryMapTreeRoot->Red || mMemoryMapTreeNil.Red) {
+    return FALSE;
+  }
+
+  TreeCount = 0;
+  if (TestCheckSubtree (mMemoryMapTreeRoot, &TreeCount) < 0) {
+    return FALSE;
+  }
+
+  ListCount = 0;
+  for (Link = mTestMap.ForwardLink; Link != &mTestMap; Link = Link->ForwardLink) {
+    ListCount++;
+  }
+
+  if (ListCount != TreeCount) {
+    return FALSE;
+  }
+
+  //
+  // Walk the descriptors in address order: they cover the map without gaps,
+  // have the type of their pages, and adjoining ones have different types
+  //
+  Address = 0;
+  for (Entry = FindMemoryMapTreeEntry (0); Entry != NULL; Entry = Next) {
+    if (Entry->Start != Address) {
+      return FALSE;
+    }
+
+    for (Page = Entry->Start / EFI_PAGE_SIZE; Page <= Entry->End / EFI_PAGE_SIZE; Page++) {
+      if (mTestPageType[Page] != Entry->Type) {
+        return FALSE;
+      }
+    }
+
+    Next = GetNextMemoryMapTreeEntry (Entry);
+    if ((Next != NULL) && (Next->Type == Entry->Type)) {
+      return FALSE;
+    }
+
+    Address = Entry->End + 1;
+  }
+
+  if (Address != TEST_MAP_PAGES * EFI_PAGE_SIZE) {
+    return FALSE;
+  }
+
+  //
+  // The index finds the same descriptors as the walk of the map
+  //
+  for (Index = 0; Index < TEST_LOOKUPS; Index++) {
+    Address = (UINT64)(TestRandom () % (TEST_MAP_PAGES + 1)) * EFI_PAGE_SIZE;
+    if (FindMemoryMapTreeEntry (Address) != TestWalkMap (Address)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Pick a random descriptor of the test map.
+
+  @param[in] Free      Pick an EfiConventionalMemory descriptor if TRUE, an
+                       allocated one otherwise.
+
+  @return The descriptor, or NULL if there is none.
+**/
+MEMORY_MAP *
+TestPickEntry (
+  IN BOOLEAN  Free
+  )
+{
+  LIST_ENTRY  *Link;
+  MEMORY_MAP  *Entry;
+  MEMORY_MAP  *Picked;
+  UINTN       Count;
+
+  Picked = NULL;
+  Count  = 0;
+  for (Link = mTestMap.ForwardLink; Link != &mTestMap; Link = Link->ForwardLink) {
+    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
+    if ((Entry->Type == EfiConventionalMemory) == Free) {
+      Count++;
+      if (TestRandom () % Count == 0) {
+        Picked = Entry;
+      }
+    }
+  }
+
+  return Picked;
+}
+
+/**
+  Reset the test map to one free descriptor.
+
+  @param[in] Context   Unused.
+
+  @retval UNIT_TEST_PASSED   Always.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ResetTestMap (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  InitializeListHead (&mTestMap);
+  mMemoryMapTreeRoot = &mMemoryMapTreeNil;
+  for (Index = 0; Index < TEST_MAX_ENTRIES; Index++) {
+    mTestFreeEntries[Index] = &mTestEntries[TEST_MAX_ENTRIES - 1 - Index];
+  }
+
+  mTestFreeEntryCount = TEST_MAX_ENTRIES;
+  for (Index = 0; Index < TEST_MAP_PAGES; Index++) {
+    mTestPageType[Index] = EfiConventionalMemory;
+  }
+
+  TestAddRange (EfiConventionalMemory, 0, TEST_MAP_PAGES * EFI_PAGE_SIZE - 1);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  Allocate and free random page ranges and compare the index with the walk
+  of the map after each step.
+
+  @param[in] Context   Unused.
+
+  @retval UNIT_TEST_PASSED   The index matched the map after every step.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RandomAllocateFree (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN       Iteration;
+  MEMORY_MAP  *Entry;
+  BOOLEAN     Allocate;
+  UINT64      Pages;
+  UINT64      Offset;
+  UINT64      Length;
+  UINT64      Start;
+
+  mTestSeed = 0x0003;
+  UT_ASSERT_TRUE (TestCheckMap ());
+
+  for (Iteration = 0; Iteration < TEST_ITERATIONS; Iteration++) {
+    Allocate = (BOOLEAN)(TestRandom () % 2 == 0);
+    Entry    = TestPickEntry (Allocate);
+    if (Entry == NULL) {
+      Entry    = TestPickEntry (!Allocate);
+      Allocate = (BOOLEAN)!Allocate;
+    }
+
+    //
+    // Convert a random part of the descriptor, which may be all of it, its
+    // front, its back or its middle
+    //
+    Pages  = (Entry->End + 1 - Entry->Start) / EFI_PAGE_SIZE;
+    Offset = TestRandom () % Pages;
+    Length = 1 + TestRandom () % (Pages - Offset);
+    if (TestRandom () % 4 == 0) {
+      Offset = 0;
+    }
+
+    Start = Entry->Start + Offset * EFI_PAGE_SIZE;
+    if (Allocate) {
+      TestConvertRange (Start, Start + Length * EFI_PAGE_SIZE - 1, (EFI_MEMORY_TYPE)(1 + TestRandom () % TEST_ALLOCATED_TYPES));
+    } else {
+      TestConvertRange (Start, Start + Length * EFI_PAGE_SIZE - 1, EfiConventionalMemory);
+    }
+
+    UT_ASSERT_TRUE (TestCheckMap ());
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Allocate every other page, so that the map holds many descriptors, then
+  free them in a random order.
+
+  @param[in] Context   Unused.
+
+  @retval UNIT_TEST_PASSED   The index matched the map after every step.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+FragmentAndCoalesce (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT64  Page;
+  UINTN   Remaining;
+  UINTN   Skip;
+
+  mTestSeed = 0x1234;
+  for (Page = 0; Page < TEST_MAP_PAGES; Page += 2) {
+    TestConvertRange (Page * EFI_PAGE_SIZE, Page * EFI_PAGE_SIZE + EFI_PAGE_SIZE - 1, EfiBootServicesData);
+  }
+
+  UT_ASSERT_TRUE (TestCheckMap ());
+  UT_ASSERT_EQUAL (mMemoryMapTreeRoot != &mMemoryMapTreeNil, TRUE);
+
+  for (Remaining = TEST_MAP_PAGES / 2; Remaining > 0; Remaining--) {
+    Skip = TestRandom () % Remaining;
+    for (Page = 0; Page < TEST_MAP_PAGES; Page += 2) {
+      if (mTestPageType[Page] == EfiBootServicesData) {
+        if (Skip == 0) {
+          break;
+        }
+
+        Skip--;
+      }
+    }
+
+    TestConvertRange (Page * EFI_PAGE_SIZE, Page * EFI_PAGE_SIZE + EFI_PAGE_SIZE - 1, EfiConventionalMemory);
+    UT_ASSERT_TRUE (TestCheckMap ());
+  }
+
+  UT_ASSERT_EQUAL (FindMemoryMapTreeEntry (0)->End, TEST_MAP_PAGES * EFI_PAGE_SIZE - 1);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the memory
+  map index and run them.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      TreeTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &TreeTests,
+             Framework,
+             "Memory Map Index Tests",
+             "DxeCore.MemoryMapTree",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for TreeTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    TreeTests,
+    "Random allocations and frees should match the walk of the map",
+    "RandomAllocateFree",
+    RandomAllocateFree,
+    ResetTestMap,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    TreeTests,
+    "A fragmented map should coalesce back to one descriptor",
+    "FragmentAndCoalesce",
+    FragmentAndCoalesce,
+    ResetTestMap,
+    NULL,
+    NULL
+    );
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
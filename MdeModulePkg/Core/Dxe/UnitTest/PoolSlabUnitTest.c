@@ -0,0 +1,692 @@
+/** @file
+  This is a host-based unit test and microbenchmark for the DXE core pool
+  allocator in Pool.c, built once with the slab allocator
+  (PcdDxeCorePoolSlabAllocator) and once with the pool free lists only.
+
+  Random sequences of CoreInternalAllocatePool () and CoreInternalFreePool ()
+  calls are checked for overlapping buffers, and the pages taken from the page
+  allocator are counted. The benchmark times a mix of small allocations and
+  frees with a fixed working set.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include "../DxeMain.h"
+#include "../Mem/Imem.h"
+#include "../Mem/HeapGuard.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "DXE Core Pool Slab Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_LIVE_BUFFERS      2000
+#define TEST_ITERATIONS        100000
+#define TEST_REUSE_BUFFERS     1000
+#define TEST_BENCH_LIVE        1024
+#define TEST_BENCH_OPERATIONS  2000000
+#define TEST_OEM_MEMORY_TYPE   ((EFI_MEMORY_TYPE)0x70000001)
+
+typedef struct {
+  UINT8              *Buffer;
+  UINTN              Size;
+  EFI_MEMORY_TYPE    Type;
+} TEST_BUFFER;
+
+EFI_LOCK  gMemoryLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
+BOOLEAN   mOnGuarding = FALSE;
+
+//
+// Pages handed out by the page allocator stand-in, per memory type. OEM and
+// OS memory types are counted in the last entry.
+//
+UINTN        mTestPages[EfiMaxMemoryType + 1];
+UINTN        mTestPageAllocations;
+UINT32       mTestSeed;
+TEST_BUFFER  mTestBuffers[TEST_LIVE_BUFFERS];
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Return the mTestPages entry of a memory type.
+
+  @param[in]  MemoryType  The memory type.
+
+  @return The index in mTestPages.
+**/
+UINTN
+TestPageIndex (
+  IN EFI_MEMORY_TYPE  MemoryType
+  )
+{
+  return ((UINT32)MemoryType < EfiMaxMemoryType) ? (UINTN)MemoryType : EfiMaxMemoryType;
+}
+
+/**
+  Stand-in for the DXE core page allocator, pool pages are aligned on the
+  allocation granularity.
+**/
+VOID *
+CoreAllocatePoolPages (
+  IN EFI_MEMORY_TYPE  PoolType,
+  IN UINTN            NumberOfPages,
+  IN UINTN            Alignment,
+  IN BOOLEAN          NeedGuard
+  )
+{
+  VOID  *Buffer;
+
+  Buffer = AllocateAlignedPages (NumberOfPages, Alignment);
+  if (Buffer != NULL) {
+    mTestPages[TestPageIndex (PoolType)] += NumberOfPages;
+    mTestPageAllocations++;
+  }
+
+  return Buffer;
+}
+
+/**
+  Stand-in for the DXE core page allocator. The pages of pool memory of every
+  type are accounted in CoreFreePoolPagesI () through
+  ApplyMemoryProtectionPolicy ().
+**/
+VOID
+CoreFreePoolPages (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NumberOfPages
+  )
+{
+  FreeAlignedPages ((VOID *)(UINTN)Memory, NumberOfPages);
+}
+
+/**
+  Account the pool pages given back to free memory.
+**/
+EFI_STATUS
+EFIAPI
+ApplyMemoryProtectionPolicy (
+  IN  EFI_MEMORY_TYPE       OldType,
+  IN  EFI_MEMORY_TYPE       NewType,
+  IN  EFI_PHYSICAL_ADDRESS  Memory,
+  IN  UINT64                Length
+  )
+{
+  if (NewType == EfiConventionalMemory) {
+    mTestPages[TestPageIndex (OldType)] -= EFI_SIZE_TO_PAGES ((UINTN)Length);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the DXE core service.
+**/
+VOID
+CoreAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->Lock = EfiLockAcquired;
+}
+
+/**
+  Stand-in for the DXE core service.
+**/
+EFI_STATUS
+CoreAcquireLockOrFail (
+  IN EFI_LOCK  *Lock
+  )
+{
+  if (Lock->Lock == EfiLockAcquired) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  Lock->Lock = EfiLockAcquired;
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the DXE core service.
+**/
+VOID
+CoreReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+}
+
+/**
+  Stand-in for the DXE core service.
+**/
+VOID
+CoreAcquireMemoryLock (
+  VOID
+  )
+{
+  CoreAcquireLock (&gMemoryLock);
+}
+
+/**
+  Stand-in for the DXE core service.
+**/
+VOID
+CoreReleaseMemoryLock (
+  VOID
+  )
+{
+  CoreReleaseLock (&gMemoryLock);
+}
+
+/**
+  Stand-in for the DXE core service, memory profiling is disabled.
+**/
+EFI_STATUS
+EFIAPI
+CoreUpdateProfile (
+  IN EFI_PHYSICAL_ADDRESS   CallerAddress,
+  IN MEMORY_PROFILE_ACTION  Action,
+  IN EFI_MEMORY_TYPE        MemoryType,
+  IN UINTN                  Size,
+  IN VOID                   *Buffer,
+  IN CHAR8                  *ActionString OPTIONAL
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Stand-in for the DXE core service.
+**/
+VOID
+InstallMemoryAttributesTableOnMemoryAllocation (
+  IN EFI_MEMORY_TYPE  MemoryType
+  )
+{
+}
+
+/**
+  Stand-in for the DXE core service, the heap guard is disabled.
+**/
+BOOLEAN
+IsHeapGuardEnabled (
+  UINT8  GuardType
+  )
+{
+  return FALSE;
+}
+
+/**
+  Stand-in for the DXE core service, the heap guard is disabled.
+**/
+BOOLEAN
+IsPoolTypeToGuard (
+  IN EFI_MEMORY_TYPE  MemoryType
+  )
+{
+  return FALSE;
+}
+
+/**
+  Stand-in for the DXE core service, the heap guard is disabled.
+**/
+BOOLEAN
+EFIAPI
+IsMemoryGuarded (
+  IN EFI_PHYSICAL_ADDRESS  Address
+  )
+{
+  return FALSE;
+}
+
+/**
+  Stand-in for the DXE core service, the heap guard is disabled.
+**/
+VOID
+EFIAPI
+GuardFreedPagesChecked (
+  IN  EFI_PHYSICAL_ADDRESS  BaseAddress,
+  IN  UINTN                 Pages
+  )
+{
+}
+
+/**
+  Stand-in for the DXE core service, the heap guard is disabled.
+**/
+VOID
+SetGuardForMemory (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NumberOfPages
+  )
+{
+  ASSERT (FALSE);
+}
+
+/**
+  Stand-in for the DXE core service, the heap guard is disabled.
+**/
+VOID
+UnsetGuardForMemory (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NumberOfPages
+  )
+{
+  ASSERT (FALSE);
+}
+
+/**
+  Stand-in for the DXE core service, the heap guard is disabled.
+**/
+VOID
+AdjustMemoryF (
+  IN OUT EFI_PHYSICAL_ADDRESS  *Memory,
+  IN OUT UINTN                 *NumberOfPages
+  )
+{
+  ASSERT (FALSE);
+}
+
+/**
+  Stand-in for the DXE core service, the heap guard is disabled.
+**/
+VOID *
+AdjustPoolHeadA (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NoPages,
+  IN UINTN                 Size
+  )
+{
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Stand-in for the DXE core service, the heap guard is disabled.
+**/
+VOID *
+AdjustPoolHeadF (
+  IN EFI_PHYSICAL_ADDRESS  Memory,
+  IN UINTN                 NoPages,
+  IN UINTN                 Size
+  )
+{
+  ASSERT (FALSE);
+  return NULL;
+}
+
+/**
+  Return a pseudo-random number.
+
+  @return The next number of the sequence.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mTestSeed = mTestSeed * 1103515245 + 12345;
+  return mTestSeed >> 8;
+}
+
+/**
+  Allocate a test buffer and fill it with a pattern of its slot.
+
+  @param[out] Entry   The test buffer.
+  @param[in]  Slot    The slot of the test buffer.
+  @param[in]  Size    The size of the buffer.
+  @param[in]  Type    The memory type of the buffer.
+
+  @return The status of CoreInternalAllocatePool ().
+**/
+EFI_STATUS
+TestAllocate (
+  OUT TEST_BUFFER      *Entry,
+  IN  UINTN            Slot,
+  IN  UINTN            Size,
+  IN  EFI_MEMORY_TYPE  Type
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = CoreInternalAllocatePool (Type, Size, (VOID **)&Entry->Buffer);
+  if (!EFI_ERROR (Status)) {
+    Entry->Size = Size;
+    Entry->Type = Type;
+    SetMem (Entry->Buffer, Size, (UINT8)Slot);
+  }
+
+  return Status;
+}
+
+/**
+  Check the pattern of a test buffer and free it.
+
+  @param[in, out] Entry   The test buffer.
+  @param[in]      Slot    The slot of the test buffer.
+
+  @retval TRUE   The pattern was intact and the buffer was freed.
+  @retval FALSE  The buffer was overwritten, or it could not be freed.
+**/
+BOOLEAN
+TestFree (
+  IN OUT TEST_BUFFER  *Entry,
+  IN     UINTN        Slot
+  )
+{
+  EFI_MEMORY_TYPE  Type;
+  UINTN            Index;
+
+  for (Index = 0; Index < Entry->Size; Index++) {
+    if (Entry->Buffer[Index] != (UINT8)Slot) {
+      return FALSE;
+    }
+  }
+
+  if (EFI_ERROR (CoreInternalFreePool (Entry->Buffer, &Type)) || (Type != Entry->Type)) {
+    return FALSE;
+  }
+
+  Entry->Buffer = NULL;
+  return TRUE;
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  Random allocations and frees of several memory types must hand out buffers
+  that do not overlap.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+PoolAllocateAndFree (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST EFI_MEMORY_TYPE  Types[] = {
+    EfiBootServicesData, EfiRuntimeServicesData, TEST_OEM_MEMORY_TYPE
+  };
+  UINTN                         Iteration;
+  UINTN                         Slot;
+  UINTN                         Size;
+
+  mTestSeed = 1;
+  ZeroMem (mTestBuffers, sizeof (mTestBuffers));
+  for (Iteration = 0; Iteration < TEST_ITERATIONS; Iteration++) {
+    Slot = TestRandom () % TEST_LIVE_BUFFERS;
+    if (mTestBuffers[Slot].Buffer != NULL) {
+      UT_ASSERT_TRUE (TestFree (&mTestBuffers[Slot], Slot));
+      continue;
+    }
+
+    //
+    // Mostly slab sized requests, some served by the free lists and pages
+    //
+    Size = ((TestRandom () % 8) == 0) ? TestRandom () % 6000 + 1 : TestRandom () % 1000 + 1;
+    UT_ASSERT_NOT_EFI_ERROR (TestAllocate (&mTestBuffers[Slot], Slot, Size, Types[TestRandom () % ARRAY_SIZE (Types)]));
+  }
+
+  for (Slot = 0; Slot < TEST_LIVE_BUFFERS; Slot++) {
+    if (mTestBuffers[Slot].Buffer != NULL) {
+      UT_ASSERT_TRUE (TestFree (&mTestBuffers[Slot], Slot));
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Slots of a size class must be reused, and once they are all freed only one
+  slab of the size class must be kept.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+PoolSlabReuse (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Order[TEST_REUSE_BUFFERS];
+  UINTN  Slot;
+  UINTN  Other;
+  UINTN  Swap;
+  UINTN  Pass;
+  UINTN  Pages;
+
+  if (!FeaturePcdGet (PcdDxeCorePoolSlabAllocator)) {
+    return UNIT_TEST_SKIPPED;
+  }
+
+  //
+  // EfiLoaderData is not used by the other tests
+  //
+  UT_ASSERT_EQUAL (mTestPages[EfiLoaderData], 0);
+  mTestSeed = 2;
+  Pages     = 0;
+  for (Pass = 0; Pass < 4; Pass++) {
+    for (Slot = 0; Slot < TEST_REUSE_BUFFERS; Slot++) {
+      UT_ASSERT_NOT_EFI_ERROR (TestAllocate (&mTestBuffers[Slot], Slot, 40, EfiLoaderData));
+      Order[Slot] = Slot;
+    }
+
+    //
+    // Every pass fills the slab that was kept and then the same number of
+    // new slabs
+    //
+    if (Pass == 0) {
+      Pages = mTestPages[EfiLoaderData];
+      UT_ASSERT_TRUE (Pages > EFI_SIZE_TO_PAGES (DEFAULT_PAGE_ALLOCATION_GRANULARITY));
+    } else {
+      UT_ASSERT_EQUAL (mTestPages[EfiLoaderData], Pages);
+    }
+
+    //
+    // Free the slots in random order, so that full slabs rejoin the size
+    // class list while other slabs are still in use
+    //
+    for (Slot = TEST_REUSE_BUFFERS - 1; Slot > 0; Slot--) {
+      Other        = TestRandom () % (Slot + 1);
+      Swap         = Order[Slot];
+      Order[Slot]  = Order[Other];
+      Order[Other] = Swap;
+    }
+
+    for (Slot = 0; Slot < TEST_REUSE_BUFFERS; Slot++) {
+      UT_ASSERT_TRUE (TestFree (&mTestBuffers[Order[Slot]], Order[Slot]));
+    }
+
+    UT_ASSERT_EQUAL (mTestPages[EfiLoaderData], EFI_SIZE_TO_PAGES (DEFAULT_PAGE_ALLOCATION_GRANULARITY));
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Time a mix of small allocations and frees with a working set of
+  TEST_BENCH_LIVE buffers, and count the page allocations.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+PoolBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VOID        **Buffers;
+  EFI_STATUS  Status;
+  UINTN       Operation;
+  UINTN       Slot;
+  UINTN       PageAllocations;
+  UINTN       Pages;
+  clock_t     Ticks;
+
+  Buffers = AllocateZeroPool (TEST_BENCH_LIVE * sizeof (VOID *));
+  UT_ASSERT_NOT_NULL (Buffers);
+
+  mTestSeed       = 3;
+  Status          = EFI_SUCCESS;
+  PageAllocations = mTestPageAllocations;
+  Pages           = mTestPages[EfiBootServicesData];
+  Ticks           = clock ();
+  for (Operation = 0; Operation < TEST_BENCH_OPERATIONS; Operation++) {
+    Slot = TestRandom () % TEST_BENCH_LIVE;
+    if (Buffers[Slot] != NULL) {
+      Status        = CoreInternalFreePool (Buffers[Slot], NULL);
+      Buffers[Slot] = NULL;
+    } else {
+      Status = CoreInternalAllocatePool (EfiBootServicesData, TestRandom () % 512 + 16, &Buffers[Slot]);
+    }
+
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  Ticks = clock () - Ticks;
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  UT_LOG_INFO (
+    "Slab allocator %a: %d operations in %Lu ms, %Lu page allocations, %Lu pages in use\n",
+    FeaturePcdGet (PcdDxeCorePoolSlabAllocator) ? "on" : "off",
+    TEST_BENCH_OPERATIONS,
+    (UINT64)(Ticks * 1000 / CLOCKS_PER_SEC),
+    (UINT64)(mTestPageAllocations - PageAllocations),
+    (UINT64)(mTestPages[EfiBootServicesData] - Pages)
+    );
+
+  for (Slot = 0; Slot < TEST_BENCH_LIVE; Slot++) {
+    if (Buffers[Slot] != NULL) {
+      UT_ASSERT_NOT_EFI_ERROR (CoreInternalFreePool (Buffers[Slot], NULL));
+    }
+  }
+
+  FreePool (Buffers);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Main entry point to the unit test.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      PoolTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &PoolTests,
+             Framework,
+             "Pool Slab Tests",
+             "DxeCore.PoolSlab",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for PoolTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    PoolTests,
+    "Random allocations and frees should not overlap",
+    "AllocateAndFree",
+    PoolAllocateAndFree,
+    NULL,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    PoolTests,
+    "Slab slots should be reused and one empty slab kept",
+    "SlabReuse",
+    PoolSlabReuse,
+    NULL,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    PoolTests,
+    "Time small allocations and frees",
+    "Benchmark",
+    PoolBenchmark,
+    NULL,
+    NULL,
+    NULL
+    );
+
+  //
+  // Execute the tests.
+  //
+  CoreInitializePool ();
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
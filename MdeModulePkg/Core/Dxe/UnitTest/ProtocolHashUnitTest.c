@@ -0,0 +1,620 @@
+/** @file
+  This is a host-based unit test and microbenchmark for the protocol GUID hash
+  index of the DXE core protocol database in Handle.c.
+
+  Protocol entries are created through CoreFindProtocolEntry () and protocols
+  are installed, looked up and uninstalled through the Boot Services of
+  Handle.c. Every entry of mProtocolDatabase must be found in exactly one
+  bucket of mProtocolHashTable, and a lookup must compare far fewer GUIDs than
+  the walk over mProtocolDatabase that the DXE core used before.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include "../DxeMain.h"
+#include "../Hand/Handle.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "DXE Core Protocol Hash Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_PROTOCOL_COUNT   1000
+#define TEST_HANDLE_COUNT     64
+#define TEST_HANDLE_PROTOCOLS 16
+#define TEST_BENCH_LOOKUPS    200000
+
+extern LIST_ENTRY  mProtocolDatabase;
+extern LIST_ENTRY  mProtocolHashTable[PROTOCOL_ENTRY_HASH_SIZE];
+
+EFI_HANDLE  gDxeCoreImageHandle;
+UINT32      mTestSeed;
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Stand-in for the DXE core service.
+
+  @param[in]  Lock   The lock to acquire.
+**/
+VOID
+CoreAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->Lock = EfiLockAcquired;
+}
+
+/**
+  Stand-in for the DXE core service.
+
+  @param[in]  Lock   The lock to release.
+**/
+VOID
+CoreReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+}
+
+/**
+  Stand-in for the DXE core service.
+
+  @param[in]  NewTpl   The new task priority level.
+
+  @return TPL_APPLICATION.
+**/
+EFI_TPL
+EFIAPI
+CoreRaiseTpl (
+  IN EFI_TPL  NewTpl
+  )
+{
+  return TPL_APPLICATION;
+}
+
+/**
+  Stand-in for the DXE core service.
+
+  @param[in]  NewTpl   The task priority level to restore.
+**/
+VOID
+EFIAPI
+CoreRestoreTpl (
+  IN EFI_TPL  NewTpl
+  )
+{
+}
+
+/**
+  Stand-in for the DXE core service, no notification is registered.
+
+  @param[in]  UserEvent   The event to signal.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+CoreSignalEvent (
+  IN EFI_EVENT  UserEvent
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the DXE core service, no driver is connected.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+CoreConnectController (
+  IN  EFI_HANDLE                ControllerHandle,
+  IN  EFI_HANDLE                *DriverImageHandle    OPTIONAL,
+  IN  EFI_DEVICE_PATH_PROTOCOL  *RemainingDevicePath  OPTIONAL,
+  IN  BOOLEAN                   Recursive
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the DXE core service, no driver is connected.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+CoreDisconnectController (
+  IN  EFI_HANDLE  ControllerHandle,
+  IN  EFI_HANDLE  DriverImageHandle  OPTIONAL,
+  IN  EFI_HANDLE  ChildHandle        OPTIONAL
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the DXE core service.
+
+  @param[in]  Buffer   The pool buffer to free.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+CoreFreePool (
+  IN VOID  *Buffer
+  )
+{
+  FreePool (Buffer);
+  return EFI_SUCCESS;
+}
+
+/**
+  Return a pseudo-random number.
+
+  @return The next number of the sequence.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mTestSeed = mTestSeed * 1103515245 + 12345;
+  return mTestSeed >> 8;
+}
+
+/**
+  Fill a GUID with pseudo-random bytes.
+
+  @param[out] Guid    Receives the GUID.
+**/
+VOID
+TestRandomGuid (
+  OUT EFI_GUID  *Guid
+  )
+{
+  UINT8  *Bytes;
+  UINTN  Index;
+
+  Bytes = (UINT8 *)Guid;
+  for (Index = 0; Index < sizeof (EFI_GUID); Index++) {
+    Bytes[Index] = (UINT8)TestRandom ();
+  }
+}
+
+/**
+  Look up a protocol entry with the protocol database lock held.
+
+  @param[in]  Protocol  The ID of the protocol.
+  @param[in]  Create    Create a new entry if one is not found.
+
+  @return The protocol entry, or NULL.
+**/
+PROTOCOL_ENTRY *
+TestFindProtocolEntry (
+  IN EFI_GUID  *Protocol,
+  IN BOOLEAN   Create
+  )
+{
+  PROTOCOL_ENTRY  *ProtEntry;
+
+  CoreAcquireProtocolLock ();
+  ProtEntry = CoreFindProtocolEntry (Protocol, Create);
+  CoreReleaseProtocolLock ();
+  return ProtEntry;
+}
+
+/**
+  Find a protocol entry by walking mProtocolDatabase, the way the DXE core
+  looked protocols up before the hash index.
+
+  @param[in]      Protocol      The ID of the protocol.
+  @param[in, out] Comparisons   Incremented for every GUID comparison.
+
+  @return The protocol entry, or NULL.
+**/
+PROTOCOL_ENTRY *
+TestWalkProtocolDatabase (
+  IN     EFI_GUID  *Protocol,
+  IN OUT UINTN     *Comparisons
+  )
+{
+  LIST_ENTRY      *Link;
+  PROTOCOL_ENTRY  *Item;
+
+  for (Link = mProtocolDatabase.ForwardLink; Link != &mProtocolDatabase; Link = Link->ForwardLink) {
+    Item          = CR (Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE);
+    *Comparisons += 1;
+    if (CompareGuid (&Item->ProtocolID, Protocol)) {
+      return Item;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Count the entries of a list.
+
+  @param[in]  ListHead  The list.
+
+  @return The number of entries.
+**/
+UINTN
+TestListLength (
+  IN LIST_ENTRY  *ListHead
+  )
+{
+  LIST_ENTRY  *Link;
+  UINTN       Count;
+
+  Count = 0;
+  for (Link = ListHead->ForwardLink; Link != ListHead; Link = Link->ForwardLink) {
+    Count++;
+  }
+
+  return Count;
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  Entries created by CoreFindProtocolEntry () must be found again, unknown
+  GUIDs must not be added, and every entry of mProtocolDatabase must be in
+  exactly one hash bucket.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ProtocolHashFindEntries (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GUID        Guids[TEST_PROTOCOL_COUNT];
+  PROTOCOL_ENTRY  *Entries[TEST_PROTOCOL_COUNT];
+  PROTOCOL_ENTRY  *ProtEntry;
+  EFI_GUID        Guid;
+  LIST_ENTRY      *Link;
+  UINTN           DatabaseCount;
+  UINTN           HashCount;
+  UINTN           Index;
+
+  mTestSeed     = 1;
+  DatabaseCount = TestListLength (&mProtocolDatabase);
+  for (Index = 0; Index < TEST_PROTOCOL_COUNT; Index++) {
+    TestRandomGuid (&Guids[Index]);
+    Entries[Index] = TestFindProtocolEntry (&Guids[Index], TRUE);
+    UT_ASSERT_NOT_NULL (Entries[Index]);
+    UT_ASSERT_TRUE (CompareGuid (&Entries[Index]->ProtocolID, &Guids[Index]));
+  }
+
+  UT_ASSERT_EQUAL (TestListLength (&mProtocolDatabase), DatabaseCount + TEST_PROTOCOL_COUNT);
+
+  for (Index = 0; Index < TEST_PROTOCOL_COUNT; Index++) {
+    UT_ASSERT_EQUAL ((UINTN)TestFindProtocolEntry (&Guids[Index], FALSE), (UINTN)Entries[Index]);
+    UT_ASSERT_EQUAL ((UINTN)TestFindProtocolEntry (&Guids[Index], TRUE), (UINTN)Entries[Index]);
+  }
+
+  for (Index = 0; Index < TEST_PROTOCOL_COUNT; Index++) {
+    TestRandomGuid (&Guid);
+    UT_ASSERT_TRUE (TestFindProtocolEntry (&Guid, FALSE) == NULL);
+  }
+
+  UT_ASSERT_EQUAL (TestListLength (&mProtocolDatabase), DatabaseCount + TEST_PROTOCOL_COUNT);
+
+  //
+  // Every entry is in the bucket of its GUID, so the buckets hold exactly
+  // the entries of mProtocolDatabase.
+  //
+  HashCount = 0;
+  for (Index = 0; Index < PROTOCOL_ENTRY_HASH_SIZE; Index++) {
+    for (Link = mProtocolHashTable[Index].ForwardLink; Link != &mProtocolHashTable[Index]; Link = Link->ForwardLink) {
+      ProtEntry = CR (Link, PROTOCOL_ENTRY, HashLink, PROTOCOL_ENTRY_SIGNATURE);
+      UT_ASSERT_EQUAL ((UINTN)TestFindProtocolEntry (&ProtEntry->ProtocolID, FALSE), (UINTN)ProtEntry);
+      HashCount++;
+    }
+  }
+
+  UT_ASSERT_EQUAL (HashCount, TestListLength (&mProtocolDatabase));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Protocols installed on handles must be found through HandleProtocol () until
+  they are uninstalled.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ProtocolHashInstallUninstall (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GUID    Guids[TEST_HANDLE_PROTOCOLS];
+  EFI_HANDLE  Handles[TEST_HANDLE_COUNT];
+  VOID        *Interface;
+  UINTN       Handle;
+  UINTN       Index;
+
+  mTestSeed = 2;
+  for (Index = 0; Index < TEST_HANDLE_PROTOCOLS; Index++) {
+    TestRandomGuid (&Guids[Index]);
+  }
+
+  for (Handle = 0; Handle < TEST_HANDLE_COUNT; Handle++) {
+    Handles[Handle] = NULL;
+    for (Index = 0; Index < TEST_HANDLE_PROTOCOLS; Index++) {
+      UT_ASSERT_NOT_EFI_ERROR (
+        CoreInstallProtocolInterface (
+          &Handles[Handle],
+          &Guids[Index],
+          EFI_NATIVE_INTERFACE,
+          (VOID *)(Handle * TEST_HANDLE_PROTOCOLS + Index + 1)
+          )
+        );
+    }
+  }
+
+  //
+  // Uninstall the protocols with an odd index
+  //
+  for (Handle = 0; Handle < TEST_HANDLE_COUNT; Handle++) {
+    for (Index = 1; Index < TEST_HANDLE_PROTOCOLS; Index += 2) {
+      UT_ASSERT_NOT_EFI_ERROR (
+        CoreUninstallProtocolInterface (
+          Handles[Handle],
+          &Guids[Index],
+          (VOID *)(Handle * TEST_HANDLE_PROTOCOLS + Index + 1)
+          )
+        );
+    }
+  }
+
+  for (Handle = 0; Handle < TEST_HANDLE_COUNT; Handle++) {
+    for (Index = 0; Index < TEST_HANDLE_PROTOCOLS; Index++) {
+      Interface = NULL;
+      if ((Index % 2) == 0) {
+        UT_ASSERT_NOT_EFI_ERROR (CoreHandleProtocol (Handles[Handle], &Guids[Index], &Interface));
+        UT_ASSERT_EQUAL ((UINTN)Interface, Handle * TEST_HANDLE_PROTOCOLS + Index + 1);
+      } else {
+        UT_ASSERT_STATUS_EQUAL (CoreHandleProtocol (Handles[Handle], &Guids[Index], &Interface), EFI_UNSUPPORTED);
+      }
+    }
+  }
+
+  for (Handle = 0; Handle < TEST_HANDLE_COUNT; Handle++) {
+    for (Index = 0; Index < TEST_HANDLE_PROTOCOLS; Index += 2) {
+      UT_ASSERT_NOT_EFI_ERROR (
+        CoreUninstallProtocolInterface (
+          Handles[Handle],
+          &Guids[Index],
+          (VOID *)(Handle * TEST_HANDLE_PROTOCOLS + Index + 1)
+          )
+        );
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Count the GUID comparisons and time the lookups of all protocols in the
+  database, through the hash index and through the walk of mProtocolDatabase.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ProtocolHashLookupCost (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GUID        *Guids;
+  LIST_ENTRY      *Link;
+  PROTOCOL_ENTRY  *ProtEntry;
+  UINTN           Count;
+  UINTN           Index;
+  UINTN           Position;
+  UINTN           WalkComparisons;
+  UINTN           HashComparisons;
+  clock_t         Ticks[2];
+
+  Count = TestListLength (&mProtocolDatabase);
+  UT_ASSERT_TRUE (Count >= TEST_PROTOCOL_COUNT);
+  Guids = AllocatePool (Count * sizeof (EFI_GUID));
+  UT_ASSERT_NOT_NULL (Guids);
+
+  Index = 0;
+  for (Link = mProtocolDatabase.ForwardLink; Link != &mProtocolDatabase; Link = Link->ForwardLink) {
+    ProtEntry = CR (Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE);
+    CopyGuid (&Guids[Index++], &ProtEntry->ProtocolID);
+  }
+
+  //
+  // A lookup through the index compares the GUIDs of its bucket up to the
+  // entry it finds.
+  //
+  HashComparisons = 0;
+  for (Index = 0; Index < PROTOCOL_ENTRY_HASH_SIZE; Index++) {
+    Position = 0;
+    for (Link = mProtocolHashTable[Index].ForwardLink; Link != &mProtocolHashTable[Index]; Link = Link->ForwardLink) {
+      HashComparisons += ++Position;
+    }
+  }
+
+  WalkComparisons = 0;
+  for (Index = 0; Index < Count; Index++) {
+    UT_ASSERT_NOT_NULL (TestWalkProtocolDatabase (&Guids[Index], &WalkComparisons));
+  }
+
+  Ticks[0] = clock ();
+  for (Index = 0; Index < TEST_BENCH_LOOKUPS; Index++) {
+    UT_ASSERT_NOT_NULL (TestWalkProtocolDatabase (&Guids[(Index * 7) % Count], &Position));
+  }
+
+  Ticks[0] = clock () - Ticks[0];
+
+  CoreAcquireProtocolLock ();
+  Ticks[1] = clock ();
+  for (Index = 0; Index < TEST_BENCH_LOOKUPS; Index++) {
+    if (CoreFindProtocolEntry (&Guids[(Index * 7) % Count], FALSE) == NULL) {
+      break;
+    }
+  }
+
+  Ticks[1] = clock () - Ticks[1];
+  CoreReleaseProtocolLock ();
+  UT_ASSERT_EQUAL (Index, TEST_BENCH_LOOKUPS);
+
+  UT_LOG_INFO (
+    "%Lu protocols: database walk %Lu GUID comparisons, hash index %Lu\n",
+    (UINT64)Count,
+    (UINT64)WalkComparisons,
+    (UINT64)HashComparisons
+    );
+  UT_LOG_INFO (
+    "%d lookups: database walk %Lu ms, hash index %Lu ms\n",
+    TEST_BENCH_LOOKUPS,
+    (UINT64)(Ticks[0] * 1000 / CLOCKS_PER_SEC),
+    (UINT64)(Ticks[1] * 1000 / CLOCKS_PER_SEC)
+    );
+
+  //
+  // With random GUIDs the buckets hold about Count / PROTOCOL_ENTRY_HASH_SIZE
+  // entries each, so a lookup compares a few GUIDs instead of half of the
+  // database.
+  //
+  UT_ASSERT_TRUE (HashComparisons <= Count * (Count / PROTOCOL_ENTRY_HASH_SIZE + 2));
+  UT_ASSERT_TRUE (HashComparisons * 10 < WalkComparisons);
+
+  FreePool (Guids);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Main entry point to the unit test.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ProtocolHashTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &ProtocolHashTests,
+             Framework,
+             "Protocol Hash Tests",
+             "DxeCore.ProtocolHash",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for ProtocolHashTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    ProtocolHashTests,
+    "Created protocol entries should be found in their hash bucket",
+    "FindEntries",
+    ProtocolHashFindEntries,
+    NULL,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    ProtocolHashTests,
+    "Installed protocols should be found until they are uninstalled",
+    "InstallUninstall",
+    ProtocolHashInstallUninstall,
+    NULL,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    ProtocolHashTests,
+    "Lookups should take far fewer GUID comparisons than the database walk",
+    "LookupCost",
+    ProtocolHashLookupCost,
+    NULL,
+    NULL,
+    NULL
+    );
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
@@ -0,0 +1,740 @@
+/** @file
+  This is a host-based unit test and microbenchmark for the pairing heap that
+  holds the timer database of the DXE core in Timer.c.
+
+  Timers are armed and cancelled through CoreSetTimer (), and expire through
+  CoreTimerTick () and CoreCheckTimers (). The order in which the timers are
+  signaled is checked against a brute-force model of the timer database. The
+  benchmark runs the same sequence of operations on the heap and on the sorted
+  list that the DXE core used before.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include "../DxeMain.h"
+#include "../Event/Event.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "DXE Core Timer Heap Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_TIMER_COUNT      10000
+#define TEST_RANDOM_TIMERS    2000
+#define TEST_RANDOM_STEPS     50000
+#define TEST_SAME_TIME        100
+#define TEST_BENCH_OPERATIONS 20000
+#define TEST_TIMER_PERIOD     100000
+
+typedef struct {
+  LIST_ENTRY    Link;
+  UINT64        TriggerTime;
+} TEST_LIST_TIMER;
+
+extern TIMER_EVENT_INFO  *mEfiTimerHeap;
+extern UINT64            mEfiSystemTime;
+extern EFI_EVENT         mEfiCheckTimerEvent;
+
+VOID
+EFIAPI
+CoreCheckTimers (
+  IN EFI_EVENT  CheckEvent,
+  IN VOID       *Context
+  );
+
+EFI_TIMER_ARCH_PROTOCOL  *gTimer;
+IEVENT                   mTestCheckEvent;
+IEVENT                   *mTestEvents;
+UINT64                   *mTestArmOrder;
+UINT64                   mTestArmCount;
+IEVENT                   **mTestSignaled;
+UINTN                    mTestSignalCount;
+UINTN                    mTestCheckSignals;
+UINT32                   mTestSeed;
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Stand-in for the DXE core service.
+
+  @param[in]  Lock   The lock to acquire.
+**/
+VOID
+CoreAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->Lock = EfiLockAcquired;
+}
+
+/**
+  Stand-in for the DXE core service.
+
+  @param[in]  Lock   The lock to release.
+**/
+VOID
+CoreReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+}
+
+/**
+  Stand-in for the DXE core service, returns the timer check event.
+
+  @param[out] Event   Receives the event.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+CoreCreateEventInternal (
+  IN UINT32            Type,
+  IN EFI_TPL           NotifyTpl,
+  IN EFI_EVENT_NOTIFY  NotifyFunction  OPTIONAL,
+  IN CONST VOID        *NotifyContext  OPTIONAL,
+  IN CONST EFI_GUID    *EventGroup     OPTIONAL,
+  OUT EFI_EVENT        *Event
+  )
+{
+  mTestCheckEvent.Signature = EVENT_SIGNATURE;
+  mTestCheckEvent.Type      = Type;
+  *Event                    = &mTestCheckEvent;
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the DXE core service, records the signaled timer events.
+
+  @param[in]  UserEvent   The event to signal.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+CoreSignalEvent (
+  IN EFI_EVENT  UserEvent
+  )
+{
+  if (UserEvent == mEfiCheckTimerEvent) {
+    mTestCheckSignals++;
+  } else {
+    ASSERT (mTestSignalCount < TEST_TIMER_COUNT);
+    mTestSignaled[mTestSignalCount++] = UserEvent;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the timer architectural protocol service.
+
+  @param[in]  This          The protocol instance.
+  @param[out] TimerPeriod   Receives the timer period.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+TestGetTimerPeriod (
+  IN  EFI_TIMER_ARCH_PROTOCOL  *This,
+  OUT UINT64                   *TimerPeriod
+  )
+{
+  *TimerPeriod = TEST_TIMER_PERIOD;
+  return EFI_SUCCESS;
+}
+
+EFI_TIMER_ARCH_PROTOCOL  mTestTimer = {
+  NULL,
+  NULL,
+  TestGetTimerPeriod,
+  NULL
+};
+
+/**
+  Return a pseudo-random number.
+
+  @return The next number of the sequence.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mTestSeed = mTestSeed * 1103515245 + 12345;
+  return mTestSeed >> 8;
+}
+
+/**
+  Prepare the timer events and cancel any timer left by another test.
+
+  @param[in]  Context  Unit test case context
+
+  @retval UNIT_TEST_PASSED  The timer database is empty.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestResetTimers (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < TEST_TIMER_COUNT; Index++) {
+    if (mTestEvents[Index].Signature == EVENT_SIGNATURE) {
+      CoreSetTimer (&mTestEvents[Index], TimerCancel, 0);
+    }
+
+    mTestEvents[Index].Signature = EVENT_SIGNATURE;
+    mTestEvents[Index].Type      = EVT_TIMER | EVT_NOTIFY_SIGNAL;
+    mTestArmOrder[Index]         = 0;
+  }
+
+  mTestSignalCount  = 0;
+  mTestCheckSignals = 0;
+  UT_ASSERT_TRUE (mEfiTimerHeap == NULL);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Arm a one-shot timer and record the order in which it was armed.
+
+  @param[in]  Index     The index of the timer event.
+  @param[in]  Delay     The number of 100ns units until the timer expires.
+
+  @return The status of CoreSetTimer ().
+**/
+EFI_STATUS
+TestArmTimer (
+  IN UINTN   Index,
+  IN UINT64  Delay
+  )
+{
+  mTestArmOrder[Index] = ++mTestArmCount;
+  return CoreSetTimer (&mTestEvents[Index], TimerRelative, Delay);
+}
+
+/**
+  Advance the system time and run the timer check, the way the timer
+  interrupt and the check event of the DXE core do.
+
+  @param[in]  Duration  The number of 100ns units to advance.
+**/
+VOID
+TestTick (
+  IN UINT64  Duration
+  )
+{
+  mTestSignalCount  = 0;
+  mTestCheckSignals = 0;
+  CoreTimerTick (Duration);
+  CoreCheckTimers (mEfiCheckTimerEvent, NULL);
+}
+
+/**
+  Compare two armed timers of the model in expiry order.
+
+  @param[in]  Left   Index of the first timer.
+  @param[in]  Right  Index of the second timer.
+
+  @retval TRUE   The first timer expires before the second one.
+  @retval FALSE  The second timer expires before the first one.
+**/
+BOOLEAN
+TestExpiresBefore (
+  IN UINTN  Left,
+  IN UINTN  Right
+  )
+{
+  if (mTestEvents[Left].Timer.TriggerTime != mTestEvents[Right].Timer.TriggerTime) {
+    return (BOOLEAN)(mTestEvents[Left].Timer.TriggerTime < mTestEvents[Right].Timer.TriggerTime);
+  }
+
+  return (BOOLEAN)(mTestArmOrder[Left] < mTestArmOrder[Right]);
+}
+
+/**
+  Find the armed one-shot timers that expired at the current system time,
+  and sort them in expiry order.
+
+  @param[in]  Count     The number of timer events in use.
+  @param[out] Expired   Receives the indices of the expired timers.
+
+  @return The number of expired timers.
+**/
+UINTN
+TestModelExpired (
+  IN  UINTN  Count,
+  OUT UINTN  *Expired
+  )
+{
+  UINTN  Index;
+  UINTN  Found;
+  UINTN  Position;
+
+  Found = 0;
+  for (Index = 0; Index < Count; Index++) {
+    if ((mTestArmOrder[Index] == 0) || (mTestEvents[Index].Timer.TriggerTime > mEfiSystemTime)) {
+      continue;
+    }
+
+    //
+    // Insertion sort, the number of timers that expire in one tick is small
+    //
+    for (Position = Found; Position > 0 && TestExpiresBefore (Index, Expired[Position - 1]); Position--) {
+      Expired[Position] = Expired[Position - 1];
+    }
+
+    Expired[Position] = Index;
+    Found++;
+  }
+
+  return Found;
+}
+
+/**
+  Insert a timer into a sorted list, the way the DXE core armed timers
+  before the pairing heap.
+
+  @param[in]  ListHead  The sorted timer list.
+  @param[in]  Timer     The timer to insert.
+**/
+VOID
+TestListInsert (
+  IN LIST_ENTRY       *ListHead,
+  IN TEST_LIST_TIMER  *Timer
+  )
+{
+  LIST_ENTRY  *Link;
+
+  for (Link = ListHead->ForwardLink; Link != ListHead; Link = Link->ForwardLink) {
+    if (BASE_CR (Link, TEST_LIST_TIMER, Link)->TriggerTime > Timer->TriggerTime) {
+      break;
+    }
+  }
+
+  InsertTailList (Link, &Timer->Link);
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  Random sequences of arming, re-arming, cancelling and ticks must signal
+  exactly the expired timers, in the order of their trigger time and then
+  of arming.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TimerHeapRandomOrder (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  *Expired;
+  UINTN  Found;
+  UINTN  Step;
+  UINTN  Index;
+  UINTN  Armed;
+
+  Expired = AllocatePool (TEST_RANDOM_TIMERS * sizeof (UINTN));
+  UT_ASSERT_NOT_NULL (Expired);
+
+  mTestSeed = 1;
+  for (Step = 0; Step < TEST_RANDOM_STEPS; Step++) {
+    Index = TestRandom () % TEST_RANDOM_TIMERS;
+    switch (TestRandom () % 8) {
+      case 0:
+        UT_ASSERT_NOT_EFI_ERROR (CoreSetTimer (&mTestEvents[Index], TimerCancel, 0));
+        mTestArmOrder[Index] = 0;
+        break;
+
+      case 1:
+        //
+        // Advance the system time and compare the expired timers
+        //
+        TestTick (1 + TestRandom () % 200);
+        Found = TestModelExpired (TEST_RANDOM_TIMERS, Expired);
+        UT_ASSERT_EQUAL (mTestSignalCount, Found);
+        for (Index = 0; Index < Found; Index++) {
+          UT_ASSERT_EQUAL ((UINTN)mTestSignaled[Index], (UINTN)&mTestEvents[Expired[Index]]);
+          UT_ASSERT_FALSE (mTestEvents[Expired[Index]].Timer.Queued);
+          mTestArmOrder[Expired[Index]] = 0;
+        }
+
+        break;
+
+      default:
+        //
+        // Few distinct delays, so many timers share a trigger time
+        //
+        UT_ASSERT_NOT_EFI_ERROR (TestArmTimer (Index, 1 + TestRandom () % 64 * 16));
+        break;
+    }
+  }
+
+  Armed = 0;
+  for (Index = 0; Index < TEST_RANDOM_TIMERS; Index++) {
+    UT_ASSERT_EQUAL (mTestEvents[Index].Timer.Queued, (BOOLEAN)(mTestArmOrder[Index] != 0));
+    if (mTestEvents[Index].Timer.Queued) {
+      Armed++;
+    }
+  }
+
+  UT_ASSERT_TRUE (Armed > 0);
+  FreePool (Expired);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Timers with the same trigger time must expire in the order they were
+  armed, and a re-armed timer must move behind the others.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TimerHeapSameTime (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Order[TEST_SAME_TIME];
+  UINTN  Index;
+  UINTN  Other;
+  UINTN  Swap;
+
+  mTestSeed = 2;
+  for (Index = 0; Index < TEST_SAME_TIME; Index++) {
+    Order[Index] = Index;
+  }
+
+  for (Index = TEST_SAME_TIME - 1; Index > 0; Index--) {
+    Other        = TestRandom () % (Index + 1);
+    Swap         = Order[Index];
+    Order[Index] = Order[Other];
+    Order[Other] = Swap;
+  }
+
+  for (Index = 0; Index < TEST_SAME_TIME; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (TestArmTimer (Order[Index], 1000));
+  }
+
+  //
+  // Re-arm the first timer for the same trigger time
+  //
+  UT_ASSERT_NOT_EFI_ERROR (TestArmTimer (Order[0], 1000));
+
+  TestTick (999);
+  UT_ASSERT_EQUAL (mTestSignalCount, 0);
+  TestTick (1);
+  UT_ASSERT_EQUAL (mTestSignalCount, TEST_SAME_TIME);
+  for (Index = 1; Index < TEST_SAME_TIME; Index++) {
+    UT_ASSERT_EQUAL ((UINTN)mTestSignaled[Index - 1], (UINTN)&mTestEvents[Order[Index]]);
+  }
+
+  UT_ASSERT_EQUAL ((UINTN)mTestSignaled[TEST_SAME_TIME - 1], (UINTN)&mTestEvents[Order[0]]);
+  UT_ASSERT_TRUE (mEfiTimerHeap == NULL);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Periodic timers must be re-armed after they expire, and a periodic timer
+  that fell behind must restart from the current time.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TimerHeapPeriodic (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Signals[3];
+  UINTN  Tick;
+  UINTN  Index;
+
+  UT_ASSERT_NOT_EFI_ERROR (CoreSetTimer (&mTestEvents[0], TimerPeriodic, 10));
+  UT_ASSERT_NOT_EFI_ERROR (CoreSetTimer (&mTestEvents[1], TimerPeriodic, 25));
+  UT_ASSERT_NOT_EFI_ERROR (CoreSetTimer (&mTestEvents[2], TimerPeriodic, 0));
+  UT_ASSERT_EQUAL (mTestEvents[2].Timer.Period, TEST_TIMER_PERIOD);
+
+  ZeroMem (Signals, sizeof (Signals));
+  for (Tick = 0; Tick < 100; Tick++) {
+    TestTick (10);
+    for (Index = 0; Index < mTestSignalCount; Index++) {
+      Signals[mTestSignaled[Index] - mTestEvents]++;
+    }
+  }
+
+  UT_ASSERT_EQUAL (Signals[0], 100);
+  UT_ASSERT_EQUAL (Signals[1], 40);
+  UT_ASSERT_EQUAL (Signals[2], 0);
+
+  //
+  // After a tick far beyond the periods, each timer restarts from the current
+  // time and signals the check event again, so it is signaled once more in
+  // the same check, and then waits for a full period
+  //
+  TestTick (2 * TEST_TIMER_PERIOD);
+  UT_ASSERT_EQUAL (mTestSignalCount, 6);
+  UT_ASSERT_EQUAL (mTestCheckSignals, 1 + 3);
+  for (Index = 0; Index < 3; Index++) {
+    UT_ASSERT_EQUAL ((UINTN)mTestSignaled[Index], (UINTN)mTestSignaled[Index + 3]);
+    UT_ASSERT_TRUE (mTestEvents[Index].Timer.Queued);
+    UT_ASSERT_EQUAL (mTestEvents[Index].Timer.TriggerTime, mEfiSystemTime + mTestEvents[Index].Timer.Period);
+  }
+
+  for (Index = 0; Index < 3; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (CoreSetTimer (&mTestEvents[Index], TimerCancel, 0));
+  }
+
+  UT_ASSERT_TRUE (mEfiTimerHeap == NULL);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Time re-arming timers at random with TEST_TIMER_COUNT timers armed, with
+  the pairing heap and with the sorted list that the DXE core used before.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TimerHeapBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_LIST_TIMER  *ListTimers;
+  LIST_ENTRY       ListHead;
+  LIST_ENTRY       *Link;
+  UINT64           ListTime;
+  UINTN            ListSignals;
+  UINTN            HeapSignals;
+  UINTN            Operation;
+  UINTN            Index;
+  UINT64           Delay;
+  clock_t          Ticks[2];
+
+  ListTimers = AllocatePool (TEST_TIMER_COUNT * sizeof (TEST_LIST_TIMER));
+  UT_ASSERT_NOT_NULL (ListTimers);
+
+  //
+  // Every timer is armed for up to 10 seconds, and every 100 operations a
+  // 1 ms tick expires the timers that are due
+  //
+  mTestSeed = 3;
+  for (Index = 0; Index < TEST_TIMER_COUNT; Index++) {
+    UT_ASSERT_NOT_EFI_ERROR (TestArmTimer (Index, 1 + TestRandom () % 100000000));
+  }
+
+  HeapSignals = 0;
+  Ticks[0]    = clock ();
+  for (Operation = 0; Operation < TEST_BENCH_OPERATIONS; Operation++) {
+    Index = TestRandom () % TEST_TIMER_COUNT;
+    Delay = 1 + TestRandom () % 100000000;
+    CoreSetTimer (&mTestEvents[Index], TimerRelative, Delay);
+    if ((Operation % 100) == 99) {
+      TestTick (10000);
+      HeapSignals += mTestSignalCount;
+    }
+  }
+
+  Ticks[0] = clock () - Ticks[0];
+
+  mTestSeed = 3;
+  ListTime  = 0;
+  InitializeListHead (&ListHead);
+  for (Index = 0; Index < TEST_TIMER_COUNT; Index++) {
+    ListTimers[Index].TriggerTime = ListTime + 1 + TestRandom () % 100000000;
+    TestListInsert (&ListHead, &ListTimers[Index]);
+  }
+
+  ListSignals = 0;
+  Ticks[1]    = clock ();
+  for (Operation = 0; Operation < TEST_BENCH_OPERATIONS; Operation++) {
+    Index = TestRandom () % TEST_TIMER_COUNT;
+    Delay = 1 + TestRandom () % 100000000;
+    if (ListTimers[Index].Link.ForwardLink != NULL) {
+      RemoveEntryList (&ListTimers[Index].Link);
+    }
+
+    ListTimers[Index].TriggerTime = ListTime + Delay;
+    TestListInsert (&ListHead, &ListTimers[Index]);
+    if ((Operation % 100) == 99) {
+      ListTime += 10000;
+      while (!IsListEmpty (&ListHead)) {
+        Link = GetFirstNode (&ListHead);
+        if (BASE_CR (Link, TEST_LIST_TIMER, Link)->TriggerTime > ListTime) {
+          break;
+        }
+
+        RemoveEntryList (Link);
+        Link->ForwardLink = NULL;
+        ListSignals++;
+      }
+    }
+  }
+
+  Ticks[1] = clock () - Ticks[1];
+
+  UT_LOG_INFO (
+    "%d timers, %d re-arms, %Lu expired: sorted list %Lu ms, pairing heap %Lu ms\n",
+    TEST_TIMER_COUNT,
+    TEST_BENCH_OPERATIONS,
+    (UINT64)HeapSignals,
+    (UINT64)(Ticks[1] * 1000 / CLOCKS_PER_SEC),
+    (UINT64)(Ticks[0] * 1000 / CLOCKS_PER_SEC)
+    );
+
+  //
+  // Both databases ran the same operations, so the same timers expired
+  //
+  UT_ASSERT_EQUAL (HeapSignals, ListSignals);
+
+  FreePool (ListTimers);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Main entry point to the unit test.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      TimerHeapTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &TimerHeapTests,
+             Framework,
+             "Timer Heap Tests",
+             "DxeCore.TimerHeap",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for TimerHeapTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    TimerHeapTests,
+    "Expired timers should be signaled in trigger time and arming order",
+    "RandomOrder",
+    TimerHeapRandomOrder,
+    TestResetTimers,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    TimerHeapTests,
+    "Timers with the same trigger time should expire in arming order",
+    "SameTime",
+    TimerHeapSameTime,
+    TestResetTimers,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    TimerHeapTests,
+    "Periodic timers should be re-armed after they expire",
+    "Periodic",
+    TimerHeapPeriodic,
+    TestResetTimers,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    TimerHeapTests,
+    "Re-arming timers should be timed against the sorted list",
+    "Benchmark",
+    TimerHeapBenchmark,
+    TestResetTimers,
+    NULL,
+    NULL
+    );
+
+  mTestEvents   = AllocateZeroPool (TEST_TIMER_COUNT * sizeof (IEVENT));
+  mTestArmOrder = AllocateZeroPool (TEST_TIMER_COUNT * sizeof (UINT64));
+  mTestSignaled = AllocateZeroPool (TEST_TIMER_COUNT * sizeof (IEVENT *));
+  if ((mTestEvents == NULL) || (mTestArmOrder == NULL) || (mTestSignaled == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  gTimer = &mTestTimer;
+  CoreInitializeTimer ();
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
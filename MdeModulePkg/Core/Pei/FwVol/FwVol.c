@@ -243,6 +243,103 @@ FileHandleToVolume (
   return NULL;
 }
 
+/**
+  Search the file index of a firmware volume with the semantics of FindFileEx ().
+
+  @param FwVolHeader     Pointer to the FV header of the volume to search
+  @param FileIndex       The file index of the volume
+  @param FileName        File name
+  @param SearchType      Filter to find only files of this type.
+                         Type EFI_FV_FILETYPE_ALL causes no filtering to be done.
+  @param FileHeader      This parameter must point to a valid FFS volume.
+  @param AprioriFile     Pointer to AprioriFile image in this FV if has
+
+  @return EFI_NOT_FOUND  No files matching the search criteria were found
+  @retval EFI_SUCCESS    Success to search given file
+
+**/
+STATIC
+EFI_STATUS
+FindFileInIndex (
+  IN        EFI_FIRMWARE_VOLUME_HEADER  *FwVolHeader,
+  IN        FV_FILE_INDEX               *FileIndex,
+  IN  CONST EFI_GUID                    *FileName    OPTIONAL,
+  IN        EFI_FV_FILETYPE             SearchType,
+  IN OUT    EFI_FFS_FILE_HEADER         **FileHeader,
+  IN OUT    EFI_PEI_FILE_HANDLE         *AprioriFile  OPTIONAL
+  )
+{
+  FV_FILE_INDEX_ENTRY  *Entry;
+  UINT32               *HashHead;
+  UINT32               Index;
+  UINT32               Low;
+  UINT32               High;
+  UINTN                CurrentOffset;
+  EFI_FFS_FILE_HEADER  *FfsFileHeader;
+
+  Entry    = FV_FILE_INDEX_ENTRIES (FileIndex);
+  HashHead = FV_FILE_INDEX_HASH_HEADS (FileIndex);
+
+  if (FileName != NULL) {
+    for (Index = HashHead[FV_FILE_INDEX_HASH (FileName, FileIndex->HashSize)];
+         Index != FV_FILE_INDEX_END;
+         Index = Entry[Index].Next)
+    {
+      if (CompareGuid (&Entry[Index].Name, FileName)) {
+        *FileHeader = (EFI_FFS_FILE_HEADER *)((UINT8 *)FwVolHeader + Entry[Index].Offset);
+        return EFI_SUCCESS;
+      }
+    }
+
+    *FileHeader = NULL;
+    return EFI_NOT_FOUND;
+  }
+
+  //
+  // Start with the first entry after *FileHeader.
+  //
+  Low = 0;
+  if (*FileHeader != NULL) {
+    CurrentOffset = (UINTN)*FileHeader - (UINTN)FwVolHeader;
+    High          = FileIndex->FileCount;
+    while (Low < High) {
+      Index = Low + (High - Low) / 2;
+      if (Entry[Index].Offset <= CurrentOffset) {
+        Low = Index + 1;
+      } else {
+        High = Index;
+      }
+    }
+  }
+
+  for (Index = Low; Index < FileIndex->FileCount; Index++) {
+    FfsFileHeader = (EFI_FFS_FILE_HEADER *)((UINT8 *)FwVolHeader + Entry[Index].Offset);
+    if (SearchType == PEI_CORE_INTERNAL_FFS_FILE_DISPATCH_TYPE) {
+      if ((Entry[Index].Type == EFI_FV_FILETYPE_PEIM) ||
+          (Entry[Index].Type == EFI_FV_FILETYPE_COMBINED_PEIM_DRIVER) ||
+          (Entry[Index].Type == EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE))
+      {
+        *FileHeader = FfsFileHeader;
+        return EFI_SUCCESS;
+      } else if (AprioriFile != NULL) {
+        if (Entry[Index].Type == EFI_FV_FILETYPE_FREEFORM) {
+          if (CompareGuid (&Entry[Index].Name, &gPeiAprioriFileNameGuid)) {
+            *AprioriFile = (EFI_PEI_FILE_HANDLE)FfsFileHeader;
+          }
+        }
+      }
+    } else if (((SearchType == Entry[Index].Type) || (SearchType == EFI_FV_FILETYPE_ALL)) &&
+               (Entry[Index].Type != EFI_FV_FILETYPE_FFS_PAD))
+    {
+      *FileHeader = FfsFileHeader;
+      return EFI_SUCCESS;
+    }
+  }
+
+  *FileHeader = NULL;
+  return EFI_NOT_FOUND;
+}
+
 /**
   Given the input file pointer, search for the first matching file in the
   FFS volume as defined by SearchType. The search starts from FileHeader inside
@@ -283,6 +380,7 @@ FindFileEx (
   UINT8                           FileState;
   UINT8                           DataCheckSum;
   BOOLEAN                         IsFfs3Fv;
+  PEI_CORE_FV_HANDLE              *CoreFvHandle;
 
   //
   // Convert the handle of FV to FV header for memory-mapped firmware volume
@@ -290,6 +388,11 @@ FindFileEx (
   FwVolHeader = (EFI_FIRMWARE_VOLUME_HEADER *)FvHandle;
   FileHeader  = (EFI_FFS_FILE_HEADER **)FileHandle;
 
+  CoreFvHandle = FvHandleToCoreHandle (FvHandle);
+  if ((CoreFvHandle != NULL) && (CoreFvHandle->FileIndex != NULL)) {
+    return FindFileInIndex (FwVolHeader, CoreFvHandle->FileIndex, FileName, SearchType, FileHeader, AprioriFile);
+  }
+
   IsFfs3Fv = CompareGuid (&FwVolHeader->FileSystemGuid, &gEfiFirmwareFileSystem3Guid);
 
   FvLength = FwVolHeader->FvLength;
@@ -669,6 +772,10 @@ FirmwareVolumeInfoPpiNotifyCallback (
       ));
     PrivateData->FvCount++;
 
+    if (PrivateData->FvFileIndexReady) {
+      PeiBuildFvFileIndex (&PrivateData->Fv[CurFvCount]);
+    }
+
     //
     // Scan and process the new discovered FV for EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE
     //
@@ -2215,6 +2322,232 @@ PeiReinitializeFv (
   }
 }
 
+/**
+  Walk the files of a firmware volume like FindFileEx () does, and record the
+  ones FindFileEx () may return.
+
+  @param FwVolHeader     Pointer to the FV header of the volume.
+  @param Entry           Optional buffer receiving FileCount entries. The hash
+                         chains are not initialized.
+  @param FileCount       Receives the number of files.
+
+  @retval EFI_SUCCESS            The walk reached the end of the files.
+  @retval EFI_VOLUME_CORRUPTED   A file has a bad checksum or the volume
+                                 has an unexpected layout.
+**/
+STATIC
+EFI_STATUS
+PeiWalkFvFiles (
+  IN  EFI_FIRMWARE_VOLUME_HEADER  *FwVolHeader,
+  OUT FV_FILE_INDEX_ENTRY         *Entry      OPTIONAL,
+  OUT UINT32                      *FileCount
+  )
+{
+  EFI_FIRMWARE_VOLUME_EXT_HEADER  *FwVolExtHeader;
+  EFI_FFS_FILE_HEADER             *FfsFileHeader;
+  UINT32                          FileLength;
+  UINT32                          HeaderLength;
+  UINT64                          FileOffset;
+  UINTN                           Index;
+  UINT8                           ErasePolarity;
+  EFI_FFS_FILE_STATE              FileState;
+  BOOLEAN                         IsFfs3Fv;
+
+  *FileCount = 0;
+  IsFfs3Fv   = CompareGuid (&FwVolHeader->FileSystemGuid, &gEfiFirmwareFileSystem3Guid);
+  if ((FwVolHeader->Attributes & EFI_FVB2_ERASE_POLARITY) != 0) {
+    ErasePolarity = 1;
+  } else {
+    ErasePolarity = 0;
+  }
+
+  if (FwVolHeader->ExtHeaderOffset != 0) {
+    FwVolExtHeader = (EFI_FIRMWARE_VOLUME_EXT_HEADER *)((UINT8 *)FwVolHeader + FwVolHeader->ExtHeaderOffset);
+    FileOffset     = FwVolHeader->ExtHeaderOffset + FwVolExtHeader->ExtHeaderSize;
+  } else {
+    FileOffset = FwVolHeader->HeaderLength;
+  }
+
+  FileOffset = ALIGN_VALUE (FileOffset, 8);
+  if ((FwVolHeader->FvLength > MAX_UINT32) || (FileOffset > FwVolHeader->FvLength)) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  while (FileOffset < (FwVolHeader->FvLength - sizeof (EFI_FFS_FILE_HEADER))) {
+    FfsFileHeader = (EFI_FFS_FILE_HEADER *)((UINT8 *)FwVolHeader + FileOffset);
+    if (IS_FFS_FILE2 (FfsFileHeader)) {
+      HeaderLength = sizeof (EFI_FFS_FILE_HEADER2);
+      FileLength   = FFS_FILE2_SIZE (FfsFileHeader);
+    } else {
+      HeaderLength = sizeof (EFI_FFS_FILE_HEADER);
+      FileLength   = FFS_FILE_SIZE (FfsFileHeader);
+    }
+
+    FileState = GetFileState (ErasePolarity, FfsFileHeader);
+    switch (FileState) {
+      case EFI_FILE_HEADER_CONSTRUCTION:
+      case EFI_FILE_HEADER_INVALID:
+        FileOffset += HeaderLength;
+        continue;
+
+      case EFI_FILE_DATA_VALID:
+      case EFI_FILE_MARKED_FOR_UPDATE:
+      case EFI_FILE_DELETED:
+        //
+        // Reject anything the DXE Core would reject when scanning the FV, so
+        // that it can trust an index of this FV.
+        //
+        if ((FileLength < HeaderLength) || (FileLength > FwVolHeader->FvLength - FileOffset) ||
+            (CalculateHeaderChecksum (FfsFileHeader) != 0))
+        {
+          return EFI_VOLUME_CORRUPTED;
+        }
+
+        if ((FfsFileHeader->Attributes & FFS_ATTRIB_CHECKSUM) == FFS_ATTRIB_CHECKSUM) {
+          if (FfsFileHeader->IntegrityCheck.Checksum.File !=
+              CalculateCheckSum8 ((CONST UINT8 *)FfsFileHeader + HeaderLength, FileLength - HeaderLength))
+          {
+            return EFI_VOLUME_CORRUPTED;
+          }
+        } else if (FfsFileHeader->IntegrityCheck.Checksum.File != FFS_FIXED_CHECKSUM) {
+          return EFI_VOLUME_CORRUPTED;
+        }
+
+        if ((FileState == EFI_FILE_DELETED) || (IS_FFS_FILE2 (FfsFileHeader) && !IsFfs3Fv)) {
+          break;
+        }
+
+        if (Entry != NULL) {
+          CopyGuid (&Entry[*FileCount].Name, &FfsFileHeader->Name);
+          Entry[*FileCount].Offset = (UINT32)FileOffset;
+          Entry[*FileCount].Type   = FfsFileHeader->Type;
+        }
+
+        (*FileCount)++;
+        break;
+
+      default:
+        //
+        // FindFileEx () stops at any other state, but only free space ends
+        // the files of a consistent FV.
+        //
+        for (Index = 0; Index < sizeof (EFI_FFS_FILE_HEADER); Index++) {
+          if (((UINT8 *)FfsFileHeader)[Index] != (ErasePolarity != 0 ? 0xFF : 0)) {
+            return EFI_VOLUME_CORRUPTED;
+          }
+        }
+
+        return EFI_SUCCESS;
+    }
+
+    FileOffset += GET_OCCUPIED_SIZE (FileLength, 8);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Build the file index of an FV in a GUID HOB.
+
+  No index is built for an FV in a format the PEI Core does not produce the
+  EFI_PEI_FIRMWARE_VOLUME_PPI for, for a corrupted FV, or when the index would
+  not fit in a HOB. FindFileEx () keeps walking the file headers of such FVs.
+
+  @param CoreFvHandle   The PEI_CORE_FV_HANDLE of the FV.
+**/
+VOID
+PeiBuildFvFileIndex (
+  IN OUT PEI_CORE_FV_HANDLE  *CoreFvHandle
+  )
+{
+  EFI_FIRMWARE_VOLUME_HEADER  *FwVolHeader;
+  FV_FILE_INDEX               *FileIndex;
+  FV_FILE_INDEX_ENTRY         *Entry;
+  UINT32                      *HashHead;
+  UINT32                      FileCount;
+  UINT32                      HashSize;
+  UINT32                      Bucket;
+  UINT32                      Index;
+  UINTN                       IndexSize;
+
+  if ((CoreFvHandle->FileIndex != NULL) ||
+      ((CoreFvHandle->FvPpi != &mPeiFfs2FwVol.Fv) && (CoreFvHandle->FvPpi != &mPeiFfs3FwVol.Fv)))
+  {
+    return;
+  }
+
+  FwVolHeader = (EFI_FIRMWARE_VOLUME_HEADER *)CoreFvHandle->FvHandle;
+  if (EFI_ERROR (PeiWalkFvFiles (FwVolHeader, NULL, &FileCount))) {
+    DEBUG ((DEBUG_WARN, "No file index for the FV at %p, it may be corrupted\n", FwVolHeader));
+    return;
+  }
+
+  HashSize = 1;
+  while (HashSize < FileCount) {
+    HashSize <<= 1;
+  }
+
+  IndexSize = sizeof (FV_FILE_INDEX) + (UINTN)FileCount * sizeof (FV_FILE_INDEX_ENTRY) + (UINTN)HashSize * sizeof (UINT32);
+  if (IndexSize > 0xFFF8 - sizeof (EFI_HOB_GUID_TYPE)) {
+    DEBUG ((DEBUG_INFO, "No file index for the FV at %p, it has too many files\n", FwVolHeader));
+    return;
+  }
+
+  FileIndex = BuildGuidHob (&gEdkiiFvFileIndexHobGuid, IndexSize);
+  if (FileIndex == NULL) {
+    return;
+  }
+
+  FileIndex->FvBase    = (EFI_PHYSICAL_ADDRESS)(UINTN)FwVolHeader;
+  FileIndex->FvLength  = FwVolHeader->FvLength;
+  FileIndex->FileCount = FileCount;
+  FileIndex->HashSize  = HashSize;
+  Entry                = FV_FILE_INDEX_ENTRIES (FileIndex);
+  HashHead             = FV_FILE_INDEX_HASH_HEADS (FileIndex);
+  ZeroMem (Entry, (UINTN)FileCount * sizeof (FV_FILE_INDEX_ENTRY));
+  SetMem32 (HashHead, (UINTN)HashSize * sizeof (UINT32), FV_FILE_INDEX_END);
+
+  PeiWalkFvFiles (FwVolHeader, Entry, &FileCount);
+  ASSERT (FileCount == FileIndex->FileCount);
+
+  //
+  // Link the entries from the last one, so each chain is in volume order and
+  // a lookup finds the same file as the walk of FindFileEx () would.
+  //
+  for (Index = FileCount; Index > 0; Index--) {
+    Bucket                = FV_FILE_INDEX_HASH (&Entry[Index - 1].Name, HashSize);
+    Entry[Index - 1].Next = HashHead[Bucket];
+    HashHead[Bucket]      = Index - 1;
+  }
+
+  CoreFvHandle->FileIndex = FileIndex;
+}
+
+/**
+  Build the file index of every FV of the PEI Core once permanent memory is
+  installed and the FVs have been migrated, so that FindFileEx () and the DXE
+  Core no longer walk the FFS file headers of those FVs.
+
+  @param PrivateData   Pointer to PEI_CORE_INSTANCE.
+**/
+VOID
+PeiBuildFvFileIndexes (
+  IN  PEI_CORE_INSTANCE  *PrivateData
+  )
+{
+  UINTN  Index;
+
+  if (!FeaturePcdGet (PcdPeiCoreFvFileIndex)) {
+    return;
+  }
+
+  for (Index = 0; Index < PrivateData->FvCount; Index++) {
+    PeiBuildFvFileIndex (&PrivateData->Fv[Index]);
+  }
+
+  PrivateData->FvFileIndexReady = TRUE;
+}
+
 /**
   Report the information for a newly discovered FV in an unknown format.
 
@@ -300,6 +300,20 @@ FindFileEx (
   IN OUT    EFI_PEI_FILE_HANDLE  *AprioriFile  OPTIONAL
   );
 
+/**
+  Build the file index of an FV in a GUID HOB.
+
+  No index is built for an FV in a format the PEI Core does not produce the
+  EFI_PEI_FIRMWARE_VOLUME_PPI for, for a corrupted FV, or when the index would
+  not fit in a HOB. FindFileEx () keeps walking the file headers of such FVs.
+
+  @param CoreFvHandle   The PEI_CORE_FV_HANDLE of the FV.
+**/
+VOID
+PeiBuildFvFileIndex (
+  IN OUT PEI_CORE_FV_HANDLE  *CoreFvHandle
+  );
+
 /**
   Report the information for a newly discovered FV in an unknown format.
 
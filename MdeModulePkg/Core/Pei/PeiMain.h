@@ -45,6 +45,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Guid/FirmwareFileSystem3.h>
 #include <Guid/AprioriFileName.h>
 #include <Guid/MigratedFvInfo.h>
+#include <Guid/FvFileIndexHob.h>
 
 ///
 /// It is an FFS type extension used for PeiFindFileEx. It indicates current
@@ -146,6 +147,11 @@ typedef struct {
   EFI_PEI_FILE_HANDLE            *FvFileHandles;
   BOOLEAN                        ScanFv;
   UINT32                         AuthenticationStatus;
+  //
+  // Pointer to the file index of the FV in its GUID HOB, or NULL if the FV
+  // has no file index.
+  //
+  FV_FILE_INDEX                  *FileIndex;
 } PEI_CORE_FV_HANDLE;
 
 typedef struct {
@@ -235,6 +241,12 @@ struct _PEI_CORE_INSTANCE {
   ///
   PEI_CORE_FV_HANDLE                *Fv;
 
+  ///
+  /// TRUE once the file indexes of the FVs have been built in permanent memory.
+  /// An FV found after that gets its file index when it is installed.
+  ///
+  BOOLEAN                           FvFileIndexReady;
+
   ///
   /// Pointer to the buffer with the MaxUnknownFvInfoCount number of entries.
   /// Each entry is for one FV which could not be dispatched by PeiCore.
@@ -2027,4 +2039,16 @@ PeiReinitializeFv (
   IN  PEI_CORE_INSTANCE  *PrivateData
   );
 
+/**
+  Build the file index of every FV of the PEI Core once permanent memory is
+  installed and the FVs have been migrated, so that FindFileEx () and the DXE
+  Core no longer walk the FFS file headers of those FVs.
+
+  @param PrivateData   Pointer to PEI_CORE_INSTANCE.
+**/
+VOID
+PeiBuildFvFileIndexes (
+  IN  PEI_CORE_INSTANCE  *PrivateData
+  );
+
 #endif
@@ -453,6 +453,11 @@ PeiCore (
       DumpPpiList (&PrivateData);
     }
 
+    //
+    // The FVs are at their final location, index their files.
+    //
+    PeiBuildFvFileIndexes (&PrivateData);
+
     //
     // Try to locate Temporary RAM Done Ppi.
     //
@@ -0,0 +1,81 @@
+/** @file
+  Definitions of the GUID HOB that holds the file index of a firmware volume.
+
+  Once permanent memory is installed, the PEI Core builds such a HOB for each
+  memory-mapped firmware volume in a file system format it supports. Later PEI
+  file searches and the DXE Core use the index rather than walking the FFS file
+  headers of the volume again.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __FV_FILE_INDEX_HOB_H__
+#define __FV_FILE_INDEX_HOB_H__
+
+#define EDKII_FV_FILE_INDEX_HOB_GUID \
+  { \
+    0x5b9a7c0d, 0x2f13, 0x4b7e, { 0x9a, 0x61, 0x3c, 0xd4, 0x8e, 0x27, 0xf5, 0x0b } \
+  }
+
+///
+/// Terminates a hash chain.
+///
+#define FV_FILE_INDEX_END  MAX_UINT32
+
+///
+/// Hash bucket of a file name in a table of HashSize buckets. HashSize is a
+/// power of two.
+///
+#define FV_FILE_INDEX_HASH(Name, HashSize)  ((Name)->Data1 & ((HashSize) - 1))
+
+typedef struct {
+  ///
+  /// Name of the file.
+  ///
+  EFI_GUID    Name;
+  ///
+  /// Offset of the FFS file header from the start of the firmware volume.
+  ///
+  UINT32      Offset;
+  ///
+  /// Index of the next entry of the same hash bucket, in volume order, or
+  /// FV_FILE_INDEX_END.
+  ///
+  UINT32      Next;
+  ///
+  /// Type of the file.
+  ///
+  UINT8       Type;
+  UINT8       Reserved[3];
+} FV_FILE_INDEX_ENTRY;
+
+///
+/// The index lists, in volume order, the files whose state is
+/// EFI_FILE_DATA_VALID or EFI_FILE_MARKED_FOR_UPDATE and whose header and data
+/// checksums have been verified. A volume with a corrupted file has no index.
+///
+typedef struct {
+  ///
+  /// Base address and length of the firmware volume when the index was built.
+  ///
+  EFI_PHYSICAL_ADDRESS    FvBase;
+  UINT64                  FvLength;
+  UINT32                  FileCount;
+  UINT32                  HashSize;
+  //
+  // FV_FILE_INDEX_ENTRY    Entry[FileCount];
+  // UINT32                 HashHead[HashSize];
+  //
+} FV_FILE_INDEX;
+
+#define FV_FILE_INDEX_ENTRIES(Index) \
+  ((FV_FILE_INDEX_ENTRY *)((FV_FILE_INDEX *)(Index) + 1))
+
+#define FV_FILE_INDEX_HASH_HEADS(Index) \
+  ((UINT32 *)(FV_FILE_INDEX_ENTRIES (Index) + ((FV_FILE_INDEX *)(Index))->FileCount))
+
+extern EFI_GUID  gEdkiiFvFileIndexHobGuid;
+
+#endif
@@ -23,7 +23,32 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define LZMAF86_CUSTOM_DECOMPRESS_GUID  \
   { 0xD42AE6BD, 0x1352, 0x4bfb, { 0x90, 0x9A, 0xCA, 0x72, 0xA6, 0xEA, 0xE8, 0x89 } }
 
+///
+/// The Global ID used to identify a section of an FFS file of type
+/// EFI_SECTION_GUID_DEFINED, whose contents have been compressed using LZMA
+/// in independently decodable chunks.
+///
+#define LZMA_CHUNKED_CUSTOM_DECOMPRESS_GUID  \
+  { 0x662F41F9, 0xE810, 0x49EF, { 0x8B, 0x59, 0xDE, 0xA1, 0x18, 0x2A, 0x56, 0x85 } }
+
+#define LZMA_CHUNKED_SIGNATURE  SIGNATURE_32 ('L', 'Z', 'C', 'K')
+
+///
+/// Header of the data of a LZMA_CHUNKED_CUSTOM_DECOMPRESS_GUID section.
+/// It is followed by ChunkCount UINT32 values that give the size of each
+/// compressed chunk, and then by the chunks. Each chunk is a complete LZMA
+/// stream that decodes to ChunkSize bytes, except for the last chunk that
+/// decodes to the remaining bytes of DecodedSize.
+///
+typedef struct {
+  UINT32    Signature;
+  UINT32    ChunkSize;
+  UINT32    ChunkCount;
+  UINT32    DecodedSize;
+} LZMA_CHUNKED_HEADER;
+
 extern GUID  gLzmaCustomDecompressGuid;
 extern GUID  gLzmaF86CustomDecompressGuid;
+extern GUID  gLzmaChunkedCustomDecompressGuid;
 
 #endif
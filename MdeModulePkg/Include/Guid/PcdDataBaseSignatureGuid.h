@@ -54,6 +54,26 @@ typedef struct  {
   UINT16    ExGuidIndex;        // Index of GuidTable in units of GUID.
 } DYNAMICEX_MAPPING;
 
+//
+// The ExMap hash table is a minimal perfect hash of the first ExTokenCount
+// entries of ExMapTable, keyed on the token space GUID and the token number:
+//
+//   UINT32  BucketCount;
+//   UINT32  Displacement[BucketCount];
+//   UINT32  ExMapIndex[ExTokenCount];
+//
+// The key is hashed with FNV-1a over the seed (UINT32), the GUID and the token
+// number (UINT32), all little endian, followed by the MurmurHash3 finalizer.
+// The seed 0 hash selects the bucket. If the
+// Displacement of the bucket has PCD_EXMAP_HASH_DIRECT set, its low bits are the
+// slot in ExMapIndex; otherwise the slot is the hash with the Displacement as
+// seed, modulo ExTokenCount. The ExMapTable entry found this way must still be
+// compared with the key.
+//
+#define PCD_EXMAP_HASH_DIRECT        BIT31
+#define PCD_EXMAP_HASH_OFFSET_BASIS  0x811C9DC5
+#define PCD_EXMAP_HASH_PRIME         0x01000193
+
 typedef struct {
   UINT32    StringIndex;        // Offset in String Table in units of UINT8.
   UINT32    DefaultValueOffset; // Offset of the Default Value.
@@ -96,7 +116,8 @@ typedef struct {
   UINT16          LocalTokenCount;              // LOCAL_TOKEN_NUMBER for all.
   UINT16          ExTokenCount;                 // EX_TOKEN_NUMBER for DynamicEx.
   UINT16          GuidTableCount;               // The Number of Guid in GuidTable.
-  UINT8           Pad[6];                       // Pad bytes to satisfy the alignment.
+  UINT8           Pad[2];                       // Pad bytes to satisfy the alignment.
+  TABLE_OFFSET    ExMapHashTableOffset;         // 0 if the database has no ExMap hash table.
 
   //
   // Default initialized external PCD database binary structure
@@ -108,6 +129,7 @@ typedef struct {
   // UINT32                         ValueUint32[];
   // VPD_HEAD                       VpdHead[];               // VPD Offset
   // DYNAMICEX_MAPPING              ExMapTable[];            // DynamicEx PCD mapped to LocalIndex in LocalTokenNumberTable. It can be accessed by the ExMapTableOffset.
+  // UINT32                         ExMapHashTable[];        // Perfect hash of ExMapTable. It can be accessed by the ExMapHashTableOffset.
   // UINT32                         LocalTokenNumberTable[]; // Offset | DataType | PCD Type. It can be accessed by LocalTokenNumberTableOffset.
   // GUID                           GuidTable[];             // GUID for DynamicEx and HII PCD variable Guid. It can be accessed by the GuidTableOffset.
   // STRING_HEAD                    StringHead[];            // String PCD
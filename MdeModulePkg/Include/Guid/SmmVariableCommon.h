@@ -77,6 +77,16 @@ typedef struct {
 // The payload for this function is SMM_VARIABLE_COMMUNICATE_GET_RUNTIME_CACHE_INFO
 //
 #define SMM_VARIABLE_FUNCTION_GET_RUNTIME_CACHE_INFO  14
+//
+// The payload for this function is SMM_VARIABLE_COMMUNICATE_BATCH, followed by
+// EntryCount SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE entries, each of them
+// starting at an offset aligned on sizeof (UINTN).
+//
+#define SMM_VARIABLE_FUNCTION_STAGE_BATCH  15
+//
+// The payload for this function is SMM_VARIABLE_COMMUNICATE_BATCH
+//
+#define SMM_VARIABLE_FUNCTION_COMMIT_BATCH  16
 
 ///
 /// Size of SMM communicate header, without including the payload.
@@ -147,4 +157,22 @@ typedef struct {
   BOOLEAN    AuthenticatedVariableUsage;
 } SMM_VARIABLE_COMMUNICATE_GET_RUNTIME_CACHE_INFO;
 
+///
+/// This structure is used to communicate with SMI handler by the batched SetVariable ().
+///
+typedef struct {
+  ///
+  /// SMM_VARIABLE_FUNCTION_STAGE_BATCH: index of the first entry of the
+  /// payload in the batch, 0 starts a new batch.
+  /// SMM_VARIABLE_FUNCTION_COMMIT_BATCH: returns the index of the entry that
+  /// caused the batch to fail.
+  ///
+  UINTN    EntryIndex;
+  ///
+  /// SMM_VARIABLE_FUNCTION_STAGE_BATCH: number of entries in the payload.
+  /// SMM_VARIABLE_FUNCTION_COMMIT_BATCH: number of entries in the batch.
+  ///
+  UINTN    EntryCount;
+} SMM_VARIABLE_COMMUNICATE_BATCH;
+
 #endif // _SMM_VARIABLE_COMMON_H_
@@ -0,0 +1,99 @@
+/** @file
+  Concurrent Dispatch Protocol is related to EDK II-specific implementation of
+  the DXE dispatcher and intended for use by DXE drivers that need to do CPU
+  bound work during their initialization.
+
+  The driver splits its initialization into procedures that only compute, and
+  completion routines that run on the Bootstrap Processor (BSP) and publish
+  the results, e.g. by installing protocols. The DXE dispatcher runs the
+  procedures queued by an entry point on the Application Processors (APs) and
+  the BSP as soon as the entry point returns, and the completion routines
+  before it starts the next driver. No other driver code runs while the APs
+  are busy, so the MP Services Protocol is free again for the next driver.
+
+  The drivers themselves are still dispatched one at a time. Only the work
+  queued by the same entry point runs concurrently, so a driver gains nothing
+  unless it can split its own initialization into independent procedures.
+
+  The DXE Core only produces this protocol if PcdDxeCoreConcurrentDispatch is
+  TRUE.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __CONCURRENT_DISPATCH_H__
+#define __CONCURRENT_DISPATCH_H__
+
+#define EDKII_CONCURRENT_DISPATCH_PROTOCOL_GUID \
+  { \
+    0x5714c345, 0x5ca2, 0x48a0, { 0x91, 0xf7, 0xcf, 0x13, 0x4f, 0xff, 0x5c, 0x7c } \
+  }
+
+typedef struct _EDKII_CONCURRENT_DISPATCH_PROTOCOL EDKII_CONCURRENT_DISPATCH_PROTOCOL;
+
+/**
+  Publish the results of concurrent work on the BSP.
+
+  @param[in] Context   The Context passed to StartWork ().
+
+**/
+typedef
+VOID
+(EFIAPI *EDKII_CONCURRENT_DISPATCH_COMPLETION)(
+  IN VOID  *Context
+  );
+
+/**
+  Run the CPU bound part of a driver initialization concurrently with the DXE
+  dispatcher.
+
+  Called from the entry point of a DXE driver started by the DXE dispatcher,
+  this function queues the work. Once the entry point has returned, the
+  queued procedures run on the idle APs and the BSP. They must not use any
+  boot or runtime service, protocol or library that relies on them, nor
+  allocate or free memory; all their buffers must be allocated by the caller.
+  The completion routines then run on the BSP at TPL_APPLICATION, in the order
+  the work was queued, and may use every boot service.
+
+  A procedure that does not return within PcdDxeCoreConcurrentDispatchApTimeout
+  is aborted and its completion routine is not called. If the entry point
+  returns an error, the work it queued is discarded without calling either
+  routine.
+
+  Called from anywhere else, Procedure and Completion run on the BSP before
+  this function returns.
+
+  @param[in] This         The EDKII_CONCURRENT_DISPATCH_PROTOCOL instance.
+  @param[in] Procedure    The CPU bound part of the initialization.
+  @param[in] Completion   Optional. The part of the initialization that
+                          publishes the results.
+  @param[in] Context      The context passed to Procedure and Completion.
+
+  @retval EFI_SUCCESS            Procedure has been queued, or has run.
+  @retval EFI_INVALID_PARAMETER  Procedure is NULL.
+  @retval EFI_OUT_OF_RESOURCES   There are not enough resources to track the
+                                 work. Neither routine has been called.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_CONCURRENT_DISPATCH_START_WORK)(
+  IN EDKII_CONCURRENT_DISPATCH_PROTOCOL    *This,
+  IN EFI_AP_PROCEDURE                      Procedure,
+  IN EDKII_CONCURRENT_DISPATCH_COMPLETION  Completion OPTIONAL,
+  IN VOID                                  *Context
+  );
+
+///
+/// Concurrent Dispatch Protocol is related to EDK II-specific implementation of
+/// the DXE dispatcher and intended for use by DXE drivers that need to do CPU
+/// bound work during their initialization.
+///
+struct _EDKII_CONCURRENT_DISPATCH_PROTOCOL {
+  EDKII_CONCURRENT_DISPATCH_START_WORK    StartWork;
+};
+
+extern EFI_GUID  gEdkiiConcurrentDispatchProtocolGuid;
+
+#endif
@@ -0,0 +1,80 @@
+/** @file
+  Variable Batch Protocol is related to EDK II-specific implementation of variables
+  and intended for use as a means to set a group of non-volatile variables with a
+  single update of the variable store.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __VARIABLE_BATCH_H__
+#define __VARIABLE_BATCH_H__
+
+#define EDKII_VARIABLE_BATCH_PROTOCOL_GUID \
+  { \
+    0xb848ab26, 0x0d40, 0x41d8, { 0xa8, 0x17, 0x41, 0xd5, 0x9f, 0xdb, 0x1e, 0xfc } \
+  }
+
+typedef struct _EDKII_VARIABLE_BATCH_PROTOCOL EDKII_VARIABLE_BATCH_PROTOCOL;
+
+///
+/// One variable update of a batch. The fields have the meaning of the
+/// parameters of the SetVariable () runtime service.
+///
+typedef struct {
+  CHAR16      *VariableName;
+  EFI_GUID    *VendorGuid;
+  UINT32      Attributes;
+  UINTN       DataSize;
+  VOID        *Data;
+} EDKII_VARIABLE_BATCH_ENTRY;
+
+/**
+  Set a group of non-volatile variables.
+
+  The updates are applied in order, with the same checks as the SetVariable ()
+  runtime service, to a staging copy of the variable store. The variable store
+  is then updated with a single fault tolerant write, so that after a power loss
+  either all or none of the updates are present.
+
+  Every entry must have the EFI_VARIABLE_NON_VOLATILE attribute set. The platform
+  key and the language variables cannot be part of a batch.
+
+  @param[in]  This          The EDKII_VARIABLE_BATCH_PROTOCOL instance.
+  @param[in]  EntryCount    Number of entries in Entries.
+  @param[in]  Entries       The variable updates.
+  @param[out] FailedEntry   Optional. Index of the entry that caused the batch to
+                            fail, or EntryCount if no single entry is responsible.
+
+  @retval EFI_SUCCESS            All the variable updates have been committed.
+  @retval EFI_INVALID_PARAMETER  Entries is NULL and EntryCount is not 0, or an
+                                 entry cannot be part of a batch.
+  @retval EFI_ABORTED            The variable store was updated by another caller
+                                 while the batch was staged.
+  @retval EFI_UNSUPPORTED        The service is called after ExitBootServices ().
+  @return Others                 The error returned for the failing entry by
+                                 SetVariable (), or the error of the commit.
+                                 No variable update has been committed.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_VARIABLE_BATCH_PROTOCOL_SET_VARIABLES)(
+  IN CONST EDKII_VARIABLE_BATCH_PROTOCOL  *This,
+  IN       UINTN                          EntryCount,
+  IN       EDKII_VARIABLE_BATCH_ENTRY     *Entries,
+  OUT      UINTN                          *FailedEntry OPTIONAL
+  );
+
+///
+/// Variable Batch Protocol is related to EDK II-specific implementation of variables
+/// and intended for use as a means to set a group of non-volatile variables with a
+/// single update of the variable store.
+///
+struct _EDKII_VARIABLE_BATCH_PROTOCOL {
+  EDKII_VARIABLE_BATCH_PROTOCOL_SET_VARIABLES    SetVariables;
+};
+
+extern EFI_GUID  gEdkiiVariableBatchProtocolGuid;
+
+#endif
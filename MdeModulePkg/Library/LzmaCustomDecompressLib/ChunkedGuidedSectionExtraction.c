@@ -0,0 +1,445 @@
+/** @file
+  LZMA Chunked Decompress GUIDed Section Extraction Library.
+
+  It produces the LZMA custom decompression algorithm for sections whose data
+  is split into independently decodable LZMA chunks, in addition to the plain
+  LZMA custom decompression algorithm. The chunks are decoded on all enabled
+  processors through the PEI MP Services PPI, or on the BSP alone when the PPI
+  is not available.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+#include <Library/PeiServicesLib.h>
+#include <Library/PeiServicesTablePointerLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Ppi/MpServices.h>
+
+//
+// Each chunk starts with the LZMA properties and the 64-bit decoded size
+//
+#define LZMA_CHUNK_HEADER_SIZE  (5 + 8)
+
+typedef struct {
+  CONST UINT8         *Chunks;
+  UINT32              *ChunkOffsets;
+  UINT32              *ChunkSizes;
+  UINT32              ChunkCount;
+  UINT32              ChunkSize;
+  UINT32              DecodedSize;
+  UINT8               *Destination;
+  UINT8               *Scratch;
+  UINT32              ChunkScratchSize;
+  UINT32              WorkerCount;
+  volatile UINT32     NextWorker;
+  volatile UINT32     NextChunk;
+  volatile BOOLEAN    Failed;
+} LZMA_CHUNKED_CONTEXT;
+
+/**
+  Get the data of a LZMA chunked GUIDed section.
+
+  @param[in]  InputSection  A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] Data          The data of the section.
+  @param[out] DataSize      The size, in bytes, of the data of the section.
+  @param[out] Attributes    Optional. The attributes of the GUIDed section.
+
+  @retval TRUE   The section is a LZMA chunked GUIDed section.
+  @retval FALSE  The section has another GUID.
+
+**/
+STATIC
+BOOLEAN
+LzmaChunkedGetSectionData (
+  IN  CONST VOID   *InputSection,
+  OUT CONST UINT8  **Data,
+  OUT UINT32       *DataSize,
+  OUT UINT16       *Attributes OPTIONAL
+  )
+{
+  EFI_GUID_DEFINED_SECTION   *Section;
+  EFI_GUID_DEFINED_SECTION2  *Section2;
+
+  if (IS_SECTION2 (InputSection)) {
+    Section2 = (EFI_GUID_DEFINED_SECTION2 *)InputSection;
+    if (!CompareGuid (&gLzmaChunkedCustomDecompressGuid, &Section2->SectionDefinitionGuid)) {
+      return FALSE;
+    }
+
+    *Data     = (UINT8 *)InputSection + Section2->DataOffset;
+    *DataSize = SECTION2_SIZE (InputSection) - Section2->DataOffset;
+    if (Attributes != NULL) {
+      *Attributes = Section2->Attributes;
+    }
+  } else {
+    Section = (EFI_GUID_DEFINED_SECTION *)InputSection;
+    if (!CompareGuid (&gLzmaChunkedCustomDecompressGuid, &Section->SectionDefinitionGuid)) {
+      return FALSE;
+    }
+
+    *Data     = (UINT8 *)InputSection + Section->DataOffset;
+    *DataSize = SECTION_SIZE (InputSection) - Section->DataOffset;
+    if (Attributes != NULL) {
+      *Attributes = Section->Attributes;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Validate the header of LZMA chunked data.
+
+  @param[in]  Data          The LZMA chunked data.
+  @param[in]  DataSize      The size, in bytes, of the data.
+  @param[out] Header        The header of the data.
+
+  @retval RETURN_SUCCESS            The header is valid.
+  @retval RETURN_INVALID_PARAMETER  The header is corrupted.
+
+**/
+STATIC
+RETURN_STATUS
+LzmaChunkedReadHeader (
+  IN  CONST UINT8          *Data,
+  IN  UINT32               DataSize,
+  OUT LZMA_CHUNKED_HEADER  *Header
+  )
+{
+  if (DataSize < sizeof (LZMA_CHUNKED_HEADER)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  CopyMem (Header, Data, sizeof (LZMA_CHUNKED_HEADER));
+  if ((Header->Signature != LZMA_CHUNKED_SIGNATURE) ||
+      (Header->ChunkSize == 0) ||
+      (Header->ChunkCount != (UINT32)DivU64x32 ((UINT64)Header->DecodedSize + Header->ChunkSize - 1, Header->ChunkSize)) ||
+      ((DataSize - sizeof (LZMA_CHUNKED_HEADER)) / sizeof (UINT32) < Header->ChunkCount))
+  {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Get the number of processors that decode chunks in parallel.
+
+  @param[in]  ChunkCount    The number of chunks to decode.
+  @param[out] MpServices    The PEI MP Services PPI, or NULL if the chunks are
+                            decoded on the BSP.
+
+  @return The number of chunk decoders, each one needs its own LZMA scratch buffer.
+
+**/
+STATIC
+UINT32
+LzmaChunkedGetWorkerCount (
+  IN  UINT32                   ChunkCount,
+  OUT EFI_PEI_MP_SERVICES_PPI  **MpServices
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       NumberOfProcessors;
+  UINTN       NumberOfEnabledProcessors;
+
+  *MpServices = NULL;
+  if (ChunkCount < 2) {
+    return 1;
+  }
+
+  Status = PeiServicesLocatePpi (&gEfiPeiMpServicesPpiGuid, 0, NULL, (VOID **)MpServices);
+  if (EFI_ERROR (Status)) {
+    *MpServices = NULL;
+    return 1;
+  }
+
+  Status = (*MpServices)->GetNumberOfProcessors (
+                            GetPeiServicesTablePointer (),
+                            *MpServices,
+                            &NumberOfProcessors,
+                            &NumberOfEnabledProcessors
+                            );
+  if (EFI_ERROR (Status) || (NumberOfEnabledProcessors < 2)) {
+    *MpServices = NULL;
+    return 1;
+  }
+
+  //
+  // The BSP only waits while the APs decode the chunks.
+  //
+  return (UINT32)MIN (ChunkCount, NumberOfEnabledProcessors - 1);
+}
+
+/**
+  Decode chunks until all of them are taken. It runs on every processor that
+  takes part in the decompression.
+
+  @param[in, out] Buffer    The LZMA_CHUNKED_CONTEXT of the decompression.
+
+**/
+STATIC
+VOID
+EFIAPI
+LzmaChunkedDecompressWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  LZMA_CHUNKED_CONTEXT  *Context;
+  RETURN_STATUS         Status;
+  UINT32                Worker;
+  UINT32                Chunk;
+  UINT32                Offset;
+
+  Context = (LZMA_CHUNKED_CONTEXT *)Buffer;
+  Worker  = InterlockedIncrement (&Context->NextWorker) - 1;
+  if (Worker >= Context->WorkerCount) {
+    return;
+  }
+
+  while (!Context->Failed) {
+    Chunk = InterlockedIncrement (&Context->NextChunk) - 1;
+    if (Chunk >= Context->ChunkCount) {
+      break;
+    }
+
+    //
+    // The chunk must decode to exactly its part of the output buffer, so it
+    // can neither write into the part of another chunk nor leave a hole.
+    //
+    Offset = Chunk * Context->ChunkSize;
+    Status = LzmaUefiDecompressToSize (
+               Context->Chunks + Context->ChunkOffsets[Chunk],
+               Context->ChunkSizes[Chunk],
+               Context->Destination + Offset,
+               MIN (Context->ChunkSize, Context->DecodedSize - Offset),
+               Context->Scratch + (UINTN)Worker * Context->ChunkScratchSize
+               );
+    if (RETURN_ERROR (Status)) {
+      Context->Failed = TRUE;
+    }
+  }
+}
+
+/**
+  Examines a GUIDed section and returns the size of the decoded buffer and the
+  size of an scratch buffer required to actually decode the data in a GUIDed section.
+
+  The scratch buffer holds the chunk table and one LZMA scratch buffer for each
+  processor that decodes chunks.
+
+  @param[in]  InputSection       A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBufferSize   A pointer to the size, in bytes, of an output buffer required
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] ScratchBufferSize  A pointer to the size, in bytes, required as scratch space
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] SectionAttribute   A pointer to the attributes of the GUIDed section. See the Attributes
+                                 field of EFI_GUID_DEFINED_SECTION in the PI Specification.
+
+  @retval  RETURN_SUCCESS            The information about InputSection was returned.
+  @retval  RETURN_INVALID_PARAMETER  The information can not be retrieved from the section specified by InputSection.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionGetInfo (
+  IN  CONST VOID  *InputSection,
+  OUT UINT32      *OutputBufferSize,
+  OUT UINT32      *ScratchBufferSize,
+  OUT UINT16      *SectionAttribute
+  )
+{
+  RETURN_STATUS            Status;
+  CONST UINT8              *Data;
+  UINT32                   DataSize;
+  LZMA_CHUNKED_HEADER      Header;
+  EFI_PEI_MP_SERVICES_PPI  *MpServices;
+  UINT32                   ChunkScratchSize;
+  UINT32                   DecodedSize;
+
+  ASSERT (InputSection != NULL);
+  ASSERT (OutputBufferSize != NULL);
+  ASSERT (ScratchBufferSize != NULL);
+  ASSERT (SectionAttribute != NULL);
+
+  if (!LzmaChunkedGetSectionData (InputSection, &Data, &DataSize, SectionAttribute)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Status = LzmaChunkedReadHeader (Data, DataSize, &Header);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  ChunkScratchSize = 0;
+  if (Header.ChunkCount > 0) {
+    //
+    // Every chunk needs the scratch size of the first one
+    //
+    Data += sizeof (LZMA_CHUNKED_HEADER) + Header.ChunkCount * sizeof (UINT32);
+    if (DataSize - sizeof (LZMA_CHUNKED_HEADER) - Header.ChunkCount * sizeof (UINT32) < LZMA_CHUNK_HEADER_SIZE) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    Status = LzmaUefiDecompressGetInfo (Data, LZMA_CHUNK_HEADER_SIZE, &DecodedSize, &ChunkScratchSize);
+    if (RETURN_ERROR (Status)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+  }
+
+  *OutputBufferSize  = Header.DecodedSize;
+  *ScratchBufferSize = 2 * Header.ChunkCount * sizeof (UINT32) +
+                       LzmaChunkedGetWorkerCount (Header.ChunkCount, &MpServices) * ChunkScratchSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decompress a LZMA chunked GUIDed section into a caller allocated output buffer.
+
+  @param[in]  InputSection  A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBuffer  A pointer to a buffer that contains the result of a decode operation.
+  @param[out] ScratchBuffer A caller allocated buffer that may be required by this function
+                            as a scratch buffer to perform the decode operation.
+  @param[out] AuthenticationStatus
+                            A pointer to the authentication status of the decoded output buffer.
+                            See the definition of authentication status in the EFI_PEI_GUIDED_SECTION_EXTRACTION_PPI
+                            section of the PI Specification. EFI_AUTH_STATUS_PLATFORM_OVERRIDE must
+                            never be set by this handler.
+
+  @retval  RETURN_SUCCESS            The buffer specified by InputSection was decoded.
+  @retval  RETURN_INVALID_PARAMETER  The section specified by InputSection can not be decoded.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionExtraction (
+  IN CONST  VOID    *InputSection,
+  OUT       VOID    **OutputBuffer,
+  OUT       VOID    *ScratchBuffer         OPTIONAL,
+  OUT       UINT32  *AuthenticationStatus
+  )
+{
+  RETURN_STATUS            Status;
+  CONST UINT8              *Data;
+  UINT32                   DataSize;
+  LZMA_CHUNKED_HEADER      Header;
+  LZMA_CHUNKED_CONTEXT     Context;
+  EFI_PEI_MP_SERVICES_PPI  *MpServices;
+  UINT32                   Chunk;
+  UINT32                   Offset;
+  UINT32                   ChunkSize;
+  UINT32                   DecodedSize;
+  UINT32                   ScratchSize;
+
+  ASSERT (OutputBuffer != NULL);
+  ASSERT (InputSection != NULL);
+
+  if (!LzmaChunkedGetSectionData (InputSection, &Data, &DataSize, NULL)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Status = LzmaChunkedReadHeader (Data, DataSize, &Header);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Authentication is set to Zero, which may be ignored.
+  //
+  *AuthenticationStatus = 0;
+  if (Header.ChunkCount == 0) {
+    return RETURN_SUCCESS;
+  }
+
+  ZeroMem (&Context, sizeof (Context));
+  Context.ChunkOffsets = (UINT32 *)ScratchBuffer;
+  Context.ChunkSizes   = Context.ChunkOffsets + Header.ChunkCount;
+  Context.Chunks       = Data + sizeof (LZMA_CHUNKED_HEADER) + Header.ChunkCount * sizeof (UINT32);
+  Context.ChunkCount   = Header.ChunkCount;
+  Context.ChunkSize    = Header.ChunkSize;
+  Context.DecodedSize  = Header.DecodedSize;
+  Context.Destination  = *OutputBuffer;
+  Context.Scratch      = (UINT8 *)(Context.ChunkSizes + Header.ChunkCount);
+  DataSize            -= sizeof (LZMA_CHUNKED_HEADER) + Header.ChunkCount * sizeof (UINT32);
+
+  //
+  // Locate the chunks and check their decoded sizes, so that no chunk can
+  // write outside of its part of the output buffer.
+  //
+  Offset = 0;
+  for (Chunk = 0; Chunk < Header.ChunkCount; Chunk++) {
+    ChunkSize = ReadUnaligned32 ((UINT32 *)(Data + sizeof (LZMA_CHUNKED_HEADER)) + Chunk);
+    if ((ChunkSize < LZMA_CHUNK_HEADER_SIZE) || (ChunkSize > DataSize - Offset)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    Status = LzmaUefiDecompressGetInfo (Context.Chunks + Offset, ChunkSize, &DecodedSize, &ScratchSize);
+    if (RETURN_ERROR (Status) ||
+        (DecodedSize != MIN (Header.ChunkSize, Header.DecodedSize - Chunk * Header.ChunkSize)))
+    {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    Context.ChunkOffsets[Chunk] = Offset;
+    Context.ChunkSizes[Chunk]   = ChunkSize;
+    Context.ChunkScratchSize    = ScratchSize;
+    Offset                     += ChunkSize;
+  }
+
+  Context.WorkerCount = LzmaChunkedGetWorkerCount (Header.ChunkCount, &MpServices);
+  if (MpServices != NULL) {
+    //
+    // The BSP decodes the chunks left by the APs below, e.g. if no AP could
+    // be started.
+    //
+    MpServices->StartupAllAPs (
+                  GetPeiServicesTablePointer (),
+                  MpServices,
+                  LzmaChunkedDecompressWorker,
+                  FALSE,
+                  0,
+                  &Context
+                  );
+  }
+
+  //
+  // The APs are done, so the BSP can use the scratch buffer of any worker.
+  //
+  Context.NextWorker = 0;
+  LzmaChunkedDecompressWorker (&Context);
+
+  if (Context.Failed) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Register the LZMA and the LZMA chunked decompress handlers.
+
+  @retval  RETURN_SUCCESS            Register successfully.
+  @retval  RETURN_OUT_OF_RESOURCES   No enough memory to store this handler.
+**/
+EFI_STATUS
+EFIAPI
+LzmaChunkedDecompressLibConstructor (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = LzmaDecompressLibConstructor ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return ExtractGuidedSectionRegisterHandlers (
+           &gLzmaChunkedCustomDecompressGuid,
+           LzmaChunkedGuidedSectionGetInfo,
+           LzmaChunkedGuidedSectionExtraction
+           );
+}
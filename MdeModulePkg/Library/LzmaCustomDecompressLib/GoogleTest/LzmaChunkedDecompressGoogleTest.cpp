@@ -0,0 +1,421 @@
+/** @file
+  Unit tests of the LZMA chunked GUIDed section extraction.
+
+  The chunks are decoded on 1, 4 and 16 host threads that stand in for the APs
+  started through the PEI MP Services PPI, and the time of each decode is
+  reported.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <Library/GoogleTestLib.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+extern "C" {
+  #include <PiPei.h>
+  #include <Library/BaseLib.h>
+  #include <Library/BaseMemoryLib.h>
+  #include <Library/ExtractGuidedSectionLib.h>
+  #include <Library/PeiServicesLib.h>
+  #include <Ppi/MpServices.h>
+  #include <Guid/LzmaDecompress.h>
+
+  RETURN_STATUS
+  EFIAPI
+  LzmaChunkedGuidedSectionGetInfo (
+    IN  CONST VOID  *InputSection,
+    OUT UINT32      *OutputBufferSize,
+    OUT UINT32      *ScratchBufferSize,
+    OUT UINT16      *SectionAttribute
+    );
+
+  RETURN_STATUS
+  EFIAPI
+  LzmaChunkedGuidedSectionExtraction (
+    IN CONST  VOID    *InputSection,
+    OUT       VOID    **OutputBuffer,
+    OUT       VOID    *ScratchBuffer         OPTIONAL,
+    OUT       UINT32  *AuthenticationStatus
+    );
+}
+
+using namespace testing;
+
+#define TEST_CHUNK_SIZE   SIZE_64KB
+#define TEST_CHUNK_COUNT  64
+#define TEST_GUARD_SIZE   64
+
+//
+// LZMA stream of TestPatternByte (0) .. TestPatternByte (SIZE_64KB - 1)
+//
+STATIC CONST UINT8  mFullChunk[] = {
+  0x5D, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+  0x0F, 0x57, 0x02, 0x68, 0xC6, 0x78, 0xCE, 0xD8, 0x0F, 0x90, 0xE6, 0xEB, 0xB6, 0xDD, 0x1F, 0x70,
+  0x62, 0xB0, 0x21, 0x27, 0x14, 0xF9, 0xB1, 0x95, 0x8A, 0x58, 0x60, 0x21, 0x7A, 0x2C, 0xAC, 0xE7,
+  0x77, 0x98, 0xDF, 0x45, 0x86, 0xDA, 0xAC, 0x69, 0x34, 0x69, 0x0D, 0x38, 0x64, 0x55, 0xE2, 0xB7,
+  0x18, 0x16, 0xAA, 0x44, 0x15, 0x99, 0xBE, 0xA2, 0x90, 0x8B, 0x09, 0xD6, 0x1F, 0xC9, 0x47, 0xFF,
+  0xEF, 0xDE, 0x9A, 0xC6, 0x8D, 0xBF, 0x33, 0xD9, 0xB5, 0xD4, 0x6A, 0xAF, 0x16, 0xED, 0xF4, 0x83,
+  0xBC, 0x69, 0x74, 0xD1, 0x23, 0xE6, 0xC7, 0x84, 0x1E, 0x12, 0x9B, 0xA6, 0x75, 0x90, 0x56, 0x90,
+  0x89, 0x72, 0x1A, 0x58, 0x7F, 0x5A, 0x3E, 0x80, 0x06, 0x4C, 0x56, 0x65, 0x3F, 0x78, 0xEB, 0xAD,
+  0xD7, 0xC6, 0x55, 0x3B, 0x1F, 0x67, 0xE3, 0xA8, 0x37, 0x8A, 0x19, 0x99, 0xF2, 0x4C, 0xE6, 0xA5,
+  0xCB, 0x00, 0x71, 0x89, 0x5B, 0xCF, 0x16, 0x23, 0x81, 0x92, 0xF1, 0xF7, 0x07, 0xBF, 0x9B, 0xEE,
+  0xDC, 0xFA, 0x16, 0x13, 0x0E, 0x51, 0xD0, 0x10, 0x69, 0x88, 0x3E, 0xDE, 0xE4, 0xBD, 0xC3, 0xA6,
+  0xE0, 0x95, 0x83, 0x2B, 0x4B, 0xA8, 0x95, 0x75, 0x98, 0x7A, 0x1B, 0x8A, 0x02, 0x74, 0x78, 0xA6,
+  0xA1, 0xFC, 0x6A, 0x60, 0xF0, 0xA5, 0xAD, 0x2A, 0xC8, 0x55, 0xC4, 0xCF, 0x2F, 0x06, 0x0F, 0x62,
+  0x1B, 0x9D, 0x85, 0xB9, 0x15, 0x1C, 0xC8, 0x9B, 0x94, 0x19, 0x66, 0xD4, 0x06, 0x20, 0x86, 0x26,
+  0xA3, 0xAD, 0x7C, 0x68, 0x84, 0x02, 0x2F, 0x7B, 0x8F, 0x2B, 0x57, 0x72, 0x32, 0x56, 0xB3, 0xD8,
+  0x88, 0x0F, 0x4D, 0x7F, 0x03, 0x56, 0x3D, 0xC3, 0xD5, 0x9A, 0xC2, 0x28, 0x29, 0x4E, 0xB0, 0x41,
+  0x7F, 0xF4, 0x55, 0x70, 0x4C, 0x14, 0x36, 0xA6, 0x2D, 0xBD, 0x0E, 0x95, 0xB8, 0x91, 0x52, 0x97,
+  0x28, 0xA3, 0x80, 0x42, 0x67, 0x86, 0x00, 0x7B, 0x8C, 0xFB, 0x47, 0x0F, 0xF2, 0x9B, 0x31, 0x86,
+  0xC8, 0x90, 0xEE, 0x9C, 0x93, 0xB0, 0x2C, 0x55, 0xDB, 0x3F, 0x2E, 0x43, 0xC3, 0x6C, 0x10, 0x2C,
+  0xDD, 0x9C, 0x91, 0x9E, 0x83, 0x22, 0xDB, 0xE4, 0x46, 0xCD, 0xC3, 0xAA, 0x4E, 0x19, 0x73, 0xFF,
+  0xCE, 0xF1, 0x7A, 0x73, 0xF8, 0x20, 0xF7, 0x33, 0xAB, 0xA7, 0xB0, 0x5A, 0x87, 0x02, 0xD0, 0x7A,
+  0x22, 0x1F, 0x22, 0x46, 0xD0, 0x03, 0x3F, 0xC1, 0x3C, 0x1A, 0x78, 0x17, 0x1C, 0x6F, 0x89, 0x29,
+  0x2B, 0xE9, 0x4E, 0x0C, 0x42, 0xF0, 0x5B, 0x6A, 0x28, 0x0D, 0x0A, 0x9C, 0x12, 0x8D, 0x83, 0x5B,
+  0x17, 0x32, 0x47, 0xCC, 0x44, 0xAE, 0x5D, 0x5C, 0x04, 0x0A, 0xCF, 0x42, 0xF9, 0xFA, 0x41, 0xDE,
+  0xAE, 0x9E, 0xFB, 0x53, 0x2D, 0x97, 0x6F, 0x4A, 0x0A, 0x39, 0xC2, 0xE0, 0xAA, 0xEB, 0x25, 0xBC,
+  0x86, 0x55, 0xA1, 0xC0, 0x6E, 0x4F, 0x75, 0x67, 0x5E, 0xDD, 0x69, 0x7C, 0x4E, 0x5C, 0x64, 0x48,
+  0xF9, 0x99, 0x9E, 0x41, 0xBD, 0x3B, 0x3E, 0x16, 0xFD, 0x9D, 0x21, 0x20, 0x08, 0xC2, 0x6E, 0x1C,
+  0xEE, 0x7A, 0xA0, 0x92, 0x56, 0xE5, 0x98, 0x04, 0x7C, 0x9D, 0xC0, 0x11, 0xFF, 0xFF, 0x94, 0x79,
+  0x9A, 0xC0
+};
+
+//
+// LZMA stream of TestPatternByte (0) .. TestPatternByte (SIZE_32KB - 1),
+// terminated by an end marker.
+//
+STATIC CONST UINT8  mHalfChunk[] = {
+  0x5D, 0x00, 0x00, 0x01, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+  0x0F, 0x57, 0x02, 0x68, 0xC6, 0x78, 0xCE, 0xD8, 0x0F, 0x90, 0xE6, 0xEB, 0xB6, 0xDD, 0x1F, 0x70,
+  0x62, 0xB0, 0x21, 0x27, 0x14, 0xF9, 0xB1, 0x95, 0x8A, 0x58, 0x60, 0x21, 0x7A, 0x2C, 0xAC, 0xE7,
+  0x77, 0x98, 0xDF, 0x45, 0x86, 0xDA, 0xAC, 0x69, 0x34, 0x69, 0x0D, 0x38, 0x64, 0x55, 0xE2, 0xB7,
+  0x18, 0x16, 0xAA, 0x44, 0x15, 0x99, 0xBE, 0xA2, 0x90, 0x8B, 0x09, 0xD6, 0x1F, 0xC9, 0x47, 0xFF,
+  0xEF, 0xDE, 0x9A, 0xC6, 0x8D, 0xBF, 0x33, 0xD9, 0xB5, 0xD4, 0x6A, 0xAF, 0x16, 0xED, 0xF4, 0x83,
+  0xBC, 0x69, 0x74, 0xD1, 0x23, 0xE6, 0xC7, 0x84, 0x1E, 0x12, 0x9B, 0xA6, 0x75, 0x90, 0x56, 0x90,
+  0x89, 0x72, 0x1A, 0x58, 0x7F, 0x5A, 0x3E, 0x80, 0x06, 0x4C, 0x56, 0x65, 0x3F, 0x78, 0xEB, 0xAD,
+  0xD7, 0xC6, 0x55, 0x3B, 0x1F, 0x67, 0xE3, 0xA8, 0x37, 0x8A, 0x19, 0x99, 0xF2, 0x4C, 0xE6, 0xA5,
+  0xCB, 0x00, 0x71, 0x89, 0x5B, 0xCF, 0x16, 0x23, 0x81, 0x92, 0xF1, 0xF7, 0x07, 0xBF, 0x9B, 0xEE,
+  0xDC, 0xFA, 0x16, 0x13, 0x0E, 0x51, 0xD0, 0x10, 0x69, 0x88, 0x3E, 0xDE, 0xE4, 0xBD, 0xC3, 0xA6,
+  0xE0, 0x95, 0x83, 0x2B, 0x4B, 0xA8, 0x95, 0x75, 0x98, 0x7A, 0x1B, 0x8A, 0x02, 0x74, 0x78, 0xA6,
+  0xA1, 0xFC, 0x6A, 0x60, 0xF0, 0xA5, 0xAD, 0x2A, 0xC8, 0x55, 0xC4, 0xCF, 0x2F, 0x06, 0x0F, 0x62,
+  0x1B, 0x9D, 0x85, 0xB9, 0x15, 0x1C, 0xC8, 0x9B, 0x94, 0x19, 0x66, 0xD4, 0x06, 0x20, 0x86, 0x26,
+  0xA3, 0xAD, 0x7C, 0x68, 0x84, 0x02, 0x2F, 0x7B, 0x8F, 0x2B, 0x57, 0x72, 0x32, 0x56, 0xB3, 0xD8,
+  0x88, 0x0F, 0x4D, 0x7F, 0x03, 0x56, 0x3D, 0xC3, 0xD5, 0x9A, 0xC2, 0x28, 0x29, 0x4E, 0xB0, 0x41,
+  0x7F, 0xF4, 0x55, 0x70, 0x4C, 0x14, 0x36, 0xA6, 0x2D, 0xBD, 0x0E, 0x95, 0xB8, 0x91, 0x52, 0x97,
+  0x28, 0xA3, 0x80, 0x42, 0x67, 0x86, 0x00, 0x7B, 0x8C, 0xFB, 0x47, 0x0F, 0xF2, 0x9B, 0x31, 0x86,
+  0xC8, 0x90, 0xEE, 0x9C, 0x93, 0xB0, 0x2C, 0x55, 0xDB, 0x3F, 0x2E, 0x43, 0xC3, 0x6C, 0x10, 0x2C,
+  0xDD, 0x9C, 0x91, 0x9E, 0x83, 0x22, 0xDB, 0xE4, 0x46, 0xCD, 0xC3, 0xAA, 0x4E, 0x19, 0x73, 0xFF,
+  0xCE, 0xF1, 0x7A, 0x73, 0xF8, 0x20, 0xF7, 0x33, 0xAB, 0xA7, 0xB0, 0x5A, 0x87, 0x02, 0xD0, 0x7A,
+  0x22, 0x1F, 0x22, 0x46, 0xD0, 0x03, 0x3F, 0xC1, 0x3C, 0x1A, 0x78, 0x17, 0x1C, 0x6F, 0x89, 0x29,
+  0x2B, 0xE9, 0x4E, 0x0C, 0x42, 0xF0, 0x5B, 0x6A, 0x28, 0x0D, 0x0A, 0x9C, 0x12, 0x8D, 0x83, 0x5B,
+  0x17, 0x32, 0x47, 0xCC, 0x44, 0xAE, 0x5D, 0x5B, 0x8D, 0x33, 0xBC, 0x1B, 0xFF, 0xFE, 0x04, 0x47,
+  0xF2
+};
+
+//
+// Offset of the 64-bit decoded size in the header of a LZMA stream
+//
+#define LZMA_DECODED_SIZE_OFFSET  5
+
+STATIC UINTN  mNumberOfEnabledProcessors;
+
+/**
+  Get the byte at Index of the data that every test chunk encodes.
+**/
+STATIC
+UINT8
+TestPatternByte (
+  IN UINTN  Index
+  )
+{
+  return (UINT8)((Index % 251) * 7 + Index / SIZE_4KB);
+}
+
+/**
+  Return the processors of the host: the BSP and one AP for each decoding thread.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestGetNumberOfProcessors (
+  IN  CONST EFI_PEI_SERVICES   **PeiServices,
+  IN  EFI_PEI_MP_SERVICES_PPI  *This,
+  OUT UINTN                    *NumberOfProcessors,
+  OUT UINTN                    *NumberOfEnabledProcessors
+  )
+{
+  *NumberOfProcessors        = mNumberOfEnabledProcessors;
+  *NumberOfEnabledProcessors = mNumberOfEnabledProcessors;
+  return EFI_SUCCESS;
+}
+
+/**
+  Run Procedure on one host thread for each AP, and wait for all of them.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestStartupAllAPs (
+  IN  CONST EFI_PEI_SERVICES   **PeiServices,
+  IN  EFI_PEI_MP_SERVICES_PPI  *This,
+  IN  EFI_AP_PROCEDURE         Procedure,
+  IN  BOOLEAN                  SingleThread,
+  IN  UINTN                    TimeoutInMicroSeconds,
+  IN  VOID                     *ProcedureArgument      OPTIONAL
+  )
+{
+  std::vector<std::thread>  Aps;
+
+  for (UINTN Index = 1; Index < mNumberOfEnabledProcessors; Index++) {
+    Aps.emplace_back ([Procedure, ProcedureArgument]() { Procedure (ProcedureArgument); });
+  }
+
+  for (std::thread &Ap : Aps) {
+    Ap.join ();
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_PEI_MP_SERVICES_PPI  mTestMpServices = {
+  TestGetNumberOfProcessors,
+  NULL,
+  TestStartupAllAPs,
+  NULL,
+  NULL,
+  NULL,
+  NULL
+};
+
+STATIC EFI_PEI_PPI_DESCRIPTOR  mTestMpServicesPpiList = {
+  EFI_PEI_PPI_DESCRIPTOR_PPI | EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST,
+  &gEfiPeiMpServicesPpiGuid,
+  &mTestMpServices
+};
+
+/**
+  The section handlers are called directly by the tests.
+**/
+RETURN_STATUS
+EFIAPI
+ExtractGuidedSectionRegisterHandlers (
+  IN CONST  GUID                                     *SectionGuid,
+  IN        EXTRACT_GUIDED_SECTION_GET_INFO_HANDLER  GetInfoHandler,
+  IN        EXTRACT_GUIDED_SECTION_DECODE_HANDLER    DecodeHandler
+  )
+{
+  return RETURN_SUCCESS;
+}
+
+class LzmaChunkedDecompressTest : public TestWithParam<UINTN> {
+protected:
+  std::vector<std::vector<UINT8> >  Chunks;
+  UINT32                            DecodedSize;
+
+  void
+  SetUp (
+    ) override
+  {
+    //
+    // Full chunks, and a half chunk at the end
+    //
+    for (UINTN Index = 0; Index < TEST_CHUNK_COUNT; Index++) {
+      Chunks.emplace_back (mFullChunk, mFullChunk + sizeof (mFullChunk));
+    }
+
+    Chunks.emplace_back (mHalfChunk, mHalfChunk + sizeof (mHalfChunk));
+    DecodedSize = TEST_CHUNK_COUNT * TEST_CHUNK_SIZE + SIZE_32KB;
+
+    //
+    // The APs decode the chunks while the BSP waits
+    //
+    mNumberOfEnabledProcessors = GetParam () + 1;
+  }
+
+  /**
+    Set the decoded size in the LZMA header of a chunk.
+  **/
+  static void
+  SetChunkDecodedSize (
+    std::vector<UINT8>  &Chunk,
+    UINT64              Size
+    )
+  {
+    WriteUnaligned64 ((UINT64 *)&Chunk[LZMA_DECODED_SIZE_OFFSET], Size);
+  }
+
+  /**
+    Build a LZMA chunked GUIDed section of the chunks and decode it.
+
+    The output buffer is followed by guard bytes that must stay untouched.
+    The time that the extraction takes is returned in Time.
+  **/
+  RETURN_STATUS
+  Decode (
+    std::vector<UINT8>         &Output,
+    std::chrono::microseconds  &Time
+    )
+  {
+    std::vector<UINT8>        Section;
+    std::vector<UINT8>        Scratch;
+    EFI_GUID_DEFINED_SECTION  *GuidedSection;
+    LZMA_CHUNKED_HEADER       Header;
+    RETURN_STATUS             Status;
+    UINT32                    OutputSize;
+    UINT32                    ScratchSize;
+    UINT16                    Attributes;
+    UINT32                    AuthenticationStatus;
+    VOID                      *OutputBuffer;
+
+    Section.resize (sizeof (EFI_GUID_DEFINED_SECTION) + sizeof (LZMA_CHUNKED_HEADER) + Chunks.size () * sizeof (UINT32));
+    Header.Signature   = LZMA_CHUNKED_SIGNATURE;
+    Header.ChunkSize   = TEST_CHUNK_SIZE;
+    Header.ChunkCount  = (UINT32)Chunks.size ();
+    Header.DecodedSize = DecodedSize;
+    CopyMem (&Section[sizeof (EFI_GUID_DEFINED_SECTION)], &Header, sizeof (Header));
+    for (UINTN Index = 0; Index < Chunks.size (); Index++) {
+      WriteUnaligned32 (
+        (UINT32 *)&Section[sizeof (EFI_GUID_DEFINED_SECTION) + sizeof (Header)] + Index,
+        (UINT32)Chunks[Index].size ()
+        );
+      Section.insert (Section.end (), Chunks[Index].begin (), Chunks[Index].end ());
+    }
+
+    GuidedSection = (EFI_GUID_DEFINED_SECTION *)Section.data ();
+    GuidedSection->CommonHeader.Type = EFI_SECTION_GUID_DEFINED;
+    GuidedSection->CommonHeader.Size[0] = (UINT8)Section.size ();
+    GuidedSection->CommonHeader.Size[1] = (UINT8)(Section.size () >> 8);
+    GuidedSection->CommonHeader.Size[2] = (UINT8)(Section.size () >> 16);
+    CopyGuid (&GuidedSection->SectionDefinitionGuid, &gLzmaChunkedCustomDecompressGuid);
+    GuidedSection->DataOffset = sizeof (EFI_GUID_DEFINED_SECTION);
+    GuidedSection->Attributes = EFI_GUIDED_SECTION_PROCESSING_REQUIRED;
+
+    Status = LzmaChunkedGuidedSectionGetInfo (Section.data (), &OutputSize, &ScratchSize, &Attributes);
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
+
+    EXPECT_EQ (OutputSize, DecodedSize);
+    Output.assign (OutputSize + TEST_GUARD_SIZE, 0xCC);
+    Scratch.resize (ScratchSize);
+    OutputBuffer = Output.data ();
+
+    auto  Start = std::chrono::steady_clock::now ();
+
+    Status = LzmaChunkedGuidedSectionExtraction (Section.data (), &OutputBuffer, Scratch.data (), &AuthenticationStatus);
+    Time   = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now () - Start);
+    return Status;
+  }
+
+  RETURN_STATUS
+  Decode (
+    std::vector<UINT8>  &Output
+    )
+  {
+    std::chrono::microseconds  Time;
+
+    return Decode (Output, Time);
+  }
+
+  /**
+    Check that the guard bytes after the output buffer are untouched.
+  **/
+  void
+  ExpectGuardIntact (
+    CONST std::vector<UINT8>  &Output
+    )
+  {
+    for (UINTN Index = DecodedSize; Index < Output.size (); Index++) {
+      ASSERT_EQ (Output[Index], 0xCC) << "at " << Index;
+    }
+  }
+};
+
+//
+// Decode all chunks, check the output and report the decoding time.
+//
+TEST_P (LzmaChunkedDecompressTest, DecodesAllChunks) {
+  std::vector<UINT8>         Output;
+  std::chrono::microseconds  Time;
+  RETURN_STATUS              Status;
+  UINTN                      Index;
+
+  Status = Decode (Output, Time);
+  ASSERT_EQ (Status, RETURN_SUCCESS);
+  for (Index = 0; Index < DecodedSize; Index++) {
+    ASSERT_EQ (Output[Index], TestPatternByte (Index % TEST_CHUNK_SIZE)) << "at " << Index;
+  }
+
+  ExpectGuardIntact (Output);
+  printf (
+    "%u threads: %u chunks, %u KB in %llu us\n",
+    (UINT32)GetParam (),
+    (UINT32)Chunks.size (),
+    DecodedSize / SIZE_1KB,
+    (UINT64)Time.count ()
+    );
+}
+
+//
+// A chunk whose LZMA header does not match its part of the output buffer
+// is rejected before it is decoded.
+//
+TEST_P (LzmaChunkedDecompressTest, RejectsChunkHeaderMismatch) {
+  std::vector<UINT8>  Output;
+
+  SetChunkDecodedSize (Chunks[TEST_CHUNK_COUNT / 2], TEST_CHUNK_SIZE + 1);
+  EXPECT_EQ (Decode (Output), RETURN_INVALID_PARAMETER);
+
+  SetChunkDecodedSize (Chunks[TEST_CHUNK_COUNT / 2], TEST_CHUNK_SIZE - 1);
+  EXPECT_EQ (Decode (Output), RETURN_INVALID_PARAMETER);
+}
+
+//
+// A chunk whose header matches, but whose stream ends early, would leave a
+// hole in the output buffer.
+//
+TEST_P (LzmaChunkedDecompressTest, RejectsChunkThatEndsEarly) {
+  std::vector<UINT8>  Output;
+
+  Chunks[TEST_CHUNK_COUNT / 2].assign (mHalfChunk, mHalfChunk + sizeof (mHalfChunk));
+  SetChunkDecodedSize (Chunks[TEST_CHUNK_COUNT / 2], TEST_CHUNK_SIZE);
+  EXPECT_EQ (Decode (Output), RETURN_INVALID_PARAMETER);
+}
+
+//
+// A chunk whose header matches, but whose stream holds more data, must not
+// write past its part of the output buffer.
+//
+TEST_P (LzmaChunkedDecompressTest, RejectsChunkThatRunsOver) {
+  std::vector<UINT8>  Output;
+
+  Chunks.back ().assign (mFullChunk, mFullChunk + sizeof (mFullChunk));
+  SetChunkDecodedSize (Chunks.back (), SIZE_32KB);
+  EXPECT_EQ (Decode (Output), RETURN_INVALID_PARAMETER);
+  ExpectGuardIntact (Output);
+}
+
+INSTANTIATE_TEST_SUITE_P (
+  Threads,
+  LzmaChunkedDecompressTest,
+  Values (1, 4, 16)
+  );
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = PeiServicesInstallPpi (&mTestMpServicesPpiList);
+  if (EFI_ERROR (Status)) {
+    return 1;
+  }
+
+  testing::InitGoogleTest (&argc, argv);
+  return RUN_ALL_TESTS ();
+}
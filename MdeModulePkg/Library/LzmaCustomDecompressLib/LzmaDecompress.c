@@ -218,3 +218,74 @@ LzmaUefiDecompress (
     return RETURN_INVALID_PARAMETER;
   }
 }
+
+/**
+  Decompresses a Lzma compressed source buffer that must decode to exactly
+  DestinationSize bytes.
+
+  Unlike LzmaUefiDecompress(), the decoded size in the header of Source is
+  checked against DestinationSize before anything is written to Destination,
+  and the decoder never writes more than DestinationSize bytes. A stream that
+  ends early is rejected as well.
+
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size of source buffer.
+  @param  Destination     The destination buffer to store the decompressed data.
+  @param  DestinationSize The size, in bytes, of the destination buffer.
+  @param  Scratch         A temporary scratch buffer that is used to perform the decompression.
+
+  @retval  RETURN_SUCCESS Decompression completed successfully, and exactly
+                          DestinationSize bytes were returned in Destination.
+  @retval  RETURN_INVALID_PARAMETER
+                          The source buffer specified by Source is corrupted
+                          (not in a valid compressed format), or it does not
+                          decode to DestinationSize bytes.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaUefiDecompressToSize (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN UINTN       DestinationSize,
+  IN OUT VOID    *Scratch
+  )
+{
+  SRes              LzmaResult;
+  ELzmaStatus       Status;
+  SizeT             DecodedBufSize;
+  SizeT             EncodedDataSize;
+  ISzAllocWithData  AllocFuncs;
+
+  if ((SourceSize < LZMA_HEADER_SIZE) ||
+      (GetDecodedSizeOfBuf ((UINT8 *)Source) != DestinationSize))
+  {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  AllocFuncs.Functions.Alloc = SzAlloc;
+  AllocFuncs.Functions.Free  = SzFree;
+  AllocFuncs.Buffer          = Scratch;
+  AllocFuncs.BufferSize      = SCRATCH_BUFFER_REQUEST_SIZE;
+
+  DecodedBufSize  = (SizeT)DestinationSize;
+  EncodedDataSize = (SizeT)(SourceSize - LZMA_HEADER_SIZE);
+
+  LzmaResult = LzmaDecode (
+                 Destination,
+                 &DecodedBufSize,
+                 (Byte *)((UINT8 *)Source + LZMA_HEADER_SIZE),
+                 &EncodedDataSize,
+                 Source,
+                 LZMA_PROPS_SIZE,
+                 LZMA_FINISH_END,
+                 &Status,
+                 &(AllocFuncs.Functions)
+                 );
+
+  if ((LzmaResult != SZ_OK) || (DecodedBufSize != DestinationSize)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return RETURN_SUCCESS;
+}
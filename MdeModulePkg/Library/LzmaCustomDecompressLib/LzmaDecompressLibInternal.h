@@ -91,4 +91,48 @@ LzmaUefiDecompress (
   IN OUT VOID    *Scratch
   );
 
+/**
+  Decompresses a Lzma compressed source buffer that must decode to exactly
+  DestinationSize bytes.
+
+  Unlike LzmaUefiDecompress(), the decoded size in the header of Source is
+  checked against DestinationSize before anything is written to Destination,
+  and the decoder never writes more than DestinationSize bytes. A stream that
+  ends early is rejected as well.
+
+  @param  Source          The source buffer containing the compressed data.
+  @param  SourceSize      The size of source buffer.
+  @param  Destination     The destination buffer to store the decompressed data.
+  @param  DestinationSize The size, in bytes, of the destination buffer.
+  @param  Scratch         A temporary scratch buffer that is used to perform the decompression.
+
+  @retval  RETURN_SUCCESS Decompression completed successfully, and exactly
+                          DestinationSize bytes were returned in Destination.
+  @retval  RETURN_INVALID_PARAMETER
+                          The source buffer specified by Source is corrupted
+                          (not in a valid compressed format), or it does not
+                          decode to DestinationSize bytes.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaUefiDecompressToSize (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN UINTN       DestinationSize,
+  IN OUT VOID    *Scratch
+  );
+
+/**
+  Register LzmaDecompress and LzmaDecompressGetInfo handlers with LzmaCustomerDecompressGuid.
+
+  @retval  RETURN_SUCCESS            Register successfully.
+  @retval  RETURN_OUT_OF_RESOURCES   No enough memory to store this handler.
+**/
+EFI_STATUS
+EFIAPI
+LzmaDecompressLibConstructor (
+  VOID
+  );
+
 #endif
@@ -1568,6 +1568,102 @@ SetHiiVariable (
   return Status;
 }
 
+/**
+  Hash a DynamicEx PCD key the way the build tool does for the ExMap hash table.
+
+  @param Seed            Hash seed.
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Dynamic-ex PCD token number.
+
+  @return The hash of the seed, the GUID and the token number.
+
+**/
+STATIC
+UINT32
+PcdExMapHash (
+  IN UINT32          Seed,
+  IN CONST EFI_GUID  *Guid,
+  IN UINT32          ExTokenNumber
+  )
+{
+  UINT32       Hash;
+  UINTN        Index;
+  CONST UINT8  *Bytes;
+
+  Hash = PCD_EXMAP_HASH_OFFSET_BASIS;
+  for (Index = 0; Index < sizeof (UINT32); Index++) {
+    Hash = (Hash ^ (UINT8)(Seed >> (Index * 8))) * PCD_EXMAP_HASH_PRIME;
+  }
+
+  Bytes = (CONST UINT8 *)Guid;
+  for (Index = 0; Index < sizeof (EFI_GUID); Index++) {
+    Hash = (Hash ^ Bytes[Index]) * PCD_EXMAP_HASH_PRIME;
+  }
+
+  for (Index = 0; Index < sizeof (UINT32); Index++) {
+    Hash = (Hash ^ (UINT8)(ExTokenNumber >> (Index * 8))) * PCD_EXMAP_HASH_PRIME;
+  }
+
+  Hash ^= Hash >> 16;
+  Hash *= 0x85EBCA6B;
+  Hash ^= Hash >> 13;
+  Hash *= 0xC2B2AE35;
+  Hash ^= Hash >> 16;
+
+  return Hash;
+}
+
+/**
+  Look up a dynamic-ex PCD in the ExMap hash table of a PCD database.
+
+  @param Database        PCD database that has an ExMap hash table.
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Dynamic-ex PCD token number.
+
+  @return Token Number for dynamic-ex PCD, or PCD_INVALID_TOKEN_NUMBER if the
+          database does not hold the PCD.
+
+**/
+STATIC
+UINTN
+PcdExMapHashLookup (
+  IN PCD_DATABASE_INIT  *Database,
+  IN CONST EFI_GUID     *Guid,
+  IN UINT32             ExTokenNumber
+  )
+{
+  UINT32             *HashTable;
+  UINT32             BucketCount;
+  UINT32             Displacement;
+  UINT32             Slot;
+  DYNAMICEX_MAPPING  *ExMap;
+  EFI_GUID           *GuidTable;
+
+  if (Database->ExTokenCount == 0) {
+    return PCD_INVALID_TOKEN_NUMBER;
+  }
+
+  HashTable    = (UINT32 *)((UINT8 *)Database + Database->ExMapHashTableOffset);
+  BucketCount  = HashTable[0];
+  Displacement = HashTable[1 + PcdExMapHash (0, Guid, ExTokenNumber) % BucketCount];
+  if ((Displacement & PCD_EXMAP_HASH_DIRECT) != 0) {
+    Slot = Displacement & ~PCD_EXMAP_HASH_DIRECT;
+  } else {
+    Slot = PcdExMapHash (Displacement, Guid, ExTokenNumber) % Database->ExTokenCount;
+  }
+
+  ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)Database + Database->ExMapTableOffset);
+  ExMap    += HashTable[1 + BucketCount + Slot];
+  GuidTable = (EFI_GUID *)((UINT8 *)Database + Database->GuidTableOffset);
+  if ((ExMap->ExTokenNumber == ExTokenNumber) &&
+      CompareGuid (&GuidTable[ExMap->ExGuidIndex], Guid))
+  {
+    return ExMap->TokenNumber;
+  }
+
+  return PCD_INVALID_TOKEN_NUMBER;
+}
+
 /**
   Get Token Number according to dynamic-ex PCD's {token space guid:token number}
 
@@ -1592,8 +1688,14 @@ GetExPcdTokenNumber (
   EFI_GUID           *GuidTable;
   EFI_GUID           *MatchGuid;
   UINTN              MatchGuidIdx;
+  UINTN              TokenNumber;
 
-  if (!mPeiDatabaseEmpty) {
+  if (!mPeiDatabaseEmpty && (mPcdDatabase.PeiDb->ExMapHashTableOffset != 0)) {
+    TokenNumber = PcdExMapHashLookup (mPcdDatabase.PeiDb, Guid, ExTokenNumber);
+    if (TokenNumber != PCD_INVALID_TOKEN_NUMBER) {
+      return TokenNumber;
+    }
+  } else if (!mPeiDatabaseEmpty) {
     ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)mPcdDatabase.PeiDb + mPcdDatabase.PeiDb->ExMapTableOffset);
     GuidTable = (EFI_GUID *)((UINT8 *)mPcdDatabase.PeiDb + mPcdDatabase.PeiDb->GuidTableOffset);
 
@@ -1612,23 +1714,30 @@ GetExPcdTokenNumber (
     }
   }
 
-  ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)mPcdDatabase.DxeDb + mPcdDatabase.DxeDb->ExMapTableOffset);
-  GuidTable = (EFI_GUID *)((UINT8 *)mPcdDatabase.DxeDb + mPcdDatabase.DxeDb->GuidTableOffset);
+  if (mPcdDatabase.DxeDb->ExMapHashTableOffset != 0) {
+    TokenNumber = PcdExMapHashLookup (mPcdDatabase.DxeDb, Guid, ExTokenNumber);
+    if (TokenNumber != PCD_INVALID_TOKEN_NUMBER) {
+      return TokenNumber;
+    }
+  } else {
+    ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)mPcdDatabase.DxeDb + mPcdDatabase.DxeDb->ExMapTableOffset);
+    GuidTable = (EFI_GUID *)((UINT8 *)mPcdDatabase.DxeDb + mPcdDatabase.DxeDb->GuidTableOffset);
 
-  MatchGuid = ScanGuid (GuidTable, mDxeGuidTableSize, Guid);
-  //
-  // We need to ASSERT here. If GUID can't be found in GuidTable, this is a
-  // error in the BUILD system.
-  //
-  ASSERT (MatchGuid != NULL);
+    MatchGuid = ScanGuid (GuidTable, mDxeGuidTableSize, Guid);
+    //
+    // We need to ASSERT here. If GUID can't be found in GuidTable, this is a
+    // error in the BUILD system.
+    //
+    ASSERT (MatchGuid != NULL);
 
-  MatchGuidIdx = MatchGuid - GuidTable;
+    MatchGuidIdx = MatchGuid - GuidTable;
 
-  for (Index = 0; Index < mPcdDatabase.DxeDb->ExTokenCount; Index++) {
-    if ((ExTokenNumber == ExMap[Index].ExTokenNumber) &&
-        (MatchGuidIdx == ExMap[Index].ExGuidIndex))
-    {
-      return ExMap[Index].TokenNumber;
+    for (Index = 0; Index < mPcdDatabase.DxeDb->ExTokenCount; Index++) {
+      if ((ExTokenNumber == ExMap[Index].ExTokenNumber) &&
+          (MatchGuidIdx == ExMap[Index].ExGuidIndex))
+      {
+        return ExMap[Index].TokenNumber;
+      }
     }
   }
 
@@ -959,6 +959,102 @@ GetWorker (
   return NULL;
 }
 
+/**
+  Hash a DynamicEx PCD key the way the build tool does for the ExMap hash table.
+
+  @param Seed            Hash seed.
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Dynamic-ex PCD token number.
+
+  @return The hash of the seed, the GUID and the token number.
+
+**/
+STATIC
+UINT32
+PcdExMapHash (
+  IN UINT32          Seed,
+  IN CONST EFI_GUID  *Guid,
+  IN UINT32          ExTokenNumber
+  )
+{
+  UINT32       Hash;
+  UINTN        Index;
+  CONST UINT8  *Bytes;
+
+  Hash = PCD_EXMAP_HASH_OFFSET_BASIS;
+  for (Index = 0; Index < sizeof (UINT32); Index++) {
+    Hash = (Hash ^ (UINT8)(Seed >> (Index * 8))) * PCD_EXMAP_HASH_PRIME;
+  }
+
+  Bytes = (CONST UINT8 *)Guid;
+  for (Index = 0; Index < sizeof (EFI_GUID); Index++) {
+    Hash = (Hash ^ Bytes[Index]) * PCD_EXMAP_HASH_PRIME;
+  }
+
+  for (Index = 0; Index < sizeof (UINT32); Index++) {
+    Hash = (Hash ^ (UINT8)(ExTokenNumber >> (Index * 8))) * PCD_EXMAP_HASH_PRIME;
+  }
+
+  Hash ^= Hash >> 16;
+  Hash *= 0x85EBCA6B;
+  Hash ^= Hash >> 13;
+  Hash *= 0xC2B2AE35;
+  Hash ^= Hash >> 16;
+
+  return Hash;
+}
+
+/**
+  Look up a dynamic-ex PCD in the ExMap hash table of a PCD database.
+
+  @param Database        PCD database that has an ExMap hash table.
+  @param Guid            Token space guid for dynamic-ex PCD entry.
+  @param ExTokenNumber   Dynamic-ex PCD token number.
+
+  @return Token Number for dynamic-ex PCD, or PCD_INVALID_TOKEN_NUMBER if the
+          database does not hold the PCD.
+
+**/
+STATIC
+UINTN
+PcdExMapHashLookup (
+  IN PCD_DATABASE_INIT  *Database,
+  IN CONST EFI_GUID     *Guid,
+  IN UINT32             ExTokenNumber
+  )
+{
+  UINT32             *HashTable;
+  UINT32             BucketCount;
+  UINT32             Displacement;
+  UINT32             Slot;
+  DYNAMICEX_MAPPING  *ExMap;
+  EFI_GUID           *GuidTable;
+
+  if (Database->ExTokenCount == 0) {
+    return PCD_INVALID_TOKEN_NUMBER;
+  }
+
+  HashTable    = (UINT32 *)((UINT8 *)Database + Database->ExMapHashTableOffset);
+  BucketCount  = HashTable[0];
+  Displacement = HashTable[1 + PcdExMapHash (0, Guid, ExTokenNumber) % BucketCount];
+  if ((Displacement & PCD_EXMAP_HASH_DIRECT) != 0) {
+    Slot = Displacement & ~PCD_EXMAP_HASH_DIRECT;
+  } else {
+    Slot = PcdExMapHash (Displacement, Guid, ExTokenNumber) % Database->ExTokenCount;
+  }
+
+  ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)Database + Database->ExMapTableOffset);
+  ExMap    += HashTable[1 + BucketCount + Slot];
+  GuidTable = (EFI_GUID *)((UINT8 *)Database + Database->GuidTableOffset);
+  if ((ExMap->ExTokenNumber == ExTokenNumber) &&
+      CompareGuid (&GuidTable[ExMap->ExGuidIndex], Guid))
+  {
+    return ExMap->TokenNumber;
+  }
+
+  return PCD_INVALID_TOKEN_NUMBER;
+}
+
 /**
   Get Token Number according to dynamic-ex PCD's {token space guid:token number}
 
@@ -987,6 +1083,10 @@ GetExPcdTokenNumber (
 
   PeiPcdDb = GetPcdDatabase ();
 
+  if (PeiPcdDb->ExMapHashTableOffset != 0) {
+    return PcdExMapHashLookup (PeiPcdDb, Guid, (UINT32)ExTokenNumber);
+  }
+
   ExMap     = (DYNAMICEX_MAPPING *)((UINT8 *)PeiPcdDb + PeiPcdDb->ExMapTableOffset);
   GuidTable = (EFI_GUID *)((UINT8 *)PeiPcdDb + PeiPcdDb->GuidTableOffset);
 
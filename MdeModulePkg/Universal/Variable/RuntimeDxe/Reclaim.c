@@ -8,6 +8,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "Variable.h"
+#include "VariableParsing.h"
 
 /**
   Gets LBA of block and offset by given address.
@@ -105,12 +106,44 @@ FtwVariableSpace (
   IN EFI_PHYSICAL_ADDRESS   VariableBase,
   IN VARIABLE_STORE_HEADER  *VariableBuffer
   )
+{
+  UINTN  FtwBufferSize;
+
+  FtwBufferSize = ((VARIABLE_STORE_HEADER *)((UINTN)VariableBase))->Size;
+  ASSERT (FtwBufferSize == VariableBuffer->Size);
+
+  return FtwVariableSpaceRange (VariableBase, 0, FtwBufferSize, (UINT8 *)VariableBuffer);
+}
+
+/**
+  Writes a buffer to a range of the variable storage space, in the working block.
+
+  This function writes a buffer to the variable storage space at the given
+  offset. Fault Tolerant Write protocol is used for writing, so the range is
+  either completely updated or left untouched when power is lost.
+
+  @param  VariableBase   Base address of the variable store.
+  @param  Offset         Offset of the range from VariableBase.
+  @param  Length         Length of the range in bytes.
+  @param  Buffer         Point to the new content of the range.
+
+  @retval EFI_SUCCESS    The function completed successfully.
+  @retval EFI_NOT_FOUND  Fail to locate Fault Tolerant Write protocol.
+  @retval EFI_ABORTED    The function could not complete successfully.
+
+**/
+EFI_STATUS
+FtwVariableSpaceRange (
+  IN EFI_PHYSICAL_ADDRESS  VariableBase,
+  IN UINTN                 Offset,
+  IN UINTN                 Length,
+  IN UINT8                 *Buffer
+  )
 {
   EFI_STATUS                         Status;
   EFI_HANDLE                         FvbHandle;
   EFI_LBA                            VarLba;
   UINTN                              VarOffset;
-  UINTN                              FtwBufferSize;
   EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *FtwProtocol;
 
   //
@@ -132,26 +165,122 @@ FtwVariableSpace (
   //
   // Get LBA and Offset by address.
   //
-  Status = GetLbaAndOffsetByAddress (VariableBase, &VarLba, &VarOffset);
+  Status = GetLbaAndOffsetByAddress (VariableBase + Offset, &VarLba, &VarOffset);
   if (EFI_ERROR (Status)) {
     return EFI_ABORTED;
   }
 
-  FtwBufferSize = ((VARIABLE_STORE_HEADER *)((UINTN)VariableBase))->Size;
-  ASSERT (FtwBufferSize == VariableBuffer->Size);
-
   //
   // FTW write record.
   //
   Status = FtwProtocol->Write (
                           FtwProtocol,
-                          VarLba,                // LBA
-                          VarOffset,             // Offset
-                          FtwBufferSize,         // NumBytes
-                          NULL,                  // PrivateData NULL
-                          FvbHandle,             // Fvb Handle
-                          (VOID *)VariableBuffer // write buffer
+                          VarLba,         // LBA
+                          VarOffset,      // Offset
+                          Length,         // NumBytes
+                          NULL,           // PrivateData NULL
+                          FvbHandle,      // Fvb Handle
+                          (VOID *)Buffer  // write buffer
                           );
 
   return Status;
 }
+
+/**
+  Check whether Reclaim () keeps a VAR_IN_DELETED_TRANSITION record.
+
+  Reclaim () promotes such a record to VAR_ADDED unless the store holds a
+  VAR_ADDED record of the same variable, or an earlier VAR_IN_DELETED_TRANSITION
+  record of it that was promoted first.
+
+  @param[in] VariableStoreHeader  Pointer to the variable store.
+  @param[in] Variable             Pointer to the VAR_IN_DELETED_TRANSITION record.
+  @param[in] AuthFormat           TRUE indicates authenticated variables are used.
+                                  FALSE indicates authenticated variables are not used.
+
+  @retval TRUE   Reclaim () keeps the record.
+  @retval FALSE  Reclaim () drops the record.
+
+**/
+STATIC
+BOOLEAN
+IsInDeletedVariableKept (
+  IN VARIABLE_STORE_HEADER  *VariableStoreHeader,
+  IN VARIABLE_HEADER        *Variable,
+  IN BOOLEAN                AuthFormat
+  )
+{
+  VARIABLE_HEADER  *OtherVariable;
+  UINTN            NameSize;
+
+  NameSize      = NameSizeOfVariable (Variable, AuthFormat);
+  OtherVariable = GetStartPointer (VariableStoreHeader);
+  while (IsValidVariableHeader (OtherVariable, GetEndPointer (VariableStoreHeader))) {
+    if (((OtherVariable->State == VAR_ADDED) ||
+         ((OtherVariable < Variable) && (OtherVariable->State == Variable->State))) &&
+        (NameSizeOfVariable (OtherVariable, AuthFormat) == NameSize) &&
+        CompareGuid (GetVendorGuidPtr (OtherVariable, AuthFormat), GetVendorGuidPtr (Variable, AuthFormat)) &&
+        (CompareMem (GetVariableNamePtr (OtherVariable, AuthFormat), GetVariableNamePtr (Variable, AuthFormat), NameSize) == 0))
+    {
+      return FALSE;
+    }
+
+    OtherVariable = GetNextVariablePtr (OtherVariable, AuthFormat);
+  }
+
+  return TRUE;
+}
+
+/**
+  Recalculate the total sizes of the variables of the non-volatile variable
+  store from the records that Reclaim () keeps.
+
+  Like Reclaim (), only VAR_ADDED records and the VAR_IN_DELETED_TRANSITION
+  records that Reclaim () would promote are counted. Deleted records, including
+  the filler records of the incremental reclaim, are not.
+
+  @param[in] VariableStoreHeader  Pointer to the non-volatile variable store.
+
+  @return Offset of the end of the last variable record in the store.
+
+**/
+UINTN
+RecalculateNvVariableTotalSize (
+  IN VARIABLE_STORE_HEADER  *VariableStoreHeader
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  VARIABLE_HEADER  *NextVariable;
+  UINTN            VariableSize;
+  BOOLEAN          AuthFormat;
+
+  AuthFormat                                         = mVariableModuleGlobal->VariableGlobal.AuthFormat;
+  mVariableModuleGlobal->HwErrVariableTotalSize      = 0;
+  mVariableModuleGlobal->CommonVariableTotalSize     = 0;
+  mVariableModuleGlobal->CommonUserVariableTotalSize = 0;
+  Variable                                           = GetStartPointer (VariableStoreHeader);
+  while (IsValidVariableHeader (Variable, GetEndPointer (VariableStoreHeader))) {
+    NextVariable = GetNextVariablePtr (Variable, AuthFormat);
+    VariableSize = (UINTN)NextVariable - (UINTN)Variable;
+    if ((Variable->State != VAR_ADDED) &&
+        ((Variable->State != (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) ||
+         !IsInDeletedVariableKept (VariableStoreHeader, Variable, AuthFormat)))
+    {
+      Variable = NextVariable;
+      continue;
+    }
+
+    if ((Variable->Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) == EFI_VARIABLE_HARDWARE_ERROR_RECORD) {
+      mVariableModuleGlobal->HwErrVariableTotalSize += VariableSize;
+    } else {
+      mVariableModuleGlobal->CommonVariableTotalSize += VariableSize;
+      if (IsUserVariable (Variable)) {
+        mVariableModuleGlobal->CommonUserVariableTotalSize += VariableSize;
+      }
+    }
+
+    Variable = NextVariable;
+  }
+
+  return (UINTN)Variable - (UINTN)VariableStoreHeader;
+}
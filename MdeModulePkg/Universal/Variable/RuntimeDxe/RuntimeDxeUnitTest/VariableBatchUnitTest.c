@@ -0,0 +1,1149 @@
+/** @file
+  This is a host-based unit test for VariableServiceSetVariableBatch (). The
+  driver runs on a memory flash device, with a fault tolerant write stand-in
+  that can lose power in the middle of a write.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../Variable.h"
+#include "../VariableIndex.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "Variable Batch Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_BLOCK_SIZE        SIZE_4KB
+#define TEST_BLOCK_COUNT       16
+#define TEST_FLASH_SIZE        (TEST_BLOCK_SIZE * TEST_BLOCK_COUNT)
+#define TEST_FV_HEADER_LENGTH  (sizeof (EFI_FIRMWARE_VOLUME_HEADER) + sizeof (EFI_FV_BLOCK_MAP_ENTRY))
+#define TEST_ATTRIBUTES        (EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS)
+#define TEST_FILL_SIZE         0x200
+#define TEST_FILL_COUNT        (TEST_FLASH_SIZE / TEST_FILL_SIZE)
+
+#define TEST_POWER_LOSS_NONE    0
+#define TEST_POWER_LOSS_SPARE   1
+#define TEST_POWER_LOSS_TARGET  2
+
+//
+// Test variable GUID {5E0B7C1A-8F43-4D26-A9B5-3C71E2D4F086}
+//
+EFI_GUID  mTestGuid = {
+  0x5e0b7c1a, 0x8f43, 0x4d26, { 0xa9, 0xb5, 0x3c, 0x71, 0xe2, 0xd4, 0xf0, 0x86 }
+};
+
+UINT8  mTestFlash[TEST_FLASH_SIZE];
+UINT8  mTestFlashCopy[TEST_FLASH_SIZE];
+UINT8  mTestFillData[TEST_FILL_SIZE];
+
+///
+/// The pending write of the fault tolerant write stand-in, as it is kept in
+/// the spare block until the target blocks are written.
+///
+BOOLEAN  mTestFtwPending;
+UINT8    *mTestFtwTarget;
+UINTN    mTestFtwLength;
+UINT8    mTestFtwSpare[TEST_FLASH_SIZE];
+
+UINTN  mTestPowerLoss;
+UINTN  mTestFtwWrites;
+UINTN  mTestFtwBytes;
+UINTN  mTestSecureBootHooks;
+
+EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  mTestFvb;
+EFI_FAULT_TOLERANT_WRITE_PROTOCOL   mTestFtw;
+EFI_HANDLE                          mTestFvbHandle = (EFI_HANDLE)&mTestFvb;
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Nothing in this test runs after ExitBootServices ().
+
+  @retval FALSE   Always.
+**/
+BOOLEAN
+AtRuntime (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+/**
+  The test is single threaded.
+
+  @param[in, out] Lock      Not used.
+  @param[in]      Priority  Not used.
+
+  @return Lock.
+**/
+EFI_LOCK *
+InitializeLock (
+  IN OUT EFI_LOCK  *Lock,
+  IN EFI_TPL       Priority
+  )
+{
+  return Lock;
+}
+
+/**
+  The test is single threaded.
+
+  @param[in] Lock   Not used.
+**/
+VOID
+AcquireLockOnlyAtBootTime (
+  IN EFI_LOCK  *Lock
+  )
+{
+}
+
+/**
+  The test is single threaded.
+
+  @param[in] Lock   Not used.
+**/
+VOID
+ReleaseLockOnlyAtBootTime (
+  IN EFI_LOCK  *Lock
+  )
+{
+}
+
+/**
+  Stand-in for the fault tolerant write protocol lookup.
+
+  @param[out] FtwProtocol   Returns the fault tolerant write stand-in.
+
+  @retval EFI_SUCCESS       Always.
+**/
+EFI_STATUS
+GetFtwProtocol (
+  OUT VOID  **FtwProtocol
+  )
+{
+  *FtwProtocol = &mTestFtw;
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the FVB protocol lookup.
+
+  @param[in]  FvBlockHandle   Handle of the memory flash device.
+  @param[out] FvBlock         Returns the FVB stand-in.
+
+  @retval EFI_SUCCESS         The handle is the one of the memory flash device.
+  @retval EFI_NOT_FOUND       Unknown handle.
+**/
+EFI_STATUS
+GetFvbByHandle (
+  IN  EFI_HANDLE                          FvBlockHandle,
+  OUT EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  **FvBlock
+  )
+{
+  if (FvBlockHandle != mTestFvbHandle) {
+    return EFI_NOT_FOUND;
+  }
+
+  *FvBlock = &mTestFvb;
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the FVB handle lookup.
+
+  @param[out] NumberHandles   Returns 1.
+  @param[out] Buffer          Returns the handle of the memory flash device.
+
+  @retval EFI_SUCCESS           The handle buffer is returned.
+  @retval EFI_OUT_OF_RESOURCES  Out of memory.
+**/
+EFI_STATUS
+GetFvbCountAndBuffer (
+  OUT UINTN       *NumberHandles,
+  OUT EFI_HANDLE  **Buffer
+  )
+{
+  *Buffer = AllocateCopyPool (sizeof (EFI_HANDLE), &mTestFvbHandle);
+  if (*Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  *NumberHandles = 1;
+  return EFI_SUCCESS;
+}
+
+/**
+  Stand-in for the platform NV storage region.
+
+  @param[out] BaseAddress   Returns the base of the memory flash device.
+  @param[out] Length        Returns the size of the memory flash device.
+
+  @retval EFI_SUCCESS       Always.
+**/
+EFI_STATUS
+EFIAPI
+GetVariableFlashNvStorageInfo (
+  OUT EFI_PHYSICAL_ADDRESS  *BaseAddress,
+  OUT UINT64                *Length
+  )
+{
+  *BaseAddress = (EFI_PHYSICAL_ADDRESS)(UINTN)mTestFlash;
+  *Length      = TEST_FLASH_SIZE;
+  return EFI_SUCCESS;
+}
+
+/**
+  There are no HOBs on the host.
+
+  @param[in] Guid   Not used.
+
+  @retval NULL      Always.
+**/
+VOID *
+EFIAPI
+GetFirstGuidHob (
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  return NULL;
+}
+
+/**
+  There are no HOBs on the host.
+
+  @param[in] Guid       Not used.
+  @param[in] HobStart   Not used.
+
+  @retval NULL          Always.
+**/
+VOID *
+EFIAPI
+GetNextGuidHob (
+  IN CONST EFI_GUID  *Guid,
+  IN CONST VOID      *HobStart
+  )
+{
+  return NULL;
+}
+
+/**
+  The test store does not use the authenticated variable format.
+
+  @param[in]  AuthVarLibContextIn   Not used.
+  @param[out] AuthVarLibContextOut  Not used.
+
+  @retval EFI_UNSUPPORTED           Always.
+**/
+EFI_STATUS
+EFIAPI
+AuthVariableLibInitialize (
+  IN  AUTH_VAR_LIB_CONTEXT_IN   *AuthVarLibContextIn,
+  OUT AUTH_VAR_LIB_CONTEXT_OUT  *AuthVarLibContextOut
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  The test store does not use the authenticated variable format.
+
+  @param[in] VariableName   Not used.
+  @param[in] VendorGuid     Not used.
+  @param[in] Data           Not used.
+  @param[in] DataSize       Not used.
+  @param[in] Attributes     Not used.
+
+  @retval EFI_UNSUPPORTED   Always.
+**/
+EFI_STATUS
+EFIAPI
+AuthVariableLibProcessVariable (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN VOID      *Data,
+  IN UINTN     DataSize,
+  IN UINT32    Attributes
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  No variable check handler is registered.
+
+  @param[in] VariableName   Not used.
+  @param[in] VendorGuid     Not used.
+  @param[in] Attributes     Not used.
+  @param[in] DataSize       Not used.
+  @param[in] Data           Not used.
+  @param[in] RequestSource  Not used.
+
+  @retval EFI_SUCCESS       Always.
+**/
+EFI_STATUS
+EFIAPI
+VarCheckLibSetVariableCheck (
+  IN CHAR16                    *VariableName,
+  IN EFI_GUID                  *VendorGuid,
+  IN UINT32                    Attributes,
+  IN UINTN                     DataSize,
+  IN VOID                      *Data,
+  IN VAR_CHECK_REQUEST_SOURCE  RequestSource
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  No variable property is registered.
+
+  @param[in] Name               Not used.
+  @param[in] Guid               Not used.
+  @param[in] VariableProperty   Not used.
+
+  @retval EFI_SUCCESS           Always.
+**/
+EFI_STATUS
+EFIAPI
+VarCheckLibVariablePropertySet (
+  IN CHAR16                       *Name,
+  IN EFI_GUID                     *Guid,
+  IN VAR_CHECK_VARIABLE_PROPERTY  *VariableProperty
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  No variable property is registered.
+
+  @param[in]  Name              Not used.
+  @param[in]  Guid              Not used.
+  @param[out] VariableProperty  Not set.
+
+  @retval EFI_NOT_FOUND         Always.
+**/
+EFI_STATUS
+EFIAPI
+VarCheckLibVariablePropertyGet (
+  IN  CHAR16                       *Name,
+  IN  EFI_GUID                     *Guid,
+  OUT VAR_CHECK_VARIABLE_PROPERTY  *VariableProperty
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+/**
+  The MOR variables are not used by the test.
+
+  @retval EFI_SUCCESS   Always.
+**/
+EFI_STATUS
+MorLockInit (
+  VOID
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  The MOR variables are not used by the test.
+
+  @param[in] VariableName   Not used.
+  @param[in] VendorGuid     Not used.
+  @param[in] Attributes     Not used.
+  @param[in] DataSize       Not used.
+  @param[in] Data           Not used.
+
+  @retval EFI_SUCCESS       Always.
+**/
+EFI_STATUS
+SetVariableCheckHandlerMor (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN UINT32    Attributes,
+  IN UINTN     DataSize,
+  IN VOID      *Data
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Count the variable updates reported to the measurement code.
+
+  @param[in] VariableName   Not used.
+  @param[in] VendorGuid     Not used.
+**/
+VOID
+EFIAPI
+SecureBootHook (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid
+  )
+{
+  mTestSecureBootHooks++;
+}
+
+/**
+  FVB stand-in of the memory flash device.
+
+  @param[in]  This        Not used.
+  @param[out] Attributes  Returns the write enabled attribute.
+
+  @retval EFI_SUCCESS     Always.
+**/
+EFI_STATUS
+EFIAPI
+TestFvbGetAttributes (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  OUT       EFI_FVB_ATTRIBUTES_2                *Attributes
+  )
+{
+  *Attributes = EFI_FVB2_READ_STATUS | EFI_FVB2_WRITE_STATUS;
+  return EFI_SUCCESS;
+}
+
+/**
+  FVB stand-in of the memory flash device.
+
+  @param[in]  This      Not used.
+  @param[out] Address   Returns the base of the memory flash device.
+
+  @retval EFI_SUCCESS   Always.
+**/
+EFI_STATUS
+EFIAPI
+TestFvbGetPhysicalAddress (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  OUT       EFI_PHYSICAL_ADDRESS                *Address
+  )
+{
+  *Address = (EFI_PHYSICAL_ADDRESS)(UINTN)mTestFlash;
+  return EFI_SUCCESS;
+}
+
+/**
+  FVB stand-in of the memory flash device.
+
+  @param[in]  This            Not used.
+  @param[in]  Lba             Not used, all the blocks have the same size.
+  @param[out] BlockSize       Returns the size of a block.
+  @param[out] NumberOfBlocks  Returns the number of blocks.
+
+  @retval EFI_SUCCESS         Always.
+**/
+EFI_STATUS
+EFIAPI
+TestFvbGetBlockSize (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN        EFI_LBA                             Lba,
+  OUT       UINTN                               *BlockSize,
+  OUT       UINTN                               *NumberOfBlocks
+  )
+{
+  *BlockSize      = TEST_BLOCK_SIZE;
+  *NumberOfBlocks = TEST_BLOCK_COUNT;
+  return EFI_SUCCESS;
+}
+
+/**
+  FVB stand-in of the memory flash device.
+
+  @param[in]      This      Not used.
+  @param[in]      Lba       The block to write.
+  @param[in]      Offset    Offset in the block.
+  @param[in, out] NumBytes  Number of bytes to write.
+  @param[in]      Buffer    The data to write.
+
+  @retval EFI_SUCCESS            The data is written.
+  @retval EFI_INVALID_PARAMETER  The range is outside of the device.
+**/
+EFI_STATUS
+EFIAPI
+TestFvbWrite (
+  IN CONST  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *This,
+  IN        EFI_LBA                             Lba,
+  IN        UINTN                               Offset,
+  IN OUT    UINTN                               *NumBytes,
+  IN        UINT8                               *Buffer
+  )
+{
+  UINTN  Address;
+
+  Address = (UINTN)Lba * TEST_BLOCK_SIZE + Offset;
+  if ((Address > TEST_FLASH_SIZE) || (*NumBytes > TEST_FLASH_SIZE - Address)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (mTestFlash + Address, Buffer, *NumBytes);
+  return EFI_SUCCESS;
+}
+
+/**
+  Fault tolerant write stand-in of the memory flash device.
+
+  The data is first kept in the spare block, then written to the target. The
+  power can be lost while the spare block is written, in which case the write
+  is lost, or while the target is written, in which case TestFtwRecover ()
+  completes it.
+
+  @param[in] This           Not used.
+  @param[in] Lba            The block to write.
+  @param[in] Offset         Offset in the block.
+  @param[in] Length         Number of bytes to write.
+  @param[in] PrivateData    Not used.
+  @param[in] FvBlockHandle  Handle of the memory flash device.
+  @param[in] Buffer         The data to write.
+
+  @retval EFI_SUCCESS            The data is written.
+  @retval EFI_INVALID_PARAMETER  The range is outside of the device.
+  @retval EFI_DEVICE_ERROR       The power was lost.
+**/
+EFI_STATUS
+EFIAPI
+TestFtwWrite (
+  IN EFI_FAULT_TOLERANT_WRITE_PROTOCOL  *This,
+  IN EFI_LBA                            Lba,
+  IN UINTN                              Offset,
+  IN UINTN                              Length,
+  IN VOID                               *PrivateData,
+  IN EFI_HANDLE                         FvBlockHandle,
+  IN VOID                               *Buffer
+  )
+{
+  UINTN  Address;
+
+  Address = (UINTN)Lba * TEST_BLOCK_SIZE + Offset;
+  if ((FvBlockHandle != mTestFvbHandle) || (Address > TEST_FLASH_SIZE) || (Length > TEST_FLASH_SIZE - Address)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  mTestFtwWrites++;
+  mTestFtwBytes += Length;
+  if (mTestPowerLoss == TEST_POWER_LOSS_SPARE) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  CopyMem (mTestFtwSpare, Buffer, Length);
+  mTestFtwTarget  = mTestFlash + Address;
+  mTestFtwLength  = Length;
+  mTestFtwPending = TRUE;
+  if (mTestPowerLoss == TEST_POWER_LOSS_TARGET) {
+    CopyMem (mTestFtwTarget, mTestFtwSpare, Length / 2);
+    return EFI_DEVICE_ERROR;
+  }
+
+  CopyMem (mTestFtwTarget, mTestFtwSpare, Length);
+  mTestFtwPending = FALSE;
+  return EFI_SUCCESS;
+}
+
+/**
+  Complete the pending write of the fault tolerant write stand-in, as the
+  fault tolerant write driver does when it starts.
+**/
+VOID
+TestFtwRecover (
+  VOID
+  )
+{
+  if (mTestFtwPending) {
+    CopyMem (mTestFtwTarget, mTestFtwSpare, mTestFtwLength);
+    mTestFtwPending = FALSE;
+  }
+}
+
+/**
+  Format the memory flash device with an empty variable store.
+**/
+VOID
+TestFormatFlash (
+  VOID
+  )
+{
+  EFI_FIRMWARE_VOLUME_HEADER  *FvHeader;
+  VARIABLE_STORE_HEADER       *Store;
+
+  SetMem (mTestFlash, TEST_FLASH_SIZE, 0xff);
+  FvHeader = (EFI_FIRMWARE_VOLUME_HEADER *)mTestFlash;
+  ZeroMem (FvHeader, TEST_FV_HEADER_LENGTH);
+  CopyGuid (&FvHeader->FileSystemGuid, &gEfiSystemNvDataFvGuid);
+  FvHeader->FvLength              = TEST_FLASH_SIZE;
+  FvHeader->Signature             = EFI_FVH_SIGNATURE;
+  FvHeader->Attributes            = EFI_FVB2_READ_STATUS | EFI_FVB2_WRITE_STATUS;
+  FvHeader->HeaderLength          = (UINT16)TEST_FV_HEADER_LENGTH;
+  FvHeader->Revision              = EFI_FVH_REVISION;
+  FvHeader->BlockMap[0].NumBlocks = TEST_BLOCK_COUNT;
+  FvHeader->BlockMap[0].Length    = TEST_BLOCK_SIZE;
+
+  Store = (VARIABLE_STORE_HEADER *)(mTestFlash + TEST_FV_HEADER_LENGTH);
+  ZeroMem (Store, sizeof (VARIABLE_STORE_HEADER));
+  CopyGuid (&Store->Signature, &gEfiVariableGuid);
+  Store->Size   = TEST_FLASH_SIZE - TEST_FV_HEADER_LENGTH;
+  Store->Format = VARIABLE_STORE_FORMATTED;
+  Store->State  = VARIABLE_STORE_HEALTHY;
+
+  mTestFtwPending = FALSE;
+  mTestPowerLoss  = TEST_POWER_LOSS_NONE;
+}
+
+/**
+  Initialize the variable driver on the memory flash device, as the DXE
+  driver does once the fault tolerant write protocol is installed.
+
+  @retval EFI_SUCCESS   The variable services are ready.
+  @return Others        The initialization failed.
+**/
+EFI_STATUS
+TestStartDriver (
+  VOID
+  )
+{
+  EFI_STATUS                          Status;
+  EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  *Fvb;
+
+  Status = VariableCommonInitialize ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // The non-volatile store is read from its memory copy, and written to the
+  // flash device.
+  //
+  mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase = (EFI_PHYSICAL_ADDRESS)(UINTN)(mTestFlash + mNvFvHeaderCache->HeaderLength);
+
+  Status = GetFvbInfoByAddress ((EFI_PHYSICAL_ADDRESS)(UINTN)mTestFlash, NULL, &Fvb);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  mVariableModuleGlobal->FvbInstance = Fvb;
+  return VariableWriteServiceInitialize ();
+}
+
+/**
+  Free the state of the variable driver, as when the power is lost.
+**/
+VOID
+TestStopDriver (
+  VOID
+  )
+{
+  VARIABLE_STORE_HEADER  *VolatileStore;
+
+  if (mVariableModuleGlobal == NULL) {
+    return;
+  }
+
+  VolatileStore = (VARIABLE_STORE_HEADER *)(UINTN)mVariableModuleGlobal->VariableGlobal.VolatileVariableBase;
+  VariableIndexUnregister (mNvVariableCache);
+  VariableIndexUnregister (VolatileStore);
+  FreePool (VolatileStore);
+  FreePool (mNvFvHeaderCache);
+  FreePool (mVariableModuleGlobal);
+  mVariableModuleGlobal = NULL;
+  mNvFvHeaderCache      = NULL;
+  mNvVariableCache      = NULL;
+}
+
+/**
+  Restart the variable driver from the content of the memory flash device,
+  after the fault tolerant write stand-in has completed its pending write.
+
+  @retval EFI_SUCCESS   The variable services are ready.
+  @return Others        The initialization failed.
+**/
+EFI_STATUS
+TestReboot (
+  VOID
+  )
+{
+  TestStopDriver ();
+  TestFtwRecover ();
+  mTestPowerLoss = TEST_POWER_LOSS_NONE;
+  return TestStartDriver ();
+}
+
+/**
+  Set a UINT32 variable of mTestGuid.
+
+  @param[in] Name     Variable name.
+  @param[in] Value    Variable value.
+
+  @return The status of SetVariable ().
+**/
+EFI_STATUS
+TestSetValue (
+  IN CHAR16  *Name,
+  IN UINT32  Value
+  )
+{
+  return VariableServiceSetVariable (Name, &mTestGuid, TEST_ATTRIBUTES, sizeof (Value), &Value);
+}
+
+/**
+  Get a UINT32 variable of mTestGuid.
+
+  @param[in]  Name    Variable name.
+  @param[out] Value   Returns the variable value.
+
+  @return The status of GetVariable ().
+**/
+EFI_STATUS
+TestGetValue (
+  IN  CHAR16  *Name,
+  OUT UINT32  *Value
+  )
+{
+  UINTN  DataSize;
+
+  DataSize = sizeof (*Value);
+  return VariableServiceGetVariable (Name, &mTestGuid, NULL, &DataSize, Value);
+}
+
+/**
+  Fill a batch entry that sets a UINT32 variable of mTestGuid.
+
+  @param[out] Entry   The batch entry.
+  @param[in]  Name    Variable name.
+  @param[in]  Value   Pointer to the variable value, NULL to delete the variable.
+**/
+VOID
+TestBatchEntry (
+  OUT EDKII_VARIABLE_BATCH_ENTRY  *Entry,
+  IN  CHAR16                      *Name,
+  IN  UINT32                      *Value
+  )
+{
+  Entry->VariableName = Name;
+  Entry->VendorGuid   = &mTestGuid;
+  Entry->Attributes   = TEST_ATTRIBUTES;
+  Entry->DataSize     = (Value == NULL) ? 0 : sizeof (*Value);
+  Entry->Data         = Value;
+}
+
+/**
+  Start the variable driver on an empty store, with the variables "Old" = 1
+  and "Gone" = 2 set through SetVariable ().
+
+  @param[in] Context    Not used.
+
+  @retval UNIT_TEST_PASSED                      The driver is ready.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The driver failed to start.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestStart (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TestStopDriver ();
+  TestFormatFlash ();
+  if (EFI_ERROR (TestStartDriver ()) ||
+      EFI_ERROR (TestSetValue (L"Old", 1)) ||
+      EFI_ERROR (TestSetValue (L"Gone", 2)))
+  {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  mTestFtwWrites       = 0;
+  mTestFtwBytes        = 0;
+  mTestSecureBootHooks = 0;
+  CopyMem (mTestFlashCopy, mTestFlash, TEST_FLASH_SIZE);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that "Old" = 1, "Gone" = 2 and "New" does not exist.
+
+  @retval UNIT_TEST_PASSED             The variables have their values before the batch.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A variable differs.
+**/
+UNIT_TEST_STATUS
+TestCheckNotApplied (
+  VOID
+  )
+{
+  UINT32  Value;
+
+  UT_ASSERT_NOT_EFI_ERROR (TestGetValue (L"Old", &Value));
+  UT_ASSERT_EQUAL (Value, 1);
+  UT_ASSERT_NOT_EFI_ERROR (TestGetValue (L"Gone", &Value));
+  UT_ASSERT_EQUAL (Value, 2);
+  UT_ASSERT_STATUS_EQUAL (TestGetValue (L"New", &Value), EFI_NOT_FOUND);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check the result of the batch of TestRunBatch (): "Old" = 10, "New" = 11 and
+  "Gone" does not exist.
+
+  @retval UNIT_TEST_PASSED             The variables have their values after the batch.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A variable differs.
+**/
+UNIT_TEST_STATUS
+TestCheckApplied (
+  VOID
+  )
+{
+  UINT32  Value;
+
+  UT_ASSERT_NOT_EFI_ERROR (TestGetValue (L"Old", &Value));
+  UT_ASSERT_EQUAL (Value, 10);
+  UT_ASSERT_NOT_EFI_ERROR (TestGetValue (L"New", &Value));
+  UT_ASSERT_EQUAL (Value, 11);
+  UT_ASSERT_STATUS_EQUAL (TestGetValue (L"Gone", &Value), EFI_NOT_FOUND);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Update "Old", add "New" and delete "Gone" in one batch.
+
+  @param[out] FailedEntry   Returns the FailedEntry of the batch.
+
+  @return The status of VariableServiceSetVariableBatch ().
+**/
+EFI_STATUS
+TestRunBatch (
+  OUT UINTN  *FailedEntry
+  )
+{
+  EDKII_VARIABLE_BATCH_ENTRY  Entries[3];
+  UINT32                      OldValue;
+  UINT32                      NewValue;
+
+  OldValue = 10;
+  NewValue = 11;
+  TestBatchEntry (&Entries[0], L"Old", &OldValue);
+  TestBatchEntry (&Entries[1], L"New", &NewValue);
+  TestBatchEntry (&Entries[2], L"Gone", NULL);
+  return VariableServiceSetVariableBatch (ARRAY_SIZE (Entries), Entries, FailedEntry);
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  A batch is committed with one fault tolerant write of the changed range of
+  the store, and survives a reboot.
+
+  @param[in] Context    Not used.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestBatchCommit (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN   FailedEntry;
+  UINT32  Value;
+
+  UT_ASSERT_NOT_EFI_ERROR (TestRunBatch (&FailedEntry));
+  UT_ASSERT_EQUAL (FailedEntry, 3);
+  UT_ASSERT_EQUAL (mTestFtwWrites, 1);
+  UT_ASSERT_TRUE (mTestFtwBytes < mNvVariableCache->Size / 4);
+  UT_ASSERT_EQUAL (mTestSecureBootHooks, 3);
+  UT_ASSERT_EQUAL (TestCheckApplied (), UNIT_TEST_PASSED);
+
+  //
+  // The memory copy of the store matches the flash.
+  //
+  UT_ASSERT_MEM_EQUAL (mNvVariableCache, mTestFlash + TEST_FV_HEADER_LENGTH, mNvVariableCache->Size);
+
+  UT_ASSERT_NOT_EFI_ERROR (TestReboot ());
+  UT_ASSERT_EQUAL (TestCheckApplied (), UNIT_TEST_PASSED);
+
+  //
+  // The store accepts regular updates after the batch.
+  //
+  UT_ASSERT_NOT_EFI_ERROR (TestSetValue (L"Gone", 3));
+  UT_ASSERT_NOT_EFI_ERROR (TestReboot ());
+  UT_ASSERT_NOT_EFI_ERROR (TestGetValue (L"Old", &Value));
+  UT_ASSERT_EQUAL (Value, 10);
+  UT_ASSERT_NOT_EFI_ERROR (TestGetValue (L"Gone", &Value));
+  UT_ASSERT_EQUAL (Value, 3);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  When one entry of a batch fails, none of the entries is applied, whether the
+  entry is rejected by the checks or runs out of space when it is staged.
+
+  @param[in] Context    Not used.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestBatchEntryFails (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EDKII_VARIABLE_BATCH_ENTRY  *Entries;
+  CHAR16                      (*Names)[8];
+  UINT32                      OldValue;
+  UINT32                      NewValue;
+  UINTN                       FailedEntry;
+  UINTN                       Index;
+
+  Entries = AllocateZeroPool (TEST_FILL_COUNT * sizeof (EDKII_VARIABLE_BATCH_ENTRY));
+  Names   = AllocateZeroPool (TEST_FILL_COUNT * sizeof (*Names));
+  UT_ASSERT_NOT_NULL (Entries);
+  UT_ASSERT_NOT_NULL (Names);
+
+  //
+  // The third entry is larger than a variable can be.
+  //
+  OldValue = 10;
+  NewValue = 11;
+  TestBatchEntry (&Entries[0], L"Old", &OldValue);
+  TestBatchEntry (&Entries[1], L"New", &NewValue);
+  TestBatchEntry (&Entries[2], L"Big", &NewValue);
+  Entries[2].Data     = mTestFlashCopy;
+  Entries[2].DataSize = PcdGet32 (PcdMaxVariableSize);
+  TestBatchEntry (&Entries[3], L"Gone", NULL);
+  UT_ASSERT_STATUS_EQUAL (VariableServiceSetVariableBatch (4, Entries, &FailedEntry), EFI_INVALID_PARAMETER);
+  UT_ASSERT_EQUAL (FailedEntry, 2);
+  UT_ASSERT_EQUAL (TestCheckNotApplied (), UNIT_TEST_PASSED);
+
+  //
+  // The entries fit one by one, but not all together.
+  //
+  SetMem (mTestFillData, sizeof (mTestFillData), 0x5a);
+  for (Index = 0; Index < TEST_FILL_COUNT; Index++) {
+    Names[Index][0] = L'F';
+    Names[Index][1] = (CHAR16)(L'0' + Index / 100);
+    Names[Index][2] = (CHAR16)(L'0' + Index / 10 % 10);
+    Names[Index][3] = (CHAR16)(L'0' + Index % 10);
+    TestBatchEntry (&Entries[Index], Names[Index], NULL);
+    Entries[Index].Data     = mTestFillData;
+    Entries[Index].DataSize = sizeof (mTestFillData);
+  }
+
+  TestBatchEntry (&Entries[0], L"Old", &OldValue);
+  UT_ASSERT_STATUS_EQUAL (VariableServiceSetVariableBatch (TEST_FILL_COUNT, Entries, &FailedEntry), EFI_OUT_OF_RESOURCES);
+  UT_ASSERT_TRUE (FailedEntry > 1);
+  UT_ASSERT_TRUE (FailedEntry < TEST_FILL_COUNT);
+  UT_ASSERT_EQUAL (TestCheckNotApplied (), UNIT_TEST_PASSED);
+  UT_ASSERT_STATUS_EQUAL (TestGetValue (Names[1], &NewValue), EFI_NOT_FOUND);
+
+  UT_ASSERT_EQUAL (mTestFtwWrites, 0);
+  UT_ASSERT_EQUAL (mTestSecureBootHooks, 0);
+  UT_ASSERT_MEM_EQUAL (mTestFlash, mTestFlashCopy, TEST_FLASH_SIZE);
+
+  //
+  // The store accepts regular updates after the failed batches.
+  //
+  UT_ASSERT_NOT_EFI_ERROR (TestSetValue (L"New", 12));
+  UT_ASSERT_NOT_EFI_ERROR (TestReboot ());
+  UT_ASSERT_NOT_EFI_ERROR (TestGetValue (L"New", &NewValue));
+  UT_ASSERT_EQUAL (NewValue, 12);
+
+  FreePool (Entries);
+  FreePool (Names);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A power loss while the batch is written to the spare block leaves none of
+  the entries applied after the reboot.
+
+  @param[in] Context    Not used.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestBatchPowerLossInSpare (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  FailedEntry;
+
+  mTestPowerLoss = TEST_POWER_LOSS_SPARE;
+  UT_ASSERT_STATUS_EQUAL (TestRunBatch (&FailedEntry), EFI_DEVICE_ERROR);
+  UT_ASSERT_EQUAL (FailedEntry, 3);
+  UT_ASSERT_EQUAL (mTestSecureBootHooks, 0);
+
+  //
+  // The memory copy of the store is synchronized with the flash.
+  //
+  UT_ASSERT_EQUAL (TestCheckNotApplied (), UNIT_TEST_PASSED);
+
+  UT_ASSERT_NOT_EFI_ERROR (TestReboot ());
+  UT_ASSERT_MEM_EQUAL (mTestFlash, mTestFlashCopy, TEST_FLASH_SIZE);
+  UT_ASSERT_EQUAL (TestCheckNotApplied (), UNIT_TEST_PASSED);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A power loss while the batch is written to the target blocks leaves all the
+  entries applied after the reboot, once the pending write is completed.
+
+  @param[in] Context    Not used.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestBatchPowerLossInTarget (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  FailedEntry;
+
+  mTestPowerLoss = TEST_POWER_LOSS_TARGET;
+  UT_ASSERT_STATUS_EQUAL (TestRunBatch (&FailedEntry), EFI_DEVICE_ERROR);
+  UT_ASSERT_EQUAL (mTestFtwWrites, 1);
+  UT_ASSERT_TRUE (mTestFtwPending);
+  UT_ASSERT_TRUE (CompareMem (mTestFlash, mTestFlashCopy, TEST_FLASH_SIZE) != 0);
+
+  UT_ASSERT_NOT_EFI_ERROR (TestReboot ());
+  UT_ASSERT_EQUAL (TestCheckApplied (), UNIT_TEST_PASSED);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Main entry point to the unit test.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      BatchTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  mTestFtw.Write              = TestFtwWrite;
+  mTestFvb.GetAttributes      = TestFvbGetAttributes;
+  mTestFvb.GetPhysicalAddress = TestFvbGetPhysicalAddress;
+  mTestFvb.GetBlockSize       = TestFvbGetBlockSize;
+  mTestFvb.Write              = TestFvbWrite;
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &BatchTests,
+             Framework,
+             "Variable Batch Tests",
+             "Variable.Batch",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for BatchTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    BatchTests,
+    "A batch is committed with one FTW write and survives a reboot",
+    "Commit",
+    TestBatchCommit,
+    TestStart,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    BatchTests,
+    "A failing entry leaves the store unchanged",
+    "EntryFails",
+    TestBatchEntryFails,
+    TestStart,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    BatchTests,
+    "A power loss while the spare block is written applies no entry",
+    "PowerLossInSpare",
+    TestBatchPowerLossInSpare,
+    TestStart,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    BatchTests,
+    "A power loss while the target is written applies all the entries",
+    "PowerLossInTarget",
+    TestBatchPowerLossInTarget,
+    TestStart,
+    NULL,
+    NULL
+    );
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  TestStopDriver ();
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
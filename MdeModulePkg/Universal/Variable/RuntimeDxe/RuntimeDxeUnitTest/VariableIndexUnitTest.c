@@ -0,0 +1,588 @@
+/** @file
+  This is a host-based unit test and microbenchmark for the variable store
+  name/GUID index used by FindVariableEx ().
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include "../VariableIndex.h"
+#include "../VariableParsing.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "Variable Store Index Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_STORE_SIZE         SIZE_64KB
+#define TEST_NAME_COUNT         64
+#define TEST_ITERATIONS         20000
+#define TEST_BENCH_VARIABLES    400
+#define TEST_BENCH_LOOKUPS      100000
+
+//
+// Test GUID 1 {4B7A0B4E-6C62-4D4C-9E0F-1D3B5C7A9E21}
+//
+EFI_GUID  mTestGuid1 = {
+  0x4b7a0b4e, 0x6c62, 0x4d4c, { 0x9e, 0x0f, 0x1d, 0x3b, 0x5c, 0x7a, 0x9e, 0x21 }
+};
+
+//
+// Test GUID 2 {A3C15F8D-2E47-4B90-8D16-7F0E4C2B6A53}
+//
+EFI_GUID  mTestGuid2 = {
+  0xa3c15f8d, 0x2e47, 0x4b90, { 0x8d, 0x16, 0x7f, 0x0e, 0x4c, 0x2b, 0x6a, 0x53 }
+};
+
+UINT32  mTestSeed;
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Nothing in this test runs after ExitBootServices ().
+
+  @retval FALSE   Always.
+**/
+BOOLEAN
+AtRuntime (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+/**
+  Deterministic pseudo random number generator, so failures reproduce.
+
+  @return Next pseudo random number.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mTestSeed = mTestSeed * 1103515245 + 12345;
+  return (mTestSeed >> 16) & 0x7FFF;
+}
+
+/**
+  Build the name of test variable number Number.
+
+  @param[out] Name     Buffer of at least 16 characters.
+  @param[in]  Number   Variable number, below 10000.
+**/
+VOID
+TestVariableName (
+  OUT CHAR16  *Name,
+  IN  UINTN   Number
+  )
+{
+  UINTN  Index;
+
+  StrCpyS (Name, 16, L"Var0000");
+  for (Index = 6; Number != 0; Index--) {
+    Name[Index] = (CHAR16)(L'0' + Number % 10);
+    Number     /= 10;
+  }
+}
+
+/**
+  Create an empty variable store.
+
+  @return Pointer to the variable store, or NULL if out of memory.
+**/
+VARIABLE_STORE_HEADER *
+TestCreateStore (
+  VOID
+  )
+{
+  VARIABLE_STORE_HEADER  *Store;
+
+  Store = AllocatePool (TEST_STORE_SIZE);
+  if (Store == NULL) {
+    return NULL;
+  }
+
+  SetMem (Store, TEST_STORE_SIZE, 0xff);
+  CopyGuid (&Store->Signature, &gEfiVariableGuid);
+  Store->Size      = TEST_STORE_SIZE;
+  Store->Format    = VARIABLE_STORE_FORMATTED;
+  Store->State     = VARIABLE_STORE_HEALTHY;
+  Store->Reserved  = 0;
+  Store->Reserved1 = 0;
+  return Store;
+}
+
+/**
+  Append a variable record to a store.
+
+  @param[in] Store      Pointer to the variable store.
+  @param[in] Name       Variable name.
+  @param[in] Guid       Variable vendor GUID.
+  @param[in] State      State of the new record.
+  @param[in] DataSize   Size of the variable data.
+
+  @return Pointer to the new record, or NULL if the store is full.
+**/
+VARIABLE_HEADER *
+TestAppendVariable (
+  IN VARIABLE_STORE_HEADER  *Store,
+  IN CHAR16                 *Name,
+  IN EFI_GUID               *Guid,
+  IN UINT8                  State,
+  IN UINTN                  DataSize
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  UINTN            NameSize;
+  UINTN            VarSize;
+
+  Variable = GetStartPointer (Store);
+  while (IsValidVariableHeader (Variable, GetEndPointer (Store))) {
+    Variable = GetNextVariablePtr (Variable, FALSE);
+  }
+
+  NameSize = StrSize (Name);
+  VarSize  = HEADER_ALIGN (sizeof (VARIABLE_HEADER) + NameSize + GET_PAD_SIZE (NameSize) + DataSize);
+  if ((UINTN)Variable + VarSize > (UINTN)GetEndPointer (Store)) {
+    return NULL;
+  }
+
+  ZeroMem (Variable, sizeof (VARIABLE_HEADER));
+  Variable->StartId    = VARIABLE_DATA;
+  Variable->State      = State;
+  Variable->Attributes = EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
+  Variable->NameSize   = (UINT32)NameSize;
+  Variable->DataSize   = (UINT32)DataSize;
+  CopyGuid (&Variable->VendorGuid, Guid);
+  CopyMem (GetVariableNamePtr (Variable, FALSE), Name, NameSize);
+  SetMem (GetVariableDataPtr (Variable, FALSE), DataSize, 0x5a);
+  return Variable;
+}
+
+/**
+  Drop deleted records from a store the way Reclaim () does.
+
+  @param[in] Store   Pointer to the variable store.
+**/
+VOID
+TestReclaimStore (
+  IN VARIABLE_STORE_HEADER  *Store
+  )
+{
+  UINT8            *Buffer;
+  UINT8            *CurrPtr;
+  VARIABLE_HEADER  *Variable;
+  VARIABLE_HEADER  *NextVariable;
+
+  Buffer = AllocatePool (TEST_STORE_SIZE);
+  if (Buffer == NULL) {
+    return;
+  }
+
+  SetMem (Buffer, TEST_STORE_SIZE, 0xff);
+  CopyMem (Buffer, Store, sizeof (VARIABLE_STORE_HEADER));
+  CurrPtr = (UINT8 *)GetStartPointer ((VARIABLE_STORE_HEADER *)Buffer);
+
+  Variable = GetStartPointer (Store);
+  while (IsValidVariableHeader (Variable, GetEndPointer (Store))) {
+    NextVariable = GetNextVariablePtr (Variable, FALSE);
+    if ((Variable->State == VAR_ADDED) || (Variable->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED))) {
+      CopyMem (CurrPtr, Variable, (UINTN)NextVariable - (UINTN)Variable);
+      CurrPtr += (UINTN)NextVariable - (UINTN)Variable;
+    }
+
+    Variable = NextVariable;
+  }
+
+  CopyMem (Store, Buffer, TEST_STORE_SIZE);
+  FreePool (Buffer);
+}
+
+/**
+  Apply a random append, state change or reclaim to a store.
+
+  @param[in] Store        Pointer to the variable store.
+  @param[in] Invalidate   TRUE to report a reclaim to the index.
+**/
+VOID
+TestMutateStore (
+  IN VARIABLE_STORE_HEADER  *Store,
+  IN BOOLEAN                Invalidate
+  )
+{
+  CHAR16           Name[16];
+  VARIABLE_HEADER  *Variable;
+  UINTN            Skip;
+  UINT8            State;
+
+  if ((TestRandom () % 3) == 0) {
+    //
+    // Change the State of a random record in place.
+    //
+    Variable = GetStartPointer (Store);
+    for (Skip = TestRandom () % 100; Skip > 0; Skip--) {
+      if (!IsValidVariableHeader (Variable, GetEndPointer (Store))) {
+        return;
+      }
+
+      Variable = GetNextVariablePtr (Variable, FALSE);
+    }
+
+    if (IsValidVariableHeader (Variable, GetEndPointer (Store))) {
+      switch (TestRandom () % 3) {
+        case 0:
+          Variable->State = VAR_ADDED;
+          break;
+        case 1:
+          Variable->State = VAR_IN_DELETED_TRANSITION & VAR_ADDED;
+          break;
+        default:
+          Variable->State = VAR_DELETED & VAR_IN_DELETED_TRANSITION & VAR_ADDED;
+          break;
+      }
+    }
+
+    return;
+  }
+
+  TestVariableName (Name, TestRandom () % TEST_NAME_COUNT);
+  State = ((TestRandom () % 4) == 0) ? (VAR_IN_DELETED_TRANSITION & VAR_ADDED) : VAR_ADDED;
+  if (TestAppendVariable (Store, Name, ((TestRandom () % 2) == 0) ? &mTestGuid1 : &mTestGuid2, State, 8 + TestRandom () % 64) == NULL) {
+    TestReclaimStore (Store);
+    if (Invalidate) {
+      VariableIndexInvalidate (Store);
+    }
+  }
+}
+
+/**
+  Look a variable up in a store without any index, using a private copy.
+
+  @param[in]  Store          Pointer to the variable store.
+  @param[in]  Copy           Buffer of TEST_STORE_SIZE bytes.
+  @param[in]  Name           Variable name.
+  @param[in]  Guid           Variable vendor GUID.
+  @param[out] PtrTrack       Result, pointing into Copy.
+
+  @return Status of FindVariableEx ().
+**/
+EFI_STATUS
+TestLinearFind (
+  IN  VARIABLE_STORE_HEADER   *Store,
+  IN  VARIABLE_STORE_HEADER   *Copy,
+  IN  CHAR16                  *Name,
+  IN  EFI_GUID                *Guid,
+  OUT VARIABLE_POINTER_TRACK  *PtrTrack
+  )
+{
+  CopyMem (Copy, Store, TEST_STORE_SIZE);
+  PtrTrack->StartPtr = GetStartPointer (Copy);
+  PtrTrack->EndPtr   = GetEndPointer (Copy);
+  return FindVariableEx (Name, Guid, FALSE, PtrTrack, FALSE);
+}
+
+/**
+  Clean up the registered indexes after a test case.
+
+  @param[in]  Context  Unit test case context
+**/
+STATIC
+VOID
+EFIAPI
+IndexCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < VARIABLE_INDEX_MAX_STORES; Index++) {
+    if (mVariableIndex[Index] != NULL) {
+      VariableIndexUnregister (mVariableIndex[Index]->VariableStore);
+    }
+  }
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  An authoritative index must give the same answer as the linear walk,
+  including the IN_DELETED_TRANSITION record, across appends, state changes
+  and reclaims.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+AuthoritativeIndexMatchesLinearWalk (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VARIABLE_STORE_HEADER   *Store;
+  VARIABLE_STORE_HEADER   *Copy;
+  VARIABLE_POINTER_TRACK  Indexed;
+  VARIABLE_POINTER_TRACK  Linear;
+  EFI_STATUS              IndexedStatus;
+  EFI_STATUS              LinearStatus;
+  CHAR16                  Name[16];
+  EFI_GUID                *Guid;
+  UINTN                   Iteration;
+
+  mTestSeed = 1;
+  Store     = TestCreateStore ();
+  Copy      = AllocatePool (TEST_STORE_SIZE);
+  UT_ASSERT_NOT_NULL (Store);
+  UT_ASSERT_NOT_NULL (Copy);
+  VariableIndexRegister (Store, TEST_STORE_SIZE, TRUE);
+
+  for (Iteration = 0; Iteration < TEST_ITERATIONS; Iteration++) {
+    TestMutateStore (Store, TRUE);
+
+    TestVariableName (Name, TestRandom () % (TEST_NAME_COUNT + 8));
+    Guid             = ((TestRandom () % 2) == 0) ? &mTestGuid1 : &mTestGuid2;
+    Indexed.StartPtr = GetStartPointer (Store);
+    Indexed.EndPtr   = GetEndPointer (Store);
+    IndexedStatus    = FindVariableEx (Name, Guid, FALSE, &Indexed, FALSE);
+    LinearStatus     = TestLinearFind (Store, Copy, Name, Guid, &Linear);
+
+    UT_ASSERT_STATUS_EQUAL (IndexedStatus, LinearStatus);
+    if (!EFI_ERROR (LinearStatus)) {
+      UT_ASSERT_EQUAL ((UINTN)Indexed.CurrPtr - (UINTN)Store, (UINTN)Linear.CurrPtr - (UINTN)Copy);
+      if (Linear.InDeletedTransitionPtr == NULL) {
+        UT_ASSERT_TRUE (Indexed.InDeletedTransitionPtr == NULL);
+      } else {
+        UT_ASSERT_NOT_NULL (Indexed.InDeletedTransitionPtr);
+        UT_ASSERT_EQUAL ((UINTN)Indexed.InDeletedTransitionPtr - (UINTN)Store, (UINTN)Linear.InDeletedTransitionPtr - (UINTN)Copy);
+      }
+    }
+  }
+
+  FreePool (Copy);
+  FreePool (Store);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A hint index is never told about reclaims. It must still only return live
+  VAR_ADDED records of the requested variable, and never miss one.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+HintIndexSurvivesSilentRewrites (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VARIABLE_STORE_HEADER   *Store;
+  VARIABLE_STORE_HEADER   *Copy;
+  VARIABLE_POINTER_TRACK  Indexed;
+  VARIABLE_POINTER_TRACK  Linear;
+  EFI_STATUS              IndexedStatus;
+  EFI_STATUS              LinearStatus;
+  CHAR16                  Name[16];
+  EFI_GUID                *Guid;
+  UINTN                   Iteration;
+
+  mTestSeed = 2;
+  Store     = TestCreateStore ();
+  Copy      = AllocatePool (TEST_STORE_SIZE);
+  UT_ASSERT_NOT_NULL (Store);
+  UT_ASSERT_NOT_NULL (Copy);
+  VariableIndexRegister (Store, TEST_STORE_SIZE, FALSE);
+
+  for (Iteration = 0; Iteration < TEST_ITERATIONS; Iteration++) {
+    TestMutateStore (Store, FALSE);
+
+    TestVariableName (Name, TestRandom () % (TEST_NAME_COUNT + 8));
+    Guid             = ((TestRandom () % 2) == 0) ? &mTestGuid1 : &mTestGuid2;
+    Indexed.StartPtr = GetStartPointer (Store);
+    Indexed.EndPtr   = GetEndPointer (Store);
+    IndexedStatus    = FindVariableEx (Name, Guid, FALSE, &Indexed, FALSE);
+    LinearStatus     = TestLinearFind (Store, Copy, Name, Guid, &Linear);
+
+    UT_ASSERT_STATUS_EQUAL (IndexedStatus, LinearStatus);
+    if (!EFI_ERROR (IndexedStatus)) {
+      UT_ASSERT_EQUAL (Indexed.CurrPtr->State, Linear.CurrPtr->State);
+      UT_ASSERT_TRUE (CompareGuid (Guid, GetVendorGuidPtr (Indexed.CurrPtr, FALSE)));
+      UT_ASSERT_MEM_EQUAL (GetVariableNamePtr (Indexed.CurrPtr, FALSE), Name, StrSize (Name));
+    }
+  }
+
+  FreePool (Copy);
+  FreePool (Store);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Compare the cost of GetVariable-style lookups with and without the index on
+  a store of TEST_BENCH_VARIABLES variables. The numbers are only logged.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+IndexedLookupBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VARIABLE_STORE_HEADER   *Store;
+  VARIABLE_POINTER_TRACK  PtrTrack;
+  CHAR16                  Name[16];
+  UINTN                   Index;
+  UINTN                   Pass;
+  clock_t                 Ticks[2];
+
+  Store = TestCreateStore ();
+  UT_ASSERT_NOT_NULL (Store);
+  for (Index = 0; Index < TEST_BENCH_VARIABLES; Index++) {
+    TestVariableName (Name, Index);
+    UT_ASSERT_NOT_NULL (TestAppendVariable (Store, Name, &mTestGuid1, VAR_ADDED, 32));
+  }
+
+  for (Pass = 0; Pass < 2; Pass++) {
+    if (Pass == 1) {
+      VariableIndexRegister (Store, TEST_STORE_SIZE, TRUE);
+    }
+
+    Ticks[Pass] = clock ();
+    for (Index = 0; Index < TEST_BENCH_LOOKUPS; Index++) {
+      TestVariableName (Name, (Index * 7) % TEST_BENCH_VARIABLES);
+      PtrTrack.StartPtr = GetStartPointer (Store);
+      PtrTrack.EndPtr   = GetEndPointer (Store);
+      UT_ASSERT_NOT_EFI_ERROR (FindVariableEx (Name, &mTestGuid1, FALSE, &PtrTrack, FALSE));
+    }
+
+    Ticks[Pass] = clock () - Ticks[Pass];
+  }
+
+  UT_LOG_INFO (
+    "%d lookups in %d variables: linear walk %Lu ms, index %Lu ms\n",
+    TEST_BENCH_LOOKUPS,
+    TEST_BENCH_VARIABLES,
+    (UINT64)(Ticks[0] * 1000 / CLOCKS_PER_SEC),
+    (UINT64)(Ticks[1] * 1000 / CLOCKS_PER_SEC)
+    );
+
+  FreePool (Store);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Main entry point to the unit test.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      IndexTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &IndexTests,
+             Framework,
+             "Variable Store Index Tests",
+             "Variable.Index",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for IndexTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    IndexTests,
+    "An authoritative index should match the linear walk",
+    "Authoritative",
+    AuthoritativeIndexMatchesLinearWalk,
+    NULL,
+    IndexCleanup,
+    NULL
+    );
+  AddTestCase (
+    IndexTests,
+    "A hint index should only return live records after silent rewrites",
+    "Hint",
+    HintIndexSurvivesSilentRewrites,
+    NULL,
+    IndexCleanup,
+    NULL
+    );
+  AddTestCase (
+    IndexTests,
+    "Indexed lookups should be cheaper than the linear walk",
+    "Benchmark",
+    IndexedLookupBenchmark,
+    NULL,
+    IndexCleanup,
+    NULL
+    );
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
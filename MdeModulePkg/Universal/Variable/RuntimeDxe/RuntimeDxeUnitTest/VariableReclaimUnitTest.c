@@ -0,0 +1,557 @@
+/** @file
+  This is a host-based unit test for RecalculateNvVariableTotalSize (), which
+  must account for the same records as Reclaim () keeps.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../Variable.h"
+#include "../VariableParsing.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "Variable Reclaim Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_STORE_SIZE   SIZE_16KB
+#define TEST_NAME_COUNT   16
+#define TEST_ITERATIONS   2000
+
+//
+// System variable GUID {4B7A0B4E-6C62-4D4C-9E0F-1D3B5C7A9E21}
+//
+EFI_GUID  mTestSystemGuid = {
+  0x4b7a0b4e, 0x6c62, 0x4d4c, { 0x9e, 0x0f, 0x1d, 0x3b, 0x5c, 0x7a, 0x9e, 0x21 }
+};
+
+//
+// User variable GUID {A3C15F8D-2E47-4B90-8D16-7F0E4C2B6A53}
+//
+EFI_GUID  mTestUserGuid = {
+  0xa3c15f8d, 0x2e47, 0x4b90, { 0x8d, 0x16, 0x7f, 0x0e, 0x4c, 0x2b, 0x6a, 0x53 }
+};
+
+VARIABLE_MODULE_GLOBAL  mTestModuleGlobal;
+VARIABLE_MODULE_GLOBAL  *mVariableModuleGlobal = &mTestModuleGlobal;
+UINT32                  mTestSeed;
+
+/// === HELPER FUNCTIONS ===========================================================================
+
+/**
+  Nothing in this test runs after ExitBootServices ().
+
+  @retval FALSE   Always.
+**/
+BOOLEAN
+AtRuntime (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+/**
+  The variables of mTestUserGuid are user variables.
+
+  @param[in] Variable   Pointer to variable header.
+
+  @retval TRUE          User variable.
+  @retval FALSE         System variable.
+**/
+BOOLEAN
+IsUserVariable (
+  IN VARIABLE_HEADER  *Variable
+  )
+{
+  return CompareGuid (GetVendorGuidPtr (Variable, FALSE), &mTestUserGuid);
+}
+
+/**
+  FTW is not used by the size accounting.
+
+  @param[out] FtwProtocol   Not set.
+
+  @retval EFI_NOT_FOUND     Always.
+**/
+EFI_STATUS
+GetFtwProtocol (
+  OUT VOID  **FtwProtocol
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+/**
+  FVB is not used by the size accounting.
+
+  @param[in]  Address       Not used.
+  @param[out] FvbHandle     Not set.
+  @param[out] FvbProtocol   Not set.
+
+  @retval EFI_NOT_FOUND     Always.
+**/
+EFI_STATUS
+GetFvbInfoByAddress (
+  IN  EFI_PHYSICAL_ADDRESS                Address,
+  OUT EFI_HANDLE                          *FvbHandle OPTIONAL,
+  OUT EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL  **FvbProtocol OPTIONAL
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Deterministic pseudo random number generator, so failures reproduce.
+
+  @return Next pseudo random number.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mTestSeed = mTestSeed * 1103515245 + 12345;
+  return (mTestSeed >> 16) & 0x7FFF;
+}
+
+/**
+  Create an empty variable store.
+
+  @return Pointer to the variable store, or NULL if out of memory.
+**/
+VARIABLE_STORE_HEADER *
+TestCreateStore (
+  VOID
+  )
+{
+  VARIABLE_STORE_HEADER  *Store;
+
+  Store = AllocatePool (TEST_STORE_SIZE);
+  if (Store == NULL) {
+    return NULL;
+  }
+
+  SetMem (Store, TEST_STORE_SIZE, 0xff);
+  CopyGuid (&Store->Signature, &gEfiVariableGuid);
+  Store->Size      = TEST_STORE_SIZE;
+  Store->Format    = VARIABLE_STORE_FORMATTED;
+  Store->State     = VARIABLE_STORE_HEALTHY;
+  Store->Reserved  = 0;
+  Store->Reserved1 = 0;
+  return Store;
+}
+
+/**
+  Append a variable record to a store.
+
+  @param[in] Store        Pointer to the variable store.
+  @param[in] Name         Variable name.
+  @param[in] Guid         Variable vendor GUID.
+  @param[in] State        State of the new record.
+  @param[in] Attributes   Attributes of the new record.
+  @param[in] DataSize     Size of the variable data.
+
+  @return Pointer to the new record, or NULL if the store is full.
+**/
+VARIABLE_HEADER *
+TestAppendVariable (
+  IN VARIABLE_STORE_HEADER  *Store,
+  IN CHAR16                 *Name,
+  IN EFI_GUID               *Guid,
+  IN UINT8                  State,
+  IN UINT32                 Attributes,
+  IN UINTN                  DataSize
+  )
+{
+  VARIABLE_HEADER  *Variable;
+  UINTN            NameSize;
+  UINTN            VarSize;
+
+  Variable = GetStartPointer (Store);
+  while (IsValidVariableHeader (Variable, GetEndPointer (Store))) {
+    Variable = GetNextVariablePtr (Variable, FALSE);
+  }
+
+  NameSize = StrSize (Name);
+  VarSize  = HEADER_ALIGN (sizeof (VARIABLE_HEADER) + NameSize + GET_PAD_SIZE (NameSize) + DataSize);
+  if ((UINTN)Variable + VarSize > (UINTN)GetEndPointer (Store)) {
+    return NULL;
+  }
+
+  ZeroMem (Variable, sizeof (VARIABLE_HEADER));
+  Variable->StartId    = VARIABLE_DATA;
+  Variable->State      = State;
+  Variable->Attributes = Attributes;
+  Variable->NameSize   = (UINT32)NameSize;
+  Variable->DataSize   = (UINT32)DataSize;
+  CopyGuid (&Variable->VendorGuid, Guid);
+  CopyMem (GetVariableNamePtr (Variable, FALSE), Name, NameSize);
+  SetMem (GetVariableDataPtr (Variable, FALSE), DataSize, 0x5a);
+  return Variable;
+}
+
+/**
+  Size of a variable record, including its alignment padding.
+
+  @param[in] Variable   Pointer to the variable record.
+
+  @return Size of the record in bytes.
+**/
+UINTN
+TestRecordSize (
+  IN VARIABLE_HEADER  *Variable
+  )
+{
+  return (UINTN)GetNextVariablePtr (Variable, FALSE) - (UINTN)Variable;
+}
+
+/**
+  Rebuild a store the way Reclaim () does, and add up the sizes of the
+  records it keeps.
+
+  @param[in]  Store         Pointer to the variable store.
+  @param[out] HwErrSize     Size of the kept hardware error records.
+  @param[out] CommonSize    Size of the other kept records.
+  @param[out] UserSize      Size of the kept user variable records.
+**/
+VOID
+TestReclaimStore (
+  IN  VARIABLE_STORE_HEADER  *Store,
+  OUT UINTN                  *HwErrSize,
+  OUT UINTN                  *CommonSize,
+  OUT UINTN                  *UserSize
+  )
+{
+  VARIABLE_STORE_HEADER  *Buffer;
+  UINT8                  *CurrPtr;
+  VARIABLE_HEADER        *Variable;
+  VARIABLE_HEADER        *Added;
+  BOOLEAN                FoundAdded;
+  UINTN                  Pass;
+
+  Buffer = TestCreateStore ();
+  if (Buffer == NULL) {
+    return;
+  }
+
+  CurrPtr = (UINT8 *)GetStartPointer (Buffer);
+  for (Pass = 0; Pass < 2; Pass++) {
+    Variable = GetStartPointer (Store);
+    while (IsValidVariableHeader (Variable, GetEndPointer (Store))) {
+      if ((Pass == 0) && (Variable->State == VAR_ADDED)) {
+        FoundAdded = FALSE;
+      } else if ((Pass == 1) && (Variable->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED))) {
+        FoundAdded = FALSE;
+        Added      = GetStartPointer (Buffer);
+        while (IsValidVariableHeader (Added, GetEndPointer (Buffer))) {
+          if (CompareGuid (&Added->VendorGuid, &Variable->VendorGuid) &&
+              (Added->NameSize == Variable->NameSize) &&
+              (CompareMem (GetVariableNamePtr (Added, FALSE), GetVariableNamePtr (Variable, FALSE), Added->NameSize) == 0))
+          {
+            FoundAdded = TRUE;
+          }
+
+          Added = GetNextVariablePtr (Added, FALSE);
+        }
+      } else {
+        FoundAdded = TRUE;
+      }
+
+      if (!FoundAdded) {
+        CopyMem (CurrPtr, Variable, TestRecordSize (Variable));
+        ((VARIABLE_HEADER *)CurrPtr)->State = VAR_ADDED;
+        CurrPtr                            += TestRecordSize (Variable);
+      }
+
+      Variable = GetNextVariablePtr (Variable, FALSE);
+    }
+  }
+
+  *HwErrSize  = 0;
+  *CommonSize = 0;
+  *UserSize   = 0;
+  Variable    = GetStartPointer (Buffer);
+  while (IsValidVariableHeader (Variable, GetEndPointer (Buffer))) {
+    if ((Variable->Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) != 0) {
+      *HwErrSize += TestRecordSize (Variable);
+    } else {
+      *CommonSize += TestRecordSize (Variable);
+      if (IsUserVariable (Variable)) {
+        *UserSize += TestRecordSize (Variable);
+      }
+    }
+
+    Variable = GetNextVariablePtr (Variable, FALSE);
+  }
+
+  FreePool (Buffer);
+}
+
+/// === TEST CASES =================================================================================
+
+/**
+  Deleted records, filler records and IN_DELETED_TRANSITION records that have
+  a VAR_ADDED copy must not be counted; everything else must.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RecalculateCountsOnlyKeptRecords (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VARIABLE_STORE_HEADER  *Store;
+  VARIABLE_HEADER        *Variable;
+  VARIABLE_HEADER        *Last;
+  UINT32                 Attributes;
+  UINTN                  HwErrSize;
+  UINTN                  CommonSize;
+  UINTN                  UserSize;
+  UINTN                  Offset;
+
+  Store = TestCreateStore ();
+  UT_ASSERT_NOT_NULL (Store);
+  Attributes = EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
+  HwErrSize  = 0;
+  CommonSize = 0;
+  UserSize   = 0;
+
+  //
+  // A live system variable.
+  //
+  Variable = TestAppendVariable (Store, L"Live", &mTestSystemGuid, VAR_ADDED, Attributes, 24);
+  UT_ASSERT_NOT_NULL (Variable);
+  CommonSize += TestRecordSize (Variable);
+
+  //
+  // A deleted variable.
+  //
+  UT_ASSERT_NOT_NULL (TestAppendVariable (Store, L"Gone", &mTestSystemGuid, VAR_DELETED & VAR_IN_DELETED_TRANSITION & VAR_ADDED, Attributes, 64));
+
+  //
+  // An update in progress: the old copy is only counted through the new one.
+  //
+  UT_ASSERT_NOT_NULL (TestAppendVariable (Store, L"Updated", &mTestUserGuid, VAR_IN_DELETED_TRANSITION & VAR_ADDED, Attributes, 16));
+  Variable = TestAppendVariable (Store, L"Updated", &mTestUserGuid, VAR_ADDED, Attributes, 40);
+  UT_ASSERT_NOT_NULL (Variable);
+  CommonSize += TestRecordSize (Variable);
+  UserSize   += TestRecordSize (Variable);
+
+  //
+  // An update interrupted before the new copy was added: Reclaim () keeps it.
+  //
+  Variable = TestAppendVariable (Store, L"Interrupted", &mTestUserGuid, VAR_IN_DELETED_TRANSITION & VAR_ADDED, Attributes, 8);
+  UT_ASSERT_NOT_NULL (Variable);
+  CommonSize += TestRecordSize (Variable);
+  UserSize   += TestRecordSize (Variable);
+
+  //
+  // A hardware error record.
+  //
+  Variable = TestAppendVariable (Store, L"HwErrRec0001", &mTestSystemGuid, VAR_ADDED, Attributes | EFI_VARIABLE_HARDWARE_ERROR_RECORD, 32);
+  UT_ASSERT_NOT_NULL (Variable);
+  HwErrSize += TestRecordSize (Variable);
+
+  //
+  // A deleted filler record of the incremental reclaim.
+  //
+  Last = TestAppendVariable (Store, L"", &gEfiVariableGuid, VAR_DELETED & VAR_IN_DELETED_TRANSITION & VAR_ADDED, 0, 1024);
+  UT_ASSERT_NOT_NULL (Last);
+
+  mTestModuleGlobal.HwErrVariableTotalSize      = MAX_UINTN;
+  mTestModuleGlobal.CommonVariableTotalSize     = MAX_UINTN;
+  mTestModuleGlobal.CommonUserVariableTotalSize = MAX_UINTN;
+  Offset                                        = RecalculateNvVariableTotalSize (Store);
+
+  UT_ASSERT_EQUAL (Offset, (UINTN)Last + TestRecordSize (Last) - (UINTN)Store);
+  UT_ASSERT_EQUAL (mTestModuleGlobal.HwErrVariableTotalSize, HwErrSize);
+  UT_ASSERT_EQUAL (mTestModuleGlobal.CommonVariableTotalSize, CommonSize);
+  UT_ASSERT_EQUAL (mTestModuleGlobal.CommonUserVariableTotalSize, UserSize);
+
+  FreePool (Store);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  On random stores, the recalculated sizes must be the sizes of the store
+  that Reclaim () would write.
+
+  @param[in]  Context  Unit test case context
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RecalculateMatchesReclaim (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VARIABLE_STORE_HEADER  *Store;
+  CHAR16                 Name[16];
+  UINT8                  State;
+  UINT32                 Attributes;
+  UINTN                  HwErrSize;
+  UINTN                  CommonSize;
+  UINTN                  UserSize;
+  UINTN                  Iteration;
+  UINTN                  Number;
+
+  mTestSeed = 1;
+  Store     = TestCreateStore ();
+  UT_ASSERT_NOT_NULL (Store);
+
+  for (Iteration = 0; Iteration < TEST_ITERATIONS; Iteration++) {
+    Number = TestRandom () % TEST_NAME_COUNT;
+    StrCpyS (Name, ARRAY_SIZE (Name), L"Var00");
+    Name[3] = (CHAR16)(L'0' + Number / 10);
+    Name[4] = (CHAR16)(L'0' + Number % 10);
+    switch (TestRandom () % 4) {
+      case 0:
+        State = VAR_DELETED & VAR_IN_DELETED_TRANSITION & VAR_ADDED;
+        break;
+      case 1:
+        State = VAR_IN_DELETED_TRANSITION & VAR_ADDED;
+        break;
+      default:
+        State = VAR_ADDED;
+        break;
+    }
+
+    Attributes = EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS;
+    if ((TestRandom () % 8) == 0) {
+      Attributes |= EFI_VARIABLE_HARDWARE_ERROR_RECORD;
+    }
+
+    if (TestAppendVariable (
+          Store,
+          Name,
+          ((TestRandom () % 2) == 0) ? &mTestSystemGuid : &mTestUserGuid,
+          State,
+          Attributes,
+          TestRandom () % 200
+          ) == NULL)
+    {
+      FreePool (Store);
+      Store = TestCreateStore ();
+      UT_ASSERT_NOT_NULL (Store);
+    }
+
+    RecalculateNvVariableTotalSize (Store);
+    TestReclaimStore (Store, &HwErrSize, &CommonSize, &UserSize);
+    UT_ASSERT_EQUAL (mTestModuleGlobal.HwErrVariableTotalSize, HwErrSize);
+    UT_ASSERT_EQUAL (mTestModuleGlobal.CommonVariableTotalSize, CommonSize);
+    UT_ASSERT_EQUAL (mTestModuleGlobal.CommonUserVariableTotalSize, UserSize);
+  }
+
+  FreePool (Store);
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Main entry point to the unit test.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ReclaimTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &ReclaimTests,
+             Framework,
+             "Variable Reclaim Tests",
+             "Variable.Reclaim",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for ReclaimTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    ReclaimTests,
+    "The NV total sizes should only count the records Reclaim keeps",
+    "KeptRecords",
+    RecalculateCountsOnlyKeptRecords,
+    NULL,
+    NULL,
+    NULL
+    );
+  AddTestCase (
+    ReclaimTests,
+    "The NV total sizes should match the reclaimed store",
+    "MatchesReclaim",
+    RecalculateMatchesReclaim,
+    NULL,
+    NULL,
+    NULL
+    );
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
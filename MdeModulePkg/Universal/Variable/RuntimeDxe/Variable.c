@@ -26,6 +26,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "Variable.h"
+#include "VariableIndex.h"
 #include "VariableNonVolatile.h"
 #include "VariableParsing.h"
 #include "VariableRuntimeCache.h"
@@ -53,6 +54,31 @@ VARIABLE_INFO_ENTRY  *gVariableInfo = NULL;
 ///
 BOOLEAN  mEndOfDxe = FALSE;
 
+///
+/// Offset in the NV variable store of the next incremental reclaim step, or 0
+/// if no incremental reclaim pass is in progress.
+///
+UINTN  mIncrementalReclaimOffset = 0;
+
+///
+/// NonVolatileLastVariableOffset at the end of the last incremental reclaim
+/// pass that found nothing to reclaim.
+///
+UINTN  mIncrementalReclaimCleanEnd = 0;
+
+///
+/// Bytes written to the NV variable store by the current incremental reclaim
+/// pass, and by all reclaims since boot.
+///
+UINTN   mIncrementalReclaimPassBytes = 0;
+UINT64  mReclaimBytesWritten         = 0;
+
+///
+/// Count of the writes to the non-volatile variable store. A batched update
+/// uses it to detect writes of other callers while the batch is staged.
+///
+UINTN  mNvVariableUpdateCount = 0;
+
 ///
 /// It indicates the var check request source.
 /// In the implementation, DXE is regarded as untrusted, and SMM is trusted.
@@ -146,6 +172,10 @@ UpdateVariableStore (
   FvVolHdr = 0;
   DataPtr  = DataPtrIndex;
 
+  if (!Volatile) {
+    mNvVariableUpdateCount++;
+  }
+
   //
   // Check if the Data is Volatile.
   //
@@ -768,37 +798,35 @@ Reclaim (
       mVariableModuleGlobal->CommonVariableTotalSize     = CommonVariableTotalSize;
       mVariableModuleGlobal->CommonUserVariableTotalSize = CommonUserVariableTotalSize;
     } else {
-      mVariableModuleGlobal->HwErrVariableTotalSize      = 0;
-      mVariableModuleGlobal->CommonVariableTotalSize     = 0;
-      mVariableModuleGlobal->CommonUserVariableTotalSize = 0;
-      Variable                                           = GetStartPointer ((VARIABLE_STORE_HEADER *)(UINTN)VariableBase);
-      while (IsValidVariableHeader (Variable, GetEndPointer ((VARIABLE_STORE_HEADER *)(UINTN)VariableBase))) {
-        NextVariable = GetNextVariablePtr (Variable, AuthFormat);
-        VariableSize = (UINTN)NextVariable - (UINTN)Variable;
-        if ((Variable->Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) == EFI_VARIABLE_HARDWARE_ERROR_RECORD) {
-          mVariableModuleGlobal->HwErrVariableTotalSize += VariableSize;
-        } else if ((Variable->Attributes & EFI_VARIABLE_HARDWARE_ERROR_RECORD) != EFI_VARIABLE_HARDWARE_ERROR_RECORD) {
-          mVariableModuleGlobal->CommonVariableTotalSize += VariableSize;
-          if (IsUserVariable (Variable)) {
-            mVariableModuleGlobal->CommonUserVariableTotalSize += VariableSize;
-          }
-        }
-
-        Variable = NextVariable;
-      }
-
-      *LastVariableOffset = (UINTN)Variable - (UINTN)VariableBase;
+      *LastVariableOffset = RecalculateNvVariableTotalSize ((VARIABLE_STORE_HEADER *)(UINTN)VariableBase);
     }
   }
 
 Done:
   DoneStatus = EFI_SUCCESS;
+  if (!IsVolatile) {
+    mNvVariableUpdateCount++;
+  }
+
   if (IsVolatile || mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
-    DoneStatus = SynchronizeRuntimeVariableCache (
-                   &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeVolatileCache,
-                   0,
-                   VariableStoreHeader->Size
-                   );
+    //
+    // Records have been moved, the index of the store has to be rebuilt.
+    //
+    VariableIndexInvalidate (VariableStoreHeader);
+    if (IsVolatile) {
+      DoneStatus = SynchronizeRuntimeVariableCache (
+                     &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeVolatileCache,
+                     0,
+                     VariableStoreHeader->Size
+                     );
+    } else {
+      DoneStatus = SynchronizeRuntimeVariableCache (
+                     &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache,
+                     0,
+                     VariableStoreHeader->Size
+                     );
+    }
+
     ASSERT_EFI_ERROR (DoneStatus);
     FreePool (ValidBuffer);
   } else {
@@ -806,6 +834,16 @@ Done:
     // For NV variable reclaim, we use mNvVariableCache as the buffer, so copy the data back.
     //
     CopyMem (mNvVariableCache, (UINT8 *)(UINTN)VariableBase, VariableStoreHeader->Size);
+    VariableIndexInvalidate (mNvVariableCache);
+    if (!EFI_ERROR (Status)) {
+      //
+      // A full reclaim supersedes any incremental reclaim pass in progress.
+      //
+      mIncrementalReclaimOffset = 0;
+      mReclaimBytesWritten     += VariableStoreHeader->Size;
+      DEBUG ((DEBUG_INFO, "Variable: reclaim rewrote 0x%x bytes, 0x%lx since boot\n", VariableStoreHeader->Size, mReclaimBytesWritten));
+    }
+
     DoneStatus = SynchronizeRuntimeVariableCache (
                    &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache,
                    0,
@@ -821,6 +859,263 @@ Done:
   return Status;
 }
 
+/**
+  Run one step of the incremental reclaim of the non-volatile variable store.
+
+  A pass walks the store from its start. Each step takes the records that
+  follow the first deleted record at the pass cursor, up to one FVB block of
+  records still in use, and rewrites them through FTW moved down over the
+  deleted records, followed by a deleted filler record that covers the space
+  they freed. The next step absorbs the filler, so the freed space travels
+  towards the end of the store. Once nothing but deleted records is left
+  behind the cursor, the filler is erased one block at a time, its header
+  last, which releases the space.
+
+  Each step is a single FTW write of a range whose old and new content
+  describe the same variables, so the store is consistent whenever power is
+  lost.
+
+  @retval TRUE    Records were moved out of the end of the store, so the
+                  filler is now the last record and can be erased.
+  @retval FALSE   Otherwise.
+
+**/
+BOOLEAN
+ReclaimIncrementalStep (
+  VOID
+  )
+{
+  EFI_STATUS             Status;
+  VARIABLE_STORE_HEADER  *VariableStoreHeader;
+  VARIABLE_HEADER        *Variable;
+  VARIABLE_HEADER        *NextVariable;
+  VARIABLE_HEADER        *Filler;
+  UINT8                  *Buffer;
+  UINT8                  *CurrPtr;
+  UINTN                  BlockSize;
+  UINTN                  FillerSize;
+  UINTN                  LastOffset;
+  UINTN                  StartOffset;
+  UINTN                  EndOffset;
+  UINTN                  DataOffset;
+  UINTN                  WriteOffset;
+  UINTN                  WriteSize;
+  UINTN                  KeptSize;
+  BOOLEAN                AuthFormat;
+  BOOLEAN                MoveRecords;
+
+  AuthFormat          = mVariableModuleGlobal->VariableGlobal.AuthFormat;
+  VariableStoreHeader = mNvVariableCache;
+  LastOffset          = mVariableModuleGlobal->NonVolatileLastVariableOffset;
+
+  if (mIncrementalReclaimOffset == 0) {
+    //
+    // Start a pass once half of the store is in use, unless nothing has been
+    // written since the last pass that had nothing to reclaim.
+    //
+    if ((LastOffset < VariableStoreHeader->Size / 2) || (LastOffset == mIncrementalReclaimCleanEnd)) {
+      return FALSE;
+    }
+
+    mIncrementalReclaimOffset    = (UINTN)GetStartPointer (VariableStoreHeader) - (UINTN)VariableStoreHeader;
+    mIncrementalReclaimPassBytes = 0;
+  }
+
+  BlockSize  = mNvFvHeaderCache->BlockMap[0].Length;
+  FillerSize = HEADER_ALIGN (GetVariableHeaderSize (AuthFormat) + sizeof (CHAR16) + GET_PAD_SIZE (sizeof (CHAR16)));
+
+  //
+  // Skip the records in use in front of the cursor, they stay where they are.
+  //
+  Variable = (VARIABLE_HEADER *)((UINTN)VariableStoreHeader + mIncrementalReclaimOffset);
+  while (IsValidVariableHeader (Variable, GetEndPointer (VariableStoreHeader)) &&
+         ((Variable->State == VAR_ADDED) || (Variable->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED))))
+  {
+    Variable = GetNextVariablePtr (Variable, AuthFormat);
+  }
+
+  StartOffset = (UINTN)Variable - (UINTN)VariableStoreHeader;
+  if (StartOffset >= LastOffset) {
+    //
+    // Nothing left to reclaim in this pass.
+    //
+    if (mIncrementalReclaimPassBytes == 0) {
+      mIncrementalReclaimCleanEnd = LastOffset;
+    }
+
+    mIncrementalReclaimOffset = 0;
+    return FALSE;
+  }
+
+  //
+  // Take the deleted records at the cursor and the records in use behind them,
+  // up to one block of records to move.
+  //
+  KeptSize = 0;
+  while (IsValidVariableHeader (Variable, GetEndPointer (VariableStoreHeader))) {
+    NextVariable = GetNextVariablePtr (Variable, AuthFormat);
+    if ((Variable->State == VAR_ADDED) || (Variable->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED))) {
+      if ((KeptSize != 0) && (KeptSize + ((UINTN)NextVariable - (UINTN)Variable) + FillerSize > BlockSize)) {
+        break;
+      }
+
+      KeptSize += (UINTN)NextVariable - (UINTN)Variable;
+    }
+
+    Variable = NextVariable;
+  }
+
+  EndOffset = (UINTN)Variable - (UINTN)VariableStoreHeader;
+  Variable    = (VARIABLE_HEADER *)((UINTN)VariableStoreHeader + StartOffset);
+  MoveRecords = (BOOLEAN)((KeptSize != 0) ||
+                          ((UINTN)GetNextVariablePtr (Variable, AuthFormat) != (UINTN)VariableStoreHeader + EndOffset));
+  if (MoveRecords) {
+    if (EndOffset - StartOffset - KeptSize < FillerSize) {
+      //
+      // Malformed records the filler cannot cover, leave them to Reclaim ().
+      //
+      mIncrementalReclaimCleanEnd = LastOffset;
+      mIncrementalReclaimOffset   = 0;
+      return FALSE;
+    }
+
+    //
+    // Move the records in use down and cover the rest of the range with a
+    // deleted filler record. Only the filler header has to be written, its
+    // data is whatever the range held before.
+    //
+    WriteOffset = StartOffset;
+    WriteSize   = KeptSize + FillerSize;
+  } else if (EndOffset == LastOffset) {
+    //
+    // A single deleted record is left up to the end of the store. Erase its
+    // content one block at a time, starting from the first byte not erased
+    // yet, and erase its header last so that the store stays walkable.
+    //
+    DataOffset = StartOffset + FillerSize;
+    while ((DataOffset < EndOffset) && (((UINT8 *)VariableStoreHeader)[DataOffset] == 0xff)) {
+      DataOffset++;
+    }
+
+    if (DataOffset == EndOffset) {
+      WriteOffset = StartOffset;
+      WriteSize   = FillerSize;
+    } else {
+      WriteOffset = DataOffset;
+      WriteSize   = MIN (EndOffset - DataOffset, BlockSize);
+    }
+  } else {
+    mIncrementalReclaimOffset = 0;
+    return FALSE;
+  }
+
+  Buffer = AllocatePool (WriteSize);
+  if (Buffer == NULL) {
+    return FALSE;
+  }
+
+  SetMem (Buffer, WriteSize, 0xff);
+  if (MoveRecords) {
+    CurrPtr  = Buffer;
+    Variable = (VARIABLE_HEADER *)((UINTN)VariableStoreHeader + StartOffset);
+    while ((UINTN)Variable < (UINTN)VariableStoreHeader + EndOffset) {
+      NextVariable = GetNextVariablePtr (Variable, AuthFormat);
+      if ((Variable->State == VAR_ADDED) || (Variable->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED))) {
+        CopyMem (CurrPtr, Variable, (UINTN)NextVariable - (UINTN)Variable);
+        CurrPtr += (UINTN)NextVariable - (UINTN)Variable;
+      }
+
+      Variable = NextVariable;
+    }
+
+    Filler = (VARIABLE_HEADER *)CurrPtr;
+    ZeroMem (Filler, FillerSize);
+    Filler->StartId    = VARIABLE_DATA;
+    Filler->State      = VAR_DELETED & VAR_IN_DELETED_TRANSITION & VAR_ADDED;
+    Filler->Attributes = EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS;
+    SetNameSizeOfVariable (Filler, sizeof (CHAR16), AuthFormat);
+    SetDataSizeOfVariable (Filler, EndOffset - StartOffset - KeptSize - GetVariableDataOffset (Filler, AuthFormat), AuthFormat);
+    ASSERT ((UINTN)GetNextVariablePtr (Filler, AuthFormat) - (UINTN)Filler == EndOffset - StartOffset - KeptSize);
+  }
+
+  mNvVariableUpdateCount++;
+  Status = FtwVariableSpaceRange (
+             mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase,
+             WriteOffset,
+             WriteSize,
+             Buffer
+             );
+  if (EFI_ERROR (Status)) {
+    FreePool (Buffer);
+    mIncrementalReclaimOffset = 0;
+    return FALSE;
+  }
+
+  //
+  // Update the memory copy of the Flash region.
+  //
+  CopyMem ((UINT8 *)VariableStoreHeader + WriteOffset, Buffer, WriteSize);
+  FreePool (Buffer);
+  VariableIndexInvalidate (VariableStoreHeader);
+  SynchronizeRuntimeVariableCache (
+    &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache,
+    WriteOffset,
+    WriteSize
+    );
+
+  mIncrementalReclaimPassBytes += WriteSize;
+  mReclaimBytesWritten         += WriteSize;
+  LastOffset                    = RecalculateNvVariableTotalSize (VariableStoreHeader);
+
+  if (KeptSize != 0) {
+    mIncrementalReclaimOffset = StartOffset + KeptSize;
+  } else if (LastOffset == StartOffset) {
+    //
+    // The last deleted record is gone, the pass is complete.
+    //
+    mVariableModuleGlobal->NonVolatileLastVariableOffset = LastOffset;
+    mIncrementalReclaimOffset                            = 0;
+    DEBUG ((
+      DEBUG_INFO,
+      "Variable: incremental reclaim rewrote 0x%x bytes, 0x%lx since boot\n",
+      mIncrementalReclaimPassBytes,
+      mReclaimBytesWritten
+      ));
+  } else {
+    mIncrementalReclaimOffset = StartOffset;
+  }
+
+  return (BOOLEAN)((KeptSize != 0) && (EndOffset == LastOffset));
+}
+
+/**
+  Reclaim part of the non-volatile variable store after a successful
+  SetVariable (), see ReclaimIncrementalStep ().
+
+  At most two blocks are written per call, which bounds the cost that a
+  SetVariable () call pays for reclaiming. The second step only runs when the
+  first one moved records appended after the space being reclaimed, so that
+  steady writes cannot keep that space from being released.
+
+**/
+VOID
+ReclaimIncremental (
+  VOID
+  )
+{
+  if (!FeaturePcdGet (PcdVariableIncrementalReclaim) ||
+      AtRuntime () ||
+      mVariableModuleGlobal->VariableGlobal.EmuNvMode ||
+      (mNvFvHeaderCache == NULL))
+  {
+    return;
+  }
+
+  if (ReclaimIncrementalStep ()) {
+    ReclaimIncrementalStep ();
+  }
+}
+
 /**
   Finds variable in storage blocks of volatile and non-volatile storage areas.
 
@@ -2573,15 +2868,12 @@ VariableServiceGetNextVariableName (
 }
 
 /**
-
-  This code sets variable in storage blocks (Volatile or Non-Volatile).
+  Check the parameters of a SetVariable () request before the variable
+  services lock is taken.
 
   Caution: This function may receive untrusted input.
   This function may be invoked in SMM mode, and datasize and data are external input.
   This function will do basic validation, before parse the data.
-  This function will parse the authentication carefully to avoid security issues, like
-  buffer overflow, integer overflow.
-  This function will check attribute carefully to avoid authentication bypass.
 
   @param VariableName                     Name of Variable to be found.
   @param VendorGuid                       Variable vendor GUID.
@@ -2590,24 +2882,13 @@ VariableServiceGetNextVariableName (
                                           data, this value contains the required size.
   @param Data                             Data pointer.
 
-  @retval EFI_SUCCESS                     The function completed successfully.
-  @retval EFI_NOT_FOUND                   The variable was not found.
-  @retval EFI_BUFFER_TOO_SMALL            The DataSize is too small for the result.
-  @retval EFI_INVALID_PARAMETER           VariableName is NULL.
-  @retval EFI_INVALID_PARAMETER           VendorGuid is NULL.
-  @retval EFI_INVALID_PARAMETER           DataSize is NULL.
-  @retval EFI_INVALID_PARAMETER           The DataSize is not too small and Data is NULL.
-  @retval EFI_DEVICE_ERROR                The variable could not be retrieved due to a hardware error.
-  @retval EFI_SECURITY_VIOLATION          The variable could not be retrieved due to an authentication failure.
-  @retval EFI_UNSUPPORTED                 After ExitBootServices() has been called, this return code may be returned
-                                          if no variable storage is supported. The platform should describe this
-                                          runtime service as unsupported at runtime via an EFI_RT_PROPERTIES_TABLE
-                                          configuration table.
+  @retval EFI_SUCCESS                     The request can be processed.
+  @retval EFI_ALREADY_STARTED             The request has been handled by SetVariableCheckHandlerMor ().
+  @return Others                          The request is rejected with this status.
 
 **/
 EFI_STATUS
-EFIAPI
-VariableServiceSetVariable (
+VariableServiceSetVariableCheck (
   IN CHAR16    *VariableName,
   IN EFI_GUID  *VendorGuid,
   IN UINT32    Attributes,
@@ -2615,12 +2896,9 @@ VariableServiceSetVariable (
   IN VOID      *Data
   )
 {
-  VARIABLE_POINTER_TRACK  Variable;
-  EFI_STATUS              Status;
-  VARIABLE_HEADER         *NextVariable;
-  EFI_PHYSICAL_ADDRESS    Point;
-  UINTN                   PayloadSize;
-  BOOLEAN                 AuthFormat;
+  EFI_STATUS  Status;
+  UINTN       PayloadSize;
+  BOOLEAN     AuthFormat;
 
   AuthFormat = mVariableModuleGlobal->VariableGlobal.AuthFormat;
 
@@ -2821,24 +3099,52 @@ VariableServiceSetVariable (
   // Special Handling for MOR Lock variable.
   //
   Status = SetVariableCheckHandlerMor (VariableName, VendorGuid, Attributes, PayloadSize, (VOID *)((UINTN)Data + DataSize - PayloadSize));
-  if (Status == EFI_ALREADY_STARTED) {
-    //
-    // EFI_ALREADY_STARTED means the SetVariable() action is handled inside of SetVariableCheckHandlerMor().
-    // Variable driver can just return SUCCESS.
-    //
-    return EFI_SUCCESS;
-  }
-
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
   Status = VarCheckLibSetVariableCheck (VariableName, VendorGuid, Attributes, PayloadSize, (VOID *)((UINTN)Data + DataSize - PayloadSize), mRequestSource);
-  if (EFI_ERROR (Status)) {
-    return Status;
-  }
+  return Status;
+}
 
-  AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+/**
+  Set the variable once the parameters of the request have been checked by
+  VariableServiceSetVariableCheck (). The caller holds the variable services
+  lock.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode, and datasize and data are external input.
+  This function will parse the authentication carefully to avoid security issues, like
+  buffer overflow, integer overflow.
+  This function will check attribute carefully to avoid authentication bypass.
+
+  @param VariableName                     Name of Variable to be found.
+  @param VendorGuid                       Variable vendor GUID.
+  @param Attributes                       Attribute value of the variable found
+  @param DataSize                         Size of Data found. If size is less than the
+                                          data, this value contains the required size.
+  @param Data                             Data pointer.
+
+  @retval EFI_SUCCESS                     The variable has been set.
+  @return Others                          The variable could not be set.
+
+**/
+EFI_STATUS
+VariableServiceSetVariableInternal (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN UINT32    Attributes,
+  IN UINTN     DataSize,
+  IN VOID      *Data
+  )
+{
+  VARIABLE_POINTER_TRACK  Variable;
+  EFI_STATUS              Status;
+  VARIABLE_HEADER         *NextVariable;
+  EFI_PHYSICAL_ADDRESS    Point;
+  BOOLEAN                 AuthFormat;
+
+  AuthFormat = mVariableModuleGlobal->VariableGlobal.AuthFormat;
 
   //
   // Consider reentrant in MCA/INIT/NMI. It needs be reupdated.
@@ -2898,8 +3204,75 @@ VariableServiceSetVariable (
     Status = UpdateVariable (VariableName, VendorGuid, Data, DataSize, Attributes, 0, 0, &Variable, NULL);
   }
 
+  if (!EFI_ERROR (Status)) {
+    ReclaimIncremental ();
+  }
+
 Done:
   InterlockedDecrement (&mVariableModuleGlobal->VariableGlobal.ReentrantState);
+  return Status;
+}
+
+/**
+
+  This code sets variable in storage blocks (Volatile or Non-Volatile).
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode, and datasize and data are external input.
+  This function will do basic validation, before parse the data.
+  This function will parse the authentication carefully to avoid security issues, like
+  buffer overflow, integer overflow.
+  This function will check attribute carefully to avoid authentication bypass.
+
+  @param VariableName                     Name of Variable to be found.
+  @param VendorGuid                       Variable vendor GUID.
+  @param Attributes                       Attribute value of the variable found
+  @param DataSize                         Size of Data found. If size is less than the
+                                          data, this value contains the required size.
+  @param Data                             Data pointer.
+
+  @retval EFI_SUCCESS                     The function completed successfully.
+  @retval EFI_NOT_FOUND                   The variable was not found.
+  @retval EFI_BUFFER_TOO_SMALL            The DataSize is too small for the result.
+  @retval EFI_INVALID_PARAMETER           VariableName is NULL.
+  @retval EFI_INVALID_PARAMETER           VendorGuid is NULL.
+  @retval EFI_INVALID_PARAMETER           DataSize is NULL.
+  @retval EFI_INVALID_PARAMETER           The DataSize is not too small and Data is NULL.
+  @retval EFI_DEVICE_ERROR                The variable could not be retrieved due to a hardware error.
+  @retval EFI_SECURITY_VIOLATION          The variable could not be retrieved due to an authentication failure.
+  @retval EFI_UNSUPPORTED                 After ExitBootServices() has been called, this return code may be returned
+                                          if no variable storage is supported. The platform should describe this
+                                          runtime service as unsupported at runtime via an EFI_RT_PROPERTIES_TABLE
+                                          configuration table.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableServiceSetVariable (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN UINT32    Attributes,
+  IN UINTN     DataSize,
+  IN VOID      *Data
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = VariableServiceSetVariableCheck (VariableName, VendorGuid, Attributes, DataSize, Data);
+  if (Status == EFI_ALREADY_STARTED) {
+    //
+    // EFI_ALREADY_STARTED means the SetVariable() action is handled inside of SetVariableCheckHandlerMor().
+    // Variable driver can just return SUCCESS.
+    //
+    return EFI_SUCCESS;
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+  Status = VariableServiceSetVariableInternal (VariableName, VendorGuid, Attributes, DataSize, Data);
   ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
 
   if (!AtRuntime ()) {
@@ -3794,6 +4167,8 @@ VariableCommonInitialize (
   VolatileVariableStore->Reserved  = 0;
   VolatileVariableStore->Reserved1 = 0;
 
+  VariableIndexRegister (VolatileVariableStore, VolatileVariableStore->Size, TRUE);
+
   return EFI_SUCCESS;
 }
 
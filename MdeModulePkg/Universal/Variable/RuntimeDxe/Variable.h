@@ -17,6 +17,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/Variable.h>
 #include <Protocol/VariableLock.h>
 #include <Protocol/VarCheck.h>
+#include <Protocol/VariableBatch.h>
 #include <Library/PcdLib.h>
 #include <Library/HobLib.h>
 #include <Library/UefiDriverEntryPoint.h>
@@ -157,6 +158,45 @@ FtwVariableSpace (
   IN VARIABLE_STORE_HEADER  *VariableBuffer
   );
 
+/**
+  Writes a buffer to a range of the variable storage space, in the working block.
+
+  This function writes a buffer to the variable storage space at the given
+  offset. Fault Tolerant Write protocol is used for writing, so the range is
+  either completely updated or left untouched when power is lost.
+
+  @param  VariableBase   Base address of the variable store.
+  @param  Offset         Offset of the range from VariableBase.
+  @param  Length         Length of the range in bytes.
+  @param  Buffer         Point to the new content of the range.
+
+  @retval EFI_SUCCESS    The function completed successfully.
+  @retval EFI_NOT_FOUND  Fail to locate Fault Tolerant Write protocol.
+  @retval EFI_ABORTED    The function could not complete successfully.
+
+**/
+EFI_STATUS
+FtwVariableSpaceRange (
+  IN EFI_PHYSICAL_ADDRESS  VariableBase,
+  IN UINTN                 Offset,
+  IN UINTN                 Length,
+  IN UINT8                 *Buffer
+  );
+
+/**
+  Recalculate the total sizes of the variables of the non-volatile variable
+  store from the records that Reclaim () keeps.
+
+  @param[in] VariableStoreHeader  Pointer to the non-volatile variable store.
+
+  @return Offset of the end of the last variable record in the store.
+
+**/
+UINTN
+RecalculateNvVariableTotalSize (
+  IN VARIABLE_STORE_HEADER  *VariableStoreHeader
+  );
+
 /**
   Finds variable in storage blocks of volatile and non-volatile storage areas.
 
@@ -552,6 +592,85 @@ VariableServiceSetVariable (
   IN VOID      *Data
   );
 
+/**
+  Check the parameters of a SetVariable () request before the variable
+  services lock is taken.
+
+  @param VariableName                     Name of Variable to be found.
+  @param VendorGuid                       Variable vendor GUID.
+  @param Attributes                       Attribute value of the variable found
+  @param DataSize                         Size of Data found. If size is less than the
+                                          data, this value contains the required size.
+  @param Data                             Data pointer.
+
+  @retval EFI_SUCCESS                     The request can be processed.
+  @retval EFI_ALREADY_STARTED             The request has been handled by SetVariableCheckHandlerMor ().
+  @return Others                          The request is rejected with this status.
+
+**/
+EFI_STATUS
+VariableServiceSetVariableCheck (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN UINT32    Attributes,
+  IN UINTN     DataSize,
+  IN VOID      *Data
+  );
+
+/**
+  Set the variable once the parameters of the request have been checked by
+  VariableServiceSetVariableCheck (). The caller holds the variable services
+  lock.
+
+  @param VariableName                     Name of Variable to be found.
+  @param VendorGuid                       Variable vendor GUID.
+  @param Attributes                       Attribute value of the variable found
+  @param DataSize                         Size of Data found. If size is less than the
+                                          data, this value contains the required size.
+  @param Data                             Data pointer.
+
+  @retval EFI_SUCCESS                     The variable has been set.
+  @return Others                          The variable could not be set.
+
+**/
+EFI_STATUS
+VariableServiceSetVariableInternal (
+  IN CHAR16    *VariableName,
+  IN EFI_GUID  *VendorGuid,
+  IN UINT32    Attributes,
+  IN UINTN     DataSize,
+  IN VOID      *Data
+  );
+
+/**
+  Set a group of non-volatile variables with a single update of the
+  non-volatile variable store.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode, and the entries are external input.
+  Every entry is checked as by VariableServiceSetVariable ().
+
+  @param[in]  EntryCount    Number of entries in Entries.
+  @param[in]  Entries       The variable updates.
+  @param[out] FailedEntry   Optional. Index of the entry that caused the batch to
+                            fail, or EntryCount if no single entry is responsible.
+
+  @retval EFI_SUCCESS            All the variable updates have been committed.
+  @retval EFI_INVALID_PARAMETER  Entries is NULL and EntryCount is not 0, or an
+                                 entry cannot be part of a batch.
+  @retval EFI_ABORTED            The variable store was updated by another caller
+                                 while the batch was staged.
+  @retval EFI_UNSUPPORTED        The service is called at OS runtime.
+  @return Others                 The error of the failing entry or of the commit.
+
+**/
+EFI_STATUS
+VariableServiceSetVariableBatch (
+  IN  UINTN                       EntryCount,
+  IN  EDKII_VARIABLE_BATCH_ENTRY  *Entries,
+  OUT UINTN                       *FailedEntry OPTIONAL
+  );
+
 /**
 
   This code returns information about the EFI variables.
@@ -696,6 +815,20 @@ VarCheckVariablePropertyGet (
   OUT VAR_CHECK_VARIABLE_PROPERTY  *VariableProperty
   );
 
+/**
+  Is user variable?
+
+  @param[in] Variable   Pointer to variable header.
+
+  @retval TRUE          User variable.
+  @retval FALSE         System variable.
+
+**/
+BOOLEAN
+IsUserVariable (
+  IN VARIABLE_HEADER  *Variable
+  );
+
 /**
   Initialize variable quota.
 
@@ -711,6 +844,8 @@ extern VARIABLE_STORE_HEADER       *mNvVariableCache;
 extern VARIABLE_INFO_ENTRY         *gVariableInfo;
 extern BOOLEAN                     mEndOfDxe;
 extern VAR_CHECK_REQUEST_SOURCE    mRequestSource;
+extern UINTN                       mNvVariableUpdateCount;
+extern UINTN                       mIncrementalReclaimOffset;
 
 extern AUTH_VAR_LIB_CONTEXT_OUT  mAuthContextOut;
 
@@ -0,0 +1,417 @@
+/** @file
+  Batched update of non-volatile variables.
+
+  The updates of a batch go through the regular SetVariable () path, running
+  in emulated non-volatile mode against a staging copy of the non-volatile
+  variable store. The range of the store that differs from the staging copy is
+  then written with one fault tolerant write, so a power loss leaves either all
+  or none of the updates in the store.
+
+  Caution: This module requires additional review when modified.
+  This driver will have external input - variable data. They may be input in SMM mode.
+  This external input must be validated carefully to avoid security issue like
+  buffer overflow, integer overflow.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Variable.h"
+#include "VariableIndex.h"
+#include "VariableRuntimeCache.h"
+
+#include <Guid/MemoryOverwriteControl.h>
+#include <IndustryStandard/MemoryOverwriteRequestControlLock.h>
+
+typedef struct {
+  CHAR16      *VariableName;
+  EFI_GUID    *VendorGuid;
+} VARIABLE_BATCH_EXCLUDED;
+
+typedef struct {
+  VARIABLE_STORE_HEADER     *NvVariableCache;
+  EFI_PHYSICAL_ADDRESS      NonVolatileVariableBase;
+  BOOLEAN                   EmuNvMode;
+  UINTN                     NonVolatileLastVariableOffset;
+  UINTN                     HwErrVariableTotalSize;
+  UINTN                     CommonVariableTotalSize;
+  UINTN                     CommonUserVariableTotalSize;
+  VARIABLE_RUNTIME_CACHE    RuntimeNvCache;
+} VARIABLE_NV_STORE_STATE;
+
+///
+/// Variables whose update changes state of the variable driver or of the
+/// authenticated variable library that cannot be rolled back.
+///
+VARIABLE_BATCH_EXCLUDED  mVariableBatchExcluded[] = {
+  { EFI_PLATFORM_KEY_NAME,                      &gEfiGlobalVariableGuid                    },
+  { EFI_LANG_VARIABLE_NAME,                     &gEfiGlobalVariableGuid                    },
+  { EFI_PLATFORM_LANG_VARIABLE_NAME,            &gEfiGlobalVariableGuid                    },
+  //
+  // The MOR variables are handled by SetVariableCheckHandlerMor () outside of
+  // the variable store.
+  //
+  { MEMORY_OVERWRITE_REQUEST_VARIABLE_NAME,     &gEfiMemoryOverwriteControlDataGuid        },
+  { MEMORY_OVERWRITE_REQUEST_CONTROL_LOCK_NAME, &gEfiMemoryOverwriteRequestControlLockGuid },
+};
+
+/**
+  Check whether a batch entry can be staged.
+
+  @param[in] Entry  The batch entry.
+
+  @retval TRUE   The entry can be staged.
+  @retval FALSE  The entry cannot be part of a batch.
+
+**/
+BOOLEAN
+VariableBatchIsEntryAllowed (
+  IN EDKII_VARIABLE_BATCH_ENTRY  *Entry
+  )
+{
+  UINTN  Index;
+
+  if ((Entry->VariableName == NULL) || (Entry->VendorGuid == NULL)) {
+    return FALSE;
+  }
+
+  if ((Entry->Attributes & EFI_VARIABLE_NON_VOLATILE) == 0) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mVariableBatchExcluded); Index++) {
+    if (CompareGuid (Entry->VendorGuid, mVariableBatchExcluded[Index].VendorGuid) &&
+        (StrCmp (Entry->VariableName, mVariableBatchExcluded[Index].VariableName) == 0))
+    {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Exchange the non-volatile variable store state of the variable driver with
+  the one in State.
+
+  @param[in, out] State  The state to activate, returns the previous state.
+
+**/
+VOID
+VariableBatchSwapNvStore (
+  IN OUT VARIABLE_NV_STORE_STATE  *State
+  )
+{
+  VARIABLE_NV_STORE_STATE  Current;
+  VARIABLE_RUNTIME_CACHE   *RuntimeNvCache;
+
+  RuntimeNvCache = &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache;
+
+  Current.NvVariableCache               = mNvVariableCache;
+  Current.NonVolatileVariableBase       = mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase;
+  Current.EmuNvMode                     = mVariableModuleGlobal->VariableGlobal.EmuNvMode;
+  Current.NonVolatileLastVariableOffset = mVariableModuleGlobal->NonVolatileLastVariableOffset;
+  Current.HwErrVariableTotalSize        = mVariableModuleGlobal->HwErrVariableTotalSize;
+  Current.CommonVariableTotalSize       = mVariableModuleGlobal->CommonVariableTotalSize;
+  Current.CommonUserVariableTotalSize   = mVariableModuleGlobal->CommonUserVariableTotalSize;
+  CopyMem (&Current.RuntimeNvCache, RuntimeNvCache, sizeof (VARIABLE_RUNTIME_CACHE));
+
+  mNvVariableCache                                              = State->NvVariableCache;
+  mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase = State->NonVolatileVariableBase;
+  mVariableModuleGlobal->VariableGlobal.EmuNvMode               = State->EmuNvMode;
+  mVariableModuleGlobal->NonVolatileLastVariableOffset          = State->NonVolatileLastVariableOffset;
+  mVariableModuleGlobal->HwErrVariableTotalSize                 = State->HwErrVariableTotalSize;
+  mVariableModuleGlobal->CommonVariableTotalSize                = State->CommonVariableTotalSize;
+  mVariableModuleGlobal->CommonUserVariableTotalSize            = State->CommonUserVariableTotalSize;
+  CopyMem (RuntimeNvCache, &State->RuntimeNvCache, sizeof (VARIABLE_RUNTIME_CACHE));
+
+  CopyMem (State, &Current, sizeof (VARIABLE_NV_STORE_STATE));
+}
+
+/**
+  Set one batch entry against the staging store.
+
+  The caller holds the variable services lock.
+
+  @param[in, out] Staging  State of the staging store.
+  @param[in]      Entry    The batch entry.
+
+  @return The status of VariableServiceSetVariableInternal ().
+
+**/
+EFI_STATUS
+VariableBatchStageEntry (
+  IN OUT VARIABLE_NV_STORE_STATE     *Staging,
+  IN     EDKII_VARIABLE_BATCH_ENTRY  *Entry
+  )
+{
+  EFI_STATUS              Status;
+  VARIABLE_RUNTIME_CACHE  *RuntimeNvCache;
+
+  VariableBatchSwapNvStore (Staging);
+  Status = VariableServiceSetVariableInternal (
+             Entry->VariableName,
+             Entry->VendorGuid,
+             Entry->Attributes,
+             Entry->DataSize,
+             Entry->Data
+             );
+  VariableBatchSwapNvStore (Staging);
+
+  //
+  // A flush of the runtime caches while the staging store was active clears
+  // the pending update flag. Keep any pending update of the runtime NV cache.
+  //
+  RuntimeNvCache = &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache;
+  if (RuntimeNvCache->PendingUpdateLength != 0) {
+    SynchronizeRuntimeVariableCache (
+      RuntimeNvCache,
+      RuntimeNvCache->PendingUpdateOffset,
+      RuntimeNvCache->PendingUpdateLength
+      );
+  }
+
+  return Status;
+}
+
+/**
+  Write the staging store to the non-volatile variable store.
+
+  The caller holds the variable services lock.
+
+  @param[in] Staging      State of the staging store.
+
+  @retval EFI_SUCCESS     The non-volatile variable store matches the staging store.
+  @return Others          The fault tolerant write failed, the store is unchanged.
+
+**/
+EFI_STATUS
+VariableBatchCommit (
+  IN VARIABLE_NV_STORE_STATE  *Staging
+  )
+{
+  EFI_STATUS              Status;
+  UINT8                   *Cache;
+  UINT8                   *Store;
+  UINTN                   StoreSize;
+  UINTN                   Start;
+  UINTN                   End;
+  VARIABLE_RUNTIME_CACHE  *RuntimeNvCache;
+
+  RuntimeNvCache = &mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache;
+  Cache          = (UINT8 *)mNvVariableCache;
+  Store          = (UINT8 *)Staging->NvVariableCache;
+  StoreSize      = mNvVariableCache->Size;
+
+  for (Start = 0; (Start < StoreSize) && (Cache[Start] == Store[Start]); Start++) {
+  }
+
+  if (Start == StoreSize) {
+    return EFI_SUCCESS;
+  }
+
+  for (End = StoreSize; (Cache[End - 1] == Store[End - 1]); End--) {
+  }
+
+  mNvVariableUpdateCount++;
+  if (!mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
+    Status = FtwVariableSpaceRange (
+               mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase,
+               Start,
+               End - Start,
+               Store + Start
+               );
+    if (EFI_ERROR (Status)) {
+      //
+      // Resynchronize the memory copy of the Flash region, as Reclaim () does.
+      //
+      CopyMem (mNvVariableCache, (VOID *)(UINTN)mVariableModuleGlobal->VariableGlobal.NonVolatileVariableBase, StoreSize);
+      VariableIndexInvalidate (mNvVariableCache);
+      mVariableModuleGlobal->NonVolatileLastVariableOffset = RecalculateNvVariableTotalSize (mNvVariableCache);
+      SynchronizeRuntimeVariableCache (RuntimeNvCache, 0, StoreSize);
+      return Status;
+    }
+  }
+
+  //
+  // Update the memory copy of the Flash region, which is the variable store
+  // itself in emulated non-volatile variable mode.
+  //
+  CopyMem (Cache + Start, Store + Start, End - Start);
+  mVariableModuleGlobal->NonVolatileLastVariableOffset = Staging->NonVolatileLastVariableOffset;
+  mVariableModuleGlobal->HwErrVariableTotalSize        = Staging->HwErrVariableTotalSize;
+  mVariableModuleGlobal->CommonVariableTotalSize       = Staging->CommonVariableTotalSize;
+  mVariableModuleGlobal->CommonUserVariableTotalSize   = Staging->CommonUserVariableTotalSize;
+
+  //
+  // The staged updates may have reclaimed the store, so records may have moved.
+  //
+  VariableIndexInvalidate (mNvVariableCache);
+  mIncrementalReclaimOffset = 0;
+  SynchronizeRuntimeVariableCache (RuntimeNvCache, Start, End - Start);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Set a group of non-volatile variables with a single update of the
+  non-volatile variable store.
+
+  Caution: This function may receive untrusted input.
+  This function may be invoked in SMM mode, and the entries are external input.
+  Every entry is checked as by VariableServiceSetVariable ().
+
+  @param[in]  EntryCount    Number of entries in Entries.
+  @param[in]  Entries       The variable updates.
+  @param[out] FailedEntry   Optional. Index of the entry that caused the batch to
+                            fail, or EntryCount if no single entry is responsible.
+
+  @retval EFI_SUCCESS            All the variable updates have been committed.
+  @retval EFI_INVALID_PARAMETER  Entries is NULL and EntryCount is not 0, or an
+                                 entry cannot be part of a batch.
+  @retval EFI_ABORTED            The variable store was updated by another caller
+                                 while the batch was staged.
+  @retval EFI_UNSUPPORTED        The service is called at OS runtime.
+  @return Others                 The error of the failing entry or of the commit.
+
+**/
+EFI_STATUS
+VariableServiceSetVariableBatch (
+  IN  UINTN                       EntryCount,
+  IN  EDKII_VARIABLE_BATCH_ENTRY  *Entries,
+  OUT UINTN                       *FailedEntry OPTIONAL
+  )
+{
+  EFI_STATUS               Status;
+  VARIABLE_NV_STORE_STATE  Staging;
+  UINTN                    UpdateCount;
+  UINTN                    Index;
+
+  if (FailedEntry != NULL) {
+    *FailedEntry = EntryCount;
+  }
+
+  if ((Entries == NULL) && (EntryCount != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (AtRuntime ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  for (Index = 0; Index < EntryCount; Index++) {
+    if (!VariableBatchIsEntryAllowed (&Entries[Index])) {
+      if (FailedEntry != NULL) {
+        *FailedEntry = Index;
+      }
+
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  if (EntryCount == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Staging.NvVariableCache = AllocatePool (mNvVariableCache->Size);
+  if (Staging.NvVariableCache == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+  Status = EFI_SUCCESS;
+  if ((mVariableModuleGlobal->FvbInstance == NULL) && !mVariableModuleGlobal->VariableGlobal.EmuNvMode) {
+    Status = EFI_NOT_AVAILABLE_YET;
+  } else if (mVariableModuleGlobal->VariableGlobal.HobVariableBase != 0) {
+    //
+    // The HOB variable store shadows the non-volatile one, and is flushed as a
+    // side effect of SetVariable (). Flush it first so that it stays out of
+    // the staging store.
+    //
+    FlushHobVariableToFlash (NULL, NULL);
+    if (mVariableModuleGlobal->VariableGlobal.HobVariableBase != 0) {
+      Status = EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+    FreePool (Staging.NvVariableCache);
+    return Status;
+  }
+
+  CopyMem (Staging.NvVariableCache, mNvVariableCache, mNvVariableCache->Size);
+  Staging.NonVolatileVariableBase       = (EFI_PHYSICAL_ADDRESS)(UINTN)Staging.NvVariableCache;
+  Staging.EmuNvMode                     = TRUE;
+  Staging.NonVolatileLastVariableOffset = mVariableModuleGlobal->NonVolatileLastVariableOffset;
+  Staging.HwErrVariableTotalSize        = mVariableModuleGlobal->HwErrVariableTotalSize;
+  Staging.CommonVariableTotalSize       = mVariableModuleGlobal->CommonVariableTotalSize;
+  Staging.CommonUserVariableTotalSize   = mVariableModuleGlobal->CommonUserVariableTotalSize;
+
+  //
+  // Updates of the runtime NV cache from the staging store are redirected to
+  // the staging store itself, and the real cache is updated on commit.
+  //
+  ZeroMem (&Staging.RuntimeNvCache, sizeof (VARIABLE_RUNTIME_CACHE));
+  if (mVariableModuleGlobal->VariableGlobal.VariableRuntimeCacheContext.VariableRuntimeNvCache.Store != NULL) {
+    Staging.RuntimeNvCache.Store = Staging.NvVariableCache;
+  }
+
+  UpdateCount = mNvVariableUpdateCount;
+  ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+
+  for (Index = 0; Index < EntryCount; Index++) {
+    Status = VariableServiceSetVariableCheck (
+               Entries[Index].VariableName,
+               Entries[Index].VendorGuid,
+               Entries[Index].Attributes,
+               Entries[Index].DataSize,
+               Entries[Index].Data
+               );
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+    if (mNvVariableUpdateCount != UpdateCount) {
+      Status = EFI_ABORTED;
+    } else {
+      Status      = VariableBatchStageEntry (&Staging, &Entries[Index]);
+      UpdateCount = mNvVariableUpdateCount;
+    }
+
+    ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  if (!EFI_ERROR (Status)) {
+    AcquireLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+    if (mNvVariableUpdateCount != UpdateCount) {
+      Status = EFI_ABORTED;
+    } else {
+      Status = VariableBatchCommit (&Staging);
+    }
+
+    ReleaseLockOnlyAtBootTime (&mVariableModuleGlobal->VariableGlobal.VariableServicesLock);
+  }
+
+  FreePool (Staging.NvVariableCache);
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Variable: batch of %d variables failed at entry %d - %r\n", EntryCount, Index, Status));
+    if ((FailedEntry != NULL) && (Index < EntryCount)) {
+      *FailedEntry = Index;
+    }
+
+    return Status;
+  }
+
+  for (Index = 0; Index < EntryCount; Index++) {
+    SecureBootHook (Entries[Index].VariableName, Entries[Index].VendorGuid);
+  }
+
+  return EFI_SUCCESS;
+}
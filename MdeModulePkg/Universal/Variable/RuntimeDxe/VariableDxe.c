@@ -11,6 +11,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
 #include "Variable.h"
+#include "VariableIndex.h"
 
 #include <Protocol/VariablePolicy.h>
 #include <Library/VariablePolicyLib.h>
@@ -21,6 +22,15 @@ ProtocolIsVariablePolicyEnabled (
   OUT BOOLEAN  *State
   );
 
+EFI_STATUS
+EFIAPI
+VariableBatchSetVariables (
+  IN CONST EDKII_VARIABLE_BATCH_PROTOCOL  *This,
+  IN       UINTN                          EntryCount,
+  IN       EDKII_VARIABLE_BATCH_ENTRY     *Entries,
+  OUT      UINTN                          *FailedEntry OPTIONAL
+  );
+
 EFI_HANDLE                      mHandle                      = NULL;
 EFI_EVENT                       mVirtualAddressChangeEvent   = NULL;
 VOID                            *mFtwRegistration            = NULL;
@@ -42,6 +52,7 @@ EDKII_VAR_CHECK_PROTOCOL        mVarCheck = {
   VarCheckVariablePropertySet,
   VarCheckVariablePropertyGet
 };
+EDKII_VARIABLE_BATCH_PROTOCOL   mVariableBatch = { VariableBatchSetVariables };
 
 /**
   Some Secure Boot Policy Variable may update following other variable changes(SecureBoot follows PK change, etc).
@@ -268,6 +279,13 @@ VariableClassAddressChangeEvent (
   EfiConvertPointer (0x0, (VOID **)&mNvVariableCache);
   EfiConvertPointer (0x0, (VOID **)&mNvFvHeaderCache);
 
+  for (Index = 0; Index < VARIABLE_INDEX_MAX_STORES; Index++) {
+    if (mVariableIndex[Index] != NULL) {
+      EfiConvertPointer (0x0, (VOID **)&mVariableIndex[Index]->VariableStore);
+      EfiConvertPointer (0x0, (VOID **)&mVariableIndex[Index]);
+    }
+  }
+
   if (mAuthContextOut.AddressPointer != NULL) {
     for (Index = 0; Index < mAuthContextOut.AddressPointerCount; Index++) {
       EfiConvertPointer (0x0, (VOID **)mAuthContextOut.AddressPointer[Index]);
@@ -521,6 +539,31 @@ ProtocolIsVariablePolicyEnabled (
   return EFI_SUCCESS;
 }
 
+/**
+  Set a group of non-volatile variables with a single update of the variable
+  store.
+
+  @param[in]  This          The EDKII_VARIABLE_BATCH_PROTOCOL instance.
+  @param[in]  EntryCount    Number of entries in Entries.
+  @param[in]  Entries       The variable updates.
+  @param[out] FailedEntry   Optional. Index of the entry that caused the batch to
+                            fail, or EntryCount if no single entry is responsible.
+
+  @return The status of VariableServiceSetVariableBatch ().
+
+**/
+EFI_STATUS
+EFIAPI
+VariableBatchSetVariables (
+  IN CONST EDKII_VARIABLE_BATCH_PROTOCOL  *This,
+  IN       UINTN                          EntryCount,
+  IN       EDKII_VARIABLE_BATCH_ENTRY     *Entries,
+  OUT      UINTN                          *FailedEntry OPTIONAL
+  )
+{
+  return VariableServiceSetVariableBatch (EntryCount, Entries, FailedEntry);
+}
+
 /**
   Variable Driver main entry point. The Variable driver places the 4 EFI
   runtime services in the EFI System Table and installs arch protocols
@@ -563,6 +606,14 @@ VariableServiceInitialize (
                   );
   ASSERT_EFI_ERROR (Status);
 
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &mHandle,
+                  &gEdkiiVariableBatchProtocolGuid,
+                  &mVariableBatch,
+                  NULL
+                  );
+  ASSERT_EFI_ERROR (Status);
+
   SystemTable->RuntimeServices->GetVariable         = VariableServiceGetVariable;
   SystemTable->RuntimeServices->GetNextVariableName = VariableServiceGetNextVariableName;
   SystemTable->RuntimeServices->SetVariable         = VariableServiceSetVariable;
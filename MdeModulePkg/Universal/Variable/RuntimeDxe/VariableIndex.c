@@ -0,0 +1,384 @@
+/** @file
+  Name and vendor GUID index over the records of a variable store.
+
+  Each registered store owns a table of buckets. A bucket chains, in store
+  order, the offsets of all records whose name and vendor GUID hash to it,
+  whatever their State. The State and the runtime access attribute are only
+  evaluated at lookup time, since UpdateVariable () changes them in place.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "VariableIndex.h"
+#include "VariableParsing.h"
+
+VARIABLE_INDEX  *mVariableIndex[VARIABLE_INDEX_MAX_STORES];
+
+/**
+  Get the index of a variable store.
+
+  @param[in] StartPtr   Start pointer of the variable store.
+
+  @return Pointer to the index, or NULL if the store has no index.
+
+**/
+VARIABLE_INDEX *
+VariableIndexGet (
+  IN VARIABLE_HEADER  *StartPtr
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < VARIABLE_INDEX_MAX_STORES; Index++) {
+    if ((mVariableIndex[Index] != NULL) &&
+        (GetStartPointer (mVariableIndex[Index]->VariableStore) == StartPtr))
+    {
+      return mVariableIndex[Index];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Hash a variable name and vendor GUID.
+
+  @param[in] Name       Pointer to the variable name.
+  @param[in] NameSize   Size of the variable name in bytes.
+  @param[in] Guid       Pointer to the vendor GUID.
+
+  @return Bucket number.
+
+**/
+UINTN
+VariableIndexHash (
+  IN CONST VOID  *Name,
+  IN UINTN       NameSize,
+  IN CONST VOID  *Guid
+  )
+{
+  CONST UINT8  *Bytes;
+  UINT32       Hash;
+  UINTN        Index;
+
+  Hash  = (UINT32)NameSize;
+  Bytes = Name;
+  for (Index = 0; Index < NameSize; Index++) {
+    Hash = (Hash * 31) + Bytes[Index];
+  }
+
+  Bytes = Guid;
+  for (Index = 0; Index < sizeof (EFI_GUID); Index++) {
+    Hash = (Hash * 31) + Bytes[Index];
+  }
+
+  Hash ^= Hash >> 16;
+  Hash ^= Hash >> 8;
+  return Hash % VARIABLE_INDEX_HASH_SIZE;
+}
+
+/**
+  Bring the index up to date with the records appended to the store since
+  the last lookup, or rebuild it after it was invalidated.
+
+  @param[in, out] VariableIndex   Pointer to the index.
+  @param[in]      EndPtr          End pointer of the variable store.
+  @param[in]      AuthFormat      TRUE indicates authenticated variables are used.
+                                  FALSE indicates authenticated variables are not used.
+
+  @retval TRUE    The index covers every record of the store.
+  @retval FALSE   The store holds more records than the index can describe,
+                  or its last record is not complete yet.
+
+**/
+BOOLEAN
+VariableIndexRefresh (
+  IN OUT VARIABLE_INDEX   *VariableIndex,
+  IN     VARIABLE_HEADER  *EndPtr,
+  IN     BOOLEAN          AuthFormat
+  )
+{
+  VARIABLE_INDEX_ENTRY  *Entry;
+  VARIABLE_HEADER       *Variable;
+  VARIABLE_HEADER       *NextVariable;
+  UINTN                 NameSize;
+  UINTN                 Bucket;
+  UINTN                 Index;
+
+  if (!VariableIndex->Valid) {
+    for (Index = 0; Index < VARIABLE_INDEX_HASH_SIZE; Index++) {
+      VariableIndex->Head[Index] = VARIABLE_INDEX_END;
+      VariableIndex->Tail[Index] = VARIABLE_INDEX_END;
+    }
+
+    VariableIndex->Count      = 0;
+    VariableIndex->Overflow   = FALSE;
+    VariableIndex->IndexedEnd = (UINT32)((UINTN)GetStartPointer (VariableIndex->VariableStore) - (UINTN)VariableIndex->VariableStore);
+    VariableIndex->Valid      = TRUE;
+  }
+
+  if (VariableIndex->Overflow) {
+    return FALSE;
+  }
+
+  Entry    = (VARIABLE_INDEX_ENTRY *)(VariableIndex + 1);
+  Variable = (VARIABLE_HEADER *)((UINTN)VariableIndex->VariableStore + VariableIndex->IndexedEnd);
+  while (IsValidVariableHeader (Variable, EndPtr)) {
+    NameSize     = NameSizeOfVariable (Variable, AuthFormat);
+    NextVariable = GetNextVariablePtr (Variable, AuthFormat);
+    if ((NextVariable <= Variable) ||
+        ((UINTN)GetVariableNamePtr (Variable, AuthFormat) + NameSize > (UINTN)EndPtr))
+    {
+      //
+      // Not a complete record yet. Leave the store to the linear walk and
+      // retry from this record on the next lookup.
+      //
+      VariableIndex->IndexedEnd = (UINT32)((UINTN)Variable - (UINTN)VariableIndex->VariableStore);
+      return FALSE;
+    }
+
+    if (VariableIndex->Count == VariableIndex->Capacity) {
+      VariableIndex->Overflow = TRUE;
+      return FALSE;
+    }
+
+    Bucket                             = VariableIndexHash (GetVariableNamePtr (Variable, AuthFormat), NameSize, GetVendorGuidPtr (Variable, AuthFormat));
+    Entry[VariableIndex->Count].Offset = (UINT32)((UINTN)Variable - (UINTN)VariableIndex->VariableStore);
+    Entry[VariableIndex->Count].Next   = VARIABLE_INDEX_END;
+    if (VariableIndex->Tail[Bucket] == VARIABLE_INDEX_END) {
+      VariableIndex->Head[Bucket] = VariableIndex->Count;
+    } else {
+      Entry[VariableIndex->Tail[Bucket]].Next = VariableIndex->Count;
+    }
+
+    VariableIndex->Tail[Bucket] = VariableIndex->Count;
+    VariableIndex->Count++;
+
+    Variable = NextVariable;
+  }
+
+  VariableIndex->IndexedEnd = (UINT32)((UINTN)Variable - (UINTN)VariableIndex->VariableStore);
+  return TRUE;
+}
+
+/**
+  Create an index for a variable store.
+
+  The index is allocated from runtime pool and built on the first lookup. If
+  the allocation fails or too many stores are registered, lookups in the store
+  keep using the linear walk.
+
+  @param[in] VariableStore   Pointer to the variable store header.
+  @param[in] StoreSize       Size of the variable store in bytes.
+  @param[in] Authoritative   TRUE if the caller reports every rewrite of the
+                             store through VariableIndexInvalidate ().
+
+**/
+VOID
+VariableIndexRegister (
+  IN VARIABLE_STORE_HEADER  *VariableStore,
+  IN UINTN                  StoreSize,
+  IN BOOLEAN                Authoritative
+  )
+{
+  VARIABLE_INDEX  *VariableIndex;
+  UINTN           Capacity;
+  UINTN           Index;
+
+  if ((VariableStore == NULL) || (VariableIndexGet (GetStartPointer (VariableStore)) != NULL)) {
+    return;
+  }
+
+  for (Index = 0; Index < VARIABLE_INDEX_MAX_STORES; Index++) {
+    if (mVariableIndex[Index] == NULL) {
+      break;
+    }
+  }
+
+  if (Index == VARIABLE_INDEX_MAX_STORES) {
+    return;
+  }
+
+  Capacity      = StoreSize / VARIABLE_INDEX_MIN_RECORD_SIZE;
+  VariableIndex = AllocateRuntimeZeroPool (sizeof (VARIABLE_INDEX) + Capacity * sizeof (VARIABLE_INDEX_ENTRY));
+  if (VariableIndex == NULL) {
+    return;
+  }
+
+  VariableIndex->VariableStore = VariableStore;
+  VariableIndex->Authoritative = Authoritative;
+  VariableIndex->Capacity      = (UINT32)Capacity;
+  mVariableIndex[Index]        = VariableIndex;
+}
+
+/**
+  Remove and free the index of a variable store.
+
+  Must not be called at OS runtime.
+
+  @param[in] VariableStore   Pointer to the variable store header.
+
+**/
+VOID
+VariableIndexUnregister (
+  IN VARIABLE_STORE_HEADER  *VariableStore
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < VARIABLE_INDEX_MAX_STORES; Index++) {
+    if ((mVariableIndex[Index] != NULL) && (mVariableIndex[Index]->VariableStore == VariableStore)) {
+      FreePool (mVariableIndex[Index]);
+      mVariableIndex[Index] = NULL;
+    }
+  }
+}
+
+/**
+  Discard the content of the index of a variable store so that it is rebuilt
+  on the next lookup. Must be called whenever records of the store are moved,
+  e.g. by Reclaim ().
+
+  @param[in] VariableStore   Pointer to the variable store header. Stores
+                             without an index are ignored.
+
+**/
+VOID
+VariableIndexInvalidate (
+  IN VARIABLE_STORE_HEADER  *VariableStore
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < VARIABLE_INDEX_MAX_STORES; Index++) {
+    if ((mVariableIndex[Index] != NULL) && (mVariableIndex[Index]->VariableStore == VariableStore)) {
+      mVariableIndex[Index]->Valid = FALSE;
+    }
+  }
+}
+
+/**
+  Find the variable in the variable store described by PtrTrack through the
+  index of that store.
+
+  For an authoritative index the result is identical to the one of the linear
+  walk in FindVariableEx (). For a hint index only a verified VAR_ADDED
+  record is returned and InDeletedTransitionPtr is not reported.
+
+  @param[in]       VariableName        Name of the variable to be found, not empty.
+  @param[in]       VendorGuid          Vendor GUID to be found.
+  @param[in]       IgnoreRtCheck       Ignore EFI_VARIABLE_RUNTIME_ACCESS attribute
+                                       check at runtime when searching variable.
+  @param[in, out]  PtrTrack            Variable Track Pointer structure that contains Variable Information.
+  @param[in]       AuthFormat          TRUE indicates authenticated variables are used.
+                                       FALSE indicates authenticated variables are not used.
+
+  @retval EFI_SUCCESS         Variable found successfully.
+  @retval EFI_NOT_FOUND       Variable not found.
+  @retval EFI_UNSUPPORTED     The store has no usable index, or the hint index
+                              has no verified hit; the caller must walk the store.
+
+**/
+EFI_STATUS
+VariableIndexFind (
+  IN     CHAR16                  *VariableName,
+  IN     EFI_GUID                *VendorGuid,
+  IN     BOOLEAN                 IgnoreRtCheck,
+  IN OUT VARIABLE_POINTER_TRACK  *PtrTrack,
+  IN     BOOLEAN                 AuthFormat
+  )
+{
+  VARIABLE_INDEX        *VariableIndex;
+  VARIABLE_INDEX_ENTRY  *Entry;
+  VARIABLE_HEADER       *Variable;
+  VARIABLE_HEADER       *InDeletedVariable;
+  UINTN                 NameSize;
+  UINT32                Slot;
+
+  VariableIndex = VariableIndexGet (PtrTrack->StartPtr);
+  if ((VariableIndex == NULL) ||
+      (PtrTrack->EndPtr != GetEndPointer (VariableIndex->VariableStore)) ||
+      !VariableIndexRefresh (VariableIndex, PtrTrack->EndPtr, AuthFormat))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  NameSize          = StrSize (VariableName);
+  Entry             = (VARIABLE_INDEX_ENTRY *)(VariableIndex + 1);
+  InDeletedVariable = NULL;
+
+  for ( Slot = VariableIndex->Head[VariableIndexHash (VariableName, NameSize, VendorGuid)]
+        ; Slot != VARIABLE_INDEX_END
+        ; Slot = Entry[Slot].Next
+        )
+  {
+    Variable = (VARIABLE_HEADER *)((UINTN)VariableIndex->VariableStore + Entry[Slot].Offset);
+    if (!VariableIndex->Authoritative) {
+      //
+      // The store may have been rewritten behind the index, so make sure the
+      // slot still holds a complete record before looking into it.
+      //
+      if (!IsValidVariableHeader (Variable, PtrTrack->EndPtr) ||
+          ((UINTN)GetVariableNamePtr (Variable, AuthFormat) + NameSize > (UINTN)PtrTrack->EndPtr) ||
+          (Variable->State != VAR_ADDED))
+      {
+        continue;
+      }
+    }
+
+    if ((Variable->State != VAR_ADDED) &&
+        (Variable->State != (VAR_IN_DELETED_TRANSITION & VAR_ADDED)))
+    {
+      continue;
+    }
+
+    if (!IgnoreRtCheck && AtRuntime () && ((Variable->Attributes & EFI_VARIABLE_RUNTIME_ACCESS) == 0)) {
+      continue;
+    }
+
+    if ((NameSizeOfVariable (Variable, AuthFormat) != NameSize) ||
+        !CompareGuid (VendorGuid, GetVendorGuidPtr (Variable, AuthFormat)) ||
+        (CompareMem (VariableName, GetVariableNamePtr (Variable, AuthFormat), NameSize) != 0))
+    {
+      continue;
+    }
+
+    if (Variable->State == (VAR_IN_DELETED_TRANSITION & VAR_ADDED)) {
+      InDeletedVariable = Variable;
+    } else {
+      PtrTrack->CurrPtr                = Variable;
+      PtrTrack->InDeletedTransitionPtr = InDeletedVariable;
+      return EFI_SUCCESS;
+    }
+  }
+
+  if (!VariableIndex->Authoritative) {
+    return EFI_UNSUPPORTED;
+  }
+
+  PtrTrack->CurrPtr                = InDeletedVariable;
+  PtrTrack->InDeletedTransitionPtr = NULL;
+  return (PtrTrack->CurrPtr == NULL) ? EFI_NOT_FOUND : EFI_SUCCESS;
+}
+
+/**
+  Report that the linear walk of a store found a variable that the hint index
+  of the store did not, so that the index is rebuilt on the next lookup.
+
+  @param[in] PtrTrack   Variable Track Pointer structure used for the walk.
+
+**/
+VOID
+VariableIndexMissed (
+  IN VARIABLE_POINTER_TRACK  *PtrTrack
+  )
+{
+  VARIABLE_INDEX  *VariableIndex;
+
+  VariableIndex = VariableIndexGet (PtrTrack->StartPtr);
+  if ((VariableIndex != NULL) && !VariableIndex->Authoritative && !VariableIndex->Overflow) {
+    VariableIndex->Valid = FALSE;
+  }
+}
@@ -0,0 +1,163 @@
+/** @file
+  Name and vendor GUID index over the records of a variable store.
+
+  The index lets FindVariableEx () locate a variable without walking every
+  record of the store. It holds store offsets rather than pointers so it stays
+  valid across SetVirtualAddressMap (), and it picks up newly appended records
+  lazily on the next lookup.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _VARIABLE_INDEX_H_
+#define _VARIABLE_INDEX_H_
+
+#include "Variable.h"
+
+#define VARIABLE_INDEX_HASH_SIZE        0x100
+#define VARIABLE_INDEX_MAX_STORES       4
+#define VARIABLE_INDEX_END              MAX_UINT32
+
+//
+// Records smaller than this are uncommon; the index is sized for one entry per
+// VARIABLE_INDEX_MIN_RECORD_SIZE bytes of store and falls back to the linear
+// walk when a store holds more records than that.
+//
+#define VARIABLE_INDEX_MIN_RECORD_SIZE  (sizeof (VARIABLE_HEADER) + 16)
+
+typedef struct {
+  ///
+  /// Offset of the variable header from the start of the variable store.
+  ///
+  UINT32    Offset;
+  ///
+  /// Next entry of the same bucket, in store order.
+  ///
+  UINT32    Next;
+} VARIABLE_INDEX_ENTRY;
+
+typedef struct {
+  ///
+  /// Variable store the index describes.
+  ///
+  VARIABLE_STORE_HEADER    *VariableStore;
+  ///
+  /// TRUE if every change to the store other than appending a record or
+  /// updating a record's State is reported by VariableIndexInvalidate ().
+  /// Otherwise the index is only used as a hint and every hit is verified.
+  ///
+  BOOLEAN                  Authoritative;
+  BOOLEAN                  Valid;
+  BOOLEAN                  Overflow;
+  ///
+  /// Offset of the first byte of the store that has not been indexed yet.
+  ///
+  UINT32                   IndexedEnd;
+  UINT32                   Count;
+  UINT32                   Capacity;
+  UINT32                   Head[VARIABLE_INDEX_HASH_SIZE];
+  UINT32                   Tail[VARIABLE_INDEX_HASH_SIZE];
+  //
+  // VARIABLE_INDEX_ENTRY   Entry[Capacity];
+  //
+} VARIABLE_INDEX;
+
+///
+/// Indexes of the registered variable stores. Exposed so that the runtime
+/// modules can convert the pointers on SetVirtualAddressMap ().
+///
+extern VARIABLE_INDEX  *mVariableIndex[VARIABLE_INDEX_MAX_STORES];
+
+/**
+  Create an index for a variable store.
+
+  The index is allocated from runtime pool and built on the first lookup. If
+  the allocation fails or too many stores are registered, lookups in the store
+  keep using the linear walk.
+
+  @param[in] VariableStore   Pointer to the variable store header.
+  @param[in] StoreSize       Size of the variable store in bytes.
+  @param[in] Authoritative   TRUE if the caller reports every rewrite of the
+                             store through VariableIndexInvalidate ().
+
+**/
+VOID
+VariableIndexRegister (
+  IN VARIABLE_STORE_HEADER  *VariableStore,
+  IN UINTN                  StoreSize,
+  IN BOOLEAN                Authoritative
+  );
+
+/**
+  Remove and free the index of a variable store.
+
+  Must not be called at OS runtime.
+
+  @param[in] VariableStore   Pointer to the variable store header.
+
+**/
+VOID
+VariableIndexUnregister (
+  IN VARIABLE_STORE_HEADER  *VariableStore
+  );
+
+/**
+  Discard the content of the index of a variable store so that it is rebuilt
+  on the next lookup. Must be called whenever records of the store are moved,
+  e.g. by Reclaim ().
+
+  @param[in] VariableStore   Pointer to the variable store header. Stores
+                             without an index are ignored.
+
+**/
+VOID
+VariableIndexInvalidate (
+  IN VARIABLE_STORE_HEADER  *VariableStore
+  );
+
+/**
+  Find the variable in the variable store described by PtrTrack through the
+  index of that store.
+
+  For an authoritative index the result is identical to the one of the linear
+  walk in FindVariableEx (). For a hint index only a verified VAR_ADDED
+  record is returned and InDeletedTransitionPtr is not reported.
+
+  @param[in]       VariableName        Name of the variable to be found, not empty.
+  @param[in]       VendorGuid          Vendor GUID to be found.
+  @param[in]       IgnoreRtCheck       Ignore EFI_VARIABLE_RUNTIME_ACCESS attribute
+                                       check at runtime when searching variable.
+  @param[in, out]  PtrTrack            Variable Track Pointer structure that contains Variable Information.
+  @param[in]       AuthFormat          TRUE indicates authenticated variables are used.
+                                       FALSE indicates authenticated variables are not used.
+
+  @retval EFI_SUCCESS         Variable found successfully.
+  @retval EFI_NOT_FOUND       Variable not found.
+  @retval EFI_UNSUPPORTED     The store has no usable index, or the hint index
+                              has no verified hit; the caller must walk the store.
+
+**/
+EFI_STATUS
+VariableIndexFind (
+  IN     CHAR16                  *VariableName,
+  IN     EFI_GUID                *VendorGuid,
+  IN     BOOLEAN                 IgnoreRtCheck,
+  IN OUT VARIABLE_POINTER_TRACK  *PtrTrack,
+  IN     BOOLEAN                 AuthFormat
+  );
+
+/**
+  Report that the linear walk of a store found a variable that the hint index
+  of the store did not, so that the index is rebuilt on the next lookup.
+
+  @param[in] PtrTrack   Variable Track Pointer structure used for the walk.
+
+**/
+VOID
+VariableIndexMissed (
+  IN VARIABLE_POINTER_TRACK  *PtrTrack
+  );
+
+#endif
@@ -7,6 +7,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
+#include "VariableIndex.h"
 #include "VariableParsing.h"
 
 /**
@@ -470,9 +471,19 @@ FindVariableEx (
 {
   VARIABLE_HEADER  *InDeletedVariable;
   VOID             *Point;
+  EFI_STATUS       Status;
 
   PtrTrack->InDeletedTransitionPtr = NULL;
 
+  if (VariableName[0] != 0) {
+    Status = VariableIndexFind (VariableName, VendorGuid, IgnoreRtCheck, PtrTrack, AuthFormat);
+    if (Status != EFI_UNSUPPORTED) {
+      return Status;
+    }
+
+    PtrTrack->InDeletedTransitionPtr = NULL;
+  }
+
   //
   // Find the variable by walk through HOB, volatile and non-volatile variable store.
   //
@@ -505,6 +516,7 @@ FindVariableEx (
                 InDeletedVariable = PtrTrack->CurrPtr;
               } else {
                 PtrTrack->InDeletedTransitionPtr = InDeletedVariable;
+                VariableIndexMissed (PtrTrack);
                 return EFI_SUCCESS;
               }
             }
@@ -40,6 +40,14 @@ BOOLEAN  mAtRuntime              = FALSE;
 UINT8    *mVariableBufferPayload = NULL;
 UINTN    mVariableBufferPayloadSize;
 
+///
+/// Entries of the batched SetVariable () request being staged, stored as
+/// SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE records aligned on sizeof (UINTN).
+///
+UINT8  *mVariableBatchBuffer    = NULL;
+UINTN  mVariableBatchBufferSize = 0;
+UINTN  mVariableBatchEntryCount = 0;
+
 /**
   SecureBoot Hook for SetVariable.
 
@@ -424,6 +432,204 @@ SmmVariableGetStatistics (
   return EFI_SUCCESS;
 }
 
+/**
+  Discard the entries of the batched SetVariable () request being staged.
+
+**/
+VOID
+SmmVariableBatchReset (
+  VOID
+  )
+{
+  if (mVariableBatchBuffer != NULL) {
+    FreePool (mVariableBatchBuffer);
+  }
+
+  mVariableBatchBuffer     = NULL;
+  mVariableBatchBufferSize = 0;
+  mVariableBatchEntryCount = 0;
+}
+
+/**
+  Stage entries of a batched SetVariable () request.
+
+  Caution: This function may receive untrusted input.
+  The payload is external input, so this function will validate every entry
+  as the SMM_VARIABLE_FUNCTION_SET_VARIABLE handler does.
+
+  @param[in] Batch          Payload copied to SMRAM: the batch header followed by
+                            the entries.
+  @param[in] PayloadSize    Size of the payload in bytes.
+
+  @retval EFI_SUCCESS            The entries have been staged.
+  @retval EFI_ACCESS_DENIED      An entry is malformed.
+  @retval EFI_INVALID_PARAMETER  The entries do not follow the staged ones.
+  @retval EFI_OUT_OF_RESOURCES   The staged entries do not fit in the variable store.
+  @retval EFI_UNSUPPORTED        The function is called at OS runtime.
+
+**/
+EFI_STATUS
+SmmVariableBatchStage (
+  IN SMM_VARIABLE_COMMUNICATE_BATCH  *Batch,
+  IN UINTN                           PayloadSize
+  )
+{
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE  *Entry;
+  UINTN                                     Offset;
+  UINTN                                     EntrySize;
+  UINTN                                     StagedSize;
+  UINTN                                     Index;
+  UINT8                                     *Buffer;
+
+  if ((Batch->EntryIndex == 0) || AtRuntime ()) {
+    SmmVariableBatchReset ();
+  }
+
+  if (AtRuntime ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Batch->EntryIndex != mVariableBatchEntryCount) {
+    SmmVariableBatchReset ();
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Offset     = sizeof (SMM_VARIABLE_COMMUNICATE_BATCH);
+  StagedSize = 0;
+  for (Index = 0; Index < Batch->EntryCount; Index++) {
+    if (PayloadSize - Offset < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)) {
+      SmmVariableBatchReset ();
+      return EFI_ACCESS_DENIED;
+    }
+
+    Entry = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)((UINT8 *)Batch + Offset);
+    if (((UINTN)(~0) - Entry->DataSize < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name)) ||
+        ((UINTN)(~0) - Entry->NameSize < OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + Entry->DataSize))
+    {
+      //
+      // Prevent EntrySize overflow happen
+      //
+      SmmVariableBatchReset ();
+      return EFI_ACCESS_DENIED;
+    }
+
+    EntrySize = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + Entry->DataSize + Entry->NameSize;
+    if (EntrySize > PayloadSize - Offset) {
+      DEBUG ((DEBUG_ERROR, "StageBatch: Data size exceed communication buffer size limit!\n"));
+      SmmVariableBatchReset ();
+      return EFI_ACCESS_DENIED;
+    }
+
+    //
+    // The VariableSpeculationBarrier() call here is to ensure the previous
+    // range/content checks for the CommBuffer have been completed before the
+    // subsequent consumption of the CommBuffer content.
+    //
+    VariableSpeculationBarrier ();
+    if ((Entry->NameSize < sizeof (CHAR16)) || (Entry->Name[Entry->NameSize/sizeof (CHAR16) - 1] != L'\0')) {
+      //
+      // Make sure VariableName is A Null-terminated string.
+      //
+      SmmVariableBatchReset ();
+      return EFI_ACCESS_DENIED;
+    }
+
+    StagedSize += ALIGN_VALUE (EntrySize, sizeof (UINTN));
+    Offset     += MIN (ALIGN_VALUE (EntrySize, sizeof (UINTN)), PayloadSize - Offset);
+  }
+
+  //
+  // A batch cannot change more than the whole variable store.
+  //
+  if (StagedSize > mNvVariableCache->Size - mVariableBatchBufferSize) {
+    SmmVariableBatchReset ();
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (StagedSize == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Buffer = AllocatePool (mVariableBatchBufferSize + StagedSize);
+  if (Buffer == NULL) {
+    SmmVariableBatchReset ();
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (mVariableBatchBuffer != NULL) {
+    CopyMem (Buffer, mVariableBatchBuffer, mVariableBatchBufferSize);
+    FreePool (mVariableBatchBuffer);
+  }
+
+  mVariableBatchBuffer = Buffer;
+  Offset               = sizeof (SMM_VARIABLE_COMMUNICATE_BATCH);
+  for (Index = 0; Index < Batch->EntryCount; Index++) {
+    Entry     = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)((UINT8 *)Batch + Offset);
+    EntrySize = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + Entry->DataSize + Entry->NameSize;
+    CopyMem (mVariableBatchBuffer + mVariableBatchBufferSize, Entry, EntrySize);
+    mVariableBatchBufferSize += ALIGN_VALUE (EntrySize, sizeof (UINTN));
+    Offset                   += MIN (ALIGN_VALUE (EntrySize, sizeof (UINTN)), PayloadSize - Offset);
+  }
+
+  mVariableBatchEntryCount += Batch->EntryCount;
+  return EFI_SUCCESS;
+}
+
+/**
+  Commit the batched SetVariable () request that has been staged.
+
+  The staged entries are discarded whether or not the commit succeeds.
+
+  @param[in]  EntryCount    Number of entries in the batch, as seen by the caller.
+  @param[out] FailedEntry   Index of the entry that caused the batch to fail, or
+                            EntryCount if no single entry is responsible.
+
+  @retval EFI_INVALID_PARAMETER  EntryCount does not match the staged entries.
+  @return Others                 The status of VariableServiceSetVariableBatch ().
+
+**/
+EFI_STATUS
+SmmVariableBatchCommit (
+  IN  UINTN  EntryCount,
+  OUT UINTN  *FailedEntry
+  )
+{
+  EFI_STATUS                                Status;
+  EDKII_VARIABLE_BATCH_ENTRY                *Entries;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE  *Entry;
+  UINTN                                     Offset;
+  UINTN                                     Index;
+
+  *FailedEntry = EntryCount;
+  if ((EntryCount != mVariableBatchEntryCount) || (EntryCount == 0)) {
+    SmmVariableBatchReset ();
+    return (EntryCount == 0) ? EFI_SUCCESS : EFI_INVALID_PARAMETER;
+  }
+
+  Entries = AllocatePool (EntryCount * sizeof (EDKII_VARIABLE_BATCH_ENTRY));
+  if (Entries == NULL) {
+    SmmVariableBatchReset ();
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Offset = 0;
+  for (Index = 0; Index < EntryCount; Index++) {
+    Entry                       = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)(mVariableBatchBuffer + Offset);
+    Entries[Index].VariableName = Entry->Name;
+    Entries[Index].VendorGuid   = &Entry->Guid;
+    Entries[Index].Attributes   = Entry->Attributes;
+    Entries[Index].DataSize     = Entry->DataSize;
+    Entries[Index].Data         = (UINT8 *)Entry->Name + Entry->NameSize;
+    Offset                     += ALIGN_VALUE (OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + Entry->DataSize + Entry->NameSize, sizeof (UINTN));
+  }
+
+  Status = VariableServiceSetVariableBatch (EntryCount, Entries, FailedEntry);
+
+  FreePool (Entries);
+  SmmVariableBatchReset ();
+  return Status;
+}
+
 /**
   Communication service SMI Handler entry.
 
@@ -469,6 +675,7 @@ SmmVariableHandler (
   SMM_VARIABLE_COMMUNICATE_GET_RUNTIME_CACHE_INFO          *GetRuntimeCacheInfo;
   SMM_VARIABLE_COMMUNICATE_LOCK_VARIABLE                   *VariableToLock;
   SMM_VARIABLE_COMMUNICATE_VAR_CHECK_VARIABLE_PROPERTY     *CommVariableProperty;
+  SMM_VARIABLE_COMMUNICATE_BATCH                           *Batch;
   VARIABLE_INFO_ENTRY                                      *VariableInfo;
   VARIABLE_RUNTIME_CACHE_CONTEXT                           *VariableCacheContext;
   VARIABLE_STORE_HEADER                                    *VariableCache;
@@ -986,6 +1193,29 @@ SmmVariableHandler (
       Status = EFI_SUCCESS;
       break;
 
+    case SMM_VARIABLE_FUNCTION_STAGE_BATCH:
+      if (CommBufferPayloadSize < sizeof (SMM_VARIABLE_COMMUNICATE_BATCH)) {
+        DEBUG ((DEBUG_ERROR, "StageBatch: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+
+      //
+      // Copy the input communicate buffer payload to pre-allocated SMM variable buffer payload.
+      //
+      CopyMem (mVariableBufferPayload, SmmVariableFunctionHeader->Data, CommBufferPayloadSize);
+      Status = SmmVariableBatchStage ((SMM_VARIABLE_COMMUNICATE_BATCH *)mVariableBufferPayload, CommBufferPayloadSize);
+      break;
+
+    case SMM_VARIABLE_FUNCTION_COMMIT_BATCH:
+      if (CommBufferPayloadSize < sizeof (SMM_VARIABLE_COMMUNICATE_BATCH)) {
+        DEBUG ((DEBUG_ERROR, "CommitBatch: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+
+      Batch  = (SMM_VARIABLE_COMMUNICATE_BATCH *)SmmVariableFunctionHeader->Data;
+      Status = SmmVariableBatchCommit (Batch->EntryCount, &Batch->EntryIndex);
+      break;
+
     default:
       Status = EFI_UNSUPPORTED;
   }
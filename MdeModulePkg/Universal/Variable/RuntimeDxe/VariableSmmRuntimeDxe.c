@@ -25,6 +25,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/SmmVariable.h>
 #include <Protocol/VariableLock.h>
 #include <Protocol/VarCheck.h>
+#include <Protocol/VariableBatch.h>
 
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
@@ -41,6 +42,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Guid/SmmVariableCommon.h>
 
 #include "PrivilegePolymorphic.h"
+#include "VariableIndex.h"
 #include "VariableParsing.h"
 
 EFI_HANDLE                      mHandle                              = NULL;
@@ -65,6 +67,7 @@ BOOLEAN                         mHobFlushComplete;
 EFI_LOCK                        mVariableServicesLock;
 EDKII_VARIABLE_LOCK_PROTOCOL    mVariableLock;
 EDKII_VAR_CHECK_PROTOCOL        mVarCheck;
+EDKII_VARIABLE_BATCH_PROTOCOL   mVariableBatch;
 
 /**
   The logic to initialize the VariablePolicy engine is in its own file.
@@ -581,6 +584,7 @@ CheckForRuntimeCacheSync (
   //
   if (mHobFlushComplete && (mVariableRuntimeHobCacheBuffer != NULL)) {
     if (!EfiAtRuntime ()) {
+      VariableIndexUnregister (mVariableRuntimeHobCacheBuffer);
       FreePages (mVariableRuntimeHobCacheBuffer, EFI_SIZE_TO_PAGES (mVariableRuntimeHobCacheBufferSize));
     }
 
@@ -1255,6 +1259,160 @@ Done:
   return Status;
 }
 
+/**
+  Set a group of non-volatile variables with a single update of the variable
+  store.
+
+  The entries are staged in SMM with as few SMM_VARIABLE_FUNCTION_STAGE_BATCH
+  requests as the communicate buffer allows, then committed by a single
+  SMM_VARIABLE_FUNCTION_COMMIT_BATCH request.
+
+  Caution: This function may receive untrusted input.
+  The data size and data are external input, so this function will validate it carefully to avoid buffer overflow.
+
+  @param[in]  This          The EDKII_VARIABLE_BATCH_PROTOCOL instance.
+  @param[in]  EntryCount    Number of entries in Entries.
+  @param[in]  Entries       The variable updates.
+  @param[out] FailedEntry   Optional. Index of the entry that caused the batch to
+                            fail, or EntryCount if no single entry is responsible.
+
+  @retval EFI_SUCCESS            All the variable updates have been committed.
+  @retval EFI_INVALID_PARAMETER  Entries is NULL and EntryCount is not 0, or an
+                                 entry is invalid or exceeds the SMM payload limit.
+  @retval EFI_UNSUPPORTED        The service is called at OS runtime.
+  @return Others                 The status returned by the batch service in SMM.
+
+**/
+EFI_STATUS
+EFIAPI
+VariableBatchSetVariables (
+  IN CONST EDKII_VARIABLE_BATCH_PROTOCOL  *This,
+  IN       UINTN                          EntryCount,
+  IN       EDKII_VARIABLE_BATCH_ENTRY     *Entries,
+  OUT      UINTN                          *FailedEntry OPTIONAL
+  )
+{
+  EFI_STATUS                                Status;
+  SMM_VARIABLE_COMMUNICATE_BATCH            *Batch;
+  SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE  *SmmVariableHeader;
+  UINTN                                     PayloadSize;
+  UINTN                                     EntrySize;
+  UINTN                                     VariableNameSize;
+  UINTN                                     First;
+  UINTN                                     Index;
+
+  if (FailedEntry != NULL) {
+    *FailedEntry = EntryCount;
+  }
+
+  if ((Entries == NULL) && (EntryCount != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (EfiAtRuntime ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Check input parameters. Every entry has to fit in one stage request.
+  //
+  for (Index = 0; Index < EntryCount; Index++) {
+    if ((Entries[Index].VariableName == NULL) || (Entries[Index].VariableName[0] == 0) || (Entries[Index].VendorGuid == NULL) ||
+        ((Entries[Index].DataSize != 0) && (Entries[Index].Data == NULL)))
+    {
+      if (FailedEntry != NULL) {
+        *FailedEntry = Index;
+      }
+
+      return EFI_INVALID_PARAMETER;
+    }
+
+    VariableNameSize = StrSize (Entries[Index].VariableName);
+    if ((VariableNameSize > mVariableBufferPayloadSize) ||
+        (Entries[Index].DataSize > mVariableBufferPayloadSize) ||
+        (ALIGN_VALUE (OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + VariableNameSize + Entries[Index].DataSize, sizeof (UINTN)) >
+         mVariableBufferPayloadSize - sizeof (SMM_VARIABLE_COMMUNICATE_BATCH)))
+    {
+      if (FailedEntry != NULL) {
+        *FailedEntry = Index;
+      }
+
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  AcquireLockOnlyAtBootTime (&mVariableServicesLock);
+
+  Status = EFI_SUCCESS;
+  Index  = 0;
+  while (!EFI_ERROR (Status) && (Index < EntryCount)) {
+    First       = Index;
+    PayloadSize = sizeof (SMM_VARIABLE_COMMUNICATE_BATCH);
+    while (Index < EntryCount) {
+      EntrySize = ALIGN_VALUE (
+                    OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + StrSize (Entries[Index].VariableName) + Entries[Index].DataSize,
+                    sizeof (UINTN)
+                    );
+      if (EntrySize > mVariableBufferPayloadSize - PayloadSize) {
+        break;
+      }
+
+      PayloadSize += EntrySize;
+      Index++;
+    }
+
+    Status = InitCommunicateBuffer ((VOID **)&Batch, PayloadSize, SMM_VARIABLE_FUNCTION_STAGE_BATCH);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    ASSERT (Batch != NULL);
+
+    Batch->EntryIndex = First;
+    Batch->EntryCount = Index - First;
+    SmmVariableHeader = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)(Batch + 1);
+    for ( ; First < Index; First++) {
+      CopyGuid (&SmmVariableHeader->Guid, Entries[First].VendorGuid);
+      SmmVariableHeader->DataSize   = Entries[First].DataSize;
+      SmmVariableHeader->NameSize   = StrSize (Entries[First].VariableName);
+      SmmVariableHeader->Attributes = Entries[First].Attributes;
+      CopyMem (SmmVariableHeader->Name, Entries[First].VariableName, SmmVariableHeader->NameSize);
+      CopyMem ((UINT8 *)SmmVariableHeader->Name + SmmVariableHeader->NameSize, Entries[First].Data, Entries[First].DataSize);
+      EntrySize         = OFFSET_OF (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE, Name) + SmmVariableHeader->NameSize + SmmVariableHeader->DataSize;
+      SmmVariableHeader = (SMM_VARIABLE_COMMUNICATE_ACCESS_VARIABLE *)((UINT8 *)SmmVariableHeader + ALIGN_VALUE (EntrySize, sizeof (UINTN)));
+    }
+
+    //
+    // Send data to SMM.
+    //
+    Status = SendCommunicateBuffer (PayloadSize);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = InitCommunicateBuffer ((VOID **)&Batch, sizeof (SMM_VARIABLE_COMMUNICATE_BATCH), SMM_VARIABLE_FUNCTION_COMMIT_BATCH);
+    if (!EFI_ERROR (Status)) {
+      ASSERT (Batch != NULL);
+
+      Batch->EntryIndex = EntryCount;
+      Batch->EntryCount = EntryCount;
+      Status            = SendCommunicateBuffer (sizeof (SMM_VARIABLE_COMMUNICATE_BATCH));
+      if (EFI_ERROR (Status) && (FailedEntry != NULL)) {
+        *FailedEntry = MIN (Batch->EntryIndex, EntryCount);
+      }
+    }
+  }
+
+  ReleaseLockOnlyAtBootTime (&mVariableServicesLock);
+
+  if (!EFI_ERROR (Status)) {
+    for (Index = 0; Index < EntryCount; Index++) {
+      SecureBootHook (Entries[Index].VariableName, Entries[Index].VendorGuid);
+    }
+  }
+
+  return Status;
+}
+
 /**
   This code returns information about the EFI variables.
 
@@ -1413,6 +1571,15 @@ VariableAddressChangeEvent (
   IN VOID       *Context
   )
 {
+  UINTN  Index;
+
+  for (Index = 0; Index < VARIABLE_INDEX_MAX_STORES; Index++) {
+    if (mVariableIndex[Index] != NULL) {
+      EfiConvertPointer (0x0, (VOID **)&mVariableIndex[Index]->VariableStore);
+      EfiConvertPointer (0x0, (VOID **)&mVariableIndex[Index]);
+    }
+  }
+
   EfiConvertPointer (0x0, (VOID **)&mVariableBuffer);
   EfiConvertPointer (0x0, (VOID **)&mMmCommunication2);
   EfiConvertPointer (EFI_OPTIONAL_PTR, (VOID **)&mVariableRuntimeHobCacheBuffer);
@@ -1735,6 +1902,13 @@ SmmVariableReady (
             Status = SendRuntimeVariableCacheContextToSmm ();
             if (!EFI_ERROR (Status)) {
               SyncRuntimeCache ();
+              //
+              // The caches are rewritten by the MM variable driver without
+              // notice, so their indexes can only serve as verified hints.
+              //
+              VariableIndexRegister (mVariableRuntimeHobCacheBuffer, mVariableRuntimeHobCacheBufferSize, FALSE);
+              VariableIndexRegister (mVariableRuntimeNvCacheBuffer, mVariableRuntimeNvCacheBufferSize, FALSE);
+              VariableIndexRegister (mVariableRuntimeVolatileCacheBuffer, mVariableRuntimeVolatileCacheBufferSize, FALSE);
             }
           }
         }
@@ -1788,6 +1962,15 @@ SmmVariableReady (
                                                      );
   ASSERT_EFI_ERROR (Status);
 
+  mVariableBatch.SetVariables = VariableBatchSetVariables;
+  Status                      = gBS->InstallMultipleProtocolInterfaces (
+                                       &mHandle,
+                                       &gEdkiiVariableBatchProtocolGuid,
+                                       &mVariableBatch,
+                                       NULL
+                                       );
+  ASSERT_EFI_ERROR (Status);
+
   gBS->CloseEvent (Event);
 }
 
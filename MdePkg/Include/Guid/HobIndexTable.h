@@ -0,0 +1,85 @@
+/** @file
+  Definitions of the configuration table that indexes the GUID HOBs of the
+  HOB list by GUID.
+
+  The DXE Core installs the table once the HOB list is final, and HOB library
+  instances use it to find GUID HOBs without walking the whole HOB list.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __HOB_INDEX_TABLE_H__
+#define __HOB_INDEX_TABLE_H__
+
+#define EDKII_HOB_INDEX_TABLE_GUID \
+  { \
+    0x3e1f52a8, 0x9b07, 0x4c6d, { 0xb1, 0x4e, 0x72, 0x0a, 0xd9, 0x5c, 0x18, 0xe3 } \
+  }
+
+///
+/// Terminates a hash chain.
+///
+#define HOB_INDEX_END  MAX_UINT32
+
+///
+/// Hash bucket of a GUID in a table of HashSize buckets. HashSize is a power
+/// of two.
+///
+#define HOB_INDEX_HASH(Guid, HashSize) \
+  ((((CONST UINT32 *)(Guid))[0] ^ ((CONST UINT32 *)(Guid))[1] ^ \
+    ((CONST UINT32 *)(Guid))[2] ^ ((CONST UINT32 *)(Guid))[3]) & ((HashSize) - 1))
+
+typedef struct {
+  ///
+  /// GUID of the GUID HOBs.
+  ///
+  EFI_GUID    Name;
+  ///
+  /// Index of the next GUID of the same hash bucket, or HOB_INDEX_END.
+  ///
+  UINT32      Next;
+  ///
+  /// Index in HobOffset[] of the offset of the first GUID HOB with this GUID.
+  /// The offsets of all of them follow in HOB list order.
+  ///
+  UINT32      FirstHob;
+  UINT32      HobCount;
+  UINT32      Reserved;
+} HOB_INDEX_GUID_ENTRY;
+
+typedef struct {
+  ///
+  /// Address of the HOB list the table describes, and size of the HOB list up
+  /// to and including the end of list HOB.
+  ///
+  EFI_PHYSICAL_ADDRESS    HobList;
+  UINT64                  HobListSize;
+  UINT32                  GuidCount;
+  UINT32                  HashSize;
+  UINT32                  HobCount;
+  UINT32                  Reserved;
+  //
+  // HOB_INDEX_GUID_ENTRY   Guid[GuidCount];
+  // UINT32                 HashHead[HashSize];
+  // UINT32                 HobOffset[HobCount];
+  //
+} HOB_INDEX_TABLE;
+
+#define HOB_INDEX_GUIDS(Table) \
+  ((HOB_INDEX_GUID_ENTRY *)((HOB_INDEX_TABLE *)(Table) + 1))
+
+#define HOB_INDEX_HASH_HEADS(Table) \
+  ((UINT32 *)(HOB_INDEX_GUIDS (Table) + ((HOB_INDEX_TABLE *)(Table))->GuidCount))
+
+#define HOB_INDEX_HOB_OFFSETS(Table) \
+  (HOB_INDEX_HASH_HEADS (Table) + ((HOB_INDEX_TABLE *)(Table))->HashSize)
+
+#define HOB_INDEX_TABLE_SIZE(GuidCount, HashSize, HobCount) \
+  (sizeof (HOB_INDEX_TABLE) + (UINTN)(GuidCount) * sizeof (HOB_INDEX_GUID_ENTRY) + \
+   ((UINTN)(HashSize) + (UINTN)(HobCount)) * sizeof (UINT32))
+
+extern EFI_GUID  gEdkiiHobIndexTableGuid;
+
+#endif
@@ -75,6 +75,21 @@
 ///
 #define HTTP_HEADER_ACCEPT_RANGES  "Accept-Ranges"
 
+///
+/// Range Request Header
+/// The Range request-header field requests only one or more sub-ranges
+/// of the selected representation, e.g. "bytes=0-499".
+///
+#define HTTP_HEADER_RANGE  "Range"
+
+///
+/// Content-Range Response Header
+/// The Content-Range header field is sent in a single part 206 (Partial Content)
+/// response to indicate the partial range of the selected representation
+/// enclosed as the message payload, e.g. "bytes 0-499/1234".
+///
+#define HTTP_HEADER_CONTENT_RANGE  "Content-Range"
+
 ///
 /// Accept-Encoding Request Header
 /// The Accept-Encoding request-header field is similar to Accept,
@@ -0,0 +1,119 @@
+;------------------------------------------------------------------------------
+;
+; CRC32 and CRC32c instructions for AArch64
+;
+; Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+;
+; SPDX-License-Identifier: BSD-2-Clause-Patent
+;
+;------------------------------------------------------------------------------
+
+  EXPORT InternalArmReadIdAa64Isar0
+  EXPORT InternalArmCrc32
+  EXPORT InternalArmCrc32c
+  AREA BaseLib_LowLevel, CODE, READONLY
+
+;/**
+;  Reads the ID_AA64ISAR0_EL1 register.
+;
+;  @return The value of ID_AA64ISAR0_EL1.
+;**/
+;UINT64
+;EFIAPI
+;InternalArmReadIdAa64Isar0 (
+;  VOID
+;  );
+;
+InternalArmReadIdAa64Isar0
+    mrs     x0, id_aa64isar0_el1
+    ret
+
+;/**
+;  Updates a CRC32 through the ARMv8 CRC32 instructions.
+;
+;  @param[in]  Crc      The CRC32 of the preceding data, before the final
+;                       inversion.
+;  @param[in]  Buffer   A pointer to the buffer.
+;  @param[in]  Length   The number of bytes in the buffer.
+;
+;  @return The CRC32 of the preceding data and the buffer, before the final
+;          inversion.
+;**/
+;UINT32
+;EFIAPI
+;InternalArmCrc32 (
+;  IN      UINT32       Crc,
+;  IN      CONST UINT8  *Buffer,
+;  IN      UINTN        Length
+;  );
+;
+InternalArmCrc32
+InternalArmCrc32Align
+    tst     x1, #7
+    beq     InternalArmCrc32Loop8
+    cbz     x2, InternalArmCrc32Done
+    ldrb    w3, [x1], #1
+    crc32b  w0, w0, w3
+    sub     x2, x2, #1
+    b       InternalArmCrc32Align
+InternalArmCrc32Loop8
+    cmp     x2, #8
+    blo     InternalArmCrc32Bytes
+    ldr     x3, [x1], #8
+    crc32x  w0, w0, x3
+    sub     x2, x2, #8
+    b       InternalArmCrc32Loop8
+InternalArmCrc32Bytes
+    cbz     x2, InternalArmCrc32Done
+    ldrb    w3, [x1], #1
+    crc32b  w0, w0, w3
+    sub     x2, x2, #1
+    b       InternalArmCrc32Bytes
+InternalArmCrc32Done
+    ret
+
+;/**
+;  Updates a CRC32c through the ARMv8 CRC32C instructions.
+;
+;  @param[in]  Crc      The CRC32c of the preceding data, before the final
+;                       inversion.
+;  @param[in]  Buffer   A pointer to the buffer.
+;  @param[in]  Length   The number of bytes in the buffer.
+;
+;  @return The CRC32c of the preceding data and the buffer, before the final
+;          inversion.
+;**/
+;UINT32
+;EFIAPI
+;InternalArmCrc32c (
+;  IN      UINT32       Crc,
+;  IN      CONST UINT8  *Buffer,
+;  IN      UINTN        Length
+;  );
+;
+InternalArmCrc32c
+InternalArmCrc32cAlign
+    tst     x1, #7
+    beq     InternalArmCrc32cLoop8
+    cbz     x2, InternalArmCrc32cDone
+    ldrb    w3, [x1], #1
+    crc32cb w0, w0, w3
+    sub     x2, x2, #1
+    b       InternalArmCrc32cAlign
+InternalArmCrc32cLoop8
+    cmp     x2, #8
+    blo     InternalArmCrc32cBytes
+    ldr     x3, [x1], #8
+    crc32cx w0, w0, x3
+    sub     x2, x2, #8
+    b       InternalArmCrc32cLoop8
+InternalArmCrc32cBytes
+    cbz     x2, InternalArmCrc32cDone
+    ldrb    w3, [x1], #1
+    crc32cb w0, w0, w3
+    sub     x2, x2, #1
+    b       InternalArmCrc32cBytes
+InternalArmCrc32cDone
+    ret
+
+  END
@@ -0,0 +1,94 @@
+/** @file
+  Selects the AArch64 CRC32 and CRC32C instructions at runtime.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+
+//
+// CRC32 field of ID_AA64ISAR0_EL1, non-zero when the CRC32 and CRC32C
+// instructions are implemented.
+//
+#define ID_AA64ISAR0_CRC32_SHIFT  16
+#define ID_AA64ISAR0_CRC32_MASK   0xF
+
+//
+// Buffers shorter than this are left to the table driven code.
+//
+#define CRC32_ACCELERATED_MIN_LENGTH  64
+
+/**
+  Returns whether the processor implements the CRC32 and CRC32C instructions.
+
+  @retval TRUE    The instructions are implemented.
+  @retval FALSE   The instructions are not implemented.
+
+**/
+STATIC
+BOOLEAN
+InternalArmHasCrc32 (
+  VOID
+  )
+{
+  return ((InternalArmReadIdAa64Isar0 () >> ID_AA64ISAR0_CRC32_SHIFT) &
+          ID_AA64ISAR0_CRC32_MASK) != 0;
+}
+
+/**
+  Updates a CRC32 with the CPU CRC instructions, if the CPU has them and the
+  buffer is large enough for them to pay off.
+
+  @param[in, out]  Crc      The CRC32 of the preceding data, before the final
+                            inversion. Updated with the processed bytes.
+  @param[in]       Buffer   A pointer to the buffer.
+  @param[in]       Length   The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+EFIAPI
+InternalCrc32Accelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  if ((Length < CRC32_ACCELERATED_MIN_LENGTH) || !InternalArmHasCrc32 ()) {
+    return 0;
+  }
+
+  *Crc = InternalArmCrc32 (*Crc, Buffer, Length);
+  return Length;
+}
+
+/**
+  Updates a CRC32c with the CPU CRC instructions, if the CPU has them and the
+  buffer is large enough for them to pay off.
+
+  @param[in, out]  Crc      The CRC32c of the preceding data, before the final
+                            inversion. Updated with the processed bytes.
+  @param[in]       Buffer   A pointer to the buffer.
+  @param[in]       Length   The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+EFIAPI
+InternalCrc32cAccelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  if ((Length < CRC32_ACCELERATED_MIN_LENGTH) || !InternalArmHasCrc32 ()) {
+    return 0;
+  }
+
+  *Crc = InternalArmCrc32c (*Crc, Buffer, Length);
+  return Length;
+}
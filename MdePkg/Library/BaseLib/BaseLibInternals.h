@@ -553,6 +553,50 @@ InternalAsciiHexCharToUintn (
   IN      CHAR8  Char
   );
 
+//
+// Checksum functions
+//
+
+/**
+  Updates a CRC32 with the CPU CRC instructions, if the CPU has them and the
+  buffer is large enough for them to pay off.
+
+  @param[in, out]  Crc      The CRC32 of the preceding data, before the final
+                            inversion. Updated with the processed bytes.
+  @param[in]       Buffer   A pointer to the buffer.
+  @param[in]       Length   The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+EFIAPI
+InternalCrc32Accelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  );
+
+/**
+  Updates a CRC32c with the CPU CRC instructions, if the CPU has them and the
+  buffer is large enough for them to pay off.
+
+  @param[in, out]  Crc      The CRC32c of the preceding data, before the final
+                            inversion. Updated with the processed bytes.
+  @param[in]       Buffer   A pointer to the buffer.
+  @param[in]       Length   The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+EFIAPI
+InternalCrc32cAccelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  );
+
 //
 // Ia32 and x64 specific functions
 //
@@ -850,7 +894,104 @@ InternalX86RdRand64  (
   OUT     UINT64  *Rand
   );
 
-#else
+  #if defined (MDE_CPU_X64)
+
+/**
+  Updates a CRC32 through the PCLMULQDQ instruction.
+
+  @param[in]  Crc      The CRC32 of the preceding data, before the final
+                       inversion.
+  @param[in]  Buffer   A pointer to the buffer.
+  @param[in]  Length   The number of bytes in the buffer. At least 64, and a
+                       multiple of 16.
+
+  @return The CRC32 of the preceding data and the buffer, before the final
+          inversion.
+
+**/
+UINT32
+EFIAPI
+InternalX64Crc32Pclmul (
+  IN      UINT32       Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  );
+
+/**
+  Updates a CRC32c through the SSE4.2 CRC32 instruction.
+
+  @param[in]  Crc      The CRC32c of the preceding data, before the final
+                       inversion.
+  @param[in]  Buffer   A pointer to the buffer.
+  @param[in]  Length   The number of bytes in the buffer.
+
+  @return The CRC32c of the preceding data and the buffer, before the final
+          inversion.
+
+**/
+UINT32
+EFIAPI
+InternalX64Crc32cSse42 (
+  IN      UINT32       Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  );
+
+  #endif
+
+#elif defined (MDE_CPU_AARCH64)
+
+/**
+  Reads the ID_AA64ISAR0_EL1 register.
+
+  @return The value of ID_AA64ISAR0_EL1.
+
+**/
+UINT64
+EFIAPI
+InternalArmReadIdAa64Isar0 (
+  VOID
+  );
+
+/**
+  Updates a CRC32 through the ARMv8 CRC32 instructions.
+
+  @param[in]  Crc      The CRC32 of the preceding data, before the final
+                       inversion.
+  @param[in]  Buffer   A pointer to the buffer.
+  @param[in]  Length   The number of bytes in the buffer.
+
+  @return The CRC32 of the preceding data and the buffer, before the final
+          inversion.
+
+**/
+UINT32
+EFIAPI
+InternalArmCrc32 (
+  IN      UINT32       Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  );
+
+/**
+  Updates a CRC32c through the ARMv8 CRC32C instructions.
+
+  @param[in]  Crc      The CRC32c of the preceding data, before the final
+                       inversion.
+  @param[in]  Buffer   A pointer to the buffer.
+  @param[in]  Length   The number of bytes in the buffer.
+
+  @return The CRC32c of the preceding data and the buffer, before the final
+          inversion.
+
+**/
+UINT32
+EFIAPI
+InternalArmCrc32c (
+  IN      UINT32       Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  );
 
 #endif
 
@@ -0,0 +1,55 @@
+/** @file
+  CRC32 and CRC32c acceleration for processors without CRC instructions.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+
+/**
+  Updates a CRC32 with the CPU CRC instructions, if the CPU has them and the
+  buffer is large enough for them to pay off.
+
+  @param[in, out]  Crc      The CRC32 of the preceding data, before the final
+                            inversion. Updated with the processed bytes.
+  @param[in]       Buffer   A pointer to the buffer.
+  @param[in]       Length   The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer, always 0.
+
+**/
+UINTN
+EFIAPI
+InternalCrc32Accelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  return 0;
+}
+
+/**
+  Updates a CRC32c with the CPU CRC instructions, if the CPU has them and the
+  buffer is large enough for them to pay off.
+
+  @param[in, out]  Crc      The CRC32c of the preceding data, before the final
+                            inversion. Updated with the processed bytes.
+  @param[in]       Buffer   A pointer to the buffer.
+  @param[in]       Length   The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer, always 0.
+
+**/
+UINTN
+EFIAPI
+InternalCrc32cAccelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  return 0;
+}
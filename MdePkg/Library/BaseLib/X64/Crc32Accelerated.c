@@ -0,0 +1,98 @@
+/** @file
+  Selects the x64 CRC32 and CRC32c instructions at runtime.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+#include <Register/Intel/Cpuid.h>
+
+//
+// Buffers shorter than this are left to the table driven code, which is as
+// fast on them once the cost of CPUID is taken into account.
+//
+#define CRC32_ACCELERATED_MIN_LENGTH  SIZE_1KB
+
+/**
+  Returns the features reported by CPUID leaf 1 in ECX.
+
+  @return The CPUID_VERSION_INFO_ECX of the processor.
+
+**/
+STATIC
+CPUID_VERSION_INFO_ECX
+InternalGetVersionInfoEcx (
+  VOID
+  )
+{
+  CPUID_VERSION_INFO_ECX  Ecx;
+
+  AsmCpuid (CPUID_VERSION_INFO, NULL, NULL, &Ecx.Uint32, NULL);
+  return Ecx;
+}
+
+/**
+  Updates a CRC32 with the CPU CRC instructions, if the CPU has them and the
+  buffer is large enough for them to pay off.
+
+  @param[in, out]  Crc      The CRC32 of the preceding data, before the final
+                            inversion. Updated with the processed bytes.
+  @param[in]       Buffer   A pointer to the buffer.
+  @param[in]       Length   The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+EFIAPI
+InternalCrc32Accelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  if ((Length < CRC32_ACCELERATED_MIN_LENGTH) ||
+      (InternalGetVersionInfoEcx ().Bits.PCLMULQDQ == 0))
+  {
+    return 0;
+  }
+
+  //
+  // InternalX64Crc32Pclmul () folds whole 16-byte blocks.
+  //
+  Length &= ~(UINTN)0xF;
+  *Crc    = InternalX64Crc32Pclmul (*Crc, Buffer, Length);
+  return Length;
+}
+
+/**
+  Updates a CRC32c with the CPU CRC instructions, if the CPU has them and the
+  buffer is large enough for them to pay off.
+
+  @param[in, out]  Crc      The CRC32c of the preceding data, before the final
+                            inversion. Updated with the processed bytes.
+  @param[in]       Buffer   A pointer to the buffer.
+  @param[in]       Length   The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+EFIAPI
+InternalCrc32cAccelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  if ((Length < CRC32_ACCELERATED_MIN_LENGTH) ||
+      (InternalGetVersionInfoEcx ().Bits.SSE4_2 == 0))
+  {
+    return 0;
+  }
+
+  *Crc = InternalX64Crc32cSse42 (*Crc, Buffer, Length);
+  return Length;
+}
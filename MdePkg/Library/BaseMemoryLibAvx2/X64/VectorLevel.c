@@ -0,0 +1,96 @@
+/** @file
+  Selects the vector registers used by the memory functions.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "MemLibInternals.h"
+#include <Library/PcdLib.h>
+#include <Register/Intel/Cpuid.h>
+
+//
+// Values of mMemLibVectorLevel, see also VectorLevel.inc.
+//
+#define MEM_LIB_VECTOR_UNKNOWN  0
+#define MEM_LIB_VECTOR_SSE2     1
+#define MEM_LIB_VECTOR_AVX2     2
+#define MEM_LIB_VECTOR_AVX512   3
+
+//
+// XCR0 state components.
+//
+#define XCR0_SSE        BIT1
+#define XCR0_AVX        BIT2
+#define XCR0_OPMASK     BIT5
+#define XCR0_ZMM_HI256  BIT6
+#define XCR0_HI16_ZMM   BIT7
+
+//
+// The widest vector registers the memory functions may use, detected on the
+// first call that needs more than 32 bytes of them.
+//
+UINT8  mMemLibVectorLevel = MEM_LIB_VECTOR_UNKNOWN;
+
+/**
+  Detect the widest vector registers that the processor implements and that
+  have been enabled in XCR0.
+
+  The AVX2 and AVX-512 registers are only used if PcdBaseMemoryLibAvxEnable is
+  TRUE, as the interrupt handlers of CpuExceptionHandlerLib do not preserve
+  them.
+
+  @return The vector level, also stored in mMemLibVectorLevel.
+
+**/
+UINT8
+EFIAPI
+InternalMemDetectVectorLevel (
+  VOID
+  )
+{
+  UINT32                                       MaxLeaf;
+  CPUID_VERSION_INFO_ECX                       VersionEcx;
+  CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_EBX  ExtendedEbx;
+  UINT64                                       Xcr0;
+  UINT8                                        Level;
+
+  Level = MEM_LIB_VECTOR_SSE2;
+  if (!FeaturePcdGet (PcdBaseMemoryLibAvxEnable)) {
+    mMemLibVectorLevel = Level;
+    return Level;
+  }
+
+  AsmCpuid (CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+  AsmCpuid (CPUID_VERSION_INFO, NULL, NULL, &VersionEcx.Uint32, NULL);
+  if ((MaxLeaf >= CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS) &&
+      (VersionEcx.Bits.OSXSAVE != 0) && (VersionEcx.Bits.AVX != 0))
+  {
+    AsmCpuidEx (
+      CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS,
+      CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_SUB_LEAF_INFO,
+      NULL,
+      &ExtendedEbx.Uint32,
+      NULL,
+      NULL
+      );
+    Xcr0 = AsmXGetBv (0);
+
+    if ((ExtendedEbx.Bits.AVX2 != 0) &&
+        ((Xcr0 & (XCR0_SSE | XCR0_AVX)) == (XCR0_SSE | XCR0_AVX)))
+    {
+      Level = MEM_LIB_VECTOR_AVX2;
+
+      if ((ExtendedEbx.Bits.AVX512F != 0) &&
+          ((Xcr0 & (XCR0_OPMASK | XCR0_ZMM_HI256 | XCR0_HI16_ZMM)) ==
+           (XCR0_OPMASK | XCR0_ZMM_HI256 | XCR0_HI16_ZMM)))
+      {
+        Level = MEM_LIB_VECTOR_AVX512;
+      }
+    }
+  }
+
+  mMemLibVectorLevel = Level;
+  return Level;
+}
@@ -921,6 +921,147 @@ PeCoffLoaderImageAddress (
   return (CHAR8 *)((UINTN)ImageContext->ImageAddress + Address - TeStrippedOffset);
 }
 
+/**
+  Applies a run of HIGHLOW or DIR64 fixups of a relocation block.
+
+  The run starts at Reloc and ends before the first entry of another type. The
+  fixups are applied without the bound check and the type dispatch of every
+  entry, so the caller must make sure that the whole page of the block lies in
+  the image.
+
+  @param  Reloc       The first relocation entry of the run, either HIGHLOW or
+                      DIR64.
+  @param  RelocEnd    The end of the relocation block.
+  @param  FixupBase   The loaded address of the page of the block.
+  @param  Adjust      The offset to adjust the fixups.
+  @param  FixupData   On input, the position in the fixup log, or NULL if the
+                      fixups are not logged. On output, the position after the
+                      logged fixups.
+
+  @return The first relocation entry after the run.
+
+**/
+UINT16 *
+PeCoffLoaderRelocateRun (
+  IN     UINT16  *Reloc,
+  IN     UINT16  *RelocEnd,
+  IN     CHAR8   *FixupBase,
+  IN     UINT64  Adjust,
+  IN OUT CHAR8   **FixupData
+  )
+{
+  UINT16  Type;
+  UINT32  *Fixup32;
+  UINT64  *Fixup64;
+  UINT32  *Log32;
+  UINT64  *Log64;
+
+  Type = (UINT16)(*Reloc & 0xF000);
+  if (Type == (EFI_IMAGE_REL_BASED_DIR64 << 12)) {
+    if (*FixupData == NULL) {
+      do {
+        Fixup64  = (UINT64 *)(FixupBase + (*Reloc & 0xFFF));
+        *Fixup64 = *Fixup64 + Adjust;
+        Reloc++;
+      } while (((UINTN)Reloc < (UINTN)RelocEnd) && ((*Reloc & 0xF000) == Type));
+    } else {
+      Log64 = ALIGN_POINTER (*FixupData, sizeof (UINT64));
+      do {
+        Fixup64  = (UINT64 *)(FixupBase + (*Reloc & 0xFFF));
+        *Fixup64 = *Fixup64 + Adjust;
+        *Log64++ = *Fixup64;
+        Reloc++;
+      } while (((UINTN)Reloc < (UINTN)RelocEnd) && ((*Reloc & 0xF000) == Type));
+
+      *FixupData = (CHAR8 *)Log64;
+    }
+  } else {
+    if (*FixupData == NULL) {
+      do {
+        Fixup32  = (UINT32 *)(FixupBase + (*Reloc & 0xFFF));
+        *Fixup32 = *Fixup32 + (UINT32)Adjust;
+        Reloc++;
+      } while (((UINTN)Reloc < (UINTN)RelocEnd) && ((*Reloc & 0xF000) == Type));
+    } else {
+      Log32 = ALIGN_POINTER (*FixupData, sizeof (UINT32));
+      do {
+        Fixup32  = (UINT32 *)(FixupBase + (*Reloc & 0xFFF));
+        *Fixup32 = *Fixup32 + (UINT32)Adjust;
+        *Log32++ = *Fixup32;
+        Reloc++;
+      } while (((UINTN)Reloc < (UINTN)RelocEnd) && ((*Reloc & 0xF000) == Type));
+
+      *FixupData = (CHAR8 *)Log32;
+    }
+  }
+
+  return Reloc;
+}
+
+/**
+  Re-applies a run of HIGHLOW or DIR64 fixups of a relocation block for
+  PeCoffLoaderRelocateImageForRuntime ().
+
+  A fixup is only applied if the value in the image still matches the value
+  logged by PeCoffLoaderRelocateImage (). The caller must make sure that the
+  whole page of the block lies in the image.
+
+  @param  Reloc       The first relocation entry of the run, either HIGHLOW or
+                      DIR64.
+  @param  RelocEnd    The end of the relocation block.
+  @param  FixupBase   The loaded address of the page of the block.
+  @param  Adjust      The offset to adjust the fixups.
+  @param  FixupData   On input, the position in the fixup log. On output, the
+                      position after the fixups of the run.
+
+  @return The first relocation entry after the run.
+
+**/
+UINT16 *
+PeHotRelocateRun (
+  IN     UINT16  *Reloc,
+  IN     UINT16  *RelocEnd,
+  IN     CHAR8   *FixupBase,
+  IN     UINT64  Adjust,
+  IN OUT CHAR8   **FixupData
+  )
+{
+  UINT16  Type;
+  UINT32  *Fixup32;
+  UINT64  *Fixup64;
+  UINT32  *Log32;
+  UINT64  *Log64;
+
+  Type = (UINT16)(*Reloc & 0xF000);
+  if (Type == (EFI_IMAGE_REL_BASED_DIR64 << 12)) {
+    Log64 = ALIGN_POINTER (*FixupData, sizeof (UINT64));
+    do {
+      Fixup64 = (UINT64 *)(FixupBase + (*Reloc & 0xFFF));
+      if (*Log64++ == *Fixup64) {
+        *Fixup64 = *Fixup64 + Adjust;
+      }
+
+      Reloc++;
+    } while (((UINTN)Reloc < (UINTN)RelocEnd) && ((*Reloc & 0xF000) == Type));
+
+    *FixupData = (CHAR8 *)Log64;
+  } else {
+    Log32 = ALIGN_POINTER (*FixupData, sizeof (UINT32));
+    do {
+      Fixup32 = (UINT32 *)(FixupBase + (*Reloc & 0xFFF));
+      if (*Log32++ == *Fixup32) {
+        *Fixup32 = *Fixup32 + (UINT32)Adjust;
+      }
+
+      Reloc++;
+    } while (((UINTN)Reloc < (UINTN)RelocEnd) && ((*Reloc & 0xF000) == Type));
+
+    *FixupData = (CHAR8 *)Log32;
+  }
+
+  return Reloc;
+}
+
 /**
   Applies relocation fixups to a PE/COFF image that was loaded with PeCoffLoaderLoadImage().
 
@@ -975,6 +1116,7 @@ PeCoffLoaderRelocateImage (
   PHYSICAL_ADDRESS                     BaseAddress;
   UINT32                               NumberOfRvaAndSizes;
   UINT32                               TeStrippedOffset;
+  BOOLEAN                              BlockInImage;
 
   ASSERT (ImageContext != NULL);
 
@@ -1109,10 +1251,23 @@ PeCoffLoaderRelocateImage (
         return RETURN_LOAD_ERROR;
       }
 
+      //
+      // If the whole page of the block lies in the image, no entry needs a
+      // bound check and runs of HIGHLOW or DIR64 fixups take the fast path.
+      //
+      BlockInImage = (BOOLEAN)((UINT64)RelocBase->VirtualAddress + SIZE_4KB <= (UINT64)ImageContext->ImageSize + TeStrippedOffset);
+
       //
       // Run this relocation record
       //
       while ((UINTN)Reloc < (UINTN)RelocEnd) {
+        if (BlockInImage &&
+            (((*Reloc >> 12) == EFI_IMAGE_REL_BASED_DIR64) || ((*Reloc >> 12) == EFI_IMAGE_REL_BASED_HIGHLOW)))
+        {
+          Reloc = PeCoffLoaderRelocateRun (Reloc, RelocEnd, FixupBase, Adjust, &FixupData);
+          continue;
+        }
+
         Fixup = PeCoffLoaderImageAddress (ImageContext, RelocBase->VirtualAddress + (*Reloc & 0xFFF), TeStrippedOffset);
         if (Fixup == NULL) {
           ImageContext->ImageError = IMAGE_ERROR_FAILED_RELOCATION;
@@ -1767,6 +1922,7 @@ PeCoffLoaderRelocateImageForRuntime (
   UINTN                                Adjust;
   RETURN_STATUS                        Status;
   PE_COFF_LOADER_IMAGE_CONTEXT         ImageContext;
+  BOOLEAN                              BlockInImage;
 
   if ((RelocationData == NULL) || (ImageBase == 0x0) || (VirtImageBase == 0x0)) {
     return;
@@ -1887,10 +2043,23 @@ PeCoffLoaderRelocateImageForRuntime (
         return;
       }
 
+      //
+      // If the whole page of the block lies in the image, no entry needs a
+      // bound check and runs of HIGHLOW or DIR64 fixups take the fast path.
+      //
+      BlockInImage = (BOOLEAN)((UINT64)RelocBase->VirtualAddress + SIZE_4KB <= (UINT64)ImageContext.ImageSize);
+
       //
       // Run this relocation record
       //
       while ((UINTN)Reloc < (UINTN)RelocEnd) {
+        if (BlockInImage &&
+            (((*Reloc >> 12) == EFI_IMAGE_REL_BASED_DIR64) || ((*Reloc >> 12) == EFI_IMAGE_REL_BASED_HIGHLOW)))
+        {
+          Reloc = PeHotRelocateRun (Reloc, RelocEnd, FixupBase, Adjust, &FixupData);
+          continue;
+        }
+
         Fixup = PeCoffLoaderImageAddress (&ImageContext, RelocBase->VirtualAddress + (*Reloc & 0xFFF), 0);
         if (Fixup == NULL) {
           return;
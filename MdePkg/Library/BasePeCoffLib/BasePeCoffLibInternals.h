@@ -67,6 +67,63 @@ PeHotRelocateImageEx (
   IN UINT64     Adjust
   );
 
+/**
+  Applies a run of HIGHLOW or DIR64 fixups of a relocation block.
+
+  The run starts at Reloc and ends before the first entry of another type. The
+  fixups are applied without the bound check and the type dispatch of every
+  entry, so the caller must make sure that the whole page of the block lies in
+  the image.
+
+  @param  Reloc       The first relocation entry of the run, either HIGHLOW or
+                      DIR64.
+  @param  RelocEnd    The end of the relocation block.
+  @param  FixupBase   The loaded address of the page of the block.
+  @param  Adjust      The offset to adjust the fixups.
+  @param  FixupData   On input, the position in the fixup log, or NULL if the
+                      fixups are not logged. On output, the position after the
+                      logged fixups.
+
+  @return The first relocation entry after the run.
+
+**/
+UINT16 *
+PeCoffLoaderRelocateRun (
+  IN     UINT16  *Reloc,
+  IN     UINT16  *RelocEnd,
+  IN     CHAR8   *FixupBase,
+  IN     UINT64  Adjust,
+  IN OUT CHAR8   **FixupData
+  );
+
+/**
+  Re-applies a run of HIGHLOW or DIR64 fixups of a relocation block for
+  PeCoffLoaderRelocateImageForRuntime ().
+
+  A fixup is only applied if the value in the image still matches the value
+  logged by PeCoffLoaderRelocateImage (). The caller must make sure that the
+  whole page of the block lies in the image.
+
+  @param  Reloc       The first relocation entry of the run, either HIGHLOW or
+                      DIR64.
+  @param  RelocEnd    The end of the relocation block.
+  @param  FixupBase   The loaded address of the page of the block.
+  @param  Adjust      The offset to adjust the fixups.
+  @param  FixupData   On input, the position in the fixup log. On output, the
+                      position after the fixups of the run.
+
+  @return The first relocation entry after the run.
+
+**/
+UINT16 *
+PeHotRelocateRun (
+  IN     UINT16  *Reloc,
+  IN     UINT16  *RelocEnd,
+  IN     CHAR8   *FixupBase,
+  IN     UINT64  Adjust,
+  IN OUT CHAR8   **FixupData
+  );
+
 /**
   Returns TRUE if the machine type of PE/COFF image is supported. Supported
   does not mean the image can be executed it means the PE/COFF loader supports
@@ -1,7 +1,10 @@
 /** @file
   HOB Library implementation for Dxe Phase.
 
-Copyright (c) 2006 - 2018, Intel Corporation. All rights reserved.<BR>
+  GUID HOBs are found through the HOB index table when the DXE Core installed
+  one for the HOB list.
+
+Copyright (c) 2006 - 2024, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -9,13 +12,15 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <PiDxe.h>
 
 #include <Guid/HobList.h>
+#include <Guid/HobIndexTable.h>
 
 #include <Library/HobLib.h>
 #include <Library/UefiLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
 
-VOID  *mHobList = NULL;
+VOID             *mHobList  = NULL;
+HOB_INDEX_TABLE  *mHobIndex = NULL;
 
 /**
   Returns the pointer to the HOB list.
@@ -54,7 +59,8 @@ GetHobList (
 
 /**
   The constructor function caches the pointer to HOB list by calling GetHobList()
-  and will always return EFI_SUCCESS.
+  and the pointer to the HOB index table of that HOB list, if any, and will
+  always return EFI_SUCCESS.
 
   @param  ImageHandle   The firmware allocated handle for the EFI image.
   @param  SystemTable   A pointer to the EFI System Table.
@@ -69,11 +75,100 @@ HobLibConstructor (
   IN EFI_SYSTEM_TABLE  *SystemTable
   )
 {
+  EFI_STATUS  Status;
+
   GetHobList ();
 
+  Status = EfiGetSystemConfigurationTable (&gEdkiiHobIndexTableGuid, (VOID **)&mHobIndex);
+  if (EFI_ERROR (Status) || (mHobIndex->HobList != (EFI_PHYSICAL_ADDRESS)(UINTN)mHobList)) {
+    mHobIndex = NULL;
+  }
+
   return EFI_SUCCESS;
 }
 
+/**
+  Finds the next instance of the matched GUID HOB from the starting HOB
+  through the HOB index table.
+
+  @param  Guid          The GUID to match with in the HOB list.
+  @param  HobStart      A pointer to a HOB of the indexed HOB list.
+  @param  GuidHob       Returns the next instance of the matched GUID HOB from
+                        the starting HOB, or NULL if there is none.
+
+  @retval TRUE          GuidHob is the answer of the HOB index table.
+  @retval FALSE         The HOB index table does not describe the HOB list.
+
+**/
+STATIC
+BOOLEAN
+GetNextGuidHobFromIndex (
+  IN  CONST EFI_GUID  *Guid,
+  IN  CONST VOID      *HobStart,
+  OUT VOID            **GuidHob
+  )
+{
+  HOB_INDEX_GUID_ENTRY  *GuidEntry;
+  UINT32                *HobOffset;
+  UINT32                Index;
+  UINT32                Low;
+  UINT32                High;
+  UINT32                Middle;
+  UINTN                 StartOffset;
+  EFI_PEI_HOB_POINTERS  Hob;
+
+  *GuidHob  = NULL;
+  GuidEntry = HOB_INDEX_GUIDS (mHobIndex);
+  for (Index = HOB_INDEX_HASH_HEADS (mHobIndex)[HOB_INDEX_HASH (Guid, mHobIndex->HashSize)];
+       Index != HOB_INDEX_END;
+       Index = GuidEntry[Index].Next)
+  {
+    if (CompareGuid (&GuidEntry[Index].Name, Guid)) {
+      break;
+    }
+  }
+
+  if (Index == HOB_INDEX_END) {
+    return TRUE;
+  }
+
+  //
+  // Find the first HOB of the GUID at or after HobStart.
+  //
+  StartOffset = (UINTN)HobStart - (UINTN)mHobIndex->HobList;
+  HobOffset   = HOB_INDEX_HOB_OFFSETS (mHobIndex) + GuidEntry[Index].FirstHob;
+  Low         = 0;
+  High        = GuidEntry[Index].HobCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (HobOffset[Middle] < StartOffset) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  if (Low == GuidEntry[Index].HobCount) {
+    return TRUE;
+  }
+
+  //
+  // The HOB the index points to must be a GUID HOB of the GUID. Otherwise the
+  // HOB list changed after it was indexed.
+  //
+  if (HobOffset[Low] + sizeof (EFI_HOB_GUID_TYPE) > mHobIndex->HobListSize) {
+    return FALSE;
+  }
+
+  Hob.Raw = (UINT8 *)(UINTN)(mHobIndex->HobList + HobOffset[Low]);
+  if ((Hob.Header->HobType != EFI_HOB_TYPE_GUID_EXTENSION) || !CompareGuid (&Hob.Guid->Name, Guid)) {
+    return FALSE;
+  }
+
+  *GuidHob = Hob.Raw;
+  return TRUE;
+}
+
 /**
   Returns the next instance of a HOB type from the starting HOB.
 
@@ -172,6 +267,25 @@ GetNextGuidHob (
   )
 {
   EFI_PEI_HOB_POINTERS  GuidHob;
+  VOID                  *IndexedHob;
+
+  ASSERT (Guid != NULL);
+  ASSERT (HobStart != NULL);
+
+  //
+  // HobStart may point into another HOB list, e.g. a copy made by the caller.
+  //
+  if ((mHobIndex != NULL) &&
+      ((UINTN)HobStart >= (UINTN)mHobIndex->HobList) &&
+      ((UINTN)HobStart - (UINTN)mHobIndex->HobList < mHobIndex->HobListSize))
+  {
+    if (GetNextGuidHobFromIndex (Guid, HobStart, &IndexedHob)) {
+      return IndexedHob;
+    }
+
+    DEBUG ((DEBUG_ERROR, "HobLib: HOB list changed after it was indexed, index disabled\n"));
+    mHobIndex = NULL;
+  }
 
   GuidHob.Raw = (UINT8 *)HobStart;
   while ((GuidHob.Raw = GetNextHob (EFI_HOB_TYPE_GUID_EXTENSION, GuidHob.Raw)) != NULL) {
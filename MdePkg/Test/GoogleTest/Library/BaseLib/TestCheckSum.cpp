@@ -15,6 +15,56 @@ extern "C" {
 constexpr STATIC UINT32  mHelloCrc32c = 0x9A71BB4C;
 constexpr STATIC UINT16  mHelloCrc16  = 0x34F6;
 
+// Large enough to cover the CPU CRC instructions and several folds of the
+// word-at-a-time sums, plus room to misalign the start
+constexpr STATIC UINTN  mRandomBufferSize = 8192 + 16;
+
+// Bit at a time reference CRC32 and CRC32c, without initial and final inversion
+STATIC
+UINT32
+ReferenceCrc (
+  UINT32       Crc,
+  CONST UINT8  *Buffer,
+  UINTN        Length,
+  UINT32       Polynomial
+  )
+{
+  while (Length-- != 0) {
+    Crc ^= *(Buffer++);
+    for (UINTN Bit = 0; Bit < 8; Bit++) {
+      Crc = (Crc >> 1) ^ ((Crc & 1) != 0 ? Polynomial : 0);
+    }
+  }
+
+  return Crc;
+}
+
+class ChecksumRandomTest : public ::testing::Test {
+protected:
+  UINT8 Buffer[mRandomBufferSize];
+
+  void
+  SetUp (
+    ) override
+  {
+    UINT32  Seed;
+
+    Seed = 0x12345678;
+    for (UINTN Index = 0; Index < mRandomBufferSize; Index++) {
+      Seed          = Seed * 1103515245 + 12345;
+      Buffer[Index] = (UINT8)(Seed >> 16);
+    }
+  }
+};
+
+// Lengths around the slice-by-8 step, the 16-byte folds, the threshold of the
+// CPU CRC instructions and the word-at-a-time sums
+constexpr STATIC UINTN  mRandomLengths[] = {
+  0,    1,    2,    3,    7,    8,    9,    15,   16,   17,   63,   64,
+  65,   127,  128,  255,  256,  257,  1023, 1024, 1025, 1039, 1040, 1088,
+  2047, 2048, 4096, 4099, 8191, 8192
+};
+
 TEST (Crc32c, BasicCheck) {
   // Note: The magic numbers below are precomputed checksums
   // Check for basic operation on even and odd numbers of bytes
@@ -39,6 +89,80 @@ TEST (Crc32c, MultipartCheck) {
   EXPECT_EQ (CalculateCrc32c (&"hello"[3], 2, val), mHelloCrc32c);
 }
 
+TEST_F (ChecksumRandomTest, Crc32c) {
+  for (UINTN Offset = 0; Offset < 16; Offset++) {
+    for (UINTN Length : mRandomLengths) {
+      EXPECT_EQ (
+        CalculateCrc32c (Buffer + Offset, Length, 0),
+        ~ReferenceCrc (~0U, Buffer + Offset, Length, 0x82F63B78)
+        ) << "Offset " << Offset << " Length " << Length;
+    }
+  }
+
+  // Chain the checksum over both sides of the accelerated threshold
+  EXPECT_EQ (
+    CalculateCrc32c (Buffer + 3000, 5000, CalculateCrc32c (Buffer, 3000, 0)),
+    CalculateCrc32c (Buffer, 8000, 0)
+    );
+}
+
+TEST (Crc32, BasicCheck) {
+  // Check value of the CRC32 of ITU-T V.42
+  EXPECT_EQ (CalculateCrc32 ((VOID *)"123456789", 9), 0xCBF43926U);
+  EXPECT_EQ (CalculateCrc32 ((VOID *)"", 0), 0U);
+}
+
+TEST_F (ChecksumRandomTest, Crc32) {
+  for (UINTN Offset = 0; Offset < 16; Offset++) {
+    for (UINTN Length : mRandomLengths) {
+      EXPECT_EQ (
+        CalculateCrc32 (Buffer + Offset, Length),
+        ~ReferenceCrc (~0U, Buffer + Offset, Length, 0xEDB88320)
+        ) << "Offset " << Offset << " Length " << Length;
+    }
+  }
+}
+
+TEST_F (ChecksumRandomTest, Sum8) {
+  for (UINTN Offset = 0; Offset < 16; Offset++) {
+    for (UINTN Length : mRandomLengths) {
+      UINT8  Sum;
+
+      Sum = 0;
+      for (UINTN Index = 0; Index < Length; Index++) {
+        Sum = (UINT8)(Sum + Buffer[Offset + Index]);
+      }
+
+      EXPECT_EQ (CalculateSum8 (Buffer + Offset, Length), Sum) << "Offset " << Offset << " Length " << Length;
+    }
+  }
+
+  // All bytes 0xFF saturate the lanes the most
+  memset (Buffer, 0xFF, sizeof (Buffer));
+  EXPECT_EQ (CalculateSum8 (Buffer, 8192), 0);
+  EXPECT_EQ (CalculateSum8 (Buffer + 1, 8191), 1);
+}
+
+TEST_F (ChecksumRandomTest, Sum16) {
+  for (UINTN Offset = 0; Offset < 16; Offset += 2) {
+    for (UINTN Length : mRandomLengths) {
+      UINT16  Sum;
+
+      Length &= ~(UINTN)1;
+      Sum     = 0;
+      for (UINTN Index = 0; Index < Length; Index += 2) {
+        Sum = (UINT16)(Sum + ReadUnaligned16 ((UINT16 *)(Buffer + Offset + Index)));
+      }
+
+      EXPECT_EQ (CalculateSum16 ((UINT16 *)(Buffer + Offset), Length), Sum) << "Offset " << Offset << " Length " << Length;
+    }
+  }
+
+  memset (Buffer, 0xFF, sizeof (Buffer));
+  EXPECT_EQ (CalculateSum16 ((UINT16 *)Buffer, 8192), 0xF000);
+  EXPECT_EQ (CalculateSum16 ((UINT16 *)(Buffer + 2), 8190), 0xF001);
+}
+
 TEST (Crc16, BasicCheck) {
   // Note: The magic numbers below are precomputed checksums
   // Check for basic operation on even and odd numbers of bytes
@@ -0,0 +1,833 @@
+/** @file
+  This is a host-based unit test and microbenchmark for the instances of the
+  BaseMemoryLib class.
+
+  The same source is built once for every instance, see the INF files of this
+  directory. The functions are compared with byte-by-byte reference
+  implementations for all sizes up to a few KB and random alignments, and the
+  time of the most used ones is logged for typical sizes so that the logs of
+  the instances can be compared.
+
+  CPUID is passed through to the processor so that the instances selecting the
+  vector registers at runtime use the widest ones enabled on the host.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+#if defined (_MSC_VER)
+  #include <intrin.h>
+#else
+  #include <cpuid.h>
+#endif
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+#include <Library/UnitTestHostBaseLib.h>
+
+#define UNIT_TEST_NAME     "BaseMemoryLib Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+//
+// All sizes up to TEST_ALL_SIZES are tested, then TEST_RANDOM_SIZES random
+// sizes up to TEST_MAX_SIZE.
+//
+#define TEST_ALL_SIZES     (SIZE_1KB + 64)
+#define TEST_RANDOM_SIZES  200
+#define TEST_MAX_SIZE      SIZE_64KB
+
+//
+// Bytes around the tested range that must not be modified.
+//
+#define TEST_GUARD_SIZE  64
+#define TEST_GUARD_BYTE  0xA5
+
+#define TEST_BUFFER_SIZE  (TEST_MAX_SIZE + 4 * TEST_GUARD_SIZE)
+
+//
+// Bytes copied, set or compared for each size of the benchmark.
+//
+#define TEST_BENCH_BYTES  SIZE_64MB
+
+typedef struct {
+  UINT8    *Buffer[2];
+  UINT8    *Reference;
+} TEST_BUFFERS;
+
+UINT32        mTestSeed;
+TEST_BUFFERS  mTestBuffers;
+
+CONST UINTN  mTestBenchSizes[] = { 16, 64, 256, SIZE_4KB, SIZE_64KB };
+
+/**
+  Return the next value of a linear congruential generator.
+
+  @return A pseudo random value.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mTestSeed = mTestSeed * 1103515245 + 12345;
+  return mTestSeed >> 8;
+}
+
+/**
+  Fill a buffer with pseudo random bytes.
+
+  @param[out] Buffer  The buffer to fill.
+  @param[in]  Length  The number of bytes of Buffer.
+**/
+VOID
+TestFillRandom (
+  OUT UINT8  *Buffer,
+  IN  UINTN  Length
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Length; Index++) {
+    Buffer[Index] = (UINT8)TestRandom ();
+  }
+}
+
+/**
+  Return the Index-th tested size, all sizes up to TEST_ALL_SIZES then random
+  ones up to TEST_MAX_SIZE, rounded down to a multiple of Granularity.
+
+  @param[in] Index        The index of the size.
+  @param[in] Granularity  The size of the values of the function tested.
+
+  @return The size in bytes.
+**/
+UINTN
+TestSize (
+  IN UINTN  Index,
+  IN UINTN  Granularity
+  )
+{
+  UINTN  Size;
+
+  if (Index < TEST_ALL_SIZES) {
+    Size = Index;
+  } else {
+    Size = TestRandom () % (TEST_MAX_SIZE + 1);
+  }
+
+  return Size & ~(Granularity - 1);
+}
+
+/**
+  Byte-by-byte reference implementation of CopyMem ().
+
+  @param[out] Destination  The destination buffer.
+  @param[in]  Source       The source buffer.
+  @param[in]  Length       The number of bytes to copy.
+**/
+VOID
+TestReferenceCopy (
+  OUT UINT8        *Destination,
+  IN  CONST UINT8  *Source,
+  IN  UINTN        Length
+  )
+{
+  UINTN  Index;
+
+  if (Destination < Source) {
+    for (Index = 0; Index < Length; Index++) {
+      Destination[Index] = Source[Index];
+    }
+  } else {
+    for (Index = Length; Index > 0; Index--) {
+      Destination[Index - 1] = Source[Index - 1];
+    }
+  }
+}
+
+/**
+  Byte-by-byte reference implementation of the SetMem () functions.
+
+  @param[out] Buffer     The buffer to fill.
+  @param[in]  Length     The number of bytes to fill.
+  @param[in]  Value      The value to fill Buffer with.
+  @param[in]  ValueSize  The number of bytes of Value.
+**/
+VOID
+TestReferenceSet (
+  OUT UINT8   *Buffer,
+  IN  UINTN   Length,
+  IN  UINT64  Value,
+  IN  UINTN   ValueSize
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Length; Index++) {
+    Buffer[Index] = (UINT8)RShiftU64 (Value, (UINTN)(8 * (Index % ValueSize)));
+  }
+}
+
+/**
+  Reference implementation of the ScanMem () functions.
+
+  @param[in] Buffer     The buffer to scan.
+  @param[in] Length     The number of bytes to scan.
+  @param[in] Value      The value to search for.
+  @param[in] ValueSize  The number of bytes of Value.
+
+  @return The first match, or NULL if there is none.
+**/
+CONST VOID *
+TestReferenceScan (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length,
+  IN UINT64       Value,
+  IN UINTN        ValueSize
+  )
+{
+  UINTN  Index;
+  UINTN  Byte;
+
+  for (Index = 0; Index < Length; Index += ValueSize) {
+    for (Byte = 0; Byte < ValueSize; Byte++) {
+      if (Buffer[Index + Byte] != (UINT8)RShiftU64 (Value, (UINTN)(8 * Byte))) {
+        break;
+      }
+    }
+
+    if (Byte == ValueSize) {
+      return Buffer + Index;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Call the SetMem () function of a value size.
+
+  @param[out] Buffer     The buffer to fill.
+  @param[in]  Length     The number of bytes to fill.
+  @param[in]  Value      The value to fill Buffer with.
+  @param[in]  ValueSize  The number of bytes of Value, 0 for ZeroMem ().
+
+  @return Buffer.
+**/
+VOID *
+TestSetMem (
+  OUT VOID    *Buffer,
+  IN  UINTN   Length,
+  IN  UINT64  Value,
+  IN  UINTN   ValueSize
+  )
+{
+  switch (ValueSize) {
+    case 0:
+      return ZeroMem (Buffer, Length);
+    case 1:
+      return SetMem (Buffer, Length, (UINT8)Value);
+    case 2:
+      return SetMem16 (Buffer, Length, (UINT16)Value);
+    case 4:
+      return SetMem32 (Buffer, Length, (UINT32)Value);
+    default:
+      return SetMem64 (Buffer, Length, Value);
+  }
+}
+
+/**
+  Call the ScanMem () function of a value size.
+
+  @param[in] Buffer     The buffer to scan.
+  @param[in] Length     The number of bytes to scan.
+  @param[in] Value      The value to search for.
+  @param[in] ValueSize  The number of bytes of Value.
+
+  @return The first match, or NULL if there is none.
+**/
+CONST VOID *
+TestScanMem (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length,
+  IN UINT64      Value,
+  IN UINTN       ValueSize
+  )
+{
+  switch (ValueSize) {
+    case 1:
+      return ScanMem8 (Buffer, Length, (UINT8)Value);
+    case 2:
+      return ScanMem16 (Buffer, Length, (UINT16)Value);
+    case 4:
+      return ScanMem32 (Buffer, Length, (UINT32)Value);
+    default:
+      return ScanMem64 (Buffer, Length, Value);
+  }
+}
+
+/**
+  Retrieves CPUID information from the processor running the test.
+
+  @param[in]  Index     The 32-bit value to load into EAX prior to invoking the
+                        CPUID instruction.
+  @param[in]  SubIndex  The 32-bit value to load into ECX prior to invoking the
+                        CPUID instruction.
+  @param[out] Eax       The pointer to the 32-bit EAX value returned by the
+                        CPUID instruction. This is an optional parameter that
+                        may be NULL.
+  @param[out] Ebx       The pointer to the 32-bit EBX value returned by the
+                        CPUID instruction. This is an optional parameter that
+                        may be NULL.
+  @param[out] Ecx       The pointer to the 32-bit ECX value returned by the
+                        CPUID instruction. This is an optional parameter that
+                        may be NULL.
+  @param[out] Edx       The pointer to the 32-bit EDX value returned by the
+                        CPUID instruction. This is an optional parameter that
+                        may be NULL.
+
+  @return Index.
+**/
+UINT32
+EFIAPI
+TestAsmCpuidEx (
+  IN  UINT32  Index,
+  IN  UINT32  SubIndex,
+  OUT UINT32  *Eax   OPTIONAL,
+  OUT UINT32  *Ebx   OPTIONAL,
+  OUT UINT32  *Ecx   OPTIONAL,
+  OUT UINT32  *Edx   OPTIONAL
+  )
+{
+  UINT32  Registers[4];
+
+ #if defined (_MSC_VER)
+  __cpuidex ((int *)Registers, (int)Index, (int)SubIndex);
+ #else
+  __cpuid_count (Index, SubIndex, Registers[0], Registers[1], Registers[2], Registers[3]);
+ #endif
+
+  if (Eax != NULL) {
+    *Eax = Registers[0];
+  }
+
+  if (Ebx != NULL) {
+    *Ebx = Registers[1];
+  }
+
+  if (Ecx != NULL) {
+    *Ecx = Registers[2];
+  }
+
+  if (Edx != NULL) {
+    *Edx = Registers[3];
+  }
+
+  return Index;
+}
+
+/**
+  Retrieves CPUID information from the processor running the test.
+
+  @param[in]  Index  The 32-bit value to load into EAX prior to invoking the
+                     CPUID instruction.
+  @param[out] Eax    The pointer to the 32-bit EAX value returned by the CPUID
+                     instruction. This is an optional parameter that may be
+                     NULL.
+  @param[out] Ebx    The pointer to the 32-bit EBX value returned by the CPUID
+                     instruction. This is an optional parameter that may be
+                     NULL.
+  @param[out] Ecx    The pointer to the 32-bit ECX value returned by the CPUID
+                     instruction. This is an optional parameter that may be
+                     NULL.
+  @param[out] Edx    The pointer to the 32-bit EDX value returned by the CPUID
+                     instruction. This is an optional parameter that may be
+                     NULL.
+
+  @return Index.
+**/
+UINT32
+EFIAPI
+TestAsmCpuid (
+  IN  UINT32  Index,
+  OUT UINT32  *Eax   OPTIONAL,
+  OUT UINT32  *Ebx   OPTIONAL,
+  OUT UINT32  *Ecx   OPTIONAL,
+  OUT UINT32  *Edx   OPTIONAL
+  )
+{
+  return TestAsmCpuidEx (Index, 0, Eax, Ebx, Ecx, Edx);
+}
+
+/**
+  CopyMem () should give the same result as the reference implementation for
+  disjoint buffers and for buffers overlapping in both directions.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              The buffers match.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A difference has been found.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CopyMemMatchesReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8  *Buffer;
+  UINT8  *Reference;
+  UINTN  Index;
+  UINTN  Length;
+  UINTN  Source;
+  UINTN  Destination;
+
+  Buffer    = mTestBuffers.Buffer[0];
+  Reference = mTestBuffers.Reference;
+  mTestSeed = 1;
+
+  for (Index = 0; Index < TEST_ALL_SIZES + TEST_RANDOM_SIZES; Index++) {
+    Length = TestSize (Index, 1);
+
+    //
+    // Disjoint buffers, then a Destination before, after or at Source.
+    //
+    Source = TEST_GUARD_SIZE + TestRandom () % TEST_GUARD_SIZE;
+    switch (Index % 4) {
+      case 0:
+        Destination = Source + Length + TEST_GUARD_SIZE + TestRandom () % TEST_GUARD_SIZE;
+        break;
+      case 1:
+        Destination = Source - TestRandom () % TEST_GUARD_SIZE;
+        break;
+      case 2:
+        Destination = Source + TestRandom () % TEST_GUARD_SIZE;
+        break;
+      default:
+        Destination = Source;
+        break;
+    }
+
+    if (Destination + Length + TEST_GUARD_SIZE > TEST_BUFFER_SIZE) {
+      Destination = Source;
+    }
+
+    TestFillRandom (Buffer, TEST_BUFFER_SIZE);
+    memcpy (Reference, Buffer, TEST_BUFFER_SIZE);
+
+    UT_ASSERT_EQUAL ((UINTN)CopyMem (Buffer + Destination, Buffer + Source, Length), (UINTN)(Buffer + Destination));
+    TestReferenceCopy (Reference + Destination, Reference + Source, Length);
+    UT_ASSERT_MEM_EQUAL (Buffer, Reference, TEST_BUFFER_SIZE);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  SetMem (), SetMem16 (), SetMem32 (), SetMem64 () and ZeroMem () should give
+  the same result as the reference implementation.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              The buffers match.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A difference has been found.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+SetMemMatchesReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8   *Buffer;
+  UINT8   *Reference;
+  UINTN   ValueSize;
+  UINTN   Granularity;
+  UINTN   Index;
+  UINTN   Length;
+  UINTN   Offset;
+  UINT64  Value;
+
+  Buffer    = mTestBuffers.Buffer[0];
+  Reference = mTestBuffers.Reference;
+  mTestSeed = 2;
+
+  for (ValueSize = 0; ValueSize <= sizeof (UINT64); ValueSize = MAX (2 * ValueSize, 1)) {
+    Granularity = MAX (ValueSize, 1);
+    for (Index = 0; Index < TEST_ALL_SIZES + TEST_RANDOM_SIZES; Index++) {
+      Length = TestSize (Index, Granularity);
+      Offset = TEST_GUARD_SIZE + (TestRandom () % TEST_GUARD_SIZE & ~(Granularity - 1));
+      Value  = LShiftU64 (TestRandom (), 32) | TestRandom ();
+
+      memset (Buffer, TEST_GUARD_BYTE, TEST_BUFFER_SIZE);
+      memset (Reference, TEST_GUARD_BYTE, TEST_BUFFER_SIZE);
+
+      UT_ASSERT_EQUAL ((UINTN)TestSetMem (Buffer + Offset, Length, Value, ValueSize), (UINTN)(Buffer + Offset));
+      TestReferenceSet (Reference + Offset, Length, (ValueSize == 0) ? 0 : Value, Granularity);
+      UT_ASSERT_MEM_EQUAL (Buffer, Reference, TEST_BUFFER_SIZE);
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  CompareMem () should return 0 for equal buffers, and the difference of the
+  first mismatched bytes otherwise.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              The results are correct.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A wrong result has been found.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CompareMemMatchesReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8  *Destination;
+  UINT8  *Source;
+  UINTN  Index;
+  UINTN  Length;
+  UINTN  Mismatch;
+
+  mTestSeed = 3;
+
+  for (Index = 0; Index < TEST_ALL_SIZES + TEST_RANDOM_SIZES; Index++) {
+    Length      = TestSize (Index, 1);
+    Destination = mTestBuffers.Buffer[0] + TestRandom () % TEST_GUARD_SIZE;
+    Source      = mTestBuffers.Buffer[1] + TestRandom () % TEST_GUARD_SIZE;
+    TestFillRandom (Source, Length);
+    memcpy (Destination, Source, Length);
+
+    UT_ASSERT_EQUAL (CompareMem (Destination, Source, Length), 0);
+    if (Length == 0) {
+      continue;
+    }
+
+    //
+    // Change a byte, and another one after it that must not be reported.
+    //
+    Mismatch              = TestRandom () % Length;
+    Destination[Mismatch] = (UINT8)(Source[Mismatch] + 1 + TestRandom () % 255);
+    if (Mismatch + 1 < Length) {
+      Destination[Length - 1] = (UINT8)~Source[Length - 1];
+    }
+
+    UT_ASSERT_EQUAL (
+      CompareMem (Destination, Source, Length),
+      (INTN)Destination[Mismatch] - (INTN)Source[Mismatch]
+      );
+    UT_ASSERT_EQUAL (
+      CompareMem (Source, Destination, Length),
+      (INTN)Source[Mismatch] - (INTN)Destination[Mismatch]
+      );
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  ScanMem8 (), ScanMem16 (), ScanMem32 () and ScanMem64 () should return the
+  same match as the reference implementation.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              The results are correct.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A wrong result has been found.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ScanMemMatchesReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8   *Buffer;
+  UINTN   ValueSize;
+  UINTN   Index;
+  UINTN   Length;
+  UINTN   Match;
+  UINT64  Value;
+
+  mTestSeed = 4;
+
+  for (ValueSize = 1; ValueSize <= sizeof (UINT64); ValueSize *= 2) {
+    for (Index = ValueSize; Index < TEST_ALL_SIZES + TEST_RANDOM_SIZES; Index++) {
+      Length = TestSize (Index, ValueSize);
+      if (Length == 0) {
+        continue;
+      }
+
+      Buffer = mTestBuffers.Buffer[0] + (TestRandom () % TEST_GUARD_SIZE & ~(ValueSize - 1));
+      Value  = LShiftU64 (TestRandom (), 32) | TestRandom ();
+
+      //
+      // Fill the buffer with values differing from Value in one byte only,
+      // and the bytes after it with Value, then maybe add a match.
+      //
+      TestReferenceSet (Buffer, Length + ValueSize, Value, ValueSize);
+      for (Match = 0; Match < Length; Match += ValueSize) {
+        Buffer[Match + TestRandom () % ValueSize] ^= (UINT8)(1 + TestRandom () % 255);
+      }
+
+      if ((Index % 4) != 0) {
+        Match = TestRandom () % Length & ~(ValueSize - 1);
+        TestReferenceSet (Buffer + Match, ValueSize, Value, ValueSize);
+      }
+
+      UT_ASSERT_EQUAL (
+        (UINTN)TestScanMem (Buffer, Length, Value, ValueSize),
+        (UINTN)TestReferenceScan (Buffer, Length, Value, ValueSize)
+        );
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  IsZeroBuffer () should return TRUE for zero buffers only.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              The results are correct.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A wrong result has been found.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+IsZeroBufferMatchesReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8  *Buffer;
+  UINTN  Index;
+  UINTN  Length;
+  UINTN  NonZero;
+
+  mTestSeed = 5;
+
+  for (Index = 1; Index < TEST_ALL_SIZES + TEST_RANDOM_SIZES; Index++) {
+    Length = TestSize (Index, 1);
+    if (Length == 0) {
+      continue;
+    }
+
+    //
+    // Non-zero bytes around the buffer must be ignored.
+    //
+    Buffer = mTestBuffers.Buffer[0] + TEST_GUARD_SIZE + TestRandom () % TEST_GUARD_SIZE;
+    memset (Buffer - TEST_GUARD_SIZE, TEST_GUARD_BYTE, Length + 2 * TEST_GUARD_SIZE);
+    memset (Buffer, 0, Length);
+    UT_ASSERT_TRUE (IsZeroBuffer (Buffer, Length));
+
+    NonZero         = ((Index % 2) == 0) ? TestRandom () % Length : Length - 1 - TestRandom () % MIN (Length, 32);
+    Buffer[NonZero] = (UINT8)(1 + TestRandom () % 255);
+    UT_ASSERT_FALSE (IsZeroBuffer (Buffer, Length));
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Log the throughput of CopyMem (), ZeroMem (), SetMem () and CompareMem ()
+  for aligned buffers of typical sizes, in MB/s.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED  The benchmark has run.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+MemoryBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8    *Destination;
+  UINT8    *Source;
+  UINTN    SizeIndex;
+  UINTN    Size;
+  UINTN    Passes;
+  UINTN    Pass;
+  UINTN    Function;
+  INTN     Result;
+  clock_t  Ticks[4];
+
+  Destination = mTestBuffers.Buffer[0];
+  Source      = mTestBuffers.Buffer[1];
+  memset (Source, 0x5A, TEST_MAX_SIZE);
+  Result = 0;
+
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (mTestBenchSizes); SizeIndex++) {
+    Size   = mTestBenchSizes[SizeIndex];
+    Passes = TEST_BENCH_BYTES / Size;
+
+    for (Function = 0; Function < ARRAY_SIZE (Ticks); Function++) {
+      Ticks[Function] = clock ();
+      for (Pass = 0; Pass < Passes; Pass++) {
+        switch (Function) {
+          case 0:
+            CopyMem (Destination, Source, Size);
+            break;
+          case 1:
+            ZeroMem (Destination, Size);
+            break;
+          case 2:
+            SetMem (Destination, Size, 0x5A);
+            break;
+          default:
+            Result |= CompareMem (Destination, Source, Size);
+            break;
+        }
+      }
+
+      Ticks[Function] = MAX (clock () - Ticks[Function], 1);
+    }
+
+    UT_LOG_INFO (
+      "%a %5Lu bytes: CopyMem %Lu MB/s, ZeroMem %Lu MB/s, SetMem %Lu MB/s, CompareMem %Lu MB/s\n",
+      gEfiCallerBaseName,
+      (UINT64)Size,
+      (UINT64)(TEST_BENCH_BYTES / SIZE_1MB * CLOCKS_PER_SEC / Ticks[0]),
+      (UINT64)(TEST_BENCH_BYTES / SIZE_1MB * CLOCKS_PER_SEC / Ticks[1]),
+      (UINT64)(TEST_BENCH_BYTES / SIZE_1MB * CLOCKS_PER_SEC / Ticks[2]),
+      (UINT64)(TEST_BENCH_BYTES / SIZE_1MB * CLOCKS_PER_SEC / Ticks[3])
+      );
+  }
+
+  //
+  // SetMem () has made the buffers equal again before CompareMem () is timed.
+  //
+  UT_ASSERT_EQUAL (Result, 0);
+
+  return UNIT_TEST_PASSED;
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Main entry point to the unit test.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      MemoryTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Let the instances detect the vector registers of the host.
+  //
+  gUnitTestHostBaseLib.X86->AsmCpuid   = TestAsmCpuid;
+  gUnitTestHostBaseLib.X86->AsmCpuidEx = TestAsmCpuidEx;
+
+  //
+  // Aligned buffers, so that the tests and benchmark do not depend on the
+  // alignment of the allocations.
+  //
+  mTestBuffers.Buffer[0] = AllocateAlignedPages (EFI_SIZE_TO_PAGES (TEST_BUFFER_SIZE), SIZE_4KB);
+  mTestBuffers.Buffer[1] = AllocateAlignedPages (EFI_SIZE_TO_PAGES (TEST_BUFFER_SIZE), SIZE_4KB);
+  mTestBuffers.Reference = AllocateAlignedPages (EFI_SIZE_TO_PAGES (TEST_BUFFER_SIZE), SIZE_4KB);
+  if ((mTestBuffers.Buffer[0] == NULL) || (mTestBuffers.Buffer[1] == NULL) || (mTestBuffers.Reference == NULL)) {
+    DEBUG ((DEBUG_ERROR, "Failed to allocate the test buffers\n"));
+    goto EXIT;
+  }
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &MemoryTests,
+             Framework,
+             "BaseMemoryLib Tests",
+             "BaseMemoryLib.Memory",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for MemoryTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (MemoryTests, "CopyMem should match the byte-by-byte reference", "CopyMem", CopyMemMatchesReference, NULL, NULL, NULL);
+  AddTestCase (MemoryTests, "SetMem and ZeroMem should match the byte-by-byte reference", "SetMem", SetMemMatchesReference, NULL, NULL, NULL);
+  AddTestCase (MemoryTests, "CompareMem should return the first difference", "CompareMem", CompareMemMatchesReference, NULL, NULL, NULL);
+  AddTestCase (MemoryTests, "ScanMem should return the first match", "ScanMem", ScanMemMatchesReference, NULL, NULL, NULL);
+  AddTestCase (MemoryTests, "IsZeroBuffer should detect any non-zero byte", "IsZeroBuffer", IsZeroBufferMatchesReference, NULL, NULL, NULL);
+  AddTestCase (MemoryTests, "Log the throughput of the most used functions", "Benchmark", MemoryBenchmark, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  if (mTestBuffers.Buffer[0] != NULL) {
+    FreeAlignedPages (mTestBuffers.Buffer[0], EFI_SIZE_TO_PAGES (TEST_BUFFER_SIZE));
+  }
+
+  if (mTestBuffers.Buffer[1] != NULL) {
+    FreeAlignedPages (mTestBuffers.Buffer[1], EFI_SIZE_TO_PAGES (TEST_BUFFER_SIZE));
+  }
+
+  if (mTestBuffers.Reference != NULL) {
+    FreeAlignedPages (mTestBuffers.Reference, EFI_SIZE_TO_PAGES (TEST_BUFFER_SIZE));
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
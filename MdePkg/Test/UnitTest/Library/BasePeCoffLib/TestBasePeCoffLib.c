@@ -0,0 +1,709 @@
+/** @file
+  This is a host-based unit test and microbenchmark for the base relocation of
+  BasePeCoffLib.
+
+  The relocation of PeCoffLoaderRelocateImage () and the re-relocation of
+  PeCoffLoaderRelocateImageForRuntime () are compared with a per-entry
+  reference implementation on synthetic PE32+ images.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <time.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <IndustryStandard/PeImage.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PeCoffLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "BasePeCoffLib Unit Test"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_IMAGE_BASE        0x10000000ULL
+#define TEST_RUNTIME_ADJUST    0x40000000ULL
+#define TEST_PE_HEADER_OFFSET  0x80
+#define TEST_RELOC_RVA         0x1000
+#define TEST_DATA_PAGES        64
+#define TEST_BENCH_PAGES       1024
+#define TEST_BENCH_PASSES      20
+
+//
+// The last page of the data section, and of the image, ends in the middle.
+//
+#define TEST_LAST_PAGE_SIZE  0x800
+
+typedef struct {
+  UINT8                           *File;
+  PE_COFF_LOADER_IMAGE_CONTEXT    Context;
+  VOID                            *Buffer;
+  UINT8                           *Image;
+  UINT8                           *FixupData;
+} TEST_IMAGE;
+
+UINT32      mTestSeed;
+TEST_IMAGE  mTestImages[2];
+
+/**
+  Return the next value of a linear congruential generator.
+
+  @return A pseudo random value.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mTestSeed = mTestSeed * 1103515245 + 12345;
+  return mTestSeed >> 8;
+}
+
+/**
+  Append the relocation block of a data page.
+
+  @param[in, out] Reloc       The position of the block. On output, the
+                              position after the block.
+  @param[in]      PageRva     The RVA of the page.
+  @param[in]      PageSize    The number of bytes of the page in the image.
+  @param[in]      Dense       TRUE for a page of pointers only, FALSE for a mix
+                              of every relocation type.
+**/
+VOID
+TestAppendRelocBlock (
+  IN OUT UINT8    **Reloc,
+  IN     UINT32   PageRva,
+  IN     UINT32   PageSize,
+  IN     BOOLEAN  Dense
+  )
+{
+  EFI_IMAGE_BASE_RELOCATION  *Block;
+  UINT16                     *Entry;
+  UINT32                     Offset;
+  UINTN                      Run;
+  UINTN                      Type;
+  UINT32                     Width;
+
+  Block                 = (EFI_IMAGE_BASE_RELOCATION *)*Reloc;
+  Block->VirtualAddress = PageRva;
+  Entry                 = (UINT16 *)(Block + 1);
+  Offset                = 0;
+
+  while (Offset + sizeof (UINT64) <= PageSize) {
+    if (Dense) {
+      Type = EFI_IMAGE_REL_BASED_DIR64;
+      Run  = 1;
+    } else {
+      switch (TestRandom () % 8) {
+        case 0:
+        case 1:
+        case 2:
+          Type = EFI_IMAGE_REL_BASED_DIR64;
+          break;
+        case 3:
+        case 4:
+          Type = EFI_IMAGE_REL_BASED_HIGHLOW;
+          break;
+        case 5:
+          Type = EFI_IMAGE_REL_BASED_HIGH;
+          break;
+        case 6:
+          Type = EFI_IMAGE_REL_BASED_LOW;
+          break;
+        default:
+          Type = EFI_IMAGE_REL_BASED_ABSOLUTE;
+          break;
+      }
+
+      Run     = 1 + TestRandom () % 24;
+      Offset += (TestRandom () % 3) * sizeof (UINT32);
+    }
+
+    Width = (Type == EFI_IMAGE_REL_BASED_DIR64) ? sizeof (UINT64) : sizeof (UINT32);
+    for ( ; (Run > 0) && (Offset + Width <= PageSize); Run--) {
+      *Entry++ = (UINT16)((Type << 12) | Offset);
+      if (Type != EFI_IMAGE_REL_BASED_ABSOLUTE) {
+        Offset += Width;
+      }
+    }
+  }
+
+  //
+  // Pad the block to a multiple of 4 bytes.
+  //
+  if ((((UINT8 *)Entry - (UINT8 *)Block) & BIT1) != 0) {
+    *Entry++ = EFI_IMAGE_REL_BASED_ABSOLUTE << 12;
+  }
+
+  Block->SizeOfBlock = (UINT32)((UINT8 *)Entry - (UINT8 *)Block);
+  *Reloc             = (UINT8 *)Entry;
+}
+
+/**
+  Create the file of a PE32+ image with a relocation section and a data section
+  full of fixups. The data section is the last one and its last page ends in
+  the middle, so that only the relocation block of the last page does not lie
+  entirely in the image.
+
+  @param[out] Image       The test image.
+  @param[in]  DataPages   The number of pages of the data section.
+  @param[in]  Dense       TRUE for pages of pointers only, FALSE for a mix of
+                          every relocation type.
+**/
+VOID
+TestCreateImageFile (
+  OUT TEST_IMAGE  *Image,
+  IN  UINTN       DataPages,
+  IN  BOOLEAN     Dense
+  )
+{
+  EFI_IMAGE_DOS_HEADER      *DosHdr;
+  EFI_IMAGE_NT_HEADERS64    *Hdr;
+  EFI_IMAGE_SECTION_HEADER  *Section;
+  UINT32                    RelocSize;
+  UINT32                    DataRva;
+  UINT32                    DataSize;
+  UINT8                     *Reloc;
+  UINT32                    *Data;
+  UINTN                     Index;
+
+  //
+  // A block needs at most one entry per 4 bytes, plus its header and a pad.
+  //
+  RelocSize = (UINT32)ALIGN_VALUE (DataPages * (SIZE_4KB / sizeof (UINT32) * sizeof (UINT16) + 12), SIZE_4KB);
+  DataRva   = TEST_RELOC_RVA + RelocSize;
+  DataSize  = (UINT32)(DataPages * SIZE_4KB - (SIZE_4KB - TEST_LAST_PAGE_SIZE));
+
+  Image->File = AllocateZeroPool (DataRva + DataSize);
+  ASSERT (Image->File != NULL);
+
+  DosHdr           = (EFI_IMAGE_DOS_HEADER *)Image->File;
+  DosHdr->e_magic  = EFI_IMAGE_DOS_SIGNATURE;
+  DosHdr->e_lfanew = TEST_PE_HEADER_OFFSET;
+
+  Hdr                                     = (EFI_IMAGE_NT_HEADERS64 *)(Image->File + TEST_PE_HEADER_OFFSET);
+  Hdr->Signature                          = EFI_IMAGE_NT_SIGNATURE;
+  Hdr->FileHeader.Machine                 = IMAGE_FILE_MACHINE_X64;
+  Hdr->FileHeader.NumberOfSections        = 2;
+  Hdr->FileHeader.SizeOfOptionalHeader    = sizeof (EFI_IMAGE_OPTIONAL_HEADER64);
+  Hdr->FileHeader.Characteristics         = EFI_IMAGE_FILE_EXECUTABLE_IMAGE;
+  Hdr->OptionalHeader.Magic               = EFI_IMAGE_NT_OPTIONAL_HDR64_MAGIC;
+  Hdr->OptionalHeader.AddressOfEntryPoint = DataRva;
+  Hdr->OptionalHeader.ImageBase           = TEST_IMAGE_BASE;
+  Hdr->OptionalHeader.SectionAlignment    = SIZE_4KB;
+  Hdr->OptionalHeader.FileAlignment       = 0x200;
+  Hdr->OptionalHeader.SizeOfImage         = DataRva + DataSize;
+  Hdr->OptionalHeader.SizeOfHeaders       = TEST_RELOC_RVA;
+  Hdr->OptionalHeader.Subsystem           = EFI_IMAGE_SUBSYSTEM_EFI_RUNTIME_DRIVER;
+  Hdr->OptionalHeader.NumberOfRvaAndSizes = EFI_IMAGE_NUMBER_OF_DIRECTORY_ENTRIES;
+
+  Section = (EFI_IMAGE_SECTION_HEADER *)(Hdr + 1);
+  CopyMem (Section->Name, ".reloc", sizeof (".reloc"));
+  Section->Misc.VirtualSize = RelocSize;
+  Section->VirtualAddress   = TEST_RELOC_RVA;
+  Section->SizeOfRawData    = RelocSize;
+  Section->PointerToRawData = TEST_RELOC_RVA;
+  Section->Characteristics  = EFI_IMAGE_SCN_CNT_INITIALIZED_DATA | EFI_IMAGE_SCN_MEM_READ;
+
+  Section++;
+  CopyMem (Section->Name, ".data", sizeof (".data"));
+  Section->Misc.VirtualSize = DataSize;
+  Section->VirtualAddress   = DataRva;
+  Section->SizeOfRawData    = DataSize;
+  Section->PointerToRawData = DataRva;
+  Section->Characteristics  = EFI_IMAGE_SCN_CNT_INITIALIZED_DATA | EFI_IMAGE_SCN_MEM_READ | EFI_IMAGE_SCN_MEM_WRITE;
+
+  Reloc = Image->File + TEST_RELOC_RVA;
+  for (Index = 0; Index < DataPages; Index++) {
+    TestAppendRelocBlock (
+      &Reloc,
+      (UINT32)(DataRva + Index * SIZE_4KB),
+      (Index == DataPages - 1) ? TEST_LAST_PAGE_SIZE : SIZE_4KB,
+      Dense
+      );
+  }
+
+  Hdr->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress = TEST_RELOC_RVA;
+  Hdr->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_BASERELOC].Size           = (UINT32)(Reloc - (Image->File + TEST_RELOC_RVA));
+
+  Data = (UINT32 *)(Image->File + DataRva);
+  for (Index = 0; Index < DataSize / sizeof (UINT32); Index++) {
+    Data[Index] = TestRandom ();
+  }
+}
+
+/**
+  Load a test image with BasePeCoffLib.
+
+  @param[in, out] Image   The test image.
+
+  @retval TRUE    The image has been loaded.
+  @retval FALSE   The image could not be loaded.
+**/
+BOOLEAN
+TestLoadImage (
+  IN OUT TEST_IMAGE  *Image
+  )
+{
+  RETURN_STATUS  Status;
+
+  ZeroMem (&Image->Context, sizeof (Image->Context));
+  Image->Context.Handle    = Image->File;
+  Image->Context.ImageRead = PeCoffLoaderImageReadFromMemory;
+  Status                   = PeCoffLoaderGetImageInfo (&Image->Context);
+  if (RETURN_ERROR (Status)) {
+    return FALSE;
+  }
+
+  Image->Buffer = AllocateZeroPool ((UINTN)Image->Context.ImageSize + Image->Context.SectionAlignment);
+  if (Image->Buffer == NULL) {
+    return FALSE;
+  }
+
+  Image->Image                = ALIGN_POINTER (Image->Buffer, Image->Context.SectionAlignment);
+  Image->Context.ImageAddress = (PHYSICAL_ADDRESS)(UINTN)Image->Image;
+  Status                      = PeCoffLoaderLoadImage (&Image->Context);
+  if (RETURN_ERROR (Status)) {
+    return FALSE;
+  }
+
+  Image->FixupData = AllocateZeroPool (Image->Context.FixupDataSize);
+  return (BOOLEAN)(Image->FixupData != NULL);
+}
+
+/**
+  Free the buffers of a test image.
+
+  @param[in, out] Image   The test image.
+**/
+VOID
+TestFreeImage (
+  IN OUT TEST_IMAGE  *Image
+  )
+{
+  if (Image->File != NULL) {
+    FreePool (Image->File);
+  }
+
+  if (Image->Buffer != NULL) {
+    FreePool (Image->Buffer);
+  }
+
+  if (Image->FixupData != NULL) {
+    FreePool (Image->FixupData);
+  }
+
+  ZeroMem (Image, sizeof (*Image));
+}
+
+/**
+  Apply the relocations of a loaded test image one entry at a time, with a
+  bound check for every entry.
+
+  @param[in]      Image       The test image.
+  @param[in]      Adjust      The offset to adjust the fixups.
+  @param[in]      Runtime     FALSE to relocate the image, TRUE to re-relocate
+                              it like PeCoffLoaderRelocateImageForRuntime ().
+  @param[in, out] FixupData   The fixup log, or NULL if Runtime is FALSE and
+                              the fixups are not logged.
+**/
+VOID
+TestReferenceRelocate (
+  IN     TEST_IMAGE  *Image,
+  IN     UINT64      Adjust,
+  IN     BOOLEAN     Runtime,
+  IN OUT UINT8       *FixupData
+  )
+{
+  EFI_IMAGE_NT_HEADERS64     *Hdr;
+  EFI_IMAGE_DATA_DIRECTORY   *RelocDir;
+  EFI_IMAGE_BASE_RELOCATION  *RelocBase;
+  EFI_IMAGE_BASE_RELOCATION  *RelocBaseEnd;
+  UINT16                     *Reloc;
+  UINT16                     *RelocEnd;
+  UINT32                     Rva;
+  UINT16                     *Fixup16;
+  UINT32                     *Fixup32;
+  UINT64                     *Fixup64;
+
+  Hdr          = (EFI_IMAGE_NT_HEADERS64 *)(Image->Image + TEST_PE_HEADER_OFFSET);
+  RelocDir     = &Hdr->OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_BASERELOC];
+  RelocBase    = (EFI_IMAGE_BASE_RELOCATION *)(Image->Image + RelocDir->VirtualAddress);
+  RelocBaseEnd = (EFI_IMAGE_BASE_RELOCATION *)((UINT8 *)RelocBase + RelocDir->Size);
+
+  while (RelocBase < RelocBaseEnd) {
+    RelocEnd = (UINT16 *)((UINT8 *)RelocBase + RelocBase->SizeOfBlock);
+    for (Reloc = (UINT16 *)(RelocBase + 1); Reloc < RelocEnd; Reloc++) {
+      Rva = RelocBase->VirtualAddress + (*Reloc & 0xFFF);
+      if (Rva >= Image->Context.ImageSize) {
+        return;
+      }
+
+      switch (*Reloc >> 12) {
+        case EFI_IMAGE_REL_BASED_HIGH:
+        case EFI_IMAGE_REL_BASED_LOW:
+          Fixup16 = (UINT16 *)(Image->Image + Rva);
+          if (!Runtime || (*(UINT16 *)FixupData == *Fixup16)) {
+            if ((*Reloc >> 12) == EFI_IMAGE_REL_BASED_HIGH) {
+              *Fixup16 = (UINT16)(*Fixup16 + (UINT16)((UINT32)Adjust >> 16));
+            } else {
+              *Fixup16 = (UINT16)(*Fixup16 + (UINT16)Adjust);
+            }
+          }
+
+          if (FixupData != NULL) {
+            if (!Runtime) {
+              *(UINT16 *)FixupData = *Fixup16;
+            }
+
+            FixupData += sizeof (UINT16);
+          }
+
+          break;
+
+        case EFI_IMAGE_REL_BASED_HIGHLOW:
+          Fixup32 = (UINT32 *)(Image->Image + Rva);
+          if (FixupData != NULL) {
+            FixupData = ALIGN_POINTER (FixupData, sizeof (UINT32));
+          }
+
+          if (!Runtime || (*(UINT32 *)FixupData == *Fixup32)) {
+            *Fixup32 = *Fixup32 + (UINT32)Adjust;
+          }
+
+          if (FixupData != NULL) {
+            if (!Runtime) {
+              *(UINT32 *)FixupData = *Fixup32;
+            }
+
+            FixupData += sizeof (UINT32);
+          }
+
+          break;
+
+        case EFI_IMAGE_REL_BASED_DIR64:
+          Fixup64 = (UINT64 *)(Image->Image + Rva);
+          if (FixupData != NULL) {
+            FixupData = ALIGN_POINTER (FixupData, sizeof (UINT64));
+          }
+
+          if (!Runtime || (*(UINT64 *)FixupData == *Fixup64)) {
+            *Fixup64 = *Fixup64 + Adjust;
+          }
+
+          if (FixupData != NULL) {
+            if (!Runtime) {
+              *(UINT64 *)FixupData = *Fixup64;
+            }
+
+            FixupData += sizeof (UINT64);
+          }
+
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    RelocBase = (EFI_IMAGE_BASE_RELOCATION *)RelocEnd;
+  }
+}
+
+/**
+  Relocate and re-relocate an image with BasePeCoffLib and with the reference
+  implementation, and compare the images and the fixup logs.
+
+  @param[in] Dense  TRUE for pages of pointers only, FALSE for a mix of every
+                    relocation type.
+
+  @retval UNIT_TEST_PASSED              The images and logs match.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A difference has been found.
+**/
+UNIT_TEST_STATUS
+TestRelocationMatchesReference (
+  IN BOOLEAN  Dense
+  )
+{
+  TEST_IMAGE                 *Lib;
+  TEST_IMAGE                 *Ref;
+  UINTN                      Offset;
+  EFI_IMAGE_BASE_RELOCATION  *RelocBase;
+  UINT16                     *Reloc;
+  UINT64                     *Modified64;
+
+  Lib       = &mTestImages[0];
+  Ref       = &mTestImages[1];
+  mTestSeed = 1;
+  TestCreateImageFile (Lib, TEST_DATA_PAGES, Dense);
+  mTestSeed = 1;
+  TestCreateImageFile (Ref, TEST_DATA_PAGES, Dense);
+  UT_ASSERT_TRUE (TestLoadImage (Lib));
+  UT_ASSERT_TRUE (TestLoadImage (Ref));
+
+  //
+  // Relocate both images as if loaded at the address of the first one.
+  //
+  Lib->Context.FixupData = Lib->FixupData;
+  UT_ASSERT_NOT_EFI_ERROR (PeCoffLoaderRelocateImage (&Lib->Context));
+  TestReferenceRelocate (Ref, (UINT64)(UINTN)Lib->Image - TEST_IMAGE_BASE, FALSE, Ref->FixupData);
+
+  Offset = Lib->Context.SizeOfHeaders;
+  UT_ASSERT_MEM_EQUAL (Lib->Image + Offset, Ref->Image + Offset, (UINTN)Lib->Context.ImageSize - Offset);
+  UT_ASSERT_MEM_EQUAL (Lib->FixupData, Ref->FixupData, Lib->Context.FixupDataSize);
+
+  //
+  // Change the first pointer of the first page, as if code had updated it, so
+  // that the re-relocation for runtime leaves it alone.
+  //
+  RelocBase = (EFI_IMAGE_BASE_RELOCATION *)(Lib->Image + TEST_RELOC_RVA);
+  for (Reloc = (UINT16 *)(RelocBase + 1); (*Reloc >> 12) != EFI_IMAGE_REL_BASED_DIR64; Reloc++) {
+  }
+
+  Modified64  = (UINT64 *)(Lib->Image + RelocBase->VirtualAddress + (*Reloc & 0xFFF));
+  *Modified64 = 0x5A5A5A5A5A5A5A5AULL;
+  CopyMem (Ref->Image + ((UINT8 *)Modified64 - Lib->Image), Modified64, sizeof (UINT64));
+
+  PeCoffLoaderRelocateImageForRuntime (
+    (PHYSICAL_ADDRESS)(UINTN)Lib->Image,
+    (PHYSICAL_ADDRESS)(UINTN)Lib->Image + TEST_RUNTIME_ADJUST,
+    (UINTN)Lib->Context.ImageSize,
+    Lib->FixupData
+    );
+  TestReferenceRelocate (Ref, TEST_RUNTIME_ADJUST, TRUE, Ref->FixupData);
+
+  UT_ASSERT_EQUAL (*Modified64, 0x5A5A5A5A5A5A5A5AULL);
+  UT_ASSERT_MEM_EQUAL (Lib->Image + Offset, Ref->Image + Offset, (UINTN)Lib->Context.ImageSize - Offset);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Relocations of every type should give the same image and fixup log as the
+  per-entry reference implementation.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              The images and logs match.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A difference has been found.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+MixedRelocationsMatchReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  return TestRelocationMatchesReference (FALSE);
+}
+
+/**
+  Pages of pointers only should give the same image and fixup log as the
+  per-entry reference implementation.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              The images and logs match.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   A difference has been found.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DenseRelocationsMatchReference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  return TestRelocationMatchesReference (TRUE);
+}
+
+/**
+  Log the time of PeCoffLoaderRelocateImage () and of the per-entry reference
+  implementation for large images.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED              The benchmark has run.
+  @retval UNIT_TEST_ERROR_TEST_FAILED   The image could not be loaded.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RelocationBenchmark (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_IMAGE  *Image;
+  UINTN       Dense;
+  UINTN       Index;
+  clock_t     Ticks[2];
+
+  Image = &mTestImages[0];
+  for (Dense = 0; Dense < 2; Dense++) {
+    mTestSeed = 2;
+    TestCreateImageFile (Image, TEST_BENCH_PAGES, (BOOLEAN)Dense);
+    UT_ASSERT_TRUE (TestLoadImage (Image));
+
+    //
+    // Move the image back and forth between two addresses, 1GB apart.
+    //
+    Ticks[0] = clock ();
+    for (Index = 0; Index < TEST_BENCH_PASSES; Index++) {
+      TestReferenceRelocate (Image, ((Index & BIT0) == 0) ? SIZE_1GB : (UINT64)-SIZE_1GB, FALSE, NULL);
+    }
+
+    Ticks[0] = clock () - Ticks[0];
+
+    Ticks[1] = clock ();
+    for (Index = 0; Index < TEST_BENCH_PASSES; Index++) {
+      Image->Context.DestinationAddress = TEST_IMAGE_BASE + (((Index & BIT0) == 0) ? SIZE_1GB : 0);
+      UT_ASSERT_NOT_EFI_ERROR (PeCoffLoaderRelocateImage (&Image->Context));
+    }
+
+    Ticks[1] = clock () - Ticks[1];
+
+    UT_LOG_INFO (
+      "%d relocations of %d %a pages: per entry %Lu us, BasePeCoffLib %Lu us\n",
+      TEST_BENCH_PASSES,
+      TEST_BENCH_PAGES,
+      (Dense != 0) ? "pointer" : "mixed",
+      (UINT64)(Ticks[0] * 1000000 / CLOCKS_PER_SEC),
+      (UINT64)(Ticks[1] * 1000000 / CLOCKS_PER_SEC)
+      );
+
+    TestFreeImage (Image);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Cleanup function that frees the test images.
+
+  @param[in] Context  Unused.
+**/
+VOID
+EFIAPI
+TestImageCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TestFreeImage (&mTestImages[0]);
+  TestFreeImage (&mTestImages[1]);
+}
+
+/// === TEST ENGINE ================================================================================
+
+/**
+  Main entry point to the unit test.
+**/
+VOID
+EFIAPI
+UnitTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      RelocationTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  //
+  // Add all test suites and tests.
+  //
+  Status = CreateUnitTestSuite (
+             &RelocationTests,
+             Framework,
+             "PE/COFF Relocation Tests",
+             "BasePeCoffLib.Relocation",
+             NULL,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for RelocationTests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (
+    RelocationTests,
+    "Relocations of every type should match the per-entry reference",
+    "Mixed",
+    MixedRelocationsMatchReference,
+    NULL,
+    TestImageCleanup,
+    NULL
+    );
+  AddTestCase (
+    RelocationTests,
+    "Pages of pointers should match the per-entry reference",
+    "Dense",
+    DenseRelocationsMatchReference,
+    NULL,
+    TestImageCleanup,
+    NULL
+    );
+  AddTestCase (
+    RelocationTests,
+    "Relocation should be cheaper than the per-entry reference",
+    "Benchmark",
+    RelocationBenchmark,
+    NULL,
+    TestImageCleanup,
+    NULL
+    );
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define Main  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+Main (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestMain ();
+  return 0;
+}
@@ -0,0 +1,92 @@
+/** @file
+  Tests for HttpBootRange.c.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <gtest/gtest.h>
+
+extern "C" {
+  #include <Uefi.h>
+  #include <Library/BaseLib.h>
+  #include <Library/DebugLib.h>
+  #include "../HttpBootDxe.h"
+}
+
+////////////////////////////////////////////////////////////////////////
+// Symbol Definitions
+// These functions are not directly under test - but required to compile
+////////////////////////////////////////////////////////////////////////
+EFI_STATUS
+HttpBootCheckImageType (
+  IN      CHAR8              *Uri,
+  IN      VOID               *UriParser,
+  IN      UINTN              HeaderCount,
+  IN      EFI_HTTP_HEADER    *Headers,
+  OUT  HTTP_BOOT_IMAGE_TYPE  *ImageType
+  )
+{
+  *ImageType = ImageTypeEfi;
+  return EFI_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////
+// HttpBootParseContentRange Tests
+////////////////////////////////////////////////////////////////////////
+
+class HttpBootParseContentRangeTest : public ::testing::Test {
+protected:
+  UINTN First;
+  UINTN Last;
+  UINTN CompleteLength;
+
+  EFI_STATUS
+  Parse (
+    CONST CHAR8  *Value
+    )
+  {
+    CHAR8  Buffer[64];
+
+    AsciiStrCpyS (Buffer, sizeof (Buffer), Value);
+    return HttpBootParseContentRange (Buffer, &First, &Last, &CompleteLength);
+  }
+};
+
+// A byte range of a file with a known length is accepted.
+TEST_F (HttpBootParseContentRangeTest, ValidRangeShouldBeParsed) {
+  ASSERT_EQ (Parse ("bytes 0-499/1234"), EFI_SUCCESS);
+  ASSERT_EQ (First, (UINTN)0);
+  ASSERT_EQ (Last, (UINTN)499);
+  ASSERT_EQ (CompleteLength, (UINTN)1234);
+
+  ASSERT_EQ (Parse ("bytes 4194304-8388607/10000000"), EFI_SUCCESS);
+  ASSERT_EQ (First, (UINTN)4194304);
+  ASSERT_EQ (Last, (UINTN)8388607);
+  ASSERT_EQ (CompleteLength, (UINTN)10000000);
+
+  ASSERT_EQ (Parse ("bytes 1233-1233/1234"), EFI_SUCCESS);
+}
+
+// An unsatisfied range or an unknown length can't be used to place the data.
+TEST_F (HttpBootParseContentRangeTest, UnknownRangeOrLengthShouldBeRejected) {
+  ASSERT_EQ (Parse ("bytes */1234"), EFI_INVALID_PARAMETER);
+  ASSERT_EQ (Parse ("bytes 0-499/*"), EFI_INVALID_PARAMETER);
+}
+
+// Ranges outside of the file or in the wrong order are rejected.
+TEST_F (HttpBootParseContentRangeTest, InconsistentRangeShouldBeRejected) {
+  ASSERT_EQ (Parse ("bytes 500-499/1234"), EFI_INVALID_PARAMETER);
+  ASSERT_EQ (Parse ("bytes 0-1234/1234"), EFI_INVALID_PARAMETER);
+  ASSERT_EQ (Parse ("bytes 0-0/0"), EFI_INVALID_PARAMETER);
+}
+
+// Anything but a single byte range is rejected.
+TEST_F (HttpBootParseContentRangeTest, MalformedValueShouldBeRejected) {
+  ASSERT_EQ (Parse ("items 0-1/2"), EFI_INVALID_PARAMETER);
+  ASSERT_EQ (Parse ("bytes -1/2"), EFI_INVALID_PARAMETER);
+  ASSERT_EQ (Parse ("bytes 0-/2"), EFI_INVALID_PARAMETER);
+  ASSERT_EQ (Parse ("bytes 0-1"), EFI_INVALID_PARAMETER);
+  ASSERT_EQ (Parse ("bytes 0-1/2 "), EFI_INVALID_PARAMETER);
+  ASSERT_EQ (Parse ("bytes 0-1/2,3-4/5"), EFI_INVALID_PARAMETER);
+  ASSERT_EQ (Parse (""), EFI_INVALID_PARAMETER);
+}
@@ -597,21 +597,24 @@ HttpBootHttpIoCallback (
 }
 
 /**
-  Create a HttpIo instance for the file download.
+  Create and configure a HttpIo instance for the boot file server.
 
   @param[in]    Private        The pointer to the driver's private data.
+  @param[in]    Callback       Callback function for the HttpIo, optional.
+  @param[out]   HttpIo         The HttpIo instance to initialize.
 
   @retval EFI_SUCCESS          Successfully created.
   @retval Others               Failed to create HttpIo.
 
 **/
 EFI_STATUS
-HttpBootCreateHttpIo (
-  IN     HTTP_BOOT_PRIVATE_DATA  *Private
+HttpBootInitHttpIo (
+  IN     HTTP_BOOT_PRIVATE_DATA  *Private,
+  IN     HTTP_IO_CALLBACK        Callback  OPTIONAL,
+  OUT    HTTP_IO                 *HttpIo
   )
 {
   HTTP_IO_CONFIG_DATA  ConfigData;
-  EFI_STATUS           Status;
   EFI_HANDLE           ImageHandle;
   UINT32               TimeoutValue;
 
@@ -636,15 +639,34 @@ HttpBootCreateHttpIo (
     ImageHandle = Private->Ip6Nic->ImageHandle;
   }
 
-  Status = HttpIoCreateIo (
-             ImageHandle,
-             Private->Controller,
-             Private->UsingIpv6 ? IP_VERSION_6 : IP_VERSION_4,
-             &ConfigData,
-             HttpBootHttpIoCallback,
-             (VOID *)Private,
-             &Private->HttpIo
-             );
+  return HttpIoCreateIo (
+           ImageHandle,
+           Private->Controller,
+           Private->UsingIpv6 ? IP_VERSION_6 : IP_VERSION_4,
+           &ConfigData,
+           Callback,
+           (VOID *)Private,
+           HttpIo
+           );
+}
+
+/**
+  Create a HttpIo instance for the file download.
+
+  @param[in]    Private        The pointer to the driver's private data.
+
+  @retval EFI_SUCCESS          Successfully created.
+  @retval Others               Failed to create HttpIo.
+
+**/
+EFI_STATUS
+HttpBootCreateHttpIo (
+  IN     HTTP_BOOT_PRIVATE_DATA  *Private
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = HttpBootInitHttpIo (Private, HttpBootHttpIoCallback, &Private->HttpIo);
   if (EFI_ERROR (Status)) {
     return Status;
   }
@@ -901,6 +923,122 @@ HttpBootGetBootFileCallback (
   return EFI_SUCCESS;
 }
 
+/**
+  Build the HTTP header for a boot file request, which includes the Host, Accept,
+  User-Agent and, if the authentication information is known, Authorization fields.
+
+  @param[in]       Private         The pointer to the driver's private data.
+  @param[in]       ExtraCount      Number of header fields the caller will add.
+  @param[out]      HttpIoHeader    The created HTTP header.
+
+  @retval EFI_SUCCESS              The header was created.
+  @retval EFI_OUT_OF_RESOURCES     Could not allocate needed resources.
+  @retval EFI_UNSUPPORTED          The authentication scheme is not supported.
+  @retval Others                   Unexpected error happened.
+
+**/
+EFI_STATUS
+HttpBootCreateRequestHeader (
+  IN     HTTP_BOOT_PRIVATE_DATA  *Private,
+  IN     UINTN                   ExtraCount,
+  OUT    HTTP_IO_HEADER          **HttpIoHeader
+  )
+{
+  EFI_STATUS      Status;
+  HTTP_IO_HEADER  *Header;
+  CHAR8           *HostName;
+  CHAR8           BaseAuthValue[80];
+
+  Header = HttpIoCreateHeader (((Private->AuthData != NULL) ? 4 : 3) + ExtraCount);
+  if (Header == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Add HTTP header field 1: Host
+  //
+  HostName = NULL;
+  Status   = HttpUrlGetHostName (
+               Private->BootFileUri,
+               Private->BootFileUriParser,
+               &HostName
+               );
+  if (EFI_ERROR (Status)) {
+    goto ON_ERROR;
+  }
+
+  Status = HttpIoSetHeader (
+             Header,
+             HTTP_HEADER_HOST,
+             HostName
+             );
+  FreePool (HostName);
+  if (EFI_ERROR (Status)) {
+    goto ON_ERROR;
+  }
+
+  //
+  // Add HTTP header field 2: Accept
+  //
+  Status = HttpIoSetHeader (
+             Header,
+             HTTP_HEADER_ACCEPT,
+             "*/*"
+             );
+  if (EFI_ERROR (Status)) {
+    goto ON_ERROR;
+  }
+
+  //
+  // Add HTTP header field 3: User-Agent
+  //
+  Status = HttpIoSetHeader (
+             Header,
+             HTTP_HEADER_USER_AGENT,
+             HTTP_USER_AGENT_EFI_HTTP_BOOT
+             );
+  if (EFI_ERROR (Status)) {
+    goto ON_ERROR;
+  }
+
+  //
+  // Add HTTP header field 4: Authorization
+  //
+  if (Private->AuthData != NULL) {
+    ASSERT (Header->MaxHeaderCount == 4 + ExtraCount);
+
+    if ((Private->AuthScheme != NULL) && (CompareMem (Private->AuthScheme, "Basic", 5) != 0)) {
+      Status = EFI_UNSUPPORTED;
+      goto ON_ERROR;
+    }
+
+    AsciiSPrint (
+      BaseAuthValue,
+      sizeof (BaseAuthValue),
+      "%a %a",
+      "Basic",
+      Private->AuthData
+      );
+
+    Status = HttpIoSetHeader (
+               Header,
+               HTTP_HEADER_AUTHORIZATION,
+               BaseAuthValue
+               );
+    if (EFI_ERROR (Status)) {
+      goto ON_ERROR;
+    }
+  }
+
+
+  *HttpIoHeader = Header;
+  return EFI_SUCCESS;
+
+ON_ERROR:
+  HttpIoFreeHeader (Header);
+  return Status;
+}
+
 /**
   This function download the boot file by using UEFI HTTP protocol.
 
@@ -937,7 +1075,6 @@ HttpBootGetBootFile (
 {
   EFI_STATUS               Status;
   EFI_HTTP_STATUS_CODE     StatusCode;
-  CHAR8                    *HostName;
   EFI_HTTP_REQUEST_DATA    *RequestData;
   HTTP_IO_RESPONSE_DATA    *ResponseData;
   HTTP_IO_RESPONSE_DATA    ResponseBody;
@@ -947,12 +1084,14 @@ HttpBootGetBootFile (
   HTTP_BOOT_CALLBACK_DATA  Context;
   UINTN                    ContentLength;
   HTTP_BOOT_CACHE_CONTENT  *Cache;
+  HTTP_BOOT_ENTITY_DATA    *EntityData;
   UINT8                    *Block;
+  UINTN                    BlockSize;
+  UINTN                    BlockOffset;
   UINTN                    UrlSize;
   CHAR16                   *Url;
   BOOLEAN                  IdentityMode;
   UINTN                    ReceivedSize;
-  CHAR8                    BaseAuthValue[80];
   EFI_HTTP_HEADER          *HttpHeader;
   CHAR8                    *Data;
 
@@ -986,8 +1125,16 @@ HttpBootGetBootFile (
   }
 
   //
-  // Not found in cache, try to download it through HTTP.
+  // Not found in cache, try to download it through HTTP. Large files are
+  // downloaded over several connections in parallel if the server supports it.
   //
+  if (!HeaderOnly && (Buffer != NULL)) {
+    Status = HttpBootGetBootFileByRange (Private, Url, BufferSize, Buffer, ImageType);
+    if (Status != EFI_UNSUPPORTED) {
+      FreePool (Url);
+      return Status;
+    }
+  }
 
   //
   // 1. Create a temp cache item for the requested URI if caller doesn't provide buffer.
@@ -1015,86 +1162,9 @@ HttpBootGetBootFile (
   //       User-Agent
   //       [Authorization]
   //
-  HttpIoHeader = HttpIoCreateHeader ((Private->AuthData != NULL) ? 4 : 3);
-  if (HttpIoHeader == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto ERROR_2;
-  }
-
-  //
-  // Add HTTP header field 1: Host
-  //
-  HostName = NULL;
-  Status   = HttpUrlGetHostName (
-               Private->BootFileUri,
-               Private->BootFileUriParser,
-               &HostName
-               );
+  Status = HttpBootCreateRequestHeader (Private, 0, &HttpIoHeader);
   if (EFI_ERROR (Status)) {
-    goto ERROR_3;
-  }
-
-  Status = HttpIoSetHeader (
-             HttpIoHeader,
-             HTTP_HEADER_HOST,
-             HostName
-             );
-  FreePool (HostName);
-  if (EFI_ERROR (Status)) {
-    goto ERROR_3;
-  }
-
-  //
-  // Add HTTP header field 2: Accept
-  //
-  Status = HttpIoSetHeader (
-             HttpIoHeader,
-             HTTP_HEADER_ACCEPT,
-             "*/*"
-             );
-  if (EFI_ERROR (Status)) {
-    goto ERROR_3;
-  }
-
-  //
-  // Add HTTP header field 3: User-Agent
-  //
-  Status = HttpIoSetHeader (
-             HttpIoHeader,
-             HTTP_HEADER_USER_AGENT,
-             HTTP_USER_AGENT_EFI_HTTP_BOOT
-             );
-  if (EFI_ERROR (Status)) {
-    goto ERROR_3;
-  }
-
-  //
-  // Add HTTP header field 4: Authorization
-  //
-  if (Private->AuthData != NULL) {
-    ASSERT (HttpIoHeader->MaxHeaderCount == 4);
-
-    if ((Private->AuthScheme != NULL) && (CompareMem (Private->AuthScheme, "Basic", 5) != 0)) {
-      Status = EFI_UNSUPPORTED;
-      goto ERROR_3;
-    }
-
-    AsciiSPrint (
-      BaseAuthValue,
-      sizeof (BaseAuthValue),
-      "%a %a",
-      "Basic",
-      Private->AuthData
-      );
-
-    Status = HttpIoSetHeader (
-               HttpIoHeader,
-               HTTP_HEADER_AUTHORIZATION,
-               BaseAuthValue
-               );
-    if (EFI_ERROR (Status)) {
-      goto ERROR_3;
-    }
+    goto ERROR_2;
   }
 
   //
@@ -1237,6 +1307,18 @@ HttpBootGetBootFile (
     goto ERROR_5;
   }
 
+  //
+  // Record whether the server accepts range requests for the file.
+  //
+  if (HeaderOnly) {
+    HttpHeader = HttpFindHeader (
+                   ResponseData->HeaderCount,
+                   ResponseData->Headers,
+                   HTTP_HEADER_ACCEPT_RANGES
+                   );
+    Private->AcceptRanges = (BOOLEAN)((HttpHeader != NULL) && (AsciiStriCmp (HttpHeader->FieldValue, "bytes") == 0));
+  }
+
   //
   // 3.2 Cache the response header.
   //
@@ -1294,16 +1376,37 @@ HttpBootGetBootFile (
       //
       // In identity transfer-coding there is no need to parse the message body,
       // just download the message body to the user provided buffer directly.
+      // If the caller doesn't provide a buffer, download it directly into cache
+      // blocks of up to HTTP_BOOT_CACHE_BLOCK_SIZE bytes, so the body is received
+      // only once without allocating the whole entity length at a time.
       //
       ReceivedSize = 0;
+      BlockSize    = 0;
+      BlockOffset  = 0;
       while (ReceivedSize < ContentLength) {
-        ResponseBody.Body       = (CHAR8 *)Buffer + ReceivedSize;
-        ResponseBody.BodyLength = *BufferSize - ReceivedSize;
-        Status                  = HttpIoRecvResponse (
-                                    &Private->HttpIo,
-                                    FALSE,
-                                    &ResponseBody
-                                    );
+        if (Cache != NULL) {
+          if (Context.Block == NULL) {
+            BlockSize     = MIN (ContentLength - ReceivedSize, HTTP_BOOT_CACHE_BLOCK_SIZE);
+            BlockOffset   = 0;
+            Context.Block = AllocatePool (BlockSize);
+            if (Context.Block == NULL) {
+              Status = EFI_OUT_OF_RESOURCES;
+              goto ERROR_6;
+            }
+          }
+
+          ResponseBody.Body       = (CHAR8 *)Context.Block + BlockOffset;
+          ResponseBody.BodyLength = BlockSize - BlockOffset;
+        } else {
+          ResponseBody.Body       = (CHAR8 *)Buffer + ReceivedSize;
+          ResponseBody.BodyLength = *BufferSize - ReceivedSize;
+        }
+
+        Status = HttpIoRecvResponse (
+                   &Private->HttpIo,
+                   FALSE,
+                   &ResponseBody
+                   );
         if (EFI_ERROR (Status) || EFI_ERROR (ResponseBody.Status)) {
           if (EFI_ERROR (ResponseBody.Status)) {
             Status = ResponseBody.Status;
@@ -1325,6 +1428,26 @@ HttpBootGetBootFile (
             goto ERROR_6;
           }
         }
+
+        //
+        // Save the cache block into the cache list once it is full.
+        //
+        if (Context.Block != NULL) {
+          BlockOffset += ResponseBody.BodyLength;
+          if (BlockOffset == BlockSize) {
+            EntityData = AllocatePool (sizeof (HTTP_BOOT_ENTITY_DATA));
+            if (EntityData == NULL) {
+              Status = EFI_OUT_OF_RESOURCES;
+              goto ERROR_6;
+            }
+
+            EntityData->Block      = Context.Block;
+            EntityData->DataStart  = Context.Block;
+            EntityData->DataLength = BlockSize;
+            InsertTailList (&Cache->EntityDataList, &EntityData->Link);
+            Context.Block = NULL;
+          }
+        }
       }
     } else {
       //
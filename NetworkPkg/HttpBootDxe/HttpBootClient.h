@@ -11,6 +11,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define __EFI_HTTP_BOOT_HTTP_H__
 
 #define HTTP_BOOT_BLOCK_SIZE                   32000
+#define HTTP_BOOT_CACHE_BLOCK_SIZE             SIZE_1MB
 #define HTTP_USER_AGENT_EFI_HTTP_BOOT          "UefiHttpBoot/1.0"
 #define HTTP_BOOT_AUTHENTICATION_INFO_MAX_LEN  255
 
@@ -72,6 +73,24 @@ HttpBootDiscoverBootInfo (
   IN OUT HTTP_BOOT_PRIVATE_DATA  *Private
   );
 
+/**
+  Create and configure a HttpIo instance for the boot file server.
+
+  @param[in]    Private        The pointer to the driver's private data.
+  @param[in]    Callback       Callback function for the HttpIo, optional.
+  @param[out]   HttpIo         The HttpIo instance to initialize.
+
+  @retval EFI_SUCCESS          Successfully created.
+  @retval Others               Failed to create HttpIo.
+
+**/
+EFI_STATUS
+HttpBootInitHttpIo (
+  IN     HTTP_BOOT_PRIVATE_DATA  *Private,
+  IN     HTTP_IO_CALLBACK        Callback  OPTIONAL,
+  OUT    HTTP_IO                 *HttpIo
+  );
+
 /**
   Create a HttpIo instance for the file download.
 
@@ -86,6 +105,27 @@ HttpBootCreateHttpIo (
   IN     HTTP_BOOT_PRIVATE_DATA  *Private
   );
 
+/**
+  Build the HTTP header for a boot file request, which includes the Host, Accept,
+  User-Agent and, if the authentication information is known, Authorization fields.
+
+  @param[in]       Private         The pointer to the driver's private data.
+  @param[in]       ExtraCount      Number of header fields the caller will add.
+  @param[out]      HttpIoHeader    The created HTTP header.
+
+  @retval EFI_SUCCESS              The header was created.
+  @retval EFI_OUT_OF_RESOURCES     Could not allocate needed resources.
+  @retval EFI_UNSUPPORTED          The authentication scheme is not supported.
+  @retval Others                   Unexpected error happened.
+
+**/
+EFI_STATUS
+HttpBootCreateRequestHeader (
+  IN     HTTP_BOOT_PRIVATE_DATA  *Private,
+  IN     UINTN                   ExtraCount,
+  OUT    HTTP_IO_HEADER          **HttpIoHeader
+  );
+
 /**
   This function download the boot file by using UEFI HTTP protocol.
 
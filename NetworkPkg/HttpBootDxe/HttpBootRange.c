@@ -0,0 +1,532 @@
+/** @file
+  Parallel download of the boot file with HTTP range requests.
+
+  The boot file is split into HTTP_BOOT_RANGE_SEGMENT_SIZE segments which are
+  requested over several HTTP children, so that a long round trip time to the
+  server is hidden behind several TCP windows in flight. The segments are
+  received directly to their place in the caller's buffer in whatever order
+  they complete.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "HttpBootDxe.h"
+
+/**
+  Parse a decimal number followed by Delimiter.
+
+  @param[in]   String            The string to parse.
+  @param[in]   Delimiter         The character expected after the number.
+  @param[out]  Number            The parsed number.
+
+  @return The character after Delimiter, or NULL if String doesn't start with
+          a number followed by Delimiter.
+
+**/
+STATIC
+CHAR8 *
+HttpBootParseRangeNumber (
+  IN  CHAR8  *String,
+  IN  CHAR8  Delimiter,
+  OUT UINTN  *Number
+  )
+{
+  CHAR8  *End;
+
+  if ((*String < '0') || (*String > '9')) {
+    return NULL;
+  }
+
+  if (RETURN_ERROR (AsciiStrDecimalToUintnS (String, &End, Number)) || (*End != Delimiter)) {
+    return NULL;
+  }
+
+  return End + 1;
+}
+
+/**
+  Parse the value of a Content-Range header, e.g. "bytes 0-499/1234".
+
+  @param[in]   Value             The Content-Range header value.
+  @param[out]  First             The offset of the first byte in the range.
+  @param[out]  Last              The offset of the last byte in the range.
+  @param[out]  CompleteLength    The length of the whole representation.
+
+  @retval EFI_SUCCESS            The value was parsed.
+  @retval EFI_INVALID_PARAMETER  The value is not a valid byte range, or the
+                                 complete length is unknown.
+
+**/
+EFI_STATUS
+HttpBootParseContentRange (
+  IN  CHAR8  *Value,
+  OUT UINTN  *First,
+  OUT UINTN  *Last,
+  OUT UINTN  *CompleteLength
+  )
+{
+  if (AsciiStrnCmp (Value, "bytes ", sizeof ("bytes ") - 1) != 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Value = HttpBootParseRangeNumber (Value + sizeof ("bytes ") - 1, '-', First);
+  if (Value != NULL) {
+    Value = HttpBootParseRangeNumber (Value, '/', Last);
+  }
+
+  if (Value != NULL) {
+    Value = HttpBootParseRangeNumber (Value, '\0', CompleteLength);
+  }
+
+  if ((Value == NULL) || (*First > *Last) || (*Last >= *CompleteLength)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Request the next segment of the boot file on a connection.
+
+  @param[in]       Download        The ranged download.
+  @param[in, out]  Connection      An idle connection of the download.
+
+  @retval EFI_SUCCESS              The request was sent.
+  @retval Others                   Failed to send the request.
+
+**/
+STATIC
+EFI_STATUS
+HttpBootRangeRequest (
+  IN OUT HTTP_BOOT_RANGE_DOWNLOAD    *Download,
+  IN OUT HTTP_BOOT_RANGE_CONNECTION  *Connection
+  )
+{
+  EFI_STATUS  Status;
+  CHAR8       RangeValue[HTTP_BOOT_RANGE_VALUE_LEN];
+
+  ASSERT (Connection->State == HttpBootRangeIdle);
+  ASSERT (Download->NextOffset < Download->FileSize);
+
+  Connection->First     = Download->NextOffset;
+  Connection->Length    = MIN (HTTP_BOOT_RANGE_SEGMENT_SIZE, Download->FileSize - Download->NextOffset);
+  Connection->Received  = 0;
+  Download->NextOffset += Connection->Length;
+
+  AsciiSPrint (
+    RangeValue,
+    sizeof (RangeValue),
+    "bytes=%lu-%lu",
+    (UINT64)Connection->First,
+    (UINT64)(Connection->First + Connection->Length - 1)
+    );
+  Status = HttpIoSetHeader (Download->HttpIoHeader, HTTP_HEADER_RANGE, RangeValue);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = HttpIoSendRequest (
+             &Connection->HttpIo,
+             &Download->RequestData,
+             Download->HttpIoHeader->HeaderCount,
+             Download->HttpIoHeader->Headers,
+             0,
+             NULL
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Connection->State = HttpBootRangeHeader;
+  return EFI_SUCCESS;
+}
+
+/**
+  Queue a response token on a connection, for the response header or for the
+  rest of the current segment depending on the connection's state.
+
+  The token completes asynchronously, the caller polls the HTTP child until
+  HttpIo.IsRxDone is set.
+
+  @param[in]       Download        The ranged download.
+  @param[in, out]  Connection      A connection of the download with a request outstanding.
+
+  @retval EFI_SUCCESS              The token was queued.
+  @retval Others                   Failed to queue the token.
+
+**/
+STATIC
+EFI_STATUS
+HttpBootRangeReceive (
+  IN     HTTP_BOOT_RANGE_DOWNLOAD    *Download,
+  IN OUT HTTP_BOOT_RANGE_CONNECTION  *Connection
+  )
+{
+  EFI_STATUS        Status;
+  HTTP_IO           *HttpIo;
+  EFI_HTTP_MESSAGE  *Message;
+
+  HttpIo  = &Connection->HttpIo;
+  Message = HttpIo->RspToken.Message;
+
+  HttpIo->RspToken.Status = EFI_NOT_READY;
+  Message->HeaderCount    = 0;
+  Message->Headers        = NULL;
+  if (Connection->State == HttpBootRangeHeader) {
+    Message->Data.Response = &Connection->Response;
+    Message->BodyLength    = 0;
+    Message->Body          = NULL;
+  } else {
+    Message->Data.Response = NULL;
+    Message->BodyLength    = Connection->Length - Connection->Received;
+    Message->Body          = Download->Buffer + Connection->First + Connection->Received;
+  }
+
+  HttpIo->IsRxDone = FALSE;
+  Status           = gBS->SetTimer (HttpIo->TimeoutEvent, TimerRelative, HttpIo->Timeout * TICKS_PER_MS);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = HttpIo->Http->Response (HttpIo->Http, &HttpIo->RspToken);
+  if (EFI_ERROR (Status)) {
+    gBS->SetTimer (HttpIo->TimeoutEvent, TimerCancel, 0);
+  }
+
+  return Status;
+}
+
+/**
+  Check that the response header received on a connection carries exactly the
+  requested segment of the boot file, and free the header.
+
+  @param[in, out]  Download        The ranged download.
+  @param[in]       Connection      The connection which received the header.
+
+  @retval EFI_SUCCESS              The response carries the requested segment.
+  @retval EFI_UNSUPPORTED          The server didn't answer with the requested
+                                   segment of the same file.
+  @retval Others                   Unexpected error happened.
+
+**/
+STATIC
+EFI_STATUS
+HttpBootRangeCheckResponse (
+  IN OUT HTTP_BOOT_RANGE_DOWNLOAD    *Download,
+  IN     HTTP_BOOT_RANGE_CONNECTION  *Connection
+  )
+{
+  EFI_STATUS        Status;
+  EFI_HTTP_MESSAGE  *Message;
+  EFI_HTTP_HEADER   *Header;
+  UINTN             First;
+  UINTN             Last;
+  UINTN             CompleteLength;
+
+  Message = Connection->HttpIo.RspToken.Message;
+  Status  = Connection->HttpIo.RspToken.Status;
+  if (EFI_ERROR (Status) && (Status != EFI_HTTP_ERROR)) {
+    goto ON_EXIT;
+  }
+
+  //
+  // A server which ignores the Range header answers with the whole file,
+  // leave it to the single connection download in that case.
+  //
+  Status = EFI_UNSUPPORTED;
+  if (Connection->Response.StatusCode != HTTP_STATUS_206_PARTIAL_CONTENT) {
+    DEBUG ((DEBUG_WARN, "HttpBoot: Range request answered with status %d.\n", Connection->Response.StatusCode));
+    goto ON_EXIT;
+  }
+
+  Header = HttpFindHeader (Message->HeaderCount, Message->Headers, HTTP_HEADER_CONTENT_RANGE);
+  if ((Header == NULL) ||
+      EFI_ERROR (HttpBootParseContentRange (Header->FieldValue, &First, &Last, &CompleteLength)) ||
+      (First != Connection->First) ||
+      (Last != Connection->First + Connection->Length - 1) ||
+      (CompleteLength != Download->FileSize))
+  {
+    DEBUG ((DEBUG_ERROR, "HttpBoot: Unexpected Content-Range for bytes %lu-%lu.\n", (UINT64)Connection->First, (UINT64)(Connection->First + Connection->Length - 1)));
+    goto ON_EXIT;
+  }
+
+  Header = HttpFindHeader (Message->HeaderCount, Message->Headers, HTTP_HEADER_CONTENT_LENGTH);
+  if ((Header != NULL) && (AsciiStrDecimalToUintn (Header->FieldValue) != Connection->Length)) {
+    DEBUG ((DEBUG_ERROR, "HttpBoot: Content-Length doesn't match the Content-Range.\n"));
+    goto ON_EXIT;
+  }
+
+  //
+  // All the segments must come from the same version of the file.
+  //
+  Header = HttpFindHeader (Message->HeaderCount, Message->Headers, HTTP_HEADER_ETAG);
+  if (!Download->HeaderChecked) {
+    if (Header != NULL) {
+      Download->ETag = AllocateCopyPool (AsciiStrSize (Header->FieldValue), Header->FieldValue);
+      if (Download->ETag == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+        goto ON_EXIT;
+      }
+    }
+
+    Status = HttpBootCheckImageType (
+               Download->Private->BootFileUri,
+               Download->Private->BootFileUriParser,
+               Message->HeaderCount,
+               Message->Headers,
+               &Download->ImageType
+               );
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+
+    Download->HeaderChecked = TRUE;
+  } else if ((Header == NULL) != (Download->ETag == NULL)) {
+    DEBUG ((DEBUG_ERROR, "HttpBoot: Entity tag changed during the download.\n"));
+    goto ON_EXIT;
+  } else if ((Header != NULL) && (AsciiStrCmp (Header->FieldValue, Download->ETag) != 0)) {
+    DEBUG ((DEBUG_ERROR, "HttpBoot: Entity tag changed during the download.\n"));
+    goto ON_EXIT;
+  }
+
+  Status = EFI_SUCCESS;
+
+ON_EXIT:
+  HttpFreeHeaderFields (Message->Headers, Message->HeaderCount);
+  Message->Headers     = NULL;
+  Message->HeaderCount = 0;
+  return Status;
+}
+
+/**
+  Handle the completion of the response token queued on a connection, and
+  queue the next one.
+
+  @param[in, out]  Download        The ranged download.
+  @param[in, out]  Connection      The connection whose token completed.
+
+  @retval EFI_SUCCESS              The data was received and the next token is queued.
+  @retval EFI_UNSUPPORTED          The server didn't answer with the requested segment.
+  @retval Others                   Unexpected error happened.
+
+**/
+STATIC
+EFI_STATUS
+HttpBootRangeComplete (
+  IN OUT HTTP_BOOT_RANGE_DOWNLOAD    *Download,
+  IN OUT HTTP_BOOT_RANGE_CONNECTION  *Connection
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_HTTP_MESSAGE                 *Message;
+  EFI_HTTP_BOOT_CALLBACK_PROTOCOL  *HttpBootCallback;
+
+  gBS->SetTimer (Connection->HttpIo.TimeoutEvent, TimerCancel, 0);
+  Connection->HttpIo.IsRxDone = FALSE;
+
+  if (Connection->State == HttpBootRangeHeader) {
+    Status = HttpBootRangeCheckResponse (Download, Connection);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Connection->State = HttpBootRangeBody;
+  } else {
+    Message = Connection->HttpIo.RspToken.Message;
+    Status  = Connection->HttpIo.RspToken.Status;
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    HttpBootCallback = Download->Private->HttpBootCallback;
+    if ((HttpBootCallback != NULL) && (Message->BodyLength != 0)) {
+      Status = HttpBootCallback->Callback (
+                                   HttpBootCallback,
+                                   HttpBootHttpEntityBody,
+                                   TRUE,
+                                   (UINT32)Message->BodyLength,
+                                   Message->Body
+                                   );
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    Connection->Received   += Message->BodyLength;
+    Download->ReceivedSize += Message->BodyLength;
+    if (Connection->Received == Connection->Length) {
+      Connection->State = HttpBootRangeIdle;
+      if (Download->NextOffset < Download->FileSize) {
+        Status = HttpBootRangeRequest (Download, Connection);
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+      }
+    }
+  }
+
+  if (Connection->State == HttpBootRangeIdle) {
+    return EFI_SUCCESS;
+  }
+
+  return HttpBootRangeReceive (Download, Connection);
+}
+
+/**
+  Download the boot file with HTTP range requests over several HTTP children in
+  parallel, each segment being received directly to its place in Buffer.
+
+  The ranged download is only used if PcdHttpBootRangeConnections is greater than
+  1, the server announced "Accept-Ranges: bytes" for the boot file and the file is
+  at least HTTP_BOOT_RANGE_MIN_FILE_SIZE bytes long. Every response must be a
+  206 (Partial Content) carrying exactly the requested range of a file of the
+  expected size and the same entity tag, otherwise the download is abandoned.
+
+  @param[in]       Private         The pointer to the driver's private data.
+  @param[in]       Url             The boot file URL.
+  @param[in, out]  BufferSize      On input the size of Buffer in bytes. On output with
+                                   a return code of EFI_SUCCESS, the amount of data
+                                   transferred to Buffer.
+  @param[out]      Buffer          The memory buffer to transfer the file to.
+  @param[out]      ImageType       The image type of the downloaded file.
+
+  @retval EFI_SUCCESS              The file was loaded.
+  @retval EFI_UNSUPPORTED          The ranged download can't be used for this file,
+                                   the caller should download it with a single request.
+  @retval Others                   Unexpected error happened.
+
+**/
+EFI_STATUS
+HttpBootGetBootFileByRange (
+  IN     HTTP_BOOT_PRIVATE_DATA  *Private,
+  IN     CHAR16                  *Url,
+  IN OUT UINTN                   *BufferSize,
+  OUT    UINT8                   *Buffer,
+  OUT    HTTP_BOOT_IMAGE_TYPE    *ImageType
+  )
+{
+  EFI_STATUS                  Status;
+  HTTP_BOOT_RANGE_DOWNLOAD    Download;
+  HTTP_BOOT_RANGE_CONNECTION  *Connection;
+  UINTN                       ConnectionCount;
+  UINTN                       Index;
+
+  ConnectionCount = MIN (PcdGet8 (PcdHttpBootRangeConnections), HTTP_BOOT_RANGE_MAX_CONNECTIONS);
+  if ((ConnectionCount < 2) || !Private->AcceptRanges ||
+      (Private->BootFileSize < HTTP_BOOT_RANGE_MIN_FILE_SIZE) ||
+      (*BufferSize < Private->BootFileSize))
+  {
+    return EFI_UNSUPPORTED;
+  }
+
+  ZeroMem (&Download, sizeof (Download));
+  Download.Private            = Private;
+  Download.Buffer             = Buffer;
+  Download.FileSize           = Private->BootFileSize;
+  Download.ImageType          = ImageTypeMax;
+  Download.RequestData.Method = HttpMethodGet;
+  Download.RequestData.Url    = Url;
+  Download.ConnectionCount    = MIN (
+                                  ConnectionCount,
+                                  (Download.FileSize + HTTP_BOOT_RANGE_SEGMENT_SIZE - 1) / HTTP_BOOT_RANGE_SEGMENT_SIZE
+                                  );
+
+  Download.Connections = AllocateZeroPool (Download.ConnectionCount * sizeof (HTTP_BOOT_RANGE_CONNECTION));
+  if (Download.Connections == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = HttpBootCreateRequestHeader (Private, 1, &Download.HttpIoHeader);
+  if (EFI_ERROR (Status)) {
+    goto ON_EXIT;
+  }
+
+  //
+  // Each HTTP child opens its own TCP connection to the server with its first
+  // request. The response callback of the HttpIo is not used, so that the
+  // HTTP Boot Callback Protocol sees the download as one entity body.
+  //
+  for (Index = 0; Index < Download.ConnectionCount; Index++) {
+    Connection = &Download.Connections[Index];
+    Status     = HttpBootInitHttpIo (Private, NULL, &Connection->HttpIo);
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+
+    Connection->HttpCreated = TRUE;
+
+    Status = HttpBootRangeRequest (&Download, Connection);
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+
+    Status = HttpBootRangeReceive (&Download, Connection);
+    if (EFI_ERROR (Status)) {
+      goto ON_EXIT;
+    }
+  }
+
+  //
+  // Poll all the connections until every segment is received. A connection
+  // requests the next segment as soon as it has received its current one.
+  //
+  while (Download.ReceivedSize < Download.FileSize) {
+    for (Index = 0; Index < Download.ConnectionCount; Index++) {
+      Connection = &Download.Connections[Index];
+      if (Connection->State == HttpBootRangeIdle) {
+        continue;
+      }
+
+      Connection->HttpIo.Http->Poll (Connection->HttpIo.Http);
+      if (!Connection->HttpIo.IsRxDone) {
+        if (!EFI_ERROR (gBS->CheckEvent (Connection->HttpIo.TimeoutEvent))) {
+          Status = EFI_TIMEOUT;
+          goto ON_EXIT;
+        }
+
+        continue;
+      }
+
+      Status = HttpBootRangeComplete (&Download, Connection);
+      if (EFI_ERROR (Status)) {
+        goto ON_EXIT;
+      }
+    }
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "HttpBoot: Downloaded %lu bytes over %d connections.\n",
+    (UINT64)Download.FileSize,
+    (UINT32)Download.ConnectionCount
+    ));
+
+  *BufferSize = Download.FileSize;
+  *ImageType  = Download.ImageType;
+  Status      = EFI_SUCCESS;
+
+ON_EXIT:
+  for (Index = 0; Index < Download.ConnectionCount; Index++) {
+    Connection = &Download.Connections[Index];
+    if (Connection->HttpCreated) {
+      if (Connection->State != HttpBootRangeIdle) {
+        Connection->HttpIo.Http->Cancel (Connection->HttpIo.Http, NULL);
+      }
+
+      HttpIoDestroyIo (&Connection->HttpIo);
+    }
+  }
+
+  if (Download.HttpIoHeader != NULL) {
+    HttpIoFreeHeader (Download.HttpIoHeader);
+  }
+
+  if (Download.ETag != NULL) {
+    FreePool (Download.ETag);
+  }
+
+  FreePool (Download.Connections);
+  return Status;
+}
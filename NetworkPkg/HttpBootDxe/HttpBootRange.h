@@ -0,0 +1,120 @@
+/** @file
+  Declaration of the parallel boot file download with HTTP range requests.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __EFI_HTTP_BOOT_RANGE_H__
+#define __EFI_HTTP_BOOT_RANGE_H__
+
+//
+// Upper limit of PcdHttpBootRangeConnections.
+//
+#define HTTP_BOOT_RANGE_MAX_CONNECTIONS  8
+
+//
+// Size of each range request. Files smaller than two segments are
+// downloaded over a single connection.
+//
+#define HTTP_BOOT_RANGE_SEGMENT_SIZE   SIZE_4MB
+#define HTTP_BOOT_RANGE_MIN_FILE_SIZE  (2 * HTTP_BOOT_RANGE_SEGMENT_SIZE)
+
+//
+// Length of the "bytes=<First>-<Last>" value of the Range header.
+//
+#define HTTP_BOOT_RANGE_VALUE_LEN  48
+
+typedef enum {
+  HttpBootRangeIdle,                    // No request outstanding.
+  HttpBootRangeHeader,                  // Waiting for the response header.
+  HttpBootRangeBody                     // Receiving the message-body.
+} HTTP_BOOT_RANGE_STATE;
+
+//
+// One HTTP child downloading a segment of the boot file.
+//
+typedef struct {
+  HTTP_IO                   HttpIo;
+  BOOLEAN                   HttpCreated;
+  HTTP_BOOT_RANGE_STATE     State;
+  UINTN                     First;      // Offset of the segment in the file.
+  UINTN                     Length;     // Length of the segment.
+  UINTN                     Received;   // Bytes of the segment received so far.
+  EFI_HTTP_RESPONSE_DATA    Response;
+} HTTP_BOOT_RANGE_CONNECTION;
+
+//
+// State of a ranged boot file download.
+//
+typedef struct {
+  HTTP_BOOT_PRIVATE_DATA        *Private;
+  HTTP_IO_HEADER                *HttpIoHeader;
+  EFI_HTTP_REQUEST_DATA         RequestData;
+  UINT8                         *Buffer;
+  UINTN                         FileSize;
+  UINTN                         NextOffset;     // Offset of the next segment to request.
+  UINTN                         ReceivedSize;
+  BOOLEAN                       HeaderChecked;  // The first response has been checked.
+  CHAR8                         *ETag;          // Entity tag of the first response.
+  HTTP_BOOT_IMAGE_TYPE          ImageType;
+  UINTN                         ConnectionCount;
+  HTTP_BOOT_RANGE_CONNECTION    *Connections;
+} HTTP_BOOT_RANGE_DOWNLOAD;
+
+/**
+  Parse the value of a Content-Range header, e.g. "bytes 0-499/1234".
+
+  @param[in]   Value             The Content-Range header value.
+  @param[out]  First             The offset of the first byte in the range.
+  @param[out]  Last              The offset of the last byte in the range.
+  @param[out]  CompleteLength    The length of the whole representation.
+
+  @retval EFI_SUCCESS            The value was parsed.
+  @retval EFI_INVALID_PARAMETER  The value is not a valid byte range, or the
+                                 complete length is unknown.
+
+**/
+EFI_STATUS
+HttpBootParseContentRange (
+  IN  CHAR8  *Value,
+  OUT UINTN  *First,
+  OUT UINTN  *Last,
+  OUT UINTN  *CompleteLength
+  );
+
+/**
+  Download the boot file with HTTP range requests over several HTTP children in
+  parallel, each segment being received directly to its place in Buffer.
+
+  The ranged download is only used if PcdHttpBootRangeConnections is greater than
+  1, the server announced "Accept-Ranges: bytes" for the boot file and the file is
+  at least HTTP_BOOT_RANGE_MIN_FILE_SIZE bytes long. Every response must be a
+  206 (Partial Content) carrying exactly the requested range of a file of the
+  expected size and the same entity tag, otherwise the download is abandoned.
+
+  @param[in]       Private         The pointer to the driver's private data.
+  @param[in]       Url             The boot file URL.
+  @param[in, out]  BufferSize      On input the size of Buffer in bytes. On output with
+                                   a return code of EFI_SUCCESS, the amount of data
+                                   transferred to Buffer.
+  @param[out]      Buffer          The memory buffer to transfer the file to.
+  @param[out]      ImageType       The image type of the downloaded file.
+
+  @retval EFI_SUCCESS              The file was loaded.
+  @retval EFI_UNSUPPORTED          The ranged download can't be used for this file,
+                                   the caller should download it with a single request.
+  @retval Others                   Unexpected error happened.
+
+**/
+EFI_STATUS
+HttpBootGetBootFileByRange (
+  IN     HTTP_BOOT_PRIVATE_DATA  *Private,
+  IN     CHAR16                  *Url,
+  IN OUT UINTN                   *BufferSize,
+  OUT    UINT8                   *Buffer,
+  OUT    HTTP_BOOT_IMAGE_TYPE    *ImageType
+  );
+
+#endif
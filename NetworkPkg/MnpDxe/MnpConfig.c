@@ -512,6 +512,12 @@ MnpInitializeDeviceData (
   InitializeListHead (&MnpDeviceData->AllTxBufList);
   MnpDeviceData->TxBufCount = 0;
 
+  //
+  // Initialize the cache of the recycled rx data wraps.
+  //
+  InitializeListHead (&MnpDeviceData->FreeRxDataWrapList);
+  MnpDeviceData->FreeRxDataWrapCount = 0;
+
   //
   // Create the system poll timer.
   //
@@ -619,6 +625,7 @@ MnpDestroyDeviceData (
   LIST_ENTRY       *Entry;
   LIST_ENTRY       *NextEntry;
   MNP_TX_BUF_WRAP  *TxBufWrap;
+  MNP_RXDATA_WRAP  *RxDataWrap;
 
   NET_CHECK_SIGNATURE (MnpDeviceData, MNP_DEVICE_DATA_SIGNATURE);
 
@@ -653,6 +660,18 @@ MnpDestroyDeviceData (
   ASSERT (IsListEmpty (&MnpDeviceData->AllTxBufList));
   ASSERT (MnpDeviceData->TxBufCount == 0);
 
+  //
+  // Free the cached rx data wraps.
+  //
+  NET_LIST_FOR_EACH_SAFE (Entry, NextEntry, &MnpDeviceData->FreeRxDataWrapList) {
+    RxDataWrap = NET_LIST_USER_STRUCT (Entry, MNP_RXDATA_WRAP, WrapEntry);
+    RemoveEntryList (Entry);
+    gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
+    FreePool (RxDataWrap);
+    MnpDeviceData->FreeRxDataWrapCount--;
+  }
+  ASSERT (MnpDeviceData->FreeRxDataWrapCount == 0);
+
   //
   // Free the RxNbufCache.
   //
@@ -1273,6 +1292,7 @@ MnpStart (
     }
 
     MnpDeviceData->EnableSystemPoll = EnableSystemPoll;
+    MnpDeviceData->PollInterval     = MNP_SYS_POLL_INTERVAL;
   }
 
   //
@@ -69,6 +69,7 @@ typedef struct {
 
   EFI_EVENT                      PollTimer;
   BOOLEAN                        EnableSystemPoll;
+  UINT64                         PollInterval;
 
   EFI_EVENT                      TimeoutCheckTimer;
   EFI_EVENT                      MediaDetectTimer;
@@ -85,6 +86,12 @@ typedef struct {
   UINT32                         BufferLength;
   UINT32                         PaddingSize;
   NET_BUF                        *RxNbufCache;
+
+  //
+  // List of MNP_RXDATA_WRAP, with their recycle event, kept for reuse.
+  //
+  LIST_ENTRY                     FreeRxDataWrapList;
+  UINT32                         FreeRxDataWrapCount;
 } MNP_DEVICE_DATA;
 
 #define MNP_DEVICE_DATA_FROM_THIS(a) \
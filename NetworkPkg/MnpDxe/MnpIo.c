@@ -428,13 +428,20 @@ MnpRecycleRxData (
 {
   MNP_RXDATA_WRAP  *RxDataWrap;
   MNP_DEVICE_DATA  *MnpDeviceData;
+  EFI_TPL          OldTpl;
 
   ASSERT (Context != NULL);
 
   RxDataWrap = (MNP_RXDATA_WRAP *)Context;
-  NET_CHECK_SIGNATURE (RxDataWrap->Instance, MNP_INSTANCE_DATA_SIGNATURE);
-
   ASSERT (RxDataWrap->Nbuf != NULL);
+  if (RxDataWrap->Nbuf == NULL) {
+    //
+    // The recycle event of a free wrap has been signaled again.
+    //
+    return;
+  }
+
+  NET_CHECK_SIGNATURE (RxDataWrap->Instance, MNP_INSTANCE_DATA_SIGNATURE);
 
   MnpDeviceData = RxDataWrap->Instance->MnpServiceData->MnpDeviceData;
   NET_CHECK_SIGNATURE (MnpDeviceData, MNP_DEVICE_DATA_SIGNATURE);
@@ -445,17 +452,31 @@ MnpRecycleRxData (
   MnpFreeNbuf (MnpDeviceData, RxDataWrap->Nbuf);
   RxDataWrap->Nbuf = NULL;
 
-  //
-  // Close the recycle event.
-  //
-  gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
 
   //
   // Remove this Wrap entry from the list.
   //
   RemoveEntryList (&RxDataWrap->WrapEntry);
 
-  FreePool (RxDataWrap);
+  if (MnpDeviceData->FreeRxDataWrapCount < MNP_MAX_FREE_RXDATA_WRAP_NUM) {
+    //
+    // Keep the Wrap and its recycle event for the next received packet.
+    //
+    InsertHeadList (&MnpDeviceData->FreeRxDataWrapList, &RxDataWrap->WrapEntry);
+    MnpDeviceData->FreeRxDataWrapCount++;
+    RxDataWrap = NULL;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  if (RxDataWrap != NULL) {
+    //
+    // Close the recycle event.
+    //
+    gBS->CloseEvent (RxDataWrap->RxData.RecycleEvent);
+    FreePool (RxDataWrap);
+  }
 }
 
 /**
@@ -690,6 +711,9 @@ MnpAnalysePacket (
 /**
   Wrap the RxData.
 
+  A MNP_RXDATA_WRAP recycled earlier is reused with its recycle event if there
+  is one, otherwise a new one is allocated.
+
   @param[in]  Instance           Pointer to the mnp instance context data.
   @param[in]  RxData             Pointer to the receive data to wrap.
 
@@ -703,15 +727,51 @@ MnpWrapRxData (
   )
 {
   EFI_STATUS       Status;
+  MNP_DEVICE_DATA  *MnpDeviceData;
   MNP_RXDATA_WRAP  *RxDataWrap;
+  EFI_EVENT        RecycleEvent;
+  EFI_TPL          OldTpl;
 
-  //
-  // Allocate memory.
-  //
-  RxDataWrap = AllocatePool (sizeof (MNP_RXDATA_WRAP));
-  if (RxDataWrap == NULL) {
-    DEBUG ((DEBUG_ERROR, "MnpDispatchPacket: Failed to allocate a MNP_RXDATA_WRAP.\n"));
-    return NULL;
+  MnpDeviceData = Instance->MnpServiceData->MnpDeviceData;
+  RxDataWrap    = NULL;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  if (!IsListEmpty (&MnpDeviceData->FreeRxDataWrapList)) {
+    RxDataWrap = NET_LIST_HEAD (&MnpDeviceData->FreeRxDataWrapList, MNP_RXDATA_WRAP, WrapEntry);
+    RemoveEntryList (&RxDataWrap->WrapEntry);
+    MnpDeviceData->FreeRxDataWrapCount--;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  if (RxDataWrap != NULL) {
+    RecycleEvent = RxDataWrap->RxData.RecycleEvent;
+  } else {
+    //
+    // Allocate memory.
+    //
+    RxDataWrap = AllocatePool (sizeof (MNP_RXDATA_WRAP));
+    if (RxDataWrap == NULL) {
+      DEBUG ((DEBUG_ERROR, "MnpDispatchPacket: Failed to allocate a MNP_RXDATA_WRAP.\n"));
+      return NULL;
+    }
+
+    //
+    // Create the recycle event.
+    //
+    Status = gBS->CreateEvent (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_NOTIFY,
+                    MnpRecycleRxData,
+                    RxDataWrap,
+                    &RecycleEvent
+                    );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "MnpDispatchPacket: gBS->CreateEvent failed, %r.\n", Status));
+
+      FreePool (RxDataWrap);
+      return NULL;
+    }
   }
 
   RxDataWrap->Instance = Instance;
@@ -720,23 +780,7 @@ MnpWrapRxData (
   // Fill the RxData in RxDataWrap,
   //
   CopyMem (&RxDataWrap->RxData, RxData, sizeof (RxDataWrap->RxData));
-
-  //
-  // Create the recycle event.
-  //
-  Status = gBS->CreateEvent (
-                  EVT_NOTIFY_SIGNAL,
-                  TPL_NOTIFY,
-                  MnpRecycleRxData,
-                  RxDataWrap,
-                  &RxDataWrap->RxData.RecycleEvent
-                  );
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "MnpDispatchPacket: gBS->CreateEvent failed, %r.\n", Status));
-
-    FreePool (RxDataWrap);
-    return NULL;
-  }
+  RxDataWrap->RxData.RecycleEvent = RecycleEvent;
 
   return RxDataWrap;
 }
@@ -985,6 +1029,39 @@ EXIT:
   return Status;
 }
 
+/**
+  Receive and deliver the packets pending in SNP, up to MNP_RX_BATCH_SIZE.
+
+  @param[in, out]  MnpDeviceData        Pointer to the mnp device context data.
+  @param[out]      Received             The number of packets received.
+
+  @retval EFI_SUCCESS           At least one packet has been received.
+  @retval Others                The error returned by MnpReceivePacket() for
+                                the first packet.
+
+**/
+EFI_STATUS
+MnpReceivePackets (
+  IN OUT MNP_DEVICE_DATA  *MnpDeviceData,
+  OUT    UINTN            *Received
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Count;
+
+  Status = EFI_SUCCESS;
+  for (Count = 0; Count < MNP_RX_BATCH_SIZE; Count++) {
+    Status = MnpReceivePacket (MnpDeviceData);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  *Received = Count;
+
+  return (Count != 0) ? EFI_SUCCESS : Status;
+}
+
 /**
   Remove the received packets if timeout occurs.
 
@@ -1099,6 +1176,8 @@ MnpSystemPoll (
   )
 {
   MNP_DEVICE_DATA  *MnpDeviceData;
+  UINTN            Received;
+  UINT64           PollInterval;
 
   MnpDeviceData = (MNP_DEVICE_DATA *)Context;
   NET_CHECK_SIGNATURE (MnpDeviceData, MNP_DEVICE_DATA_SIGNATURE);
@@ -1106,10 +1185,35 @@ MnpSystemPoll (
   //
   // Try to receive packets from Snp.
   //
-  MnpReceivePacket (MnpDeviceData);
+  MnpReceivePackets (MnpDeviceData, &Received);
 
   //
   // Dispatch the DPC queued by the NotifyFunction of rx token's events.
   //
   DispatchDpc ();
+
+  if ((Event == NULL) || !MnpDeviceData->EnableSystemPoll) {
+    return;
+  }
+
+  //
+  // Poll on every timer tick while the batches are full, and go back to the
+  // default interval once no packet is received. A periodic timer is not
+  // signaled more often than the platform timer tick, which is often 10
+  // milliseconds, so a shorter fixed interval would not poll any faster.
+  // With such a tick the receive rate only gains from the batches.
+  //
+  if (Received == MNP_RX_BATCH_SIZE) {
+    PollInterval = MNP_SYS_POLL_INTERVAL_MIN;
+  } else if (Received == 0) {
+    PollInterval = MNP_SYS_POLL_INTERVAL;
+  } else {
+    PollInterval = MnpDeviceData->PollInterval;
+  }
+
+  if (PollInterval != MnpDeviceData->PollInterval) {
+    if (!EFI_ERROR (gBS->SetTimer (MnpDeviceData->PollTimer, TimerPeriodic, PollInterval))) {
+      MnpDeviceData->PollInterval = PollInterval;
+    }
+  }
 }
@@ -0,0 +1,330 @@
+/** @file
+  Tests for the windowed download in Mtftp4Rrq.c.
+
+  The tests feed DATA packets to Mtftp4RrqHandleData () as a server using the
+  windowsize option (RFC 7440) would send them, and check the ACKs the client
+  sends back.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <gtest/gtest.h>
+#include <vector>
+
+extern "C" {
+  #include <Uefi.h>
+  #include <Library/BaseLib.h>
+  #include <Library/BaseMemoryLib.h>
+  #include <Library/DebugLib.h>
+  #include "Mtftp4RrqGoogleTest.h"
+}
+
+////////////////////////////////////////////////////////////////////////
+// Defines
+////////////////////////////////////////////////////////////////////////
+
+#define TEST_BLKSIZE     512
+#define TEST_WINDOWSIZE  4
+#define TEST_TIMEOUT     3
+#define TEST_BLOCKS      10
+
+////////////////////////////////////////////////////////////////////////
+// Symbol Definitions
+// These functions are not directly under test - but required to compile
+////////////////////////////////////////////////////////////////////////
+
+//
+// The block numbers of the ACKs sent by the client.
+//
+static std::vector<UINT16>  mAcks;
+
+extern "C" {
+  EFI_STATUS
+  EFIAPI
+  UdpIoSendDatagram (
+    IN  UDP_IO           *UdpIo,
+    IN  NET_BUF          *Packet,
+    IN  UDP_END_POINT    *EndPoint OPTIONAL,
+    IN  EFI_IP_ADDRESS   *Gateway  OPTIONAL,
+    IN  UDP_IO_CALLBACK  CallBack,
+    IN  VOID             *Context
+    )
+  {
+    EFI_MTFTP4_ACK_HEADER  Ack;
+
+    if ((Packet->TotalSize == sizeof (Ack)) &&
+        (NetbufCopy (Packet, 0, sizeof (Ack), (UINT8 *)&Ack) == sizeof (Ack)) &&
+        (NTOHS (Ack.OpCode) == EFI_MTFTP4_OPCODE_ACK))
+    {
+      mAcks.push_back (NTOHS (Ack.Block[0]));
+    }
+
+    CallBack (Packet, EndPoint, EFI_SUCCESS, Context);
+    return EFI_SUCCESS;
+  }
+
+  EFI_STATUS
+  EFIAPI
+  UdpIoRecvDatagram (
+    IN  UDP_IO           *UdpIo,
+    IN  UDP_IO_CALLBACK  CallBack,
+    IN  VOID             *Context,
+    IN  UINT32           HeadLen
+    )
+  {
+    return EFI_SUCCESS;
+  }
+
+  UDP_IO *
+  EFIAPI
+  UdpIoCreateIo (
+    IN  EFI_HANDLE           Controller,
+    IN  EFI_HANDLE           ImageHandle,
+    IN  UDP_IO_CONFIG        Configure,
+    IN  UINT8                UdpVersion,
+    IN  VOID                 *Context
+    )
+  {
+    return NULL;
+  }
+
+  EFI_STATUS
+  EFIAPI
+  UdpIoFreeIo (
+    IN  UDP_IO  *UdpIo
+    )
+  {
+    return EFI_SUCCESS;
+  }
+
+  VOID
+  Mtftp4CleanOperation (
+    IN OUT MTFTP4_PROTOCOL  *Instance,
+    IN     EFI_STATUS       Result
+    )
+  {
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+// Mtftp4RrqHandleData Tests
+////////////////////////////////////////////////////////////////////////
+
+class Mtftp4RrqTest : public ::testing::Test {
+protected:
+  MTFTP4_SERVICE Service;
+  MTFTP4_PROTOCOL Instance;
+  EFI_MTFTP4_TOKEN Token;
+  UINT8 File[TEST_BLOCKS * TEST_BLKSIZE];
+  UINT8 Buffer[TEST_BLOCKS * TEST_BLKSIZE];
+  UINT8 Packet[MTFTP4_DATA_HEAD_LEN + TEST_BLKSIZE];
+
+  //
+  // A download whose OACK negotiated the window size has been acknowledged.
+  //
+  virtual void
+  SetUp (
+    )
+  {
+    UINTN  Index;
+
+    ZeroMem (&Service, sizeof (Service));
+    ZeroMem (&Instance, sizeof (Instance));
+    ZeroMem (&Token, sizeof (Token));
+    ZeroMem (Buffer, sizeof (Buffer));
+    for (Index = 0; Index < sizeof (File); Index++) {
+      File[Index] = (UINT8)(Index * 7 + Index / TEST_BLKSIZE);
+    }
+
+    InitializeListHead (&Service.Children);
+    InitializeListHead (&Instance.Blocks);
+    InsertTailList (&Service.Children, &Instance.Link);
+
+    Token.Buffer     = Buffer;
+    Token.BufferSize = sizeof (Buffer);
+
+    Instance.Token      = &Token;
+    Instance.Operation  = EFI_MTFTP4_OPCODE_RRQ;
+    Instance.Master     = TRUE;
+    Instance.BlkSize    = TEST_BLKSIZE;
+    Instance.WindowSize = TEST_WINDOWSIZE;
+    Instance.Timeout    = TEST_TIMEOUT;
+    Instance.MaxRetry   = 5;
+    ASSERT_EQ (Mtftp4InitBlockRange (&Instance.Blocks, 1, 0xffff), EFI_SUCCESS);
+    ASSERT_EQ (Mtftp4RrqSendAck (&Instance, 0), EFI_SUCCESS);
+    mAcks.clear ();
+  }
+
+  virtual void
+  TearDown (
+    )
+  {
+    LIST_ENTRY  *Entry;
+
+    while (!IsListEmpty (&Instance.Blocks)) {
+      Entry = Instance.Blocks.ForwardLink;
+      RemoveEntryList (Entry);
+      FreePool (NET_LIST_USER_STRUCT (Entry, MTFTP4_BLOCK_RANGE, Link));
+    }
+
+    if (Instance.LastPacket != NULL) {
+      NetbufFree (Instance.LastPacket);
+    }
+  }
+
+  //
+  // Receive the DATA packet of a block of File. The last block is short.
+  //
+  BOOLEAN
+  Receive (
+    UINT16  Block
+    )
+  {
+    EFI_MTFTP4_PACKET  *Data;
+    UINT32             DataLen;
+    BOOLEAN            Completed;
+
+    DataLen = (Block == TEST_BLOCKS) ? TEST_BLKSIZE / 2 : TEST_BLKSIZE;
+    Data    = (EFI_MTFTP4_PACKET *)Packet;
+    Data->Data.OpCode = HTONS (EFI_MTFTP4_OPCODE_DATA);
+    Data->Data.Block  = HTONS (Block);
+    CopyMem (Data->Data.Data, File + (Block - 1) * TEST_BLKSIZE, DataLen);
+
+    Completed = FALSE;
+    EXPECT_EQ (Mtftp4RrqHandleData (&Instance, Data, MTFTP4_DATA_HEAD_LEN + DataLen, FALSE, &Completed), EFI_SUCCESS);
+    return Completed;
+  }
+
+  //
+  // Receive a sequence of blocks.
+  //
+  void
+  Receive (
+    std::initializer_list<UINT16>  Blocks
+    )
+  {
+    for (UINT16 Block : Blocks) {
+      EXPECT_FALSE (Receive (Block));
+    }
+  }
+
+  //
+  // Let the timer tick until the session times out.
+  //
+  void
+  TimeOut (
+    )
+  {
+    UINTN  Ticks;
+
+    for (Ticks = 0; Ticks < TEST_TIMEOUT && !Instance.HasTimeout; Ticks++) {
+      Mtftp4OnTimerTickNotifyLevel (NULL, &Service);
+    }
+
+    ASSERT_TRUE (Instance.HasTimeout);
+    Mtftp4OnTimerTick (NULL, &Service);
+  }
+
+  //
+  // Check the ACKs sent since the last check.
+  //
+  void
+  ExpectAcks (
+    std::initializer_list<UINT16>  Blocks
+    )
+  {
+    EXPECT_EQ (mAcks, std::vector<UINT16>(Blocks));
+    mAcks.clear ();
+  }
+
+  //
+  // Receive the rest of the file in order from Block, then check it.
+  //
+  void
+  ExpectDownloadCompletes (
+    UINT16  Block
+    )
+  {
+    for ( ; Block < TEST_BLOCKS; Block++) {
+      EXPECT_FALSE (Receive (Block));
+    }
+
+    EXPECT_TRUE (Receive (TEST_BLOCKS));
+    ASSERT_FALSE (mAcks.empty ());
+    EXPECT_EQ (mAcks.back (), TEST_BLOCKS);
+    EXPECT_EQ (Token.BufferSize, (TEST_BLOCKS - 1) * TEST_BLKSIZE + TEST_BLKSIZE / 2);
+    EXPECT_EQ (CompareMem (Buffer, File, (UINTN)Token.BufferSize), 0);
+  }
+};
+
+// Test Description:
+// Blocks received in order are acknowledged once per window, and the last
+// block is acknowledged at once.
+TEST_F (Mtftp4RrqTest, InOrderShouldAckEachWindow) {
+  Receive ({ 1, 2, 3 });
+  ExpectAcks ({ });
+  Receive ({ 4 });
+  ExpectAcks ({ 4 });
+  Receive ({ 5, 6, 7, 8, 9 });
+  ExpectAcks ({ 8 });
+  ExpectDownloadCompletes (10);
+  ExpectAcks ({ 10 });
+}
+
+// Test Description:
+// After a lost block, only the first block of the rest of the window is
+// acknowledged, with the block before the gap. The server restarts the
+// window there. A loss in a later window is acknowledged again.
+TEST_F (Mtftp4RrqTest, LostBlockShouldAckGapOnce) {
+  Receive ({ 1, 3 });
+  ExpectAcks ({ 1 });
+  Receive ({ 4 });
+  ExpectAcks ({ });
+
+  Receive ({ 2, 3, 4 });
+  ExpectAcks ({ });
+  Receive ({ 5 });
+  ExpectAcks ({ 5 });
+
+  Receive ({ 6, 8 });
+  ExpectAcks ({ 6 });
+  ExpectDownloadCompletes (7);
+}
+
+// Test Description:
+// When the ACK of a gap is lost, the server times out and resends its
+// window. The block already received is not acknowledged again, and the
+// timeout acknowledges the blocks received in order since the gap ACK.
+TEST_F (Mtftp4RrqTest, LostGapAckShouldRecoverOnTimeout) {
+  Receive ({ 1, 3, 4 });
+  ExpectAcks ({ 1 });
+
+  Receive ({ 1, 2, 3, 4 });
+  ExpectAcks ({ });
+  TimeOut ();
+  ExpectAcks ({ 4 });
+
+  Receive ({ 5, 6, 7, 8 });
+  ExpectAcks ({ 8 });
+  ExpectDownloadCompletes (9);
+}
+
+// Test Description:
+// Each block restarts the timer. A timeout in the middle of a window
+// acknowledges the last block received in order, so that the server does
+// not resend the blocks before it. A timeout with no new block retransmits
+// the last ACK.
+TEST_F (Mtftp4RrqTest, TimeoutMidWindowShouldAckLastBlock) {
+  Receive ({ 1 });
+  Mtftp4OnTimerTickNotifyLevel (NULL, &Service);
+  Receive ({ 2 });
+  EXPECT_EQ (Instance.PacketToLive, (UINT32)TEST_TIMEOUT);
+  TimeOut ();
+  ExpectAcks ({ 2 });
+  TimeOut ();
+  ExpectAcks ({ 2 });
+
+  Receive ({ 3, 4, 5, 6 });
+  ExpectAcks ({ 6 });
+  ExpectDownloadCompletes (7);
+}
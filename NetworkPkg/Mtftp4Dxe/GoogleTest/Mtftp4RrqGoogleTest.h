@@ -0,0 +1,60 @@
+/** @file
+  This file exposes the internal interfaces which may be unit tested
+  for the Mtftp4Dxe driver.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef MTFTP4_RRQ_GOOGLE_TEST_H_
+#define MTFTP4_RRQ_GOOGLE_TEST_H_
+
+//
+// Minimal includes needed to compile
+//
+#include <Uefi.h>
+#include "../Mtftp4Impl.h"
+
+/**
+  Build and send a ACK packet for the download session.
+
+  @param  Instance              The Mtftp session
+  @param  BlkNo                 The BlkNo to ack.
+
+  @retval EFI_OUT_OF_RESOURCES  Failed to allocate memory for the packet
+  @retval EFI_SUCCESS           The ACK has been sent
+  @retval Others                Failed to send the ACK.
+
+**/
+EFI_STATUS
+Mtftp4RrqSendAck (
+  IN MTFTP4_PROTOCOL  *Instance,
+  IN UINT16           BlkNo
+  );
+
+/**
+  Function to process the received data packets.
+
+  It will save the block then send back an ACK if it is active.
+
+  @param  Instance              The downloading MTFTP session
+  @param  Packet                The packet received
+  @param  Len                   The length of the packet
+  @param  Multicast             Whether this packet is multicast or unicast
+  @param  Completed             Return whether the download has completed
+
+  @retval EFI_SUCCESS           The data packet is successfully processed
+  @retval EFI_ABORTED           The download is aborted by the user
+  @retval EFI_BUFFER_TOO_SMALL  The user provided buffer is too small
+
+**/
+EFI_STATUS
+Mtftp4RrqHandleData (
+  IN     MTFTP4_PROTOCOL    *Instance,
+  IN     EFI_MTFTP4_PACKET  *Packet,
+  IN     UINT32             Len,
+  IN     BOOLEAN            Multicast,
+  OUT BOOLEAN               *Completed
+  );
+
+#endif // MTFTP4_RRQ_GOOGLE_TEST_H_
@@ -126,6 +126,12 @@ struct _MTFTP4_PROTOCOL {
   //
   UINT64                    AckedBlock;
 
+  //
+  // Whether the block before a lost one has been acknowledged, see
+  // Mtftp4RrqHandleData.
+  //
+  BOOLEAN                   GapAcked;
+
   //
   // The server's communication end point: IP and two ports. one for
   // initial request, one for its selected port.
@@ -214,6 +220,22 @@ Mtftp4RrqStart (
   IN UINT16           Operation
   );
 
+/**
+  Acknowledge the blocks received since the last ACK when the download
+  session times out in the middle of a window.
+
+  @param  Instance              The Mtftp session
+
+  @retval EFI_SUCCESS           The ACK has been sent.
+  @retval EFI_NOT_FOUND         No block was received since the last ACK.
+  @retval Others                Failed to send the ACK.
+
+**/
+EFI_STATUS
+Mtftp4RrqAckOnTimeout (
+  IN MTFTP4_PROTOCOL  *Instance
+  );
+
 #define MTFTP4_SERVICE_FROM_THIS(a)   \
   CR (a, MTFTP4_SERVICE, ServiceBinding, MTFTP4_SERVICE_SIGNATURE)
 
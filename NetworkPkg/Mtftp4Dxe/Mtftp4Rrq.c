@@ -264,6 +264,19 @@ Mtftp4RrqHandleData (
   // expected one. If we are passive (Slave), save the block.
   //
   if (Instance->Master && (Expected != BlockNum)) {
+    //
+    // After a block of the window is lost the server still sends the rest
+    // of the window. Only the first of these blocks is acknowledged, the
+    // server then restarts the window after the ACKed block (RFC 7440).
+    // ACKing every following one would make it restart the window again
+    // for each of them.
+    //
+    if ((Instance->WindowSize > 1) && Instance->GapAcked) {
+      return EFI_SUCCESS;
+    }
+
+    Instance->GapAcked = TRUE;
+
     //
     // If Expected is 0, (UINT16) (Expected - 1) is also the expected Ack number (65535).
     //
@@ -280,14 +293,14 @@ Mtftp4RrqHandleData (
   // Record the total received and saved block number.
   //
   Instance->TotalBlock++;
+  Instance->GapAcked = FALSE;
 
   //
-  // Reset the passive client's timer whenever it received a
-  // valid data packet.
+  // Reset the timer whenever a valid data packet is received. For the
+  // active client, this keeps the timer from expiring while the rest of
+  // the window is still arriving.
   //
-  if (!Instance->Master) {
-    Mtftp4SetTimeout (Instance);
-  }
+  Mtftp4SetTimeout (Instance);
 
   //
   // Check whether we have received all the blocks. Send the ACK if we
@@ -319,6 +332,45 @@ Mtftp4RrqHandleData (
   return Status;
 }
 
+/**
+  Acknowledge the blocks received since the last ACK when the download
+  session times out in the middle of a window.
+
+  RFC 7440 requires the receiver to acknowledge the last block received in
+  order on timeout. The server then only resends the blocks after it, where
+  retransmitting the previous ACK would make it resend the whole window.
+
+  @param  Instance              The Mtftp session
+
+  @retval EFI_SUCCESS           The ACK has been sent.
+  @retval EFI_NOT_FOUND         No block was received since the last ACK.
+  @retval Others                Failed to send the ACK.
+
+**/
+EFI_STATUS
+Mtftp4RrqAckOnTimeout (
+  IN MTFTP4_PROTOCOL  *Instance
+  )
+{
+  INTN  Expected;
+
+  if (((Instance->Operation != EFI_MTFTP4_OPCODE_RRQ) &&
+       (Instance->Operation != EFI_MTFTP4_OPCODE_DIR)) ||
+      !Instance->Master ||
+      (Instance->TotalBlock == Instance->AckedBlock))
+  {
+    return EFI_NOT_FOUND;
+  }
+
+  Expected = Mtftp4GetNextBlockNum (&Instance->Blocks);
+
+  if (Expected < 0) {
+    return EFI_NOT_FOUND;
+  }
+
+  return Mtftp4RrqSendAck (Instance, (UINT16)(Expected - 1));
+}
+
 /**
   Validate whether the options received in the server's OACK packet is valid.
 
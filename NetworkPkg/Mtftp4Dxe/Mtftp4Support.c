@@ -637,10 +637,14 @@ Mtftp4OnTimerTick (
 
     //
     // Retransmit the packet if haven't reach the maximum retry count,
-    // otherwise exit the transfer.
+    // otherwise exit the transfer. A download that received part of a
+    // window acknowledges that part instead.
     //
     if (++Instance->CurRetry < Instance->MaxRetry) {
-      Mtftp4Retransmit (Instance);
+      if (EFI_ERROR (Mtftp4RrqAckOnTimeout (Instance))) {
+        Mtftp4Retransmit (Instance);
+      }
+
       Mtftp4SetTimeout (Instance);
     } else {
       Mtftp4CleanOperation (Instance, EFI_TIMEOUT);
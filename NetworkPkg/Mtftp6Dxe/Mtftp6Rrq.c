@@ -52,8 +52,13 @@ Mtftp6RrqSendAck (
   Ack->Ack.Block[0] = HTONS (BlockNum);
 
   //
-  // Reset current retry count of the instance.
+  // Save the packet buf for retransmit, and reset current retry count of
+  // the instance.
   //
+  if (Instance->LastPacket != NULL) {
+    NetbufFree (Instance->LastPacket);
+  }
+
   Instance->CurRetry   = 0;
   Instance->LastPacket = Packet;
 
@@ -241,6 +246,19 @@ Mtftp6RrqHandleData (
     NetbufFree (*UdpPacket);
     *UdpPacket = NULL;
 
+    //
+    // After a block of the window is lost the server still sends the rest
+    // of the window. Only the first of these blocks is acknowledged, the
+    // server then restarts the window after the ACKed block (RFC 7440).
+    // ACKing every following one would make it restart the window again
+    // for each of them.
+    //
+    if ((Instance->WindowSize > 1) && Instance->GapAcked) {
+      return EFI_SUCCESS;
+    }
+
+    Instance->GapAcked = TRUE;
+
     //
     // If Expected is 0, (UINT16) (Expected - 1) is also the expected Ack number (65535).
     //
@@ -257,13 +275,14 @@ Mtftp6RrqHandleData (
   // Record the total received and saved block number.
   //
   Instance->TotalBlock++;
+  Instance->GapAcked = FALSE;
 
   //
-  // Reset the passive client's timer whenever it received a valid data packet.
+  // Reset the timer whenever a valid data packet is received. For the
+  // active client, this keeps the timer from expiring while the rest of
+  // the window is still arriving.
   //
-  if (!Instance->IsMaster) {
-    Instance->PacketToLive = Instance->Timeout * 2;
-  }
+  Instance->PacketToLive = Instance->IsMaster ? Instance->Timeout : (Instance->Timeout * 2);
 
   //
   // Check whether we have received all the blocks. Send the ACK if we
@@ -302,6 +321,45 @@ Mtftp6RrqHandleData (
   return Status;
 }
 
+/**
+  Acknowledge the blocks received since the last ACK when the download
+  times out in the middle of a window.
+
+  RFC 7440 requires the receiver to acknowledge the last block received in
+  order on timeout. The server then only resends the blocks after it, where
+  retransmitting the previous ACK would make it resend the whole window.
+
+  @param[in]  Instance              The pointer to the Mtftp6 instance.
+
+  @retval EFI_SUCCESS           The ACK was sent.
+  @retval EFI_NOT_FOUND         No block was received since the last ACK.
+  @retval Others                Failed to send the ACK.
+
+**/
+EFI_STATUS
+Mtftp6RrqAckOnTimeout (
+  IN MTFTP6_INSTANCE  *Instance
+  )
+{
+  INTN  Expected;
+
+  if (((Instance->Operation != EFI_MTFTP6_OPCODE_RRQ) &&
+       (Instance->Operation != EFI_MTFTP6_OPCODE_DIR)) ||
+      !Instance->IsMaster ||
+      (Instance->TotalBlock == Instance->AckedBlock))
+  {
+    return EFI_NOT_FOUND;
+  }
+
+  Expected = Mtftp6GetNextBlockNum (&Instance->BlkList);
+
+  if (Expected < 0) {
+    return EFI_NOT_FOUND;
+  }
+
+  return Mtftp6RrqSendAck (Instance, (UINT16)(Expected - 1));
+}
+
 /**
   Validate whether the options received in the server's OACK packet is valid.
   The options are valid only if:
@@ -337,7 +395,7 @@ Mtftp6RrqOackValid (
   // return the timeout matches that requested.
   //
   if ((((ReplyInfo->BitMap & MTFTP6_OPT_BLKSIZE_BIT) != 0) && (ReplyInfo->BlkSize > RequestInfo->BlkSize)) ||
-      (((ReplyInfo->BitMap & MTFTP6_OPT_WINDOWSIZE_BIT) != 0) && (ReplyInfo->BlkSize > RequestInfo->BlkSize)) ||
+      (((ReplyInfo->BitMap & MTFTP6_OPT_WINDOWSIZE_BIT) != 0) && (ReplyInfo->WindowSize > RequestInfo->WindowSize)) ||
       (((ReplyInfo->BitMap & MTFTP6_OPT_TIMEOUT_BIT) != 0) && (ReplyInfo->Timeout != RequestInfo->Timeout))
       )
   {
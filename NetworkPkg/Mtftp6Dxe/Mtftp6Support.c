@@ -958,6 +958,7 @@ Mtftp6OperationClean (
   Instance->WindowSize     = 1;
   Instance->TotalBlock     = 0;
   Instance->AckedBlock     = 0;
+  Instance->GapAcked       = FALSE;
   Instance->LastBlk        = 0;
   Instance->PacketToLive   = 0;
   Instance->MaxRetry       = 0;
@@ -1212,10 +1213,13 @@ Mtftp6OnTimerTick (
 
     //
     // Retransmit the packet if haven't reach the maximum retry count,
-    // otherwise exit the transfer.
+    // otherwise exit the transfer. A download that received part of a
+    // window acknowledges that part instead.
     //
     if (Instance->CurRetry < Instance->MaxRetry) {
-      Mtftp6TransmitPacket (Instance, Instance->LastPacket);
+      if (EFI_ERROR (Mtftp6RrqAckOnTimeout (Instance))) {
+        Mtftp6TransmitPacket (Instance, Instance->LastPacket);
+      }
     } else {
       Mtftp6OperationClean (Instance, EFI_TIMEOUT);
       continue;
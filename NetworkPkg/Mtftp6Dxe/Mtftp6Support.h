@@ -333,4 +333,20 @@ Mtftp6RrqStart (
   IN UINT16           Operation
   );
 
+/**
+  Acknowledge the blocks received since the last ACK when the download
+  times out in the middle of a window.
+
+  @param[in]  Instance              The pointer to the Mtftp6 instance.
+
+  @retval EFI_SUCCESS           The ACK was sent.
+  @retval EFI_NOT_FOUND         No block was received since the last ACK.
+  @retval Others                Failed to send the ACK.
+
+**/
+EFI_STATUS
+Mtftp6RrqAckOnTimeout (
+  IN MTFTP6_INSTANCE  *Instance
+  );
+
 #endif
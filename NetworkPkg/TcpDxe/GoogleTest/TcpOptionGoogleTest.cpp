@@ -0,0 +1,143 @@
+/** @file
+  Tests for TcpOption.c and TcpCongestion.c.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <gtest/gtest.h>
+
+extern "C" {
+  #include <Uefi.h>
+  #include <Library/BaseLib.h>
+  #include <Library/DebugLib.h>
+  #include "../TcpMain.h"
+}
+
+////////////////////////////////////////////////////////////////////////
+// Symbol Definitions
+// These symbols are not directly under test - but required to compile
+////////////////////////////////////////////////////////////////////////
+UINT32  mTcpTick = 1000;
+
+////////////////////////////////////////////////////////////////////////
+// TcpParseOption Tests
+////////////////////////////////////////////////////////////////////////
+
+class TcpParseOptionTest : public ::testing::Test {
+protected:
+  UINT8 Packet[sizeof (TCP_HEAD) + TCP_OPTION_MAX_LEN];
+  TCP_HEAD *Tcp;
+  TCP_OPTION Option;
+
+  virtual void
+  SetUp (
+    )
+  {
+    ZeroMem (Packet, sizeof (Packet));
+    ZeroMem (&Option, sizeof (Option));
+    Tcp = (TCP_HEAD *)Packet;
+  }
+
+  //
+  // Copy the options after the TCP header, they must be 4 bytes aligned.
+  //
+  void
+  SetOptions (
+    const UINT8  *Options,
+    UINT8        Len
+    )
+  {
+    ASSERT_EQ (Len % 4, 0);
+    CopyMem (Packet + sizeof (TCP_HEAD), Options, Len);
+    Tcp->HeadLen = (UINT8)((sizeof (TCP_HEAD) + Len) >> 2);
+  }
+};
+
+// Test Description:
+// The SACK permitted option of a SYN segment is recognized.
+TEST_F (TcpParseOptionTest, SackPermittedShouldBeParsed) {
+  UINT8  Options[] = {
+    TCP_OPTION_MSS,       TCP_OPTION_MSS_LEN,       0x05, 0xb4,
+    TCP_OPTION_NOP,       TCP_OPTION_NOP,
+    TCP_OPTION_SACK_PERM, TCP_OPTION_SACK_PERM_LEN
+  };
+
+  SetOptions (Options, sizeof (Options));
+
+  EXPECT_EQ (TcpParseOption (Tcp, &Option), 0);
+  EXPECT_TRUE (TCP_FLG_ON (Option.Flag, TCP_OPTION_RCVD_MSS));
+  EXPECT_TRUE (TCP_FLG_ON (Option.Flag, TCP_OPTION_RCVD_SACK_PERM));
+  EXPECT_EQ (Option.Mss, 1460);
+}
+
+// Test Description:
+// The blocks of a SACK option are returned in host byte order.
+TEST_F (TcpParseOptionTest, SackBlocksShouldBeParsed) {
+  UINT8  Options[] = {
+    TCP_OPTION_NOP,  TCP_OPTION_NOP,  TCP_OPTION_SACK, 2 + 2 * TCP_OPTION_SACK_BLOCK_LEN,
+    0x00,            0x00,            0x10,            0x00,
+    0x00,            0x00,            0x20,            0x00,
+    0x00,            0x00,            0x30,            0x00,
+    0x00,            0x00,            0x40,            0x00
+  };
+
+  SetOptions (Options, sizeof (Options));
+
+  EXPECT_EQ (TcpParseOption (Tcp, &Option), 0);
+  EXPECT_TRUE (TCP_FLG_ON (Option.Flag, TCP_OPTION_RCVD_SACK));
+  ASSERT_EQ (Option.SackNum, 2);
+  EXPECT_EQ (Option.SackBlock[0].Left, 0x1000U);
+  EXPECT_EQ (Option.SackBlock[0].Right, 0x2000U);
+  EXPECT_EQ (Option.SackBlock[1].Left, 0x3000U);
+  EXPECT_EQ (Option.SackBlock[1].Right, 0x4000U);
+}
+
+// Test Description:
+// A SACK option whose length isn't a multiple of the block length is rejected.
+TEST_F (TcpParseOptionTest, SackWithBadLengthShouldFail) {
+  UINT8  Options[] = {
+    TCP_OPTION_NOP,  TCP_OPTION_NOP,  TCP_OPTION_SACK, 2 + TCP_OPTION_SACK_BLOCK_LEN + 1,
+    0x00,            0x00,            0x10,            0x00,
+    0x00,            0x00,            0x20,            0x00,
+    0x00,            TCP_OPTION_EOP,  TCP_OPTION_EOP,  TCP_OPTION_EOP
+  };
+
+  SetOptions (Options, sizeof (Options));
+
+  EXPECT_EQ (TcpParseOption (Tcp, &Option), -1);
+}
+
+// Test Description:
+// A SACK option running past the end of the header is rejected.
+TEST_F (TcpParseOptionTest, TruncatedSackShouldFail) {
+  UINT8  Options[] = {
+    TCP_OPTION_NOP,  TCP_OPTION_NOP,  TCP_OPTION_SACK, 2 + 2 * TCP_OPTION_SACK_BLOCK_LEN,
+    0x00,            0x00,            0x10,            0x00,
+    0x00,            0x00,            0x20,            0x00
+  };
+
+  SetOptions (Options, sizeof (Options));
+
+  EXPECT_EQ (TcpParseOption (Tcp, &Option), -1);
+}
+
+////////////////////////////////////////////////////////////////////////
+// TcpCubeRoot Tests
+////////////////////////////////////////////////////////////////////////
+
+// Test Description:
+// The cube root is rounded down to an integer.
+TEST (TcpCubeRootTest, CubeRootShouldRoundDown) {
+  EXPECT_EQ (TcpCubeRoot (0), 0U);
+  EXPECT_EQ (TcpCubeRoot (1), 1U);
+  EXPECT_EQ (TcpCubeRoot (26), 2U);
+  EXPECT_EQ (TcpCubeRoot (27), 3U);
+  EXPECT_EQ (TcpCubeRoot (2500000000ULL), 1357U);
+  EXPECT_EQ (TcpCubeRoot (1000000000000000000ULL), 1000000U);
+}
+
+// Test Description:
+// The cube root of a value beyond (2^21 - 1)^3 saturates.
+TEST (TcpCubeRootTest, CubeRootShouldSaturate) {
+  EXPECT_EQ (TcpCubeRoot (MAX_UINT64), (1U << 21) - 1);
+}
@@ -0,0 +1,353 @@
+/** @file
+  Tests for the SACK scoreboard in TcpSack.c and the receive buffer
+  autotuning in TcpCongestion.c.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <gtest/gtest.h>
+
+extern "C" {
+  #include <Uefi.h>
+  #include <Library/BaseLib.h>
+  #include <Library/BaseMemoryLib.h>
+  #include <Library/DebugLib.h>
+  #include "../TcpMain.h"
+}
+
+////////////////////////////////////////////////////////////////////////
+// Symbol Definitions
+// These functions are not directly under test - but required to compile
+////////////////////////////////////////////////////////////////////////
+
+//
+// The sequence numbers passed to TcpRetransmit, and its return value.
+//
+static TCP_SEQNO  mRetransmitSeq[8];
+static UINTN      mRetransmitNum;
+static INTN       mRetransmitStatus;
+
+extern "C" {
+  INTN
+  TcpRetransmit (
+    IN TCP_CB     *Tcb,
+    IN TCP_SEQNO  Seq
+    )
+  {
+    if (mRetransmitNum < ARRAY_SIZE (mRetransmitSeq)) {
+      mRetransmitSeq[mRetransmitNum++] = Seq;
+    }
+
+    return mRetransmitStatus;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+// TcpSackUpdate and TcpSackRetransmit Tests
+////////////////////////////////////////////////////////////////////////
+
+class TcpSackTest : public ::testing::Test {
+protected:
+  TCP_CB Tcb;
+  TCP_OPTION Option;
+
+  virtual void
+  SetUp (
+    )
+  {
+    ZeroMem (&Tcb, sizeof (Tcb));
+    InitializeListHead (&Tcb.SndQue);
+    Tcb.SndUna = 1000;
+    Tcb.SndNxt = 100000;
+    Tcb.SndMss = 1000;
+
+    mRetransmitNum    = 0;
+    mRetransmitStatus = 0;
+  }
+
+  //
+  // Feed the scoreboard with an ACK carrying a SACK option.
+  //
+  void
+  Sack (
+    TCP_SEQNO                                          Ack,
+    std::initializer_list<std::pair<UINT32, UINT32> >  Blocks
+    )
+  {
+    ZeroMem (&Option, sizeof (Option));
+    for (const auto &Block : Blocks) {
+      Option.SackBlock[Option.SackNum].Left  = Block.first;
+      Option.SackBlock[Option.SackNum].Right = Block.second;
+      Option.SackNum++;
+    }
+
+    TcpSackUpdate (&Tcb, Ack, &Option);
+  }
+
+  //
+  // Check that the scoreboard holds exactly these ranges.
+  //
+  void
+  ExpectScoreboard (
+    std::initializer_list<std::pair<UINT32, UINT32> >  Blocks
+    )
+  {
+    UINTN  Index;
+
+    ASSERT_EQ (Tcb.SackBlockNum, Blocks.size ());
+    Index = 0;
+    for (const auto &Block : Blocks) {
+      EXPECT_EQ (Tcb.SackBlock[Index].Left, Block.first);
+      EXPECT_EQ (Tcb.SackBlock[Index].Right, Block.second);
+      Index++;
+    }
+  }
+};
+
+// Test Description:
+// Disjoint blocks are kept sorted, whatever order they are reported in.
+TEST_F (TcpSackTest, DisjointBlocksShouldBeSorted) {
+  Sack (1000, { { 5000, 6000 }, { 3000, 4000 } });
+  Sack (1000, { { 7000, 8000 } });
+  ExpectScoreboard ({ { 3000, 4000 }, { 5000, 6000 }, { 7000, 8000 } });
+}
+
+// Test Description:
+// Overlapping and adjoining blocks are merged into one range.
+TEST_F (TcpSackTest, OverlappingBlocksShouldMerge) {
+  Sack (1000, { { 3000, 4000 } });
+  Sack (1000, { { 3500, 4500 } });
+  ExpectScoreboard ({ { 3000, 4500 } });
+
+  Sack (1000, { { 4500, 5000 } });
+  ExpectScoreboard ({ { 3000, 5000 } });
+
+  Sack (1000, { { 2000, 3000 } });
+  ExpectScoreboard ({ { 2000, 5000 } });
+}
+
+// Test Description:
+// A block spanning several ranges merges all of them.
+TEST_F (TcpSackTest, BlockBridgingRangesShouldMergeThem) {
+  Sack (1000, { { 3000, 4000 }, { 5000, 6000 }, { 7000, 8000 }, { 9000, 10000 } });
+  Sack (1000, { { 3500, 7500 } });
+  ExpectScoreboard ({ { 3000, 8000 }, { 9000, 10000 } });
+}
+
+// Test Description:
+// A cumulative ACK drops the ranges below it and trims the range it splits.
+TEST_F (TcpSackTest, CumulativeAckShouldTrimRanges) {
+  Sack (1000, { { 3000, 4000 }, { 5000, 6000 }, { 7000, 8000 } });
+  Sack (5500, {});
+  ExpectScoreboard ({ { 5500, 6000 }, { 7000, 8000 } });
+
+  Sack (8000, {});
+  ExpectScoreboard ({});
+}
+
+// Test Description:
+// A block starting below the cumulative ACK only covers the data above it.
+TEST_F (TcpSackTest, BlockBelowAckShouldBeTrimmed) {
+  Sack (3000, { { 2000, 4000 } });
+  ExpectScoreboard ({ { 3000, 4000 } });
+}
+
+// Test Description:
+// Empty blocks, blocks for acknowledged data and blocks for data not sent
+// yet are ignored.
+TEST_F (TcpSackTest, InvalidBlocksShouldBeIgnored) {
+  Sack (3000, { { 5000, 5000 }, { 6000, 5000 }, { 1000, 2000 }, { 99000, 101000 } });
+  ExpectScoreboard ({});
+}
+
+// Test Description:
+// When the scoreboard is full, a lower range replaces the highest one and
+// a range above all of them is dropped.
+TEST_F (TcpSackTest, FullScoreboardShouldKeepLowestRanges) {
+  UINT32  Index;
+
+  for (Index = 0; Index < TCP_SACK_BLOCK_NUM; Index++) {
+    Sack (1000, { { 10000 + Index * 2000, 11000 + Index * 2000 } });
+  }
+
+  ASSERT_EQ (Tcb.SackBlockNum, TCP_SACK_BLOCK_NUM);
+
+  Sack (1000, { { 50000, 51000 } });
+  ASSERT_EQ (Tcb.SackBlockNum, TCP_SACK_BLOCK_NUM);
+  EXPECT_EQ (Tcb.SackBlock[TCP_SACK_BLOCK_NUM - 1].Left, 10000U + (TCP_SACK_BLOCK_NUM - 1) * 2000);
+
+  Sack (1000, { { 3000, 4000 } });
+  ASSERT_EQ (Tcb.SackBlockNum, TCP_SACK_BLOCK_NUM);
+  EXPECT_EQ (Tcb.SackBlock[0].Left, 3000U);
+  EXPECT_EQ (Tcb.SackBlock[1].Left, 10000U);
+  EXPECT_EQ (Tcb.SackBlock[TCP_SACK_BLOCK_NUM - 1].Left, 10000U + (TCP_SACK_BLOCK_NUM - 2) * 2000);
+}
+
+// Test Description:
+// The first hole starts at SndUna, and one MSS of it is retransmitted.
+TEST_F (TcpSackTest, RetransmitShouldStartAtSndUna) {
+  Sack (1000, { { 5000, 6000 } });
+
+  EXPECT_EQ (TcpSackRetransmit (&Tcb), 0);
+  ASSERT_EQ (mRetransmitNum, 1U);
+  EXPECT_EQ (mRetransmitSeq[0], 1000U);
+  EXPECT_EQ (Tcb.SackHighRxt, 2000U);
+}
+
+// Test Description:
+// The next retransmission continues after the data already retransmitted,
+// and skips the SACKed ranges.
+TEST_F (TcpSackTest, RetransmitShouldSkipSackedRanges) {
+  Sack (1000, { { 3000, 4000 }, { 6000, 7000 } });
+  Tcb.SackHighRxt = 3000;
+
+  EXPECT_EQ (TcpSackRetransmit (&Tcb), 0);
+  ASSERT_EQ (mRetransmitNum, 1U);
+  EXPECT_EQ (mRetransmitSeq[0], 4000U);
+  EXPECT_EQ (Tcb.SackHighRxt, 5000U);
+}
+
+// Test Description:
+// A retransmission doesn't run into the next SACKed range.
+TEST_F (TcpSackTest, RetransmitShouldStopAtNextRange) {
+  Sack (1000, { { 3000, 4000 }, { 4500, 5000 } });
+  Tcb.SackHighRxt = 4000;
+
+  EXPECT_EQ (TcpSackRetransmit (&Tcb), 0);
+  ASSERT_EQ (mRetransmitNum, 1U);
+  EXPECT_EQ (mRetransmitSeq[0], 4000U);
+  EXPECT_EQ (Tcb.SackHighRxt, 4500U);
+}
+
+// Test Description:
+// A retransmission doesn't cross the end of the queued segment it starts in.
+TEST_F (TcpSackTest, RetransmitShouldStopAtSegmentEnd) {
+  NET_BUF  Nbuf;
+  TCP_SEG  *Seg;
+
+  ZeroMem (&Nbuf, sizeof (Nbuf));
+  Seg      = TCPSEG_NETBUF (&Nbuf);
+  Seg->Seq = 1000;
+  Seg->End = 1300;
+  InsertTailList (&Tcb.SndQue, &Nbuf.List);
+
+  Sack (1000, { { 5000, 6000 } });
+
+  EXPECT_EQ (TcpSackRetransmit (&Tcb), 0);
+  ASSERT_EQ (mRetransmitNum, 1U);
+  EXPECT_EQ (mRetransmitSeq[0], 1000U);
+  EXPECT_EQ (Tcb.SackHighRxt, 1300U);
+}
+
+// Test Description:
+// Data above the highest SACKed range isn't retransmitted.
+TEST_F (TcpSackTest, NoHoleBelowHighestRangeShouldFail) {
+  Sack (1000, { { 3000, 4000 } });
+  Tcb.SackHighRxt = 3000;
+
+  EXPECT_EQ (TcpSackRetransmit (&Tcb), -1);
+  EXPECT_EQ (mRetransmitNum, 0U);
+  EXPECT_EQ (Tcb.SackHighRxt, 3000U);
+}
+
+// Test Description:
+// A failed retransmission leaves the retransmission point unchanged.
+TEST_F (TcpSackTest, FailedRetransmitShouldKeepHighRxt) {
+  Sack (1000, { { 3000, 4000 } });
+  mRetransmitStatus = -1;
+
+  EXPECT_EQ (TcpSackRetransmit (&Tcb), -1);
+  EXPECT_EQ (mRetransmitNum, 1U);
+  EXPECT_EQ (Tcb.SackHighRxt, 0U);
+}
+
+////////////////////////////////////////////////////////////////////////
+// TcpAutotuneRcvBuffer Tests
+////////////////////////////////////////////////////////////////////////
+
+class TcpAutotuneTest : public ::testing::Test {
+protected:
+  TCP_CB Tcb;
+  SOCKET Sock;
+  UINT32 SavedTick;
+
+  virtual void
+  SetUp (
+    )
+  {
+    SavedTick = mTcpTick;
+    ZeroMem (&Tcb, sizeof (Tcb));
+    ZeroMem (&Sock, sizeof (Sock));
+    Tcb.Sk = &Sock;
+    SET_RCV_BUFFSIZE (&Sock, TCP_RCV_BUF_SIZE);
+
+    //
+    // One tick of RTT, measured from tick 1000 at sequence 0.
+    //
+    Tcb.SRtt         = 1 << TCP_RTT_SHIFT;
+    Tcb.RcvSpaceSeq  = 0;
+    Tcb.RcvSpaceTick = 1000;
+    mTcpTick         = 1000;
+  }
+
+  virtual void
+  TearDown (
+    )
+  {
+    mTcpTick = SavedTick;
+  }
+};
+
+// Test Description:
+// Nothing is measured before one RTT has elapsed.
+TEST_F (TcpAutotuneTest, ShouldWaitForOneRtt) {
+  Tcb.SRtt   = 2 << TCP_RTT_SHIFT;
+  Tcb.RcvNxt = 8 * 1024 * 1024;
+  mTcpTick   = 1001;
+
+  TcpAutotuneRcvBuffer (&Tcb);
+  EXPECT_EQ (GET_RCV_BUFFSIZE (&Sock), (UINT32)TCP_RCV_BUF_SIZE);
+  EXPECT_EQ (Tcb.RcvSpaceSeq, 0U);
+  EXPECT_EQ (Tcb.RcvSpaceTick, 1000U);
+}
+
+// Test Description:
+// The buffer grows to twice the data received in one RTT, and the next
+// measurement starts.
+TEST_F (TcpAutotuneTest, ShouldGrowToTwiceTheRttData) {
+  Tcb.RcvNxt = 3 * 1024 * 1024;
+  mTcpTick   = 1001;
+
+  TcpAutotuneRcvBuffer (&Tcb);
+  EXPECT_EQ (GET_RCV_BUFFSIZE (&Sock), 6U * 1024 * 1024);
+  EXPECT_EQ (Tcb.RcvSpaceSeq, Tcb.RcvNxt);
+  EXPECT_EQ (Tcb.RcvSpaceTick, 1001U);
+}
+
+// Test Description:
+// The buffer never grows beyond TCP_RCV_BUF_SIZE_MAX, however fast the
+// data arrives.
+TEST_F (TcpAutotuneTest, GrowthShouldBeBounded) {
+  Tcb.RcvNxt = 0xF0000000;
+  mTcpTick   = 1001;
+
+  TcpAutotuneRcvBuffer (&Tcb);
+  EXPECT_EQ (GET_RCV_BUFFSIZE (&Sock), (UINT32)TCP_RCV_BUF_SIZE_MAX);
+
+  Tcb.RcvNxt += 0x0F000000;
+  mTcpTick    = 1002;
+
+  TcpAutotuneRcvBuffer (&Tcb);
+  EXPECT_EQ (GET_RCV_BUFFSIZE (&Sock), (UINT32)TCP_RCV_BUF_SIZE_MAX);
+}
+
+// Test Description:
+// The buffer doesn't shrink when less data arrives.
+TEST_F (TcpAutotuneTest, ShouldNotShrink) {
+  Tcb.RcvNxt = 64 * 1024;
+  mTcpTick   = 1004;
+
+  TcpAutotuneRcvBuffer (&Tcb);
+  EXPECT_EQ (GET_RCV_BUFFSIZE (&Sock), (UINT32)TCP_RCV_BUF_SIZE);
+  EXPECT_EQ (Tcb.RcvSpaceSeq, Tcb.RcvNxt);
+}
@@ -0,0 +1,251 @@
+/** @file
+  TCP congestion control and receive buffer autotuning. NewReno as
+  specified in RFC5681 and RFC6582 is used by default, CUBIC as specified
+  in RFC8312 can be selected with PcdTcpCongestionControl. The receive
+  buffer is autotuned if PcdTcpRcvBufferAutotune is TRUE.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TcpMain.h"
+
+//
+// CUBIC constants of RFC8312. The multiplicative decrease factor is
+// 0.7, and the constant C of the cubic function is 0.4, which makes
+// 1000^3 / C = 2.5e9 the cube of milliseconds per segment.
+//
+#define TCP_CUBIC_BETA_NUM     7
+#define TCP_CUBIC_BETA_DEN     10
+#define TCP_CUBIC_C_INVERSE    2500000000U
+#define TCP_CUBIC_TIME_MAX     0x100000     ///< Bound of |t - K| in milliseconds, keeps its cube in 64 bits.
+
+/**
+  Compute the integer cube root of a value.
+
+  @param[in]  Value   The value to compute the cube root of.
+
+  @return             The largest integer whose cube isn't greater than
+                      Value, saturated at 2^21 - 1.
+
+**/
+UINT32
+TcpCubeRoot (
+  IN UINT64  Value
+  )
+{
+  UINT32  Root;
+  UINT32  Bit;
+  UINT64  Cube;
+
+  Root = 0;
+
+  for (Bit = 1 << 20; Bit != 0; Bit >>= 1) {
+    Cube = MultU64x64 (MultU64x32 (Root | Bit, Root | Bit), Root | Bit);
+
+    if (Cube <= Value) {
+      Root |= Bit;
+    }
+  }
+
+  return Root;
+}
+
+/**
+  Compute the slow start threshold after a loss is detected, either by
+  the duplicated ACKs or by the retransmission timeout.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+  @return                   The new slow start threshold.
+
+**/
+UINT32
+TcpCongestionSsthresh (
+  IN OUT TCP_CB  *Tcb
+  )
+{
+  UINT32  FlightSize;
+
+  if (PcdGet8 (PcdTcpCongestionControl) != TCP_CC_CUBIC) {
+    //
+    // RFC5681 section 3.1, equation (4).
+    //
+    FlightSize = TCP_SUB_SEQ (Tcb->SndNxt, Tcb->SndUna);
+    return MAX (FlightSize >> 1, (UINT32)(2 * Tcb->SndMss));
+  }
+
+  //
+  // RFC8312 section 4.6, fast convergence. If the window is reduced
+  // before it grows back to the last maximum, a new flow is sharing
+  // the path, release some bandwidth for it.
+  //
+  if (Tcb->CWnd < Tcb->CubicWLastMax) {
+    Tcb->CubicWLastMax = Tcb->CWnd;
+    Tcb->CubicWMax     = (UINT32)DivU64x32 (
+                                   MultU64x32 (Tcb->CWnd, TCP_CUBIC_BETA_DEN + TCP_CUBIC_BETA_NUM),
+                                   2 * TCP_CUBIC_BETA_DEN
+                                   );
+  } else {
+    Tcb->CubicWLastMax = Tcb->CWnd;
+    Tcb->CubicWMax     = Tcb->CWnd;
+  }
+
+  //
+  // Start a new growth epoch on the next congestion avoidance.
+  //
+  Tcb->CubicOrigin = 0;
+
+  return MAX (
+           (UINT32)DivU64x32 (MultU64x32 (Tcb->CWnd, TCP_CUBIC_BETA_NUM), TCP_CUBIC_BETA_DEN),
+           (UINT32)(2 * Tcb->SndMss)
+           );
+}
+
+/**
+  Compute the target window of CUBIC one RTT from now, RFC8312
+  section 4.1.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+  @return                   The target window in bytes.
+
+**/
+UINT64
+TcpCubicTarget (
+  IN OUT TCP_CB  *Tcb
+  )
+{
+  UINT32  Time;
+  UINT32  Delta;
+  UINT64  Offset;
+
+  if (Tcb->CubicOrigin == 0) {
+    //
+    // The first congestion avoidance of the epoch. K is the time for
+    // the window to grow back to the maximum before the last reduction.
+    //
+    Tcb->CubicEpoch = mTcpTick;
+
+    if (Tcb->CWnd < Tcb->CubicWMax) {
+      Tcb->CubicK      = TcpCubeRoot (MultU64x32 ((Tcb->CubicWMax - Tcb->CWnd) / Tcb->SndMss, TCP_CUBIC_C_INVERSE));
+      Tcb->CubicOrigin = Tcb->CubicWMax;
+    } else {
+      Tcb->CubicK      = 0;
+      Tcb->CubicOrigin = Tcb->CWnd;
+    }
+  }
+
+  //
+  // t is the time elapsed since the epoch started plus one RTT,
+  // both in milliseconds.
+  //
+  Time = TCP_SUB_TIME (mTcpTick, Tcb->CubicEpoch) * TCP_TICK + ((Tcb->SRtt * TCP_TICK) >> TCP_RTT_SHIFT);
+
+  if (Time >= Tcb->CubicK) {
+    Delta = MIN (Time - Tcb->CubicK, TCP_CUBIC_TIME_MAX);
+  } else {
+    Delta = MIN (Tcb->CubicK - Time, TCP_CUBIC_TIME_MAX);
+  }
+
+  //
+  // C * (t - K)^3 in bytes.
+  //
+  Offset = DivU64x32 (MultU64x64 (MultU64x32 (Delta, Delta), Delta), TCP_CUBIC_C_INVERSE);
+  Offset = MultU64x32 (Offset, Tcb->SndMss);
+
+  if (Time >= Tcb->CubicK) {
+    return Tcb->CubicOrigin + Offset;
+  }
+
+  return (Offset < Tcb->CubicOrigin) ? Tcb->CubicOrigin - Offset : 0;
+}
+
+/**
+  Increase the congestion window in congestion avoidance, on an ACK
+  that acknowledges new data.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+**/
+VOID
+TcpCongestionAvoid (
+  IN OUT TCP_CB  *Tcb
+  )
+{
+  UINT32  Increase;
+  UINT64  Target;
+
+  //
+  // RFC5681 section 3.1, equation (3).
+  //
+  Increase = MAX (Tcb->SndMss * Tcb->SndMss / Tcb->CWnd, 1);
+
+  if (PcdGet8 (PcdTcpCongestionControl) == TCP_CC_CUBIC) {
+    //
+    // Grow the window to the target in one RTT, but no more than by
+    // half of it. Never grow slower than NewReno does, this covers
+    // the TCP friendly region of RFC8312 section 4.2.
+    //
+    Target = MIN (TcpCubicTarget (Tcb), Tcb->CWnd + (Tcb->CWnd >> 1));
+
+    if (Target > Tcb->CWnd) {
+      Increase = MAX (
+                   Increase,
+                   (UINT32)DivU64x32 (MultU64x32 (Target - Tcb->CWnd, Tcb->SndMss), Tcb->CWnd)
+                   );
+    }
+  }
+
+  Tcb->CWnd += Increase;
+}
+
+/**
+  Grow the receive buffer so that the receive window doesn't limit the
+  throughput. The data received in the last RTT estimates the
+  bandwidth-delay product, and the buffer is kept at twice of it, since
+  the application may be one RTT behind in reading the data.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+**/
+VOID
+TcpAutotuneRcvBuffer (
+  IN OUT TCP_CB  *Tcb
+  )
+{
+  UINT32  Elapsed;
+  UINT32  Rtt;
+  UINT64  Space;
+
+  //
+  // SRtt is in ticks scaled by 8, and zero if the RTT is shorter than a
+  // tick. Measure at least one tick, the estimate is too coarse otherwise.
+  //
+  Rtt     = MAX (Tcb->SRtt, 1);
+  Elapsed = TCP_SUB_TIME (mTcpTick, Tcb->RcvSpaceTick);
+  if ((Elapsed << TCP_RTT_SHIFT) < MAX (Rtt, 1 << TCP_RTT_SHIFT)) {
+    return;
+  }
+
+  Space = DivU64x32 (
+            MultU64x32 (TCP_SUB_SEQ (Tcb->RcvNxt, Tcb->RcvSpaceSeq), Rtt),
+            Elapsed << (TCP_RTT_SHIFT - 1)
+            );
+
+  if (Space > GET_RCV_BUFFSIZE (Tcb->Sk)) {
+    SET_RCV_BUFFSIZE (Tcb->Sk, (UINT32)MIN (Space, TCP_RCV_BUF_SIZE_MAX));
+
+    DEBUG (
+      (DEBUG_NET,
+       "TcpAutotuneRcvBuffer: receive buffer of TCB %p grows to %d\n",
+       Tcb,
+       GET_RCV_BUFFSIZE (Tcb->Sk))
+      );
+  }
+
+  Tcb->RcvSpaceSeq  = Tcb->RcvNxt;
+  Tcb->RcvSpaceTick = mTcpTick;
+}
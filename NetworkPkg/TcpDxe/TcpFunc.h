@@ -588,6 +588,100 @@ TcpSetKeepaliveTimer (
   IN OUT TCP_CB  *Tcb
   );
 
+//
+// Functions in TcpCongestion.c
+//
+
+/**
+  Compute the integer cube root of a value.
+
+  @param[in]  Value   The value to compute the cube root of.
+
+  @return             The largest integer whose cube isn't greater than
+                      Value, saturated at 2^21 - 1.
+
+**/
+UINT32
+TcpCubeRoot (
+  IN UINT64  Value
+  );
+
+/**
+  Compute the slow start threshold after a loss is detected, either by
+  the duplicated ACKs or by the retransmission timeout.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+  @return                   The new slow start threshold.
+
+**/
+UINT32
+TcpCongestionSsthresh (
+  IN OUT TCP_CB  *Tcb
+  );
+
+/**
+  Increase the congestion window in congestion avoidance, on an ACK
+  that acknowledges new data.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+**/
+VOID
+TcpCongestionAvoid (
+  IN OUT TCP_CB  *Tcb
+  );
+
+/**
+  Grow the receive buffer so that the receive window doesn't limit the
+  throughput. The data received in the last RTT estimates the
+  bandwidth-delay product, and the buffer is kept at twice of it, up to
+  TCP_RCV_BUF_SIZE_MAX.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+**/
+VOID
+TcpAutotuneRcvBuffer (
+  IN OUT TCP_CB  *Tcb
+  );
+
+//
+// Functions in TcpSack.c
+//
+
+/**
+  Update the ranges SACKed by the peer with the blocks of the SACK option
+  received, RFC2018. The ranges are kept sorted and merged.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+  @param[in]       Ack      The acknowledge sequence number of the received segment.
+  @param[in]       Option   Pointer to the options of the received segment.
+
+**/
+VOID
+TcpSackUpdate (
+  IN OUT TCP_CB      *Tcb,
+  IN     TCP_SEQNO   Ack,
+  IN     TCP_OPTION  *Option
+  );
+
+/**
+  Retransmit the first segment of the lowest hole in the sequence space
+  that isn't SACKed and hasn't been retransmitted in this recovery,
+  RFC6675.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+  @retval 0       A segment is retransmitted.
+  @retval -1      No hole is found, or an error condition occurred.
+
+**/
+INTN
+TcpSackRetransmit (
+  IN OUT TCP_CB  *Tcb
+  );
+
 //
 // Functions in TcpIo.c
 //
@@ -163,7 +163,9 @@ Tcp4Configure (
     }
 
     Option = TcpConfigData->ControlOption;
-    if ((NULL != Option) && (Option->EnableSelectiveAck || Option->EnablePathMtuDiscovery)) {
+    if ((NULL != Option) && (Option->EnablePathMtuDiscovery ||
+                             (Option->EnableSelectiveAck && !PcdGetBool (PcdTcpSelectiveAck))))
+    {
       return EFI_UNSUPPORTED;
     }
   }
@@ -698,7 +700,9 @@ Tcp6Configure (
     }
 
     Option = Tcp6ConfigData->ControlOption;
-    if ((NULL != Option) && (Option->EnableSelectiveAck || Option->EnablePathMtuDiscovery)) {
+    if ((NULL != Option) && (Option->EnablePathMtuDiscovery ||
+                             (Option->EnableSelectiveAck && !PcdGetBool (PcdTcpSelectiveAck))))
+    {
       return EFI_UNSUPPORTED;
     }
   }
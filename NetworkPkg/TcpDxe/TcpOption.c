@@ -82,7 +82,15 @@ TcpComputeScale (
 
   ASSERT ((Tcb != NULL) && (Tcb->Sk != NULL));
 
-  BufSize = GET_RCV_BUFFSIZE (Tcb->Sk);
+  //
+  // The scale can't be changed after the handshake, so leave room for
+  // the receive buffer to be grown by the autotuning.
+  //
+  if (TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_RCV_AUTOTUNE)) {
+    BufSize = TCP_RCV_BUF_SIZE_MAX;
+  } else {
+    BufSize = GET_RCV_BUFFSIZE (Tcb->Sk);
+  }
 
   Scale = 0;
   while ((Scale < TCP_OPTION_MAX_WS) && ((UINT32)(TCP_OPTION_MAX_WIN << Scale) < BufSize)) {
@@ -160,6 +168,28 @@ TcpSynBuildOption (
     TcpPutUint32 (Data, TCP_OPTION_WS_FAST | TcpComputeScale (Tcb));
   }
 
+  //
+  // Build SACK permitted option, only when SACK isn't
+  // disabled, and either we are doing active open or
+  // we have received SACK permitted option from peer.
+  //
+  if (!TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_NO_SACK) &&
+      (!TCP_FLG_ON (TCPSEG_NETBUF (Nbuf)->Flag, TCP_FLG_ACK) ||
+       TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_RCVD_SACK))
+      )
+  {
+    Data = NetbufAllocSpace (
+             Nbuf,
+             TCP_OPTION_SACK_PERM_ALIGNED_LEN,
+             NET_BUF_HEAD
+             );
+
+    ASSERT (Data != NULL);
+
+    Len += TCP_OPTION_SACK_PERM_ALIGNED_LEN;
+    TcpPutUint32 (Data, TCP_OPTION_SACK_PERM_FAST);
+  }
+
   //
   // Build the MSS option.
   //
@@ -172,6 +202,116 @@ TcpSynBuildOption (
   return Len;
 }
 
+/**
+  Get the range of contiguous out-of-order data that starts at Entry in
+  the reassemble queue.
+
+  @param[in]       Tcb     Pointer to the TCP_CB of this TCP instance.
+  @param[in, out]  Entry   On input, the first segment of the range. On
+                           output, the first segment after the range.
+  @param[out]      Block   The range of sequence numbers.
+
+**/
+VOID
+TcpGetRcvRange (
+  IN     TCP_CB          *Tcb,
+  IN OUT LIST_ENTRY      **Entry,
+  OUT    TCP_SACK_BLOCK  *Block
+  )
+{
+  TCP_SEG  *Seg;
+
+  Seg          = TCPSEG_NETBUF (NET_LIST_USER_STRUCT (*Entry, NET_BUF, List));
+  Block->Left  = Seg->Seq;
+  Block->Right = Seg->End;
+
+  for (*Entry = (*Entry)->ForwardLink; *Entry != &Tcb->RcvQue; *Entry = (*Entry)->ForwardLink) {
+    Seg = TCPSEG_NETBUF (NET_LIST_USER_STRUCT (*Entry, NET_BUF, List));
+
+    if (TCP_SEQ_GT (Seg->Seq, Block->Right)) {
+      break;
+    }
+
+    if (TCP_SEQ_GT (Seg->End, Block->Right)) {
+      Block->Right = Seg->End;
+    }
+  }
+}
+
+/**
+  Build the SACK option, RFC2018. The first block reports the range
+  that holds the latest segment received, the others follow in
+  sequence order.
+
+  @param[in]  Tcb     Pointer to the TCP_CB of this TCP instance.
+  @param[in]  Nbuf    Pointer to the buffer to store the options.
+  @param[in]  MaxNum  The maximum number of blocks to build.
+
+  @return             The total length of the SACK option, aligned.
+
+**/
+UINT16
+TcpBuildSackOption (
+  IN TCP_CB   *Tcb,
+  IN NET_BUF  *Nbuf,
+  IN UINT8    MaxNum
+  )
+{
+  TCP_SACK_BLOCK  Block[TCP_OPTION_MAX_SACK];
+  TCP_SACK_BLOCK  Range;
+  LIST_ENTRY      *Entry;
+  UINT8           *Data;
+  UINT8           Num;
+  UINT8           Index;
+
+  ASSERT (MaxNum <= TCP_OPTION_MAX_SACK);
+
+  Num   = 0;
+  Entry = Tcb->RcvQue.ForwardLink;
+
+  while ((Entry != &Tcb->RcvQue) && (Num < TCP_OPTION_MAX_SACK)) {
+    TcpGetRcvRange (Tcb, &Entry, &Range);
+
+    if (TCP_SEQ_LEQ (Range.Right, Tcb->RcvNxt)) {
+      continue;
+    }
+
+    if ((Num != 0) && TCP_SEQ_LEQ (Range.Left, Tcb->RcvSackSeq) && TCP_SEQ_LT (Tcb->RcvSackSeq, Range.Right)) {
+      //
+      // Move the range of the latest segment to the first place.
+      //
+      Block[Num] = Block[0];
+      Block[0]   = Range;
+    } else {
+      Block[Num] = Range;
+    }
+
+    Num++;
+  }
+
+  Num = MIN (Num, MaxNum);
+  if (Num == 0) {
+    return 0;
+  }
+
+  Data = NetbufAllocSpace (
+           Nbuf,
+           TCP_OPTION_SACK_HEAD_ALIGNED_LEN + Num * TCP_OPTION_SACK_BLOCK_LEN,
+           NET_BUF_HEAD
+           );
+
+  ASSERT (Data != NULL);
+
+  TcpPutUint32 (Data, TCP_OPTION_SACK_FAST | (2 + Num * TCP_OPTION_SACK_BLOCK_LEN));
+
+  for (Index = 0; Index < Num; Index++) {
+    TcpPutUint32 (Data + 4 + Index * TCP_OPTION_SACK_BLOCK_LEN, Block[Index].Left);
+    TcpPutUint32 (Data + 8 + Index * TCP_OPTION_SACK_BLOCK_LEN, Block[Index].Right);
+  }
+
+  return (UINT16)(TCP_OPTION_SACK_HEAD_ALIGNED_LEN + Num * TCP_OPTION_SACK_BLOCK_LEN);
+}
+
 /**
   Build the TCP option in synchronized states.
 
@@ -214,6 +354,23 @@ TcpBuildOption (
     TcpPutUint32 (Data + 8, Tcb->TsRecent);
   }
 
+  //
+  // Build the SACK option if out-of-order data is queued. It's only
+  // sent on segments without data, the MSS doesn't leave room for it.
+  //
+  if (TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_SND_SACK) &&
+      !TCP_FLG_ON (TCPSEG_NETBUF (Nbuf)->Flag, TCP_FLG_RST) &&
+      (Nbuf->TotalSize == Len) &&
+      !IsListEmpty (&Tcb->RcvQue)
+      )
+  {
+    Len = (UINT16)(Len + TcpBuildSackOption (
+                           Tcb,
+                           Nbuf,
+                           (UINT8)((TCP_OPTION_MAX_LEN - Len - TCP_OPTION_SACK_HEAD_ALIGNED_LEN) / TCP_OPTION_SACK_BLOCK_LEN)
+                           ));
+  }
+
   return Len;
 }
 
@@ -239,10 +396,12 @@ TcpParseOption (
   UINT8  Cur;
   UINT8  Type;
   UINT8  Len;
+  UINT8  Index;
 
   ASSERT ((Tcp != NULL) && (Option != NULL));
 
-  Option->Flag = 0;
+  Option->Flag    = 0;
+  Option->SackNum = 0;
 
   TotalLen = (UINT8)((Tcp->HeadLen << 2) - sizeof (TCP_HEAD));
   if (TotalLen <= 0) {
@@ -311,6 +470,42 @@ TcpParseOption (
         Cur += TCP_OPTION_TS_LEN;
         break;
 
+      case TCP_OPTION_SACK_PERM:
+        Len = Head[Cur + 1];
+
+        if ((Len != TCP_OPTION_SACK_PERM_LEN) || (TotalLen - Cur < TCP_OPTION_SACK_PERM_LEN)) {
+          return -1;
+        }
+
+        TCP_SET_FLG (Option->Flag, TCP_OPTION_RCVD_SACK_PERM);
+
+        Cur += TCP_OPTION_SACK_PERM_LEN;
+        break;
+
+      case TCP_OPTION_SACK:
+        Len = Head[Cur + 1];
+
+        if ((Len < 2 + TCP_OPTION_SACK_BLOCK_LEN) ||
+            ((Len - 2) % TCP_OPTION_SACK_BLOCK_LEN != 0) ||
+            (TotalLen - Cur < Len))
+        {
+          return -1;
+        }
+
+        //
+        // Keep the first blocks only, they report the most recent data.
+        //
+        for (Index = 0; (Index < (Len - 2) / TCP_OPTION_SACK_BLOCK_LEN) && (Index < TCP_OPTION_MAX_SACK); Index++) {
+          Option->SackBlock[Index].Left  = TcpGetUint32 (&Head[Cur + 2 + Index * TCP_OPTION_SACK_BLOCK_LEN]);
+          Option->SackBlock[Index].Right = TcpGetUint32 (&Head[Cur + 6 + Index * TCP_OPTION_SACK_BLOCK_LEN]);
+        }
+
+        Option->SackNum = Index;
+        TCP_SET_FLG (Option->Flag, TCP_OPTION_RCVD_SACK);
+
+        Cur = (UINT8)(Cur + Len);
+        break;
+
       case TCP_OPTION_NOP:
         Cur++;
         break;
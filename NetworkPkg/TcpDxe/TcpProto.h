@@ -70,6 +70,16 @@
 #define TCP_CTRL_TIMER_ON      0x1000   ///< At least one of the timer is on.
 #define TCP_CTRL_RTT_ON        0x2000   ///< The RTT measurement is on.
 #define TCP_CTRL_ACK_NOW       0x4000   ///< Send the ACK now, don't delay.
+#define TCP_CTRL_NO_SACK       0x8000   ///< Disable SACK option.
+#define TCP_CTRL_RCVD_SACK     0x10000  ///< Received a SACK permitted option in syn.
+#define TCP_CTRL_SND_SACK      0x20000  ///< Send SACK option to remote.
+#define TCP_CTRL_RCV_AUTOTUNE  0x40000  ///< Grow the receive buffer to the bandwidth-delay product.
+
+//
+// Congestion control algorithms, selected by PcdTcpCongestionControl.
+//
+#define TCP_CC_NEWRENO  0           ///< NewReno, RFC5681 and RFC6582.
+#define TCP_CC_CUBIC    1           ///< CUBIC, RFC8312.
 
 //
 // Timer related values
@@ -111,6 +121,7 @@
 //
 #define TCP_RCV_BUF_SIZE          (2 * 1024 * 1024)
 #define TCP_RCV_BUF_SIZE_MIN      (8 * 1024)
+#define TCP_RCV_BUF_SIZE_MAX      (16 * 1024 * 1024)   ///< Limit of the receive buffer autotuning.
 #define TCP_SND_BUF_SIZE          (2 * 1024 * 1024)
 #define TCP_SND_BUF_SIZE_MIN      (8 * 1024)
 #define TCP_BACKLOG               10
@@ -204,6 +215,19 @@
 
 #define TCP_MAX_WIN  0xFFFFU
 
+//
+// The number of SACKed ranges remembered by the sender.
+//
+#define TCP_SACK_BLOCK_NUM  8
+
+///
+/// A range of sequence numbers [Left, Right) reported by SACK.
+///
+typedef struct _TCP_SACK_BLOCK {
+  TCP_SEQNO    Left;  ///< The first sequence number of the block.
+  TCP_SEQNO    Right; ///< The sequence number following the last one of the block.
+} TCP_SACK_BLOCK;
+
 ///
 /// TCP segmentation data.
 ///
@@ -306,6 +330,29 @@ struct _TCP_CONTROL_BLOCK {
   UINT8               LossTimes;    ///< Number of retxmit timeouts in a row.
   TCP_SEQNO           LossRecover;  ///< Recover point for retxmit.
 
+  //
+  // RFC2018 and RFC6675 variables, SACK based loss recovery.
+  //
+  TCP_SACK_BLOCK      SackBlock[TCP_SACK_BLOCK_NUM]; ///< Ranges SACKed by the peer, sorted.
+  UINT8               SackBlockNum;                  ///< Number of valid ranges in SackBlock.
+  TCP_SEQNO           SackHighRxt;                   ///< Highest sequence retransmitted in recovery.
+  TCP_SEQNO           RcvSackSeq;                    ///< Start of the latest out-of-order segment.
+
+  //
+  // RFC8312 variables, CUBIC congestion control.
+  //
+  UINT32              CubicWMax;     ///< CWnd before the last reduction.
+  UINT32              CubicWLastMax; ///< CubicWMax before the last reduction.
+  UINT32              CubicOrigin;   ///< CWnd the cubic function grows back to.
+  UINT32              CubicK;        ///< Time to reach CubicOrigin, in milliseconds.
+  UINT32              CubicEpoch;    ///< Tick when the current growth epoch started.
+
+  //
+  // Receive buffer autotuning.
+  //
+  TCP_SEQNO           RcvSpaceSeq;  ///< RcvNxt at the start of the measurement.
+  UINT32              RcvSpaceTick; ///< Tick when the measurement started.
+
   //
   // RFC7323
   // Addressing Window Retraction for TCP Window Scale Option.
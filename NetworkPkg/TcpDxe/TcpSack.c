@@ -0,0 +1,187 @@
+/** @file
+  TCP selective acknowledgment, RFC2018. The sender keeps a scoreboard of
+  the ranges SACKed by the peer, and retransmits the holes between them in
+  fast recovery as RFC6675 describes.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TcpMain.h"
+
+/**
+  Update the ranges SACKed by the peer with the blocks of the SACK option
+  received, RFC2018. The ranges are kept sorted and merged.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+  @param[in]       Ack      The acknowledge sequence number of the received segment.
+  @param[in]       Option   Pointer to the options of the received segment.
+
+**/
+VOID
+TcpSackUpdate (
+  IN OUT TCP_CB      *Tcb,
+  IN     TCP_SEQNO   Ack,
+  IN     TCP_OPTION  *Option
+  )
+{
+  TCP_SACK_BLOCK  *Block;
+  TCP_SEQNO       Left;
+  TCP_SEQNO       Right;
+  UINT8           Index;
+  UINT8           Cur;
+  UINT8           Next;
+  UINT8           Num;
+
+  Block = Tcb->SackBlock;
+
+  //
+  // Drop the ranges that are cumulatively acknowledged now.
+  //
+  Num = 0;
+  for (Index = 0; Index < Tcb->SackBlockNum; Index++) {
+    if (TCP_SEQ_LEQ (Block[Index].Right, Ack)) {
+      continue;
+    }
+
+    Block[Num] = Block[Index];
+    if (TCP_SEQ_LT (Block[Num].Left, Ack)) {
+      Block[Num].Left = Ack;
+    }
+
+    Num++;
+  }
+
+  for (Index = 0; Index < Option->SackNum; Index++) {
+    Left  = Option->SackBlock[Index].Left;
+    Right = Option->SackBlock[Index].Right;
+
+    //
+    // Ignore the invalid blocks and the ones reporting duplicated data.
+    //
+    if (TCP_SEQ_GEQ (Left, Right) || TCP_SEQ_LEQ (Right, Ack) || TCP_SEQ_GT (Right, Tcb->SndNxt)) {
+      continue;
+    }
+
+    if (TCP_SEQ_LT (Left, Ack)) {
+      Left = Ack;
+    }
+
+    //
+    // Find the ranges that overlap or adjoin the block, and merge them.
+    //
+    Cur = 0;
+    while ((Cur < Num) && TCP_SEQ_LT (Block[Cur].Right, Left)) {
+      Cur++;
+    }
+
+    for (Next = Cur; (Next < Num) && TCP_SEQ_LEQ (Block[Next].Left, Right); Next++) {
+      if (TCP_SEQ_LT (Block[Next].Left, Left)) {
+        Left = Block[Next].Left;
+      }
+
+      if (TCP_SEQ_GT (Block[Next].Right, Right)) {
+        Right = Block[Next].Right;
+      }
+    }
+
+    if (Next == Cur) {
+      //
+      // A new range. If the scoreboard is full, forget the highest
+      // range, the lower ones are more useful for the retransmission.
+      //
+      if (Num == TCP_SACK_BLOCK_NUM) {
+        if (Cur == Num) {
+          continue;
+        }
+
+        Num--;
+      }
+
+      CopyMem (&Block[Cur + 1], &Block[Cur], (Num - Cur) * sizeof (TCP_SACK_BLOCK));
+      Num++;
+    } else {
+      CopyMem (&Block[Cur + 1], &Block[Next], (Num - Next) * sizeof (TCP_SACK_BLOCK));
+      Num = (UINT8)(Num - (Next - Cur - 1));
+    }
+
+    Block[Cur].Left  = Left;
+    Block[Cur].Right = Right;
+  }
+
+  Tcb->SackBlockNum = Num;
+}
+
+/**
+  Retransmit the first segment of the lowest hole in the sequence space
+  that isn't SACKed and hasn't been retransmitted in this recovery,
+  RFC6675.
+
+  @param[in, out]  Tcb      Pointer to the TCP_CB of this TCP instance.
+
+  @retval 0       A segment is retransmitted.
+  @retval -1      No hole is found, or an error condition occurred.
+
+**/
+INTN
+TcpSackRetransmit (
+  IN OUT TCP_CB  *Tcb
+  )
+{
+  LIST_ENTRY  *Entry;
+  TCP_SEG     *Seg;
+  TCP_SEQNO   Seq;
+  TCP_SEQNO   End;
+  UINT8       Index;
+
+  Seq = Tcb->SndUna;
+  if (TCP_SEQ_GT (Tcb->SackHighRxt, Seq)) {
+    Seq = Tcb->SackHighRxt;
+  }
+
+  //
+  // Data above the highest SACKed range isn't considered lost.
+  //
+  for (Index = 0; Index < Tcb->SackBlockNum; Index++) {
+    if (TCP_SEQ_LT (Seq, Tcb->SackBlock[Index].Left)) {
+      break;
+    }
+
+    if (TCP_SEQ_LT (Seq, Tcb->SackBlock[Index].Right)) {
+      Seq = Tcb->SackBlock[Index].Right;
+    }
+  }
+
+  if (Index == Tcb->SackBlockNum) {
+    return -1;
+  }
+
+  if (TcpRetransmit (Tcb, Seq) != 0) {
+    return -1;
+  }
+
+  //
+  // TcpRetransmit doesn't cross the boundary of the queued segment.
+  //
+  End = Seq + Tcb->SndMss;
+  if (TCP_SEQ_GT (End, Tcb->SackBlock[Index].Left)) {
+    End = Tcb->SackBlock[Index].Left;
+  }
+
+  NET_LIST_FOR_EACH (Entry, &Tcb->SndQue) {
+    Seg = TCPSEG_NETBUF (NET_LIST_USER_STRUCT (Entry, NET_BUF, List));
+
+    if (TCP_SEQ_LEQ (Seg->Seq, Seq) && TCP_SEQ_LT (Seq, Seg->End)) {
+      if (TCP_SEQ_GT (End, Seg->End)) {
+        End = Seg->End;
+      }
+
+      break;
+    }
+  }
+
+  Tcb->SackHighRxt = End;
+  return 0;
+}
@@ -180,8 +180,6 @@ TcpRexmitTimeout (
   IN OUT TCP_CB  *Tcb
   )
 {
-  UINT32  FlightSize;
-
   DEBUG (
     (DEBUG_WARN,
      "TcpRexmitTimeout: transmission timeout for TCB %p\n",
@@ -189,15 +187,14 @@ TcpRexmitTimeout (
     );
 
   //
-  // Set the congestion window. FlightSize is the
-  // amount of data that has been sent but not
-  // yet ACKed.
+  // Set the congestion window, and forget the SACKed
+  // ranges as the peer may have discarded them.
   //
-  FlightSize    = TCP_SUB_SEQ (Tcb->SndNxt, Tcb->SndUna);
-  Tcb->Ssthresh = MAX ((UINT32)(2 * Tcb->SndMss), FlightSize / 2);
+  Tcb->Ssthresh = TcpCongestionSsthresh (Tcb);
 
-  Tcb->CWnd        = Tcb->SndMss;
-  Tcb->LossRecover = Tcb->SndNxt;
+  Tcb->CWnd         = Tcb->SndMss;
+  Tcb->LossRecover  = Tcb->SndNxt;
+  Tcb->SackBlockNum = 0;
 
   Tcb->LossTimes++;
   if ((Tcb->LossTimes > Tcb->MaxRexmit) && !TCP_TIMER_ON (Tcb->EnabledTimer, TCP_TIMER_CONNECT)) {
@@ -506,6 +503,10 @@ TcpTickingDpc (
 
     Tcb->Idle++;
 
+    if (TCP_FLG_ON (Tcb->CtrlFlag, TCP_CTRL_RCV_AUTOTUNE) && TCP_CONNECTED (Tcb->State)) {
+      TcpAutotuneRcvBuffer (Tcb);
+    }
+
     if (Tcb->DelayedAck != 0) {
       TcpSendAck (Tcb);
     }
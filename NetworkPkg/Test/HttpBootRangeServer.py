@@ -0,0 +1,284 @@
+## @file
+#  HTTP server on the loopback interface for testing the ranged boot file
+#  download of HttpBootDxe (PcdHttpBootRangeConnections).
+#
+#  The server answers HEAD and GET requests for a single boot file with
+#  "Accept-Ranges: bytes", a strong ETag and 206 (Partial Content) responses
+#  to single byte range requests. A delay before every response and a rate
+#  limit per connection emulate a server behind a long round trip time.
+#
+#  Serve a file, e.g. to an EmulatorPkg or QEMU guest booting from
+#  http://<host>:8080/<name>:
+#
+#    HttpBootRangeServer.py --file Boot.iso --address 0.0.0.0 --port 8080
+#
+#  Check the server itself, and compare a single connection download with a
+#  ranged one over 4 connections:
+#
+#    HttpBootRangeServer.py --self-test --size 64M --connections 4
+#
+#  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+#
+#  SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+import argparse
+import hashlib
+import http.client
+import http.server
+import os
+import re
+import sys
+import threading
+import time
+
+SEGMENT_SIZE = 4 * 1024 * 1024
+RANGE_PATTERN = re.compile(r'^bytes=(\d+)-(\d+)$')
+
+
+class BootFile:
+    def __init__(self, name, data):
+        self.name = name
+        self.data = data
+        self.etag = '"%s"' % hashlib.sha256(data).hexdigest()[:32]
+        self.lock = threading.Lock()
+        self.served = bytearray(len(data) // SEGMENT_SIZE + 1)
+        self.ranges = 0
+
+    def record(self, first, last):
+        with self.lock:
+            self.ranges += 1
+            for index in range(first // SEGMENT_SIZE, last // SEGMENT_SIZE + 1):
+                self.served[index] = 1
+
+
+class RangeHandler(http.server.BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def log_message(self, format, *args):
+        if self.server.verbose:
+            sys.stderr.write('%s:%d %s\n' % (self.client_address[0], self.client_address[1], format % args))
+
+    def send_common_headers(self, length):
+        boot_file = self.server.boot_file
+        self.send_header('Content-Type', 'application/octet-stream')
+        self.send_header('Content-Length', str(length))
+        self.send_header('Accept-Ranges', 'bytes')
+        self.send_header('ETag', boot_file.etag)
+
+    def parse_range(self):
+        value = self.headers.get('Range')
+        if value is None:
+            return None
+        match = RANGE_PATTERN.match(value.strip())
+        size = len(self.server.boot_file.data)
+        if match is None:
+            return 'invalid'
+        first, last = int(match.group(1)), int(match.group(2))
+        if first > last or first >= size:
+            return 'invalid'
+        return first, min(last, size - 1)
+
+    def do_HEAD(self):
+        self.respond(send_body=False)
+
+    def do_GET(self):
+        self.respond(send_body=True)
+
+    def respond(self, send_body):
+        boot_file = self.server.boot_file
+        if self.path.lstrip('/') != boot_file.name:
+            self.send_response(404)
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+            return
+
+        time.sleep(self.server.delay)
+        size = len(boot_file.data)
+        byte_range = self.parse_range()
+        if byte_range == 'invalid':
+            self.send_response(416)
+            self.send_header('Content-Range', 'bytes */%d' % size)
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+            return
+
+        if byte_range is None:
+            first, last = 0, size - 1
+            self.send_response(200)
+        else:
+            first, last = byte_range
+            self.send_response(206)
+            self.send_header('Content-Range', 'bytes %d-%d/%d' % (first, last, size))
+
+        self.send_common_headers(last - first + 1)
+        self.end_headers()
+        if not send_body:
+            return
+
+        if byte_range is not None:
+            boot_file.record(first, last)
+        self.send_rate_limited(boot_file.data[first:last + 1])
+
+    def send_rate_limited(self, data):
+        rate = self.server.rate
+        chunk = 64 * 1024
+        start = time.monotonic()
+        for offset in range(0, len(data), chunk):
+            self.wfile.write(data[offset:offset + chunk])
+            if rate:
+                ahead = (offset + chunk) / rate - (time.monotonic() - start)
+                if ahead > 0:
+                    time.sleep(ahead)
+
+
+class RangeServer(http.server.ThreadingHTTPServer):
+    daemon_threads = True
+
+    def __init__(self, address, boot_file, delay, rate, verbose):
+        super().__init__(address, RangeHandler)
+        self.boot_file = boot_file
+        self.delay = delay
+        self.rate = rate
+        self.verbose = verbose
+
+
+def parse_size(value):
+    units = {'K': 1024, 'M': 1024 ** 2, 'G': 1024 ** 3}
+    if value[-1:].upper() in units:
+        return int(value[:-1]) * units[value[-1:].upper()]
+    return int(value)
+
+
+def fetch(port, name, first=None, last=None):
+    connection = http.client.HTTPConnection('127.0.0.1', port)
+    headers = {}
+    if first is not None:
+        headers['Range'] = 'bytes=%d-%d' % (first, last)
+    connection.request('GET', '/' + name, headers=headers)
+    response = connection.getresponse()
+    body = response.read()
+    result = (response.status, dict(response.getheaders()), body)
+    connection.close()
+    return result
+
+
+def ranged_download(port, name, size, connections):
+    #
+    # Same segmentation as HttpBootRange.c: fixed size segments handed out in
+    # file order to whichever connection is free.
+    #
+    buffer = bytearray(size)
+    segments = [(offset, min(offset + SEGMENT_SIZE, size) - 1) for offset in range(0, size, SEGMENT_SIZE)]
+    lock = threading.Lock()
+    errors = []
+    etags = set()
+
+    def worker():
+        connection = http.client.HTTPConnection('127.0.0.1', port)
+        while True:
+            with lock:
+                if not segments or errors:
+                    break
+                first, last = segments.pop(0)
+            connection.request('GET', '/' + name, headers={'Range': 'bytes=%d-%d' % (first, last)})
+            response = connection.getresponse()
+            body = response.read()
+            expected = 'bytes %d-%d/%d' % (first, last, size)
+            if response.status != 206 or response.getheader('Content-Range') != expected or len(body) != last - first + 1:
+                with lock:
+                    errors.append('bad response %d %s for %s' % (response.status, response.getheader('Content-Range'), expected))
+                break
+            with lock:
+                etags.add(response.getheader('ETag'))
+            buffer[first:last + 1] = body
+        connection.close()
+
+    threads = [threading.Thread(target=worker) for _ in range(connections)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    if len(etags) > 1:
+        errors.append('entity tag changed during the download')
+    return bytes(buffer), errors
+
+
+def self_test(args):
+    size = parse_size(args.size)
+    boot_file = BootFile('boot.img', os.urandom(size))
+    server = RangeServer(('127.0.0.1', 0), boot_file, args.delay, args.rate, args.verbose)
+    port = server.server_address[1]
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    digest = hashlib.sha256(boot_file.data).hexdigest()
+    failures = 0
+
+    status, headers, body = fetch(port, boot_file.name, 0, 99)
+    if status != 206 or headers.get('Content-Range') != 'bytes 0-99/%d' % size or body != boot_file.data[:100]:
+        print('FAIL: single range request')
+        failures += 1
+
+    status, headers, body = fetch(port, boot_file.name, size, size + 10)
+    if status != 416:
+        print('FAIL: unsatisfiable range accepted')
+        failures += 1
+
+    start = time.monotonic()
+    status, headers, body = fetch(port, boot_file.name)
+    single = time.monotonic() - start
+    if status != 200 or hashlib.sha256(body).hexdigest() != digest:
+        print('FAIL: single connection download')
+        failures += 1
+
+    start = time.monotonic()
+    body, errors = ranged_download(port, boot_file.name, size, args.connections)
+    ranged = time.monotonic() - start
+    for error in errors:
+        print('FAIL: ' + error)
+        failures += 1
+    if hashlib.sha256(body).hexdigest() != digest:
+        print('FAIL: ranged download content mismatch')
+        failures += 1
+
+    server.shutdown()
+    print('%d bytes, 1 connection: %.2f s, %d connections: %.2f s' % (size, single, args.connections, ranged))
+    print('PASS' if failures == 0 else '%d FAILURES' % failures)
+    return 0 if failures == 0 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description='HTTP boot file server with byte range support.')
+    parser.add_argument('--file', help='boot file to serve')
+    parser.add_argument('--size', default='32M', help='size of the random boot file for --self-test')
+    parser.add_argument('--address', default='127.0.0.1', help='address to listen on')
+    parser.add_argument('--port', type=int, default=8080, help='port to listen on')
+    parser.add_argument('--delay', type=float, default=0.05, help='seconds before every response')
+    parser.add_argument('--rate', type=parse_size, default=parse_size('8M'), help='bytes per second per connection, 0 for unlimited')
+    parser.add_argument('--connections', type=int, default=4, help='connections used by --self-test')
+    parser.add_argument('--self-test', action='store_true', help='test the server against a ranged client on loopback')
+    parser.add_argument('--verbose', action='store_true', help='log every request')
+    args = parser.parse_args()
+
+    if args.self_test:
+        return self_test(args)
+
+    if args.file is None:
+        parser.error('--file is required')
+
+    with open(args.file, 'rb') as file:
+        boot_file = BootFile(os.path.basename(args.file), file.read())
+    server = RangeServer((args.address, args.port), boot_file, args.delay, args.rate, args.verbose)
+    print('Serving %s (%d bytes, ETag %s) on http://%s:%d/%s' % (
+        boot_file.name, len(boot_file.data), boot_file.etag, args.address, args.port, boot_file.name))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+    print('%d range requests served, %d of %d segments requested' % (
+        boot_file.ranges, sum(boot_file.served), len(boot_file.served)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
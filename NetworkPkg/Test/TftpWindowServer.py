@@ -0,0 +1,371 @@
+## @file
+#  TFTP server on the loopback interface for testing the windowsize option
+#  (RFC 7440) of Mtftp4Dxe and Mtftp6Dxe.
+#
+#  The server answers read requests with the blksize, timeout, tsize and
+#  windowsize options and sends windowsize blocks before waiting for an ACK.
+#  A delay before every window and a random loss of data packets emulate a
+#  server behind a long round trip time.
+#
+#  Serve a directory, e.g. to an EmulatorPkg or QEMU guest doing a PXE boot
+#  with PcdPxeTftpWindowSize set:
+#
+#    TftpWindowServer.py --root /srv/tftp --address 0.0.0.0 --port 69
+#
+#  Check the server itself, and compare downloads with different window
+#  sizes. The client of --self-test follows the same receive rules as the
+#  MTFTP drivers: it acknowledges a window once it is complete, only the
+#  first block after a lost one, and on timeout the last block received in
+#  order.
+#
+#    TftpWindowServer.py --self-test --size 16M --windows 1,4,16 --loss 0.001
+#
+#  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+#
+#  SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+import argparse
+import hashlib
+import os
+import random
+import socket
+import struct
+import sys
+import threading
+import time
+
+OPCODE_RRQ = 1
+OPCODE_DATA = 3
+OPCODE_ACK = 4
+OPCODE_ERROR = 5
+OPCODE_OACK = 6
+
+ERROR_NOT_FOUND = 1
+ERROR_ILLEGAL_OPERATION = 4
+
+DEFAULT_BLKSIZE = 512
+MAX_BLKSIZE = 65464
+MAX_WINDOWSIZE = 65535
+MAX_RETRY = 5
+
+
+def parse_size(value):
+    units = {'K': 1024, 'M': 1024 ** 2, 'G': 1024 ** 3}
+    if value[-1:].upper() in units:
+        return int(value[:-1]) * units[value[-1:].upper()]
+    return int(value)
+
+
+def error_packet(code, message):
+    return struct.pack('!HH', OPCODE_ERROR, code) + message.encode('ascii') + b'\0'
+
+
+def parse_request(packet):
+    fields = packet[2:].split(b'\0')
+    if len(fields) < 3:
+        return None, None, {}
+    name = fields[0].decode('ascii', 'replace')
+    mode = fields[1].decode('ascii', 'replace').lower()
+    options = {}
+    for index in range(2, len(fields) - 1, 2):
+        options[fields[index].decode('ascii').lower()] = fields[index + 1].decode('ascii')
+    return name, mode, options
+
+
+class Transfer(threading.Thread):
+    def __init__(self, server, client, data, options):
+        super().__init__(daemon=True)
+        self.server = server
+        self.client = client
+        self.data = data
+        self.options = options
+        self.socket = socket.socket(server.family, socket.SOCK_DGRAM)
+        self.socket.bind((server.address, 0))
+        self.random = random.Random(server.seed)
+
+    def negotiate(self):
+        reply = {}
+        self.blksize = DEFAULT_BLKSIZE
+        self.windowsize = 1
+        self.timeout = self.server.timeout
+        if 'blksize' in self.options:
+            self.blksize = max(8, min(int(self.options['blksize']), MAX_BLKSIZE))
+            reply['blksize'] = self.blksize
+        if 'windowsize' in self.options:
+            self.windowsize = max(1, min(int(self.options['windowsize']), self.server.max_window))
+            reply['windowsize'] = self.windowsize
+        if 'timeout' in self.options:
+            self.timeout = int(self.options['timeout'])
+            reply['timeout'] = self.timeout
+        if 'tsize' in self.options:
+            reply['tsize'] = len(self.data)
+        return reply
+
+    def send(self, packet, data_packet=False):
+        if data_packet and self.random.random() < self.server.loss:
+            self.server.count('dropped')
+            return
+        self.socket.sendto(packet, self.client)
+
+    def wait_ack(self, first, last):
+        #
+        # Return the absolute number of the block acknowledged within
+        # [first, last], or None on timeout. The ACK carries the block
+        # number modulo 65536.
+        #
+        deadline = time.monotonic() + self.timeout
+        while True:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return None
+            self.socket.settimeout(remaining)
+            try:
+                packet, peer = self.socket.recvfrom(65536)
+            except socket.timeout:
+                return None
+            if peer != self.client or len(packet) < 4:
+                continue
+            opcode, number = struct.unpack('!HH', packet[:4])
+            if opcode == OPCODE_ERROR:
+                raise ConnectionAbortedError(packet[4:-1].decode('ascii', 'replace'))
+            if opcode != OPCODE_ACK:
+                continue
+            block = first + ((number - first) & 0xFFFF)
+            if block <= last:
+                return block
+
+    def run(self):
+        try:
+            self.transfer()
+        except (ConnectionAbortedError, OSError) as error:
+            if self.server.verbose:
+                sys.stderr.write('%s: %s\n' % (self.client[0], error))
+        finally:
+            self.socket.close()
+
+    def transfer(self):
+        reply = self.negotiate()
+        last_block = len(self.data) // self.blksize + 1
+        if reply:
+            oack = struct.pack('!H', OPCODE_OACK)
+            for name, value in reply.items():
+                oack += name.encode('ascii') + b'\0' + str(value).encode('ascii') + b'\0'
+            for retry in range(MAX_RETRY):
+                self.send(oack)
+                if self.wait_ack(0, 0) == 0:
+                    break
+            else:
+                return
+
+        acked = 0
+        retry = 0
+        while acked < last_block:
+            time.sleep(self.server.delay)
+            end = min(acked + self.windowsize, last_block)
+            for block in range(acked + 1, end + 1):
+                offset = (block - 1) * self.blksize
+                packet = struct.pack('!HH', OPCODE_DATA, block & 0xFFFF) + self.data[offset:offset + self.blksize]
+                self.send(packet, data_packet=True)
+                self.server.count('sent')
+            block = self.wait_ack(acked, end)
+            if block is None or block == acked:
+                retry += 1
+                self.server.count('restarts')
+                if retry >= MAX_RETRY:
+                    return
+                continue
+            retry = 0
+            acked = block
+        self.server.count('completed')
+
+
+class TftpServer:
+    def __init__(self, address, port, files, delay, loss, max_window, timeout, seed, verbose):
+        self.family = socket.AF_INET6 if ':' in address else socket.AF_INET
+        self.address = address
+        self.files = files
+        self.delay = delay
+        self.loss = loss
+        self.max_window = max_window
+        self.timeout = timeout
+        self.seed = seed
+        self.verbose = verbose
+        self.lock = threading.Lock()
+        self.counters = {}
+        self.socket = socket.socket(self.family, socket.SOCK_DGRAM)
+        self.socket.bind((address, port))
+        self.port = self.socket.getsockname()[1]
+
+    def count(self, name):
+        with self.lock:
+            self.counters[name] = self.counters.get(name, 0) + 1
+
+    def serve_forever(self):
+        while True:
+            packet, client = self.socket.recvfrom(65536)
+            if len(packet) < 2 or struct.unpack('!H', packet[:2])[0] != OPCODE_RRQ:
+                self.socket.sendto(error_packet(ERROR_ILLEGAL_OPERATION, 'Only read requests are supported'), client)
+                continue
+            name, mode, options = parse_request(packet)
+            if self.verbose:
+                sys.stderr.write('%s: RRQ %s %s %s\n' % (client[0], name, mode, options))
+            data = self.files(name)
+            if data is None:
+                self.socket.sendto(error_packet(ERROR_NOT_FOUND, 'File not found'), client)
+                continue
+            Transfer(self, client, data, options).start()
+
+
+def download(port, name, blksize, windowsize, timeout):
+    client = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    request = struct.pack('!H', OPCODE_RRQ) + name.encode('ascii') + b'\0octet\0'
+    options = {'blksize': blksize, 'tsize': 0, 'timeout': timeout}
+    if windowsize > 1:
+        options['windowsize'] = windowsize
+    for option, value in options.items():
+        request += option.encode('ascii') + b'\0' + str(value).encode('ascii') + b'\0'
+
+    client.sendto(request, ('127.0.0.1', port))
+    last_packet = request
+    server = ('127.0.0.1', port)
+    chunks = []
+    expected = 1
+    received_since_ack = 0
+    gap_acked = False
+    retry = 0
+
+    def ack(block):
+        packet = struct.pack('!HH', OPCODE_ACK, block & 0xFFFF)
+        client.sendto(packet, server)
+        return packet
+
+    client.settimeout(timeout)
+    while True:
+        try:
+            packet, peer = client.recvfrom(65536)
+        except socket.timeout:
+            retry += 1
+            if retry >= MAX_RETRY:
+                raise TimeoutError('download timed out')
+            if received_since_ack:
+                last_packet = ack(expected - 1)
+                received_since_ack = 0
+            else:
+                client.sendto(last_packet, server)
+            continue
+
+        retry = 0
+        server = peer
+        opcode = struct.unpack('!H', packet[:2])[0]
+        if opcode == OPCODE_ERROR:
+            raise ConnectionAbortedError(packet[4:-1].decode('ascii', 'replace'))
+        if opcode == OPCODE_OACK:
+            fields = packet[2:].split(b'\0')
+            reply = dict(zip(fields[0::2], fields[1::2]))
+            blksize = int(reply.get(b'blksize', DEFAULT_BLKSIZE))
+            windowsize = int(reply.get(b'windowsize', 1))
+            last_packet = ack(0)
+            continue
+        if opcode != OPCODE_DATA:
+            continue
+
+        block = struct.unpack('!H', packet[2:4])[0]
+        if block != expected & 0xFFFF:
+            if windowsize > 1 and gap_acked:
+                continue
+            gap_acked = True
+            last_packet = ack(expected - 1)
+            received_since_ack = 0
+            continue
+
+        chunks.append(packet[4:])
+        expected += 1
+        received_since_ack += 1
+        gap_acked = False
+        if len(packet) - 4 < blksize:
+            ack(expected - 1)
+            break
+        if received_since_ack == windowsize:
+            last_packet = ack(expected - 1)
+            received_since_ack = 0
+
+    client.close()
+    return b''.join(chunks)
+
+
+def self_test(args):
+    data = os.urandom(parse_size(args.size))
+    digest = hashlib.sha256(data).hexdigest()
+    server = TftpServer('127.0.0.1', 0, lambda name: data if name == 'boot.img' else None,
+                        args.delay, args.loss, args.max_window, 1, args.seed, args.verbose)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    failures = 0
+
+    for windowsize in [int(value) for value in args.windows.split(',')]:
+        server.counters = {}
+        start = time.monotonic()
+        try:
+            body = download(server.port, 'boot.img', args.blksize, windowsize, 1)
+        except (TimeoutError, ConnectionAbortedError) as error:
+            print('FAIL: windowsize %d: %s' % (windowsize, error))
+            failures += 1
+            continue
+        elapsed = time.monotonic() - start
+        if hashlib.sha256(body).hexdigest() != digest:
+            print('FAIL: windowsize %d: content mismatch' % windowsize)
+            failures += 1
+        print('windowsize %5d: %6.2f s, %7.2f MB/s, %d blocks sent, %d dropped, %d window restarts' % (
+            windowsize, elapsed, len(data) / elapsed / 1e6, server.counters.get('sent', 0),
+            server.counters.get('dropped', 0), server.counters.get('restarts', 0)))
+
+    print('PASS' if failures == 0 else '%d FAILURES' % failures)
+    return 0 if failures == 0 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description='TFTP server with windowsize option support.')
+    parser.add_argument('--root', help='directory to serve')
+    parser.add_argument('--address', default='127.0.0.1', help='address to listen on')
+    parser.add_argument('--port', type=int, default=6969, help='port to listen on')
+    parser.add_argument('--delay', type=float, default=0.002, help='seconds before every window')
+    parser.add_argument('--loss', type=float, default=0.0, help='probability of dropping a data packet')
+    parser.add_argument('--max-window', type=int, default=64, help='largest windowsize accepted')
+    parser.add_argument('--timeout', type=int, default=1, help='retransmit timeout without the timeout option')
+    parser.add_argument('--seed', type=int, default=1, help='seed of the packet loss')
+    parser.add_argument('--size', default='8M', help='size of the random boot file for --self-test')
+    parser.add_argument('--blksize', type=int, default=1468, help='blksize requested by --self-test')
+    parser.add_argument('--windows', default='1,4,16', help='windowsizes compared by --self-test')
+    parser.add_argument('--self-test', action='store_true', help='test the server against a windowed client on loopback')
+    parser.add_argument('--verbose', action='store_true', help='log every request')
+    args = parser.parse_args()
+
+    if args.self_test:
+        return self_test(args)
+
+    if args.root is None:
+        parser.error('--root is required')
+
+    root = os.path.realpath(args.root)
+
+    def files(name):
+        path = os.path.realpath(os.path.join(root, name.lstrip('/\\')))
+        if not path.startswith(root + os.sep) or not os.path.isfile(path):
+            return None
+        with open(path, 'rb') as file:
+            return file.read()
+
+    server = TftpServer(args.address, args.port, files, args.delay, args.loss,
+                        args.max_window, args.timeout, args.seed, args.verbose)
+    print('Serving %s on %s:%d' % (root, args.address, server.port))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+    print(', '.join('%s %d' % item for item in sorted(server.counters.items())))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())